@@ -7,10 +7,269 @@
 
 #ifndef SIMULATION
 
-// dummy implementation until real one is required.
+#include "PathManager.hpp"
+#include "Geofence.hpp"
+#include "BinaryLog.hpp"
+#include "Clock.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+
+struct PMFix{
+	GeoPosition position;
+	float velocityNorth, velocityEast;
+};
+
+// a mission is loaded into whichever one isn't flying, and swapped in by the attitude manager's own task, so a load
+// never touches the segments being flown. Which one's flying and which is pending only change together, in critical
+// sections, so a loader can never see the swap half done and pick the one being flown as its spare
+static PathManager missions[2];
+static PathManager *activeMission = &missions[0];
+static PathManager * volatile pendingMission = nullptr;
+
+static PMFix latestFix; // only touched in critical sections
+static bool haveFix = false;
+
+// a fence is swapped in the same way as a mission, except it's built by the caller. The pending one only changes in
+// critical sections, and the caller gets the old one back once fencePending is clear
+static const Geofence *activeFence = nullptr;
+static const Geofence *pendingFence = nullptr;
+static volatile bool fencePending = false;
+
+static GeofenceStatus fenceStatus; // only touched in critical sections
+static bool haveFenceStatus = false;
+
+// commands from the ground, flown instead of the mission's until they run out. Only touched in critical sections
+static PMCommands overrideCommands;
+static uint32_t overrideStartMs = 0;
+static uint32_t overrideHoldMs = 0;
+static bool wasOverridden = false;
+
+// the one that isn't flying, or nullptr if a mission's still waiting to be swapped in
+static PathManager *take_spare()
+{
+	PathManager *spare = nullptr;
+
+	taskENTER_CRITICAL();
+	if (pendingMission == nullptr)
+	{
+		spare = (activeMission == &missions[0]) ? &missions[1] : &missions[0];
+	}
+	taskEXIT_CRITICAL();
+
+	return spare;
+}
+
+// also keeps the spare's segments from being written after it's handed over
+static void publish(PathManager *spare)
+{
+	taskENTER_CRITICAL();
+	pendingMission = spare;
+	taskEXIT_CRITICAL();
+}
+
+StatusCode PM_LoadMission(const GeoPosition *Home, const Waypoint *Waypoints, uint8_t Count)
+{
+	if (Home == nullptr)
+	{
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	PathManager *spare = take_spare();
+	if (spare == nullptr)
+	{
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	StatusCode status = spare->load_mission(*Home, Waypoints, Count);
+
+	if (status == STATUS_CODE_OK)
+	{
+		publish(spare);
+	}
+
+	return status;
+}
+
+StatusCode PM_LoadPlan(const GeoPosition *Home, const PathSegment *Segments, uint8_t Count)
+{
+	if (Home == nullptr)
+	{
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	PathManager *spare = take_spare();
+	if (spare == nullptr)
+	{
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	StatusCode status = spare->load_plan(*Home, Segments, Count);
+
+	if (status == STATUS_CODE_OK)
+	{
+		publish(spare);
+	}
+
+	return status;
+}
+
+void PM_UpdatePosition(const GeoPosition *Position, float VelocityNorth, float VelocityEast)
+{
+	PMFix fix;
+	fix.position = *Position;
+	fix.velocityNorth = VelocityNorth;
+	fix.velocityEast = VelocityEast;
+
+	taskENTER_CRITICAL();
+	latestFix = fix;
+	haveFix = true;
+	taskEXIT_CRITICAL();
+}
+
+void PM_SetOverride(const PMCommands *Commands, uint32_t HoldMs)
+{
+	uint32_t now = get_system_time();
+
+	taskENTER_CRITICAL();
+	if (Commands != nullptr)
+	{
+		overrideCommands = *Commands;
+	}
+	overrideStartMs = now;
+	overrideHoldMs = (Commands != nullptr) ? HoldMs : 0;
+	taskEXIT_CRITICAL();
+}
+
+StatusCode PM_SetGeofence(const Geofence *Fence)
+{
+	StatusCode status = STATUS_CODE_OK;
+
+	// also keeps the fence from being written after it's handed over
+	taskENTER_CRITICAL();
+	if (fencePending)
+	{
+		status = STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+	else
+	{
+		pendingFence = Fence;
+		fencePending = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return status;
+}
+
+bool PM_GeofencePending(void)
+{
+	bool pending;
+
+	// and keeps the caller from writing to the old fence before it's seen this
+	taskENTER_CRITICAL();
+	pending = fencePending;
+	taskEXIT_CRITICAL();
+
+	return pending;
+}
+
+bool PM_GetGeofenceStatus(GeofenceStatus *Status)
+{
+	bool checked;
+
+	taskENTER_CRITICAL();
+	*Status = fenceStatus;
+	checked = haveFenceStatus;
+	taskEXIT_CRITICAL();
+
+	return checked;
+}
+
+static void checkGeofence(const GeoPosition *Position)
+{
+	GeofenceStatus status = activeFence->check(*Position);
+
+	bool wasBreached;
+
+	taskENTER_CRITICAL();
+	wasBreached = haveFenceStatus && fenceStatus.breached;
+	fenceStatus = status;
+	haveFenceStatus = true;
+	taskEXIT_CRITICAL();
+
+	if (status.breached && !wasBreached)
+	{
+		LOG_ERROR("geofence breached, zone %d by %d cm", status.zone, (int32_t) (-status.margin * 100.0f));
+	}
+	else if (!status.breached && wasBreached)
+	{
+		LOG_INFO("geofence clear");
+	}
+}
+
+// without a mission or a fix the commands are left as they were
 PMError_t PM_GetCommands(PMCommands *Commands)
 {
-	(void) Commands;
+	if (pendingMission != nullptr)
+	{
+		taskENTER_CRITICAL();
+		activeMission = pendingMission;
+		pendingMission = nullptr;
+		taskEXIT_CRITICAL();
+	}
+
+	if (fencePending)
+	{
+		taskENTER_CRITICAL();
+		activeFence = pendingFence;
+		fencePending = false;
+		haveFenceStatus = false;
+		taskEXIT_CRITICAL();
+	}
+
+	PMFix fix;
+	bool fixed;
+
+	taskENTER_CRITICAL();
+	fix = latestFix;
+	fixed = haveFix;
+	taskEXIT_CRITICAL();
+
+	if (fixed && activeMission->has_mission())
+	{
+		PathState state;
+		state.position = activeMission->frame().to_ned(fix.position);
+		state.velocity_north = fix.velocityNorth;
+		state.velocity_east = fix.velocityEast;
+
+		activeMission->update(state, *Commands);
+	}
+
+	if (fixed && activeFence != nullptr)
+	{
+		checkGeofence(&fix.position);
+	}
+
+	uint32_t now = get_system_time();
+	bool overridden;
+
+	taskENTER_CRITICAL();
+	// measured from when it was set, so the time wrapping round doesn't matter
+	overridden = (now - overrideStartMs) < overrideHoldMs;
+	if (overridden)
+	{
+		*Commands = overrideCommands;
+	}
+	taskEXIT_CRITICAL();
+
+	if (overridden && !wasOverridden)
+	{
+		LOG_INFO("flying setpoints from the ground");
+	}
+	else if (!overridden && wasOverridden)
+	{
+		LOG_INFO("setpoints from the ground ran out, back to the mission");
+	}
+	wasOverridden = overridden;
 
 	PMError_t errorStruct;
 	errorStruct.errorCode = 0;
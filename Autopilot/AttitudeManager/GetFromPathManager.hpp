@@ -6,6 +6,15 @@
 #ifndef GET_FROM_PATH_MANAGER_HPP
 #define GET_FROM_PATH_MANAGER_HPP
 
+#include <stdint.h>
+#include "Status.hpp"
+
+struct Waypoint;
+struct GeoPosition;
+struct PathSegment;
+struct GeofenceStatus;
+class Geofence;
+
 struct PMCommands{
 	float roll,pitch,yaw;	// commanded orientation (radians)
 	float airspeed;			// commanded airspeed m/s
@@ -22,4 +31,52 @@ struct PMError_t{
 */
 PMError_t PM_GetCommands(PMCommands *Commands);
 
+/**
+* Hands a new mission to the path manager. Its segments are worked out here, in the caller's task, and it takes over
+* on the next PM_GetCommands.
+* @return 					STATUS_CODE_RESOURCE_EXHAUSTED if the previous mission hasn't been picked up yet,
+* 							STATUS_CODE_INVALID_ARGS if the mission can't be flown
+*/
+StatusCode PM_LoadMission(const GeoPosition *Home, const Waypoint *Waypoints, uint8_t Count);
+
+/**
+* Hands a plan that's already been worked out to the path manager, the same way as PM_LoadMission. Only call it from
+* one task at a time, along with PM_LoadMission.
+* @return 					STATUS_CODE_RESOURCE_EXHAUSTED if the previous mission hasn't been picked up yet,
+* 							STATUS_CODE_INVALID_ARGS if the plan can't be flown
+*/
+StatusCode PM_LoadPlan(const GeoPosition *Home, const PathSegment *Segments, uint8_t Count);
+
+/**
+* Flies the given commands instead of the mission's, until they've been held for HoldMs. Safe to call from any task,
+* and calling it again before then replaces them.
+* @param[in]	Commands 	nullptr, or a HoldMs of 0, hands control straight back to the mission
+*/
+void PM_SetOverride(const PMCommands *Commands, uint32_t HoldMs);
+
+/**
+* Gives the path manager the latest gps fix to guide from. Safe to call from any task.
+*/
+void PM_UpdatePosition(const GeoPosition *Position, float VelocityNorth, float VelocityEast);
+
+/**
+* Starts checking every fix against a fence, from the next PM_GetCommands on. The fence is used in place, so it
+* mustn't be changed until another one has replaced it: once PM_GeofencePending() is false again, the one before it
+* is free to be rebuilt. nullptr stops checking. Safe to call from any task.
+* @return 					STATUS_CODE_RESOURCE_EXHAUSTED if the previous fence hasn't been picked up yet
+*/
+StatusCode PM_SetGeofence(const Geofence *Fence);
+
+/**
+* Says whether the last fence set is still waiting for PM_GetCommands to pick it up. Safe to call from any task.
+* @return 					false once it's in use, and the fence it replaced is no longer read
+*/
+bool PM_GeofencePending(void);
+
+/**
+* Gets where the last fix was relative to the fence. Safe to call from any task.
+* @return 					false if there's no fence or no fix to check yet
+*/
+bool PM_GetGeofenceStatus(GeofenceStatus *Status);
+
 #endif
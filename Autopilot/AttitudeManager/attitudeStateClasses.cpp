@@ -7,6 +7,7 @@
 float OutputMixingMode::_channelOut[4];
 PMCommands fetchInstructionsMode::_PMInstructions;
 SFOutput_t sensorFusionMode::_SFOutput;
+Snapshot<SFOutput_t> sensorFusionMode::_published;
 PID_Output_t PIDloopMode::_PidOutput;
 
 /***********************************************************************************************************************
@@ -40,6 +41,7 @@ void sensorFusionMode::execute(attitudeManager* attitudeMgr)
 
     if (ErrorStruct.errorCode == 0)
     {
+        _published.publish(_SFOutput);
         attitudeMgr->setState(PIDloopMode::getInstance());
     }
     else
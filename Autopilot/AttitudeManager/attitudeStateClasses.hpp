@@ -9,6 +9,7 @@
 #include "SendInstructionsToSafety.hpp"
 #include "IMU.hpp"
 #include "airspeed.hpp"
+#include "Snapshot.hpp"
 
 /***********************************************************************************************************************
  * Definitions
@@ -58,6 +59,8 @@ class sensorFusionMode : public attitudeState
         void exit(attitudeManager* attitudeMgr) {(void) attitudeMgr;}
         static attitudeState& getInstance();
         static SFOutput_t *GetSFOutput(void) {return &_SFOutput;}
+        // Safe from other tasks, like telemetry. Returns 0 until sensor fusion has first succeeded
+        static uint32_t ReadPublishedSFOutput(SFOutput_t *Output) {return _published.read(*Output);}
     private:
         sensorFusionMode() {}
         sensorFusionMode(const sensorFusionMode& other);
@@ -65,6 +68,7 @@ class sensorFusionMode : public attitudeState
         IMU_CLASS ImuSens;
         AIRSPEED_CLASS AirspeedSens;
         static SFOutput_t _SFOutput;
+        static Snapshot<SFOutput_t> _published;
 
 };
 
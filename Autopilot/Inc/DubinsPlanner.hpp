@@ -0,0 +1,107 @@
+/**
+ * Plans paths through a mission's waypoints that the aircraft can actually fly, for PathManager to follow. Between
+ * each pair of waypoints is the shortest Dubins path: a turn, a straight and a turn, or three turns when they're close
+ * together, all at the tightest radius the leg's airspeed allows. Each waypoint is passed through on the heading
+ * halfway between the legs either side of it. See Dubins, "On Curves of Minimal Length with a Constraint on Average
+ * Curvature, and with Prescribed Initial and Terminal Positions and Tangents", 1957
+ *
+ * Planning is done a leg at a time by step(). Each step is a fixed amount of work however long the mission is, so a
+ * plan can be spread over as many slices as suits the caller, and dropped part way through when something more urgent
+ * comes along. A return home is a Dubins path onto a circle round home, and a loiter on it from there
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "PathManager.hpp"
+
+//turns are planned gentler than guidance is allowed to roll, so there's roll left over to correct with
+static const float PLANNER_ROLL_RAD = 0.75f * PATH_MAX_ROLL_RAD;
+
+typedef enum PlannerState {
+	PLANNER_IDLE = 0,
+	PLANNER_WORKING,
+	PLANNER_DONE,
+	PLANNER_FAILED
+} PlannerState;
+
+typedef struct DubinsPose {
+	float north; //m
+	float east;
+	float course; //rad, clockwise from north
+} DubinsPose;
+
+/**
+ * @return m, the radius of a level turn at the planning roll
+ */
+float planner_turn_radius(float airspeed);
+
+/**
+ * Works out the shortest path from one pose to another that never turns tighter than radius. Only the horizontal parts
+ * of the segments are filled in, and turns or straights too short to matter are left out
+ * @param segments Room for 3
+ * @param length Set to the length of the whole path, m
+ * @return How many segments were written
+ */
+uint8_t dubins_path(const DubinsPose &from, const DubinsPose &to, float radius, PathSegment *segments, float &length);
+
+class DubinsPlanner {
+	public:
+		DubinsPlanner();
+
+		/**
+		 * Starts planning a mission, dropping whatever was being planned before. The plan is in the local frame
+		 * centred on home
+		 * @param count At least 2, and no more than PATH_MAX_WAYPOINTS. Consecutive waypoints can't be on top of each
+		 *              other, and airspeeds have to be positive
+		 */
+		StatusCode start_mission(const GeoPosition &home, const Waypoint *waypoints, uint8_t count);
+
+		/**
+		 * Starts planning a way home from where the aircraft is, dropping whatever was being planned before. It ends
+		 * loitering clockwise round home, at home's altitude
+		 * @param course rad, clockwise from north, that the aircraft is flying
+		 * @param loiter_radius m. Made bigger if it's tighter than the aircraft can turn at airspeed
+		 */
+		StatusCode start_return(const GeoPosition &position, float course, const GeoPosition &home, float airspeed,
+								float loiter_radius);
+
+		/**
+		 * Plans the next leg
+		 * @return PLANNER_WORKING while there's more to do
+		 */
+		PlannerState step();
+
+		void cancel();
+
+		PlannerState state() const { return planner_state; }
+		const GeoPosition &home() const { return local.reference(); }
+		const PathSegment *plan() const { return segments; }
+		uint8_t plan_length() const { return segments_used; }
+
+	private:
+		LocalFrame local;
+		PlannerState planner_state;
+
+		Waypoint waypoints[PATH_MAX_WAYPOINTS];
+		uint8_t waypoint_count;
+		uint8_t next_leg;
+
+		//the end of the leg planned last, which the next one starts from
+		DubinsPose leg_start;
+		float leg_start_down;
+
+		bool returning;
+		float return_airspeed;
+		float loiter_radius;
+
+		PathSegment segments[PATH_MAX_SEGMENTS];
+		uint8_t segments_used;
+
+		void start();
+		void add_leg(const DubinsPose &to, float to_down, float airspeed);
+		PlannerState step_mission();
+		PlannerState step_return();
+};
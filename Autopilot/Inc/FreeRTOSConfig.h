@@ -108,6 +108,8 @@
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
 
 /* Co-routine definitions. */
@@ -124,6 +126,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil             0
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_xTaskGetIdleTaskHandle      1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -167,6 +170,17 @@ standard names. */
 
 /* USER CODE BEGIN Defines */   	      
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Scheduler trace hooks, see Common/Inc/RTOSTrace.h. Set to 0 to compile them out */
+#define RTOS_TRACE_ENABLED 1
+#if RTOS_TRACE_ENABLED && (defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__))
+    #include "RTOSTrace.h"
+#endif
+
+/* Run time stats count cpu cycles on the DWT cycle counter (DWT->CYCCNT, read by address as the CMSIS headers aren't
+   included here). initialize_system_clock() starts it before the scheduler does. It wraps every 20s at 216MHz, so
+   the stats have to be sampled more often than that, see SystemMonitor.h */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() (*(volatile uint32_t *) 0xE0001004UL)
 /* USER CODE END Defines */ 
 
 #endif /* FREERTOS_CONFIG_H */
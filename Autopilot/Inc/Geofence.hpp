@@ -0,0 +1,127 @@
+/**
+ * Keeps track of where the aircraft is allowed to be. The allowed area is inside any of the inclusion zones (or
+ * anywhere, if there are none), outside all of the exclusion zones, and between the altitude floor and ceiling.
+ * Zones are polygons or circles.
+ *
+ * Polygons are indexed when they're added so checks don't walk every edge. A grid is laid over each one, and every
+ * cell gets whether its centre is inside and the short list of edges within half a cell width of it. A check finds
+ * the point's cell and counts the listed edges between the centre and the point to tell if it's inside. That's a
+ * handful of edges however many the polygon has.
+ *
+ * Within half a cell width of the boundary the distance to it is exact. Further away it's a bound that's never more
+ * than the real distance, so the margin while inside is never overstated. Cells are sized to the polygon, a 1000 x
+ * 1000m one with a hundred vertices gets about 80m cells. The indexing itself is slow (cells x edges), so build fences
+ * on the ground
+ *
+ * Everything is in the local frame of the home position given to clear()
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Position.hpp"
+#include "Status.hpp"
+
+static const uint8_t GEOFENCE_MAX_ZONES = 8;
+static const uint16_t GEOFENCE_MAX_VERTICES = 512; //across all the polygons
+static const uint16_t GEOFENCE_MAX_CELLS = 2048;
+static const uint16_t GEOFENCE_MAX_CELL_EDGES = 8192;
+
+//zone reported when it's the altitude limits that are closest
+static const uint8_t GEOFENCE_ALTITUDE = 0xFF;
+
+typedef enum GeofenceKind {
+	GEOFENCE_INCLUSION = 0,
+	GEOFENCE_EXCLUSION
+} GeofenceKind;
+
+typedef struct GeofenceStatus {
+	bool breached;
+	float margin; //m to the nearest edge of the allowed area. Negative is how far outside it, FLT_MAX with no limits
+	uint8_t zone; //index of the zone that edge belongs to, or GEOFENCE_ALTITUDE
+} GeofenceStatus;
+
+typedef struct GeofenceCell {
+	uint16_t first_edge; //into the cell edge list
+	uint8_t edge_count;
+	bool centre_inside;
+	float centre_distance; //m from the centre to the boundary
+} GeofenceCell;
+
+typedef struct GeofenceZone {
+	GeofenceKind kind;
+	bool is_circle;
+
+	//circles
+	float centre_north;
+	float centre_east;
+	float radius;
+
+	//polygons. Vertex i and i + 1 (wrapping round) make edge i
+	uint16_t first_vertex;
+	uint16_t vertex_count;
+	uint16_t first_cell;
+	uint8_t columns;
+	uint8_t rows;
+	float min_north;
+	float min_east;
+	float max_north;
+	float max_east;
+	float inverse_cell_size;
+} GeofenceZone;
+
+class Geofence {
+	public:
+		Geofence();
+
+		/**
+		 * Removes every zone and the altitude limits, and moves the local frame to home
+		 */
+		void clear(const GeoPosition &home);
+
+		/**
+		 * @param count At least 3. Vertices go round the outside in either direction, and edges mustn't cross
+		 * @return STATUS_CODE_RESOURCE_EXHAUSTED if it doesn't fit, in which case the fence is left as it was
+		 */
+		StatusCode add_polygon(GeofenceKind kind, const GeoPosition *vertices, uint16_t count);
+
+		StatusCode add_circle(GeofenceKind kind, const GeoPosition &centre, float radius);
+
+		/**
+		 * @param floor_mm, ceiling_mm Above mean sea level, like GeoPosition::altitude_mm
+		 */
+		void set_altitude_limits(int32_t floor_mm, int32_t ceiling_mm);
+
+		GeofenceStatus check(const NEDPosition &position) const;
+		GeofenceStatus check(const GeoPosition &position) const { return check(local.to_ned(position)); }
+
+		const LocalFrame &frame() const { return local; }
+		uint8_t zone_count() const { return zones_used; }
+
+	private:
+		LocalFrame local;
+
+		GeofenceZone zones[GEOFENCE_MAX_ZONES];
+		uint8_t zones_used;
+
+		float vertex_north[GEOFENCE_MAX_VERTICES];
+		float vertex_east[GEOFENCE_MAX_VERTICES];
+		uint16_t vertices_used;
+
+		GeofenceCell cells[GEOFENCE_MAX_CELLS];
+		uint16_t cells_used;
+
+		uint16_t cell_edges[GEOFENCE_MAX_CELL_EDGES]; //edge numbers, within their polygon
+		uint16_t cell_edges_used;
+
+		bool has_altitude_limits;
+		float floor_down;
+		float ceiling_down;
+
+		//m inside the zone, negative when outside
+		float depth_in(const GeofenceZone &zone, float north, float east) const;
+		float depth_in_polygon(const GeofenceZone &zone, float north, float east) const;
+		bool index_polygon(GeofenceZone &zone);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPS_SERVICE_PERIOD_MS 10 //well inside the dma stamps, so first bytes can still be timed when they're parsed
+
+/**
+ * Runs the gps in a task of its own: configures the receiver, then keeps parsing what comes in off the uart and
+ * publishing each solution, stamped with when its first byte arrived. Every fix is passed on to the path manager.
+ * Configuring the receiver is stepped from each measurement, so it never holds this task up either
+ */
+void GpsService_Run(void const *argument);
+
+#ifdef __cplusplus
+}
+
+#include "gps.hpp"
+
+/**
+ * Copies out the latest solution, without any parsing. dataIsNew is tracked for one reader, which should be the one
+ * fusing it
+ */
+void GpsService_GetResult(GpsData_t *data);
+
+/**
+ * Copies out the latest solution without touching dataIsNew, for anything that only reports it, like telemetry
+ * @return false if there hasn't been a solution yet
+ */
+bool GpsService_GetLatest(GpsData_t *data);
+#endif
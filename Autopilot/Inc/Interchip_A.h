@@ -1,9 +1,32 @@
+#pragma once
+
 #include "stm32f7xx_hal.h"
 #include "Interchip.h"
+#include "InterchipStats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #define INTERCHIP_TRANSMIT_DELAY 5
+#define INTERCHIP_STAGING_TIMEOUT 1 // ms a setter waits for the interchip task to finish copying out the last values
 
 int16_t *Interchip_GetPWM(void);
+
+/**
+ * The setters only stage values for the next frame, never the one going out. They're dropped if the interchip task
+ * holds on to them for longer than INTERCHIP_STAGING_TIMEOUT, or before it's started
+ */
 void Interchip_SetPWM(int16_t *data);
 uint16_t Interchip_GetSafetyLevel(void);
-void Interchip_SetAutonomousLevel(uint16_t data);
\ No newline at end of file
+void Interchip_SetAutonomousLevel(uint16_t data);
+
+/**
+ * @param local How the link looks from the autopilot's end
+ * @param remote How the link looks from the safety chip's end, as of its last good frame
+ */
+void Interchip_GetLinkStats(InterchipStatsSnapshot *local, Interchip_LinkHealth *remote);
+
+#ifdef __cplusplus
+}
+#endif
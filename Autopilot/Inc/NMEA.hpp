@@ -0,0 +1,177 @@
+/**
+ * Streaming parser for the NMEA 0183 sentences a gps sends out. Bytes are fed in as they arrive, straight out of the
+ * uart's receive ring, and each one is checksummed, split into fields and converted in a single pass. Nothing is
+ * copied into intermediate strings and no libc conversion functions are used: numbers are accumulated digit by digit
+ * and scaled into fixed point integers, so the parser costs the same on the chip as it does on a host.
+ *
+ * Sentences are recognized by their type alone, so any talker works (GP for gps only receivers, GN for multi
+ * constellation ones, GL, GA, BD...). Supported types:
+ *
+ *  GGA  $--GGA,hhmmss.ss,ddmm.mmmmm,N,dddmm.mmmmm,E,fix,sats,hdop,alt,M,sep,M,age,station*cs
+ *  VTG  $--VTG,course,T,course_mag,M,knots,N,kph,K,mode*cs
+ *  RMC  $--RMC,hhmmss.ss,status,ddmm.mmmmm,N,dddmm.mmmmm,E,knots,course,ddmmyy,magvar,E,mode*cs
+ *
+ * Anything else is skipped over without being converted. Positions come out in 1e-7 degrees (about 1cm), which
+ * holds every digit a receiver sends out
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ByteRing.hpp"
+
+//the standard allows 82 characters. Some receivers go over that with long fields, so leave a bit of room
+static const uint8_t NMEA_MAX_SENTENCE_LEN = 96;
+
+typedef enum NMEASentenceType {
+	NMEA_SENTENCE_GGA = 0,
+	NMEA_SENTENCE_VTG,
+	NMEA_SENTENCE_RMC
+} NMEASentenceType;
+
+/**
+ * Position fix. Lat/lon are 0 when there's no fix
+ */
+typedef struct NMEAGGA {
+	uint32_t time_ms; //utc, since midnight
+	int32_t latitude; //1e-7 degrees, north is positive
+	int32_t longitude; //1e-7 degrees, east is positive
+	int32_t altitude_mm; //above mean sea level
+	int32_t geoid_separation_mm; //height of the geoid above the wgs84 ellipsoid
+	uint16_t hdop; //hundredths
+	uint8_t fix_quality; //0 = no fix, 1 = gps, 2 = dgps, 4 = rtk fixed, 5 = rtk float, 6 = dead reckoning
+	uint8_t satellites;
+} NMEAGGA;
+
+/**
+ * Course and speed over ground
+ */
+typedef struct NMEAVTG {
+	uint32_t speed_mm_s;
+	uint16_t course; //true, hundredths of a degree
+	bool course_valid; //receivers leave the course empty while they're not moving
+	char mode; //'A' autonomous, 'D' differential, 'E' dead reckoning, 'N' no fix. 0 from receivers older than NMEA 2.3
+} NMEAVTG;
+
+/**
+ * Recommended minimum: position, speed, course and the date
+ */
+typedef struct NMEARMC {
+	uint32_t time_ms; //utc, since midnight
+	int32_t latitude; //1e-7 degrees, north is positive
+	int32_t longitude; //1e-7 degrees, east is positive
+	uint32_t speed_mm_s;
+	uint16_t course; //true, hundredths of a degree
+	bool course_valid;
+	bool valid; //status field was 'A'. Everything else is the receiver's last guess
+	uint8_t day;
+	uint8_t month;
+	uint16_t year;
+	char mode; //same as NMEAVTG::mode
+} NMEARMC;
+
+typedef struct NMEASentence {
+	NMEASentenceType type;
+	char talker[2];
+	union {
+		NMEAGGA gga;
+		NMEAVTG vtg;
+		NMEARMC rmc;
+	};
+} NMEASentence;
+
+class NMEAParser {
+ public:
+	/**
+	 * @param byte
+	 * @return true if byte completed a sentence, which is now in sentence()
+	 */
+	bool feed(uint8_t byte);
+
+	/**
+	 * Parses bytes until a sentence is completed or they run out, so it can work in place on a ring's contents
+	 * @param data
+	 * @param len
+	 * @param complete Set to true if a sentence was completed, which is now in sentence()
+	 * @return Bytes used up. Less than len if a sentence was completed before the end
+	 */
+	size_t feed(const uint8_t *data, size_t len, bool &complete);
+
+	/**
+	 * Parses straight out of a receive ring, consuming what was parsed
+	 * @return true if a sentence was completed. Call again until false to drain the ring
+	 */
+	bool feed(ByteRing &ring);
+
+	/**
+	 * @return The last sentence completed. Stays valid until the next one completes
+	 */
+	const NMEASentence &sentence() const { return completed; }
+
+	/**
+	 * Drops any partially parsed sentence
+	 */
+	void reset() { state = NMEA_WAIT_START; }
+
+	uint32_t checksum_errors() const { return bad_checksums; }
+
+	/**
+	 * @return Sentences that were cut off, too long, or missing fields
+	 */
+	uint32_t malformed_sentences() const { return malformed; }
+
+	/**
+	 * @return Well formed sentences of a type the parser doesn't handle
+	 */
+	uint32_t ignored_sentences() const { return ignored; }
+
+ private:
+	enum NMEAParserState : uint8_t {
+		NMEA_WAIT_START = 0,
+		NMEA_ADDRESS,
+		NMEA_FIELD,
+		NMEA_CHECKSUM_HIGH,
+		NMEA_CHECKSUM_LOW
+	};
+
+	NMEAParserState state = NMEA_WAIT_START;
+	uint8_t length = 0;
+	uint8_t checksum = 0;
+	uint8_t expected_checksum = 0;
+	uint8_t field = 0;
+	uint32_t address = 0;
+
+	//the field being accumulated
+	uint32_t whole = 0;
+	uint32_t fraction = 0;
+	uint8_t whole_digits = 0;
+	uint8_t fraction_digits = 0;
+	bool in_fraction = false;
+	bool negative = false;
+	char letter = 0;
+
+	NMEASentence working;
+	NMEASentence completed;
+
+	uint32_t bad_checksums = 0;
+	uint32_t malformed = 0;
+	uint32_t ignored = 0;
+
+	bool parse(uint8_t byte);
+	void start_sentence();
+	bool start_fields();
+	void end_field();
+	void end_gga_field();
+	void end_vtg_field();
+	void end_rmc_field();
+	bool has_all_fields() const;
+	uint32_t fraction_to(uint8_t decimals) const;
+	int32_t fixed_point(uint8_t decimals) const;
+	uint32_t time_ms() const;
+	int32_t angle_from_degrees_minutes() const;
+	bool field_empty() const { return whole_digits == 0 && fraction_digits == 0 && letter == 0; }
+	void drop_sentence();
+};
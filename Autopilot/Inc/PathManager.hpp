@@ -0,0 +1,139 @@
+/**
+ * Waypoint following. A mission is a home position and a list of waypoints. When it's loaded, every leg is turned
+ * into a segment in the local frame, with its direction, length, climb and the turn onto the next leg all worked out
+ * up front, and stored one after the other in a flat array. Each tick then only looks at the current segment:
+ * progress along it, whether it's time to turn onto the next one, and L1 guidance onto its line.
+ *
+ * L1 guidance steers toward a point on the track a fixed time ahead of the aircraft, and commands the lateral
+ * acceleration that would arc onto it. The distance to that point scales with ground speed, so the response is the
+ * same at any speed, and it needs no trig per tick beyond the final roll and heading. See Park, Deyst and How, "A New
+ * Nonlinear Guidance Logic for Trajectory Tracking", 2004
+ *
+ * Segments can also be arcs, for plans made of turns of a fixed radius like the ones DubinsPlanner builds. An arc is
+ * flown the same way against the tangent at the nearest point, plus the lateral acceleration the turn itself takes.
+ * A loiter is an arc that never ends
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Position.hpp"
+#include "Status.hpp"
+#include "GetFromPathManager.hpp"
+
+static const uint8_t PATH_MAX_WAYPOINTS = 64;
+
+//a planned leg can be a turn, a straight and another turn, and a plan can end in a loiter
+static const uint8_t PATH_MAX_SEGMENTS = 3 * (PATH_MAX_WAYPOINTS - 1) + 1;
+
+//m, planned segments can be a lot shorter than legs between waypoints. A turn of a degree or two is fine
+static const float PATH_MIN_PLANNED_LENGTH = 0.01f;
+
+//L1 tuning. The period is roughly how long it takes to settle onto a line, the damping how much it overshoots
+static const float PATH_L1_PERIOD_S = 20.0f;
+static const float PATH_L1_DAMPING = 0.75f;
+
+static const float PATH_MAX_ROLL_RAD = 0.61f; //35 degrees
+static const float PATH_MAX_PITCH_RAD = 0.35f; //20 degrees
+static const float PATH_ALTITUDE_GAIN = 0.02f; //rad of pitch per metre below the track
+
+typedef struct Waypoint {
+	GeoPosition position;
+	float airspeed; //m/s, to fly the leg that ends here at
+} Waypoint;
+
+/**
+ * What guidance needs to know about the aircraft, in the mission's frame
+ */
+typedef struct PathState {
+	NEDPosition position;
+	float velocity_north; //m/s, over the ground
+	float velocity_east;
+} PathState;
+
+typedef enum PathSegmentKind {
+	PATH_LINE = 0,
+	PATH_ARC,
+	PATH_LOITER
+} PathSegmentKind;
+
+/**
+ * Everything about one leg that doesn't change while flying it
+ */
+typedef struct PathSegment {
+	PathSegmentKind kind;
+	float start_north; //m, from home
+	float start_east;
+	float start_down;
+	float direction_north; //unit vector along the leg, at its start for arcs
+	float direction_east;
+	float length; //m, horizontal. Ignored for loiters
+	float climb; //m of down per m along, so negative when climbing
+	float flight_path_angle; //rad, nose up to hold the climb
+	float course; //rad, clockwise from north, at the start
+	float switch_distance; //m before the end to start turning onto the next leg
+	float airspeed; //m/s
+
+	//arcs and loiters
+	float centre_north;
+	float centre_east;
+	float radius; //m
+	float start_bearing; //rad, clockwise from north, of the start from the centre
+	int8_t turn; //1 clockwise, -1 anticlockwise
+} PathSegment;
+
+class PathManager {
+	public:
+		PathManager();
+
+		/**
+		 * Replaces the mission. The local frame is centred on home
+		 * @param count At least 2, and no more than PATH_MAX_WAYPOINTS. Consecutive waypoints can't be on top of each
+		 *              other
+		 */
+		StatusCode load_mission(const GeoPosition &home, const Waypoint *waypoints, uint8_t count);
+
+		/**
+		 * Replaces the mission with segments that are already worked out, in the local frame centred on home
+		 * @param count At least 1, and no more than PATH_MAX_SEGMENTS. Only the last one can be a loiter
+		 */
+		StatusCode load_plan(const GeoPosition &home, const PathSegment *segments, uint8_t count);
+
+		void clear();
+
+		/**
+		 * Works out the commands for one tick. Before a mission is loaded the commands are left alone
+		 */
+		void update(const PathState &state, PMCommands &commands);
+
+		const LocalFrame &frame() const { return local; }
+		bool has_mission() const { return count > 0; }
+		uint8_t segment_count() const { return count; }
+		uint8_t current_segment() const { return current; }
+		const PathSegment &segment(uint8_t index) const { return segments[index]; }
+
+		//true once the end of the last leg is passed, or the loiter at the end is reached. The last leg's line (or
+		//circle) is followed on past it
+		bool mission_complete() const { return complete; }
+
+		//m right of the current leg, as of the last update
+		float cross_track_error() const { return cross_track; }
+
+	private:
+		LocalFrame local;
+		PathSegment segments[PATH_MAX_SEGMENTS];
+		uint8_t count;
+		uint8_t current;
+		bool complete;
+		float cross_track;
+
+		//how far round the current arc, kept up tick by tick so a full circle isn't mistaken for none
+		bool arc_entered;
+		float arc_bearing;
+		float arc_swept;
+
+		void enter_segment(uint8_t index);
+		float progress(const PathSegment &segment, const NEDPosition &position);
+};
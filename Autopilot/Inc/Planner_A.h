@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Status.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PLANNER_IDLE_PERIOD_MS 20 //how long a request can wait before planning starts
+
+struct GeoPosition;
+struct Waypoint;
+
+/**
+ * Plans missions and returns home in the background with DubinsPlanner, and hands each finished plan to the path
+ * manager in one go. It runs at low priority a leg at a time, yielding in between, so planning never holds up the
+ * control loop and a new request takes over from an old one within a leg
+ */
+void Planner_Run(void const *argument);
+
+/**
+ * Queues a mission to be planned. Everything is copied, so nothing has to stay around after this returns
+ * @return STATUS_CODE_RESOURCE_EXHAUSTED if the last request hasn't been taken up yet
+ */
+StatusCode Planner_RequestMission(const struct GeoPosition *home, const struct Waypoint *waypoints, uint8_t count);
+
+/**
+ * Queues a return home from where the aircraft is, ending in a loiter round home at home's altitude
+ * @param course rad, clockwise from north, that the aircraft is flying
+ * @return STATUS_CODE_RESOURCE_EXHAUSTED if the last request hasn't been taken up yet
+ */
+StatusCode Planner_RequestReturn(const struct GeoPosition *position, float course, const struct GeoPosition *home,
+								 float airspeed, float loiter_radius);
+
+/**
+ * @return true from a request until its plan is handed over, or planning it fails
+ */
+bool Planner_IsBusy(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Geodetic positions and the local frame navigation works in.
+ *
+ * GeoPosition is the one position type used by the gps drivers, navigation and logging. Latitude and longitude are
+ * integer 1e-7 degrees (about 1cm, and every digit a receiver sends), so positions are exact, 12 bytes, cheap to copy
+ * between tasks and log as plain integers.
+ *
+ * LocalFrame turns positions into metres north, east and down of a reference point (usually home). Everything that
+ * needs trig is worked out once when the reference is set, after that each conversion is a handful of float
+ * multiplies. The conversion is a second order expansion of the exact ellipsoid tangent plane: away from the poles
+ * it's within a millimetre at 1km out, a couple of centimetres at 5km and a few decimetres at 20km. Past that, set a
+ * closer reference
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+//1e-7 degree units per degree
+static const int32_t GEO_UNITS_PER_DEGREE = 10000000;
+
+typedef struct GeoPosition {
+	int32_t latitude; //1e-7 degrees, north is positive
+	int32_t longitude; //1e-7 degrees, east is positive
+	int32_t altitude_mm; //above mean sea level
+} GeoPosition;
+
+typedef struct NEDPosition {
+	float north; //m
+	float east; //m
+	float down; //m
+} NEDPosition;
+
+class LocalFrame {
+	public:
+		LocalFrame();
+
+		/**
+		 * Moves the origin of the frame. Does all the trig, so don't call it every cycle
+		 */
+		void set_reference(const GeoPosition &reference);
+
+		const GeoPosition &reference() const { return origin; }
+
+		NEDPosition to_ned(const GeoPosition &position) const;
+
+		/**
+		 * The inverse of to_ned(), for turning local waypoints back into positions to send or log
+		 */
+		GeoPosition from_ned(const NEDPosition &ned) const;
+
+	private:
+		GeoPosition origin;
+
+		//metres per 1e-7 degree at the origin, and how they change moving away from it
+		float north_scale;
+		float east_scale;
+		float east_skew; //change in east_scale per unit of latitude
+		float north_bend; //metres north per squared unit of longitude, lines of latitude curve away in the plane
+		float inverse_diameter; //1 / 2R, for the drop of the surface below the plane
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "SystemMonitor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSTEM_MONITOR_PERIOD_MS 1000 //has to stay well under one wrap of the run time counter
+
+/**
+ * Samples every task's stack and cpu usage and the heap once a period, logs a summary, and logs an error whenever
+ * an alarm is raised
+ */
+void SystemMonitor_Run(void const *argument);
+
+/**
+ * @param snapshot Filled in with the latest sample, for telemetry
+ */
+void SystemMonitor_GetSnapshot(SystemMonitorSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+/**
+ * Binary telemetry for the ground station, decoded on the ground by Autopilot/Tools/decode_telemetry.py.
+ *
+ * Frames are COBS encoded with a crc (see Framing.hpp), so a 0 byte only ever ends a frame and the ground can pick the
+ * stream up anywhere. Before encoding a frame is:
+ *
+ *  [0]      message id, TelemetryMessageId
+ *  [1]      sequence number, one more every frame, so the ground can count what it missed
+ *  [2-]     payload, laid out below. Little endian, floats are IEEE 754 singles
+ *  [last 2] crc16_ccitt of everything before it, little endian
+ *
+ * That's never more than 254 bytes, so encoding always adds exactly one code byte at the front, plus the 0 at the
+ * end. TelemetryWriter encodes each field as it goes straight into the uart's transmit queue. Nothing is built up
+ * anywhere else first.
+ *
+ * Payloads:
+ *
+ *  HEARTBEAT  u32 uptime ms, u32 free heap bytes, u16 cpu load permille, u8 SystemMonitorAlarm bits,
+ *             u8 TelemetryFlags
+ *  ATTITUDE   f32 roll, pitch, yaw rad, f32 roll, pitch, yaw rates rad/s, f32 airspeed m/s
+ *  GPS        i32 latitude, longitude 1e-7 deg, i32 altitude mm above msl, f32 velocity north, east, down m/s,
+ *             f32 horizontal, vertical accuracy m, i16 heading deg, u8 satellites, u8 fix (as GpsData_t),
+ *             u32 ms since boot its first byte arrived
+ *  GEOFENCE   u8 breached, u8 nearest zone, f32 margin m
+ *  TASKS      u8 count, then for each task: u8 number, 8 name characters (0 padded), u16 least free stack words,
+ *             u16 cpu permille
+ *  INTERCHIP  the spi link to the safety chip, from this end: u32 frames sent, frames received, crc failures,
+ *             sequence gaps, late frames, send overruns, transfer errors, u32 last and max round trip us,
+ *             u32 round trip histogram counts (INTERCHIP_RTT_BUCKETS of them, see InterchipStats.h). Then from the safety
+ *             chip's end, as of its last good frame: u16 crc failures, sequence gaps, late frames
+ *  ACK        u8 id and u8 sequence number of the uplink frame it answers (see Uplink.hpp), u8 StatusCode,
+ *             u8 detail: for mission uploads, how many waypoints have arrived
+ *
+ * Every message has its own rate. TelemetryScheduler fits them into what the link can carry, sending whichever is the
+ * furthest past due first. One that can't go out waits for the budget rather than holding anything else up, and one
+ * that falls a whole period behind skips that period instead of bursting to catch up. Acks aren't scheduled, they go
+ * out ahead of everything else as soon as the link has room
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DMATxQueue.hpp"
+#include "Framing.hpp"
+#include "SystemMonitor.h"
+#include "SensorFusion.hpp"
+#include "Geofence.hpp"
+#include "gps.hpp"
+#include "InterchipStats.h"
+#include "Status.hpp"
+
+static const FramingFormat TELEMETRY_FRAMING = {FRAMING_COBS, true};
+
+static const size_t TELEMETRY_HEADER_LEN = 2;
+static const size_t TELEMETRY_CRC_LEN = FRAMING_CRC_LEN;
+static const size_t TELEMETRY_MAX_CONTENT_LEN = FRAMING_COBS_MAX_BLOCK; //so one code byte covers all of it
+static const size_t TELEMETRY_MAX_PAYLOAD_LEN = TELEMETRY_MAX_CONTENT_LEN - TELEMETRY_HEADER_LEN - TELEMETRY_CRC_LEN;
+
+//header, crc, the code byte and the 0 at the end
+static const size_t TELEMETRY_FRAME_OVERHEAD = TELEMETRY_HEADER_LEN + TELEMETRY_CRC_LEN + 2;
+
+static const uint16_t TELEMETRY_HEARTBEAT_LEN = 12;
+static const uint16_t TELEMETRY_ATTITUDE_LEN = 28;
+static const uint16_t TELEMETRY_GPS_LEN = 40;
+static const uint16_t TELEMETRY_GEOFENCE_LEN = 6;
+static const uint16_t TELEMETRY_TASK_LEN = 1 + SYSTEM_MONITOR_NAME_LEN + 4;
+static const uint16_t TELEMETRY_INTERCHIP_LEN = 4 * (9 + INTERCHIP_RTT_BUCKETS) + 6;
+static const uint16_t TELEMETRY_ACK_LEN = 4;
+
+typedef enum TelemetryMessageId : uint8_t {
+	TELEMETRY_HEARTBEAT = 0,
+	TELEMETRY_ATTITUDE,
+	TELEMETRY_GPS,
+	TELEMETRY_GEOFENCE,
+	TELEMETRY_TASKS,
+	TELEMETRY_INTERCHIP,
+	TELEMETRY_MESSAGE_COUNT,
+	TELEMETRY_ACK = 0x80, //not scheduled
+	TELEMETRY_NONE = 0xFF
+} TelemetryMessageId;
+
+typedef enum TelemetryFlags : uint8_t {
+	TELEMETRY_FLAG_PLANNER_BUSY = 1 << 0,
+	TELEMETRY_FLAG_GPS_FIX = 1 << 1,
+	TELEMETRY_FLAG_GEOFENCE_ACTIVE = 1 << 2,
+	TELEMETRY_FLAG_GEOFENCE_BREACHED = 1 << 3
+} TelemetryFlags;
+
+typedef struct TelemetryAck {
+	uint8_t id; //of the uplink frame being answered
+	uint8_t sequence;
+	uint8_t status; //StatusCode
+	uint8_t detail;
+} TelemetryAck;
+
+/**
+ * @return Bytes a frame with this much payload takes on the wire
+ */
+static inline size_t telemetry_frame_len(size_t payload_len) {
+	return payload_len + TELEMETRY_FRAME_OVERHEAD;
+}
+
+static inline uint16_t telemetry_tasks_len(uint8_t task_count) {
+	return (uint16_t) (1 + task_count * TELEMETRY_TASK_LEN);
+}
+
+/**
+ * Writes one frame into space handed out by UARTPort::transmit_reserve(), wrapping from the first piece of it into the
+ * second where it has to
+ */
+class TelemetryWriter : public FrameWriter {
+ public:
+	/**
+	 * Starts a frame
+	 * @param region Exactly telemetry_frame_len() of the payload that's going to be written
+	 */
+	TelemetryWriter(const DMATxRegion &region, TelemetryMessageId id, uint8_t sequence);
+};
+
+void telemetry_write_heartbeat(TelemetryWriter &writer, uint32_t uptime_ms, const SystemMonitorSnapshot &system,
+							   uint8_t flags);
+void telemetry_write_attitude(TelemetryWriter &writer, const SFOutput_t &attitude);
+void telemetry_write_gps(TelemetryWriter &writer, const GpsData_t &gps);
+void telemetry_write_geofence(TelemetryWriter &writer, const GeofenceStatus &status);
+void telemetry_write_tasks(TelemetryWriter &writer, const SystemMonitorSnapshot &system);
+void telemetry_write_interchip(TelemetryWriter &writer, const InterchipStatsSnapshot &local,
+								const Interchip_LinkHealth &remote);
+void telemetry_write_ack(TelemetryWriter &writer, const TelemetryAck &ack);
+
+class TelemetryScheduler {
+ public:
+	TelemetryScheduler();
+
+	/**
+	 * @param bytes_per_s What the link carries, less whatever headroom should be left on it
+	 * @param burst_bytes Most that can go out at once after the link's been quiet. No more than the transmit queue
+	 */
+	void set_link(uint32_t bytes_per_s, uint32_t burst_bytes);
+
+	/**
+	 * @param rate_hz 0 turns the message off. It's first due straight away
+	 * @return STATUS_CODE_INVALID_ARGS for a message that doesn't exist, or a negative rate
+	 */
+	StatusCode set_rate(TelemetryMessageId id, float rate_hz);
+
+	/**
+	 * @param now_us
+	 * @return The message furthest past due, or TELEMETRY_NONE if none are due. It stays due until sent() or skip()
+	 */
+	TelemetryMessageId next(uint64_t now_us);
+
+	/**
+	 * Takes a frame's bytes out of the link budget, if they're there
+	 * @return false if the link can't take it yet
+	 */
+	bool spend(size_t frame_len, uint64_t now_us);
+
+	/**
+	 * Moves a message on to its next period, after it's been sent
+	 */
+	void sent(TelemetryMessageId id);
+
+	/**
+	 * Moves a message on to its next period without sending it, like when there's nothing to send
+	 */
+	void skip(TelemetryMessageId id);
+
+	uint32_t sent_count(TelemetryMessageId id) const { return id < TELEMETRY_MESSAGE_COUNT ? sends[id] : 0; }
+
+	/**
+	 * @return Periods a message missed, because the link was too busy or there was nothing to send
+	 */
+	uint32_t skipped_count(TelemetryMessageId id) const { return id < TELEMETRY_MESSAGE_COUNT ? skips[id] : 0; }
+
+ private:
+	uint32_t period_us[TELEMETRY_MESSAGE_COUNT]; //0 when off
+	uint64_t due_us[TELEMETRY_MESSAGE_COUNT];
+	bool starting[TELEMETRY_MESSAGE_COUNT]; //due whenever next() is next called
+	uint32_t sends[TELEMETRY_MESSAGE_COUNT];
+	uint32_t skips[TELEMETRY_MESSAGE_COUNT];
+
+	//token bucket, in millionths of a byte so a microsecond's worth isn't rounded away
+	uint32_t bytes_per_s;
+	uint64_t burst;
+	uint64_t tokens;
+	uint64_t last_refill_us;
+	bool refilled;
+
+	void advance(TelemetryMessageId id);
+};
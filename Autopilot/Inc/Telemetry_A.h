@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "Status.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_PERIOD_MS 10
+#define TELEMETRY_BAUDRATE 57600
+#define TELEMETRY_LINK_PERCENT 80 //of the link telemetry plans to use, leaving room for the radio's own overhead
+#define TELEMETRY_RX_BYTES_PER_PERIOD 256 //over 4 times what the link can bring in over a period
+
+/**
+ * Runs the radio link, on a uart of its own. Telemetry goes down, each message at its own rate and no more than the
+ * link can carry, written straight into the uart's dma queue from wherever its data is published (see Telemetry.hpp).
+ * Commands come up (see Uplink.hpp), are decoded where they land in the receive ring, and are acked on the way down.
+ * Only so many received bytes are decoded each period, so however much arrives the task's work stays bounded
+ */
+void Telemetry_Run(void const *argument);
+
+/**
+ * Changes how often a message is sent. Taken up by the telemetry task on its next period
+ * @param id TelemetryMessageId
+ * @param rate_hz 0 turns the message off
+ * @return STATUS_CODE_INVALID_ARGS for a message that doesn't exist, or a negative rate
+ */
+StatusCode Telemetry_SetRate(uint8_t id, float rate_hz);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+/**
+ * The u-blox UBX binary protocol. Frames are parsed as bytes arrive, checksummed with a running Fletcher sum, and the
+ * NAV-PVT solution is decoded from them. Kept free of hardware so it can be tested and benchmarked on a host with
+ * captured receiver output. The driver that configures the receiver and uses this is UbloxGps.
+ *
+ * A frame is:
+ *
+ *  [0-1]    sync (0xB5 0x62)
+ *  [2]      class
+ *  [3]      id
+ *  [4-5]    payload length, little endian
+ *  [6-]     payload
+ *  [n-2]    CK_A, CK_B: 8 bit Fletcher checksum over everything from the class to the end of the payload
+ *
+ * All multi-byte fields are little endian
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Status.hpp"
+#include "ByteRing.hpp"
+
+static const uint8_t UBX_SYNC_1 = 0xB5;
+static const uint8_t UBX_SYNC_2 = 0x62;
+static const size_t UBX_FRAME_OVERHEAD = 8; //sync, class, id, length and checksum
+
+static const uint8_t UBX_CLASS_NAV = 0x01;
+static const uint8_t UBX_CLASS_ACK = 0x05;
+static const uint8_t UBX_CLASS_CFG = 0x06;
+
+static const uint8_t UBX_ID_NAV_PVT = 0x07;
+static const uint8_t UBX_ID_ACK_NAK = 0x00;
+static const uint8_t UBX_ID_ACK_ACK = 0x01;
+static const uint8_t UBX_ID_CFG_PRT = 0x00;
+static const uint8_t UBX_ID_CFG_MSG = 0x01;
+static const uint8_t UBX_ID_CFG_RATE = 0x08;
+
+//u-blox 7 receivers send 84 bytes, M8 and later 92. Only the first 84 are used
+static const uint16_t UBX_NAV_PVT_MIN_LEN = 84;
+
+//larger frames (like NAV-SAT) are dropped as soon as their length is read, and the parser looks for the next sync
+static const uint16_t UBX_MAX_PAYLOAD_LEN = 100;
+
+typedef enum UBXFixType {
+	UBX_FIX_NONE = 0,
+	UBX_FIX_DEAD_RECKONING,
+	UBX_FIX_2D,
+	UBX_FIX_3D,
+	UBX_FIX_GNSS_DEAD_RECKONING,
+	UBX_FIX_TIME_ONLY
+} UBXFixType;
+
+/**
+ * Navigation solution. Units are the receiver's own, so nothing is lost converting them
+ */
+typedef struct UBXNavPVT {
+	uint32_t itow_ms; //gps time of week the solution is for
+	uint16_t year;
+	uint8_t month;
+	uint8_t day;
+	uint8_t hour; //utc
+	uint8_t minute;
+	uint8_t second;
+	int32_t nano; //fraction of the second, can be negative
+	bool date_valid;
+	bool time_valid;
+	UBXFixType fix_type;
+	bool fix_ok; //within the accuracy masks the receiver was configured with
+	bool differential; //corrections were applied
+	uint8_t satellites;
+	int32_t longitude; //1e-7 degrees
+	int32_t latitude; //1e-7 degrees
+	int32_t height_mm; //above the ellipsoid
+	int32_t height_msl_mm; //above mean sea level
+	uint32_t horizontal_accuracy_mm;
+	uint32_t vertical_accuracy_mm;
+	int32_t velocity_north_mm_s;
+	int32_t velocity_east_mm_s;
+	int32_t velocity_down_mm_s;
+	int32_t ground_speed_mm_s;
+	int32_t heading_of_motion; //1e-5 degrees
+	uint32_t speed_accuracy_mm_s;
+	uint32_t heading_accuracy; //1e-5 degrees
+	uint16_t pdop; //hundredths
+} UBXNavPVT;
+
+class UBXParser {
+ public:
+	/**
+	 * @param byte
+	 * @return true if byte completed a frame with a good checksum, which is now available through payload()
+	 */
+	bool feed(uint8_t byte);
+
+	/**
+	 * Parses bytes until a frame is completed or they run out
+	 * @param data
+	 * @param len
+	 * @param complete Set to true if a frame was completed
+	 * @return Bytes used up. Less than len if a frame was completed before the end
+	 */
+	size_t feed(const uint8_t *data, size_t len, bool &complete);
+
+	/**
+	 * Parses straight out of a receive ring, consuming what was parsed
+	 * @return true if a frame was completed. Call again until false to drain the ring
+	 */
+	bool feed(ByteRing &ring);
+
+	/**
+	 * The last completed frame. Stays valid until the next call to feed()
+	 */
+	uint8_t message_class() const { return frame_class; }
+	uint8_t message_id() const { return frame_id; }
+	const uint8_t *payload() const { return data; }
+	uint16_t payload_length() const { return length; }
+
+	bool is(uint8_t message_class, uint8_t message_id) const {
+		return frame_class == message_class && frame_id == message_id;
+	}
+
+	/**
+	 * Where the last completed frame's first sync byte was, counting every byte fed since the last reset() from 0
+	 */
+	uint32_t frame_start() const { return start; }
+
+	/**
+	 * Drops any partially received frame, and starts counting bytes from 0 again
+	 */
+	void reset() {
+		state = UBX_SYNC_1_STATE;
+		position = 0;
+	}
+
+	uint32_t checksum_errors() const { return bad_checksums; }
+
+	/**
+	 * @return Frames too large to keep, dropped at their length field
+	 */
+	uint32_t skipped_frames() const { return skipped; }
+
+ private:
+	enum UBXParserState : uint8_t {
+		UBX_SYNC_1_STATE = 0,
+		UBX_SYNC_2_STATE,
+		UBX_CLASS_STATE,
+		UBX_ID_STATE,
+		UBX_LENGTH_LOW_STATE,
+		UBX_LENGTH_HIGH_STATE,
+		UBX_PAYLOAD_STATE,
+		UBX_CK_A_STATE,
+		UBX_CK_B_STATE
+	};
+
+	UBXParserState state = UBX_SYNC_1_STATE;
+	uint8_t frame_class = 0;
+	uint8_t frame_id = 0;
+	uint16_t length = 0;
+	uint16_t received = 0;
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+	uint8_t data[UBX_MAX_PAYLOAD_LEN];
+
+	uint32_t position = 0; //bytes fed since reset()
+	uint32_t start = 0;
+
+	uint32_t bad_checksums = 0;
+	uint32_t skipped = 0;
+
+	bool parse(uint8_t byte);
+};
+
+/**
+ * @param payload A NAV-PVT payload
+ * @param len
+ * @param pvt
+ * @return STATUS_CODE_INVALID_ARGS if the payload is too short. pvt is left untouched in that case
+ */
+StatusCode ubx_decode_nav_pvt(const uint8_t *payload, uint16_t len, UBXNavPVT &pvt);
+
+/**
+ * Wraps a payload into a frame
+ * @param out Must have room for len + UBX_FRAME_OVERHEAD bytes
+ * @return Length of the frame, 0 if it doesn't fit in out
+ */
+size_t ubx_build_frame(uint8_t message_class, uint8_t message_id, const uint8_t *payload, uint16_t len, uint8_t *out,
+					   size_t out_len);
+
+/**
+ * CFG-PRT for the receiver's UART1: 8N1 at baudrate, accepting UBX and NMEA, sending only UBX
+ * @return Length of the frame written to out, 0 if it doesn't fit
+ */
+size_t ubx_build_cfg_prt(uint32_t baudrate, uint8_t *out, size_t out_len);
+
+/**
+ * CFG-RATE: one navigation solution every measurement_period_ms, aligned to gps time
+ * @return Length of the frame written to out, 0 if it doesn't fit
+ */
+size_t ubx_build_cfg_rate(uint16_t measurement_period_ms, uint8_t *out, size_t out_len);
+
+/**
+ * CFG-MSG: how often a message is sent on the port this is received on
+ * @param rate Send every rate solutions, 0 to turn the message off
+ * @return Length of the frame written to out, 0 if it doesn't fit
+ */
+size_t ubx_build_cfg_msg(uint8_t message_class, uint8_t message_id, uint8_t rate, uint8_t *out, size_t out_len);
@@ -0,0 +1,122 @@
+/**
+ * Gps driver for u-blox receivers (7 series and later) over UBX. Init() moves the receiver's uart up to 115200 baud,
+ * turns off its NMEA output and asks for a NAV-PVT solution at 10Hz, which is everything GpsData_t needs in one
+ * 100 byte frame. Received frames go through the uart's dma ring into UBXParser.
+ *
+ * Nothing is saved to the receiver's flash, so it comes back up at 9600 baud with NMEA after a power cycle. If
+ * solutions stop arriving the configuration is sent again, waiting twice as long each time it doesn't help.
+ *
+ * Configuring never waits: frames go out through tx dma, and each step is taken by BeginMeasuring() once the one before
+ * it has had time to go out on the wire and for the receiver to switch baudrates
+ *
+ * Init() and BeginMeasuring() belong to one task, which does all the parsing. Each solution is stamped with when its
+ * first byte came off the wire, worked out from the dma hand over stamps, then published as a Snapshot. GetResult() only
+ * copies the latest one out, so it's quick and safe from any task
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include "gps.hpp"
+#include "UBX.hpp"
+#include "UART.hpp"
+#include "Snapshot.hpp"
+
+static const uint32_t UBLOX_DEFAULT_BAUDRATE = 9600;
+static const uint32_t UBLOX_BAUDRATE = 115200;
+static const uint16_t UBLOX_MEASUREMENT_PERIOD_MS = 100;
+
+//the receiver takes a moment to switch baudrates after acknowledging
+static const uint32_t UBLOX_BAUDRATE_SWITCH_MS = 50;
+
+//10 missed solutions
+static const uint64_t UBLOX_RECONFIGURE_TIMEOUT_US = 1000000;
+
+//how long it's left between tries once the receiver's stopped answering, like when it's unplugged
+static const uint64_t UBLOX_MAX_RECONFIGURE_TIMEOUT_US = 32000000;
+
+static const size_t UBLOX_TX_QUEUE_LEN = 64;
+
+//holds a couple of NAV-PVT frames, in case reading falls behind a cycle
+static const size_t UBLOX_RX_BUFFER_LEN = 256;
+
+typedef enum UbloxConfigStep {
+	UBLOX_CONFIGURED,
+	UBLOX_SENT_AT_DEFAULT_BAUDRATE, //waiting for CFG-PRT to go out at 9600 and the receiver to switch
+	UBLOX_SENT_AT_NEW_BAUDRATE //the same, at 115200 in case it was already there
+} UbloxConfigStep;
+
+class UbloxGps : public Gps {
+ public:
+	explicit UbloxGps(UARTPortNum port);
+
+	/**
+	 * Sets up the uart and starts configuring the receiver. The rest of the configuration is sent by BeginMeasuring()
+	 */
+	void Init(void) override;
+
+	/**
+	 * Parses whatever has been received since the last call, and publishes any new solution. Takes the next configuration
+	 * step when one is due. Call at least as often as the 10Hz solution rate, always from the same task
+	 */
+	void BeginMeasuring(void) override;
+
+	/**
+	 * Copies out the latest published solution, without parsing anything. dataIsNew is tracked for one reader
+	 */
+	void GetResult(GpsData_t *Data) override;
+
+	/**
+	 * Copies out the latest published solution for anyone besides GetResult()'s reader, leaving dataIsNew alone
+	 * @return Solutions published so far, so a change means a new one. 0 if there's nothing yet
+	 */
+	uint32_t read_latest(GpsData_t &data_out) const { return published.read(data_out); }
+
+	/**
+	 * @return The last solution, in the receiver's own units. Only for the task calling BeginMeasuring()
+	 */
+	const UBXNavPVT &latest() const { return pvt; }
+
+	uint32_t checksum_errors() const { return parser.checksum_errors(); }
+
+	/**
+	 * @return CFG messages the receiver rejected
+	 */
+	uint32_t rejected_configurations() const { return naks; }
+
+	/**
+	 * @return How many times the configuration was sent again after solutions stopped arriving
+	 */
+	uint32_t reconfigurations() const { return reconfigured; }
+
+	/**
+	 * @return true until the whole configuration has been sent
+	 */
+	bool configuring() const { return step != UBLOX_CONFIGURED; }
+
+ private:
+	UARTPort port;
+	UBXParser parser;
+	UBXNavPVT pvt;
+	GpsData_t data;
+	Snapshot<GpsData_t> published;
+	uint32_t last_read = 0; //publish count the last GetResult() saw
+
+	uint64_t last_solution_us = 0;
+	uint64_t reconfigure_timeout_us = UBLOX_RECONFIGURE_TIMEOUT_US;
+	uint32_t retries = 0; //configurations sent since the last solution
+	uint32_t naks = 0;
+	uint32_t reconfigured = 0;
+
+	UbloxConfigStep step = UBLOX_CONFIGURED;
+	uint32_t baudrate = UBLOX_DEFAULT_BAUDRATE;
+	uint64_t step_due_us = 0;
+
+	void configure();
+	void step_configuration(uint64_t now_us);
+	void switch_baudrate(uint32_t baudrate);
+	void send_cfg_prt(uint64_t now_us);
+	void send(const uint8_t *frame, size_t len);
+	void convert_solution(uint64_t received_us);
+};
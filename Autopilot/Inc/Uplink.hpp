@@ -0,0 +1,143 @@
+/**
+ * Commands from the ground, on the same link as telemetry and framed the same way (see Telemetry.hpp): COBS encoded
+ * [id][seq][payload][crc16 LE], at most 254 bytes before encoding, ending in a 0.
+ *
+ * They're taken apart by a FramedPort (FramedPort.hpp) as they arrive, straight out of the uart's receive ring, with
+ * the same small amount of work for every byte. A damaged frame is dropped at the next 0, and the stream picks up
+ * again from there.
+ *
+ * Payloads, little endian, floats are IEEE 754 singles:
+ *
+ *  SETPOINT       f32 roll, pitch, yaw rad, f32 airspeed m/s, u16 ms to hold them for, up to UPLINK_MAX_HOLD_MS.
+ *                 0 hands control back to the path manager
+ *  PARAM_SET      u16 UplinkParameter, f32 value
+ *  MISSION_START  u8 transfer, u8 waypoint count, i32 home latitude, longitude 1e-7 deg, i32 home altitude mm
+ *  MISSION_CHUNK  u8 transfer, u8 index of its first waypoint, then up to UPLINK_MAX_CHUNK_WAYPOINTS of: i32 latitude,
+ *                 longitude 1e-7 deg, i32 altitude mm, f32 airspeed m/s
+ *  MISSION_END    u8 transfer
+ *
+ * Every command is answered with a TELEMETRY_ACK carrying its id and sequence number and a StatusCode. For mission
+ * uploads the ack also says how many waypoints have arrived in order, so the ground only ever has to send again
+ * whatever wasn't acked. Chunks can be sent again safely, and a mission is only handed to the planner once it's all
+ * there
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Telemetry.hpp"
+#include "PathManager.hpp"
+#include "GetFromPathManager.hpp"
+#include "Status.hpp"
+
+static const uint16_t UPLINK_SETPOINT_LEN = 18;
+static const uint16_t UPLINK_PARAM_SET_LEN = 6;
+static const uint16_t UPLINK_MISSION_START_LEN = 14;
+static const uint16_t UPLINK_MISSION_CHUNK_HEADER_LEN = 2;
+static const uint16_t UPLINK_WAYPOINT_LEN = 16;
+static const uint16_t UPLINK_MISSION_END_LEN = 1;
+
+static const uint8_t UPLINK_MAX_CHUNK_WAYPOINTS =
+	(TELEMETRY_MAX_PAYLOAD_LEN - UPLINK_MISSION_CHUNK_HEADER_LEN) / UPLINK_WAYPOINT_LEN;
+static const uint16_t UPLINK_MAX_HOLD_MS = 10000; //so losing the link can't leave a setpoint in control for long
+
+typedef enum UplinkMessageId : uint8_t {
+	UPLINK_SETPOINT = 0x40, //clear of telemetry's ids, so a frame looped back can't be taken for a command
+	UPLINK_PARAM_SET,
+	UPLINK_MISSION_START,
+	UPLINK_MISSION_CHUNK,
+	UPLINK_MISSION_END
+} UplinkMessageId;
+
+typedef enum UplinkParameter : uint16_t {
+	//telemetry rates in Hz, one per TelemetryMessageId
+	UPLINK_PARAM_TELEMETRY_RATE = 0,
+	UPLINK_PARAM_TELEMETRY_RATE_LAST = UPLINK_PARAM_TELEMETRY_RATE + TELEMETRY_MESSAGE_COUNT - 1,
+	UPLINK_PARAM_COUNT
+} UplinkParameter;
+
+typedef struct UplinkSetpoint {
+	PMCommands commands;
+	uint16_t hold_ms;
+} UplinkSetpoint;
+
+typedef struct UplinkParameterWrite {
+	uint16_t id; //UplinkParameter
+	float value;
+} UplinkParameterWrite;
+
+typedef struct UplinkMissionStart {
+	uint8_t transfer;
+	uint8_t count;
+	GeoPosition home;
+} UplinkMissionStart;
+
+typedef struct UplinkMissionChunk {
+	uint8_t transfer;
+	uint8_t first;
+	uint8_t count;
+	const uint8_t *waypoints; //count of them, still packed in the frame
+} UplinkMissionChunk;
+
+/**
+ * Each of these checks a payload is the right length and unpacks it
+ * @return false if it isn't
+ */
+bool uplink_parse_setpoint(const uint8_t *payload, size_t len, UplinkSetpoint &setpoint);
+bool uplink_parse_parameter(const uint8_t *payload, size_t len, UplinkParameterWrite &parameter);
+bool uplink_parse_mission_start(const uint8_t *payload, size_t len, UplinkMissionStart &start);
+bool uplink_parse_mission_chunk(const uint8_t *payload, size_t len, UplinkMissionChunk &chunk);
+
+/**
+ * Puts a mission back together from its chunks
+ */
+class UplinkMission {
+ public:
+	UplinkMission();
+
+	/**
+	 * Starts taking a mission. The same start sent again (because its ack was lost) keeps what's already arrived
+	 * @return STATUS_CODE_INVALID_ARGS for fewer than 2 waypoints or more than PATH_MAX_WAYPOINTS
+	 */
+	StatusCode start(const UplinkMissionStart &start);
+
+	/**
+	 * Unpacks a chunk's waypoints into place
+	 * @return STATUS_CODE_UNINITIALIZED if it's not from the mission being taken. STATUS_CODE_OUT_OF_RANGE if it
+	 * leaves a gap after what's arrived, or runs past the end of the mission
+	 */
+	StatusCode add(const UplinkMissionChunk &chunk);
+
+	/**
+	 * @return STATUS_CODE_UNINITIALIZED if it's not the mission being taken. STATUS_CODE_OUT_OF_RANGE if waypoints
+	 * are still missing
+	 */
+	StatusCode finish(uint8_t transfer) const;
+
+	/**
+	 * Marks the mission as handed over, so it isn't handed over again if the end is sent again
+	 */
+	void handed_over() { submitted = true; }
+	bool was_handed_over() const { return submitted; }
+
+	/**
+	 * @return Waypoints that have arrived, in order from the first
+	 */
+	uint8_t received() const { return arrived; }
+
+	const GeoPosition &home() const { return mission_home; }
+	const Waypoint *waypoints() const { return mission; }
+	uint8_t count() const { return expected; }
+
+ private:
+	bool started;
+	bool submitted;
+	uint8_t transfer;
+	uint8_t expected;
+	uint8_t arrived;
+	GeoPosition mission_home;
+	Waypoint mission[PATH_MAX_WAYPOINTS];
+};
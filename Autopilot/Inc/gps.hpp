@@ -7,28 +7,34 @@
 #define	GPS_HPP
 
 #include <stdint.h>
+#include "Position.hpp"
 
 /**
  * Below is the list of available gps sensors, by part number.
  * Uncomment the one that is hooked up to hardware.
  */
 
-// #define NEO_6M // (driver currently unavailable)
-// #define NEO_7P // (driver currently unavailable)
+// #define NEO_6M // (driver currently unavailable, doesn't send NAV-PVT)
+// #define NEO_7P // UbloxGps
+// #define NEO_M8N // UbloxGps
 // #define EMLID_REACH_RTK // (driver currently unavailable)
 
 
 typedef struct
 {
-    long double latitude;  // 8 Bytes
-    long double longitude; // 8 Bytes
+    GeoPosition position; // 12 Bytes. Lat/lon in 1e-7 degrees, altitude in mm above mean sea level
     float utcTime;     // 4 Bytes. Time in seconds since 00:00 (midnight)
     float groundSpeed; // in m/s
-    int altitude; // in m
     int16_t heading; // in degrees. Should be between 0-360 at all times, but using integer just in case
+    float velocityNorth; // in m/s
+    float velocityEast; // in m/s
+    float velocityDown; // in m/s
+    float horizontalAccuracy; // in m. Receiver's estimate of the position error
+    float verticalAccuracy; // in m
     uint8_t numSatellites;    // 1 Byte
 
     uint8_t sensorStatus; // 0 = no fix, 1 = gps fix, 2 = differential gps fix (DGPS) (other codes are possible)
+    uint64_t receivedTimeUs; // get_system_time_us() when the first byte of this solution arrived, for latency compensation
     bool dataIsNew; // true if data has been refreshed since the previous time GetResult was called, false otherwise.
 
 } GpsData_t;
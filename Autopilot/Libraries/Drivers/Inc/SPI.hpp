@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include "Status.hpp"
 #include "GPIO.hpp"
 
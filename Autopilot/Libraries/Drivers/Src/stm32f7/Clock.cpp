@@ -1,15 +1,33 @@
 #include "Clock.hpp"
 #include "Status.hpp"
+#include "Timebase.hpp"
 #include "stm32f7xx_hal.h"
-#include "DMA.hpp"
 
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 
-//for dma idle line detection with uart
-extern DMAConfig uart1_dma_config;
-extern DMAConfig uart2_dma_config;
-extern DMAConfig uart3_dma_config;
-extern DMAConfig uart4_dma_config;
+static TimebaseExtender time_us;
+
+static uint32_t read_time_us_counter() {
+	return TIM5->CNT;
+}
+
+/**
+ * TIM5 is one of the two 32 bit timers, and counts at 1MHz with nothing else to do, so its count is the time in us.
+ * Timers on a divided APB1 bus run at twice its clock
+ */
+static void start_time_us_counter() {
+	__HAL_RCC_TIM5_CLK_ENABLE();
+
+	TIM5->CR1 = 0;
+	TIM5->PSC = 2 * get_peripheral_clock_apb1() / 1000000UL - 1;
+	TIM5->ARR = 0xFFFFFFFF;
+	TIM5->CNT = 0;
+	TIM5->EGR = TIM_EGR_UG; //the prescaler only takes effect after an update
+	TIM5->SR = 0;
+	TIM5->CR1 = TIM_CR1_CEN;
+
+	time_us.reset();
+}
 
 StatusCode initialize_system_clock() {
 	RCC_OscInitTypeDef RCC_OscInitStruct = {0, 0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0}};
@@ -71,6 +89,16 @@ StatusCode initialize_system_clock() {
 	status = get_status_code(HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct));
 	if (status != STATUS_CODE_OK) return status;
 
+	/**Start the DWT cycle counter used by get_cycle_count(). The DWT is locked on the M7 until its lock access
+	 * register is written
+	*/
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	start_time_us_counter();
+
 	return STATUS_CODE_OK;
 }
 
@@ -79,7 +107,15 @@ uint32_t get_lsi_clock() {
 }
 
 uint64_t get_system_time_us() {
-	return (uint64_t) (HAL_GetTick() * 1000ULL + TIM4->CNT / (get_system_clock() / 1000000UL));
+	return time_us.read(read_time_us_counter);
+}
+
+uint32_t get_cycle_count() {
+	return DWT->CYCCNT;
+}
+
+uint32_t get_cycle_count_frequency() {
+	return SystemCoreClock;
 }
 
 /**
@@ -95,38 +131,6 @@ uint64_t get_system_time_us() {
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
 	if (htim->Instance == TIM4) {
 		HAL_IncTick();
-
-		if (uart1_dma_config.timer == 1) {
-			uart1_dma_config.idle_line = 1;
-
-			DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) uart1_dma_config.dma_handle;
-			dma_handle->XferCpltCallback(dma_handle);
-		}
-
-		if (uart2_dma_config.timer == 1) {
-			//call uart2 transfer complete with idle flag on
-			uart2_dma_config.idle_line = 1;
-
-			DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) uart2_dma_config.dma_handle;
-			dma_handle->XferCpltCallback(dma_handle);
-		}
-
-		if (uart3_dma_config.timer == 1) {
-			uart3_dma_config.idle_line = 1;
-
-			DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) uart3_dma_config.dma_handle;
-			dma_handle->XferCpltCallback(dma_handle);
-		}
-
-		if (uart4_dma_config.timer == 1) {
-			uart4_dma_config.idle_line = 1;
-
-			DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) uart4_dma_config.dma_handle;
-			dma_handle->XferCpltCallback(dma_handle);
-		}
-		if (uart1_dma_config.timer) uart1_dma_config.timer--;
-		if (uart2_dma_config.timer) uart2_dma_config.timer--;
-		if (uart3_dma_config.timer) uart3_dma_config.timer--;
-		if (uart4_dma_config.timer) uart4_dma_config.timer--;
+		get_system_time_us(); //makes sure the time is read at least once every half wrap of the us counter
 	}
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "RTOSTrace.h"
+#include "RTOSTraceBuffer.hpp"
+#include "BinaryLog.hpp"
+#include "Clock.hpp"
+#include "stm32f7xx_hal.h"
+#include "cmsis_os.h"
+
+//most recent events kept, at 8 bytes each. Must be a power of two
+static const uint32_t RTOS_TRACE_LEN = 2048;
+
+static RTOSTraceRecord trace_storage[RTOS_TRACE_LEN];
+static RTOSTraceBuffer trace;
+static bool trace_setup = false;
+static std::atomic<uint8_t> next_queue_number(1);
+static volatile bool dump_requested = false;
+
+//the kernel creates a task or queue before anything else can be traced, and by then the clock is running
+static void setup_trace() {
+	if (trace_setup) return;
+
+	trace.init(trace_storage, RTOS_TRACE_LEN, get_cycle_count_frequency());
+	trace_setup = true;
+}
+
+void rtos_trace_record(uint8_t event, uint8_t id, uint16_t arg) {
+	//same as get_cycle_count(), read here directly so the hot path doesn't make another call
+	trace.record(DWT->CYCCNT, event, id, arg);
+}
+
+void rtos_trace_task_created(uint8_t id, const char *name) {
+	setup_trace();
+	trace.set_name(RTOS_TRACE_NAME_TASK, id, name);
+	rtos_trace_record(RTOS_TRACE_TASK_CREATE, id, 0);
+}
+
+uint8_t rtos_trace_queue_created(uint8_t type) {
+	setup_trace();
+	uint8_t id = next_queue_number.fetch_add(1, std::memory_order_relaxed);
+	rtos_trace_record(RTOS_TRACE_QUEUE_CREATE, id, type);
+	return id;
+}
+
+void rtos_trace_queue_named(uint8_t id, const char *name) {
+	trace.set_name(RTOS_TRACE_NAME_QUEUE, id, name);
+}
+
+void rtos_trace_isr_enter(void) {
+	rtos_trace_record(RTOS_TRACE_ISR_ENTER, (uint8_t) __get_IPSR(), 0);
+}
+
+void rtos_trace_isr_exit(void) {
+	rtos_trace_record(RTOS_TRACE_ISR_EXIT, (uint8_t) __get_IPSR(), 0);
+}
+
+void rtos_trace_request_dump(void) {
+	dump_requested = true;
+}
+
+void rtos_trace_service(void) {
+	if (!dump_requested || !trace_setup) return;
+	dump_requested = false;
+
+	//the dump itself would otherwise push the oldest records out while they're being sent
+	trace.pause();
+
+	uint8_t chunk[BINARY_LOG_MAX_ARGS_LEN];
+	size_t offset = 0;
+	size_t len;
+
+	while ((len = trace.read_dump(offset, chunk, sizeof(chunk))) > 0) {
+		//wait for room instead of losing part of the dump
+		while (!binary_log_try_write(BINARY_LOG_TRACE_ID, chunk, (uint8_t) len)) {
+			binary_log_flush();
+			osDelay(1);
+		}
+		offset += len;
+	}
+
+	trace.clear();
+	trace.resume();
+}
@@ -3,7 +3,7 @@
  * on: https://github.com/akospasztor/stm32-dma-uart
  * Which is what this code is based off
  *
- *  Only DMA receive is implemented. Note that UART 3 and 4
+ * DMA transmit goes through a DMATxQueue per port, chained from the transmit complete interrupt. Note that UART 3 and 4
  * are not capable of CTS and RTS!
  */
 #include "UART.hpp"
@@ -11,9 +11,9 @@
 #include "DMA.hpp"
 #include "Status.hpp"
 #include "Debug.hpp"
+#include "BinaryLog.hpp"
 #include "stm32f7xx_hal.h"
 #include <stdlib.h>
-#include <queue>
 
 typedef struct UARTPinSettings {
 	GPIOPort tx_port;
@@ -33,32 +33,55 @@ static UARTPinSettings PIN_SETTINGS[4] = {
 	{GPIO_PORT_D, GPIO_PORT_D, GPIO_PORT_D, GPIO_PORT_D, 0, 1, 0, 0}
 };
 
+//received bytes wait here until they're read. Must be a power of two, and at least as big as the dma buffer
+static const uint32_t UART_RX_RING_LEN = 512;
+
+//bytes waiting to be sent with dma. Must be a power of two
+static const uint32_t UART_TX_QUEUE_LEN = 1024;
+
 //uart 1 defines for enabling DMA
 UART_HandleTypeDef huart1;
 DMA_HandleTypeDef hdma_usart1_rx;
-static std::deque<uint8_t> uart1_rx_queue;
+static uint8_t uart1_rx_storage[UART_RX_RING_LEN];
+static ByteRing uart1_rx_ring;
 DMAConfig uart1_dma_config;
+DMA_HandleTypeDef hdma_usart1_tx;
+static uint8_t uart1_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart1_tx_queue;
 
 //uart 2 defines for enabling DMA
 UART_HandleTypeDef huart2;
 DMA_HandleTypeDef hdma_usart2_rx;
-static std::deque<uint8_t> uart2_rx_queue;
+static uint8_t uart2_rx_storage[UART_RX_RING_LEN];
+static ByteRing uart2_rx_ring;
 DMAConfig uart2_dma_config;
+DMA_HandleTypeDef hdma_usart2_tx;
+static uint8_t uart2_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart2_tx_queue;
 
 //uart 3 defines for enabling DMA
 UART_HandleTypeDef huart3;
 DMA_HandleTypeDef hdma_usart3_rx;
-static std::deque<uint8_t> uart3_rx_queue;
+static uint8_t uart3_rx_storage[UART_RX_RING_LEN];
+static ByteRing uart3_rx_ring;
 DMAConfig uart3_dma_config;
+DMA_HandleTypeDef hdma_usart3_tx;
+static uint8_t uart3_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart3_tx_queue;
 
 //uart 4 defines for enabling DMA
 UART_HandleTypeDef huart4;
 DMA_HandleTypeDef hdma_usart4_rx;
-static std::deque<uint8_t> uart4_rx_queue;
+static uint8_t uart4_rx_storage[UART_RX_RING_LEN];
+static ByteRing uart4_rx_ring;
 DMAConfig uart4_dma_config;
+DMA_HandleTypeDef hdma_usart4_tx;
+static uint8_t uart4_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart4_tx_queue;
 
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 extern const char *get_uart_error_code(uint32_t code);
+extern bool start_uart_dma_transmit(void *context, const uint8_t *data, size_t len);
 void USART1_DMA_ErrorCallback(DMA_HandleTypeDef *dma);
 void USART2_DMA_ErrorCallback(DMA_HandleTypeDef *dma);
 void USART3_DMA_ErrorCallback(DMA_HandleTypeDef *dma);
@@ -229,20 +252,21 @@ StatusCode UARTPort::reset() {
 	return STATUS_CODE_OK;
 }
 
-StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
-	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
-	if (dma_setup_rx || rx_buffer_size == 0) return STATUS_CODE_INVALID_ARGS;
+StatusCode UARTPort::setupRXDMA(size_t rx_buffer_size) {
+	if (rx_buffer_size > UART_RX_RING_LEN) return STATUS_CODE_INVALID_ARGS;
 	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
 
 	DMA_HandleTypeDef *dma_handle;
+	uint8_t *rx_storage = nullptr;
 	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
 
 	if (port == UART_PORT1) {
 		dma_config = &uart1_dma_config;
 		resetDMAConfig(dma_config, rx_buffer_size);
 		dma_config->dma_handle = (void *) &hdma_usart1_rx;
-		dma_config->queue = (void *) &uart1_rx_queue;
-		this->rx_queue = &uart1_rx_queue;
+		dma_config->queue = (void *) &uart1_rx_ring;
+		this->rx_ring = &uart1_rx_ring;
+		rx_storage = uart1_rx_storage;
 
 		dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 
@@ -257,8 +281,9 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 		dma_config = &uart2_dma_config;
 		resetDMAConfig(dma_config, rx_buffer_size);
 		dma_config->dma_handle = (void *) &hdma_usart2_rx;
-		dma_config->queue = (void *) &uart2_rx_queue;
-		this->rx_queue = &uart2_rx_queue;
+		dma_config->queue = (void *) &uart2_rx_ring;
+		this->rx_ring = &uart2_rx_ring;
+		rx_storage = uart2_rx_storage;
 
 		dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 
@@ -273,8 +298,9 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 		dma_config = &uart3_dma_config;
 		resetDMAConfig(dma_config, rx_buffer_size);
 		dma_config->dma_handle = (void *) &hdma_usart3_rx;
-		dma_config->queue = (void *) &uart3_rx_queue;
-		this->rx_queue = &uart3_rx_queue;
+		dma_config->queue = (void *) &uart3_rx_ring;
+		this->rx_ring = &uart3_rx_ring;
+		rx_storage = uart3_rx_storage;
 
 		dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 
@@ -289,8 +315,9 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 		dma_config = &uart4_dma_config;
 		resetDMAConfig(dma_config, rx_buffer_size);
 		dma_config->dma_handle = (void *) &hdma_usart4_rx;
-		dma_config->queue = (void *) &uart4_rx_queue;
-		this->rx_queue = &uart4_rx_queue;
+		dma_config->queue = (void *) &uart4_rx_ring;
+		this->rx_ring = &uart4_rx_ring;
+		rx_storage = uart4_rx_storage;
 
 		dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 
@@ -303,7 +330,12 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 		HAL_NVIC_SetPriority(DMA1_Stream2_IRQn, 5, 0);
 	}
 
-	dma_config->timeout = 50; //set 50ms idle timeout for all uart transactions
+	//keep whatever was already received if we're only re-setting up after an error
+	if (reallocate_dma_buffer) {
+		rx_ring->init(rx_storage, UART_RX_RING_LEN);
+		resetDMARXStamps(dma_config);
+	}
+
 	dma_handle->Init.Direction = DMA_PERIPH_TO_MEMORY;
 	dma_handle->Init.PeriphInc = DMA_PINC_DISABLE;
 	dma_handle->Init.MemInc = DMA_MINC_ENABLE;
@@ -330,9 +362,6 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 		return STATUS_CODE_RESOURCE_EXHAUSTED;
 	}
 
-	//disable the DMA half interrupt since we're using idle line detection instead
-	__HAL_DMA_DISABLE_IT(dma_handle, DMA_IT_HT);
-
 	//enable uart idle line interrupt
 	SET_BIT(uart_handle->Instance->CR1, USART_CR1_IDLEIE);
 
@@ -363,9 +392,8 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 	return status;
 }
 
-StatusCode UARTPort::resetDMA() {
+StatusCode UARTPort::resetRXDMA() {
 	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
-	if (!dma_setup_rx) return STATUS_CODE_INVALID_ARGS;
 
 	auto dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
@@ -398,7 +426,7 @@ StatusCode UARTPort::resetDMA() {
 		if (dma_config->dma_buffer == nullptr) abort("uart dma buffer null!", __FILE__, __LINE__);
 		free(dma_config->dma_buffer);
 		dma_config->dma_buffer = nullptr;
-		rx_queue->erase(rx_queue->begin(), rx_queue->end());
+		rx_ring->clear();
 	}
 
 	dma_setup_rx = false;
@@ -406,83 +434,197 @@ StatusCode UARTPort::resetDMA() {
 	return STATUS_CODE_OK;
 }
 
-//Below code based off: https://github.com/akospasztor/stm32-dma-uart/blob/master/Src/main.c
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-	if (huart->Instance == USART1) {
-		processDMARXCompleteEvent(&uart1_dma_config);
-	} else if (huart->Instance == USART2) {
-		processDMARXCompleteEvent(&uart2_dma_config);
-	} else if (huart->Instance == USART3) {
-		processDMARXCompleteEvent(&uart3_dma_config);
-	} else if (huart->Instance == UART4) {
-		processDMARXCompleteEvent(&uart4_dma_config);
+StatusCode UARTPort::setupTXDMA(size_t tx_buffer_size) {
+	if (tx_buffer_size > UART_TX_QUEUE_LEN) return STATUS_CODE_INVALID_ARGS;
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	DMA_HandleTypeDef *dma_handle;
+	uint8_t *tx_storage;
+	IRQn_Type uart_irq;
+	IRQn_Type dma_irq;
+	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
+
+	if (port == UART_PORT1) {
+		dma_handle = &hdma_usart1_tx;
+		tx_queue = &uart1_tx_queue;
+		tx_storage = uart1_tx_storage;
+		dma_handle->Instance = DMA2_Stream7;
+		uart_irq = USART1_IRQn;
+		dma_irq = DMA2_Stream7_IRQn;
+	} else if (port == UART_PORT2) {
+		dma_handle = &hdma_usart2_tx;
+		tx_queue = &uart2_tx_queue;
+		tx_storage = uart2_tx_storage;
+		dma_handle->Instance = DMA1_Stream6;
+		uart_irq = USART2_IRQn;
+		dma_irq = DMA1_Stream6_IRQn;
+	} else if (port == UART_PORT3) {
+		dma_handle = &hdma_usart3_tx;
+		tx_queue = &uart3_tx_queue;
+		tx_storage = uart3_tx_storage;
+		dma_handle->Instance = DMA1_Stream3;
+		uart_irq = USART3_IRQn;
+		dma_irq = DMA1_Stream3_IRQn;
+	} else {
+		dma_handle = &hdma_usart4_tx;
+		tx_queue = &uart4_tx_queue;
+		tx_storage = uart4_tx_storage;
+		dma_handle->Instance = DMA1_Stream4;
+		uart_irq = UART4_IRQn;
+		dma_irq = DMA1_Stream4_IRQn;
+	}
+
+	//keep whatever is still waiting to go out if we're only re-setting up after an error
+	if (reallocate_dma_buffer) {
+		StatusCode status = tx_queue->init(tx_storage, UART_TX_QUEUE_LEN, start_uart_dma_transmit, uart_handle);
+		if (status != STATUS_CODE_OK) return status;
 	}
+
+	dma_handle->Init.Channel = DMA_CHANNEL_4;
+	dma_handle->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	dma_handle->Init.PeriphInc = DMA_PINC_DISABLE;
+	dma_handle->Init.MemInc = DMA_MINC_ENABLE;
+	dma_handle->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	dma_handle->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	dma_handle->Init.Mode = DMA_NORMAL;
+	dma_handle->Init.Priority = DMA_PRIORITY_LOW;
+	dma_handle->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	StatusCode status = get_status_code(HAL_DMA_Init(dma_handle));
+	if (status != STATUS_CODE_OK) return status;
+
+	__HAL_LINKDMA(uart_handle, hdmatx, (*dma_handle));
+
+	//the transmit complete callback comes from the uart interrupt, once the last byte has left the shift register
+	HAL_NVIC_SetPriority(uart_irq, 5, 0);
+	HAL_NVIC_SetPriority(dma_irq, 5, 0);
+	HAL_NVIC_EnableIRQ(uart_irq);
+	HAL_NVIC_EnableIRQ(dma_irq);
+
+	dma_setup_tx = true;
+
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::resetTXDMA() {
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
+
+	HAL_UART_AbortTransmit(uart_handle);
+
+	switch (port) {
+		case UART_PORT1:HAL_NVIC_DisableIRQ(DMA2_Stream7_IRQn);
+			break;
+		case UART_PORT2:HAL_NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+			break;
+		case UART_PORT3:HAL_NVIC_DisableIRQ(DMA1_Stream3_IRQn);
+			break;
+		case UART_PORT4:HAL_NVIC_DisableIRQ(DMA1_Stream4_IRQn);
+			break;
+		default:break;
+	}
+
+	StatusCode status = get_status_code(HAL_DMA_DeInit(uart_handle->hdmatx));
+	if (status != STATUS_CODE_OK) return status;
+
+	//whatever was being sent goes out again from the start once the dma is back up
+	if (reallocate_dma_buffer) {
+		tx_queue->clear();
+	} else {
+		tx_queue->transfer_aborted();
+	}
+
+	dma_setup_tx = false;
+
+	return STATUS_CODE_OK;
+}
+
+static DMATxQueue *get_tx_queue(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) return &uart1_tx_queue;
+	if (huart->Instance == USART2) return &uart2_tx_queue;
+	if (huart->Instance == USART3) return &uart3_tx_queue;
+	if (huart->Instance == UART4) return &uart4_tx_queue;
+	return nullptr;
+}
+
+static DMAConfig *get_rx_dma_config(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) return &uart1_dma_config;
+	if (huart->Instance == USART2) return &uart2_dma_config;
+	if (huart->Instance == USART3) return &uart3_dma_config;
+	if (huart->Instance == UART4) return &uart4_dma_config;
+	return nullptr;
+}
+
+//the idle line interrupts (in stm32f7xx_it.c) deliver data as soon as the sender pauses, these two only make sure
+//it's picked up before the dma overwrites it on a long burst
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+	DMAConfig *config = get_rx_dma_config(huart);
+	if (config != nullptr) processDMARXEvent(config);
 }
 void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
-	error("half called");
-	UNUSED(huart);
+	DMAConfig *config = get_rx_dma_config(huart);
+	if (config != nullptr) processDMARXEvent(config);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+	DMATxQueue *queue = get_tx_queue(huart);
+	if (queue != nullptr) queue->transfer_complete();
 }
 
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
-	char buffer[50];
+	//a dma error stops the transmit part way. The queue resends that region on the next transmit
+	if (huart->gState == HAL_UART_STATE_READY) {
+		DMATxQueue *queue = get_tx_queue(huart);
+		if (queue != nullptr) queue->transfer_aborted();
+	}
+
+	//runs in the uart interrupt, so only the binary log is safe to use here
 	if (huart->Instance == USART1) {
-		sprintf(buffer,
-				"USART1 Error received. Code: %lu Type: %s",
-				huart->ErrorCode,
-				get_uart_error_code(huart->ErrorCode));
-		error(buffer);
+		LOG_ERROR("USART1 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
 		uart1_dma_config.reset = true;
 	} else if (huart->Instance == USART2) {
-		sprintf(buffer,
-				"USART2 Error received. Code: %lu Type: %s",
-				huart->ErrorCode,
-				get_uart_error_code(huart->ErrorCode));
-		error(buffer);
+		LOG_ERROR("USART2 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
 		uart2_dma_config.reset = true;
 	} else if (huart->Instance == USART3) {
-		sprintf(buffer,
-				"USART3 Error received. Code: %lu Type: %s",
-				huart->ErrorCode,
-				get_uart_error_code(huart->ErrorCode));
-		error(buffer);
+		LOG_ERROR("USART3 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
 		uart3_dma_config.reset = true;
 	} else if (huart->Instance == UART4) {
-		sprintf(buffer,
-				"USART4 Error received. Code: %lu Type: %s",
-				huart->ErrorCode,
-				get_uart_error_code(huart->ErrorCode));
-		error(buffer);
+		LOG_ERROR("USART4 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
 		uart4_dma_config.reset = true;
 	} else {
-		error("Unknown USART port got an error callback");
+		LOG_ERROR("Unknown USART port got an error callback");
 	}
 }
 
 void USART1_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("USART 1 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("USART 1 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void USART2_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("USART 2 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("USART 2 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void USART3_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("USART 3 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("USART 3 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void USART4_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("USART 4 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("USART 4 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void HAL_UART_AbortCpltCallback(UART_HandleTypeDef *huart) {
 	if (huart->Instance == USART1) {
-		error("USART1 Abort received");
+		LOG_ERROR("USART1 Abort received");
 	} else if (huart->Instance == USART2) {
-		error("USART2 Abort received");
+		LOG_ERROR("USART2 Abort received");
 	} else if (huart->Instance == USART3) {
-		error("USART3 Abort received");
+		LOG_ERROR("USART3 Abort received");
 	} else if (huart->Instance == UART4) {
-		error("USART4 Abort received");
+		LOG_ERROR("USART4 Abort received");
 	}
 }
 
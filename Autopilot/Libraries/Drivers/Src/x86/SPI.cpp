@@ -0,0 +1,77 @@
+/**
+ * Host spi. Exchanges go to the device attached at the selected slave, and read back all ones (a floating miso) if
+ * there isn't one
+ */
+
+#include "SPI.hpp"
+#include "HostDevices.hpp"
+#include <vector>
+#include <string.h>
+
+SPIPort::SPIPort(SPISettings settings) {
+	this->settings = settings;
+}
+
+StatusCode SPIPort::setup() {
+	if (has_setup || (uint32_t) settings.port >= HOST_SPI_PORTS) return STATUS_CODE_INVALID_ARGS;
+
+	has_setup = true;
+	return STATUS_CODE_OK;
+}
+
+int32_t SPIPort::add_slave(GPIOPin slave_pin) {
+	if (!has_setup) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+	if (num_slaves == MAX_SPI_SLAVES) {
+		return -1;
+	}
+
+	slaves[num_slaves] = slave_pin;
+	num_slaves++;
+	return num_slaves - 1;
+}
+
+StatusCode SPIPort::set_slave(uint32_t slave_num) {
+	if (!has_setup || slave_num >= num_slaves) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	slaves[curr_slave].set_state(GPIO_STATE_LOW);
+	slaves[slave_num].set_state(GPIO_STATE_HIGH);
+	curr_slave = slave_num;
+	return STATUS_CODE_OK;
+}
+
+StatusCode SPIPort::exchange_data(uint8_t *tx_data, uint8_t *rx_data, size_t length) {
+	if (!has_setup || (tx_data == nullptr && rx_data == nullptr)) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	HostSPIDevice *device = host_spi_device((uint8_t) settings.port, curr_slave);
+
+	//one way transfers still clock a byte in each direction
+	std::vector<uint8_t> filler;
+	if (tx_data == nullptr || rx_data == nullptr) filler.assign(length, 0);
+	const uint8_t *tx = (tx_data != nullptr) ? tx_data : filler.data();
+	uint8_t *rx = (rx_data != nullptr) ? rx_data : filler.data();
+
+	if (device == nullptr) {
+		memset(rx, 0xFF, length);
+		return STATUS_CODE_OK;
+	}
+
+	//every exchange is a transaction of its own, with chip select toggled around it
+	device->select();
+	device->exchange(tx, rx, length);
+	return STATUS_CODE_OK;
+}
+
+StatusCode SPIPort::reset() {
+	if (!has_setup) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	has_setup = false;
+	return STATUS_CODE_OK;
+}
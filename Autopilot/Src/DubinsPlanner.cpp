@@ -0,0 +1,385 @@
+#include "DubinsPlanner.hpp"
+#include <math.h>
+
+static const float GRAVITY = 9.80665f;
+static const float TWO_PI = 2.0f * (float) M_PI;
+
+//closer than this two waypoints count as the same place, like legs in PathManager
+static const float MIN_SEPARATION = 1.0f;
+
+//and two turn centres count as the same circle
+static const float SAME_CENTRE = 1e-3f;
+
+//a turn this close to a full circle is really no turn, with rounding
+static const float FULL_TURN = TWO_PI - 1e-4f;
+
+//the turns making up each kind of Dubins path, 1 clockwise, -1 anticlockwise and 0 straight
+static const uint8_t DUBINS_WORDS = 6;
+static const int8_t WORD_TURNS[DUBINS_WORDS][3] = {
+	{1, 0, 1}, //RSR
+	{-1, 0, -1}, //LSL
+	{1, 0, -1}, //RSL
+	{-1, 0, 1}, //LSR
+	{1, -1, 1}, //RLR
+	{-1, 1, -1}, //LRL
+};
+
+typedef struct Point {
+	float north;
+	float east;
+} Point;
+
+//one way of getting between the poses, with everything needed to turn it into segments
+typedef struct DubinsCandidate {
+	int8_t turns[3];
+	Point centres[3]; //the middle one is only used when it's a turn
+	Point tangents[2]; //where the first part ends and where the last part starts
+	float sweeps[3]; //rad round each turn, or m along the straight
+	float length;
+} DubinsCandidate;
+
+static inline float wrap_angle(float angle) {
+	if (angle > (float) M_PI) return angle - TWO_PI;
+	if (angle < -(float) M_PI) return angle + TWO_PI;
+	return angle;
+}
+
+static inline float bearing(const Point &from, const Point &to) {
+	return atan2f(to.east - from.east, to.north - from.north);
+}
+
+//the centre of the turn the pose is on, to its right for clockwise turns
+static inline Point turn_centre(const DubinsPose &pose, int8_t turn, float radius) {
+	Point centre = {pose.north - turn * radius * sinf(pose.course), pose.east + turn * radius * cosf(pose.course)};
+	return centre;
+}
+
+//rad round the circle from one point on it to another, going the way turn says
+static float sweep(const Point &centre, const Point &from, const Point &to, int8_t turn) {
+	float angle = turn * (bearing(centre, to) - bearing(centre, from));
+	while (angle < 0) angle += TWO_PI;
+	while (angle >= TWO_PI) angle -= TWO_PI;
+	return angle > FULL_TURN ? 0 : angle;
+}
+
+//a turn, a straight and a turn. The straight is tangent to both circles, on the outside when they turn the same way
+static bool turn_straight_turn(const Point &start, const Point &end, float start_course, float radius,
+							   DubinsCandidate &candidate) {
+	int8_t first = candidate.turns[0];
+	int8_t last = candidate.turns[2];
+	const Point &c1 = candidate.centres[0];
+	const Point &c2 = candidate.centres[2];
+
+	float v_north = c2.north - c1.north;
+	float v_east = c2.east - c1.east;
+	float distance = sqrtf(v_north * v_north + v_east * v_east);
+
+	float straight;
+	float u_north;
+	float u_east;
+
+	if (first == last) {
+		straight = distance;
+		if (distance < SAME_CENTRE) {
+			//the same circle, it's just the one turn
+			u_north = cosf(start_course);
+			u_east = sinf(start_course);
+		} else {
+			u_north = v_north / distance;
+			u_east = v_east / distance;
+		}
+	} else {
+		if (distance < 2.0f * radius) return false;
+		straight = sqrtf(distance * distance - 4.0f * radius * radius);
+		float offset = 2.0f * first * radius;
+		u_north = (straight * v_north - offset * v_east) / (distance * distance);
+		u_east = (offset * v_north + straight * v_east) / (distance * distance);
+	}
+
+	//on a clockwise circle the centre is to the right of the direction of travel
+	candidate.tangents[0].north = c1.north + first * radius * u_east;
+	candidate.tangents[0].east = c1.east - first * radius * u_north;
+	candidate.tangents[1].north = candidate.tangents[0].north + straight * u_north;
+	candidate.tangents[1].east = candidate.tangents[0].east + straight * u_east;
+
+	candidate.sweeps[0] = sweep(c1, start, candidate.tangents[0], first);
+	candidate.sweeps[1] = straight;
+	candidate.sweeps[2] = sweep(c2, candidate.tangents[1], end, last);
+	candidate.length = radius * (candidate.sweeps[0] + candidate.sweeps[2]) + straight;
+	return true;
+}
+
+//three turns, the middle one the other way and touching both of the others. It can sit on either side
+static bool turn_turn_turn(const Point &start, const Point &end, float radius, bool left_side,
+						   DubinsCandidate &candidate) {
+	const Point &c1 = candidate.centres[0];
+	const Point &c2 = candidate.centres[2];
+
+	float v_north = c2.north - c1.north;
+	float v_east = c2.east - c1.east;
+	float distance = sqrtf(v_north * v_north + v_east * v_east);
+	if (distance > 4.0f * radius || distance < SAME_CENTRE) return false;
+
+	float offset = sqrtf(4.0f * radius * radius - 0.25f * distance * distance) / distance;
+	if (left_side) offset = -offset;
+
+	Point &c3 = candidate.centres[1];
+	c3.north = 0.5f * (c1.north + c2.north) - offset * v_east;
+	c3.east = 0.5f * (c1.east + c2.east) + offset * v_north;
+
+	candidate.tangents[0].north = 0.5f * (c1.north + c3.north);
+	candidate.tangents[0].east = 0.5f * (c1.east + c3.east);
+	candidate.tangents[1].north = 0.5f * (c3.north + c2.north);
+	candidate.tangents[1].east = 0.5f * (c3.east + c2.east);
+
+	candidate.sweeps[0] = sweep(c1, start, candidate.tangents[0], candidate.turns[0]);
+	candidate.sweeps[1] = sweep(c3, candidate.tangents[0], candidate.tangents[1], candidate.turns[1]);
+	candidate.sweeps[2] = sweep(c2, candidate.tangents[1], end, candidate.turns[2]);
+	candidate.length = radius * (candidate.sweeps[0] + candidate.sweeps[1] + candidate.sweeps[2]);
+	return true;
+}
+
+static void arc_segment(const Point &centre, const Point &start, int8_t turn, float radius, float angle,
+						PathSegment &segment) {
+	float start_bearing = bearing(centre, start);
+
+	segment.kind = PATH_ARC;
+	segment.start_north = start.north;
+	segment.start_east = start.east;
+	segment.direction_north = -turn * sinf(start_bearing);
+	segment.direction_east = turn * cosf(start_bearing);
+	segment.course = atan2f(segment.direction_east, segment.direction_north);
+	segment.length = radius * angle;
+	segment.centre_north = centre.north;
+	segment.centre_east = centre.east;
+	segment.radius = radius;
+	segment.start_bearing = start_bearing;
+	segment.turn = turn;
+}
+
+static void line_segment(const Point &start, const Point &end, float length, PathSegment &segment) {
+	segment.kind = PATH_LINE;
+	segment.start_north = start.north;
+	segment.start_east = start.east;
+	segment.direction_north = (end.north - start.north) / length;
+	segment.direction_east = (end.east - start.east) / length;
+	segment.course = atan2f(segment.direction_east, segment.direction_north);
+	segment.length = length;
+	segment.centre_north = 0;
+	segment.centre_east = 0;
+	segment.radius = 0;
+	segment.start_bearing = 0;
+	segment.turn = 0;
+}
+
+float planner_turn_radius(float airspeed) {
+	return airspeed * airspeed / (GRAVITY * tanf(PLANNER_ROLL_RAD));
+}
+
+uint8_t dubins_path(const DubinsPose &from, const DubinsPose &to, float radius, PathSegment *segments,
+					float &length) {
+	Point start = {from.north, from.east};
+	Point end = {to.north, to.east};
+
+	DubinsCandidate best;
+	best.length = INFINITY;
+
+	for (uint8_t word = 0; word < DUBINS_WORDS; word++) {
+		DubinsCandidate candidate;
+		for (uint8_t i = 0; i < 3; i++) candidate.turns[i] = WORD_TURNS[word][i];
+		candidate.centres[0] = turn_centre(from, candidate.turns[0], radius);
+		candidate.centres[2] = turn_centre(to, candidate.turns[2], radius);
+
+		if (candidate.turns[1] == 0) {
+			if (turn_straight_turn(start, end, from.course, radius, candidate) && candidate.length < best.length) {
+				best = candidate;
+			}
+		} else {
+			for (uint8_t side = 0; side < 2; side++) {
+				if (turn_turn_turn(start, end, radius, side == 1, candidate) && candidate.length < best.length) {
+					best = candidate;
+				}
+			}
+		}
+	}
+
+	length = 0;
+	if (best.length == INFINITY) return 0;
+	length = best.length;
+
+	//the three parts, leaving out any that are too short to fly
+	Point starts[3] = {start, best.tangents[0], best.tangents[1]};
+	Point ends[3] = {best.tangents[0], best.tangents[1], end};
+	uint8_t count = 0;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		if (best.turns[i] == 0) {
+			if (best.sweeps[i] < PATH_MIN_PLANNED_LENGTH) continue;
+			line_segment(starts[i], ends[i], best.sweeps[i], segments[count++]);
+		} else {
+			if (radius * best.sweeps[i] < PATH_MIN_PLANNED_LENGTH) continue;
+			arc_segment(best.centres[i], starts[i], best.turns[i], radius, best.sweeps[i], segments[count++]);
+		}
+	}
+
+	return count;
+}
+
+DubinsPlanner::DubinsPlanner() {
+	cancel();
+}
+
+void DubinsPlanner::cancel() {
+	planner_state = PLANNER_IDLE;
+	waypoint_count = 0;
+	next_leg = 0;
+	returning = false;
+	segments_used = 0;
+}
+
+void DubinsPlanner::start() {
+	planner_state = PLANNER_WORKING;
+	next_leg = 0;
+	segments_used = 0;
+}
+
+StatusCode DubinsPlanner::start_mission(const GeoPosition &home, const Waypoint *mission, uint8_t count) {
+	cancel();
+
+	if (mission == nullptr || count < 2 || count > PATH_MAX_WAYPOINTS) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		if (!(mission[i].airspeed > 0)) return STATUS_CODE_INVALID_ARGS;
+		waypoints[i] = mission[i];
+	}
+
+	local.set_reference(home);
+	waypoint_count = count;
+	returning = false;
+
+	//the mission starts at the first waypoint, pointed at the second
+	NEDPosition first = local.to_ned(waypoints[0].position);
+	NEDPosition second = local.to_ned(waypoints[1].position);
+	leg_start.north = first.north;
+	leg_start.east = first.east;
+	leg_start.course = atan2f(second.east - first.east, second.north - first.north);
+	leg_start_down = first.down;
+
+	start();
+	return STATUS_CODE_OK;
+}
+
+StatusCode DubinsPlanner::start_return(const GeoPosition &position, float course, const GeoPosition &home,
+									   float airspeed, float radius) {
+	cancel();
+
+	if (!(airspeed > 0) || !(radius > 0)) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	local.set_reference(home);
+	returning = true;
+	return_airspeed = airspeed;
+	loiter_radius = radius;
+
+	NEDPosition ned = local.to_ned(position);
+	leg_start.north = ned.north;
+	leg_start.east = ned.east;
+	leg_start.course = course;
+	leg_start_down = ned.down;
+
+	start();
+	return STATUS_CODE_OK;
+}
+
+PlannerState DubinsPlanner::step() {
+	if (planner_state != PLANNER_WORKING) return planner_state;
+
+	planner_state = returning ? step_return() : step_mission();
+	return planner_state;
+}
+
+//plans from the end of the last leg to the pose given, climbing evenly the whole way
+void DubinsPlanner::add_leg(const DubinsPose &to, float to_down, float airspeed) {
+	float length;
+	uint8_t count = dubins_path(leg_start, to, planner_turn_radius(airspeed), &segments[segments_used], length);
+
+	float climb = length > 0 ? (to_down - leg_start_down) / length : 0;
+	float down = leg_start_down;
+
+	for (uint8_t i = 0; i < count; i++) {
+		PathSegment &segment = segments[segments_used + i];
+		segment.start_down = down;
+		segment.climb = climb;
+		segment.flight_path_angle = atanf(-climb);
+		segment.switch_distance = 0;
+		segment.airspeed = airspeed;
+		down += segment.length * climb;
+	}
+
+	segments_used += count;
+	leg_start = to;
+	leg_start_down = to_down;
+}
+
+PlannerState DubinsPlanner::step_mission() {
+	uint8_t end = next_leg + 1;
+	NEDPosition end_ned = local.to_ned(waypoints[end].position);
+
+	float in_north = end_ned.north - leg_start.north;
+	float in_east = end_ned.east - leg_start.east;
+	float in_length = sqrtf(in_north * in_north + in_east * in_east);
+	if (in_length < MIN_SEPARATION) return PLANNER_FAILED;
+
+	//through the end waypoint halfway between this leg's direction and the next one's
+	DubinsPose to = {end_ned.north, end_ned.east, atan2f(in_east, in_north)};
+	if (end + 1 < waypoint_count) {
+		NEDPosition after = local.to_ned(waypoints[end + 1].position);
+		float out_north = after.north - end_ned.north;
+		float out_east = after.east - end_ned.east;
+		float out_length = sqrtf(out_north * out_north + out_east * out_east);
+		if (out_length < MIN_SEPARATION) return PLANNER_FAILED;
+
+		float sum_north = in_north / in_length + out_north / out_length;
+		float sum_east = in_east / in_length + out_east / out_length;
+
+		//turning straight back, there's no halfway, so go out the way the next leg does
+		if (sum_north * sum_north + sum_east * sum_east < 1e-6f) {
+			to.course = atan2f(out_east, out_north);
+		} else {
+			to.course = atan2f(sum_east, sum_north);
+		}
+	}
+
+	add_leg(to, end_ned.down, waypoints[end].airspeed);
+	next_leg++;
+
+	return end + 1 < waypoint_count ? PLANNER_WORKING : PLANNER_DONE;
+}
+
+PlannerState DubinsPlanner::step_return() {
+	float radius = planner_turn_radius(return_airspeed);
+	if (loiter_radius < radius) loiter_radius = radius;
+
+	//onto the circle at the point nearest the aircraft, going clockwise
+	float distance = sqrtf(leg_start.north * leg_start.north + leg_start.east * leg_start.east);
+	float entry_bearing = distance < MIN_SEPARATION ? 0 : atan2f(leg_start.east, leg_start.north);
+
+	Point centre = {0, 0};
+	Point entry = {loiter_radius * cosf(entry_bearing), loiter_radius * sinf(entry_bearing)};
+	DubinsPose to = {entry.north, entry.east, wrap_angle(entry_bearing + 0.5f * (float) M_PI)};
+
+	add_leg(to, 0, return_airspeed);
+
+	PathSegment &loiter = segments[segments_used++];
+	arc_segment(centre, entry, 1, loiter_radius, 0, loiter);
+	loiter.kind = PATH_LOITER;
+	loiter.start_down = 0;
+	loiter.climb = 0;
+	loiter.flight_path_angle = 0;
+	loiter.switch_distance = 0;
+	loiter.airspeed = return_airspeed;
+
+	return PLANNER_DONE;
+}
@@ -0,0 +1,346 @@
+#include "Geofence.hpp"
+#include <float.h>
+#include <math.h>
+
+//cells per polygon, as a multiple of its vertex count
+static const uint16_t CELLS_PER_VERTEX = 2;
+static const uint16_t MIN_POLYGON_CELLS = 16;
+static const uint16_t MAX_POLYGON_CELLS = 1024;
+static const uint8_t MAX_GRID_SIDE = 64;
+
+static const uint32_t GRID_PADDING = 1;
+
+//cells list every edge this many cell widths from them, so distances up to that are exact
+static const float EXACT_CELLS = 0.5f;
+
+static inline float min_of(float a, float b) { return a < b ? a : b; }
+static inline float max_of(float a, float b) { return a > b ? a : b; }
+
+static float segment_distance_squared(float north, float east, float a_north, float a_east, float b_north,
+									  float b_east) {
+	float edge_north = b_north - a_north;
+	float edge_east = b_east - a_east;
+	float length_squared = edge_north * edge_north + edge_east * edge_east;
+
+	float t = 0;
+	if (length_squared > 0) {
+		t = ((north - a_north) * edge_north + (east - a_east) * edge_east) / length_squared;
+		t = t < 0 ? 0 : (t > 1 ? 1 : t);
+	}
+
+	float offset_north = a_north + t * edge_north - north;
+	float offset_east = a_east + t * edge_east - east;
+	return offset_north * offset_north + offset_east * offset_east;
+}
+
+//which side of a -> b the point is on
+static inline float orientation(float a_north, float a_east, float b_north, float b_east, float north, float east) {
+	return (b_north - a_north) * (east - a_east) - (b_east - a_east) * (north - a_north);
+}
+
+static inline bool segments_cross(float p_north, float p_east, float q_north, float q_east, float a_north,
+								  float a_east, float b_north, float b_east) {
+	float side_p = orientation(a_north, a_east, b_north, b_east, p_north, p_east);
+	float side_q = orientation(a_north, a_east, b_north, b_east, q_north, q_east);
+	float side_a = orientation(p_north, p_east, q_north, q_east, a_north, a_east);
+	float side_b = orientation(p_north, p_east, q_north, q_east, b_north, b_east);
+	return ((side_p > 0) != (side_q > 0)) && ((side_a > 0) != (side_b > 0));
+}
+
+typedef struct Box {
+	float min_north;
+	float min_east;
+	float max_north;
+	float max_east;
+} Box;
+
+static float box_distance_squared(const Box &box, float north, float east) {
+	float outside_north = max_of(max_of(box.min_north - north, north - box.max_north), 0);
+	float outside_east = max_of(max_of(box.min_east - east, east - box.max_east), 0);
+	return outside_north * outside_north + outside_east * outside_east;
+}
+
+static inline bool box_contains(const Box &box, float north, float east) {
+	return north >= box.min_north && north <= box.max_north && east >= box.min_east && east <= box.max_east;
+}
+
+static float box_segment_min_distance_squared(const Box &box, float a_north, float a_east, float b_north,
+											  float b_east) {
+	if (box_contains(box, a_north, a_east) || box_contains(box, b_north, b_east)) return 0;
+
+	float corners[4][2] = {
+		{box.min_north, box.min_east}, {box.min_north, box.max_east},
+		{box.max_north, box.max_east}, {box.max_north, box.min_east}
+	};
+
+	float best = min_of(box_distance_squared(box, a_north, a_east), box_distance_squared(box, b_north, b_east));
+	for (int i = 0; i < 4; i++) {
+		const float *from = corners[i];
+		const float *to = corners[(i + 1) % 4];
+		if (segments_cross(from[0], from[1], to[0], to[1], a_north, a_east, b_north, b_east)) return 0;
+		best = min_of(best, segment_distance_squared(from[0], from[1], a_north, a_east, b_north, b_east));
+	}
+	return best;
+}
+
+Geofence::Geofence() {
+	GeoPosition origin = {0, 0, 0};
+	clear(origin);
+}
+
+void Geofence::clear(const GeoPosition &home) {
+	local.set_reference(home);
+	zones_used = 0;
+	vertices_used = 0;
+	cells_used = 0;
+	cell_edges_used = 0;
+	has_altitude_limits = false;
+	floor_down = 0;
+	ceiling_down = 0;
+}
+
+StatusCode Geofence::add_polygon(GeofenceKind kind, const GeoPosition *vertices, uint16_t count) {
+	if (vertices == nullptr || count < 3) return STATUS_CODE_INVALID_ARGS;
+	if (zones_used >= GEOFENCE_MAX_ZONES || count > GEOFENCE_MAX_VERTICES - vertices_used) {
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	GeofenceZone &zone = zones[zones_used];
+	zone.kind = kind;
+	zone.is_circle = false;
+	zone.first_vertex = vertices_used;
+	zone.vertex_count = count;
+	zone.min_north = FLT_MAX;
+	zone.min_east = FLT_MAX;
+	zone.max_north = -FLT_MAX;
+	zone.max_east = -FLT_MAX;
+
+	for (uint16_t i = 0; i < count; i++) {
+		NEDPosition ned = local.to_ned(vertices[i]);
+		vertex_north[vertices_used + i] = ned.north;
+		vertex_east[vertices_used + i] = ned.east;
+		zone.min_north = min_of(zone.min_north, ned.north);
+		zone.min_east = min_of(zone.min_east, ned.east);
+		zone.max_north = max_of(zone.max_north, ned.north);
+		zone.max_east = max_of(zone.max_east, ned.east);
+	}
+
+	if (zone.max_north - zone.min_north <= 0 || zone.max_east - zone.min_east <= 0) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	uint16_t cells_before = cells_used;
+	uint16_t cell_edges_before = cell_edges_used;
+	if (!index_polygon(zone)) {
+		cells_used = cells_before;
+		cell_edges_used = cell_edges_before;
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	vertices_used += count;
+	zones_used++;
+	return STATUS_CODE_OK;
+}
+
+bool Geofence::index_polygon(GeofenceZone &zone) {
+	float width = zone.max_east - zone.min_east;
+	float height = zone.max_north - zone.min_north;
+
+	uint32_t target = (uint32_t) zone.vertex_count * CELLS_PER_VERTEX;
+	if (target < MIN_POLYGON_CELLS) target = MIN_POLYGON_CELLS;
+	if (target > MAX_POLYGON_CELLS) target = MAX_POLYGON_CELLS;
+	if (target > (uint32_t) (GEOFENCE_MAX_CELLS - cells_used)) target = GEOFENCE_MAX_CELLS - cells_used;
+	if (target < (1 + 2 * GRID_PADDING) * (1 + 2 * GRID_PADDING)) return false;
+
+	//square cells, as many as the target allows. Long thin polygons are capped by the side length instead
+	float cell_size = max_of(sqrtf(width * height / target), max_of(width, height) / MAX_GRID_SIDE);
+	uint32_t columns;
+	uint32_t rows;
+	while (true) {
+		columns = (uint32_t) ceilf(width / cell_size) + 2 * GRID_PADDING;
+		rows = (uint32_t) ceilf(height / cell_size) + 2 * GRID_PADDING;
+		if (columns * rows <= target && columns <= MAX_GRID_SIDE && rows <= MAX_GRID_SIDE) break;
+		cell_size *= 1.05f;
+	}
+
+	//a border of cells all round, so the distance just outside the polygon is exact too
+	zone.min_north -= GRID_PADDING * cell_size;
+	zone.min_east -= GRID_PADDING * cell_size;
+	zone.max_north = zone.min_north + rows * cell_size;
+	zone.max_east = zone.min_east + columns * cell_size;
+	zone.columns = (uint8_t) columns;
+	zone.rows = (uint8_t) rows;
+	zone.first_cell = cells_used;
+	zone.inverse_cell_size = 1.0f / cell_size;
+
+	const float *north = &vertex_north[zone.first_vertex];
+	const float *east = &vertex_east[zone.first_vertex];
+	uint16_t count = zone.vertex_count;
+
+	for (uint32_t row = 0; row < rows; row++) {
+		for (uint32_t column = 0; column < columns; column++) {
+			Box box;
+			box.min_north = zone.min_north + row * cell_size;
+			box.min_east = zone.min_east + column * cell_size;
+			box.max_north = box.min_north + cell_size;
+			box.max_east = box.min_east + cell_size;
+
+			float centre_north = box.min_north + 0.5f * cell_size;
+			float centre_east = box.min_east + 0.5f * cell_size;
+
+			//the edges through the cell tell which side of the boundary its points are on, and the ones a bit further
+			//out give the distance to the boundary, as long as it's short
+			float limit = EXACT_CELLS * cell_size * EXACT_CELLS * cell_size;
+			float centre_distance = FLT_MAX;
+
+			GeofenceCell &cell = cells[cells_used];
+			cell.first_edge = cell_edges_used;
+			cell.edge_count = 0;
+			bool inside = false;
+
+			for (uint16_t i = 0; i < count; i++) {
+				uint16_t next = i + 1 == count ? 0 : i + 1;
+
+				if ((north[i] > centre_north) != (north[next] > centre_north)) {
+					float crossing = east[i] + (centre_north - north[i]) * (east[next] - east[i]) / (north[next] - north[i]);
+					if (crossing > centre_east) inside = !inside;
+				}
+
+				centre_distance = min_of(centre_distance,
+					segment_distance_squared(centre_north, centre_east, north[i], east[i], north[next], east[next]));
+
+				if (box_segment_min_distance_squared(box, north[i], east[i], north[next], east[next]) <= limit) {
+					if (cell_edges_used >= GEOFENCE_MAX_CELL_EDGES || cell.edge_count == UINT8_MAX) return false;
+					cell_edges[cell_edges_used++] = i;
+					cell.edge_count++;
+				}
+			}
+
+			cell.centre_inside = inside;
+			cell.centre_distance = sqrtf(centre_distance);
+			cells_used++;
+		}
+	}
+
+	return true;
+}
+
+StatusCode Geofence::add_circle(GeofenceKind kind, const GeoPosition &centre, float radius) {
+	if (radius <= 0) return STATUS_CODE_INVALID_ARGS;
+	if (zones_used >= GEOFENCE_MAX_ZONES) return STATUS_CODE_RESOURCE_EXHAUSTED;
+
+	NEDPosition ned = local.to_ned(centre);
+	GeofenceZone &zone = zones[zones_used++];
+	zone.kind = kind;
+	zone.is_circle = true;
+	zone.centre_north = ned.north;
+	zone.centre_east = ned.east;
+	zone.radius = radius;
+	return STATUS_CODE_OK;
+}
+
+void Geofence::set_altitude_limits(int32_t floor_mm, int32_t ceiling_mm) {
+	has_altitude_limits = true;
+	floor_down = (local.reference().altitude_mm - floor_mm) * 1e-3f;
+	ceiling_down = (local.reference().altitude_mm - ceiling_mm) * 1e-3f;
+}
+
+float Geofence::depth_in(const GeofenceZone &zone, float north, float east) const {
+	if (!zone.is_circle) return depth_in_polygon(zone, north, east);
+
+	float offset_north = north - zone.centre_north;
+	float offset_east = east - zone.centre_east;
+	return zone.radius - sqrtf(offset_north * offset_north + offset_east * offset_east);
+}
+
+float Geofence::depth_in_polygon(const GeofenceZone &zone, float north, float east) const {
+	//outside the grid is outside the polygon. The distance to the grid is as close as it could be
+	Box bounds = {zone.min_north, zone.min_east, zone.max_north, zone.max_east};
+	if (!box_contains(bounds, north, east)) return -sqrtf(box_distance_squared(bounds, north, east));
+
+	float cell_size = 1.0f / zone.inverse_cell_size;
+	uint32_t column = (uint32_t) ((east - zone.min_east) * zone.inverse_cell_size);
+	uint32_t row = (uint32_t) ((north - zone.min_north) * zone.inverse_cell_size);
+	if (column >= zone.columns) column = zone.columns - 1;
+	if (row >= zone.rows) row = zone.rows - 1;
+
+	const GeofenceCell &cell = cells[zone.first_cell + row * zone.columns + column];
+	float centre_north = zone.min_north + (row + 0.5f) * cell_size;
+	float centre_east = zone.min_east + (column + 0.5f) * cell_size;
+
+	const float *vertices_north = &vertex_north[zone.first_vertex];
+	const float *vertices_east = &vertex_east[zone.first_vertex];
+	const uint16_t *edges = &cell_edges[cell.first_edge];
+
+	//every edge between the centre and the point is in the cell's list, so crossing them tells which side it's on
+	bool inside = cell.centre_inside;
+	float nearest = FLT_MAX;
+
+	for (uint8_t i = 0; i < cell.edge_count; i++) {
+		uint16_t from = edges[i];
+		uint16_t to = from + 1 == zone.vertex_count ? 0 : from + 1;
+
+		if (segments_cross(centre_north, centre_east, north, east, vertices_north[from], vertices_east[from],
+						   vertices_north[to], vertices_east[to])) {
+			inside = !inside;
+		}
+
+		nearest = min_of(nearest, segment_distance_squared(north, east, vertices_north[from], vertices_east[from],
+														   vertices_north[to], vertices_east[to]));
+	}
+
+	//anything not listed is further away than the exact distance. Past that, the boundary can't get closer any faster
+	//than the point moves away from the centre
+	float exact_distance = EXACT_CELLS * cell_size;
+	float distance = sqrtf(nearest);
+	if (distance > exact_distance) {
+		float offset_north = north - centre_north;
+		float offset_east = east - centre_east;
+		float centre_offset = sqrtf(offset_north * offset_north + offset_east * offset_east);
+		distance = max_of(exact_distance, cell.centre_distance - centre_offset);
+	}
+
+	return inside ? distance : -distance;
+}
+
+GeofenceStatus Geofence::check(const NEDPosition &position) const {
+	GeofenceStatus status;
+	status.margin = FLT_MAX;
+	status.zone = GEOFENCE_ALTITUDE;
+
+	//deepest into any inclusion zone
+	float included = FLT_MAX;
+	uint8_t included_zone = GEOFENCE_ALTITUDE;
+	bool any_inclusions = false;
+
+	for (uint8_t i = 0; i < zones_used; i++) {
+		float depth = depth_in(zones[i], position.north, position.east);
+
+		if (zones[i].kind == GEOFENCE_INCLUSION) {
+			if (!any_inclusions || depth > included) {
+				included = depth;
+				included_zone = i;
+			}
+			any_inclusions = true;
+		} else if (-depth < status.margin) {
+			status.margin = -depth;
+			status.zone = i;
+		}
+	}
+
+	if (included < status.margin) {
+		status.margin = included;
+		status.zone = included_zone;
+	}
+
+	if (has_altitude_limits) {
+		float margin = min_of(floor_down - position.down, position.down - ceiling_down);
+		if (margin < status.margin) {
+			status.margin = margin;
+			status.zone = GEOFENCE_ALTITUDE;
+		}
+	}
+
+	status.breached = status.margin < 0;
+	return status;
+}
@@ -0,0 +1,42 @@
+#include "GpsService_A.h"
+#include "UbloxGps.hpp"
+#include "GetFromPathManager.hpp"
+#include "BinaryLog.hpp"
+#include "cmsis_os.h"
+
+static UbloxGps gps(UART_PORT2);
+
+void GpsService_Run(void const *argument) {
+	gps.Init();
+
+	uint32_t last_solution = 0;
+	uint8_t last_status = 0;
+
+	for (;;) {
+		gps.BeginMeasuring();
+
+		GpsData_t data;
+		uint32_t solution = gps.read_latest(data);
+		if (solution != last_solution) {
+			last_solution = solution;
+
+			if (data.sensorStatus != last_status) {
+				LOG_INFO("gps: fix status %u, %u satellites", data.sensorStatus, data.numSatellites);
+				last_status = data.sensorStatus;
+			}
+			if (data.sensorStatus > 0) {
+				PM_UpdatePosition(&data.position, data.velocityNorth, data.velocityEast);
+			}
+		}
+
+		osDelay(GPS_SERVICE_PERIOD_MS);
+	}
+}
+
+void GpsService_GetResult(GpsData_t *data) {
+	gps.GetResult(data);
+}
+
+bool GpsService_GetLatest(GpsData_t *data) {
+	return gps.read_latest(*data) != 0;
+}
@@ -1,54 +1,101 @@
 #include "Interchip_A.h"
+#include "InterchipStats.h"
+#include "Checksum.h"
 #include "cmsis_os.h"
 #include "spi.h"
+#include <stddef.h>
+#include <string.h>
 
-static Interchip_AtoS_Packet *dataTX;
-static Interchip_StoA_Packet *dataRX;
+static Interchip_AtoS_Packet staged;    //what the setters write, copied over to dataTX for the next frame
+static Interchip_AtoS_Packet dataTX;    //read by the spi peripheral for as long as a frame is going out
+static Interchip_StoA_Packet dataRX;    //written by the spi peripheral, may hold a half received frame
+static Interchip_StoA_Packet latestRX;  //last frame from the safety chip that passed its crc
+static InterchipStats linkStats;
 osMutexId Interchip_MutexHandle;
 
 void Interchip_Run(void const *argument) {
-  dataRX = malloc(sizeof(Interchip_StoA_Packet));
-  dataTX = malloc(sizeof(Interchip_AtoS_Packet));
+  init_interchip_stats(&linkStats, INTERCHIP_TRANSMIT_DELAY * 1000);
 
   osMutexDef(Interchip_Mutex);
   Interchip_MutexHandle = osMutexCreate(osMutex(Interchip_Mutex));
 
   while (1) {
-    osMutexWait(Interchip_MutexHandle, 0);
+    if (HAL_SPI_GetState(&hspi1) != HAL_SPI_STATE_READY) {
+      // previous frame hasn't finished yet, skip this one rather than corrupting it
+      interchip_stats_send_overrun(&linkStats);
+    } else {
+      // dataTX is only touched between frames. If a setter has the staged values right now, the last ones go out again
+      if (osMutexWait(Interchip_MutexHandle, 0) == osOK) {
+        memcpy(&dataTX, &staged, sizeof(dataTX));
+        osMutexRelease(Interchip_MutexHandle);
+      }
 
-    HAL_StatusTypeDef transmit_status = HAL_SPI_TransmitReceive_IT(
-        &hspi1, (uint8_t *)dataTX, (uint8_t *)dataRX,
-        sizeof(Interchip_StoA_Packet) / sizeof(uint16_t));
+      dataTX.sequence = interchip_stats_frame_sent(&linkStats);
+      dataTX.ack_sequence = interchip_stats_ack_sequence(&linkStats);
+      interchip_stats_get_health(&linkStats, &dataTX.link);
+      dataTX.crc = crc16_ccitt(&dataTX, offsetof(Interchip_AtoS_Packet, crc));
 
-    osMutexRelease(Interchip_MutexHandle);
+      HAL_StatusTypeDef transmit_status = HAL_SPI_TransmitReceive_IT(
+          &hspi1, (uint8_t *)&dataTX, (uint8_t *)&dataRX,
+          sizeof(Interchip_StoA_Packet) / sizeof(uint16_t));
 
-    if (transmit_status != HAL_OK) {
-      Error_Handler();
+      if (transmit_status != HAL_OK) {
+        interchip_stats_send_overrun(&linkStats);
+      }
     }
     osDelay(INTERCHIP_TRANSMIT_DELAY);
   }
 }
 
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+  if (hspi->Instance != hspi1.Instance) {
+    return;
+  }
+
+  if (crc16_ccitt(&dataRX, offsetof(Interchip_StoA_Packet, crc)) != dataRX.crc) {
+    interchip_stats_crc_failure(&linkStats);
+    return;
+  }
+
+  interchip_stats_frame_received(&linkStats, dataRX.sequence, dataRX.ack_sequence);
+  memcpy(&latestRX, &dataRX, sizeof(latestRX));
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+  if (hspi->Instance == hspi1.Instance) {
+    interchip_stats_transfer_error(&linkStats);
+  }
+}
+
 // Public Functions to get and set data
 
 int16_t *Interchip_GetPWM(void) 
 { 
-  return dataRX->PWM; 
+  return latestRX.PWM; 
 }
 
 
 void Interchip_SetPWM(int16_t data[]) {
-  osMutexWait(Interchip_MutexHandle, 0);
+  if (osMutexWait(Interchip_MutexHandle, INTERCHIP_STAGING_TIMEOUT) != osOK) {
+    return;
+  }
   for (uint8_t i = 0; i < 12; i++) {
-    dataTX->PWM[i] = data[i];
+    staged.PWM[i] = data[i];
   }
   osMutexRelease(Interchip_MutexHandle);
 }
 
 
-uint16_t Interchip_GetSafetyLevel(void) { return dataRX->safety_level; }
+uint16_t Interchip_GetSafetyLevel(void) { return latestRX.safety_level; }
 void Interchip_SetAutonomousLevel(uint16_t data) {
-  osMutexWait(Interchip_MutexHandle, 0);
-  dataTX->autonomous_level = data;
-  osMutexRelease(&Interchip_MutexHandle);
-}
\ No newline at end of file
+  if (osMutexWait(Interchip_MutexHandle, INTERCHIP_STAGING_TIMEOUT) != osOK) {
+    return;
+  }
+  staged.autonomous_level = data;
+  osMutexRelease(Interchip_MutexHandle);
+}
+
+void Interchip_GetLinkStats(InterchipStatsSnapshot *local, Interchip_LinkHealth *remote) {
+  get_interchip_stats(&linkStats, local);
+  *remote = latestRX.link;
+}
@@ -0,0 +1,390 @@
+#include "NMEA.hpp"
+#include <string.h>
+
+//the three characters after the talker, packed like they arrive
+static const uint32_t NMEA_TYPE_GGA = ('G' << 16) | ('G' << 8) | 'A';
+static const uint32_t NMEA_TYPE_VTG = ('V' << 16) | ('T' << 8) | 'G';
+static const uint32_t NMEA_TYPE_RMC = ('R' << 16) | ('M' << 8) | 'C';
+
+//last field that has to be there for each type. Anything after it is optional, depending on the NMEA version
+static const uint8_t NMEA_GGA_LAST_FIELD = 11;
+static const uint8_t NMEA_VTG_LAST_FIELD = 8;
+static const uint8_t NMEA_RMC_LAST_FIELD = 9;
+
+//more integer digits than this won't fit in the accumulator. No field a receiver sends gets close
+static const uint8_t NMEA_MAX_WHOLE_DIGITS = 9;
+static const uint8_t NMEA_MAX_FRACTION_DIGITS = 9;
+
+static const uint32_t POWERS_OF_TEN[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static inline int hex_value(uint8_t c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+//knots -> mm/s is * 1852000 / 3600, which reduces to 463 / 900 for thousandths of a knot
+static inline uint32_t speed_from_knots(int32_t milliknots) {
+	if (milliknots < 0) return 0;
+	return (uint32_t) (((uint64_t) milliknots * 463 + 450) / 900);
+}
+
+inline bool NMEAParser::parse(uint8_t byte) {
+	//a start always begins a new sentence, so a cut off one never swallows the next
+	if (byte == '$') {
+		if (state != NMEA_WAIT_START) malformed++;
+		start_sentence();
+		return false;
+	}
+
+	if (state == NMEA_WAIT_START) return false;
+
+	if (++length > NMEA_MAX_SENTENCE_LEN || byte < ' ' || byte > '~') {
+		drop_sentence();
+		return false;
+	}
+
+	switch (state) {
+		case NMEA_FIELD:
+			if (byte >= '0' && byte <= '9') {
+				checksum ^= byte;
+				uint8_t digit = (uint8_t) (byte - '0');
+
+				if (in_fraction) {
+					//digits past what the accumulator holds are below any resolution we care about
+					if (fraction_digits < NMEA_MAX_FRACTION_DIGITS) {
+						fraction = fraction * 10 + digit;
+						fraction_digits++;
+					}
+				} else if (whole_digits < NMEA_MAX_WHOLE_DIGITS) {
+					whole = whole * 10 + digit;
+					whole_digits++;
+				} else {
+					drop_sentence();
+				}
+			} else if (byte == ',') {
+				checksum ^= byte;
+				end_field();
+				field++;
+			} else if (byte == '*') {
+				end_field();
+				state = NMEA_CHECKSUM_HIGH;
+			} else {
+				checksum ^= byte;
+				if (byte == '.') {
+					in_fraction = true;
+				} else if (byte == '-') {
+					negative = true;
+				} else if (letter == 0) {
+					letter = (char) byte;
+				}
+			}
+			return false;
+
+		case NMEA_ADDRESS:
+			checksum ^= byte;
+			if (byte == ',') {
+				if (!start_fields()) {
+					ignored++;
+					state = NMEA_WAIT_START;
+				}
+			} else if (length <= 2) {
+				working.talker[length - 1] = (char) byte;
+			} else {
+				address = (address << 8) | byte;
+			}
+			return false;
+
+		case NMEA_CHECKSUM_HIGH: {
+			int value = hex_value(byte);
+			if (value < 0) {
+				drop_sentence();
+				return false;
+			}
+			expected_checksum = (uint8_t) (value << 4);
+			state = NMEA_CHECKSUM_LOW;
+			return false;
+		}
+
+		case NMEA_CHECKSUM_LOW: {
+			int value = hex_value(byte);
+			state = NMEA_WAIT_START;
+
+			if (value < 0) {
+				malformed++;
+				return false;
+			}
+			if ((expected_checksum | value) != checksum) {
+				bad_checksums++;
+				return false;
+			}
+			if (!has_all_fields()) {
+				malformed++;
+				return false;
+			}
+
+			completed = working;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+bool NMEAParser::feed(uint8_t byte) {
+	return parse(byte);
+}
+
+size_t NMEAParser::feed(const uint8_t *data, size_t len, bool &complete) {
+	complete = false;
+
+	for (size_t i = 0; i < len; i++) {
+		//most of what a receiver sends are sentences we skip, so jump straight to the next start
+		if (state == NMEA_WAIT_START) {
+			const uint8_t *start = (const uint8_t *) memchr(&data[i], '$', len - i);
+			if (start == nullptr) return len;
+			i = (size_t) (start - data);
+		}
+
+		if (parse(data[i])) {
+			complete = true;
+			return i + 1;
+		}
+	}
+
+	return len;
+}
+
+bool NMEAParser::feed(ByteRing &ring) {
+	const uint8_t *data;
+	size_t len;
+
+	//the unread data can be split in two at the end of the ring
+	while ((len = ring.peek(data)) > 0) {
+		bool complete;
+		ring.consume(feed(data, len, complete));
+		if (complete) return true;
+	}
+
+	return false;
+}
+
+void NMEAParser::start_sentence() {
+	state = NMEA_ADDRESS;
+	length = 0;
+	checksum = 0;
+	address = 0;
+}
+
+bool NMEAParser::start_fields() {
+	if (length != 6) return false; //two talker characters, three type characters and the comma
+
+	switch (address) {
+		case NMEA_TYPE_GGA:
+			working.type = NMEA_SENTENCE_GGA;
+			memset(&working.gga, 0, sizeof(working.gga));
+			break;
+		case NMEA_TYPE_VTG:
+			working.type = NMEA_SENTENCE_VTG;
+			memset(&working.vtg, 0, sizeof(working.vtg));
+			break;
+		case NMEA_TYPE_RMC:
+			working.type = NMEA_SENTENCE_RMC;
+			memset(&working.rmc, 0, sizeof(working.rmc));
+			break;
+		default:
+			return false;
+	}
+
+	state = NMEA_FIELD;
+	field = 1;
+	whole = 0;
+	fraction = 0;
+	whole_digits = 0;
+	fraction_digits = 0;
+	in_fraction = false;
+	negative = false;
+	letter = 0;
+	return true;
+}
+
+void NMEAParser::end_field() {
+	switch (working.type) {
+		case NMEA_SENTENCE_GGA:
+			end_gga_field();
+			break;
+		case NMEA_SENTENCE_VTG:
+			end_vtg_field();
+			break;
+		case NMEA_SENTENCE_RMC:
+			end_rmc_field();
+			break;
+	}
+
+	whole = 0;
+	fraction = 0;
+	whole_digits = 0;
+	fraction_digits = 0;
+	in_fraction = false;
+	negative = false;
+	letter = 0;
+}
+
+void NMEAParser::end_gga_field() {
+	NMEAGGA &gga = working.gga;
+
+	switch (field) {
+		case 1:
+			gga.time_ms = time_ms();
+			break;
+		case 2:
+			gga.latitude = angle_from_degrees_minutes();
+			break;
+		case 3:
+			if (letter == 'S') gga.latitude = -gga.latitude;
+			break;
+		case 4:
+			gga.longitude = angle_from_degrees_minutes();
+			break;
+		case 5:
+			if (letter == 'W') gga.longitude = -gga.longitude;
+			break;
+		case 6:
+			gga.fix_quality = (uint8_t) whole;
+			break;
+		case 7:
+			gga.satellites = (uint8_t) whole;
+			break;
+		case 8:
+			gga.hdop = (uint16_t) fixed_point(2);
+			break;
+		case 9:
+			gga.altitude_mm = fixed_point(3);
+			break;
+		case 11:
+			gga.geoid_separation_mm = fixed_point(3);
+			break;
+		default:
+			break;
+	}
+}
+
+void NMEAParser::end_vtg_field() {
+	NMEAVTG &vtg = working.vtg;
+
+	switch (field) {
+		case 1:
+			vtg.course = (uint16_t) fixed_point(2);
+			vtg.course_valid = !field_empty();
+			break;
+		case 5:
+			vtg.speed_mm_s = speed_from_knots(fixed_point(3));
+			break;
+		case 9:
+			vtg.mode = letter;
+			break;
+		default:
+			break;
+	}
+}
+
+void NMEAParser::end_rmc_field() {
+	NMEARMC &rmc = working.rmc;
+
+	switch (field) {
+		case 1:
+			rmc.time_ms = time_ms();
+			break;
+		case 2:
+			rmc.valid = letter == 'A';
+			break;
+		case 3:
+			rmc.latitude = angle_from_degrees_minutes();
+			break;
+		case 4:
+			if (letter == 'S') rmc.latitude = -rmc.latitude;
+			break;
+		case 5:
+			rmc.longitude = angle_from_degrees_minutes();
+			break;
+		case 6:
+			if (letter == 'W') rmc.longitude = -rmc.longitude;
+			break;
+		case 7:
+			rmc.speed_mm_s = speed_from_knots(fixed_point(3));
+			break;
+		case 8:
+			rmc.course = (uint16_t) fixed_point(2);
+			rmc.course_valid = !field_empty();
+			break;
+		case 9:
+			rmc.day = (uint8_t) (whole / 10000);
+			rmc.month = (uint8_t) (whole / 100 % 100);
+			rmc.year = (uint16_t) (whole_digits == 0 ? 0 : 2000 + whole % 100);
+			break;
+		case 12:
+			rmc.mode = letter;
+			break;
+		default:
+			break;
+	}
+}
+
+bool NMEAParser::has_all_fields() const {
+	switch (working.type) {
+		case NMEA_SENTENCE_GGA:
+			return field >= NMEA_GGA_LAST_FIELD;
+		case NMEA_SENTENCE_VTG:
+			return field >= NMEA_VTG_LAST_FIELD;
+		case NMEA_SENTENCE_RMC:
+			return field >= NMEA_RMC_LAST_FIELD;
+	}
+	return false;
+}
+
+/**
+ * The fractional part of the field in units of 10^-decimals. Extra decimal places are truncated
+ */
+uint32_t NMEAParser::fraction_to(uint8_t decimals) const {
+	if (fraction_digits >= decimals) return fraction / POWERS_OF_TEN[fraction_digits - decimals];
+	return fraction * POWERS_OF_TEN[decimals - fraction_digits];
+}
+
+/**
+ * The field as an integer in units of 10^-decimals
+ */
+int32_t NMEAParser::fixed_point(uint8_t decimals) const {
+	int32_t value = (int32_t) (whole * POWERS_OF_TEN[decimals] + fraction_to(decimals));
+	return negative ? -value : value;
+}
+
+/**
+ * hhmmss.sss to milliseconds since midnight
+ */
+uint32_t NMEAParser::time_ms() const {
+	uint32_t hours = whole / 10000;
+	uint32_t minutes = whole / 100 % 100;
+	uint32_t seconds = whole % 100;
+
+	return ((hours * 60 + minutes) * 60 + seconds) * 1000 + fraction_to(3);
+}
+
+/**
+ * (d)ddmm.mmmmm to 1e-7 degrees. Minutes are kept to 6 decimal places, 1/60th of which is below the 1e-7 output
+ */
+int32_t NMEAParser::angle_from_degrees_minutes() const {
+	uint32_t degrees = whole / 100;
+	uint32_t micro_minutes = (whole % 100) * 1000000 + fraction_to(6);
+
+	//1e-6 minutes * 10 / 60 = 1e-7 degrees
+	return (int32_t) (degrees * 10000000 + (micro_minutes + 3) / 6);
+}
+
+void NMEAParser::drop_sentence() {
+	malformed++;
+	state = NMEA_WAIT_START;
+}
@@ -0,0 +1,242 @@
+#include "PathManager.hpp"
+#include <math.h>
+
+static const float GRAVITY = 9.80665f;
+
+//L1 distance per m/s of ground speed, and the gain that gives the damping asked for
+static const float L1_RATIO = PATH_L1_DAMPING * PATH_L1_PERIOD_S / (float) M_PI;
+static const float L1_GAIN = 4.0f * PATH_L1_DAMPING * PATH_L1_DAMPING;
+
+//below this there's no meaningful direction of travel, steer as if flying along the track
+static const float MIN_GROUND_SPEED = 1.0f;
+static const float MIN_L1_DISTANCE = 10.0f;
+
+//don't aim further off the track than 45 degrees, however far away it is
+static const float MAX_SIN_L1_ANGLE = 0.7071f;
+
+static const float MIN_SEGMENT_LENGTH = 1.0f;
+
+//about how long the attitude loops take to roll the aircraft to what's asked for
+static const float ROLL_LEAD_S = 0.5f;
+
+//closer than this to the middle of an arc there's no telling which way round it is
+static const float MIN_ARC_DISTANCE = 1.0f;
+
+static inline float clamp(float value, float limit) {
+	if (value > limit) return limit;
+	if (value < -limit) return -limit;
+	return value;
+}
+
+static inline float wrap_angle(float angle) {
+	if (angle > (float) M_PI) return angle - 2.0f * (float) M_PI;
+	if (angle < -(float) M_PI) return angle + 2.0f * (float) M_PI;
+	return angle;
+}
+
+PathManager::PathManager() {
+	clear();
+}
+
+void PathManager::clear() {
+	count = 0;
+	complete = false;
+	cross_track = 0;
+	enter_segment(0);
+}
+
+void PathManager::enter_segment(uint8_t index) {
+	current = index;
+	arc_entered = false;
+	arc_bearing = 0;
+	arc_swept = 0;
+}
+
+StatusCode PathManager::load_mission(const GeoPosition &home, const Waypoint *waypoints, uint8_t waypoint_count) {
+	if (waypoints == nullptr || waypoint_count < 2 || waypoint_count > PATH_MAX_WAYPOINTS) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	clear();
+	local.set_reference(home);
+
+	NEDPosition start = local.to_ned(waypoints[0].position);
+	for (uint8_t i = 0; i + 1 < waypoint_count; i++) {
+		NEDPosition end = local.to_ned(waypoints[i + 1].position);
+		float north = end.north - start.north;
+		float east = end.east - start.east;
+		float length = sqrtf(north * north + east * east);
+
+		if (length < MIN_SEGMENT_LENGTH) {
+			clear();
+			return STATUS_CODE_INVALID_ARGS;
+		}
+
+		PathSegment &segment = segments[i];
+		segment.kind = PATH_LINE;
+		segment.start_north = start.north;
+		segment.start_east = start.east;
+		segment.start_down = start.down;
+		segment.direction_north = north / length;
+		segment.direction_east = east / length;
+		segment.length = length;
+		segment.climb = (end.down - start.down) / length;
+		segment.flight_path_angle = atanf(-segment.climb);
+		segment.course = atan2f(east, north);
+		segment.airspeed = waypoints[i + 1].airspeed;
+		segment.switch_distance = 0;
+		segment.centre_north = 0;
+		segment.centre_east = 0;
+		segment.radius = 0;
+		segment.start_bearing = 0;
+		segment.turn = 0;
+
+		start = end;
+	}
+
+	uint8_t segment_count = waypoint_count - 1;
+
+	//start the turn onto the next leg where a turn at full roll would meet it, but never skip more than half a leg
+	for (uint8_t i = 0; i + 1 < segment_count; i++) {
+		PathSegment &from = segments[i];
+		const PathSegment &to = segments[i + 1];
+
+		float dot = from.direction_north * to.direction_north + from.direction_east * to.direction_east;
+		float cross = from.direction_north * to.direction_east - from.direction_east * to.direction_north;
+		float radius = to.airspeed * to.airspeed / (GRAVITY * tanf(PATH_MAX_ROLL_RAD));
+		float half_turn_tangent = fabsf(cross) / (1.0f + dot + 1e-6f); //tan(angle / 2)
+
+		float limit = 0.5f * (from.length < to.length ? from.length : to.length);
+		float distance = radius * half_turn_tangent;
+		from.switch_distance = distance < limit ? distance : limit;
+	}
+
+	count = segment_count;
+	return STATUS_CODE_OK;
+}
+
+StatusCode PathManager::load_plan(const GeoPosition &home, const PathSegment *plan, uint8_t segment_count) {
+	if (plan == nullptr || segment_count == 0 || segment_count > PATH_MAX_SEGMENTS) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	for (uint8_t i = 0; i < segment_count; i++) {
+		const PathSegment &segment = plan[i];
+		bool is_last = i + 1 == segment_count;
+
+		if (segment.kind == PATH_LOITER && !is_last) return STATUS_CODE_INVALID_ARGS;
+		if (segment.kind != PATH_LOITER && !(segment.length >= PATH_MIN_PLANNED_LENGTH)) return STATUS_CODE_INVALID_ARGS;
+		if (segment.kind != PATH_LINE && (!(segment.radius > 0) || (segment.turn != 1 && segment.turn != -1))) {
+			return STATUS_CODE_INVALID_ARGS;
+		}
+	}
+
+	clear();
+	local.set_reference(home);
+
+	for (uint8_t i = 0; i < segment_count; i++) {
+		segments[i] = plan[i];
+	}
+
+	count = segment_count;
+	complete = segments[0].kind == PATH_LOITER;
+	return STATUS_CODE_OK;
+}
+
+//m along the segment. Round an arc that's added up from the change in bearing each tick, so it can pass a full turn
+float PathManager::progress(const PathSegment &segment, const NEDPosition &position) {
+	if (segment.kind == PATH_LINE) {
+		return (position.north - segment.start_north) * segment.direction_north
+			+ (position.east - segment.start_east) * segment.direction_east;
+	}
+
+	float bearing = atan2f(position.east - segment.centre_east, position.north - segment.centre_north);
+	if (!arc_entered) {
+		arc_swept = segment.turn * wrap_angle(bearing - segment.start_bearing);
+		arc_entered = true;
+	} else {
+		arc_swept += segment.turn * wrap_angle(bearing - arc_bearing);
+	}
+	arc_bearing = bearing;
+
+	return arc_swept * segment.radius;
+}
+
+void PathManager::update(const PathState &state, PMCommands &commands) {
+	if (count == 0) return;
+
+	const PathSegment *segment = &segments[current];
+	float along = progress(*segment, state.position);
+
+	//at most one leg per tick. A leg shorter than a tick's travel is finished off on the next one
+	if (segment->kind != PATH_LOITER && along >= segment->length - segment->switch_distance) {
+		if (current + 1 < count) {
+			enter_segment(current + 1);
+			segment = &segments[current];
+			along = progress(*segment, state.position);
+			if (segment->kind == PATH_LOITER) complete = true;
+		} else if (along >= segment->length) {
+			complete = true;
+		}
+	}
+
+	//the track is the leg's line, or the tangent to the arc at the nearest point on it
+	float track_north = segment->direction_north;
+	float track_east = segment->direction_east;
+	float track_course = segment->course;
+	float curvature = 0; //1/m, positive turning right
+
+	if (segment->kind == PATH_LINE) {
+		cross_track = (state.position.east - segment->start_east) * segment->direction_north
+			- (state.position.north - segment->start_north) * segment->direction_east;
+	} else {
+		float radial_north = state.position.north - segment->centre_north;
+		float radial_east = state.position.east - segment->centre_east;
+		float distance = sqrtf(radial_north * radial_north + radial_east * radial_east);
+
+		if (distance >= MIN_ARC_DISTANCE) {
+			track_north = -segment->turn * radial_east / distance;
+			track_east = segment->turn * radial_north / distance;
+			track_course = atan2f(track_east, track_north);
+		}
+
+		//outside the circle, only turn as tightly as the circle through the aircraft would, so it can still close in
+		cross_track = -segment->turn * (distance - segment->radius);
+		curvature = segment->turn / (distance > segment->radius ? distance : segment->radius);
+	}
+
+	//lateral: the angle to the L1 point off the track, plus the angle between the velocity and the track
+	float speed = sqrtf(state.velocity_north * state.velocity_north + state.velocity_east * state.velocity_east);
+
+	//rolling into the next turn takes time, so start on it a little early
+	if (segment->kind != PATH_LOITER && current + 1 < count && segment->length - along < speed * ROLL_LEAD_S) {
+		const PathSegment &next = segments[current + 1];
+		curvature = next.kind == PATH_LINE ? 0 : next.turn / next.radius;
+	}
+	float along_velocity = 1.0f;
+	float cross_velocity = 0;
+	if (speed >= MIN_GROUND_SPEED) {
+		along_velocity = (state.velocity_north * track_north + state.velocity_east * track_east) / speed;
+		cross_velocity = (state.velocity_north * track_east - state.velocity_east * track_north) / speed;
+	}
+
+	float l1_distance = L1_RATIO * speed;
+	if (l1_distance < MIN_L1_DISTANCE) l1_distance = MIN_L1_DISTANCE;
+
+	float sin_track_angle = clamp(-cross_track / l1_distance, MAX_SIN_L1_ANGLE);
+	float cos_track_angle = sqrtf(1.0f - sin_track_angle * sin_track_angle);
+
+	//sin of the sum of the two angles, from their sines and cosines
+	float sin_l1_angle = sin_track_angle * along_velocity + cos_track_angle * cross_velocity;
+	float lateral_acceleration = L1_GAIN * speed * speed / l1_distance * sin_l1_angle + speed * speed * curvature;
+
+	commands.roll = clamp(atanf(lateral_acceleration / GRAVITY), PATH_MAX_ROLL_RAD);
+	commands.yaw = wrap_angle(track_course + asinf(sin_track_angle));
+
+	//longitudinal: hold the leg's climb, and pull toward its line. A loiter holds its height
+	float progress_along = along < 0 ? 0 : (along > segment->length ? segment->length : along);
+	if (segment->kind == PATH_LOITER) progress_along = 0;
+	float below = state.position.down - (segment->start_down + progress_along * segment->climb);
+	commands.pitch = clamp(segment->flight_path_angle + PATH_ALTITUDE_GAIN * below, PATH_MAX_PITCH_RAD);
+	commands.airspeed = segment->airspeed;
+}
@@ -0,0 +1,174 @@
+#include "Planner_A.h"
+#include "DubinsPlanner.hpp"
+#include "GetFromPathManager.hpp"
+#include "BinaryLog.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+
+typedef enum PlannerRequestState {
+	PLANNER_REQUEST_NONE = 0,
+	PLANNER_REQUEST_WRITING, //claimed by a requester, which is still filling it in
+	PLANNER_REQUEST_READY
+} PlannerRequestState;
+
+typedef struct PlannerRequest {
+	bool is_return;
+	GeoPosition home;
+
+	Waypoint waypoints[PATH_MAX_WAYPOINTS];
+	uint8_t count;
+
+	GeoPosition position;
+	float course;
+	float airspeed;
+	float loiter_radius;
+} PlannerRequest;
+
+static DubinsPlanner planner;
+
+//a request has been taken up and its plan not yet handed over: still being planned, or done and waiting for the path
+//manager to have room for it. Read by other tasks through Planner_IsBusy(), so only changed in critical sections
+static volatile bool plan_pending = false;
+
+//one request at a time. Whoever claims it fills it in, then the planner task takes it up. request_state only changes
+//in critical sections, so the request's fields are all stored before it reads READY and read after
+static PlannerRequest request;
+static volatile PlannerRequestState request_state = PLANNER_REQUEST_NONE;
+
+static bool claim_request() {
+	bool claimed = false;
+
+	taskENTER_CRITICAL();
+	if (request_state == PLANNER_REQUEST_NONE) {
+		request_state = PLANNER_REQUEST_WRITING;
+		claimed = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return claimed;
+}
+
+static void set_plan_pending(bool pending) {
+	taskENTER_CRITICAL();
+	plan_pending = pending;
+	taskEXIT_CRITICAL();
+}
+
+static void publish_request() {
+	taskENTER_CRITICAL();
+	request_state = PLANNER_REQUEST_READY;
+	taskEXIT_CRITICAL();
+}
+
+static void take_request() {
+	taskENTER_CRITICAL();
+	bool ready = request_state == PLANNER_REQUEST_READY;
+	taskEXIT_CRITICAL();
+	if (!ready) return;
+
+	StatusCode status;
+	if (request.is_return) {
+		status = planner.start_return(request.position, request.course, request.home, request.airspeed,
+									  request.loiter_radius);
+	} else {
+		status = planner.start_mission(request.home, request.waypoints, request.count);
+	}
+
+	//both at once, so the planner never looks idle between the request and its plan
+	taskENTER_CRITICAL();
+	plan_pending = status == STATUS_CODE_OK;
+	request_state = PLANNER_REQUEST_NONE;
+	taskEXIT_CRITICAL();
+
+	if (status != STATUS_CODE_OK) {
+		LOG_ERROR("planner: request rejected, status %d", status);
+	}
+}
+
+static void publish() {
+	StatusCode status = PM_LoadPlan(&planner.home(), planner.plan(), planner.plan_length());
+
+	//the path manager hasn't taken the last one yet, try again next time round
+	if (status == STATUS_CODE_RESOURCE_EXHAUSTED) return;
+
+	set_plan_pending(false);
+	if (status == STATUS_CODE_OK) {
+		LOG_INFO("planner: %u segments handed over", planner.plan_length());
+	} else {
+		LOG_ERROR("planner: path manager rejected the plan, status %d", status);
+	}
+}
+
+void Planner_Run(void const *argument) {
+	for (;;) {
+		take_request();
+
+		if (planner.state() == PLANNER_WORKING) {
+			if (planner.step() == PLANNER_FAILED) {
+				set_plan_pending(false);
+				LOG_ERROR("planner: mission can't be flown");
+			}
+
+			//one leg per slice, then anything else at this priority gets a turn
+			osThreadYield();
+			continue;
+		}
+
+		if (plan_pending) {
+			publish();
+			osDelay(1);
+			continue;
+		}
+
+		osDelay(PLANNER_IDLE_PERIOD_MS);
+	}
+}
+
+StatusCode Planner_RequestMission(const GeoPosition *home, const Waypoint *waypoints, uint8_t count) {
+	if (home == nullptr || waypoints == nullptr || count < 2 || count > PATH_MAX_WAYPOINTS) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+	if (!claim_request()) {
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	request.is_return = false;
+	request.home = *home;
+	for (uint8_t i = 0; i < count; i++) {
+		request.waypoints[i] = waypoints[i];
+	}
+	request.count = count;
+
+	publish_request();
+	return STATUS_CODE_OK;
+}
+
+StatusCode Planner_RequestReturn(const GeoPosition *position, float course, const GeoPosition *home, float airspeed,
+								 float loiter_radius) {
+	if (position == nullptr || home == nullptr) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+	if (!claim_request()) {
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	request.is_return = true;
+	request.home = *home;
+	request.position = *position;
+	request.course = course;
+	request.airspeed = airspeed;
+	request.loiter_radius = loiter_radius;
+
+	publish_request();
+	return STATUS_CODE_OK;
+}
+
+bool Planner_IsBusy(void) {
+	//the planner's own state isn't needed: plan_pending already covers a plan being worked on
+	taskENTER_CRITICAL();
+	bool busy = request_state != PLANNER_REQUEST_NONE || plan_pending;
+	taskEXIT_CRITICAL();
+
+	return busy;
+}
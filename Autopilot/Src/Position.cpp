@@ -0,0 +1,84 @@
+#include "Position.hpp"
+#include <math.h>
+
+//wgs84
+static const double WGS84_SEMI_MAJOR_AXIS = 6378137.0;
+static const double WGS84_FLATTENING = 1.0 / 298.257223563;
+static const double WGS84_ECCENTRICITY_SQUARED = WGS84_FLATTENING * (2.0 - WGS84_FLATTENING);
+
+static const double RADIANS_PER_UNIT = M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+static const int64_t UNITS_PER_TURN = 360LL * GEO_UNITS_PER_DEGREE;
+
+static inline int32_t wrap_longitude(int64_t longitude) {
+	if (longitude > UNITS_PER_TURN / 2) longitude -= UNITS_PER_TURN;
+	if (longitude < -UNITS_PER_TURN / 2) longitude += UNITS_PER_TURN;
+	return (int32_t) longitude;
+}
+
+//shortest way around, so a frame straddling the antimeridian still works
+static inline int32_t longitude_difference(int32_t to, int32_t from) {
+	return wrap_longitude((int64_t) to - from);
+}
+
+LocalFrame::LocalFrame() {
+	GeoPosition zero = {0, 0, 0};
+	set_reference(zero);
+}
+
+void LocalFrame::set_reference(const GeoPosition &reference) {
+	origin = reference;
+
+	double latitude = reference.latitude * RADIANS_PER_UNIT;
+	double sin_latitude = sin(latitude);
+	double cos_latitude = cos(latitude);
+	double height = reference.altitude_mm * 1e-3;
+
+	//radii of curvature along the meridian and the prime vertical
+	double w_squared = 1.0 - WGS84_ECCENTRICITY_SQUARED * sin_latitude * sin_latitude;
+	double prime_vertical = WGS84_SEMI_MAJOR_AXIS / sqrt(w_squared);
+	double meridian = prime_vertical * (1.0 - WGS84_ECCENTRICITY_SQUARED) / w_squared;
+
+	north_scale = (float) ((meridian + height) * RADIANS_PER_UNIT);
+	east_scale = (float) ((prime_vertical + height) * cos_latitude * RADIANS_PER_UNIT);
+	east_skew = (float) (-(meridian + height) * sin_latitude * RADIANS_PER_UNIT * RADIANS_PER_UNIT);
+	north_bend = (float) (0.5 * (prime_vertical + height) * sin_latitude * cos_latitude
+		* RADIANS_PER_UNIT * RADIANS_PER_UNIT);
+	inverse_diameter = (float) (0.5 / (sqrt(meridian * prime_vertical) + height));
+}
+
+NEDPosition LocalFrame::to_ned(const GeoPosition &position) const {
+	float latitude = (float) (position.latitude - origin.latitude);
+	float longitude = (float) longitude_difference(position.longitude, origin.longitude);
+
+	float up = (position.altitude_mm - origin.altitude_mm) * 1e-3f;
+
+	//the higher up, the further apart the same angles are
+	float stretch = 1.0f + up * 2.0f * inverse_diameter;
+
+	NEDPosition ned;
+	ned.north = (latitude * north_scale + longitude * longitude * north_bend) * stretch;
+	ned.east = longitude * (east_scale + latitude * east_skew) * stretch;
+	ned.down = (ned.north * ned.north + ned.east * ned.east) * inverse_diameter - up;
+	return ned;
+}
+
+GeoPosition LocalFrame::from_ned(const NEDPosition &ned) const {
+	float up = (ned.north * ned.north + ned.east * ned.east) * inverse_diameter - ned.down;
+	float stretch = 1.0f + up * 2.0f * inverse_diameter;
+	float north = ned.north / stretch;
+	float east = ned.east / stretch;
+
+	//the second order terms depend on the answer, so start from the first order one and refine it
+	float latitude = north / north_scale;
+	float longitude = 0;
+	for (int i = 0; i < 2; i++) {
+		longitude = east / (east_scale + latitude * east_skew);
+		latitude = (north - longitude * longitude * north_bend) / north_scale;
+	}
+
+	GeoPosition position;
+	position.latitude = origin.latitude + (int32_t) lroundf(latitude);
+	position.longitude = wrap_longitude((int64_t) origin.longitude + lroundf(longitude));
+	position.altitude_mm = origin.altitude_mm + (int32_t) lroundf(up * 1000.0f);
+	return position;
+}
@@ -0,0 +1,102 @@
+#include "SystemMonitor_A.h"
+#include "BinaryLog.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include <string.h>
+
+//a task this close to the end of its stack, or a heap this close to full, needs more room
+static const SystemMonitorThresholds SYSTEM_MONITOR_THRESHOLDS = {
+	32, //min_stack_free_words
+	1024, //min_heap_free_bytes
+	900, //max_cpu_load_permille
+};
+
+//room for more tasks than are monitored, so having too many shows up as an alarm
+static const UBaseType_t SYSTEM_MONITOR_STATUS_LEN = SYSTEM_MONITOR_MAX_TASKS + 4;
+
+static SystemMonitor monitor;
+static SystemMonitorSnapshot published; //what the telemetry side reads, only touched in critical sections
+static TaskStatus_t task_status[SYSTEM_MONITOR_STATUS_LEN];
+static SystemMonitorTaskSample samples[SYSTEM_MONITOR_STATUS_LEN];
+
+static void log_alarms(uint8_t raised, const SystemMonitorSnapshot *snapshot) {
+	if (raised & SYSTEM_MONITOR_ALARM_STACK) {
+		for (uint8_t i = 0; i < snapshot->task_count; i++) {
+			const SystemMonitorTaskUsage *task = &snapshot->tasks[i];
+			if (task->stack_free_words >= SYSTEM_MONITOR_THRESHOLDS.min_stack_free_words) continue;
+
+			char name[SYSTEM_MONITOR_NAME_LEN + 1] = {0};
+			memcpy(name, task->name, SYSTEM_MONITOR_NAME_LEN);
+			LOG_ERROR("sysmon: %s has %u words of stack left", name, task->stack_free_words);
+		}
+	}
+	if (raised & SYSTEM_MONITOR_ALARM_HEAP) {
+		LOG_ERROR("sysmon: free heap got down to %lu bytes", snapshot->heap_min_free_bytes);
+	}
+	if (raised & SYSTEM_MONITOR_ALARM_CPU) {
+		LOG_ERROR("sysmon: cpu load at %u permille", snapshot->cpu_load_permille);
+	}
+	if (raised & SYSTEM_MONITOR_ALARM_TASKS) {
+		LOG_ERROR("sysmon: more than %u tasks, not all are monitored", SYSTEM_MONITOR_MAX_TASKS);
+	}
+}
+
+static void log_snapshot(const SystemMonitorSnapshot *snapshot) {
+	LOG_INFO("sysmon: cpu %u permille, heap free %lu min %lu, alarms 0x%x", snapshot->cpu_load_permille,
+			 snapshot->heap_free_bytes, snapshot->heap_min_free_bytes, snapshot->alarms);
+
+	for (uint8_t i = 0; i < snapshot->task_count; i++) {
+		const SystemMonitorTaskUsage *task = &snapshot->tasks[i];
+		char name[SYSTEM_MONITOR_NAME_LEN + 1] = {0};
+		memcpy(name, task->name, SYSTEM_MONITOR_NAME_LEN);
+
+		LOG_INFO("sysmon: %s stack free %u words, cpu %u permille", name, task->stack_free_words, task->cpu_permille);
+	}
+}
+
+void SystemMonitor_Run(void const *argument) {
+	init_system_monitor(&monitor, &SYSTEM_MONITOR_THRESHOLDS);
+
+	for (;;) {
+		uint32_t total_run_time;
+		UBaseType_t count = uxTaskGetSystemState(task_status, SYSTEM_MONITOR_STATUS_LEN, &total_run_time);
+		TaskHandle_t idle = xTaskGetIdleTaskHandle();
+
+		//it fills in nothing at all if the array is too small
+		if (count == 0) {
+			LOG_ERROR("sysmon: more than %u tasks, can't sample them", (unsigned) SYSTEM_MONITOR_STATUS_LEN);
+			osDelay(SYSTEM_MONITOR_PERIOD_MS);
+			continue;
+		}
+
+		for (UBaseType_t i = 0; i < count; i++) {
+			samples[i].number = (uint8_t) task_status[i].xTaskNumber;
+			samples[i].name = task_status[i].pcTaskName;
+			samples[i].stack_free_words = task_status[i].usStackHighWaterMark;
+			samples[i].run_time = task_status[i].ulRunTimeCounter;
+			samples[i].is_idle = task_status[i].xHandle == idle;
+		}
+
+		uint8_t raised = system_monitor_update(&monitor, samples, (uint8_t) count, total_run_time,
+											   xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize());
+
+		SystemMonitorSnapshot snapshot;
+		get_system_monitor_snapshot(&monitor, &snapshot);
+
+		taskENTER_CRITICAL();
+		published = snapshot;
+		taskEXIT_CRITICAL();
+
+		log_alarms(raised, &snapshot);
+		log_snapshot(&snapshot);
+
+		osDelay(SYSTEM_MONITOR_PERIOD_MS);
+	}
+}
+
+void SystemMonitor_GetSnapshot(SystemMonitorSnapshot *snapshot) {
+	taskENTER_CRITICAL();
+	*snapshot = published;
+	taskEXIT_CRITICAL();
+}
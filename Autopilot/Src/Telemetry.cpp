@@ -0,0 +1,197 @@
+#include "Telemetry.hpp"
+#include <string.h>
+
+/***********************************************************************************************************************
+ * Framing
+ **********************************************************************************************************************/
+
+TelemetryWriter::TelemetryWriter(const DMATxRegion &region, TelemetryMessageId id, uint8_t sequence)
+	: FrameWriter(TELEMETRY_FRAMING, region) {
+	put_u8((uint8_t) id);
+	put_u8(sequence);
+}
+
+/***********************************************************************************************************************
+ * Messages
+ **********************************************************************************************************************/
+
+void telemetry_write_heartbeat(TelemetryWriter &writer, uint32_t uptime_ms, const SystemMonitorSnapshot &system,
+							   uint8_t flags) {
+	writer.put_u32(uptime_ms);
+	writer.put_u32(system.heap_free_bytes);
+	writer.put_u16(system.cpu_load_permille);
+	writer.put_u8(system.alarms);
+	writer.put_u8(flags);
+}
+
+void telemetry_write_attitude(TelemetryWriter &writer, const SFOutput_t &attitude) {
+	writer.put_float(attitude.IMUroll);
+	writer.put_float(attitude.IMUpitch);
+	writer.put_float(attitude.IMUyaw);
+	writer.put_float(attitude.IMUrollrate);
+	writer.put_float(attitude.IMUpitchrate);
+	writer.put_float(attitude.IMUyawrate);
+	writer.put_float(attitude.Airspeed);
+}
+
+void telemetry_write_gps(TelemetryWriter &writer, const GpsData_t &gps) {
+	writer.put_i32(gps.position.latitude);
+	writer.put_i32(gps.position.longitude);
+	writer.put_i32(gps.position.altitude_mm);
+	writer.put_float(gps.velocityNorth);
+	writer.put_float(gps.velocityEast);
+	writer.put_float(gps.velocityDown);
+	writer.put_float(gps.horizontalAccuracy);
+	writer.put_float(gps.verticalAccuracy);
+	writer.put_u16((uint16_t) gps.heading);
+	writer.put_u8(gps.numSatellites);
+	writer.put_u8(gps.sensorStatus);
+	writer.put_u32((uint32_t) (gps.receivedTimeUs / 1000));
+}
+
+void telemetry_write_geofence(TelemetryWriter &writer, const GeofenceStatus &status) {
+	writer.put_u8(status.breached ? 1 : 0);
+	writer.put_u8(status.zone);
+	writer.put_float(status.margin);
+}
+
+void telemetry_write_tasks(TelemetryWriter &writer, const SystemMonitorSnapshot &system) {
+	writer.put_u8(system.task_count);
+
+	for (uint8_t i = 0; i < system.task_count; i++) {
+		const SystemMonitorTaskUsage &task = system.tasks[i];
+		writer.put_u8(task.number);
+		writer.put_bytes((const uint8_t *) task.name, SYSTEM_MONITOR_NAME_LEN);
+		writer.put_u16(task.stack_free_words);
+		writer.put_u16(task.cpu_permille);
+	}
+}
+
+void telemetry_write_interchip(TelemetryWriter &writer, const InterchipStatsSnapshot &local,
+								const Interchip_LinkHealth &remote) {
+	writer.put_u32(local.frames_sent);
+	writer.put_u32(local.frames_received);
+	writer.put_u32(local.crc_failures);
+	writer.put_u32(local.sequence_gaps);
+	writer.put_u32(local.late_frames);
+	writer.put_u32(local.send_overruns);
+	writer.put_u32(local.transfer_errors);
+	writer.put_u32(local.last_rtt_us);
+	writer.put_u32(local.max_rtt_us);
+	for (int i = 0; i < INTERCHIP_RTT_BUCKETS; i++) {
+		writer.put_u32(local.rtt_histogram[i]);
+	}
+
+	writer.put_u16(remote.crc_failures);
+	writer.put_u16(remote.sequence_gaps);
+	writer.put_u16(remote.late_frames);
+}
+
+void telemetry_write_ack(TelemetryWriter &writer, const TelemetryAck &ack) {
+	writer.put_u8(ack.id);
+	writer.put_u8(ack.sequence);
+	writer.put_u8(ack.status);
+	writer.put_u8(ack.detail);
+}
+
+/***********************************************************************************************************************
+ * Scheduling
+ **********************************************************************************************************************/
+
+static const uint64_t TELEMETRY_TOKENS_PER_BYTE = 1000000;
+
+TelemetryScheduler::TelemetryScheduler() : bytes_per_s(0), burst(0), tokens(0), last_refill_us(0), refilled(false) {
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		period_us[i] = 0;
+		due_us[i] = 0;
+		starting[i] = false;
+		sends[i] = 0;
+		skips[i] = 0;
+	}
+}
+
+void TelemetryScheduler::set_link(uint32_t link_bytes_per_s, uint32_t burst_bytes) {
+	bytes_per_s = link_bytes_per_s;
+	burst = burst_bytes * TELEMETRY_TOKENS_PER_BYTE;
+	tokens = burst;
+}
+
+StatusCode TelemetryScheduler::set_rate(TelemetryMessageId id, float rate_hz) {
+	if (id >= TELEMETRY_MESSAGE_COUNT || !(rate_hz >= 0)) return STATUS_CODE_INVALID_ARGS;
+
+	if (rate_hz == 0) {
+		period_us[id] = 0;
+		return STATUS_CODE_OK;
+	}
+
+	float period = 1e6f / rate_hz;
+	period_us[id] = period >= (float) UINT32_MAX ? UINT32_MAX : (period < 1 ? 1 : (uint32_t) period);
+	starting[id] = true;
+	return STATUS_CODE_OK;
+}
+
+TelemetryMessageId TelemetryScheduler::next(uint64_t now_us) {
+	TelemetryMessageId chosen = TELEMETRY_NONE;
+	uint64_t chosen_due = 0;
+
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		if (period_us[i] == 0) continue;
+
+		if (starting[i]) {
+			due_us[i] = now_us;
+			starting[i] = false;
+		}
+		if (due_us[i] > now_us) continue;
+
+		//a whole period behind, so that period's lost. Catching up would only make the next ones late too
+		uint64_t late = now_us - due_us[i];
+		if (late >= period_us[i]) {
+			uint64_t missed = late / period_us[i];
+			skips[i] += (uint32_t) missed;
+			due_us[i] += missed * period_us[i];
+		}
+
+		if (chosen == TELEMETRY_NONE || due_us[i] < chosen_due) {
+			chosen = (TelemetryMessageId) i;
+			chosen_due = due_us[i];
+		}
+	}
+
+	return chosen;
+}
+
+bool TelemetryScheduler::spend(size_t frame_len, uint64_t now_us) {
+	if (!refilled) {
+		last_refill_us = now_us;
+		refilled = true;
+	}
+	if (now_us > last_refill_us) {
+		tokens += (now_us - last_refill_us) * bytes_per_s;
+		if (tokens > burst) tokens = burst;
+		last_refill_us = now_us;
+	}
+
+	uint64_t cost = frame_len * TELEMETRY_TOKENS_PER_BYTE;
+	if (cost > tokens) return false;
+
+	tokens -= cost;
+	return true;
+}
+
+void TelemetryScheduler::sent(TelemetryMessageId id) {
+	if (id >= TELEMETRY_MESSAGE_COUNT) return;
+
+	sends[id]++;
+	advance(id);
+}
+
+void TelemetryScheduler::skip(TelemetryMessageId id) {
+	if (id >= TELEMETRY_MESSAGE_COUNT) return;
+
+	skips[id]++;
+	advance(id);
+}
+
+void TelemetryScheduler::advance(TelemetryMessageId id) {
+	due_us[id] += period_us[id];
+}
@@ -0,0 +1,317 @@
+#include "Telemetry_A.h"
+#include "Telemetry.hpp"
+#include "Uplink.hpp"
+#include "UART.hpp"
+#include "FramedPort.hpp"
+#include "Clock.hpp"
+#include "GpsService_A.h"
+#include "Planner_A.h"
+#include "SystemMonitor_A.h"
+#include "Interchip_A.h"
+#include "GetFromPathManager.hpp"
+#include "attitudeStateClasses.hpp"
+#include "BinaryLog.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+
+static const size_t TELEMETRY_TX_QUEUE_LEN = 512; //a bit over 100ms of the link
+static const size_t TELEMETRY_RX_BUFFER_LEN = 256;
+static const uint8_t TELEMETRY_MAX_PENDING_ACKS = 8;
+
+//what the task starts out sending, in Hz
+static const float TELEMETRY_DEFAULT_RATES[TELEMETRY_MESSAGE_COUNT] = {
+	1, //TELEMETRY_HEARTBEAT
+	20, //TELEMETRY_ATTITUDE
+	5, //TELEMETRY_GPS
+	1, //TELEMETRY_GEOFENCE
+	0.2f, //TELEMETRY_TASKS
+	1, //TELEMETRY_INTERCHIP
+};
+
+static TelemetryScheduler scheduler;
+static uint8_t sequence = 0;
+
+static UplinkMission mission;
+
+//answers to commands, waiting for room on the link. Only the telemetry task touches these
+static TelemetryAck acks[TELEMETRY_MAX_PENDING_ACKS];
+static uint8_t first_ack = 0;
+static uint8_t ack_count = 0;
+
+//rate changes from other tasks, taken up by the telemetry task. Only touched in critical sections
+static float pending_rates[TELEMETRY_MESSAGE_COUNT];
+static uint32_t pending_mask = 0;
+
+static UARTSettings make_settings() {
+	UARTSettings settings;
+	settings.baudrate = TELEMETRY_BAUDRATE;
+	settings.parity = UART_NO_PARITY;
+	settings.stop_bits = 1;
+	return settings;
+}
+
+static UARTPort port(UART_PORT1, make_settings());
+
+//only for commands that arrive split around the end of the receive ring, the rest are decoded where they are
+static uint8_t uplink_buffer[TELEMETRY_MAX_CONTENT_LEN];
+static FramedPort link(port, TELEMETRY_FRAMING, uplink_buffer, sizeof(uplink_buffer));
+
+static void take_pending_rates() {
+	float rates[TELEMETRY_MESSAGE_COUNT];
+	uint32_t mask;
+
+	taskENTER_CRITICAL();
+	mask = pending_mask;
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		rates[i] = pending_rates[i];
+	}
+	pending_mask = 0;
+	taskEXIT_CRITICAL();
+
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		if (mask & (1u << i)) scheduler.set_rate((TelemetryMessageId) i, rates[i]);
+	}
+}
+
+/***********************************************************************************************************************
+ * Downlink
+ **********************************************************************************************************************/
+
+static uint8_t flags(const GpsData_t *gps, bool has_gps, const GeofenceStatus *fence, bool has_fence) {
+	uint8_t value = 0;
+	if (Planner_IsBusy()) value |= TELEMETRY_FLAG_PLANNER_BUSY;
+	if (has_gps && gps->sensorStatus > 0) value |= TELEMETRY_FLAG_GPS_FIX;
+	if (has_fence) value |= TELEMETRY_FLAG_GEOFENCE_ACTIVE;
+	if (has_fence && fence->breached) value |= TELEMETRY_FLAG_GEOFENCE_BREACHED;
+	return value;
+}
+
+/**
+ * Sends one message, if there's anything to send for it and the link can take it
+ * @return false if it has to wait for the link
+ */
+static bool send(TelemetryMessageId id, uint64_t now_us) {
+	//everything's read straight out of where it's published, and written from there into the queue
+	static SystemMonitorSnapshot system;
+	static SFOutput_t attitude;
+	static GpsData_t gps;
+	static GeofenceStatus fence;
+	static InterchipStatsSnapshot interchip;
+	static Interchip_LinkHealth safety_link;
+	bool available = true;
+	uint16_t payload_len = 0;
+
+	switch (id) {
+		case TELEMETRY_HEARTBEAT:
+			SystemMonitor_GetSnapshot(&system);
+			payload_len = TELEMETRY_HEARTBEAT_LEN;
+			break;
+		case TELEMETRY_ATTITUDE:
+			available = sensorFusionMode::ReadPublishedSFOutput(&attitude) != 0;
+			payload_len = TELEMETRY_ATTITUDE_LEN;
+			break;
+		case TELEMETRY_GPS:
+			available = GpsService_GetLatest(&gps);
+			payload_len = TELEMETRY_GPS_LEN;
+			break;
+		case TELEMETRY_GEOFENCE:
+			available = PM_GetGeofenceStatus(&fence);
+			payload_len = TELEMETRY_GEOFENCE_LEN;
+			break;
+		case TELEMETRY_INTERCHIP:
+			Interchip_GetLinkStats(&interchip, &safety_link);
+			payload_len = TELEMETRY_INTERCHIP_LEN;
+			break;
+		default:
+			SystemMonitor_GetSnapshot(&system);
+			payload_len = telemetry_tasks_len(system.task_count);
+			break;
+	}
+
+	if (!available) {
+		scheduler.skip(id);
+		return true;
+	}
+
+	size_t len = telemetry_frame_len(payload_len);
+	DMATxRegion region;
+	if (port.transmit_reserve(len, region) != STATUS_CODE_OK) return false;
+	if (!scheduler.spend(len, now_us)) {
+		port.transmit_commit(0);
+		return false;
+	}
+
+	TelemetryWriter writer(region, id, sequence++);
+	switch (id) {
+		case TELEMETRY_HEARTBEAT: {
+			bool has_gps = GpsService_GetLatest(&gps);
+			bool has_fence = PM_GetGeofenceStatus(&fence);
+			telemetry_write_heartbeat(writer, get_system_time(), system, flags(&gps, has_gps, &fence, has_fence));
+			break;
+		}
+		case TELEMETRY_ATTITUDE: telemetry_write_attitude(writer, attitude); break;
+		case TELEMETRY_GPS: telemetry_write_gps(writer, gps); break;
+		case TELEMETRY_GEOFENCE: telemetry_write_geofence(writer, fence); break;
+		case TELEMETRY_INTERCHIP: telemetry_write_interchip(writer, interchip, safety_link); break;
+		default: telemetry_write_tasks(writer, system); break;
+	}
+
+	port.transmit_commit(writer.finish());
+	scheduler.sent(id);
+	return true;
+}
+
+/**
+ * Sends the oldest ack waiting, if the link can take it
+ * @return false if it has to wait for the link
+ */
+static bool send_ack(uint64_t now_us) {
+	size_t len = telemetry_frame_len(TELEMETRY_ACK_LEN);
+	DMATxRegion region;
+	if (port.transmit_reserve(len, region) != STATUS_CODE_OK) return false;
+	if (!scheduler.spend(len, now_us)) {
+		port.transmit_commit(0);
+		return false;
+	}
+
+	TelemetryWriter writer(region, TELEMETRY_ACK, sequence++);
+	telemetry_write_ack(writer, acks[first_ack]);
+	port.transmit_commit(writer.finish());
+
+	first_ack = (uint8_t) ((first_ack + 1) % TELEMETRY_MAX_PENDING_ACKS);
+	ack_count--;
+	return true;
+}
+
+/***********************************************************************************************************************
+ * Uplink
+ **********************************************************************************************************************/
+
+static void queue_ack(const uint8_t *frame, StatusCode status, uint8_t detail) {
+	//the ground sends a command again if it's not acked, so one that can't be acked is as good as lost anyway
+	if (ack_count == TELEMETRY_MAX_PENDING_ACKS) return;
+
+	TelemetryAck &ack = acks[(first_ack + ack_count) % TELEMETRY_MAX_PENDING_ACKS];
+	ack.id = frame[0];
+	ack.sequence = frame[1];
+	ack.status = (uint8_t) status;
+	ack.detail = detail;
+	ack_count++;
+}
+
+static StatusCode set_parameter(const UplinkParameterWrite &parameter) {
+	if (parameter.id <= UPLINK_PARAM_TELEMETRY_RATE_LAST) {
+		return scheduler.set_rate((TelemetryMessageId) (parameter.id - UPLINK_PARAM_TELEMETRY_RATE), parameter.value);
+	}
+	return STATUS_CODE_INVALID_ARGS;
+}
+
+static StatusCode hand_over_mission(uint8_t transfer) {
+	StatusCode status = mission.finish(transfer);
+	if (status != STATUS_CODE_OK || mission.was_handed_over()) return status;
+
+	//planned in the background, so a long mission never holds up this task or the control loop
+	status = Planner_RequestMission(&mission.home(), mission.waypoints(), mission.count());
+	if (status == STATUS_CODE_OK) {
+		mission.handed_over();
+		LOG_INFO("uplink: mission of %u waypoints handed to the planner", mission.count());
+	}
+	return status;
+}
+
+static void handle_frame(void *context, const uint8_t *frame, size_t len) {
+	if (len < TELEMETRY_HEADER_LEN) return;
+
+	const uint8_t *payload = frame + TELEMETRY_HEADER_LEN;
+	size_t payload_len = len - TELEMETRY_HEADER_LEN;
+	StatusCode status = STATUS_CODE_INVALID_ARGS;
+	uint8_t detail = 0;
+
+	switch (frame[0]) {
+		case UPLINK_SETPOINT: {
+			UplinkSetpoint setpoint;
+			if (!uplink_parse_setpoint(payload, payload_len, setpoint) || setpoint.hold_ms > UPLINK_MAX_HOLD_MS) break;
+
+			PM_SetOverride(&setpoint.commands, setpoint.hold_ms);
+			status = STATUS_CODE_OK;
+			break;
+		}
+		case UPLINK_PARAM_SET: {
+			UplinkParameterWrite parameter;
+			if (uplink_parse_parameter(payload, payload_len, parameter)) status = set_parameter(parameter);
+			break;
+		}
+		case UPLINK_MISSION_START: {
+			UplinkMissionStart start;
+			if (uplink_parse_mission_start(payload, payload_len, start)) status = mission.start(start);
+			detail = mission.received();
+			break;
+		}
+		case UPLINK_MISSION_CHUNK: {
+			UplinkMissionChunk chunk;
+			if (uplink_parse_mission_chunk(payload, payload_len, chunk)) status = mission.add(chunk);
+			detail = mission.received();
+			break;
+		}
+		case UPLINK_MISSION_END: {
+			if (payload_len == UPLINK_MISSION_END_LEN) status = hand_over_mission(payload[0]);
+			detail = mission.received();
+			break;
+		}
+		default:
+			status = STATUS_CODE_UNIMPLEMENTED;
+			break;
+	}
+
+	queue_ack(frame, status, detail);
+}
+
+/***********************************************************************************************************************
+ * Task
+ **********************************************************************************************************************/
+
+void Telemetry_Run(void const *argument) {
+	port.setup();
+	StatusCode status = port.setupDMA(TELEMETRY_TX_QUEUE_LEN, TELEMETRY_RX_BUFFER_LEN);
+	if (status != STATUS_CODE_OK) {
+		LOG_ERROR("telemetry: no dma (status %d), link is down", status);
+		osThreadTerminate(NULL);
+		return;
+	}
+
+	link.add_handler(handle_frame, nullptr);
+
+	scheduler.set_link(TELEMETRY_BAUDRATE / 10 * TELEMETRY_LINK_PERCENT / 100, TELEMETRY_TX_QUEUE_LEN);
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		scheduler.set_rate((TelemetryMessageId) i, TELEMETRY_DEFAULT_RATES[i]);
+	}
+	LOG_INFO("telemetry: sending at %u baud", TELEMETRY_BAUDRATE);
+
+	for (;;) {
+		take_pending_rates();
+
+		link.receive(TELEMETRY_RX_BYTES_PER_PERIOD);
+
+		uint64_t now = get_system_time_us();
+		while (ack_count > 0 && send_ack(now)) {
+		}
+		for (;;) {
+			TelemetryMessageId id = scheduler.next(now);
+			if (id == TELEMETRY_NONE || !send(id, now)) break;
+		}
+
+		osDelay(TELEMETRY_PERIOD_MS);
+	}
+}
+
+StatusCode Telemetry_SetRate(uint8_t id, float rate_hz) {
+	if (id >= TELEMETRY_MESSAGE_COUNT || !(rate_hz >= 0)) return STATUS_CODE_INVALID_ARGS;
+
+	taskENTER_CRITICAL();
+	pending_rates[id] = rate_hz;
+	pending_mask |= 1u << id;
+	taskEXIT_CRITICAL();
+
+	return STATUS_CODE_OK;
+}
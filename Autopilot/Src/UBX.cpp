@@ -0,0 +1,254 @@
+#include "UBX.hpp"
+#include <string.h>
+
+//CFG-PRT fields for 8 data bits, no parity and 1 stop bit, and the protocol masks
+static const uint32_t UBX_PRT_MODE_8N1 = 0x000008D0;
+static const uint16_t UBX_PROTOCOL_UBX = 0x0001;
+static const uint16_t UBX_PROTOCOL_NMEA = 0x0002;
+static const uint8_t UBX_PORT_UART1 = 1;
+static const uint16_t UBX_TIME_REF_GPS = 1;
+
+//NAV-PVT bitfields
+static const uint8_t UBX_PVT_VALID_DATE = 1U << 0;
+static const uint8_t UBX_PVT_VALID_TIME = 1U << 1;
+static const uint8_t UBX_PVT_FLAGS_FIX_OK = 1U << 0;
+static const uint8_t UBX_PVT_FLAGS_DIFFERENTIAL = 1U << 1;
+
+static inline uint16_t load_le16(const uint8_t *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static inline uint32_t load_le32(const uint8_t *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline void store_le16(uint8_t *p, uint16_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static inline void store_le32(uint8_t *p, uint32_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+	p[2] = (uint8_t) (value >> 16);
+	p[3] = (uint8_t) (value >> 24);
+}
+
+inline bool UBXParser::parse(uint8_t byte) {
+	uint32_t here = position++;
+
+	switch (state) {
+		case UBX_SYNC_1_STATE:
+			if (byte == UBX_SYNC_1) {
+				state = UBX_SYNC_2_STATE;
+				start = here;
+			}
+			return false;
+
+		case UBX_SYNC_2_STATE:
+			//a repeated first sync byte could still be the start of a frame
+			if (byte == UBX_SYNC_2) {
+				state = UBX_CLASS_STATE;
+				ck_a = 0;
+				ck_b = 0;
+			} else if (byte == UBX_SYNC_1) {
+				start = here;
+			} else {
+				state = UBX_SYNC_1_STATE;
+			}
+			return false;
+
+		case UBX_CLASS_STATE:
+			frame_class = byte;
+			state = UBX_ID_STATE;
+			break;
+
+		case UBX_ID_STATE:
+			frame_id = byte;
+			state = UBX_LENGTH_LOW_STATE;
+			break;
+
+		case UBX_LENGTH_LOW_STATE:
+			length = byte;
+			state = UBX_LENGTH_HIGH_STATE;
+			break;
+
+		case UBX_LENGTH_HIGH_STATE:
+			length |= (uint16_t) (byte << 8);
+			received = 0;
+
+			//most likely sync bytes turning up inside a payload. Waiting out a bogus length could swallow up to 64k of
+			//good frames, so hunt for the next sync straight away instead
+			if (length > UBX_MAX_PAYLOAD_LEN) {
+				skipped++;
+				state = UBX_SYNC_1_STATE;
+				return false;
+			}
+			state = length == 0 ? UBX_CK_A_STATE : UBX_PAYLOAD_STATE;
+			break;
+
+		case UBX_PAYLOAD_STATE:
+			data[received] = byte;
+			if (++received == length) state = UBX_CK_A_STATE;
+			break;
+
+		case UBX_CK_A_STATE:
+			if (byte != ck_a) {
+				bad_checksums++;
+				state = UBX_SYNC_1_STATE;
+				return false;
+			}
+			state = UBX_CK_B_STATE;
+			return false;
+
+		case UBX_CK_B_STATE:
+			state = UBX_SYNC_1_STATE;
+			if (byte != ck_b) {
+				bad_checksums++;
+				return false;
+			}
+			return true;
+	}
+
+	ck_a = (uint8_t) (ck_a + byte);
+	ck_b = (uint8_t) (ck_b + ck_a);
+	return false;
+}
+
+bool UBXParser::feed(uint8_t byte) {
+	return parse(byte);
+}
+
+size_t UBXParser::feed(const uint8_t *bytes, size_t len, bool &complete) {
+	complete = false;
+
+	for (size_t i = 0; i < len; i++) {
+		//the payload is most of a frame, so copy and checksum it in one go
+		if (state == UBX_PAYLOAD_STATE) {
+			size_t run = length - received;
+			if (run > len - i) run = len - i;
+
+			uint8_t a = ck_a;
+			uint8_t b = ck_b;
+			for (size_t j = 0; j < run; j++) {
+				a = (uint8_t) (a + bytes[i + j]);
+				b = (uint8_t) (b + a);
+			}
+			ck_a = a;
+			ck_b = b;
+
+			memcpy(&data[received], &bytes[i], run);
+
+			received = (uint16_t) (received + run);
+			position += (uint32_t) run;
+			if (received == length) state = UBX_CK_A_STATE;
+			i += run - 1;
+			continue;
+		}
+
+		if (parse(bytes[i])) {
+			complete = true;
+			return i + 1;
+		}
+	}
+
+	return len;
+}
+
+bool UBXParser::feed(ByteRing &ring) {
+	const uint8_t *bytes;
+	size_t len;
+
+	//the unread data can be split in two at the end of the ring
+	while ((len = ring.peek(bytes)) > 0) {
+		bool complete;
+		ring.consume(feed(bytes, len, complete));
+		if (complete) return true;
+	}
+
+	return false;
+}
+
+StatusCode ubx_decode_nav_pvt(const uint8_t *payload, uint16_t len, UBXNavPVT &pvt) {
+	if (payload == nullptr || len < UBX_NAV_PVT_MIN_LEN) return STATUS_CODE_INVALID_ARGS;
+
+	pvt.itow_ms = load_le32(&payload[0]);
+	pvt.year = load_le16(&payload[4]);
+	pvt.month = payload[6];
+	pvt.day = payload[7];
+	pvt.hour = payload[8];
+	pvt.minute = payload[9];
+	pvt.second = payload[10];
+	pvt.date_valid = (payload[11] & UBX_PVT_VALID_DATE) != 0;
+	pvt.time_valid = (payload[11] & UBX_PVT_VALID_TIME) != 0;
+	pvt.nano = (int32_t) load_le32(&payload[16]);
+	pvt.fix_type = (UBXFixType) payload[20];
+	pvt.fix_ok = (payload[21] & UBX_PVT_FLAGS_FIX_OK) != 0;
+	pvt.differential = (payload[21] & UBX_PVT_FLAGS_DIFFERENTIAL) != 0;
+	pvt.satellites = payload[23];
+	pvt.longitude = (int32_t) load_le32(&payload[24]);
+	pvt.latitude = (int32_t) load_le32(&payload[28]);
+	pvt.height_mm = (int32_t) load_le32(&payload[32]);
+	pvt.height_msl_mm = (int32_t) load_le32(&payload[36]);
+	pvt.horizontal_accuracy_mm = load_le32(&payload[40]);
+	pvt.vertical_accuracy_mm = load_le32(&payload[44]);
+	pvt.velocity_north_mm_s = (int32_t) load_le32(&payload[48]);
+	pvt.velocity_east_mm_s = (int32_t) load_le32(&payload[52]);
+	pvt.velocity_down_mm_s = (int32_t) load_le32(&payload[56]);
+	pvt.ground_speed_mm_s = (int32_t) load_le32(&payload[60]);
+	pvt.heading_of_motion = (int32_t) load_le32(&payload[64]);
+	pvt.speed_accuracy_mm_s = load_le32(&payload[68]);
+	pvt.heading_accuracy = load_le32(&payload[72]);
+	pvt.pdop = load_le16(&payload[76]);
+
+	return STATUS_CODE_OK;
+}
+
+size_t ubx_build_frame(uint8_t message_class, uint8_t message_id, const uint8_t *payload, uint16_t len, uint8_t *out,
+					   size_t out_len) {
+	if (out == nullptr || out_len < (size_t) len + UBX_FRAME_OVERHEAD) return 0;
+
+	out[0] = UBX_SYNC_1;
+	out[1] = UBX_SYNC_2;
+	out[2] = message_class;
+	out[3] = message_id;
+	store_le16(&out[4], len);
+	if (len > 0) memcpy(&out[6], payload, len);
+
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+	for (size_t i = 2; i < (size_t) len + 6; i++) {
+		ck_a = (uint8_t) (ck_a + out[i]);
+		ck_b = (uint8_t) (ck_b + ck_a);
+	}
+	out[len + 6] = ck_a;
+	out[len + 7] = ck_b;
+
+	return (size_t) len + UBX_FRAME_OVERHEAD;
+}
+
+size_t ubx_build_cfg_prt(uint32_t baudrate, uint8_t *out, size_t out_len) {
+	uint8_t payload[20] = {};
+	payload[0] = UBX_PORT_UART1;
+	store_le32(&payload[4], UBX_PRT_MODE_8N1);
+	store_le32(&payload[8], baudrate);
+	store_le16(&payload[12], UBX_PROTOCOL_UBX | UBX_PROTOCOL_NMEA);
+	store_le16(&payload[14], UBX_PROTOCOL_UBX);
+
+	return ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_PRT, payload, sizeof(payload), out, out_len);
+}
+
+size_t ubx_build_cfg_rate(uint16_t measurement_period_ms, uint8_t *out, size_t out_len) {
+	uint8_t payload[6];
+	store_le16(&payload[0], measurement_period_ms);
+	store_le16(&payload[2], 1); //a solution for every measurement
+	store_le16(&payload[4], UBX_TIME_REF_GPS);
+
+	return ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_RATE, payload, sizeof(payload), out, out_len);
+}
+
+size_t ubx_build_cfg_msg(uint8_t message_class, uint8_t message_id, uint8_t rate, uint8_t *out, size_t out_len) {
+	uint8_t payload[3] = {message_class, message_id, rate};
+
+	return ubx_build_frame(UBX_CLASS_CFG, UBX_ID_CFG_MSG, payload, sizeof(payload), out, out_len);
+}
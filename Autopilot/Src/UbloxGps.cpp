@@ -0,0 +1,153 @@
+#include "UbloxGps.hpp"
+#include "Clock.hpp"
+#include <string.h>
+
+//big enough for CFG-PRT, the largest thing we send
+static const size_t UBLOX_TX_FRAME_LEN = 32;
+static const size_t UBLOX_READ_CHUNK_LEN = 64;
+
+static UARTSettings make_settings() {
+	UARTSettings settings;
+	settings.baudrate = UBLOX_DEFAULT_BAUDRATE;
+	settings.parity = UART_NO_PARITY;
+	settings.stop_bits = 1;
+	settings.timeout = 50;
+	return settings;
+}
+
+UbloxGps::UbloxGps(UARTPortNum port_num) : port(port_num, make_settings()) {
+	memset(&pvt, 0, sizeof(pvt));
+	memset(&data, 0, sizeof(data));
+}
+
+void UbloxGps::Init(void) {
+	port.setup();
+	configure();
+}
+
+void UbloxGps::BeginMeasuring(void) {
+	uint8_t chunk[UBLOX_READ_CHUNK_LEN];
+	size_t bytes_read;
+
+	while (port.read_bytes(chunk, sizeof(chunk), bytes_read) == STATUS_CODE_OK && bytes_read > 0) {
+		size_t position = 0;
+
+		while (position < bytes_read) {
+			bool complete;
+			position += parser.feed(&chunk[position], bytes_read - position, complete);
+			if (!complete) continue;
+
+			if (parser.is(UBX_CLASS_NAV, UBX_ID_NAV_PVT)) {
+				if (ubx_decode_nav_pvt(parser.payload(), parser.payload_length(), pvt) == STATUS_CODE_OK) {
+					last_solution_us = get_system_time_us();
+					reconfigure_timeout_us = UBLOX_RECONFIGURE_TIMEOUT_US;
+					retries = 0;
+
+					//read too late to tell, the time it was parsed is the best there is
+					uint64_t received_us;
+					if (port.rx_arrival_time(parser.frame_start(), received_us) != STATUS_CODE_OK) {
+						received_us = last_solution_us;
+					}
+
+					convert_solution(received_us);
+					published.publish(data);
+				}
+			} else if (parser.is(UBX_CLASS_ACK, UBX_ID_ACK_NAK)) {
+				naks++;
+			}
+		}
+	}
+
+	uint64_t now = get_system_time_us();
+	if (step != UBLOX_CONFIGURED) {
+		step_configuration(now);
+	} else if (now - last_solution_us > reconfigure_timeout_us) {
+		//sending it again didn't help last time, so it's probably not listening. No need to keep at it as often
+		if (retries > 0 && reconfigure_timeout_us < UBLOX_MAX_RECONFIGURE_TIMEOUT_US) reconfigure_timeout_us *= 2;
+		retries++;
+		reconfigured++;
+		configure();
+	}
+}
+
+void UbloxGps::GetResult(GpsData_t *Data) {
+	uint32_t count = published.read(*Data);
+	if (count == 0) memset(Data, 0, sizeof(*Data));
+
+	Data->dataIsNew = count != last_read;
+	last_read = count;
+}
+
+void UbloxGps::configure() {
+	//the receiver could be at its default baudrate, or still at ours if only the autopilot was reset. Asking for the
+	//new baudrate at both covers either case
+	switch_baudrate(UBLOX_DEFAULT_BAUDRATE);
+	send_cfg_prt(get_system_time_us());
+	step = UBLOX_SENT_AT_DEFAULT_BAUDRATE;
+}
+
+void UbloxGps::step_configuration(uint64_t now_us) {
+	if (now_us < step_due_us) return;
+
+	if (step == UBLOX_SENT_AT_DEFAULT_BAUDRATE) {
+		switch_baudrate(UBLOX_BAUDRATE);
+		send_cfg_prt(now_us);
+		step = UBLOX_SENT_AT_NEW_BAUDRATE;
+		return;
+	}
+
+	uint8_t frame[UBLOX_TX_FRAME_LEN];
+	size_t len = ubx_build_cfg_rate(UBLOX_MEASUREMENT_PERIOD_MS, frame, sizeof(frame));
+	send(frame, len);
+	len = ubx_build_cfg_msg(UBX_CLASS_NAV, UBX_ID_NAV_PVT, 1, frame, sizeof(frame));
+	send(frame, len);
+	step = UBLOX_CONFIGURED;
+
+	//give it the full timeout to start sending before trying again
+	last_solution_us = now_us;
+}
+
+void UbloxGps::switch_baudrate(uint32_t baudrate) {
+	//setting the baudrate sets the uart up again without dma, and throws away whatever was received at the old one
+	this->baudrate = baudrate;
+	port.adjustBaudrate(baudrate);
+	port.setupDMA(UBLOX_TX_QUEUE_LEN, UBLOX_RX_BUFFER_LEN);
+	parser.reset();
+}
+
+void UbloxGps::send_cfg_prt(uint64_t now_us) {
+	uint8_t frame[UBLOX_TX_FRAME_LEN];
+	size_t len = ubx_build_cfg_prt(UBLOX_BAUDRATE, frame, sizeof(frame));
+	send(frame, len);
+
+	//the baudrate can't change until it's all out, or the rest of it would be thrown away. 10 bits a byte
+	uint64_t wire_us = len * 10 * 1000000ULL / baudrate;
+	step_due_us = now_us + wire_us + UBLOX_BAUDRATE_SWITCH_MS * 1000;
+}
+
+void UbloxGps::send(const uint8_t *frame, size_t len) {
+	//only queued, tx dma sends it in the background
+	port.transmit(const_cast<uint8_t *>(frame), len);
+}
+
+void UbloxGps::convert_solution(uint64_t received_us) {
+	data.position.latitude = pvt.latitude;
+	data.position.longitude = pvt.longitude;
+	data.position.altitude_mm = pvt.height_msl_mm;
+	data.utcTime = pvt.hour * 3600.0f + pvt.minute * 60.0f + pvt.second + pvt.nano * 1e-9f;
+	data.groundSpeed = pvt.ground_speed_mm_s * 1e-3f;
+	data.heading = (int16_t) (pvt.heading_of_motion / 100000);
+	data.velocityNorth = pvt.velocity_north_mm_s * 1e-3f;
+	data.velocityEast = pvt.velocity_east_mm_s * 1e-3f;
+	data.velocityDown = pvt.velocity_down_mm_s * 1e-3f;
+	data.horizontalAccuracy = pvt.horizontal_accuracy_mm * 1e-3f;
+	data.verticalAccuracy = pvt.vertical_accuracy_mm * 1e-3f;
+	data.numSatellites = pvt.satellites;
+
+	//same codes as the NMEA fix quality: 0 = no fix, 1 = gps fix, 2 = differential
+	bool has_fix = pvt.fix_ok && (pvt.fix_type == UBX_FIX_2D || pvt.fix_type == UBX_FIX_3D
+		|| pvt.fix_type == UBX_FIX_GNSS_DEAD_RECKONING);
+	data.sensorStatus = has_fix ? (pvt.differential ? 2 : 1) : 0;
+
+	data.receivedTimeUs = received_us;
+}
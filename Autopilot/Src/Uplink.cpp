@@ -0,0 +1,114 @@
+#include "Uplink.hpp"
+#include <string.h>
+
+/***********************************************************************************************************************
+ * Messages
+ **********************************************************************************************************************/
+
+static uint16_t get_u16(const uint8_t *data) {
+	return (uint16_t) (data[0] | (data[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *data) {
+	return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static float get_float(const uint8_t *data) {
+	uint32_t bits = get_u32(data);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static GeoPosition get_position(const uint8_t *data) {
+	GeoPosition position;
+	position.latitude = (int32_t) get_u32(data);
+	position.longitude = (int32_t) get_u32(data + 4);
+	position.altitude_mm = (int32_t) get_u32(data + 8);
+	return position;
+}
+
+bool uplink_parse_setpoint(const uint8_t *payload, size_t len, UplinkSetpoint &setpoint) {
+	if (len != UPLINK_SETPOINT_LEN) return false;
+
+	setpoint.commands.roll = get_float(payload);
+	setpoint.commands.pitch = get_float(payload + 4);
+	setpoint.commands.yaw = get_float(payload + 8);
+	setpoint.commands.airspeed = get_float(payload + 12);
+	setpoint.hold_ms = get_u16(payload + 16);
+	return true;
+}
+
+bool uplink_parse_parameter(const uint8_t *payload, size_t len, UplinkParameterWrite &parameter) {
+	if (len != UPLINK_PARAM_SET_LEN) return false;
+
+	parameter.id = get_u16(payload);
+	parameter.value = get_float(payload + 2);
+	return true;
+}
+
+bool uplink_parse_mission_start(const uint8_t *payload, size_t len, UplinkMissionStart &start) {
+	if (len != UPLINK_MISSION_START_LEN) return false;
+
+	start.transfer = payload[0];
+	start.count = payload[1];
+	start.home = get_position(payload + 2);
+	return true;
+}
+
+bool uplink_parse_mission_chunk(const uint8_t *payload, size_t len, UplinkMissionChunk &chunk) {
+	if (len < UPLINK_MISSION_CHUNK_HEADER_LEN + UPLINK_WAYPOINT_LEN) return false;
+	if ((len - UPLINK_MISSION_CHUNK_HEADER_LEN) % UPLINK_WAYPOINT_LEN != 0) return false;
+
+	chunk.transfer = payload[0];
+	chunk.first = payload[1];
+	chunk.count = (uint8_t) ((len - UPLINK_MISSION_CHUNK_HEADER_LEN) / UPLINK_WAYPOINT_LEN);
+	chunk.waypoints = payload + UPLINK_MISSION_CHUNK_HEADER_LEN;
+	return true;
+}
+
+/***********************************************************************************************************************
+ * Missions
+ **********************************************************************************************************************/
+
+UplinkMission::UplinkMission() : started(false), submitted(false), transfer(0), expected(0), arrived(0) {
+	memset(&mission_home, 0, sizeof(mission_home));
+}
+
+StatusCode UplinkMission::start(const UplinkMissionStart &start) {
+	if (start.count < 2 || start.count > PATH_MAX_WAYPOINTS) return STATUS_CODE_INVALID_ARGS;
+
+	bool repeated = started && start.transfer == transfer && start.count == expected
+		&& memcmp(&start.home, &mission_home, sizeof(mission_home)) == 0;
+	if (repeated) return STATUS_CODE_OK;
+
+	started = true;
+	submitted = false;
+	transfer = start.transfer;
+	expected = start.count;
+	arrived = 0;
+	mission_home = start.home;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UplinkMission::add(const UplinkMissionChunk &chunk) {
+	if (!started || chunk.transfer != transfer || submitted) return STATUS_CODE_UNINITIALIZED;
+	if (chunk.first > arrived || chunk.first + chunk.count > expected) return STATUS_CODE_OUT_OF_RANGE;
+
+	for (uint8_t i = 0; i < chunk.count; i++) {
+		const uint8_t *packed = chunk.waypoints + i * UPLINK_WAYPOINT_LEN;
+		Waypoint &waypoint = mission[chunk.first + i];
+		waypoint.position = get_position(packed);
+		waypoint.airspeed = get_float(packed + 12);
+	}
+
+	//a chunk sent again can overlap what's arrived, but only ever moves it on
+	if (chunk.first + chunk.count > arrived) arrived = (uint8_t) (chunk.first + chunk.count);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UplinkMission::finish(uint8_t transfer) const {
+	if (!started || transfer != this->transfer) return STATUS_CODE_UNINITIALIZED;
+	if (arrived < expected) return STATUS_CODE_OUT_OF_RANGE;
+	return STATUS_CODE_OK;
+}
@@ -76,7 +76,11 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+osThreadId LogHandle;
+osThreadId SystemMonitorHandle;
+osThreadId PlannerHandle;
+osThreadId GpsServiceHandle;
+osThreadId TelemetryHandle;
 /* USER CODE END Variables */
 osThreadId defaultTaskHandle;
 osThreadId InterchipHandle;
@@ -84,7 +88,13 @@ osThreadId AttitudeHandle;
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
-
+extern void binary_log_flush(void);
+extern void rtos_trace_service(void);
+extern void SystemMonitor_Run(void const * argument);
+extern void Planner_Run(void const * argument);
+extern void GpsService_Run(void const * argument);
+extern void Telemetry_Run(void const * argument);
+static void Log_Run(void const * argument);
 /* USER CODE END FunctionPrototypes */
 
 void StartDefaultTask(void const * argument);
@@ -125,6 +135,27 @@ void MX_FREERTOS_Init(void) {
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  /* drains the binary log out of the debug port whenever nothing more important needs the cpu, along with
+     scheduler trace dumps */
+  osThreadDef(Log, Log_Run, osPriorityLow, 0, 128);
+  LogHandle = osThreadCreate(osThread(Log), NULL);
+
+  /* samples stack, heap and cpu usage of every task. Its own stack is bigger, for the room logging needs */
+  osThreadDef(SystemMonitor, SystemMonitor_Run, osPriorityBelowNormal, 0, 256);
+  SystemMonitorHandle = osThreadCreate(osThread(SystemMonitor), NULL);
+
+  /* plans paths in the background, a leg at a time. Same stack as the monitor, for logging */
+  osThreadDef(Planner, Planner_Run, osPriorityLow, 0, 256);
+  PlannerHandle = osThreadCreate(osThread(Planner), NULL);
+
+  /* parses the gps and publishes each fix, so nobody else waits on it. Above the planner so fixes aren't held up
+     while a plan is worked out */
+  osThreadDef(GpsService, GpsService_Run, osPriorityBelowNormal, 0, 256);
+  GpsServiceHandle = osThreadCreate(osThread(GpsService), NULL);
+
+  /* sends telemetry to the ground. Nothing waits on it, so it only gets what's left over */
+  osThreadDef(Telemetry, Telemetry_Run, osPriorityLow, 0, 256);
+  TelemetryHandle = osThreadCreate(osThread(Telemetry), NULL);
   /* USER CODE END RTOS_THREADS */
 
   /* USER CODE BEGIN RTOS_QUEUES */
@@ -153,7 +184,15 @@ void StartDefaultTask(void const * argument)
 
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
-     
+static void Log_Run(void const * argument)
+{
+  for(;;)
+  {
+    rtos_trace_service();
+    binary_log_flush();
+    osDelay(10);
+  }
+}
 /* USER CODE END Application */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
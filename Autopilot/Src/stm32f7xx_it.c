@@ -40,6 +40,7 @@
 #include "DMA.hpp"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "RTOSTrace.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -89,6 +90,11 @@ extern DMAConfig uart2_dma_config;
 extern DMAConfig uart3_dma_config;
 extern DMAConfig uart4_dma_config;
 
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+extern DMA_HandleTypeDef hdma_usart3_tx;
+extern DMA_HandleTypeDef hdma_usart4_tx;
+
 /* USER CODE BEGIN EV */
 
 /* USER CODE END EV */
@@ -195,11 +201,13 @@ void DebugMon_Handler(void)
 void WWDG_IRQHandler(void)
 {
   /* USER CODE BEGIN WWDG_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END WWDG_IRQn 0 */
   HAL_WWDG_IRQHandler(&hwwdg);
   /* USER CODE BEGIN WWDG_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END WWDG_IRQn 1 */
 }
 
@@ -209,11 +217,13 @@ void WWDG_IRQHandler(void)
 void TIM1_UP_TIM10_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_UP_TIM10_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END TIM1_UP_TIM10_IRQn 0 */
   HAL_TIM_IRQHandler(&htim10);
   /* USER CODE BEGIN TIM1_UP_TIM10_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END TIM1_UP_TIM10_IRQn 1 */
 }
 
@@ -223,11 +233,13 @@ void TIM1_UP_TIM10_IRQHandler(void)
 void TIM4_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM4_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END TIM4_IRQn 0 */
   HAL_TIM_IRQHandler(&htim4);
   /* USER CODE BEGIN TIM4_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END TIM4_IRQn 1 */
 }
 
@@ -237,11 +249,13 @@ void TIM4_IRQHandler(void)
 void I2C1_EV_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C1_EV_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END I2C1_EV_IRQn 0 */
   HAL_I2C_EV_IRQHandler(&hi2c1);
   /* USER CODE BEGIN I2C1_EV_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END I2C1_EV_IRQn 1 */
 }
 
@@ -251,11 +265,13 @@ void I2C1_EV_IRQHandler(void)
 void SPI1_IRQHandler(void)
 {
   /* USER CODE BEGIN SPI1_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END SPI1_IRQn 0 */
   HAL_SPI_IRQHandler(&hspi1);
   /* USER CODE BEGIN SPI1_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END SPI1_IRQn 1 */
 }
 
@@ -265,16 +281,18 @@ void SPI1_IRQHandler(void)
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
-  if ((USART1->ISR & USART_ISR_IDLE) != RESET) {
+  rtos_trace_isr_enter();
+  if ((USART1->CR1 & USART_CR1_IDLEIE) && (USART1->ISR & USART_ISR_IDLE) != RESET) {
     USART1->ICR = UART_CLEAR_IDLEF;
-    /* Start DMA timer */
-    uart1_dma_config.timer = uart1_dma_config.timeout;
+    /* Line went idle, deliver whatever the DMA has received so far */
+    processDMARXEvent(&uart1_dma_config);
   }
 
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END USART1_IRQn 1 */
 }
 
@@ -284,17 +302,19 @@ void USART1_IRQHandler(void)
 void USART2_IRQHandler(void)
 {
   /* USER CODE BEGIN USART2_IRQn 0 */
+  rtos_trace_isr_enter();
   //for DMA idle line detection
-  if ((USART2->ISR & USART_ISR_IDLE) != RESET) {
+  if ((USART2->CR1 & USART_CR1_IDLEIE) && (USART2->ISR & USART_ISR_IDLE) != RESET) {
     USART2->ICR = UART_CLEAR_IDLEF;
-    /* Start DMA timer */
-    uart2_dma_config.timer = uart2_dma_config.timeout;
+    /* Line went idle, deliver whatever the DMA has received so far */
+    processDMARXEvent(&uart2_dma_config);
   }
 
   /* USER CODE END USART2_IRQn 0 */
   HAL_UART_IRQHandler(&huart2);
   /* USER CODE BEGIN USART2_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END USART2_IRQn 1 */
 }
 
@@ -303,17 +323,21 @@ void USART2_IRQHandler(void)
   */
 void USART3_IRQHandler(void)
 {
+  /* USER CODE BEGIN USART3_IRQn 0 */
+  rtos_trace_isr_enter();
+
   //for DMA idle line detection
-  if ((USART3->ISR & USART_ISR_IDLE) != RESET) {
+  if ((USART3->CR1 & USART_CR1_IDLEIE) && (USART3->ISR & USART_ISR_IDLE) != RESET) {
     USART3->ICR = UART_CLEAR_IDLEF;
-    /* Start DMA timer */
-    uart3_dma_config.timer = uart3_dma_config.timeout;
+    /* Line went idle, deliver whatever the DMA has received so far */
+    processDMARXEvent(&uart3_dma_config);
   }
 
   /* USER CODE END USART3_IRQn 0 */
   HAL_UART_IRQHandler(&huart3);
   /* USER CODE BEGIN USART3_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END USART3_IRQn 1 */
 }
 
@@ -323,16 +347,18 @@ void USART3_IRQHandler(void)
 void UART4_IRQHandler(void)
 {
   /* USER CODE BEGIN UART4_IRQn 0 */
+  rtos_trace_isr_enter();
   //for DMA idle line detection
-  if ((UART4->ISR & USART_ISR_IDLE) != RESET) {
+  if ((UART4->CR1 & USART_CR1_IDLEIE) && (UART4->ISR & USART_ISR_IDLE) != RESET) {
     UART4->ICR = UART_CLEAR_IDLEF;
-    /* Start DMA timer */
-    uart4_dma_config.timer = uart4_dma_config.timeout;
+    /* Line went idle, deliver whatever the DMA has received so far */
+    processDMARXEvent(&uart4_dma_config);
   }
   /* USER CODE END UART4_IRQn 0 */
   HAL_UART_IRQHandler(&huart4);
   /* USER CODE BEGIN UART4_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END UART4_IRQn 1 */
 }
 
@@ -342,11 +368,13 @@ void UART4_IRQHandler(void)
 void I2C4_EV_IRQHandler(void)
 {
   /* USER CODE BEGIN I2C4_EV_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END I2C4_EV_IRQn 0 */
   HAL_I2C_EV_IRQHandler(&hi2c4);
   /* USER CODE BEGIN I2C4_EV_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END I2C4_EV_IRQn 1 */
 }
 
@@ -356,6 +384,7 @@ void I2C4_EV_IRQHandler(void)
 void DMA1_Stream1_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream1_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END DMA1_Stream1_IRQn 0 */
   if (uart3_dma_config.dma_handle != NULL){
@@ -364,6 +393,7 @@ void DMA1_Stream1_IRQHandler(void)
 //  HAL_DMA_IRQHandler(&hdma_usart3_rx);
   /* USER CODE BEGIN DMA1_Stream1_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END DMA1_Stream1_IRQn 1 */
 }
 
@@ -373,6 +403,7 @@ void DMA1_Stream1_IRQHandler(void)
 void DMA1_Stream2_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream2_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END DMA1_Stream2_IRQn 0 */
   if (uart4_dma_config.dma_handle != NULL){
@@ -381,6 +412,7 @@ void DMA1_Stream2_IRQHandler(void)
 //  HAL_DMA_IRQHandler(&hdma_uart4_rx);
   /* USER CODE BEGIN DMA1_Stream2_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END DMA1_Stream2_IRQn 1 */
 }
 
@@ -390,20 +422,40 @@ void DMA1_Stream2_IRQHandler(void)
 void DMA1_Stream3_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream3_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END DMA1_Stream3_IRQn 0 */
 //  HAL_DMA_IRQHandler(&hdma_spi2_rx);
+  HAL_DMA_IRQHandler(&hdma_usart3_tx);
   /* USER CODE BEGIN DMA1_Stream3_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END DMA1_Stream3_IRQn 1 */
 }
 
+/**
+  * @brief This function handles DMA1 stream4 global interrupt.
+  */
+void DMA1_Stream4_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Stream4_IRQn 0 */
+  rtos_trace_isr_enter();
+
+  /* USER CODE END DMA1_Stream4_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_usart4_tx);
+  /* USER CODE BEGIN DMA1_Stream4_IRQn 1 */
+
+  rtos_trace_isr_exit();
+  /* USER CODE END DMA1_Stream4_IRQn 1 */
+}
+
 /**
   * @brief This function handles DMA1 stream5 global interrupt.
   */
 void DMA1_Stream5_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream5_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END DMA1_Stream5_IRQn 0 */
   if (uart2_dma_config.dma_handle != NULL){
@@ -411,6 +463,7 @@ void DMA1_Stream5_IRQHandler(void)
   }
   /* USER CODE BEGIN DMA1_Stream5_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END DMA1_Stream5_IRQn 1 */
 }
 
@@ -420,6 +473,7 @@ void DMA1_Stream5_IRQHandler(void)
 void DMA2_Stream5_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream1_IRQn 0 */
+  rtos_trace_isr_enter();
 
   /* USER CODE END DMA1_Stream1_IRQn 0 */
   if (uart1_dma_config.dma_handle != NULL){
@@ -428,9 +482,42 @@ void DMA2_Stream5_IRQHandler(void)
 //  HAL_DMA_IRQHandler(&hdma_usart3_rx);
   /* USER CODE BEGIN DMA1_Stream1_IRQn 1 */
 
+  rtos_trace_isr_exit();
   /* USER CODE END DMA1_Stream1_IRQn 1 */
 }
 
+/**
+  * @brief This function handles DMA1 stream6 global interrupt.
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Stream6_IRQn 0 */
+  rtos_trace_isr_enter();
+
+  /* USER CODE END DMA1_Stream6_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_usart2_tx);
+  /* USER CODE BEGIN DMA1_Stream6_IRQn 1 */
+
+  rtos_trace_isr_exit();
+  /* USER CODE END DMA1_Stream6_IRQn 1 */
+}
+
+/**
+  * @brief This function handles DMA2 stream7 global interrupt.
+  */
+void DMA2_Stream7_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA2_Stream7_IRQn 0 */
+  rtos_trace_isr_enter();
+
+  /* USER CODE END DMA2_Stream7_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_usart1_tx);
+  /* USER CODE BEGIN DMA2_Stream7_IRQn 1 */
+
+  rtos_trace_isr_exit();
+  /* USER CODE END DMA2_Stream7_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
 
 /* USER CODE END 1 */
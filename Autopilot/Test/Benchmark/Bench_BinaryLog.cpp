@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "BinaryLog.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t LOG_BENCH_ITERATIONS = 500000;
+static const uint32_t LOG_BENCH_RING_LEN = 4096;
+
+static char sprintf_buffer[512];
+static uint8_t log_storage[LOG_BENCH_RING_LEN];
+static BinaryLog bench_log;
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchBinaryLog, FormatVersusDeferredRecord) {
+	bench_log.init(log_storage, LOG_BENCH_RING_LEN);
+
+	volatile uint32_t time = 123456;
+	volatile float altitude = 104.25f;
+	volatile int32_t throttle = -37;
+
+	//what a call site pays in Debug.cpp today, before the text is even sent
+	run_benchmark("sprintf into the debug buffer", LOG_BENCH_ITERATIONS, [&]() {
+		int len = sprintf(sprintf_buffer, "[INFO] t=%lu alt=%f thr=%d\r\n", (unsigned long) time, (double) altitude,
+						  (int) throttle);
+		benchmark_do_not_optimize(len);
+		benchmark_clobber_memory();
+	});
+
+	//what it pays with the binary log. The ring is emptied every so often, the way the flush task would
+	uint32_t count = 0;
+	run_benchmark("binary_log_pack + BinaryLog::write", LOG_BENCH_ITERATIONS, [&]() {
+		uint8_t packed[BinaryLogArgsSize<uint32_t, float, int32_t>::value];
+		uint8_t *end = binary_log_pack(packed, (uint32_t) time, (float) altitude, (int32_t) throttle);
+		bench_log.write(0x0123, packed, (uint8_t) (end - packed));
+
+		if (++count % 128 == 0) {
+			const uint8_t *data;
+			size_t len;
+			while ((len = bench_log.peek(data)) > 0) bench_log.consume(len);
+		}
+	});
+
+	ASSERT_EQ(bench_log.get_dropped(), 0u);
+}
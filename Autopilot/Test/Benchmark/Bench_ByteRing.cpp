@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "ByteRing.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t RING_BENCH_ITERATIONS = 200000;
+static const uint32_t RING_BENCH_LEN = 256;
+static const size_t RING_BENCH_CHUNK = 64;
+
+/**
+ * The malloc backed, self resizing queue that ByteRing replaced (formerly Autopilot ByteQueue.c), kept here
+ * as a baseline. Logic is unchanged, apart from being made C++ friendly
+ */
+typedef volatile struct _ResizingQueue {
+	uint8_t *_data;
+	uint32_t _size;
+	uint32_t _total_size;
+	uint32_t _initial_size;
+	uint32_t _max_size;
+	uint32_t _start_index;
+} ResizingQueue;
+
+static uint8_t resize_queue(ResizingQueue *queue, uint32_t new_size) {
+	uint32_t old_size = queue->_size;
+	uint8_t *new_data = (uint8_t *) malloc(new_size);
+	if (new_data == 0) return 0;
+
+	for (uint32_t i = 0; i < queue->_size; i++) {
+		new_data[i] = queue->_data[queue->_start_index];
+		queue->_start_index = (queue->_start_index + 1) % queue->_total_size;
+	}
+	queue->_start_index = 0;
+
+	free((void *) queue->_data);
+	queue->_data = new_data;
+	queue->_size = old_size;
+	queue->_total_size = new_size;
+	return 1;
+}
+
+static void init_queue(ResizingQueue *queue, uint32_t initial_size, uint32_t max_size) {
+	queue->_data = (uint8_t *) malloc(initial_size);
+	queue->_size = 0;
+	queue->_total_size = initial_size;
+	queue->_start_index = 0;
+	queue->_initial_size = initial_size;
+	queue->_max_size = max_size;
+}
+
+static uint8_t push_queue(ResizingQueue *queue, uint8_t byte) {
+	if (queue->_size == queue->_total_size) {
+		uint32_t expand_size = queue->_total_size * 2;
+		if (queue->_total_size == queue->_max_size) {
+			return 0;
+		} else if (expand_size > queue->_max_size) {
+			expand_size = queue->_max_size;
+		}
+		if (resize_queue(queue, expand_size) == 0) return 0;
+	}
+
+	queue->_data[(queue->_start_index + queue->_size) % queue->_total_size] = byte;
+	queue->_size++;
+	return 1;
+}
+
+static uint8_t pop_queue(ResizingQueue *queue) {
+	if (queue->_size == 0) return -1;
+
+	queue->_size--;
+	uint8_t to_return = queue->_data[queue->_start_index];
+	queue->_start_index = (queue->_start_index + 1) % queue->_total_size;
+
+	if (queue->_size <= queue->_total_size / 4 && queue->_total_size / 2 >= queue->_initial_size) {
+		resize_queue(queue, queue->_total_size / 2);
+	}
+	return to_return;
+}
+
+TEST(ByteRingBenchmark, ChunkThroughput) {
+	uint8_t in[RING_BENCH_CHUNK];
+	uint8_t out[RING_BENCH_CHUNK];
+	for (size_t i = 0; i < RING_BENCH_CHUNK; i++) in[i] = (uint8_t) i;
+
+	static uint8_t storage[RING_BENCH_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_BENCH_LEN);
+
+	//offset by a few bytes so that every chunk is split across the end of the storage at some point
+	uint8_t pad[3] = {0};
+	ring.push(pad, sizeof(pad));
+
+	BenchmarkResult bulk = run_benchmark("ByteRing push/pop 64 byte chunks", RING_BENCH_ITERATIONS, [&]() {
+		ring.push(in, RING_BENCH_CHUNK);
+		ring.pop(out, RING_BENCH_CHUNK);
+		benchmark_do_not_optimize(out);
+	}, RING_BENCH_CHUNK);
+
+	BenchmarkResult single = run_benchmark("ByteRing push/pop byte at a time", RING_BENCH_ITERATIONS, [&]() {
+		for (size_t i = 0; i < RING_BENCH_CHUNK; i++) ring.push(in[i]);
+		for (size_t i = 0; i < RING_BENCH_CHUNK; i++) ring.pop(out[i]);
+		benchmark_do_not_optimize(out);
+	}, RING_BENCH_CHUNK);
+
+	ResizingQueue queue;
+	init_queue(&queue, 16, RING_BENCH_LEN);
+
+	//starts small like the uart queues did, so it grows and shrinks on every chunk
+	BenchmarkResult resizing = run_benchmark("ByteQueue push/pop byte at a time", RING_BENCH_ITERATIONS, [&]() {
+		for (size_t i = 0; i < RING_BENCH_CHUNK; i++) push_queue(&queue, in[i]);
+		for (size_t i = 0; i < RING_BENCH_CHUNK; i++) out[i] = pop_queue(&queue);
+		benchmark_do_not_optimize(out);
+	}, RING_BENCH_CHUNK);
+
+	free((void *) queue._data);
+
+	ASSERT_EQ(memcmp(in, out, RING_BENCH_CHUNK), 0);
+
+	printf("[ BENCH    ] bulk speedup over ByteQueue: %.1fx, single byte: %.1fx\n",
+		   resizing.ns_per_op / bulk.ns_per_op, resizing.ns_per_op / single.ns_per_op);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "Benchmark.hpp"
+#include "CycleProfiler.hpp"
+#include "Clock.hpp"
+
+using ::testing::Test;
+
+static const uint32_t PROFILER_BENCH_ITERATIONS = 1000000;
+
+/**
+ * The profiler as it was, kept here as the baseline. Reads the us system time and works out the average with a
+ * 64 bit divide on every stop
+ */
+typedef struct OldProfiler {
+	int started_profile;
+	uint64_t prev_time;
+	uint64_t max_diff;
+	uint64_t min_diff;
+	uint64_t average_diff;
+	uint64_t total_diff;
+	uint64_t latest_diff;
+	int num_profiles;
+} OldProfiler;
+
+static void old_start_profile(OldProfiler *p) {
+	p->started_profile = 1;
+	p->prev_time = get_system_time_us();
+}
+
+static void old_stop_profile(OldProfiler *p) {
+	if (!p->started_profile) return;
+	p->started_profile = 0;
+	p->latest_diff = get_system_time_us() - p->prev_time;
+	p->num_profiles++;
+	p->total_diff += p->latest_diff;
+	p->average_diff = p->total_diff / p->num_profiles;
+	p->max_diff = (p->latest_diff > p->max_diff) ? p->latest_diff : p->max_diff;
+	p->min_diff = (p->latest_diff < p->min_diff) ? p->latest_diff : p->min_diff;
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+//only the bookkeeping, without reading a clock. On the host the clock read dwarfs everything else
+TEST(BenchCycleProfiler, RecordSample) {
+	CycleProfiler profiler("bench record");
+	OldProfiler old = {0, 0, 0, UINT64_MAX, 0, 0, 0, 0};
+	uint32_t sample = 0;
+
+	run_benchmark("CycleProfiler record (histogram)", PROFILER_BENCH_ITERATIONS, [&]() {
+		sample = sample * 1664525 + 1013904223;
+		profiler.record(sample >> 20);
+	});
+
+	run_benchmark("old stop_profile bookkeeping (64 bit divide)", PROFILER_BENCH_ITERATIONS, [&]() {
+		sample = sample * 1664525 + 1013904223;
+		old.started_profile = 1;
+		old.prev_time = 0;
+		benchmark_clobber_memory();
+		old.latest_diff = sample >> 20;
+		old.num_profiles++;
+		old.total_diff += old.latest_diff;
+		old.average_diff = old.total_diff / old.num_profiles;
+		old.max_diff = (old.latest_diff > old.max_diff) ? old.latest_diff : old.max_diff;
+		old.min_diff = (old.latest_diff < old.min_diff) ? old.latest_diff : old.min_diff;
+		benchmark_do_not_optimize(old);
+	});
+
+	benchmark_do_not_optimize(profiler.get_percentile(99));
+}
+
+TEST(BenchCycleProfiler, ScopeGuardAroundNothing) {
+	CycleProfiler profiler("bench scope");
+	OldProfiler old = {0, 0, 0, UINT64_MAX, 0, 0, 0, 0};
+
+	run_benchmark("PROFILE_SCOPE (steady_clock cycle counter)", PROFILER_BENCH_ITERATIONS, [&]() {
+		PROFILE_SCOPE(profiler);
+		benchmark_clobber_memory();
+	});
+
+	//the fake us clock is a plain load on the host, so this only shows the bookkeeping of the old profiler
+	run_benchmark("old start_profile + stop_profile", PROFILER_BENCH_ITERATIONS, [&]() {
+		old_start_profile(&old);
+		benchmark_clobber_memory();
+		old_stop_profile(&old);
+	});
+
+	char line[192];
+	profiler.print_stats(line, sizeof(line));
+	printf("[ BENCH    ] %s\n", line);
+}
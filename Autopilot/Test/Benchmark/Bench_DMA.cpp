@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "DMA.hpp"
+#include "ByteRing.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t DMA_BENCH_ITERATIONS = 20000;
+static const size_t DMA_BENCH_BUFFER_LEN = 64;
+static const uint32_t DMA_BENCH_RING_LEN = 512;
+
+//counter values (bytes the dma had left) at each event, over one trip around the buffer. A run of idle lines,
+//like a gps sending sentences of different lengths, then the transfer complete event as the buffer wraps
+static const uint32_t DMA_BENCH_IDLE_EVENTS[] = {52, 30, 23, 7};
+static const size_t DMA_BENCH_BYTES_PER_TRIP = DMA_BENCH_BUFFER_LEN;
+
+//the old receive path: region tracking based on the idle line timer, and each byte pushed onto a std::deque
+typedef struct LegacyDMAState {
+	uint8_t *dma_buffer;
+	size_t dma_buffer_len;
+	size_t prev_pos;
+	bool idle_line;
+} LegacyDMAState;
+
+static void deque_process(LegacyDMAState *config, uint32_t remaining, deque<uint8_t> &queue) {
+	size_t start = (config->prev_pos < config->dma_buffer_len) ? (config->dma_buffer_len - config->prev_pos) : 0;
+	size_t length;
+
+	if (config->idle_line) {
+		length = (config->prev_pos < config->dma_buffer_len) ? (config->prev_pos - remaining)
+															 : (config->dma_buffer_len - remaining);
+		config->prev_pos = remaining;
+		config->idle_line = false;
+	} else {
+		length = config->dma_buffer_len - start;
+		config->prev_pos = config->dma_buffer_len;
+	}
+
+	for (size_t i = 0, pos = start; i < length; ++i, ++pos) {
+		queue.push_back(config->dma_buffer[pos]);
+	}
+}
+
+static size_t deque_read(deque<uint8_t> &queue, uint8_t *data, size_t len) {
+	size_t bytes_read = 0;
+	while (bytes_read < len && !queue.empty()) {
+		data[bytes_read] = queue.front();
+		queue.pop_front();
+		bytes_read++;
+	}
+	return bytes_read;
+}
+
+TEST(DMABenchmark, ReplayReceiveEvents) {
+	static uint8_t dma_buffer[DMA_BENCH_BUFFER_LEN];
+	for (size_t i = 0; i < DMA_BENCH_BUFFER_LEN; i++) dma_buffer[i] = (uint8_t) i;
+
+	uint8_t out[DMA_BENCH_BUFFER_LEN];
+
+	static uint8_t ring_storage[DMA_BENCH_RING_LEN];
+	ByteRing ring;
+	ring.init(ring_storage, DMA_BENCH_RING_LEN);
+
+	DMAConfig config;
+	memset(&config, 0, sizeof(config));
+	resetDMAConfig(&config, DMA_BENCH_BUFFER_LEN);
+	config.dma_buffer = dma_buffer;
+	config.queue = &ring;
+
+	//reads happen between the events, the way a task polls the port
+	BenchmarkResult ring_result = run_benchmark("ByteRing dma receive + read", DMA_BENCH_ITERATIONS, [&]() {
+		for (size_t i = 0; i < sizeof(DMA_BENCH_IDLE_EVENTS) / sizeof(DMA_BENCH_IDLE_EVENTS[0]); i++) {
+			copyDMARXRegion(&config, DMA_BENCH_IDLE_EVENTS[i]);
+			ring.pop(out, sizeof(out));
+		}
+		copyDMARXRegion(&config, DMA_BENCH_BUFFER_LEN);
+		ring.pop(out, sizeof(out));
+		benchmark_do_not_optimize(out);
+	}, DMA_BENCH_BYTES_PER_TRIP);
+
+	ASSERT_EQ(config.dropped_bytes, 0u);
+	ASSERT_EQ(out[0], 57);
+
+	deque<uint8_t> queue;
+	LegacyDMAState legacy = {dma_buffer, DMA_BENCH_BUFFER_LEN, DMA_BENCH_BUFFER_LEN, false};
+
+	BenchmarkResult deque_result = run_benchmark("std::deque dma receive + read", DMA_BENCH_ITERATIONS, [&]() {
+		for (size_t i = 0; i < sizeof(DMA_BENCH_IDLE_EVENTS) / sizeof(DMA_BENCH_IDLE_EVENTS[0]); i++) {
+			legacy.idle_line = true;
+			deque_process(&legacy, DMA_BENCH_IDLE_EVENTS[i], queue);
+			deque_read(queue, out, sizeof(out));
+		}
+		deque_process(&legacy, DMA_BENCH_BUFFER_LEN, queue);
+		deque_read(queue, out, sizeof(out));
+		benchmark_do_not_optimize(out);
+	}, DMA_BENCH_BYTES_PER_TRIP);
+
+	ASSERT_EQ(out[0], 57);
+
+	printf("[ BENCH    ] speedup over std::deque: %.1fx\n", deque_result.ns_per_op / ring_result.ns_per_op);
+}
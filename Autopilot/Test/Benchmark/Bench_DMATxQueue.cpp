@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "DMATxQueue.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t TX_BENCH_ITERATIONS = 200000;
+static const uint32_t TX_BENCH_QUEUE_LEN = 1024;
+static const size_t TX_BENCH_LINE_LEN = 48; //about the size of a typical debug() line
+
+static const char TX_BENCH_LINE[TX_BENCH_LINE_LEN + 1] = "[DEBUG] Sys Time: 123456789 Status: OK 0123456\r\n";
+
+/**
+ * Host stand-in for the uart and its dma. Keeps a simulated clock, and a transfer takes as long as its bytes
+ * would on the wire at the given baudrate (10 bits per byte)
+ */
+typedef struct SimulatedUART {
+	uint64_t now_ns;
+	uint64_t ns_per_byte;
+	uint64_t done_at_ns;
+	size_t in_flight;
+	uint64_t bytes_sent;
+} SimulatedUART;
+
+static bool simulated_start(void *context, const uint8_t *data, size_t len) {
+	auto uart = (SimulatedUART *) context;
+	benchmark_do_not_optimize(data);
+
+	uart->in_flight = len;
+	uart->done_at_ns = uart->now_ns + len * uart->ns_per_byte;
+	return true;
+}
+
+//infinitely fast dma, so only the cost of queueing and chaining is measured
+static bool instant_start(void *context, const uint8_t *data, size_t len) {
+	benchmark_do_not_optimize(data);
+	*(size_t *) context = len;
+	return true;
+}
+
+typedef struct TxSimulationResult {
+	double throughput_kBps;
+	double mean_latency_us;
+	double max_latency_us;
+	uint32_t rejected;
+} TxSimulationResult;
+
+/**
+ * Writes a line every period_us for a simulated second, and tracks how long each one takes to leave the wire
+ */
+static TxSimulationResult simulate_link(uint32_t baudrate, uint32_t period_us) {
+	static uint8_t storage[TX_BENCH_QUEUE_LEN];
+
+	SimulatedUART uart = {0, 10000000000ULL / baudrate, 0, 0, 0};
+	DMATxQueue queue;
+	queue.init(storage, TX_BENCH_QUEUE_LEN, simulated_start, &uart);
+
+	deque<pair<uint64_t, uint64_t>> waiting; //when each queued line was written, and the byte count it ends at
+	uint64_t bytes_queued = 0;
+	uint64_t total_latency_ns = 0;
+	uint64_t max_latency_ns = 0;
+	uint32_t delivered = 0;
+
+	const uint64_t end_ns = 1000000000ULL;
+	uint64_t next_write_ns = 0;
+
+	while (uart.now_ns < end_ns) {
+		if (uart.in_flight > 0 && uart.done_at_ns <= next_write_ns) {
+			uart.now_ns = uart.done_at_ns;
+			uart.bytes_sent += uart.in_flight;
+			uart.in_flight = 0;
+			queue.transfer_complete();
+
+			while (!waiting.empty() && waiting.front().second <= uart.bytes_sent) {
+				uint64_t latency = uart.now_ns - waiting.front().first;
+				total_latency_ns += latency;
+				if (latency > max_latency_ns) max_latency_ns = latency;
+				delivered++;
+				waiting.pop_front();
+			}
+		} else {
+			uart.now_ns = next_write_ns;
+			if (queue.write((const uint8_t *) TX_BENCH_LINE, TX_BENCH_LINE_LEN) == STATUS_CODE_OK) {
+				bytes_queued += TX_BENCH_LINE_LEN;
+				waiting.push_back(make_pair(uart.now_ns, bytes_queued));
+			}
+			next_write_ns += period_us * 1000ULL;
+		}
+	}
+
+	TxSimulationResult result;
+	result.throughput_kBps = uart.bytes_sent / 1000.0;
+	result.mean_latency_us = delivered > 0 ? total_latency_ns / 1000.0 / delivered : 0;
+	result.max_latency_us = max_latency_ns / 1000.0;
+	result.rejected = queue.get_rejected_writes();
+	return result;
+}
+
+static void print_simulation(uint32_t baudrate, uint32_t period_us) {
+	TxSimulationResult result = simulate_link(baudrate, period_us);
+
+	//a blocking transmit holds the caller for the whole time the line spends on the wire
+	double blocking_us = TX_BENCH_LINE_LEN * 10 * 1e6 / baudrate;
+
+	printf("[ BENCH    ] %7lu baud, line every %5lu us: %6.1f kB/s sent, latency mean %7.1f us max %7.1f us, "
+		   "%lu rejected, blocking transmit would stall %6.1f us per line\n",
+		   (unsigned long) baudrate, (unsigned long) period_us, result.throughput_kBps, result.mean_latency_us,
+		   result.max_latency_us, (unsigned long) result.rejected, blocking_us);
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchDMATxQueue, QueueAndChainDebugLines) {
+	static uint8_t storage[TX_BENCH_QUEUE_LEN];
+	size_t in_flight = 0;
+
+	DMATxQueue queue;
+	queue.init(storage, TX_BENCH_QUEUE_LEN, instant_start, &in_flight);
+
+	//what a caller of transmit() pays with the queue, plus the completion interrupt that sends it on
+	run_benchmark("DMATxQueue write + transfer_complete", TX_BENCH_ITERATIONS, [&]() {
+		queue.write((const uint8_t *) TX_BENCH_LINE, TX_BENCH_LINE_LEN);
+		while (queue.busy()) {
+			queue.transfer_complete();
+		}
+	}, TX_BENCH_LINE_LEN);
+
+	ASSERT_EQ(queue.pending(), 0u);
+}
+
+TEST(BenchDMATxQueue, SimulatedLinkLatency) {
+	print_simulation(115200, 10000);
+	print_simulation(115200, 2000); //more than the link can carry, so the queue fills up and turns lines away
+	print_simulation(921600, 1000);
+}
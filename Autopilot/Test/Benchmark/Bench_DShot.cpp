@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "Benchmark.hpp"
+#include "DShot.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t DSHOT_BENCH_ITERATIONS = 200000;
+
+TEST(DShotBenchmark, EncodeFourChannelGroup) {
+	//what send_dshot() does for a 4 channel timer, every loop
+	DShotTiming timing;
+	dshot_get_timing(DSHOT_600, 48000000, timing);
+
+	uint16_t values[4] = {48, 600, 1200, 2047};
+	uint16_t packets[4];
+	uint16_t buffer[DSHOT_FRAME_SLOTS * 4];
+
+	run_benchmark("encode + fill 4 channel burst buffer", DSHOT_BENCH_ITERATIONS, [&]() {
+		benchmark_clobber_memory();
+		for (int i = 0; i < 4; i++) {
+			packets[i] = dshot_encode_packet(values[i], false, false);
+		}
+		dshot_fill_burst_buffer(packets, 4, timing, buffer);
+		benchmark_do_not_optimize(buffer);
+	});
+
+	ASSERT_EQ(buffer[0], timing.bit_0);
+}
+
+TEST(DShotBenchmark, DecodeErpm) {
+	//reply for 400us per electrical revolution
+	const uint32_t gcr = 0xEDBA9;
+	uint32_t erpm = 0;
+	StatusCode status = STATUS_CODE_OK;
+
+	run_benchmark("dshot_decode_erpm", DSHOT_BENCH_ITERATIONS, [&]() {
+		benchmark_clobber_memory();
+		status = dshot_decode_erpm(gcr, erpm);
+		benchmark_do_not_optimize(erpm);
+	});
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(erpm, 150000u);
+}
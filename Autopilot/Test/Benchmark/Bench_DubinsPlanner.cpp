@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "DubinsPlanner.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t PLANNER_BENCH_PLANS = 2000;
+static const GeoPosition PLANNER_BENCH_HOME = {434726560, -805423210, 326789};
+
+//full length missions wandering round a few km, close together waypoints and reversals included
+static void random_mission(const LocalFrame &frame, Waypoint *mission) {
+	for (int i = 0; i < PATH_MAX_WAYPOINTS; i++) {
+		NEDPosition ned = {(rand() / (float) RAND_MAX - 0.5f) * 3000, (rand() / (float) RAND_MAX - 0.5f) * 3000,
+						   -50 - rand() / (float) RAND_MAX * 100};
+		mission[i].position = frame.from_ned(ned);
+		mission[i].airspeed = 16 + rand() / (float) RAND_MAX * 6;
+	}
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchDubinsPlanner, Planning) {
+	LocalFrame frame;
+	frame.set_reference(PLANNER_BENCH_HOME);
+	srand(46);
+
+	const int mission_count = 16;
+	static Waypoint missions[mission_count][PATH_MAX_WAYPOINTS];
+	for (int i = 0; i < mission_count; i++) random_mission(frame, missions[i]);
+
+	static DubinsPlanner planner; //too big for the stack
+
+	DubinsPose from = {0, 0, 0.3f};
+	DubinsPose to = {200, -150, 2.5f};
+	PathSegment segments[3];
+	float length;
+	run_benchmark("dubins_path", 1000000, [&]() {
+		uint8_t count = dubins_path(from, to, 80, segments, length);
+		benchmark_do_not_optimize(count);
+		from.course += 0.001f;
+	});
+
+	uint32_t next = 0;
+	BenchmarkResult plan = run_benchmark("DubinsPlanner, 64 waypoints", PLANNER_BENCH_PLANS, [&]() {
+		planner.start_mission(PLANNER_BENCH_HOME, missions[next++ % mission_count], PATH_MAX_WAYPOINTS);
+		while (planner.step() == PLANNER_WORKING) {}
+		benchmark_do_not_optimize(planner.plan_length());
+	});
+
+	//every slice timed on its own, to see how long the planner can hold on to the cpu between chances to drop a plan
+	vector<double> slices;
+	for (uint32_t i = 0; i < PLANNER_BENCH_PLANS; i++) {
+		planner.start_mission(PLANNER_BENCH_HOME, missions[i % mission_count], PATH_MAX_WAYPOINTS);
+		PlannerState state = PLANNER_WORKING;
+		while (state == PLANNER_WORKING) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			state = planner.step();
+			chrono::steady_clock::time_point end = chrono::steady_clock::now();
+			slices.push_back((double) chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+		}
+		ASSERT_EQ(state, PLANNER_DONE);
+	}
+
+	sort(slices.begin(), slices.end());
+	printf("[ BENCH    ] %.0f plans/s. Slice median %.0f ns, 99.9%% %.0f ns, worst %.0f ns\n", plan.ops_per_sec,
+		   slices[slices.size() / 2], slices[slices.size() * 999 / 1000], slices.back());
+}
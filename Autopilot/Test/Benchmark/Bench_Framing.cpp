@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Framing.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t FRAMING_BENCH_ITERATIONS = 2000;
+static const size_t FRAMING_BENCH_PACKET_LEN = 250;
+static const size_t FRAMING_BENCH_PACKETS = 8;
+static const size_t FRAMING_BENCH_RUN_LEN = 64; //about what a uart's receive ring hands over at a time
+
+static const FramingFormat COBS_CRC = {FRAMING_COBS, true};
+static const FramingFormat SLIP_CRC = {FRAMING_SLIP, true};
+
+//telemetry-like packets: mostly small numbers and floats, so plenty of 0s
+static vector<uint8_t> bench_packet(size_t index) {
+	vector<uint8_t> packet(FRAMING_BENCH_PACKET_LEN);
+	srand(50 + index);
+	for (size_t i = 0; i < packet.size(); i++) packet[i] = (uint8_t) (i % 4 == 3 ? 0 : rand());
+	return packet;
+}
+
+static vector<uint8_t> bench_stream(FramingFormat format) {
+	vector<uint8_t> stream;
+	for (size_t i = 0; i < FRAMING_BENCH_PACKETS; i++) {
+		vector<uint8_t> packet = bench_packet(i);
+		vector<uint8_t> frame(framing_max_frame_len(format, packet.size()));
+		frame.resize(framing_encode(format, packet.data(), packet.size(), frame.data(), frame.size()));
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	return stream;
+}
+
+static void bench_encode(const char *name, FramingFormat format) {
+	vector<uint8_t> packet = bench_packet(0);
+	vector<uint8_t> frame(framing_max_frame_len(format, packet.size()));
+
+	//split like space handed out around the end of the transmit queue
+	DMATxRegion region = {frame.data(), frame.size() / 2, frame.data() + frame.size() / 2, frame.size() - frame.size() / 2};
+
+	run_benchmark(name, FRAMING_BENCH_ITERATIONS * 10, [&]() {
+		FrameWriter writer(format, region);
+		writer.put_bytes(packet.data(), packet.size());
+		benchmark_do_not_optimize(writer.finish());
+		benchmark_clobber_memory();
+	}, packet.size());
+}
+
+static void bench_feed(const char *name, FramingFormat format, const vector<uint8_t> &stream) {
+	uint8_t buffer[FRAMING_BENCH_PACKET_LEN + FRAMING_CRC_LEN];
+	FrameDecoder decoder(format, buffer, sizeof(buffer));
+	uint32_t packets = 0;
+
+	BenchmarkResult result = run_benchmark(name, FRAMING_BENCH_ITERATIONS, [&]() {
+		size_t position = 0;
+		while (position < stream.size()) {
+			size_t len = stream.size() - position;
+			if (len > FRAMING_BENCH_RUN_LEN) len = FRAMING_BENCH_RUN_LEN;
+
+			bool complete;
+			position += decoder.feed(&stream[position], len, complete);
+			if (complete) packets++;
+		}
+		benchmark_do_not_optimize(packets);
+	}, stream.size());
+
+	printf("[ BENCH    ] %-40s %10.2f ns/byte\n", name, result.ns_per_op / stream.size());
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchFraming, Encoding) {
+	bench_encode("FrameWriter, cobs with crc", COBS_CRC);
+	bench_encode("FrameWriter, slip with crc", SLIP_CRC);
+}
+
+TEST(BenchFraming, Decoding) {
+	bench_feed("FrameDecoder::feed, cobs with crc", COBS_CRC, bench_stream(COBS_CRC));
+	bench_feed("FrameDecoder::feed, slip with crc", SLIP_CRC, bench_stream(SLIP_CRC));
+
+	//noise on the line costs the same per byte as good frames, so it can't hold a receiver up for any longer
+	vector<uint8_t> noise(4096);
+	for (uint8_t &byte : noise) byte = (uint8_t) rand();
+	bench_feed("FrameDecoder::feed, noise", COBS_CRC, noise);
+}
+
+TEST(BenchFraming, DecodingInPlace) {
+	vector<uint8_t> stream = bench_stream(COBS_CRC);
+	vector<uint8_t> scratch(stream.size());
+	uint8_t buffer[FRAMING_BENCH_PACKET_LEN + FRAMING_CRC_LEN];
+	FrameDecoder decoder(COBS_CRC, buffer, sizeof(buffer));
+
+	//each frame whole in the receive ring, the way FramedPort finds most of them. The copy puts the stream back
+	//after it's been decoded over, and is timed on its own below
+	BenchmarkResult copying = run_benchmark("restoring the stream", FRAMING_BENCH_ITERATIONS, [&]() {
+		memcpy(scratch.data(), stream.data(), stream.size());
+		benchmark_clobber_memory();
+	});
+
+	BenchmarkResult result = run_benchmark("FrameDecoder::decode_in_place, cobs", FRAMING_BENCH_ITERATIONS, [&]() {
+		memcpy(scratch.data(), stream.data(), stream.size());
+		uint8_t *frame = scratch.data();
+		uint8_t *end = frame + scratch.size();
+		size_t total = 0;
+
+		while (frame < end) {
+			uint8_t *delimiter = static_cast<uint8_t *>(memchr(frame, 0, end - frame));
+			size_t packet_len;
+			if (decoder.decode_in_place(frame, delimiter - frame, packet_len)) total += packet_len;
+			frame = delimiter + 1;
+		}
+		benchmark_do_not_optimize(total);
+	}, stream.size());
+
+	printf("[ BENCH    ] %-40s %10.2f ns/byte\n", "FrameDecoder::decode_in_place, cobs",
+		   (result.ns_per_op - copying.ns_per_op) / stream.size());
+}
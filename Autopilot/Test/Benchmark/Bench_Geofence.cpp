@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Geofence.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t GEOFENCE_BENCH_ITERATIONS = 1000000;
+static const int GEOFENCE_BENCH_POINTS = 1024;
+static const GeoPosition GEOFENCE_BENCH_HOME = {434726560, -805423210, 326789};
+
+//ray casting and the nearest edge, walking every edge
+static float naive_depth(const vector<NEDPosition> &polygon, float north, float east) {
+	bool inside = false;
+	float nearest = FLT_MAX;
+	size_t count = polygon.size();
+
+	for (size_t i = 0; i < count; i++) {
+		const NEDPosition &a = polygon[i];
+		const NEDPosition &b = polygon[i + 1 == count ? 0 : i + 1];
+
+		if ((a.north > north) != (b.north > north)) {
+			float crossing = a.east + (north - a.north) * (b.east - a.east) / (b.north - a.north);
+			if (crossing > east) inside = !inside;
+		}
+
+		float edge_north = b.north - a.north;
+		float edge_east = b.east - a.east;
+		float t = ((north - a.north) * edge_north + (east - a.east) * edge_east)
+			/ (edge_north * edge_north + edge_east * edge_east);
+		t = t < 0 ? 0 : (t > 1 ? 1 : t);
+		float offset_north = a.north + t * edge_north - north;
+		float offset_east = a.east + t * edge_east - east;
+		nearest = fminf(nearest, offset_north * offset_north + offset_east * offset_east);
+	}
+
+	return inside ? sqrtf(nearest) : -sqrtf(nearest);
+}
+
+static void bench_polygon(int count) {
+	LocalFrame frame;
+	frame.set_reference(GEOFENCE_BENCH_HOME);
+
+	vector<GeoPosition> vertices;
+	for (int i = 0; i < count; i++) {
+		float angle = 2.0f * (float) M_PI * i / count;
+		float radius = 1500 + 300 * sinf(5 * angle) + 100 * sinf(23 * angle) + 30 * sinf(97 * angle);
+		NEDPosition ned = {radius * cosf(angle), radius * sinf(angle), 0};
+		vertices.push_back(frame.from_ned(ned));
+	}
+
+	static Geofence fence; //too big for the stack
+	fence.clear(GEOFENCE_BENCH_HOME);
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), count), STATUS_CODE_OK);
+
+	vector<NEDPosition> polygon;
+	for (const GeoPosition &vertex : vertices) polygon.push_back(fence.frame().to_ned(vertex));
+
+	//positions all over the fence and around it
+	vector<NEDPosition> points;
+	srand(45);
+	for (int i = 0; i < GEOFENCE_BENCH_POINTS; i++) {
+		NEDPosition point = {(rand() / (float) RAND_MAX - 0.5f) * 4000, (rand() / (float) RAND_MAX - 0.5f) * 4000, 0};
+		points.push_back(point);
+	}
+
+	char name[64];
+	uint32_t next = 0;
+
+	snprintf(name, sizeof(name), "naive, %d vertices", count);
+	BenchmarkResult naive = run_benchmark(name, GEOFENCE_BENCH_ITERATIONS / 10, [&]() {
+		const NEDPosition &point = points[next++ % GEOFENCE_BENCH_POINTS];
+		float depth = naive_depth(polygon, point.north, point.east);
+		benchmark_do_not_optimize(depth);
+	});
+
+	snprintf(name, sizeof(name), "Geofence::check, %d vertices", count);
+	BenchmarkResult indexed = run_benchmark(name, GEOFENCE_BENCH_ITERATIONS, [&]() {
+		GeofenceStatus status = fence.check(points[next++ % GEOFENCE_BENCH_POINTS]);
+		benchmark_do_not_optimize(status);
+	});
+
+	snprintf(name, sizeof(name), "Geofence::add_polygon, %d vertices", count);
+	run_benchmark(name, 10, [&]() {
+		fence.clear(GEOFENCE_BENCH_HOME);
+		StatusCode status = fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), count);
+		benchmark_do_not_optimize(status);
+	});
+
+	printf("[ BENCH    ] %d vertices: indexed check is %.1fx faster\n", count, naive.ns_per_op / indexed.ns_per_op);
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchGeofence, Containment) {
+	bench_polygon(16);
+	bench_polygon(100);
+	bench_polygon(500);
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "NMEA.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t NMEA_BENCH_ITERATIONS = 20;
+static const int NMEA_BENCH_EPOCHS = 3000; //5 minutes at 10Hz
+
+static string with_checksum(const char *body) {
+	uint8_t checksum = 0;
+	for (const char *c = body; *c != '\0'; c++) checksum ^= (uint8_t) *c;
+
+	char sentence[128];
+	snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, checksum);
+	return sentence;
+}
+
+/**
+ * The default output of a u-blox M8 at 10Hz, flying a slow circle: every epoch has the three sentences we use and the
+ * satellite sentences we don't, which is most of the bytes on the wire
+ */
+static string make_corpus(int &parsed_sentences, int &total_sentences) {
+	string corpus;
+	char body[128];
+	parsed_sentences = 0;
+	total_sentences = 0;
+
+	for (int epoch = 0; epoch < NMEA_BENCH_EPOCHS; epoch++) {
+		int centiseconds = epoch * 10;
+		int hh = 14, mm = (centiseconds / 6000) % 60, ss = (centiseconds / 100) % 60, cs = centiseconds % 100;
+		double lat_minutes = 28.12345 + (epoch % 400) * 0.00011;
+		double lon_minutes = 32.54321 + (epoch % 250) * 0.00017;
+		double knots = 24.0 + (epoch % 37) * 0.013;
+		double course = (epoch * 0.12) - (int) (epoch * 0.12 / 360) * 360;
+
+		snprintf(body, sizeof(body), "GNRMC,%02d%02d%02d.%02d,A,4328.%05d,N,08032.%05d,W,%.3f,%.2f,140619,,,A", hh, mm,
+				 ss, cs, (int) (lat_minutes * 1000) % 100000, (int) (lon_minutes * 1000) % 100000, knots, course);
+		corpus += with_checksum(body);
+		snprintf(body, sizeof(body), "GNVTG,%.2f,T,,M,%.3f,N,%.3f,K,A", course, knots, knots * 1.852);
+		corpus += with_checksum(body);
+		snprintf(body, sizeof(body), "GNGGA,%02d%02d%02d.%02d,4328.%05d,N,08032.%05d,W,1,12,0.78,%d.%d,M,-35.1,M,,", hh,
+				 mm, ss, cs, (int) (lat_minutes * 1000) % 100000, (int) (lon_minutes * 1000) % 100000,
+				 320 + epoch % 17, epoch % 10);
+		corpus += with_checksum(body);
+		corpus += with_checksum("GNGSA,A,3,02,05,06,09,12,17,19,25,,,,,1.31,0.78,1.05");
+		corpus += with_checksum("GNGSA,A,3,65,66,74,75,,,,,,,,,1.31,0.78,1.05");
+		corpus += with_checksum("GPGSV,3,1,11,02,47,304,38,05,32,262,36,06,58,060,43,09,20,070,33");
+		corpus += with_checksum("GPGSV,3,2,11,12,71,196,44,17,28,112,31,19,41,144,40,25,10,318,25");
+		corpus += with_checksum("GPGSV,3,3,11,29,04,034,,46,33,209,,51,38,218,");
+		corpus += with_checksum("GLGSV,2,1,06,65,53,041,37,66,62,292,40,74,22,134,29,75,74,166,41");
+		corpus += with_checksum("GLGSV,2,2,06,76,44,314,33,84,03,036,");
+		snprintf(body, sizeof(body), "GNGLL,4328.%05d,N,08032.%05d,W,%02d%02d%02d.%02d,A,A",
+				 (int) (lat_minutes * 1000) % 100000, (int) (lon_minutes * 1000) % 100000, hh, mm, ss, cs);
+		corpus += with_checksum(body);
+
+		parsed_sentences += 3;
+		total_sentences += 11;
+	}
+
+	return corpus;
+}
+
+static uint8_t legacy_hex(char c) {
+	return (uint8_t) (c <= '9' ? c - '0' : c - 'A' + 10);
+}
+
+//the old NMEAParser.c: find a line, verify its checksum in one pass, split every field into a scratch array in
+//another, then sscanf/atof each field we want
+static int legacy_parse(const string &corpus, long double &latitude, float &speed) {
+	int parsed = 0;
+	size_t start = 0;
+
+	while ((start = corpus.find('$', start)) != string::npos) {
+		const char *data = corpus.c_str() + start + 1;
+		start++;
+
+		uint8_t checksum = 0;
+		int i = 0;
+		while (data[i] != '*' && i < 100) checksum ^= (uint8_t) data[i++];
+		if (data[i] != '*' || (legacy_hex(data[i + 1]) << 4 | legacy_hex(data[i + 2])) != checksum) continue;
+
+		bool gga = strncmp(data + 2, "GGA", 3) == 0;
+		bool vtg = strncmp(data + 2, "VTG", 3) == 0;
+		bool rmc = strncmp(data + 2, "RMC", 3) == 0;
+		if (!gga && !vtg && !rmc) continue;
+
+		char values[15][20];
+		int j = 0;
+		for (int field = 0; field < 15; field++) {
+			int n = 0;
+			while (data[j] != ',' && data[j] != '*' && n < 19) values[field][n++] = data[j++];
+			values[field][n] = '\0';
+			if (data[j] == '*') {
+				for (field++; field < 15; field++) values[field][0] = '\0';
+				break;
+			}
+			j++;
+		}
+
+		if (gga) {
+			float utc_time;
+			int16_t altitude;
+			int satellites;
+			double input = atof(values[2]) / 100;
+			latitude = (int) input + ((input - (int) input) / 60) * 100;
+			if (values[3][0] == 'S') latitude = -latitude;
+			sscanf(values[1], "%f", &utc_time);
+			sscanf(values[9], "%hi", &altitude);
+			sscanf(values[7], "%d", &satellites);
+		} else if (vtg) {
+			sscanf(values[7], "%f", &speed);
+		} else {
+			double input = atof(values[3]) / 100;
+			latitude = (int) input + ((input - (int) input) / 60) * 100;
+			sscanf(values[7], "%f", &speed);
+		}
+		parsed++;
+	}
+
+	return parsed;
+}
+
+TEST(NMEABenchmark, ParseRecordedOutput) {
+	int parsed_sentences;
+	int total_sentences;
+	string corpus = make_corpus(parsed_sentences, total_sentences);
+	const uint8_t *bytes = (const uint8_t *) corpus.data();
+
+	NMEAParser parser;
+	int parsed = 0;
+	int32_t latitude = 0;
+
+	BenchmarkResult fast = run_benchmark("NMEAParser", NMEA_BENCH_ITERATIONS, [&]() {
+		parsed = 0;
+		size_t position = 0;
+		bool complete;
+		while (position < corpus.size()) {
+			position += parser.feed(bytes + position, corpus.size() - position, complete);
+			if (complete) {
+				parsed++;
+				latitude = parser.sentence().gga.latitude;
+			}
+		}
+		benchmark_do_not_optimize(latitude);
+	}, corpus.size());
+
+	long double legacy_latitude = 0;
+	float legacy_speed = 0;
+	int legacy_parsed = 0;
+
+	BenchmarkResult legacy = run_benchmark("split fields + sscanf", NMEA_BENCH_ITERATIONS, [&]() {
+		legacy_parsed = legacy_parse(corpus, legacy_latitude, legacy_speed);
+		benchmark_do_not_optimize(legacy_latitude);
+	}, corpus.size());
+
+	ASSERT_EQ(parsed, parsed_sentences);
+	ASSERT_EQ(legacy_parsed, parsed_sentences);
+	ASSERT_EQ(parser.checksum_errors(), 0u);
+	ASSERT_EQ(parser.malformed_sentences(), 0u);
+
+	printf("[ BENCH    ] %d sentences (%d parsed), %zu bytes\n", total_sentences, parsed_sentences, corpus.size());
+	printf("[ BENCH    ] NMEAParser: %.0f sentences/s, split + sscanf: %.0f sentences/s, speedup %.1fx\n",
+		   fast.ops_per_sec * total_sentences, legacy.ops_per_sec * total_sentences,
+		   legacy.ns_per_op / fast.ns_per_op);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "Benchmark.hpp"
+#include "PathManager.hpp"
+#include "SimulatedAircraft.hpp"
+
+using ::testing::Test;
+
+static const uint32_t PATH_BENCH_ITERATIONS = 5000000;
+static const GeoPosition PATH_BENCH_HOME = {434726560, -805423210, 326789};
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchPathManager, GuidanceTick) {
+	//a 64 waypoint zigzag, flown round and round
+	LocalFrame frame;
+	frame.set_reference(PATH_BENCH_HOME);
+	Waypoint mission[PATH_MAX_WAYPOINTS];
+	for (int i = 0; i < PATH_MAX_WAYPOINTS; i++) {
+		NEDPosition ned = {(i / 2) * 400.0f, (i % 4 == 1 || i % 4 == 2) ? 600.0f : 0.0f, -100.0f};
+		mission[i].position = frame.from_ned(ned);
+		mission[i].airspeed = 20.0f;
+	}
+
+	PathManager manager;
+	ASSERT_EQ(manager.load_mission(PATH_BENCH_HOME, mission, PATH_MAX_WAYPOINTS), STATUS_CODE_OK);
+
+	SimulatedAircraft aircraft(0, 0, -100, 0, 20);
+	PMCommands commands = {0, 0, 0, 0};
+	PathState state = aircraft.state();
+
+	//the tick on its own, against a state that moves so nothing is hoisted out of the loop
+	BenchmarkResult tick = run_benchmark("PathManager::update", PATH_BENCH_ITERATIONS, [&]() {
+		manager.update(state, commands);
+		benchmark_do_not_optimize(commands);
+		state.position.north += 0.4f;
+		if (manager.mission_complete()) {
+			manager.load_mission(PATH_BENCH_HOME, mission, PATH_MAX_WAYPOINTS);
+			state.position.north = 0;
+		}
+	});
+
+	//and closed loop with the simulated aircraft, at 50Hz of simulated time
+	manager.load_mission(PATH_BENCH_HOME, mission, PATH_MAX_WAYPOINTS);
+	run_benchmark("PathManager::update + simulated aircraft", PATH_BENCH_ITERATIONS, [&]() {
+		manager.update(aircraft.state(), commands);
+		aircraft.step(commands, 0.02f);
+		benchmark_do_not_optimize(aircraft.position);
+	});
+
+	BenchmarkResult load = run_benchmark("PathManager::load_mission, 64 waypoints", 10000, [&]() {
+		StatusCode status = manager.load_mission(PATH_BENCH_HOME, mission, PATH_MAX_WAYPOINTS);
+		benchmark_do_not_optimize(status);
+	});
+
+	printf("[ BENCH    ] %.0f guidance ticks per ms. %zu bytes of segments\n", tick.ops_per_sec / 1000.0,
+		   sizeof(PathSegment) * PATH_MAX_SEGMENTS);
+	(void) load;
+}
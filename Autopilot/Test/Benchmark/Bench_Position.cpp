@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "Benchmark.hpp"
+#include "Position.hpp"
+
+using ::testing::Test;
+
+static const uint32_t POSITION_BENCH_ITERATIONS = 2000000;
+static const GeoPosition POSITION_BENCH_HOME = {434726560, -805423210, 326789};
+
+//the straightforward way: long double degrees, through ecef with full trig for both points on every fix
+static void ecef_ned(long double home_latitude, long double home_longitude, double home_height, long double latitude,
+					 long double longitude, double height, double ned[3]) {
+	const double a = 6378137.0;
+	const double e2 = 6.69437999014e-3;
+	double from[3];
+	double to[3];
+	long double points[2][2] = {{home_latitude, home_longitude}, {latitude, longitude}};
+	double heights[2] = {home_height, height};
+	double *outputs[2] = {from, to};
+
+	for (int i = 0; i < 2; i++) {
+		double lat = (double) (points[i][0] * M_PI / 180.0L);
+		double lon = (double) (points[i][1] * M_PI / 180.0L);
+		double prime_vertical = a / sqrt(1.0 - e2 * sin(lat) * sin(lat));
+		outputs[i][0] = (prime_vertical + heights[i]) * cos(lat) * cos(lon);
+		outputs[i][1] = (prime_vertical + heights[i]) * cos(lat) * sin(lon);
+		outputs[i][2] = (prime_vertical * (1.0 - e2) + heights[i]) * sin(lat);
+	}
+
+	double lat = (double) (home_latitude * M_PI / 180.0L);
+	double lon = (double) (home_longitude * M_PI / 180.0L);
+	double x = to[0] - from[0];
+	double y = to[1] - from[1];
+	double z = to[2] - from[2];
+	ned[0] = -sin(lat) * cos(lon) * x - sin(lat) * sin(lon) * y + cos(lat) * z;
+	ned[1] = -sin(lon) * x + cos(lon) * y;
+	ned[2] = -cos(lat) * cos(lon) * x - cos(lat) * sin(lon) * y - sin(lat) * z;
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchPosition, FixToNED) {
+	LocalFrame frame;
+	frame.set_reference(POSITION_BENCH_HOME);
+	GeoPosition fix = {434826560, -805323210, 400000};
+	volatile int32_t wander = 0; //so nothing gets hoisted out of the loop
+
+	BenchmarkResult ecef = run_benchmark("lla -> ned, long double through ecef", POSITION_BENCH_ITERATIONS, [&]() {
+		double ned[3];
+		ecef_ned(43.472656L, -80.542321L, 326.789, (fix.latitude + wander) * 1e-7L, fix.longitude * 1e-7L,
+				 fix.altitude_mm * 1e-3, ned);
+		benchmark_do_not_optimize(ned);
+		wander = wander + 1;
+	});
+
+	BenchmarkResult local = run_benchmark("lla -> ned, LocalFrame", POSITION_BENCH_ITERATIONS, [&]() {
+		GeoPosition position = fix;
+		position.latitude += wander;
+		NEDPosition ned = frame.to_ned(position);
+		benchmark_do_not_optimize(ned);
+		wander = wander + 1;
+	});
+
+	BenchmarkResult inverse = run_benchmark("ned -> lla, LocalFrame", POSITION_BENCH_ITERATIONS, [&]() {
+		NEDPosition ned = {1000.0f + wander * 1e-3f, 800.0f, -73.0f};
+		GeoPosition position = frame.from_ned(ned);
+		benchmark_do_not_optimize(position);
+		wander = wander + 1;
+	});
+
+	printf("[ BENCH    ] LocalFrame: %.1fx faster than through ecef. %zu byte positions, down from %zu\n",
+		   ecef.ns_per_op / local.ns_per_op, sizeof(GeoPosition), 2 * sizeof(long double) + sizeof(int));
+	(void) inverse;
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include "Benchmark.hpp"
+#include "RTOSTraceBuffer.hpp"
+
+using ::testing::Test;
+
+static const uint32_t TRACE_BENCH_ITERATIONS = 2000000;
+static const uint32_t TRACE_BENCH_LEN = 2048;
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchRTOSTraceBuffer, RecordEvent) {
+	static RTOSTraceRecord storage[TRACE_BENCH_LEN];
+	RTOSTraceBuffer trace;
+	trace.init(storage, TRACE_BENCH_LEN, 1000000000UL);
+	uint32_t timestamp = 0;
+
+	//what every context switch, interrupt and queue operation pays on top of the work itself
+	BenchmarkResult result = run_benchmark("RTOSTraceBuffer record", TRACE_BENCH_ITERATIONS, [&]() {
+		trace.record(timestamp++, RTOS_TRACE_TASK_SWITCHED_IN, 3, 0);
+	}, RTOS_TRACE_RECORD_LEN);
+
+	//a busy autopilot: 1kHz tick, a few thousand context switches and tens of thousands of interrupts a second
+	double events_per_second = 50000;
+	printf("[ BENCH    ] %.0f events/s would cost %.3f%% of this cpu\n", events_per_second,
+		   events_per_second * result.ns_per_op / 1e7);
+
+	ASSERT_EQ(trace.size(), TRACE_BENCH_LEN);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "SBUSFrame.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t SBUS_BENCH_ITERATIONS = 200000;
+
+static const uint8_t BENCH_FRAME[SBUS_FRAME_LEN] = {
+	0x0F, 0xAC, 0x98, 0x38, 0xF8, 0x00, 0xF0, 0x7F, 0xF4, 0x71, 0x17, 0x19, 0x2C,
+	0x81, 0x0C, 0x7D, 0xB0, 0xC4, 0x2B, 0x90, 0x11, 0x0E, 0x80, 0x0C, 0x00
+};
+
+//the straightforward bit by bit decoder most s.bus implementations use, as a baseline
+static void naive_decode(const uint8_t *data, uint16_t *channels) {
+	memset(channels, 0, SBUS_NUM_CHANNELS * sizeof(uint16_t));
+
+	for (int bit = 0; bit < SBUS_NUM_CHANNELS * 11; bit++) {
+		if (data[1 + bit / 8] & (1 << (bit % 8))) {
+			channels[bit / 11] |= 1 << (bit % 11);
+		}
+	}
+}
+
+TEST(SBUSBenchmark, DecodeFrame) {
+	SBUSFrame frame;
+	uint16_t naive_channels[SBUS_NUM_CHANNELS];
+
+	BenchmarkResult fast = run_benchmark("sbus_decode_frame", SBUS_BENCH_ITERATIONS, [&]() {
+		benchmark_clobber_memory();
+		sbus_decode_frame(BENCH_FRAME, frame);
+		benchmark_do_not_optimize(frame);
+	}, SBUS_FRAME_LEN);
+
+	BenchmarkResult naive = run_benchmark("naive per-bit decode", SBUS_BENCH_ITERATIONS, [&]() {
+		benchmark_clobber_memory();
+		naive_decode(BENCH_FRAME, naive_channels);
+		benchmark_do_not_optimize(naive_channels);
+	}, SBUS_FRAME_LEN);
+
+	//both decoders have to agree for the comparison to mean anything
+	for (int i = 0; i < SBUS_NUM_CHANNELS; i++) {
+		ASSERT_EQ(frame.channels[i], naive_channels[i]);
+	}
+
+	printf("[ BENCH    ] speedup over naive: %.1fx\n", naive.ns_per_op / fast.ns_per_op);
+}
+
+TEST(SBUSBenchmark, SyncByteStream) {
+	//one byte at a time is the worst case for the frame sync
+	uint8_t stream[SBUS_FRAME_LEN * 4];
+	for (int i = 0; i < 4; i++) {
+		memcpy(&stream[i * SBUS_FRAME_LEN], BENCH_FRAME, SBUS_FRAME_LEN);
+	}
+
+	SBUSFrameSync sync;
+	SBUSFrame frame;
+	uint32_t frames = 0;
+
+	run_benchmark("SBUSFrameSync 4 frames, byte at a time", SBUS_BENCH_ITERATIONS / 10, [&]() {
+		for (size_t i = 0; i < sizeof(stream); i++) {
+			*sync.buffer() = stream[i];
+			if (sync.commit(1)) {
+				sbus_decode_frame(sync.frame(), frame);
+				frames++;
+			}
+		}
+		benchmark_do_not_optimize(frame);
+	}, sizeof(stream));
+
+	ASSERT_GT(frames, 0u);
+	ASSERT_EQ(sync.dropped_bytes(), 0u);
+}
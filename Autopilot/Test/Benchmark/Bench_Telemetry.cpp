@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "Benchmark.hpp"
+#include "Telemetry.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t TELEMETRY_BENCH_ITERATIONS = 500000;
+static const uint32_t TELEMETRY_BENCH_QUEUE_LEN = 1024;
+static const uint32_t TELEMETRY_BENCH_BAUDRATE = 57600;
+static const uint64_t TELEMETRY_BENCH_TICK_US = 10000; //how often the telemetry task runs
+
+//infinitely fast dma, so only the cost of building frames is measured
+static bool instant_start(void *context, const uint8_t *data, size_t len) {
+	benchmark_do_not_optimize(data);
+	*(size_t *) context = len;
+	return true;
+}
+
+typedef struct TelemetryBenchSources {
+	SystemMonitorSnapshot system;
+	SFOutput_t attitude;
+	GpsData_t gps;
+	GeofenceStatus geofence;
+} TelemetryBenchSources;
+
+static TelemetryBenchSources bench_sources() {
+	TelemetryBenchSources sources;
+	memset(&sources, 0, sizeof(sources));
+
+	sources.system.heap_free_bytes = 23456;
+	sources.system.cpu_load_permille = 412;
+	sources.system.task_count = 8;
+	for (uint8_t i = 0; i < sources.system.task_count; i++) {
+		sources.system.tasks[i].number = i + 1;
+		memcpy(sources.system.tasks[i].name, "TaskName", SYSTEM_MONITOR_NAME_LEN);
+		sources.system.tasks[i].stack_free_words = 60;
+		sources.system.tasks[i].cpu_permille = 50;
+	}
+
+	sources.attitude = {0.1f, -0.05f, 1.2f, 0.01f, 0.02f, -0.03f, 18.0f};
+	sources.gps.position = {434726560, -805423210, 326789};
+	sources.gps.velocityNorth = 15.2f;
+	sources.gps.numSatellites = 12;
+	sources.gps.sensorStatus = 1;
+	sources.geofence.margin = 340.0f;
+	return sources;
+}
+
+static uint16_t payload_len(TelemetryMessageId id, const TelemetryBenchSources &sources) {
+	switch (id) {
+		case TELEMETRY_HEARTBEAT: return TELEMETRY_HEARTBEAT_LEN;
+		case TELEMETRY_ATTITUDE: return TELEMETRY_ATTITUDE_LEN;
+		case TELEMETRY_GPS: return TELEMETRY_GPS_LEN;
+		case TELEMETRY_GEOFENCE: return TELEMETRY_GEOFENCE_LEN;
+		default: return telemetry_tasks_len(sources.system.task_count);
+	}
+}
+
+static void write_payload(TelemetryWriter &writer, TelemetryMessageId id, const TelemetryBenchSources &sources) {
+	switch (id) {
+		case TELEMETRY_HEARTBEAT: telemetry_write_heartbeat(writer, 123456, sources.system, 0); break;
+		case TELEMETRY_ATTITUDE: telemetry_write_attitude(writer, sources.attitude); break;
+		case TELEMETRY_GPS: telemetry_write_gps(writer, sources.gps); break;
+		case TELEMETRY_GEOFENCE: telemetry_write_geofence(writer, sources.geofence); break;
+		default: telemetry_write_tasks(writer, sources.system); break;
+	}
+}
+
+static const char *const TELEMETRY_BENCH_NAMES[TELEMETRY_MESSAGE_COUNT] = {
+	"heartbeat", "attitude", "gps", "geofence", "tasks"
+};
+
+typedef struct TelemetryLinkResult {
+	uint64_t bytes;
+	uint32_t sent[TELEMETRY_MESSAGE_COUNT];
+	uint32_t skipped[TELEMETRY_MESSAGE_COUNT];
+	uint32_t rejected;
+} TelemetryLinkResult;
+
+/**
+ * Runs the telemetry task against a simulated uart for a while. Bytes leave the queue as fast as the baudrate lets
+ * them, one tick at a time
+ */
+static TelemetryLinkResult simulate_link(const float *rates_hz, uint64_t duration_us) {
+	static uint8_t storage[TELEMETRY_BENCH_QUEUE_LEN];
+	size_t in_flight = 0;
+	DMATxQueue queue;
+	queue.init(storage, TELEMETRY_BENCH_QUEUE_LEN, instant_start, &in_flight);
+
+	TelemetryBenchSources sources = bench_sources();
+	TelemetryScheduler scheduler;
+	//80% of the link, the same as the telemetry task
+	scheduler.set_link(TELEMETRY_BENCH_BAUDRATE / 10 * 8 / 10, TELEMETRY_BENCH_QUEUE_LEN);
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		scheduler.set_rate((TelemetryMessageId) i, rates_hz[i]);
+	}
+
+	TelemetryLinkResult result;
+	memset(&result, 0, sizeof(result));
+	uint64_t wire_budget = 0; //bytes the uart could have sent so far
+	uint8_t sequence = 0;
+
+	for (uint64_t now = 0; now < duration_us; now += TELEMETRY_BENCH_TICK_US) {
+		wire_budget += TELEMETRY_BENCH_BAUDRATE / 10 * TELEMETRY_BENCH_TICK_US / 1000000;
+		while (in_flight > 0 && wire_budget >= in_flight) {
+			wire_budget -= in_flight;
+			result.bytes += in_flight;
+			in_flight = 0;
+			queue.transfer_complete();
+		}
+		if (in_flight == 0) wire_budget = 0; //an idle line doesn't bank anything
+
+		for (;;) {
+			TelemetryMessageId id = scheduler.next(now);
+			if (id == TELEMETRY_NONE) break;
+
+			size_t len = telemetry_frame_len(payload_len(id, sources));
+			DMATxRegion region;
+			if (queue.reserve(len, region) != STATUS_CODE_OK) break;
+			if (!scheduler.spend(len, now)) break;
+
+			TelemetryWriter writer(region, id, sequence++);
+			write_payload(writer, id, sources);
+			queue.commit(writer.finish());
+			scheduler.sent(id);
+		}
+	}
+
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		result.sent[i] = scheduler.sent_count((TelemetryMessageId) i);
+		result.skipped[i] = scheduler.skipped_count((TelemetryMessageId) i);
+	}
+	result.rejected = queue.get_rejected_writes();
+	return result;
+}
+
+static void print_link(const char *name, const float *rates_hz, uint64_t duration_us) {
+	TelemetryLinkResult result = simulate_link(rates_hz, duration_us);
+	double seconds = duration_us / 1e6;
+
+	printf("[ BENCH    ] %s: %.0f B/s, %.1f%% of %u baud\n", name, result.bytes / seconds,
+		   100.0 * result.bytes / seconds / (TELEMETRY_BENCH_BAUDRATE / 10), TELEMETRY_BENCH_BAUDRATE);
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		if (rates_hz[i] == 0) continue;
+		printf("[ BENCH    ]   %-10s asked %6.1f Hz, got %6.1f Hz, %u periods skipped\n", TELEMETRY_BENCH_NAMES[i],
+			   rates_hz[i], result.sent[i] / seconds, result.skipped[i]);
+	}
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchTelemetry, BuildingFrames) {
+	static uint8_t storage[TELEMETRY_BENCH_QUEUE_LEN];
+	size_t in_flight = 0;
+	DMATxQueue queue;
+	queue.init(storage, TELEMETRY_BENCH_QUEUE_LEN, instant_start, &in_flight);
+
+	TelemetryBenchSources sources = bench_sources();
+	uint8_t sequence = 0;
+	char name[64];
+
+	for (int i = 0; i < TELEMETRY_MESSAGE_COUNT; i++) {
+		TelemetryMessageId id = (TelemetryMessageId) i;
+		size_t len = telemetry_frame_len(payload_len(id, sources));
+
+		//reserving, writing the fields in, encoding and committing: everything the task does per frame
+		snprintf(name, sizeof(name), "%s frame, %zu bytes", TELEMETRY_BENCH_NAMES[i], len);
+		run_benchmark(name, TELEMETRY_BENCH_ITERATIONS, [&]() {
+			DMATxRegion region;
+			queue.reserve(len, region);
+			TelemetryWriter writer(region, id, sequence++);
+			write_payload(writer, id, sources);
+			queue.commit(writer.finish());
+			queue.transfer_complete();
+		}, len);
+	}
+}
+
+TEST(BenchTelemetry, Link) {
+	//the defaults the telemetry task starts with
+	const float defaults[TELEMETRY_MESSAGE_COUNT] = {1, 20, 5, 1, 0.2f};
+	print_link("default rates, 60s", defaults, 60000000);
+
+	//more than the link can take. Everything still gets some of it
+	const float overloaded[TELEMETRY_MESSAGE_COUNT] = {1, 200, 50, 5, 1};
+	print_link("overloaded, 60s", overloaded, 60000000);
+}
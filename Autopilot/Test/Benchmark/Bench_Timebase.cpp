@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "Benchmark.hpp"
+#include "Timebase.hpp"
+
+using ::testing::Test;
+
+static const uint32_t TIMEBASE_BENCH_ITERATIONS = 10000000;
+
+static volatile uint32_t fake_counter = 0; //stands in for the timer register
+static volatile uint32_t fake_tick = 0;
+static volatile uint32_t fake_clock_hz = 216000000;
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchTimebase, ReadTime) {
+	TimebaseExtender extender;
+
+	//the way it was: ms tick plus the timer count, with a divide every read
+	run_benchmark("us time, tick + divide", TIMEBASE_BENCH_ITERATIONS, [&]() {
+		uint64_t time = (uint64_t) (fake_tick * 1000ULL + fake_counter / (fake_clock_hz / 1000000UL));
+		benchmark_do_not_optimize(time);
+		fake_counter = fake_counter + 1;
+	});
+
+	run_benchmark("us time, extended counter", TIMEBASE_BENCH_ITERATIONS, [&]() {
+		uint64_t time = extender.read([]() { return (uint32_t) fake_counter; });
+		benchmark_do_not_optimize(time);
+		fake_counter = fake_counter + 1;
+	});
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "UBX.hpp"
+#include "NMEA.hpp"
+#include "UBXCaptures.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t UBX_BENCH_ITERATIONS = 50;
+static const int UBX_BENCH_SOLUTIONS = 6000; //10 minutes at 10Hz
+
+//one epoch of the NMEA that carries the same information as a NAV-PVT
+static const char *NMEA_EPOCH =
+	"$GNRMC,195959.00,A,4328.35936,N,08032.53926,W,5.666,300.96,140619,,,D*6E\r\n"
+	"$GNVTG,300.96,T,,M,5.666,N,10.494,K,D*11\r\n"
+	"$GNGGA,195959.00,4328.35936,N,08032.53926,W,2,14,0.78,326.8,M,-35.6,M,,0000*76\r\n";
+
+TEST(UBXBenchmark, ParseCapturedSolutions) {
+	vector<uint8_t> capture;
+	for (int i = 0; i < UBX_BENCH_SOLUTIONS; i++) {
+		const uint8_t *frame = (i % 50 == 49) ? UBX_CAPTURE_NAV_PVT_NO_FIX : UBX_CAPTURE_NAV_PVT_3D_FIX;
+		capture.insert(capture.end(), frame, frame + sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	}
+
+	UBXParser parser;
+	UBXNavPVT pvt;
+	int solutions = 0;
+
+	BenchmarkResult bulk = run_benchmark("UBXParser + decode NAV-PVT", UBX_BENCH_ITERATIONS, [&]() {
+		solutions = 0;
+		size_t position = 0;
+		bool complete;
+		while (position < capture.size()) {
+			position += parser.feed(&capture[position], capture.size() - position, complete);
+			if (complete && ubx_decode_nav_pvt(parser.payload(), parser.payload_length(), pvt) == STATUS_CODE_OK) {
+				solutions++;
+			}
+		}
+		benchmark_do_not_optimize(pvt);
+	}, capture.size());
+
+	ASSERT_EQ(solutions, UBX_BENCH_SOLUTIONS);
+
+	BenchmarkResult bytewise = run_benchmark("UBXParser byte at a time", UBX_BENCH_ITERATIONS, [&]() {
+		for (size_t i = 0; i < capture.size(); i++) {
+			if (parser.feed(capture[i])) benchmark_do_not_optimize(parser.payload_length());
+		}
+	}, capture.size());
+
+	//the same solutions as NMEA text, for comparison
+	string nmea;
+	for (int i = 0; i < UBX_BENCH_SOLUTIONS; i++) nmea += NMEA_EPOCH;
+	NMEAParser nmea_parser;
+	int sentences = 0;
+
+	BenchmarkResult text = run_benchmark("NMEAParser, RMC + VTG + GGA", UBX_BENCH_ITERATIONS, [&]() {
+		sentences = 0;
+		size_t position = 0;
+		bool complete;
+		while (position < nmea.size()) {
+			position += nmea_parser.feed((const uint8_t *) nmea.data() + position, nmea.size() - position, complete);
+			if (complete) sentences++;
+		}
+		benchmark_do_not_optimize(nmea_parser.sentence());
+	}, nmea.size());
+
+	ASSERT_EQ(sentences, UBX_BENCH_SOLUTIONS * 3);
+
+	printf("[ BENCH    ] NAV-PVT: %.0f solutions/s (%.0f byte at a time), %zu bytes each\n",
+		   bulk.ops_per_sec * UBX_BENCH_SOLUTIONS, bytewise.ops_per_sec * UBX_BENCH_SOLUTIONS,
+		   sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	printf("[ BENCH    ] NMEA: %.0f solutions/s, %zu bytes each. UBX is %.1fx less cpu per solution\n",
+		   text.ops_per_sec * UBX_BENCH_SOLUTIONS, strlen(NMEA_EPOCH), text.ns_per_op / bulk.ns_per_op);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Uplink.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t UPLINK_BENCH_ITERATIONS = 2000;
+static const uint8_t UPLINK_BENCH_CHUNKS = 4;
+
+static vector<uint8_t> encode(uint8_t id, uint8_t sequence, const vector<uint8_t> &payload) {
+	size_t len = telemetry_frame_len(payload.size());
+	vector<uint8_t> frame(len);
+	DMATxRegion region = {frame.data(), len, nullptr, 0};
+
+	TelemetryWriter writer(region, (TelemetryMessageId) id, sequence);
+	writer.put_bytes(payload.data(), payload.size());
+	frame.resize(writer.finish());
+	return frame;
+}
+
+//a mission's worth of full chunks, the heaviest thing the uplink carries
+static vector<uint8_t> mission_stream() {
+	vector<uint8_t> stream;
+	srand(49);
+
+	for (uint8_t chunk = 0; chunk < UPLINK_BENCH_CHUNKS; chunk++) {
+		vector<uint8_t> payload = {1, (uint8_t) (chunk * UPLINK_MAX_CHUNK_WAYPOINTS)};
+		for (int i = 0; i < UPLINK_MAX_CHUNK_WAYPOINTS * UPLINK_WAYPOINT_LEN; i++) {
+			payload.push_back((uint8_t) (i % 5 == 0 ? 0 : rand()));
+		}
+		vector<uint8_t> frame = encode(UPLINK_MISSION_CHUNK, chunk, payload);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	return stream;
+}
+
+/***********************************************************************************************************************
+ * Benchmarks
+ **********************************************************************************************************************/
+
+TEST(BenchUplink, MissionUpload) {
+	vector<uint8_t> stream = mission_stream();
+
+	//everything the link task does with a chunk: decoding it, and unpacking its waypoints into the mission
+	run_benchmark("decode and assemble 60 waypoints", UPLINK_BENCH_ITERATIONS, [&]() {
+		uint8_t buffer[TELEMETRY_MAX_CONTENT_LEN];
+		FrameDecoder decoder(TELEMETRY_FRAMING, buffer, sizeof(buffer));
+		UplinkMission mission;
+		UplinkMissionStart start = {1, UPLINK_BENCH_CHUNKS * UPLINK_MAX_CHUNK_WAYPOINTS, {0, 0, 0}};
+		mission.start(start);
+
+		size_t position = 0;
+		while (position < stream.size()) {
+			bool complete;
+			position += decoder.feed(&stream[position], stream.size() - position, complete);
+			if (!complete) continue;
+
+			UplinkMissionChunk chunk;
+			const uint8_t *payload = decoder.packet() + TELEMETRY_HEADER_LEN;
+			if (uplink_parse_mission_chunk(payload, decoder.packet_len() - TELEMETRY_HEADER_LEN, chunk)) {
+				mission.add(chunk);
+			}
+		}
+		benchmark_do_not_optimize(mission.received());
+	}, stream.size());
+}
@@ -0,0 +1,72 @@
+/**
+ * Tiny harness for the host benchmarks in Test/Benchmark. Each benchmark is a regular gtest test case, so
+ * they are built and run along with everything else, and just print their timings.
+ *
+ * Iteration counts are kept low on purpose so the benchmarks stay quick enough to run on every build.
+ * Numbers from a desktop CPU only mean anything relative to each other, not in absolute terms
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Stops the compiler from optimizing away a computation whose result is otherwise unused
+ */
+template <typename T>
+inline void benchmark_do_not_optimize(T const &value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Forces the compiler to assume any memory may have been read or written
+ */
+inline void benchmark_clobber_memory() {
+	asm volatile("" : : : "memory");
+}
+
+typedef struct BenchmarkResult {
+	double ns_per_op;
+	double ops_per_sec;
+} BenchmarkResult;
+
+/**
+ * Runs body() iterations times and prints the average time per call
+ * @param name What to label the printed line with
+ * @param iterations
+ * @param body Callable that performs one operation
+ * @param bytes_per_op If non zero, throughput is also printed in MB/s
+ */
+template <typename F>
+BenchmarkResult run_benchmark(const char *name, uint32_t iterations, F body, size_t bytes_per_op = 0) {
+	//warm up the caches and branch predictors first
+	for (uint32_t i = 0; i < iterations / 10 + 1; i++) {
+		body();
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; i++) {
+		body();
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double total_ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+	BenchmarkResult result;
+	result.ns_per_op = total_ns / iterations;
+	result.ops_per_sec = result.ns_per_op > 0 ? 1e9 / result.ns_per_op : 0;
+
+	if (bytes_per_op > 0) {
+		printf("[ BENCH    ] %-40s %10.1f ns/op %14.0f ops/s %10.1f MB/s\n", name, result.ns_per_op,
+			   result.ops_per_sec, result.ops_per_sec * bytes_per_op / 1e6);
+	} else {
+		printf("[ BENCH    ] %-40s %10.1f ns/op %14.0f ops/s\n", name, result.ns_per_op, result.ops_per_sec);
+	}
+
+	return result;
+}
@@ -0,0 +1,31 @@
+/**
+ * Host stand-in for the system time functions in Clock.hpp. Time only moves when a test moves it, so anything
+ * that timestamps with get_system_time() or get_system_time_us() can be stepped through deterministically.
+ *
+ * The cycle counter is the exception, and follows steady_clock in ns so host benchmarks and profilers measure real
+ * time. Tests that need it to stand still can pin it with fake_clock_set_cycles()
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Clock.hpp"
+
+void fake_clock_set_us(uint64_t us);
+
+void fake_clock_advance_us(uint64_t us);
+
+/**
+ * Pins get_cycle_count() to a value, until fake_clock_release_cycles() is called
+ * @param cycles
+ */
+void fake_clock_set_cycles(uint32_t cycles);
+
+void fake_clock_advance_cycles(uint32_t cycles);
+
+/**
+ * Makes get_cycle_count() follow steady_clock again
+ */
+void fake_clock_release_cycles();
@@ -0,0 +1,47 @@
+/**
+ * Point mass fixed wing for flying the path manager on the host. Roll makes a coordinated turn, pitch is the flight
+ * path angle and airspeed follows its command with a lag. No wind, so airspeed is ground speed
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <math.h>
+#include "PathManager.hpp"
+
+struct SimulatedAircraft {
+	NEDPosition position;
+	float heading; //rad
+	float airspeed; //m/s
+	float roll; //rad
+
+	SimulatedAircraft(float north, float east, float down, float initial_heading, float initial_airspeed)
+		: heading(initial_heading), airspeed(initial_airspeed), roll(0) {
+		position.north = north;
+		position.east = east;
+		position.down = down;
+	}
+
+	PathState state() const {
+		PathState state;
+		state.position = position;
+		state.velocity_north = airspeed * cosf(heading);
+		state.velocity_east = airspeed * sinf(heading);
+		return state;
+	}
+
+	void step(const PMCommands &commands, float dt) {
+		//the attitude loops aren't perfect, roll and speed lag their commands
+		roll += (commands.roll - roll) * (dt / 0.5f);
+		airspeed += (commands.airspeed - airspeed) * (dt / 3.0f);
+
+		heading += 9.80665f * tanf(roll) / airspeed * dt;
+		if (heading > (float) M_PI) heading -= 2.0f * (float) M_PI;
+		if (heading < -(float) M_PI) heading += 2.0f * (float) M_PI;
+
+		position.north += airspeed * cosf(heading) * dt;
+		position.east += airspeed * sinf(heading) * dt;
+		position.down -= airspeed * sinf(commands.pitch) * dt;
+	}
+};
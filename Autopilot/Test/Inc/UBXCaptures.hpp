@@ -0,0 +1,51 @@
+/**
+ * UBX frames for the parser and driver tests and benchmarks, laid out byte for byte the way a NEO-M8N sends them
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+//3d differential fix at 2019-06-14 19:59:59 utc: 43.472656N 80.5423210W, 326.789m msl, hAcc 1.234m, vAcc 2.345m,
+//velocity ned 1.5, -2.5, 0.3 m/s, ground speed 2.915 m/s heading 300.96376 degrees, 14 satellites
+static const uint8_t UBX_CAPTURE_NAV_PVT_3D_FIX[] = {
+	0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x00, 0x12, 0xE4, 0x18, 0xE3, 0x07, 0x06, 0x0E, 0x13, 0x3B,
+	0x3B, 0x37, 0x19, 0x00, 0x00, 0x00, 0xC7, 0xCF, 0xFF, 0xFF, 0x03, 0x03, 0xEA, 0x0E, 0x96, 0x37,
+	0xFE, 0xCF, 0xA0, 0x66, 0xE9, 0x19, 0xA2, 0x71, 0x04, 0x00, 0x85, 0xFC, 0x04, 0x00, 0xD2, 0x04,
+	0x00, 0x00, 0x29, 0x09, 0x00, 0x00, 0xDC, 0x05, 0x00, 0x00, 0x3C, 0xF6, 0xFF, 0xFF, 0x2C, 0x01,
+	0x00, 0x00, 0x63, 0x0B, 0x00, 0x00, 0xF8, 0x3B, 0xCB, 0x01, 0x78, 0x00, 0x00, 0x00, 0x60, 0xE3,
+	0x16, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x21, 0x0B
+};
+
+//the next solution, after losing the sky: no fix, 2 satellites, hAcc at its maximum
+static const uint8_t UBX_CAPTURE_NAV_PVT_NO_FIX[] = {
+	0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x64, 0x12, 0xE4, 0x18, 0xE3, 0x07, 0x06, 0x0E, 0x13, 0x3B,
+	0x3B, 0x37, 0x19, 0x00, 0x00, 0x00, 0xB1, 0x7F, 0x39, 0x05, 0x00, 0x00, 0xEA, 0x02, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+	0xFF, 0xFF, 0x71, 0x38, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x4E, 0x00, 0x00, 0x80, 0xA8,
+	0x12, 0x01, 0x0F, 0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0xC4, 0x46
+};
+
+//ACK-ACK for a CFG-RATE
+static const uint8_t UBX_CAPTURE_ACK_CFG_RATE[] = {
+	0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x08, 0x16, 0x3F
+};
+
+//what the configuration frames should come out as
+static const uint8_t UBX_EXPECTED_CFG_PRT_115200[] = {
+	0xB5, 0x62, 0x06, 0x00, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00, 0xD0, 0x08, 0x00, 0x00, 0x00, 0xC2,
+	0x01, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xBA, 0x52
+};
+
+static const uint8_t UBX_EXPECTED_CFG_RATE_10HZ[] = {
+	0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00, 0x7A, 0x12
+};
+
+static const uint8_t UBX_EXPECTED_CFG_MSG_NAV_PVT[] = {
+	0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51
+};
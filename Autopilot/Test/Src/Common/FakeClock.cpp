@@ -0,0 +1,47 @@
+#include "FakeClock.hpp"
+#include <chrono>
+
+static uint64_t fake_time_us = 0;
+
+static bool cycles_pinned = false;
+static uint32_t fake_cycles = 0;
+
+void fake_clock_set_us(uint64_t us) {
+	fake_time_us = us;
+}
+
+void fake_clock_advance_us(uint64_t us) {
+	fake_time_us += us;
+}
+
+uint32_t get_system_time() {
+	return (uint32_t) (fake_time_us / 1000);
+}
+
+uint64_t get_system_time_us() {
+	return fake_time_us;
+}
+
+void fake_clock_set_cycles(uint32_t cycles) {
+	cycles_pinned = true;
+	fake_cycles = cycles;
+}
+
+void fake_clock_advance_cycles(uint32_t cycles) {
+	fake_cycles += cycles;
+}
+
+void fake_clock_release_cycles() {
+	cycles_pinned = false;
+}
+
+uint32_t get_cycle_count() {
+	if (cycles_pinned) return fake_cycles;
+
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+uint32_t get_cycle_count_frequency() {
+	return 1000000000UL;
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "BinaryLog.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t LOG_LEN = 64;
+
+//copies everything waiting in the log out, the way the flush task would
+static vector<uint8_t> drain(BinaryLog &log) {
+	vector<uint8_t> out;
+	const uint8_t *data;
+	size_t len;
+
+	while ((len = log.peek(data)) > 0) {
+		out.insert(out.end(), data, data + len);
+		log.consume(len);
+	}
+	return out;
+}
+
+/***********************************************************************************************************************
+ * Argument packing
+ **********************************************************************************************************************/
+
+TEST(BinaryLog, ArgumentsArePackedLittleEndianInOrder) {
+
+	/***********************SETUP***********************/
+
+	uint8_t packed[32];
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t *end = binary_log_pack(packed, (uint8_t) 0xAB, (int16_t) -2, 1.5f, (uint64_t) 0x0102030405060708ULL);
+
+	/**********************ASSERTS**********************/
+
+	const uint8_t expected[] = {
+		0xAB, 0x00, 0x00, 0x00,
+		0xFE, 0xFF, 0xFF, 0xFF,
+		0x00, 0x00, 0xC0, 0x3F,
+		0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01
+	};
+
+	ASSERT_EQ((size_t) (end - packed), sizeof(expected));
+	ASSERT_EQ(memcmp(packed, expected, sizeof(expected)), 0);
+}
+
+TEST(BinaryLog, StringsAreCopiedWithALengthAndTruncated) {
+
+	/***********************SETUP***********************/
+
+	uint8_t packed[64];
+	char temporary[8] = "abc";
+	const char *too_long = "0123456789012345678901234567890123456789";
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t *end = binary_log_pack(packed, temporary, too_long, (const char *) nullptr);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(packed[0], 3);
+	ASSERT_EQ(memcmp(&packed[1], "abc", 3), 0);
+	ASSERT_EQ(packed[4], BINARY_LOG_MAX_STRING_LEN);
+	ASSERT_EQ(memcmp(&packed[5], too_long, BINARY_LOG_MAX_STRING_LEN), 0);
+	ASSERT_EQ(packed[5 + BINARY_LOG_MAX_STRING_LEN], 0);
+	ASSERT_EQ((size_t) (end - packed), 4 + 1 + BINARY_LOG_MAX_STRING_LEN + 1);
+}
+
+TEST(BinaryLog, WorstCaseSizeCoversEveryArgument) {
+
+	/***********************SETUP***********************/
+
+	size_t none = BinaryLogArgsSize<>::value;
+	size_t numbers = BinaryLogArgsSize<uint8_t, float, int64_t>::value;
+	size_t with_string = BinaryLogArgsSize<const char *, uint32_t>::value;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(none, 0u);
+	ASSERT_EQ(numbers, 16u);
+	ASSERT_EQ(with_string, 1 + BINARY_LOG_MAX_STRING_LEN + 4);
+}
+
+/***********************************************************************************************************************
+ * Records
+ **********************************************************************************************************************/
+
+TEST(BinaryLog, RecordsAreFramedWithSyncLengthAndId) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[LOG_LEN];
+	BinaryLog log;
+	ASSERT_EQ(log.init(storage, LOG_LEN), STATUS_CODE_OK);
+
+	uint8_t args[8];
+	uint8_t *end = binary_log_pack(args, (uint32_t) 0x11223344, (int32_t) -1);
+
+	/********************STEPTHROUGH********************/
+
+	bool written = log.write(0x1234, args, (uint8_t) (end - args));
+	bool no_args = log.write(0x0042, nullptr, 0);
+	vector<uint8_t> out = drain(log);
+
+	/**********************ASSERTS**********************/
+
+	const uint8_t expected[] = {
+		BINARY_LOG_SYNC, 8, 0x34, 0x12, 0x44, 0x33, 0x22, 0x11, 0xFF, 0xFF, 0xFF, 0xFF,
+		BINARY_LOG_SYNC, 0, 0x42, 0x00
+	};
+
+	ASSERT_TRUE(written);
+	ASSERT_TRUE(no_args);
+	ASSERT_EQ(out, vector<uint8_t>(expected, expected + sizeof(expected)));
+}
+
+TEST(BinaryLog, DroppedRecordsAreReportedOnceThereIsRoom) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[LOG_LEN];
+	uint8_t args[BINARY_LOG_MAX_ARGS_LEN] = {0};
+	BinaryLog log;
+	log.init(storage, LOG_LEN);
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_TRUE(log.write(1, args, 40));
+	ASSERT_FALSE(log.write(2, args, 40)); //doesn't fit
+	ASSERT_FALSE(log.write(3, args, 10)); //fits, but not along with the drop record in front of it
+	drain(log);
+
+	ASSERT_TRUE(log.write(4, args, 4));
+	vector<uint8_t> out = drain(log);
+
+	/**********************ASSERTS**********************/
+
+	const uint8_t expected[] = {
+		BINARY_LOG_SYNC, 4, 0xFF, 0xFF, 2, 0, 0, 0,
+		BINARY_LOG_SYNC, 4, 4, 0, 0, 0, 0, 0
+	};
+
+	ASSERT_EQ(out, vector<uint8_t>(expected, expected + sizeof(expected)));
+	ASSERT_EQ(log.get_dropped(), 2u);
+}
+
+TEST(BinaryLog, UninitializedLogDropsEverything) {
+
+	/***********************SETUP***********************/
+
+	uint8_t args[4] = {0};
+	BinaryLog log;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(log.write(1, args, sizeof(args)));
+	ASSERT_EQ(log.get_dropped(), 1u);
+}
+
+TEST(BinaryLog, TryWriteLeavesRecordsOutWithoutDroppingThem) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[LOG_LEN];
+	uint8_t args[BINARY_LOG_MAX_ARGS_LEN] = {0};
+	BinaryLog log;
+	log.init(storage, LOG_LEN);
+
+	/********************STEPTHROUGH********************/
+
+	bool first = log.try_write(1, args, 40);
+	bool second = log.try_write(2, args, 40);
+	drain(log);
+	bool after_drain = log.try_write(2, args, 40);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(first);
+	ASSERT_FALSE(second);
+	ASSERT_TRUE(after_drain);
+	ASSERT_EQ(log.get_dropped(), 0u);
+}
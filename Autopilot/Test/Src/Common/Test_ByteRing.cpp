@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <thread>
+#include "fff.h"
+
+#include "ByteRing.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t RING_LEN = 16;
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+TEST(ByteRing, CapacityMustBeAPowerOfTwo) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[24];
+	ByteRing ring;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(ring.init(storage, 24), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(ring.init(storage, 0), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(ring.init(nullptr, 16), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(ring.init(storage, 16), STATUS_CODE_OK);
+	ASSERT_EQ(ring.capacity(), 16u);
+	ASSERT_TRUE(ring.empty());
+}
+
+/***********************************************************************************************************************
+ * Copying in and out
+ **********************************************************************************************************************/
+
+TEST(ByteRing, SingleBytesComeOutInOrder) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+
+	/********************STEPTHROUGH********************/
+
+	for (uint8_t i = 0; i < RING_LEN; i++) {
+		ASSERT_TRUE(ring.push(i));
+	}
+	bool pushed_when_full = ring.push(0xFF);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(pushed_when_full);
+	ASSERT_EQ(ring.space(), 0u);
+
+	uint8_t byte;
+	for (uint8_t i = 0; i < RING_LEN; i++) {
+		ASSERT_TRUE(ring.pop(byte));
+		ASSERT_EQ(byte, i);
+	}
+	ASSERT_FALSE(ring.pop(byte));
+}
+
+TEST(ByteRing, BulkCopiesWrapAroundTheEnd) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+
+	uint8_t in[12];
+	uint8_t out[12];
+	for (int i = 0; i < 12; i++) in[i] = (uint8_t) (i + 1);
+
+	/********************STEPTHROUGH********************/
+
+	//push and pop a few times so the data straddles the end of the storage
+	size_t total_pushed = 0;
+	size_t total_popped = 0;
+	for (int round = 0; round < 5; round++) {
+		total_pushed += ring.push(in, sizeof(in));
+		size_t popped = ring.pop(out, sizeof(out));
+		total_popped += popped;
+		ASSERT_EQ(popped, sizeof(out));
+		ASSERT_EQ(memcmp(in, out, sizeof(in)), 0);
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(total_pushed, 60u);
+	ASSERT_EQ(total_popped, 60u);
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST(ByteRing, PushStopsWhenFull) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+	uint8_t data[RING_LEN * 2] = {0};
+
+	/********************STEPTHROUGH********************/
+
+	size_t pushed = ring.push(data, sizeof(data));
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(pushed, RING_LEN);
+	ASSERT_EQ(ring.size(), RING_LEN);
+	ASSERT_EQ(ring.push(data, 1), 0u);
+}
+
+TEST(ByteRing, ClearEmptiesTheRing) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+	uint8_t data[5] = {1, 2, 3, 4, 5};
+
+	/********************STEPTHROUGH********************/
+
+	ring.push(data, sizeof(data));
+	ring.clear();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(ring.empty());
+	ASSERT_EQ(ring.space(), RING_LEN);
+}
+
+/***********************************************************************************************************************
+ * Zero copy regions
+ **********************************************************************************************************************/
+
+TEST(ByteRing, PeekStopsAtTheEndOfTheStorage) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+	uint8_t data[RING_LEN];
+	for (uint8_t i = 0; i < RING_LEN; i++) data[i] = i;
+
+	/********************STEPTHROUGH********************/
+
+	ring.push(data, 12);
+	ring.pop(data, 10); //tail is now at index 10
+	ring.push(data, 10); //6 bytes at the end, 4 wrapped to the start
+
+	const uint8_t *first;
+	size_t first_len = ring.peek(first);
+	ring.consume(first_len);
+
+	const uint8_t *second;
+	size_t second_len = ring.peek(second);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(first_len, 6u);
+	ASSERT_EQ(first, &storage[10]);
+	ASSERT_EQ(second_len, 6u);
+	ASSERT_EQ(second, &storage[0]);
+}
+
+TEST(ByteRing, ReservedBytesAreOnlyVisibleOnceCommitted) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[RING_LEN];
+	ByteRing ring;
+	ring.init(storage, RING_LEN);
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t *region;
+	size_t len = ring.reserve(region);
+	memset(region, 0xAB, 4);
+	size_t size_before_commit = ring.size();
+	ring.commit(4);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(len, RING_LEN);
+	ASSERT_EQ(size_before_commit, 0u);
+	ASSERT_EQ(ring.size(), 4u);
+
+	uint8_t byte;
+	ring.pop(byte);
+	ASSERT_EQ(byte, 0xAB);
+}
+
+/***********************************************************************************************************************
+ * Concurrency
+ **********************************************************************************************************************/
+
+TEST(ByteRing, TwoThreadStressKeepsEveryByteInOrder) {
+
+	/***********************SETUP***********************/
+
+	static const uint32_t TOTAL_BYTES = 1000000;
+	static uint8_t storage[64];
+	ByteRing ring;
+	ring.init(storage, sizeof(storage));
+
+	/********************STEPTHROUGH********************/
+
+	//mix of single bytes, bulk copies and in place regions on both sides, with odd sizes so every
+	//wraparound case gets hit
+	thread producer([&ring]() {
+		uint32_t next = 0;
+		while (next < TOTAL_BYTES) {
+			//let the consumer run when full, or single core machines spend most of the test spinning
+			if (ring.space() == 0) {
+				this_thread::yield();
+			} else if (next % 3 == 0) {
+				uint8_t *region;
+				size_t len = ring.reserve(region);
+				if (len > TOTAL_BYTES - next) len = TOTAL_BYTES - next;
+				for (size_t i = 0; i < len; i++) region[i] = (uint8_t) (next + i);
+				ring.commit(len);
+				next += (uint32_t) len;
+			} else if (next % 3 == 1) {
+				uint8_t chunk[13];
+				size_t len = sizeof(chunk);
+				if (len > TOTAL_BYTES - next) len = TOTAL_BYTES - next;
+				for (size_t i = 0; i < len; i++) chunk[i] = (uint8_t) (next + i);
+				next += (uint32_t) ring.push(chunk, len);
+			} else if (ring.push((uint8_t) next)) {
+				next++;
+			}
+		}
+	});
+
+	uint32_t received = 0;
+	uint32_t mismatches = 0;
+	while (received < TOTAL_BYTES) {
+		if (ring.empty()) {
+			this_thread::yield();
+		} else if (received % 2 == 0) {
+			const uint8_t *region;
+			size_t len = ring.peek(region);
+			for (size_t i = 0; i < len; i++) {
+				if (region[i] != (uint8_t) (received + i)) mismatches++;
+			}
+			ring.consume(len);
+			received += (uint32_t) len;
+		} else {
+			uint8_t chunk[7];
+			size_t len = ring.pop(chunk, sizeof(chunk));
+			for (size_t i = 0; i < len; i++) {
+				if (chunk[i] != (uint8_t) (received + i)) mismatches++;
+			}
+			received += (uint32_t) len;
+		}
+	}
+	producer.join();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(mismatches, 0u);
+	ASSERT_EQ(received, TOTAL_BYTES);
+	ASSERT_TRUE(ring.empty());
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "fff.h"
+
+#include "CycleProfiler.hpp"
+#include "FakeClock.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static vector<string> printed_lines;
+
+static void save_line(const char *line) {
+	printed_lines.push_back(line);
+}
+
+/***********************************************************************************************************************
+ * Histogram buckets
+ **********************************************************************************************************************/
+
+TEST(CycleProfiler, SmallValuesGetABucketEach) {
+
+	/**********************ASSERTS**********************/
+
+	for (uint32_t i = 0; i < CYCLE_PROFILER_SUB_BUCKETS; i++) {
+		ASSERT_EQ(CycleProfiler::bucket_for(i), i);
+		ASSERT_EQ(CycleProfiler::bucket_upper_bound((uint8_t) i), i);
+	}
+}
+
+TEST(CycleProfiler, BucketsCoverEveryValueWithoutGaps) {
+
+	/**********************ASSERTS**********************/
+
+	uint8_t last_bucket = CYCLE_PROFILER_NUM_BUCKETS - 1;
+
+	ASSERT_EQ(CycleProfiler::bucket_for(UINT32_MAX), last_bucket);
+	ASSERT_EQ(CycleProfiler::bucket_upper_bound(last_bucket), UINT32_MAX);
+
+	for (uint8_t i = 0; i < last_bucket; i++) {
+		uint32_t upper = CycleProfiler::bucket_upper_bound(i);
+		ASSERT_EQ(CycleProfiler::bucket_for(upper), i);
+		ASSERT_EQ(CycleProfiler::bucket_for(upper + 1), i + 1);
+	}
+}
+
+TEST(CycleProfiler, BucketsAreWithinAQuarterOfTheirValues) {
+
+	/**********************ASSERTS**********************/
+
+	uint32_t values[] = {5, 100, 1000, 12345, 216000, 1000000, 50000000};
+
+	for (uint32_t value : values) {
+		uint32_t upper = CycleProfiler::bucket_upper_bound(CycleProfiler::bucket_for(value));
+		ASSERT_GE(upper, value);
+		ASSERT_LE(upper - value, value / 4);
+	}
+}
+
+/***********************************************************************************************************************
+ * Recording
+ **********************************************************************************************************************/
+
+TEST(CycleProfiler, RecordKeepsCountTotalMinAndMax) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler profiler("stats");
+
+	/********************STEPTHROUGH********************/
+
+	profiler.record(300);
+	profiler.record(100);
+	profiler.record(200);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(profiler.get_count(), 3u);
+	ASSERT_EQ(profiler.get_total(), 600u);
+	ASSERT_EQ(profiler.get_min(), 100u);
+	ASSERT_EQ(profiler.get_max(), 300u);
+	ASSERT_EQ(profiler.get_latest(), 200u);
+	ASSERT_EQ(profiler.get_mean(), 200u);
+}
+
+TEST(CycleProfiler, EmptyProfilerReportsZeros) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler profiler("empty");
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(profiler.get_min(), 0u);
+	ASSERT_EQ(profiler.get_mean(), 0u);
+	ASSERT_EQ(profiler.get_percentile(50), 0u);
+}
+
+TEST(CycleProfiler, PercentilesComeFromTheHistogram) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler profiler("percentiles");
+
+	/********************STEPTHROUGH********************/
+
+	//98 fast runs, and two slow outliers
+	for (int i = 0; i < 98; i++) {
+		profiler.record(1000);
+	}
+	profiler.record(8000);
+	profiler.record(40000);
+
+	/**********************ASSERTS**********************/
+
+	uint32_t fast_bucket_top = CycleProfiler::bucket_upper_bound(CycleProfiler::bucket_for(1000));
+	uint32_t slow_bucket_top = CycleProfiler::bucket_upper_bound(CycleProfiler::bucket_for(8000));
+
+	ASSERT_EQ(profiler.get_percentile(50), fast_bucket_top);
+	ASSERT_EQ(profiler.get_percentile(98), fast_bucket_top);
+	ASSERT_EQ(profiler.get_percentile(99), slow_bucket_top);
+	ASSERT_EQ(profiler.get_percentile(100), 40000u); //clamped to the max rather than the bucket edge
+	ASSERT_EQ(profiler.get_percentile(0), fast_bucket_top);
+}
+
+TEST(CycleProfiler, StartAndStopTimeWithTheCycleCounter) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler profiler("start stop");
+	fake_clock_set_cycles(UINT32_MAX - 10);
+
+	/********************STEPTHROUGH********************/
+
+	profiler.start();
+	fake_clock_advance_cycles(50); //wraps the counter
+	profiler.stop();
+
+	fake_clock_release_cycles();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(profiler.get_count(), 1u);
+	ASSERT_EQ(profiler.get_latest(), 50u);
+}
+
+TEST(CycleProfiler, ScopeGuardRecordsOnEveryWayOut) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler profiler("scope");
+	fake_clock_set_cycles(0);
+
+	auto timed = [&](bool leave_early) {
+		PROFILE_SCOPE(profiler);
+		fake_clock_advance_cycles(10);
+		if (leave_early) return;
+		fake_clock_advance_cycles(20);
+	};
+
+	/********************STEPTHROUGH********************/
+
+	timed(true);
+	uint32_t early = profiler.get_latest();
+	timed(false);
+	uint32_t full = profiler.get_latest();
+
+	fake_clock_release_cycles();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(profiler.get_count(), 2u);
+	ASSERT_EQ(early, 10u);
+	ASSERT_EQ(full, 30u);
+}
+
+/***********************************************************************************************************************
+ * Registry
+ **********************************************************************************************************************/
+
+TEST(CycleProfiler, ProfilersRegisterAndUnregisterThemselves) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler *before = CycleProfiler::first();
+
+	/********************STEPTHROUGH********************/
+
+	bool found = false;
+	{
+		CycleProfiler profiler("registered");
+
+		for (CycleProfiler *p = CycleProfiler::first(); p != nullptr; p = p->next()) {
+			if (p == &profiler) found = true;
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(found);
+	ASSERT_EQ(CycleProfiler::first(), before);
+}
+
+TEST(CycleProfiler, PrintAllDumpsEveryProfilerWithSamples) {
+
+	/***********************SETUP***********************/
+
+	CycleProfiler imu("imu read");
+	CycleProfiler idle("never run");
+	CycleProfiler pid("pid");
+	printed_lines.clear();
+
+	/********************STEPTHROUGH********************/
+
+	imu.record(2000);
+	pid.record(500);
+	CycleProfiler::print_all(save_line);
+
+	CycleProfiler::reset_all();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(printed_lines.size(), 2u);
+	ASSERT_EQ(printed_lines[0].find("pid: n 1, cycles min 500"), 0u);
+	ASSERT_EQ(printed_lines[1].find("imu read: n 1, cycles min 2000"), 0u);
+	ASSERT_NE(printed_lines[1].find("us mean 2.0"), string::npos); //the host counter runs at 1GHz
+	ASSERT_EQ(imu.get_count(), 0u);
+	ASSERT_EQ(pid.get_count(), 0u);
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "fff.h"
+
+#include "DMA.hpp"
+#include "ByteRing.hpp"
+#include "FakeClock.hpp"
+
+using ::testing::Test;
+
+static const size_t DMA_LEN = 8;
+
+/**
+ * Stands in for a circular dma stream writing into the buffer, and for the interrupts that report on it. The half
+ * and full transfer events fire on their own as bytes come in, the idle line event is up to the test
+ */
+class DMASimulation {
+ public:
+	DMASimulation(uint32_t ring_len = 64) : remaining(DMA_LEN), next_byte(0), events(0) {
+		ring.init(ring_storage, ring_len);
+
+		memset(&config, 0, sizeof(config));
+		resetDMAConfig(&config, DMA_LEN);
+		config.dma_buffer = dma_buffer;
+		config.queue = &ring;
+	}
+
+	//the peripheral receives bytes, which the dma writes into the buffer, wrapping around at the end
+	void receive(size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dma_buffer[DMA_LEN - remaining] = next_byte++;
+			remaining--;
+
+			if (remaining == DMA_LEN / 2) {
+				event();
+			} else if (remaining == 0) {
+				remaining = DMA_LEN;
+				event();
+			}
+		}
+	}
+
+	size_t event() {
+		events++;
+		return copyDMARXRegion(&config, remaining);
+	}
+
+	DMAConfig config;
+	ByteRing ring;
+	uint8_t ring_storage[64];
+	uint8_t dma_buffer[DMA_LEN];
+	uint32_t remaining;
+	uint8_t next_byte;
+	uint32_t events;
+};
+
+static void expect_sequence(ByteRing &ring, uint8_t first, size_t count) {
+	uint8_t data[64];
+	ASSERT_EQ(ring.pop(data, sizeof(data)), count);
+	for (size_t i = 0; i < count; i++) {
+		ASSERT_EQ(data[i], (uint8_t) (first + i));
+	}
+}
+
+/***********************************************************************************************************************
+ * Region tracking
+ **********************************************************************************************************************/
+
+TEST(DMAReceive, IdleLineDeliversAPartialBuffer) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(3);
+	size_t copied = dma.event();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(copied, 3u);
+	expect_sequence(dma.ring, 0, 3);
+}
+
+TEST(DMAReceive, HalfAndFullTransferDeliverWithoutAnIdleLine) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(DMA_LEN / 2);
+	size_t after_half = dma.ring.size();
+	dma.receive(DMA_LEN / 2);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(after_half, DMA_LEN / 2);
+	ASSERT_EQ(dma.events, 2u);
+	expect_sequence(dma.ring, 0, DMA_LEN);
+}
+
+TEST(DMAReceive, OnlyNewBytesAreCopiedOnEachEvent) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(1);
+	dma.event();
+	dma.receive(4); //half transfer fires after the third of these
+	size_t copied = dma.event();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(copied, 1u);
+	expect_sequence(dma.ring, 0, 5);
+}
+
+TEST(DMAReceive, IdleLineAfterAWrapCopiesBothEnds) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(6);
+	dma.event();
+	dma.ring.clear();
+
+	//pretend the full transfer interrupt got held off, so the idle line sees data on both sides of the wrap
+	for (int i = 0; i < 5; i++) {
+		dma.dma_buffer[(6 + i) % DMA_LEN] = (uint8_t) (6 + i);
+	}
+	dma.remaining = DMA_LEN - 3;
+	size_t copied = dma.event();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(copied, 5u);
+	expect_sequence(dma.ring, 6, 5);
+}
+
+TEST(DMAReceive, EventWithNoNewDataCopiesNothing) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(DMA_LEN);
+	size_t copied = dma.event(); //idle line right after the buffer filled up exactly
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(copied, 0u);
+	expect_sequence(dma.ring, 0, DMA_LEN);
+}
+
+TEST(DMAReceive, LongStreamArrivesInOrder) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+	uint8_t data[64];
+	uint8_t expected = 0;
+
+	/********************STEPTHROUGH********************/
+
+	//bursts of odd lengths so that idle lines land all over the buffer
+	for (int burst = 0; burst < 100; burst++) {
+		dma.receive((size_t) (burst % 11) + 1);
+		dma.event();
+
+		size_t popped = dma.ring.pop(data, sizeof(data));
+		for (size_t i = 0; i < popped; i++) {
+			ASSERT_EQ(data[i], expected++);
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(expected, dma.next_byte);
+	ASSERT_EQ(dma.config.dropped_bytes, 0u);
+}
+
+TEST(DMAReceive, FullRingCountsDroppedBytes) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma(4);
+
+	/********************STEPTHROUGH********************/
+
+	dma.receive(3);
+	dma.event();
+	dma.receive(3);
+	dma.event();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dma.config.dropped_bytes, 2u);
+	expect_sequence(dma.ring, 0, 4);
+}
+
+/***********************************************************************************************************************
+ * Arrival stamps
+ **********************************************************************************************************************/
+
+TEST(DMAArrival, BytesAreTimedBackFromTheirHandOver) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+	uint32_t time;
+
+	/********************STEPTHROUGH********************/
+
+	fake_clock_set_us(1000);
+	dma.receive(3);
+	dma.event();
+
+	fake_clock_set_us(5000);
+	dma.receive(2);
+	dma.event();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dma.config.received_bytes, 5u);
+
+	//87us a byte, the last one in each hand over coming in just as it's stamped
+	ASSERT_TRUE(getDMARXArrival(&dma.config, 0, 87, &time));
+	ASSERT_EQ(time, 1000u - 2 * 87);
+	ASSERT_TRUE(getDMARXArrival(&dma.config, 1, 87, &time));
+	ASSERT_EQ(time, 1000u - 87);
+	ASSERT_TRUE(getDMARXArrival(&dma.config, 2, 87, &time));
+	ASSERT_EQ(time, 1000u);
+
+	//the half transfer event handed the fourth byte over by itself
+	ASSERT_TRUE(getDMARXArrival(&dma.config, 3, 87, &time));
+	ASSERT_EQ(time, 5000u);
+	ASSERT_EQ(dma.events, 3u);
+
+	//not here yet
+	ASSERT_FALSE(getDMARXArrival(&dma.config, 5, 87, &time));
+}
+
+TEST(DMAArrival, OldHandOversAreForgotten) {
+
+	/***********************SETUP***********************/
+
+	DMASimulation dma;
+	uint32_t time;
+
+	/********************STEPTHROUGH********************/
+
+	for (uint32_t i = 0; i < DMA_RX_STAMPS + 1; i++) {
+		fake_clock_set_us(1000 * (i + 1));
+		dma.receive(1);
+		dma.event();
+	}
+
+	/**********************ASSERTS**********************/
+
+	//the oldest stamp is left out as it's the next to go, and the one after it can't tell where its bytes started
+	ASSERT_FALSE(getDMARXArrival(&dma.config, 0, 87, &time));
+	ASSERT_FALSE(getDMARXArrival(&dma.config, 2, 87, &time));
+	ASSERT_TRUE(getDMARXArrival(&dma.config, 3, 87, &time));
+	ASSERT_EQ(time, 4000u);
+	ASSERT_TRUE(getDMARXArrival(&dma.config, DMA_RX_STAMPS, 87, &time));
+	ASSERT_EQ(time, 1000u * (DMA_RX_STAMPS + 1));
+
+	//stamps only start again when the ring does
+	resetDMAConfig(&dma.config, DMA_LEN);
+	ASSERT_EQ(dma.config.received_bytes, (uint32_t) DMA_RX_STAMPS + 1);
+	resetDMARXStamps(&dma.config);
+	ASSERT_FALSE(getDMARXArrival(&dma.config, 0, 87, &time));
+}
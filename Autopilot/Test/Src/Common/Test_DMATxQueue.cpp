@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+#include "fff.h"
+
+#include "DMATxQueue.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t QUEUE_LEN = 16;
+
+/**
+ * Stand-in for the dma. Remembers the region it was handed, and puts it on the wire when the test says the
+ * transfer has finished
+ */
+typedef struct FakeTxDMA {
+	bool accept = true;
+	int transfers_started = 0;
+	const uint8_t *region = nullptr;
+	size_t region_len = 0;
+	string wire;
+} FakeTxDMA;
+
+static bool fake_start(void *context, const uint8_t *data, size_t len) {
+	auto dma = (FakeTxDMA *) context;
+	if (!dma->accept) return false;
+
+	dma->transfers_started++;
+	dma->region = data;
+	dma->region_len = len;
+	return true;
+}
+
+static void fake_finish(FakeTxDMA &dma, DMATxQueue &queue) {
+	dma.wire.append((const char *) dma.region, dma.region_len);
+	queue.transfer_complete();
+}
+
+static StatusCode write_string(DMATxQueue &queue, const char *string) {
+	return queue.write((const uint8_t *) string, strlen(string));
+}
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+TEST(DMATxQueue, InitNeedsAStartFunctionAndPowerOfTwoStorage) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[24];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(queue.write(storage, 1), STATUS_CODE_UNINITIALIZED);
+	ASSERT_EQ(queue.init(storage, 16, nullptr, &dma), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(queue.init(storage, 24, fake_start, &dma), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(queue.init(storage, 16, fake_start, &dma), STATUS_CODE_OK);
+	ASSERT_EQ(queue.capacity(), 16u);
+	ASSERT_FALSE(queue.busy());
+}
+
+/***********************************************************************************************************************
+ * Chaining transfers
+ **********************************************************************************************************************/
+
+TEST(DMATxQueue, WriteStartsTheDMAWhenIdle) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = write_string(queue, "hello");
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(dma.transfers_started, 1);
+	ASSERT_EQ(dma.region_len, 5u);
+	ASSERT_TRUE(queue.busy());
+	ASSERT_EQ(queue.pending(), 5u);
+}
+
+TEST(DMATxQueue, WritesWhileBusyAreChainedOnCompletion) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	/********************STEPTHROUGH********************/
+
+	write_string(queue, "abc");
+	write_string(queue, "de");
+	write_string(queue, "f");
+	int started_while_busy = dma.transfers_started;
+
+	fake_finish(dma, queue);
+	int started_after_first = dma.transfers_started;
+	size_t second_len = dma.region_len;
+
+	fake_finish(dma, queue);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(started_while_busy, 1);
+	ASSERT_EQ(started_after_first, 2);
+	ASSERT_EQ(second_len, 3u); //everything queued while the first transfer ran goes out in one go
+	ASSERT_EQ(dma.wire, "abcdef");
+	ASSERT_FALSE(queue.busy());
+	ASSERT_EQ(queue.pending(), 0u);
+}
+
+TEST(DMATxQueue, DataWrappingAroundTheEndIsSentInTwoTransfers) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	write_string(queue, "0123456789ab");
+	fake_finish(dma, queue);
+
+	/********************STEPTHROUGH********************/
+
+	write_string(queue, "ABCDEFGH");
+	size_t first_len = dma.region_len;
+	fake_finish(dma, queue);
+	size_t second_len = dma.region_len;
+	fake_finish(dma, queue);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(first_len, 4u);
+	ASSERT_EQ(second_len, 4u);
+	ASSERT_EQ(dma.wire, "0123456789abABCDEFGH");
+	ASSERT_FALSE(queue.busy());
+}
+
+/***********************************************************************************************************************
+ * Back pressure and errors
+ **********************************************************************************************************************/
+
+TEST(DMATxQueue, ReservedSpaceWrapsAroundTheEnd) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	write_string(queue, "0123456789ab");
+	fake_finish(dma, queue);
+
+	/********************STEPTHROUGH********************/
+
+	DMATxRegion region;
+	ASSERT_EQ(queue.reserve(17, region), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(queue.reserve(8, region), STATUS_CODE_OK);
+	ASSERT_FALSE(queue.busy()); //nothing goes out until it's committed
+
+	const char *message = "ABCDEFGH";
+	for (size_t i = 0; i < 8; i++) {
+		if (i < region.first_len) {
+			region.first[i] = (uint8_t) message[i];
+		} else {
+			region.second[i - region.first_len] = (uint8_t) message[i];
+		}
+	}
+	queue.commit(7);
+	fake_finish(dma, queue);
+	fake_finish(dma, queue);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(region.first_len, 4u);
+	ASSERT_EQ(region.second_len, 4u);
+	ASSERT_EQ(region.second, storage);
+	ASSERT_EQ(dma.wire, "0123456789abABCDEFG");
+	ASSERT_EQ(queue.pending(), 0u);
+
+	write_string(queue, "0123456789abcdef");
+	ASSERT_EQ(queue.reserve(1, region), STATUS_CODE_RESOURCE_EXHAUSTED);
+	ASSERT_EQ(queue.get_rejected_writes(), 1u);
+}
+
+TEST(DMATxQueue, FullQueueTurnsAwayTheWholeWrite) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	uint8_t too_big[QUEUE_LEN + 1] = {0};
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	/********************STEPTHROUGH********************/
+
+	write_string(queue, "0123456789");
+	StatusCode overflow = write_string(queue, "ABCDEFGH");
+	StatusCode fits = write_string(queue, "ABCDEF");
+	StatusCode never_fits = queue.write(too_big, sizeof(too_big));
+
+	while (queue.busy()) {
+		fake_finish(dma, queue);
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(overflow, STATUS_CODE_RESOURCE_EXHAUSTED);
+	ASSERT_EQ(fits, STATUS_CODE_OK);
+	ASSERT_EQ(never_fits, STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(queue.get_rejected_writes(), 1u);
+	ASSERT_EQ(dma.wire, "0123456789ABCDEF");
+}
+
+TEST(DMATxQueue, FailedStartIsRetriedOnTheNextWrite) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	/********************STEPTHROUGH********************/
+
+	dma.accept = false;
+	write_string(queue, "abc");
+	bool busy_after_failed_start = queue.busy();
+
+	dma.accept = true;
+	write_string(queue, "de");
+	fake_finish(dma, queue);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(busy_after_failed_start);
+	ASSERT_EQ(dma.transfers_started, 1);
+	ASSERT_EQ(dma.wire, "abcde");
+}
+
+TEST(DMATxQueue, AbortedTransferIsSentAgain) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[QUEUE_LEN];
+	FakeTxDMA dma;
+	DMATxQueue queue;
+	queue.init(storage, QUEUE_LEN, fake_start, &dma);
+
+	/********************STEPTHROUGH********************/
+
+	write_string(queue, "abc");
+	queue.transfer_aborted();
+	queue.transfer_complete(); //a late completion after the abort mustn't free anything
+
+	write_string(queue, "d");
+	fake_finish(dma, queue);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dma.transfers_started, 2);
+	ASSERT_EQ(dma.wire, "abcd");
+	ASSERT_EQ(queue.pending(), 0u);
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "fff.h"
+
+#include "DShot.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint8_t GCR_ENCODE[16] = {
+	0x19, 0x1B, 0x12, 0x13, 0x1D, 0x15, 0x16, 0x17, 0x1A, 0x09, 0x0A, 0x0B, 0x1E, 0x0D, 0x0E, 0x0F
+};
+
+//builds the reply an ESC sends back for a given period per electrical revolution, the way the ESC firmware does
+static uint32_t build_erpm_reply(uint16_t exponent, uint16_t mantissa) {
+	uint16_t value = (uint16_t) ((exponent << 9) | mantissa);
+	uint16_t crc = (uint16_t) (~(value ^ (value >> 4) ^ (value >> 8)) & 0x0F);
+	uint16_t packet = (uint16_t) ((value << 4) | crc);
+
+	uint32_t gcr = 0;
+	for (int shift = 12; shift >= 0; shift -= 4) {
+		gcr = (gcr << 5) | GCR_ENCODE[(packet >> shift) & 0x0F];
+	}
+	return gcr;
+}
+
+//timestamps of the edges on the line for a reply. Every 1 in the start bit + gcr data flips the line
+static vector<uint16_t> reply_edges(uint32_t gcr, uint16_t ticks_per_bit, uint16_t start_time) {
+	vector<uint16_t> edges;
+	uint32_t bits = (1UL << 20) | gcr;
+
+	for (int bit = 20; bit >= 0; bit--) {
+		if (bits & (1UL << bit)) {
+			edges.push_back((uint16_t) (start_time + (20 - bit) * ticks_per_bit));
+		}
+	}
+	return edges;
+}
+
+/***********************************************************************************************************************
+ * Frame encoding
+ **********************************************************************************************************************/
+
+TEST(DShot, PacketMatchesKnownFrames) {
+
+	/***********************SETUP***********************/
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	//value 1046, no telemetry: 10000010110 0 -> crc 0110
+	ASSERT_EQ(dshot_encode_packet(1046, false, false), 0x82C6);
+
+	//motor stop is all zeros, including the crc
+	ASSERT_EQ(dshot_encode_packet(DSHOT_CMD_MOTOR_STOP, false, false), 0x0000);
+
+	//bidirectional inverts the crc only
+	ASSERT_EQ(dshot_encode_packet(1046, false, true), 0x82C9);
+
+	//telemetry bit goes in bit 4 and is covered by the crc
+	ASSERT_EQ(dshot_encode_packet(DSHOT_THROTTLE_MAX, true, false), 0xFFFF);
+}
+
+TEST(DShot, CrcCoversEveryNibble) {
+
+	/***********************SETUP***********************/
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	for (uint16_t value = 0; value <= DSHOT_THROTTLE_MAX; value++) {
+		uint16_t packet = dshot_encode_packet(value, false, false);
+		uint16_t check = (uint16_t) (packet ^ (packet >> 4) ^ (packet >> 8) ^ (packet >> 12));
+
+		ASSERT_EQ(packet >> 5, value);
+		ASSERT_EQ(check & 0x0F, 0);
+	}
+}
+
+TEST(DShot, ThrottleIsClampedToValidRange) {
+
+	/***********************SETUP***********************/
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dshot_throttle_value(0), DSHOT_THROTTLE_MIN);
+	ASSERT_EQ(dshot_throttle_value(DSHOT_THROTTLE_RANGE - 1), DSHOT_THROTTLE_MAX);
+	ASSERT_EQ(dshot_throttle_value(5000), DSHOT_THROTTLE_MAX);
+	ASSERT_EQ(dshot_encode_packet(5000, false, false) >> 5, DSHOT_THROTTLE_MAX);
+}
+
+TEST(DShot, TimingForSafetyChipClock) {
+
+	/***********************SETUP***********************/
+
+	DShotTiming timing;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dshot_get_timing(DSHOT_600, 48000000, timing), STATUS_CODE_OK);
+	ASSERT_EQ(timing.period, 80);
+	ASSERT_EQ(timing.bit_1, 60);
+	ASSERT_EQ(timing.bit_0, 30);
+
+	ASSERT_EQ(dshot_get_timing(DSHOT_150, 48000000, timing), STATUS_CODE_OK);
+	ASSERT_EQ(timing.period, 320);
+
+	ASSERT_EQ(dshot_get_timing(DSHOT_600, 1000000, timing), STATUS_CODE_OUT_OF_RANGE);
+}
+
+TEST(DShot, BurstBufferInterleavesChannels) {
+
+	/***********************SETUP***********************/
+
+	DShotTiming timing = {80, 30, 60};
+	uint16_t packets[2] = {0x8000, 0x0001};
+	uint16_t buffer[DSHOT_FRAME_SLOTS * 2];
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	dshot_fill_burst_buffer(packets, 2, timing, buffer);
+
+	/**********************ASSERTS**********************/
+
+	//msb first, channel 0 then channel 1 for every bit
+	ASSERT_EQ(buffer[0], 60);
+	ASSERT_EQ(buffer[1], 30);
+	ASSERT_EQ(buffer[2], 30);
+	ASSERT_EQ(buffer[(DSHOT_FRAME_BITS - 1) * 2], 30);
+	ASSERT_EQ(buffer[(DSHOT_FRAME_BITS - 1) * 2 + 1], 60);
+
+	for (int i = DSHOT_FRAME_BITS * 2; i < DSHOT_FRAME_SLOTS * 2; i++) {
+		ASSERT_EQ(buffer[i], 0);
+	}
+}
+
+/***********************************************************************************************************************
+ * eRPM telemetry
+ **********************************************************************************************************************/
+
+TEST(DShot, ErpmReplyIsDecoded) {
+
+	/***********************SETUP***********************/
+
+	//period of 100 << 2 = 400us per electrical revolution -> 150000 erpm
+	uint32_t gcr = build_erpm_reply(2, 100);
+	uint32_t erpm = 1;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = dshot_decode_erpm(gcr, erpm);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(erpm, 150000u);
+}
+
+TEST(DShot, StoppedMotorReadsZero) {
+
+	/***********************SETUP***********************/
+
+	uint32_t erpm = 1;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dshot_decode_erpm(build_erpm_reply(7, 511), erpm), STATUS_CODE_OK);
+	ASSERT_EQ(erpm, 0u);
+}
+
+TEST(DShot, CorruptReplyIsRejected) {
+
+	/***********************SETUP***********************/
+
+	uint32_t gcr = build_erpm_reply(2, 100);
+	uint32_t erpm = 1234;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	//every single bit flip either breaks a gcr code or the crc
+	for (int bit = 0; bit < 20; bit++) {
+		ASSERT_EQ(dshot_decode_erpm(gcr ^ (1UL << bit), erpm), STATUS_CODE_INVALID_ARGS) << "bit " << bit;
+	}
+	ASSERT_EQ(erpm, 1234u);
+}
+
+TEST(DShot, ErpmIsDecodedFromCapturedEdges) {
+
+	/***********************SETUP***********************/
+
+	//dshot600 reply comes in at 750kbit, which is 64 ticks per bit on a 48Mhz timer
+	const uint16_t ticks_per_bit = 64;
+	uint32_t gcr = build_erpm_reply(3, 250);
+	vector<uint16_t> edges = reply_edges(gcr, ticks_per_bit, 0xFF00);
+
+	//a bit of jitter on every edge shouldn't matter
+	for (size_t i = 0; i < edges.size(); i++) {
+		edges[i] = (uint16_t) (edges[i] + ((i % 2) ? 9 : -7));
+	}
+
+	uint32_t erpm = 0;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = dshot_decode_erpm_edges(edges.data(), edges.size(), ticks_per_bit, erpm);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(erpm, 30000u); //250 << 3 = 2000us
+}
+
+TEST(DShot, TruncatedEdgesAreRejected) {
+
+	/***********************SETUP***********************/
+
+	const uint16_t ticks_per_bit = 64;
+	vector<uint16_t> edges = reply_edges(build_erpm_reply(3, 250), ticks_per_bit, 0);
+
+	//an extra edge far past the end of the reply
+	vector<uint16_t> long_edges = edges;
+	long_edges.push_back((uint16_t) (edges.back() + 30 * ticks_per_bit));
+
+	uint32_t erpm = 0;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(dshot_decode_erpm_edges(edges.data(), 0, ticks_per_bit, erpm), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(dshot_decode_erpm_edges(long_edges.data(), long_edges.size(), ticks_per_bit, erpm),
+			  STATUS_CODE_INVALID_ARGS);
+}
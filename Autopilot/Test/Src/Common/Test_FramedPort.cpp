@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "HostDevices.hpp"
+#include "FramedPort.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const FramingFormat FORMAT = {FRAMING_COBS, true};
+static const size_t PACKET_CAPACITY = 256;
+
+static UARTSettings make_settings() {
+	UARTSettings settings;
+	settings.parity = UART_NO_PARITY;
+	settings.timeout = 20;
+	return settings;
+}
+
+static vector<uint8_t> encode(const vector<uint8_t> &packet) {
+	vector<uint8_t> frame(framing_max_frame_len(FORMAT, packet.size()));
+	frame.resize(framing_encode(FORMAT, packet.data(), packet.size(), frame.data(), frame.size()));
+	return frame;
+}
+
+static vector<uint8_t> numbered_packet(uint8_t number, size_t len) {
+	vector<uint8_t> packet(len);
+	for (size_t i = 0; i < len; i++) packet[i] = (uint8_t) (i % 5 == 0 ? 0 : number + i);
+	return packet;
+}
+
+static void collect(void *context, const uint8_t *packet, size_t len) {
+	static_cast<vector<vector<uint8_t>> *>(context)->push_back(vector<uint8_t>(packet, packet + len));
+}
+
+class FramedPortTest : public Test {
+ protected:
+	UARTPort port;
+	uint8_t buffer[PACKET_CAPACITY];
+	vector<vector<uint8_t>> received;
+
+	void SetUp() override {
+		host_devices_reset();
+		port = UARTPort(UART_PORT3, make_settings());
+		port.setup();
+		ASSERT_EQ(port.setupDMA(0, 64), STATUS_CODE_OK);
+	}
+
+	void TearDown() override { host_devices_reset(); }
+
+	void inject(const vector<uint8_t> &bytes) { host_uart_inject(UART_PORT3, bytes.data(), bytes.size()); }
+};
+
+/***********************************************************************************************************************
+ * Receiving
+ **********************************************************************************************************************/
+
+TEST_F(FramedPortTest, WholeFramesAreHandedOutWhereTheyArrived) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+
+	vector<uint8_t> first = numbered_packet(1, 40);
+	vector<uint8_t> second = numbered_packet(2, 3);
+
+	/********************STEPTHROUGH********************/
+
+	inject(encode(first));
+	inject({0, 0}); //an idle line in between
+	inject(encode(second));
+	size_t delivered = link.receive(1024);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(delivered, 2u);
+	ASSERT_EQ(received.size(), 2u);
+	ASSERT_EQ(received[0], first);
+	ASSERT_EQ(received[1], second);
+	ASSERT_EQ(link.in_place_count(), 2u);
+	ASSERT_EQ(link.decoder().error_count(), 0u);
+	ASSERT_EQ(port.rx_available(), 0u);
+}
+
+TEST_F(FramedPortTest, FramesAroundTheEndOfTheRingArePutBackTogether) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+	vector<vector<uint8_t>> sent;
+
+	/********************STEPTHROUGH********************/
+
+	//frames of odd lengths, taken in as they come, so they end up split around the end of the ring now and then
+	for (uint8_t i = 0; i < 60; i++) {
+		vector<uint8_t> packet = numbered_packet(i, 7 + (i * 37) % 150);
+		inject(encode(packet));
+		sent.push_back(packet);
+		link.receive(1024);
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(received, sent);
+	ASSERT_GT(link.in_place_count(), 0u);
+	ASSERT_LT(link.in_place_count(), sent.size());
+	ASSERT_EQ(link.decoder().frame_count(), sent.size());
+}
+
+TEST_F(FramedPortTest, WaitsForTheRestOfAFrameToDecodeItInPlace) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+
+	vector<uint8_t> packet = numbered_packet(9, 100);
+	vector<uint8_t> frame = encode(packet);
+	vector<uint8_t> first_half(frame.begin(), frame.begin() + 50);
+	vector<uint8_t> second_half(frame.begin() + 50, frame.end());
+
+	/********************STEPTHROUGH********************/
+
+	inject(first_half);
+	size_t early = link.receive(1024);
+	size_t waiting = port.rx_available();
+
+	inject(second_half);
+	size_t late = link.receive(1024);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(early, 0u);
+	ASSERT_EQ(waiting, 50u);
+	ASSERT_EQ(late, 1u);
+	ASSERT_EQ(received[0], packet);
+	ASSERT_EQ(link.in_place_count(), 1u);
+}
+
+TEST_F(FramedPortTest, NoiseWithoutDelimitersIsntWaitedOnForever) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+
+	vector<uint8_t> noise(300, 0x42);
+	vector<uint8_t> packet = numbered_packet(3, 20);
+
+	/********************STEPTHROUGH********************/
+
+	inject(noise);
+	link.receive(1024);
+	inject({0});
+	inject(encode(packet));
+	link.receive(1024);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(received.size(), 1u);
+	ASSERT_EQ(received[0], packet);
+	ASSERT_EQ(link.decoder().error_count(), 1u);
+}
+
+TEST_F(FramedPortTest, EachCallOnlyWorksThroughItsBudget) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+
+	vector<uint8_t> packet = numbered_packet(4, 26); //30 bytes framed
+	for (int i = 0; i < 10; i++) inject(encode(packet));
+
+	/********************STEPTHROUGH********************/
+
+	size_t first = link.receive(100);
+	size_t calls = 1;
+	while (received.size() < 10 && calls < 20) {
+		link.receive(100);
+		calls++;
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(first, 3u);
+	ASSERT_EQ(received.size(), 10u);
+	ASSERT_EQ(calls, 3u);
+	for (const vector<uint8_t> &got : received) ASSERT_EQ(got, packet);
+}
+
+TEST_F(FramedPortTest, PacketsGoToEveryHandlerAndQueue) {
+
+	/***********************SETUP***********************/
+
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	uint8_t storage[128];
+	FrameQueue queue;
+	queue.init(storage, sizeof(storage));
+
+	vector<vector<uint8_t>> also_received;
+	ASSERT_EQ(link.add_handler(collect, &received), STATUS_CODE_OK);
+	ASSERT_EQ(link.add_queue(queue), STATUS_CODE_OK);
+	ASSERT_EQ(link.add_handler(collect, &also_received), STATUS_CODE_OK);
+	ASSERT_EQ(link.add_handler(collect, &also_received), STATUS_CODE_OK);
+	ASSERT_EQ(link.add_handler(collect, &also_received), STATUS_CODE_RESOURCE_EXHAUSTED);
+	ASSERT_EQ(link.add_handler(nullptr, nullptr), STATUS_CODE_INVALID_ARGS);
+
+	vector<uint8_t> packet = numbered_packet(5, 12);
+	uint8_t out[32];
+	size_t len;
+
+	/********************STEPTHROUGH********************/
+
+	inject(encode(packet));
+	link.receive(1024);
+	StatusCode popped = queue.pop(out, sizeof(out), len);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(received.size(), 1u);
+	ASSERT_EQ(also_received.size(), 2u);
+	ASSERT_EQ(popped, STATUS_CODE_OK);
+	ASSERT_EQ(vector<uint8_t>(out, out + len), packet);
+}
+
+/***********************************************************************************************************************
+ * Sending
+ **********************************************************************************************************************/
+
+TEST_F(FramedPortTest, SentPacketsComeOutTheOtherEnd) {
+
+	/***********************SETUP***********************/
+
+	UARTPort sender_port(UART_PORT1, make_settings());
+	sender_port.setup();
+	ASSERT_EQ(sender_port.setupDMA(512, 0), STATUS_CODE_OK);
+	host_uart_connect(UART_PORT1, UART_PORT3);
+
+	uint8_t unused[PACKET_CAPACITY];
+	FramedPort sender(sender_port, FORMAT, unused, sizeof(unused));
+	FramedPort link(port, FORMAT, buffer, sizeof(buffer));
+	link.add_handler(collect, &received);
+
+	vector<vector<uint8_t>> sent;
+
+	/********************STEPTHROUGH********************/
+
+	for (uint8_t i = 0; i < 20; i++) {
+		vector<uint8_t> packet = numbered_packet(i, 10 + i * 3);
+		ASSERT_EQ(sender.send(packet.data(), packet.size()), STATUS_CODE_OK);
+		sent.push_back(packet);
+		link.receive(1024);
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(received, sent);
+	UARTPort blocking(UART_PORT2, make_settings());
+	blocking.setup();
+	FramedPort no_dma(blocking, FORMAT, unused, sizeof(unused));
+	ASSERT_EQ(no_dma.send(sent[0].data(), sent[0].size()), STATUS_CODE_UNINITIALIZED);
+	sender_port.reset();
+}
@@ -0,0 +1,515 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "Framing.hpp"
+#include "Checksum.h"
+
+using namespace std;
+using ::testing::Test;
+
+static const FramingFormat FORMATS[] = {
+	{FRAMING_COBS, false},
+	{FRAMING_COBS, true},
+	{FRAMING_SLIP, false},
+	{FRAMING_SLIP, true},
+};
+
+static const size_t DECODER_CAPACITY = 600;
+
+static vector<uint8_t> encode(FramingFormat format, const vector<uint8_t> &packet) {
+	vector<uint8_t> frame(framing_max_frame_len(format, packet.size()));
+	frame.resize(framing_encode(format, packet.data(), packet.size(), frame.data(), frame.size()));
+	return frame;
+}
+
+static vector<uint8_t> packet_of(const FrameDecoder &decoder) {
+	return vector<uint8_t>(decoder.packet(), decoder.packet() + decoder.packet_len());
+}
+
+//feeds everything, a run at a time the way a uart hands it over, and collects every packet
+static vector<vector<uint8_t>> decode_all(FrameDecoder &decoder, const vector<uint8_t> &stream, size_t run = 0) {
+	vector<vector<uint8_t>> packets;
+	size_t position = 0;
+
+	while (position < stream.size()) {
+		size_t len = stream.size() - position;
+		if (run != 0 && len > run) len = run;
+
+		bool complete;
+		position += decoder.feed(&stream[position], len, complete);
+		if (complete) packets.push_back(packet_of(decoder));
+	}
+	return packets;
+}
+
+//everything between the delimiters, decoded where it is
+static bool decode_in_place(FrameDecoder &decoder, vector<uint8_t> frame, vector<uint8_t> &packet) {
+	uint8_t delimiter = framing_delimiter(decoder.frame_format());
+	if (!frame.empty() && frame.front() == delimiter) frame.erase(frame.begin());
+	if (!frame.empty() && frame.back() == delimiter) frame.pop_back();
+
+	size_t len;
+	if (!decoder.decode_in_place(frame.data(), frame.size(), len)) return false;
+	packet.assign(frame.begin(), frame.begin() + len);
+	return true;
+}
+
+static vector<uint8_t> random_packet(size_t max_len) {
+	vector<uint8_t> packet(rand() % (max_len + 1));
+	for (uint8_t &byte : packet) {
+		//plenty of the bytes that need encoding
+		switch (rand() % 4) {
+			case 0: byte = 0; break;
+			case 1: byte = rand() % 2 ? FRAMING_SLIP_END : FRAMING_SLIP_ESC; break;
+			default: byte = (uint8_t) rand(); break;
+		}
+	}
+	return packet;
+}
+
+/***********************************************************************************************************************
+ * Encoding
+ **********************************************************************************************************************/
+
+TEST(Framing, COBSMatchesThePaper) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat cobs = {FRAMING_COBS, false};
+
+	vector<uint8_t> counting; //01 to FE, exactly one full block
+	for (int i = 1; i < 255; i++) counting.push_back((uint8_t) i);
+	vector<uint8_t> starting_at_zero = {0};
+	starting_at_zero.insert(starting_at_zero.end(), counting.begin(), counting.end());
+	vector<uint8_t> one_over = counting;
+	one_over.push_back(0xFF);
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> full = encode(cobs, counting);
+	vector<uint8_t> after_zero = encode(cobs, starting_at_zero);
+	vector<uint8_t> over = encode(cobs, one_over);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(encode(cobs, {0}), vector<uint8_t>({1, 1, 0}));
+	ASSERT_EQ(encode(cobs, {0, 0}), vector<uint8_t>({1, 1, 1, 0}));
+	ASSERT_EQ(encode(cobs, {0x11, 0x22, 0, 0x33}), vector<uint8_t>({3, 0x11, 0x22, 2, 0x33, 0}));
+	ASSERT_EQ(encode(cobs, {0x11, 0x22, 0x33, 0x44}), vector<uint8_t>({5, 0x11, 0x22, 0x33, 0x44, 0}));
+
+	//a full block at the end doesn't need another code byte after it
+	ASSERT_EQ(full.size(), 256u);
+	ASSERT_EQ(full[0], 0xFF);
+	ASSERT_EQ(full[255], 0);
+
+	ASSERT_EQ(after_zero.size(), 257u);
+	ASSERT_EQ(after_zero[0], 1);
+	ASSERT_EQ(after_zero[1], 0xFF);
+
+	ASSERT_EQ(over.size(), 258u);
+	ASSERT_EQ(over[0], 0xFF);
+	ASSERT_EQ(over[255], 2);
+	ASSERT_EQ(over[256], 0xFF);
+}
+
+TEST(Framing, SLIPEscapesItsSpecialBytes) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat slip = {FRAMING_SLIP, false};
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(encode(slip, {0xC0, 0xDB, 0x01}), vector<uint8_t>({0xC0, 0xDB, 0xDC, 0xDB, 0xDD, 0x01, 0xC0}));
+	ASSERT_EQ(encode(slip, {}), vector<uint8_t>({0xC0, 0xC0}));
+}
+
+TEST(Framing, CRCFollowsThePacket) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat slip = {FRAMING_SLIP, true};
+	vector<uint8_t> packet = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> frame = encode(slip, packet);
+
+	/**********************ASSERTS**********************/
+
+	//0x29B1 is the check value for CRC-16/CCITT-FALSE, and neither byte of it needs escaping
+	ASSERT_EQ(frame.size(), 1 + packet.size() + 2 + 1);
+	ASSERT_EQ(frame[10], 0xB1);
+	ASSERT_EQ(frame[11], 0x29);
+}
+
+TEST(Framing, FramesNeverRunOverTheirWorstCase) {
+
+	/***********************SETUP***********************/
+
+	srand(50);
+
+	/**********************ASSERTS**********************/
+
+	for (const FramingFormat &format : FORMATS) {
+		for (int i = 0; i < 500; i++) {
+			vector<uint8_t> packet = random_packet(800);
+			if (i == 0) packet.assign(800, FRAMING_SLIP_END);
+			if (i == 1) packet.assign(800, 0x55);
+
+			vector<uint8_t> frame(framing_max_frame_len(format, packet.size()) + 16, 0xAA);
+			size_t len = framing_encode(format, packet.data(), packet.size(), frame.data(), frame.size());
+
+			ASSERT_GT(len, 0u);
+			ASSERT_LE(len, framing_max_frame_len(format, packet.size()));
+			ASSERT_EQ(frame[len - 1], framing_delimiter(format));
+		}
+	}
+}
+
+TEST(Framing, WriterWrapsAcrossBothPieces) {
+
+	/***********************SETUP***********************/
+
+	vector<uint8_t> packet;
+	for (int i = 0; i < 300; i++) packet.push_back((uint8_t) (i % 9 == 0 ? 0 : i % 5 == 0 ? FRAMING_SLIP_ESC : i));
+
+	/**********************ASSERTS**********************/
+
+	for (const FramingFormat &format : FORMATS) {
+		vector<uint8_t> expected = encode(format, packet);
+
+		for (size_t split = 0; split <= expected.size(); split += 7) {
+			vector<uint8_t> first(split);
+			vector<uint8_t> second(expected.size() - split);
+			DMATxRegion region = {first.data(), first.size(), second.data(), second.size()};
+
+			FrameWriter writer(format, region);
+			writer.put_bytes(packet.data(), packet.size());
+			ASSERT_EQ(writer.finish(), expected.size());
+
+			first.insert(first.end(), second.begin(), second.end());
+			ASSERT_EQ(first, expected) << "split at " << split;
+		}
+	}
+}
+
+TEST(Framing, WriterTurnsDownFramesThatDontFit) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat cobs = {FRAMING_COBS, true};
+	uint8_t space[20];
+	memset(space, 0xAA, sizeof(space));
+	DMATxRegion region = {space, 8, space + 10, 4};
+
+	/********************STEPTHROUGH********************/
+
+	FrameWriter writer(cobs, region);
+	writer.put_u32(0x01020304);
+	writer.put_u32(0x05060708);
+	writer.put_u32(0x090A0B0C);
+	size_t len = writer.finish();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(len, 0u);
+	ASSERT_EQ(space[8], 0xAA);
+	ASSERT_EQ(space[9], 0xAA);
+	for (size_t i = 14; i < sizeof(space); i++) ASSERT_EQ(space[i], 0xAA);
+}
+
+/***********************************************************************************************************************
+ * Decoding
+ **********************************************************************************************************************/
+
+TEST(Framing, EveryFormatComesBackTheSameBothWays) {
+
+	/***********************SETUP***********************/
+
+	srand(51);
+	uint8_t buffer[DECODER_CAPACITY];
+
+	/**********************ASSERTS**********************/
+
+	for (const FramingFormat &format : FORMATS) {
+		for (int i = 0; i < 300; i++) {
+			vector<uint8_t> packet = random_packet(DECODER_CAPACITY - FRAMING_CRC_LEN);
+			if (packet.empty() && !format.crc) continue; //nothing to tell it apart from an idle line
+			vector<uint8_t> frame = encode(format, packet);
+
+			FrameDecoder decoder(format, buffer, sizeof(buffer));
+			vector<vector<uint8_t>> fed = decode_all(decoder, frame);
+			vector<uint8_t> in_place;
+			bool decoded = decode_in_place(decoder, frame, in_place);
+
+			ASSERT_EQ(fed.size(), 1u);
+			ASSERT_EQ(fed[0], packet);
+			ASSERT_TRUE(decoded);
+			ASSERT_EQ(in_place, packet);
+			ASSERT_EQ(decoder.frame_count(), 2u);
+			ASSERT_EQ(decoder.error_count(), 0u);
+			ASSERT_TRUE(decoder.idle());
+		}
+	}
+}
+
+TEST(Framing, DecoderStopsAfterEachFrame) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat cobs = {FRAMING_COBS, true};
+	uint8_t buffer[DECODER_CAPACITY];
+	FrameDecoder decoder(cobs, buffer, sizeof(buffer));
+
+	vector<uint8_t> first = {1, 0, 0, 2, 3};
+	vector<uint8_t> second(200, 0x55);
+	vector<uint8_t> stream = encode(cobs, first);
+	size_t first_len = stream.size();
+	vector<uint8_t> second_frame = encode(cobs, second);
+	stream.insert(stream.end(), second_frame.begin(), second_frame.end());
+
+	/********************STEPTHROUGH********************/
+
+	bool complete;
+	size_t used = decoder.feed(stream.data(), stream.size(), complete);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(complete);
+	ASSERT_EQ(used, first_len);
+	ASSERT_EQ(packet_of(decoder), first);
+
+	used = decoder.feed(&stream[first_len], stream.size() - first_len, complete);
+	ASSERT_TRUE(complete);
+	ASSERT_EQ(used, second_frame.size());
+	ASSERT_EQ(packet_of(decoder), second);
+}
+
+TEST(Framing, RunsCanEndAnywhere) {
+
+	/***********************SETUP***********************/
+
+	//0s and escapes all over the place, and more than one full cobs block
+	vector<uint8_t> mixed;
+	for (int i = 0; i < 400; i++) mixed.push_back((uint8_t) (i % 7 == 0 ? 0 : i % 11 == 0 ? FRAMING_SLIP_END : i));
+	vector<uint8_t> plain(520, 0x11);
+	uint8_t buffer[DECODER_CAPACITY];
+
+	/**********************ASSERTS**********************/
+
+	for (const FramingFormat &format : FORMATS) {
+		vector<uint8_t> stream = encode(format, mixed);
+		vector<uint8_t> second = encode(format, plain);
+		stream.insert(stream.end(), second.begin(), second.end());
+
+		for (size_t run = 1; run < 40; run++) {
+			FrameDecoder decoder(format, buffer, sizeof(buffer));
+			vector<vector<uint8_t>> packets = decode_all(decoder, stream, run);
+
+			ASSERT_EQ(packets.size(), 2u) << "runs of " << run;
+			ASSERT_EQ(packets[0], mixed);
+			ASSERT_EQ(packets[1], plain);
+		}
+	}
+}
+
+TEST(Framing, DropsDamagedFramesAndPicksUpAfter) {
+
+	/***********************SETUP***********************/
+
+	uint8_t buffer[DECODER_CAPACITY];
+	vector<uint8_t> packet = {1, 2, 3, 0, 5, FRAMING_SLIP_END};
+
+	/**********************ASSERTS**********************/
+
+	for (const FramingFormat &format : {FORMATS[1], FORMATS[3]}) {
+		FrameDecoder decoder(format, buffer, sizeof(buffer));
+		uint8_t delimiter = framing_delimiter(format);
+
+		vector<uint8_t> damaged = encode(format, packet);
+		damaged[4] ^= 0x10;
+		vector<uint8_t> truncated = encode(format, packet);
+		truncated.erase(truncated.begin() + 3);
+		vector<uint8_t> good = encode(format, packet);
+
+		vector<uint8_t> stream(3, delimiter); //an idle line
+		stream.insert(stream.end(), damaged.begin(), damaged.end());
+		stream.insert(stream.end(), truncated.begin(), truncated.end());
+		stream.insert(stream.end(), good.begin(), good.end());
+
+		vector<vector<uint8_t>> packets = decode_all(decoder, stream);
+		vector<uint8_t> in_place;
+
+		ASSERT_EQ(packets.size(), 1u);
+		ASSERT_EQ(packets[0], packet);
+		ASSERT_EQ(decoder.error_count(), 2u);
+
+		ASSERT_FALSE(decode_in_place(decoder, damaged, in_place));
+		ASSERT_FALSE(decode_in_place(decoder, truncated, in_place));
+		ASSERT_EQ(decoder.error_count(), 4u);
+	}
+}
+
+TEST(Framing, DropsFramesThatAreTooLong) {
+
+	/***********************SETUP***********************/
+
+	FramingFormat cobs = {FRAMING_COBS, true};
+	uint8_t buffer[64];
+	FrameDecoder decoder(cobs, buffer, sizeof(buffer));
+
+	vector<uint8_t> long_packet(63, 0x42);
+	vector<uint8_t> longest(62, 0x42);
+	vector<uint8_t> stream(600, 0x42);
+	stream.push_back(0);
+	vector<uint8_t> too_long = encode(cobs, long_packet);
+	vector<uint8_t> fits = encode(cobs, longest);
+	stream.insert(stream.end(), too_long.begin(), too_long.end());
+	stream.insert(stream.end(), fits.begin(), fits.end());
+
+	/********************STEPTHROUGH********************/
+
+	vector<vector<uint8_t>> packets = decode_all(decoder, stream);
+	vector<uint8_t> in_place;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(packets.size(), 1u);
+	ASSERT_EQ(packets[0], longest);
+	ASSERT_EQ(decoder.error_count(), 2u);
+	ASSERT_FALSE(decode_in_place(decoder, too_long, in_place));
+	ASSERT_EQ(decoder.max_frame_len(), fits.size());
+}
+
+TEST(Framing, Fuzz) {
+
+	/***********************SETUP***********************/
+
+	//good frames, each after a stretch of random bytes (delimiters included) and after a copy of itself with random
+	//damage
+	srand(49);
+	uint8_t buffer[256];
+
+	for (const FramingFormat &format : {FORMATS[1], FORMATS[3]}) {
+		vector<uint8_t> stream;
+		vector<vector<uint8_t>> sent;
+
+		for (int i = 0; i < 3000; i++) {
+			vector<uint8_t> packet = random_packet(120);
+			vector<uint8_t> frame = encode(format, packet);
+
+			int garbage = rand() % 300;
+			for (int j = 0; j < garbage; j++) stream.push_back((uint8_t) rand());
+
+			vector<uint8_t> damaged = frame;
+			switch (rand() % 3) {
+				case 0: damaged[1 + rand() % (damaged.size() - 2)] ^= (uint8_t) (1 + rand() % 255); break;
+				case 1: damaged.erase(damaged.begin() + 1 + rand() % (damaged.size() - 2)); break;
+				default: damaged.insert(damaged.begin() + 1 + rand() % (damaged.size() - 1), (uint8_t) rand()); break;
+			}
+			stream.insert(stream.end(), damaged.begin(), damaged.end());
+
+			stream.push_back(framing_delimiter(format));
+			stream.insert(stream.end(), frame.begin(), frame.end());
+			sent.push_back(packet);
+		}
+
+		/********************STEPTHROUGH********************/
+
+		FrameDecoder decoder(format, buffer, sizeof(buffer));
+		vector<vector<uint8_t>> packets = decode_all(decoder, stream, 61);
+
+		/**********************ASSERTS**********************/
+
+		//every good frame comes through in order. The crc can be fooled by chance, but hardly ever
+		size_t found = 0;
+		size_t spurious = 0;
+		for (const vector<uint8_t> &packet : packets) {
+			ASSERT_LE(packet.size(), sizeof(buffer) - FRAMING_CRC_LEN);
+			if (found < sent.size() && packet == sent[found]) {
+				found++;
+			} else {
+				spurious++;
+			}
+		}
+
+		ASSERT_EQ(found, sent.size());
+		ASSERT_LE(spurious, 3u);
+		ASSERT_GT(decoder.error_count(), 3000u);
+	}
+}
+
+/***********************************************************************************************************************
+ * Queueing
+ **********************************************************************************************************************/
+
+TEST(FrameQueue, PacketsComeOutWholeAndInOrder) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[64];
+	FrameQueue queue;
+	ASSERT_EQ(queue.init(storage, 48), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(queue.init(storage, sizeof(storage)), STATUS_CODE_OK);
+
+	uint8_t out[32];
+	size_t len;
+
+	/**********************ASSERTS**********************/
+
+	//packets of every length up to 20, so they land across the end of the ring at every offset
+	for (uint8_t i = 0; i < 100; i++) {
+		vector<uint8_t> packet(i % 21, i);
+		vector<uint8_t> next(i % 13, (uint8_t) ~i);
+
+		ASSERT_TRUE(queue.push(packet.data(), packet.size()));
+		ASSERT_TRUE(queue.push(next.data(), next.size()));
+
+		ASSERT_EQ(queue.pop(out, sizeof(out), len), STATUS_CODE_OK);
+		ASSERT_EQ(vector<uint8_t>(out, out + len), packet);
+		ASSERT_EQ(queue.pop(out, sizeof(out), len), STATUS_CODE_OK);
+		ASSERT_EQ(vector<uint8_t>(out, out + len), next);
+	}
+
+	ASSERT_EQ(queue.pop(out, sizeof(out), len), STATUS_CODE_EMPTY);
+	ASSERT_EQ(queue.dropped_count(), 0u);
+}
+
+TEST(FrameQueue, DropsWhatDoesntFit) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[32];
+	FrameQueue queue;
+	queue.init(storage, sizeof(storage));
+
+	uint8_t packet[20] = {1, 2, 3};
+	uint8_t out[8];
+	size_t len;
+
+	/********************STEPTHROUGH********************/
+
+	bool first = queue.push(packet, 20);
+	bool second = queue.push(packet, 20); //22 of 32 bytes are taken
+	bool small = queue.push(packet, 3);
+	StatusCode too_long = queue.pop(out, sizeof(out), len);
+	StatusCode fits = queue.pop(out, sizeof(out), len);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(first);
+	ASSERT_FALSE(second);
+	ASSERT_TRUE(small);
+	ASSERT_EQ(queue.dropped_count(), 1u);
+
+	//one too long for what it's popped into is dropped, so it can't hold up the rest
+	ASSERT_EQ(too_long, STATUS_CODE_RESOURCE_EXHAUSTED);
+	ASSERT_EQ(fits, STATUS_CODE_OK);
+	ASSERT_EQ(len, 3u);
+	ASSERT_EQ(memcmp(out, packet, 3), 0);
+	ASSERT_TRUE(queue.empty());
+}
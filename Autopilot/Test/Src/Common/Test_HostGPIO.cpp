@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "fff.h"
+
+#include "HostDevices.hpp"
+#include "GPIO.hpp"
+#include "Clock.hpp"
+
+using ::testing::Test;
+
+class HostGPIOTest : public Test {
+ protected:
+	void SetUp() override { host_devices_reset(); }
+
+	void TearDown() override { host_devices_reset(); }
+};
+
+/***********************************************************************************************************************
+ * GPIO
+ **********************************************************************************************************************/
+
+TEST_F(HostGPIOTest, OutputsSetTheLevelAndInputsReadIt) {
+
+	/***********************SETUP***********************/
+
+	GPIOPin led(GPIO_PORT_B, 7, GPIO_OUTPUT, GPIO_STATE_HIGH);
+	GPIOPin button(GPIO_PORT_C, 13, GPIO_INPUT, GPIO_STATE_LOW, GPIO_RES_PULLUP);
+	GPIOState pressed;
+	GPIOState released;
+
+	/********************STEPTHROUGH********************/
+
+	led.setup();
+	GPIOState led_after_setup = host_gpio_level(GPIO_PORT_B, 7);
+	led.toggle_state();
+
+	button.setup();
+	button.get_state(released);
+	host_gpio_drive(GPIO_PORT_C, 13, GPIO_STATE_LOW);
+	button.get_state(pressed);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(led_after_setup, GPIO_STATE_HIGH);
+	ASSERT_EQ(host_gpio_level(GPIO_PORT_B, 7), GPIO_STATE_LOW);
+	ASSERT_EQ(released, GPIO_STATE_HIGH); //pulled up with nothing driving it
+	ASSERT_EQ(pressed, GPIO_STATE_LOW);
+}
+
+TEST_F(HostGPIOTest, PinsThatDontExistAreRejected) {
+
+	/***********************SETUP***********************/
+
+	GPIOPin pin(GPIO_PORT_A, 16, GPIO_OUTPUT, GPIO_STATE_LOW);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(pin.setup(), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(host_gpio_drive(GPIO_PORT_F, 20, GPIO_STATE_HIGH), STATUS_CODE_INVALID_ARGS);
+}
+
+/***********************************************************************************************************************
+ * Clock
+ **********************************************************************************************************************/
+
+TEST(HostClock, FollowsRealTime) {
+
+	/***********************SETUP***********************/
+
+	uint64_t start_us = get_system_time_us();
+	uint32_t start_cycles = get_cycle_count();
+
+	/********************STEPTHROUGH********************/
+
+	delay(5);
+
+	/**********************ASSERTS**********************/
+
+	uint64_t elapsed_us = get_system_time_us() - start_us;
+	uint32_t elapsed_cycles = get_cycle_count() - start_cycles;
+
+	ASSERT_GE(elapsed_us, 5000u);
+	ASSERT_LT(elapsed_us, 1000000u);
+	ASSERT_GE(elapsed_cycles / (get_cycle_count_frequency() / 1000000), elapsed_us - 1000); //same clock underneath
+}
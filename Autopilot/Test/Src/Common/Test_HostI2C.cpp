@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "fff.h"
+
+#include "HostDevices.hpp"
+#include "I2C.hpp"
+
+using ::testing::Test;
+
+static const I2CAddress BAROMETER_ADDRESS = 0x77;
+
+/**
+ * Scripted barometer: every read of the data registers sees the next pressure sample
+ */
+class FakeBarometer : public HostI2CRegisterDevice {
+ public:
+	uint16_t next_pressure = 1000;
+
+	void before_read(uint16_t address) override {
+		if (address == 0xF7) {
+			registers[0xF7] = (uint8_t) (next_pressure >> 8);
+			registers[0xF8] = (uint8_t) next_pressure;
+			next_pressure++;
+		}
+	}
+};
+
+class HostI2CTest : public Test {
+ protected:
+	void SetUp() override { host_devices_reset(); }
+
+	void TearDown() override { host_devices_reset(); }
+};
+
+/***********************************************************************************************************************
+ * Master
+ **********************************************************************************************************************/
+
+TEST_F(HostI2CTest, RegistersAreReadAndWrittenThroughTheDevice) {
+
+	/***********************SETUP***********************/
+
+	FakeBarometer barometer;
+	barometer.registers[0xD0] = 0x58; //chip id
+	host_i2c_attach(I2C_PORT1, BAROMETER_ADDRESS, &barometer);
+
+	I2CMasterPort port(I2C_PORT1, {I2C_SPEED_FAST});
+	ASSERT_EQ(port.setup(), STATUS_CODE_OK);
+
+	uint8_t id = 0;
+	uint8_t config[] = {0x27, 0xA0};
+	uint8_t pressure[2];
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode id_status = port.read_register(BAROMETER_ADDRESS, 0xD0, 1, &id, 1);
+	StatusCode config_status = port.write_register(BAROMETER_ADDRESS, 0xF4, 1, config, 2);
+	port.read_register(BAROMETER_ADDRESS, 0xF7, 1, pressure, 2);
+	port.read_register(BAROMETER_ADDRESS, 0xF7, 1, pressure, 2);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(id_status, STATUS_CODE_OK);
+	ASSERT_EQ(id, 0x58);
+	ASSERT_EQ(config_status, STATUS_CODE_OK);
+	ASSERT_EQ(barometer.registers[0xF4], 0x27);
+	ASSERT_EQ(barometer.registers[0xF5], 0xA0); //the address moved up for the second byte
+	ASSERT_EQ((pressure[0] << 8) | pressure[1], 1001);
+	ASSERT_EQ(barometer.reads, 3u);
+	ASSERT_EQ(barometer.writes, 1u);
+}
+
+TEST_F(HostI2CTest, TwoByteRegisterAddressesGoMostSignificantFirst) {
+
+	/***********************SETUP***********************/
+
+	HostI2CRegisterDevice eeprom(2);
+	host_i2c_attach(I2C_PORT2, 0x50, &eeprom);
+
+	I2CMasterPort port(I2C_PORT2, {I2C_SPEED_STANDARD});
+	port.setup();
+	uint8_t data[] = {0x11, 0x22};
+	uint8_t raw[2];
+
+	/********************STEPTHROUGH********************/
+
+	port.write_register(0x50, 0x0110, 2, data, 2);
+	uint8_t address[] = {0x01, 0x10};
+	port.write_bytes(0x50, address, 2);
+	StatusCode status = port.read_bytes(0x50, raw, 2);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(raw[0], 0x11);
+	ASSERT_EQ(raw[1], 0x22);
+}
+
+TEST_F(HostI2CTest, NothingAtTheAddressIsAnError) {
+
+	/***********************SETUP***********************/
+
+	I2CMasterPort port(I2C_PORT1, {I2C_SPEED_FAST});
+	I2CMasterPort not_setup(I2C_PORT2, {I2C_SPEED_FAST});
+	port.setup();
+	uint8_t data = 0;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(port.read_register(0x68, 0x75, 1, &data, 1), STATUS_CODE_INTERNAL_ERROR);
+	ASSERT_EQ(port.write_bytes(0x68, &data, 1), STATUS_CODE_INTERNAL_ERROR);
+	ASSERT_EQ(port.read_register(0x68, 0x75, 3, &data, 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(not_setup.read_bytes(0x68, &data, 1), STATUS_CODE_INVALID_ARGS);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "fff.h"
+
+#include "HostDevices.hpp"
+#include "SPI.hpp"
+
+using ::testing::Test;
+
+static SPISettings make_settings() {
+	SPISettings settings;
+	settings.port = SPI_PORT1;
+	settings.mode = SPI_MODE_3;
+	settings.master = true;
+	settings.frequency = 8;
+	settings.word_size = 1;
+	return settings;
+}
+
+/**
+ * Scripted imu: the gyro registers hold a new sample every read
+ */
+class FakeImu : public HostSPIRegisterDevice {
+ public:
+	uint8_t samples = 0;
+
+	void before_read(uint8_t address) override {
+		if (address == 0x43) {
+			samples++;
+			registers[0x43] = 0;
+			registers[0x44] = samples;
+		}
+	}
+};
+
+class HostSPITest : public Test {
+ protected:
+	void SetUp() override { host_devices_reset(); }
+
+	void TearDown() override { host_devices_reset(); }
+};
+
+/***********************************************************************************************************************
+ * Master
+ **********************************************************************************************************************/
+
+TEST_F(HostSPITest, SelectedSlaveAnswers) {
+
+	/***********************SETUP***********************/
+
+	FakeImu imu;
+	imu.registers[0x75] = 0x71; //who am i
+	HostSPIRegisterDevice barometer;
+	barometer.registers[0x75] = 0x58;
+
+	SPIPort port(make_settings());
+	ASSERT_EQ(port.setup(), STATUS_CODE_OK);
+	int32_t imu_slave = port.add_slave(GPIOPin(GPIO_PORT_A, 4, GPIO_OUTPUT, GPIO_STATE_LOW));
+	int32_t barometer_slave = port.add_slave(GPIOPin(GPIO_PORT_A, 5, GPIO_OUTPUT, GPIO_STATE_LOW));
+	host_spi_attach(SPI_PORT1, (uint32_t) imu_slave, &imu);
+	host_spi_attach(SPI_PORT1, (uint32_t) barometer_slave, &barometer);
+
+	uint8_t tx[] = {0x80 | 0x75, 0};
+	uint8_t rx[2];
+
+	/********************STEPTHROUGH********************/
+
+	port.set_slave((uint32_t) imu_slave);
+	port.exchange_data(tx, rx, 2);
+	uint8_t imu_id = rx[1];
+
+	port.set_slave((uint32_t) barometer_slave);
+	port.exchange_data(tx, rx, 2);
+	uint8_t barometer_id = rx[1];
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(imu_id, 0x71);
+	ASSERT_EQ(barometer_id, 0x58);
+}
+
+TEST_F(HostSPITest, BurstReadsAndWritesMoveThroughRegisters) {
+
+	/***********************SETUP***********************/
+
+	FakeImu imu;
+	SPIPort port(make_settings());
+	port.setup();
+	port.set_slave((uint32_t) port.add_slave(GPIOPin(GPIO_PORT_A, 4, GPIO_OUTPUT, GPIO_STATE_LOW)));
+	host_spi_attach(SPI_PORT1, 0, &imu);
+
+	uint8_t config[] = {0x1A, 0x03, 0x18};
+	uint8_t read_gyro[] = {0x80 | 0x43, 0, 0};
+	uint8_t rx[3];
+
+	/********************STEPTHROUGH********************/
+
+	port.exchange_data(config, nullptr, 3);
+	port.exchange_data(read_gyro, rx, 3);
+	port.exchange_data(read_gyro, rx, 3);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(imu.registers[0x1A], 0x03);
+	ASSERT_EQ(imu.registers[0x1B], 0x18);
+	ASSERT_EQ(rx[2], 2);
+}
+
+TEST_F(HostSPITest, NoDeviceReadsAllOnes) {
+
+	/***********************SETUP***********************/
+
+	SPIPort port(make_settings());
+	port.setup();
+	uint8_t rx[2] = {0, 0};
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(port.exchange_data(nullptr, rx, 2), STATUS_CODE_OK);
+	ASSERT_EQ(rx[0], 0xFF);
+	ASSERT_EQ(port.exchange_data(nullptr, nullptr, 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(port.set_slave(0), STATUS_CODE_INVALID_ARGS);
+}
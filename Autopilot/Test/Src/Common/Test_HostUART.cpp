@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fff.h"
+
+#include "HostDevices.hpp"
+#include "UART.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static UARTSettings make_settings() {
+	UARTSettings settings;
+	settings.parity = UART_NO_PARITY;
+	settings.timeout = 20;
+	return settings;
+}
+
+class HostUARTTest : public Test {
+ protected:
+	void SetUp() override { host_devices_reset(); }
+
+	void TearDown() override { host_devices_reset(); }
+};
+
+/***********************************************************************************************************************
+ * Blocking
+ **********************************************************************************************************************/
+
+TEST_F(HostUARTTest, UnwiredPortKeepsWhatItSends) {
+
+	/***********************SETUP***********************/
+
+	UARTPort port(UART_PORT2, make_settings());
+	port.setup();
+	uint8_t message[] = "$GPGGA";
+	uint8_t out[16];
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = port.transmit(message, 6);
+	size_t taken = host_uart_take_transmitted(UART_PORT2, out, sizeof(out));
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(taken, 6u);
+	ASSERT_EQ(memcmp(out, message, 6), 0);
+	ASSERT_EQ(host_uart_take_transmitted(UART_PORT2, out, sizeof(out)), 0u);
+}
+
+TEST_F(HostUARTTest, BlockingReadWaitsForEveryByteOrTimesOut) {
+
+	/***********************SETUP***********************/
+
+	UARTPort port(UART_PORT1, make_settings());
+	port.setup();
+	const uint8_t first[] = {1, 2, 3};
+	uint8_t out[4];
+	size_t read;
+
+	/********************STEPTHROUGH********************/
+
+	host_uart_inject(UART_PORT1, first, 3);
+	StatusCode too_few = port.read_bytes(out, 4, read);
+	size_t read_on_timeout = read;
+
+	//the last byte shows up while the read is waiting
+	thread sender([]() {
+		this_thread::sleep_for(chrono::milliseconds(5));
+		uint8_t last = 4;
+		host_uart_inject(UART_PORT1, &last, 1);
+	});
+	StatusCode enough = port.read_bytes(out, 4, read);
+	sender.join();
+
+	/**********************ASSERTS**********************/
+
+	const uint8_t expected[] = {1, 2, 3, 4};
+	ASSERT_EQ(too_few, STATUS_CODE_TIMEOUT);
+	ASSERT_EQ(read_on_timeout, 0u);
+	ASSERT_EQ(enough, STATUS_CODE_OK);
+	ASSERT_EQ(read, 4u);
+	ASSERT_EQ(memcmp(out, expected, 4), 0);
+}
+
+TEST_F(HostUARTTest, ConnectedPortsAreCrossedOver) {
+
+	/***********************SETUP***********************/
+
+	UARTPort autopilot(UART_PORT1, make_settings());
+	UARTPort safety(UART_PORT2, make_settings());
+	autopilot.setup();
+	safety.setup();
+	host_uart_connect(UART_PORT1, UART_PORT2);
+
+	uint8_t ping[] = {0xAA, 0x01};
+	uint8_t pong[] = {0xAA, 0x02};
+	uint8_t out[2];
+	size_t read;
+
+	/********************STEPTHROUGH********************/
+
+	autopilot.transmit(ping, 2);
+	StatusCode safety_status = safety.read_bytes(out, 2, read);
+	bool safety_got_ping = memcmp(out, ping, 2) == 0;
+
+	safety.transmit(pong, 2);
+	StatusCode autopilot_status = autopilot.read_bytes(out, 2, read);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(safety_status, STATUS_CODE_OK);
+	ASSERT_TRUE(safety_got_ping);
+	ASSERT_EQ(autopilot_status, STATUS_CODE_OK);
+	ASSERT_EQ(memcmp(out, pong, 2), 0);
+}
+
+/***********************************************************************************************************************
+ * DMA
+ **********************************************************************************************************************/
+
+TEST_F(HostUARTTest, DMAReceiveGoesThroughTheRingAroundTheBuffer) {
+
+	/***********************SETUP***********************/
+
+	UARTPort port(UART_PORT3, make_settings());
+	port.setup();
+	ASSERT_EQ(port.setupDMA(0, 16), STATUS_CODE_OK);
+
+	vector<uint8_t> sent;
+	vector<uint8_t> received;
+	uint8_t out[64];
+	size_t read;
+
+	/********************STEPTHROUGH********************/
+
+	//bursts of odd sizes, so they wrap around the 16 byte dma buffer at every offset
+	for (uint8_t burst = 1; burst < 30; burst++) {
+		vector<uint8_t> data(burst);
+		for (uint8_t i = 0; i < burst; i++) data[i] = (uint8_t) (sent.size() + i);
+
+		host_uart_inject(UART_PORT3, data.data(), data.size());
+		sent.insert(sent.end(), data.begin(), data.end());
+
+		while (port.read_bytes(out, sizeof(out), read) == STATUS_CODE_OK) {
+			received.insert(received.end(), out, out + read);
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(port.read_bytes(out, sizeof(out), read), STATUS_CODE_EMPTY);
+	ASSERT_EQ(received, sent);
+}
+
+TEST_F(HostUARTTest, DMAReceiveCanBeParsedInPlace) {
+
+	/***********************SETUP***********************/
+
+	UARTPort port(UART_PORT3, make_settings());
+	port.setup();
+	ASSERT_EQ(port.setupDMA(0, 16), STATUS_CODE_OK);
+
+	vector<uint8_t> sent;
+	vector<uint8_t> received;
+	uint8_t *data;
+	size_t len;
+
+	/********************STEPTHROUGH********************/
+
+	for (uint8_t burst = 1; burst < 30; burst++) {
+		vector<uint8_t> bytes(burst);
+		for (uint8_t i = 0; i < burst; i++) bytes[i] = (uint8_t) (sent.size() + i);
+
+		host_uart_inject(UART_PORT3, bytes.data(), bytes.size());
+		sent.insert(sent.end(), bytes.begin(), bytes.end());
+
+		//a byte less than there is each time, so runs are left part way through
+		while (port.rx_peek(data, len) == STATUS_CODE_OK) {
+			size_t used = len > 1 ? len - 1 : len;
+			received.insert(received.end(), data, data + used);
+			ASSERT_EQ(port.rx_consume(used), STATUS_CODE_OK);
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(port.rx_peek(data, len), STATUS_CODE_EMPTY);
+	ASSERT_EQ(len, 0u);
+	ASSERT_EQ(received, sent);
+
+	UARTPort blocking(UART_PORT4, make_settings());
+	blocking.setup();
+	ASSERT_EQ(blocking.rx_peek(data, len), STATUS_CODE_UNINITIALIZED);
+}
+
+TEST_F(HostUARTTest, DMATransmitIsQueuedAndDelivered) {
+
+	/***********************SETUP***********************/
+
+	UARTPort sender(UART_PORT1, make_settings());
+	UARTPort receiver(UART_PORT4, make_settings());
+	sender.setup();
+	receiver.setup();
+	ASSERT_EQ(sender.setupDMA(256, 0), STATUS_CODE_OK);
+	ASSERT_EQ(receiver.setupDMA(0, 64), STATUS_CODE_OK);
+	host_uart_connect(UART_PORT1, UART_PORT4);
+
+	uint8_t message[100];
+	for (uint8_t i = 0; i < sizeof(message); i++) message[i] = i;
+	vector<uint8_t> received;
+	uint8_t out[64];
+	size_t read;
+
+	/********************STEPTHROUGH********************/
+
+	//enough to go around the transmit queue a few times
+	for (int i = 0; i < 30; i++) {
+		ASSERT_EQ(sender.transmit(message, sizeof(message)), STATUS_CODE_OK);
+		while (receiver.read_bytes(out, sizeof(out), read) == STATUS_CODE_OK) {
+			received.insert(received.end(), out, out + read);
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(received.size(), 30 * sizeof(message));
+	ASSERT_EQ(memcmp(&received[29 * sizeof(message)], message, sizeof(message)), 0);
+	sender.reset();
+	receiver.reset();
+}
+
+TEST_F(HostUARTTest, ReadingWithoutSetupIsRejected) {
+
+	/***********************SETUP***********************/
+
+	UARTPort port(UART_PORT1, make_settings());
+	UARTPort invalid((UARTPortNum) 9, make_settings());
+	uint8_t byte = 0;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(port.read_byte(byte), STATUS_CODE_UNINITIALIZED);
+	ASSERT_EQ(port.transmit(&byte, 1), STATUS_CODE_UNINITIALIZED);
+	ASSERT_EQ(invalid.setup(), STATUS_CODE_INVALID_ARGS);
+}
+
+/***********************************************************************************************************************
+ * File descriptors
+ **********************************************************************************************************************/
+
+TEST_F(HostUARTTest, PipesCarryBothWays) {
+
+	/***********************SETUP***********************/
+
+	int to_port[2];
+	int from_port[2];
+	ASSERT_EQ(pipe(to_port), 0);
+	ASSERT_EQ(pipe(from_port), 0);
+
+	UARTPort port(UART_PORT2, make_settings());
+	port.setup();
+	ASSERT_EQ(host_uart_attach_fds(UART_PORT2, to_port[0], from_port[1]), STATUS_CODE_OK);
+
+	uint8_t out[3];
+	size_t read_len;
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_EQ(write(to_port[1], "abc", 3), 3);
+	StatusCode read_status = port.read_bytes(out, 3, read_len);
+
+	uint8_t reply[] = {'x', 'y'};
+	port.transmit(reply, 2);
+	char from_pipe[2];
+	ssize_t piped = read(from_port[0], from_pipe, 2);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(read_status, STATUS_CODE_OK);
+	ASSERT_EQ(memcmp(out, "abc", 3), 0);
+	ASSERT_EQ(piped, 2);
+	ASSERT_EQ(memcmp(from_pipe, "xy", 2), 0);
+
+	host_devices_reset();
+	close(to_port[0]);
+	close(to_port[1]);
+	close(from_port[0]);
+	close(from_port[1]);
+}
+
+TEST_F(HostUARTTest, PtyCanBeOpenedFromOutside) {
+
+	/***********************SETUP***********************/
+
+	char name[64];
+	UARTPort port(UART_PORT1, make_settings());
+	port.setup();
+	ASSERT_EQ(host_uart_open_pty(UART_PORT1, name, sizeof(name)), STATUS_CODE_OK);
+
+	int outside = open(name, O_RDWR | O_NOCTTY);
+	ASSERT_GE(outside, 0);
+
+	uint8_t out[4];
+	size_t read_len;
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_EQ(write(outside, "\xB5\x62\x01\x07", 4), 4);
+	StatusCode status = port.read_bytes(out, 4, read_len);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(memcmp(out, "\xB5\x62\x01\x07", 4), 0); //raw, nothing was translated on the way
+	close(outside);
+}
@@ -0,0 +1,375 @@
+#include <gtest/gtest.h>
+#include <stddef.h>
+#include <string.h>
+#include "fff.h"
+
+#include "InterchipStats.h"
+#include "Checksum.h"
+#include "FakeClock.hpp"
+
+using ::testing::Test;
+
+static const uint32_t FRAME_PERIOD_US = 5000;
+
+/**
+ * Both ends of the interchip link, run on the host. Each exchange sends a frame from the autopilot to the safety
+ * chip and back, the way the spi transfer does, with hooks to flip bits, drop frames, or hold them up on the way
+ */
+class LinkSimulation {
+ public:
+	LinkSimulation() {
+		fake_clock_set_us(1000000);
+		init_interchip_stats(&autopilot, FRAME_PERIOD_US);
+		init_interchip_stats(&safety, FRAME_PERIOD_US);
+	}
+
+	//what a chip does right before it starts a transfer
+	static void stamp(InterchipStats *stats, Interchip_AtoS_Packet *packet) {
+		packet->sequence = interchip_stats_frame_sent(stats);
+		packet->ack_sequence = interchip_stats_ack_sequence(stats);
+		interchip_stats_get_health(stats, &packet->link);
+		packet->crc = crc16_ccitt(packet, offsetof(Interchip_AtoS_Packet, crc));
+	}
+
+	//what a chip does when a transfer completes
+	static bool receive(InterchipStats *stats, const Interchip_AtoS_Packet *packet) {
+		if (crc16_ccitt(packet, offsetof(Interchip_AtoS_Packet, crc)) != packet->crc) {
+			interchip_stats_crc_failure(stats);
+			return false;
+		}
+		interchip_stats_frame_received(stats, packet->sequence, packet->ack_sequence);
+		return true;
+	}
+
+	/**
+	 * One frame out and one frame back
+	 * @param latency_us Time from the autopilot sending to the safety chip replying, and again on the way back
+	 * @param flip_bit_up If >= 0, bit to corrupt in the autopilot's frame
+	 * @param drop_up Lose the autopilot's frame entirely
+	 */
+	void exchange(uint32_t latency_us = 100, int flip_bit_up = -1, bool drop_up = false) {
+		Interchip_AtoS_Packet up;
+		memset(&up, 0, sizeof(up));
+		stamp(&autopilot, &up);
+
+		if (flip_bit_up >= 0) {
+			((uint8_t *) &up)[flip_bit_up / 8] ^= (uint8_t) (1 << (flip_bit_up % 8));
+		}
+
+		fake_clock_advance_us(latency_us);
+		if (!drop_up) {
+			receive(&safety, &up);
+		}
+
+		//the safety packet has the same layout in front of the crc, so the same helpers work for both
+		Interchip_AtoS_Packet down;
+		memset(&down, 0, sizeof(down));
+		stamp(&safety, &down);
+
+		fake_clock_advance_us(latency_us);
+		last_down_ok = receive(&autopilot, &down);
+		last_down = down;
+	}
+
+	void wait_for_next_frame(uint32_t elapsed_us = 0) {
+		fake_clock_advance_us(FRAME_PERIOD_US - elapsed_us);
+	}
+
+	InterchipStats autopilot;
+	InterchipStats safety;
+	Interchip_AtoS_Packet last_down;
+	bool last_down_ok;
+};
+
+/***********************************************************************************************************************
+ * Checksum
+ **********************************************************************************************************************/
+
+TEST(Checksum, MatchesTheStandardCheckValue) {
+
+	/***********************SETUP***********************/
+
+	const char *check = "123456789";
+
+	/********************STEPTHROUGH********************/
+
+	uint16_t crc = crc16_ccitt(check, 9);
+	uint16_t split = crc16_ccitt_update(crc16_ccitt_update(CRC16_CCITT_INIT, check, 4), check + 4, 5);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(crc, 0x29B1);
+	ASSERT_EQ(split, 0x29B1);
+}
+
+TEST(Checksum, EveryPacketSizeFitsIn16BitWords) {
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(sizeof(Interchip_AtoS_Packet) % 2, 0u);
+	ASSERT_EQ(sizeof(Interchip_StoA_Packet) % 2, 0u);
+	ASSERT_EQ(offsetof(Interchip_AtoS_Packet, crc), sizeof(Interchip_AtoS_Packet) - 2);
+	ASSERT_EQ(offsetof(Interchip_StoA_Packet, crc), sizeof(Interchip_StoA_Packet) - 2);
+}
+
+/***********************************************************************************************************************
+ * Link counters
+ **********************************************************************************************************************/
+
+TEST(InterchipStats, CleanLinkHasNoErrors) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	for (int i = 0; i < 100; i++) {
+		link.exchange(100);
+		link.wait_for_next_frame(200);
+	}
+	get_interchip_stats(&link.autopilot, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(s.frames_sent, 100u);
+	ASSERT_EQ(s.frames_received, 100u);
+	ASSERT_EQ(s.crc_failures, 0u);
+	ASSERT_EQ(s.sequence_gaps, 0u);
+	ASSERT_EQ(s.late_frames, 0u);
+}
+
+TEST(InterchipStats, BitFlipsAreCaughtByTheCrc) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	//flip a different bit every time, covering the header, the payload and the crc itself
+	for (int bit = 0; bit < (int) sizeof(Interchip_AtoS_Packet) * 8; bit++) {
+		link.exchange(100, bit);
+		link.wait_for_next_frame(200);
+	}
+	get_interchip_stats(&link.safety, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(s.crc_failures, sizeof(Interchip_AtoS_Packet) * 8);
+	ASSERT_EQ(s.frames_received, 0u);
+}
+
+TEST(InterchipStats, CorruptFramesShowUpAsGapsOnceTheLinkRecovers) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	link.wait_for_next_frame(200);
+	link.exchange(100, 40);
+	link.wait_for_next_frame(200);
+	link.exchange(100, -1, true);
+	link.wait_for_next_frame(200);
+	link.exchange();
+	get_interchip_stats(&link.safety, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(s.frames_received, 2u);
+	ASSERT_EQ(s.crc_failures, 1u);
+	ASSERT_EQ(s.sequence_gaps, 2u);
+}
+
+TEST(InterchipStats, SequenceNumbersWrapAround) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	link.autopilot.next_sequence = 0xFFFE;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	for (int i = 0; i < 4; i++) {
+		link.exchange();
+		link.wait_for_next_frame(200);
+	}
+	get_interchip_stats(&link.safety, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(link.autopilot.next_sequence, 2);
+	ASSERT_EQ(s.sequence_gaps, 0u);
+	ASSERT_EQ(s.frames_received, 4u);
+}
+
+TEST(InterchipStats, RepeatedFramesAreNotGaps) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	interchip_stats_frame_received(&link.safety, 10, 0);
+	fake_clock_advance_us(FRAME_PERIOD_US);
+	interchip_stats_frame_received(&link.safety, 10, 0);
+	fake_clock_advance_us(FRAME_PERIOD_US);
+	interchip_stats_frame_received(&link.safety, 9, 0);
+	get_interchip_stats(&link.safety, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(s.sequence_gaps, 0u);
+}
+
+TEST(InterchipStats, DelayedFramesAreCountedAsLate) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	link.wait_for_next_frame(200);
+	link.exchange();
+	fake_clock_advance_us(FRAME_PERIOD_US * 2);
+	link.exchange();
+	get_interchip_stats(&link.safety, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(s.late_frames, 1u);
+	ASSERT_EQ(s.sequence_gaps, 0u);
+}
+
+TEST(InterchipStats, RemoteHealthIsCarriedInEveryFrame) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	link.wait_for_next_frame(200);
+	link.exchange(100, 3);
+	link.wait_for_next_frame(200);
+	link.exchange(100, -1, true);
+	link.wait_for_next_frame(200);
+	link.exchange();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(link.last_down_ok);
+	ASSERT_EQ(link.last_down.link.crc_failures, 1);
+	ASSERT_EQ(link.last_down.link.sequence_gaps, 2);
+}
+
+/***********************************************************************************************************************
+ * Round trip time
+ **********************************************************************************************************************/
+
+TEST(InterchipStats, RoundTripTimeIsMeasuredFromTheEchoedSequence) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange(300);
+	link.wait_for_next_frame(600);
+	link.exchange(300);
+	get_interchip_stats(&link.autopilot, &s);
+
+	/**********************ASSERTS**********************/
+
+	//the first reply echoes the sequence the autopilot sent right before it
+	ASSERT_EQ(s.last_rtt_us, 600u);
+	ASSERT_EQ(s.max_rtt_us, 600u);
+	ASSERT_EQ(s.rtt_histogram[1], 1u);
+}
+
+TEST(InterchipStats, HistogramBucketsDoubleInWidth) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+	const uint32_t round_trips[] = {200, 800, 1800, 3800, 7800, 100000};
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	link.wait_for_next_frame(200);
+	for (size_t i = 0; i < sizeof(round_trips) / sizeof(round_trips[0]); i++) {
+		link.exchange(round_trips[i] / 2);
+		link.wait_for_next_frame(round_trips[i] % FRAME_PERIOD_US);
+	}
+	get_interchip_stats(&link.autopilot, &s);
+
+	/**********************ASSERTS**********************/
+
+	//buckets end at 500, 1000, 2000, 4000, 8000... and the last one takes everything past 32000
+	ASSERT_EQ(s.rtt_histogram[0], 1u);
+	ASSERT_EQ(s.rtt_histogram[1], 1u);
+	ASSERT_EQ(s.rtt_histogram[2], 1u);
+	ASSERT_EQ(s.rtt_histogram[3], 1u);
+	ASSERT_EQ(s.rtt_histogram[4], 1u);
+	ASSERT_EQ(s.rtt_histogram[INTERCHIP_RTT_BUCKETS - 1], 1u);
+	ASSERT_EQ(s.max_rtt_us, 100000u);
+}
+
+TEST(InterchipStats, HistogramAgesOutOldSamples) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	InterchipStatsSnapshot s;
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	link.wait_for_next_frame(200);
+	for (int i = 0; i < INTERCHIP_RTT_WINDOW; i++) {
+		link.exchange(100);
+		link.wait_for_next_frame(200);
+	}
+	get_interchip_stats(&link.autopilot, &s);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_LT(s.rtt_histogram[0], (uint32_t) INTERCHIP_RTT_WINDOW);
+	ASSERT_GE(s.rtt_histogram[0], (uint32_t) INTERCHIP_RTT_WINDOW / 2);
+}
+
+TEST(InterchipStats, PrintsEveryCounter) {
+
+	/***********************SETUP***********************/
+
+	LinkSimulation link;
+	char buffer[512];
+
+	/********************STEPTHROUGH********************/
+
+	link.exchange();
+	int len = print_interchip_stats("autopilot", buffer, &link.autopilot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(len, (int) strlen(buffer));
+	ASSERT_NE(strstr(buffer, "autopilot"), nullptr);
+	ASSERT_NE(strstr(buffer, "Sent: 1 Received: 1"), nullptr);
+}
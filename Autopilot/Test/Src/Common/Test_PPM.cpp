@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "fff.h"
+
+#include "PPMDecoder.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t TICK_HZ = 2000000; //0.5us per tick, same as the safety chip
+static const uint32_t TICKS_PER_US = TICK_HZ / 1000000;
+
+/**
+ * Stands in for the capture interrupt. Generates the edge timestamps a receiver would produce for a set of
+ * channel widths, and writes them into the circular buffer the same way the interrupt does
+ */
+class CaptureTrace {
+ public:
+	explicit CaptureTrace(uint16_t start_time = 0) : time(start_time), head(0) {
+		for (uint32_t i = 0; i < PPM_CAPTURE_BUFFER_LEN; i++) buffer[i] = 0;
+	}
+
+	void edge() {
+		buffer[head & (PPM_CAPTURE_BUFFER_LEN - 1)] = time;
+		head++;
+	}
+
+	void wait_us(uint32_t us) {
+		time = (uint16_t) (time + us * TICKS_PER_US);
+	}
+
+	//a frame is an edge at the start of every channel, plus one more to close off the last channel
+	void frame(const vector<uint32_t> &widths_us, uint32_t sync_us = 6000) {
+		for (size_t i = 0; i < widths_us.size(); i++) {
+			edge();
+			wait_us(widths_us[i]);
+		}
+		edge();
+		wait_us(sync_us);
+	}
+
+	uint16_t time;
+	uint32_t head;
+	volatile uint16_t buffer[PPM_CAPTURE_BUFFER_LEN];
+};
+
+static const vector<uint32_t> EIGHT_CHANNELS = {1000, 1100, 1200, 1300, 1500, 1700, 1900, 2000};
+
+/***********************************************************************************************************************
+ * Frame detection
+ **********************************************************************************************************************/
+
+TEST(PPMDecoder, NothingIsReportedBeforeTheFirstSyncGap) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	ASSERT_EQ(decoder.configure(TICK_HZ, 8), STATUS_CODE_OK);
+	CaptureTrace trace;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	//the first frame is joined at an unknown point, so it can't be trusted
+	trace.frame(EIGHT_CHANNELS);
+	uint32_t frames = decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(frames, 0u);
+	ASSERT_EQ(decoder.get_us(0), 0u);
+}
+
+TEST(PPMDecoder, FrameIsDecodedAfterSyncGap) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+	CaptureTrace trace;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	trace.frame(EIGHT_CHANNELS);
+	trace.frame(EIGHT_CHANNELS);
+	trace.edge(); //start of the next frame marks the end of the sync gap
+	uint32_t frames = decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(frames, 1u);
+	ASSERT_EQ(decoder.get_frame_count(), 1u);
+	ASSERT_EQ(decoder.get_error_count(), 0u);
+	for (uint8_t i = 0; i < 8; i++) {
+		ASSERT_EQ(decoder.get_us(i), EIGHT_CHANNELS[i]);
+		ASSERT_EQ(decoder.get_ticks(i), EIGHT_CHANNELS[i] * TICKS_PER_US);
+	}
+}
+
+TEST(PPMDecoder, CounterWrapAroundIsHandled) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+
+	//start just before the 16 bit counter overflows, so edges in the middle of the frame wrap around
+	CaptureTrace trace(0xFFFF - 3000);
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	trace.frame(EIGHT_CHANNELS);
+	trace.frame(EIGHT_CHANNELS);
+	trace.edge();
+	decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(decoder.get_frame_count(), 1u);
+	for (uint8_t i = 0; i < 8; i++) {
+		ASSERT_EQ(decoder.get_us(i), EIGHT_CHANNELS[i]);
+	}
+}
+
+TEST(PPMDecoder, CapturesCanBeProcessedInAnyChunks) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+	CaptureTrace trace;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	//process after every edge, the way it would go if channels are read faster than frames come in
+	uint32_t frames = 0;
+	for (int f = 0; f < 10; f++) {
+		for (size_t i = 0; i < EIGHT_CHANNELS.size(); i++) {
+			trace.edge();
+			trace.wait_us(EIGHT_CHANNELS[i]);
+			frames += decoder.process(trace.buffer, trace.head);
+		}
+		trace.edge();
+		trace.wait_us(8000);
+		frames += decoder.process(trace.buffer, trace.head);
+	}
+	trace.edge();
+	frames += decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(frames, 9u);
+	ASSERT_EQ(decoder.get_overrun_count(), 0u);
+	ASSERT_EQ(decoder.get_us(4), 1500u);
+}
+
+TEST(PPMDecoder, ShortAndLongFramesAreRejected) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+	CaptureTrace trace;
+
+	const vector<uint32_t> short_frame = {1500, 1500, 1500};
+	const vector<uint32_t> long_frame = {1200, 1200, 1200, 1200, 1200, 1200, 1200, 1200, 1200, 1200};
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	trace.frame(EIGHT_CHANNELS);
+	trace.frame(short_frame);
+	trace.edge();
+	uint32_t short_frames = decoder.process(trace.buffer, trace.head);
+
+	CaptureTrace second_trace;
+	PPMDecoder second_decoder;
+	second_decoder.configure(TICK_HZ, 8);
+	second_trace.frame(EIGHT_CHANNELS);
+	second_trace.frame(long_frame);
+	second_trace.frame(EIGHT_CHANNELS);
+	second_trace.edge();
+	uint32_t long_frames = second_decoder.process(second_trace.buffer, second_trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(short_frames, 0u);
+	ASSERT_EQ(decoder.get_error_count(), 1u);
+
+	//the good frame after the bad one still makes it through
+	ASSERT_EQ(long_frames, 1u);
+	ASSERT_EQ(second_decoder.get_error_count(), 1u);
+	ASSERT_EQ(second_decoder.get_us(7), 2000u);
+}
+
+TEST(PPMDecoder, OverrunResyncsOnNextGap) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+	CaptureTrace trace;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	//more frames than the buffer can hold before anyone reads them
+	for (int i = 0; i < 6; i++) {
+		trace.frame(EIGHT_CHANNELS);
+	}
+	trace.edge();
+	decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(decoder.get_overrun_count(), 1u);
+	ASSERT_GE(decoder.get_frame_count(), 1u);
+	ASSERT_EQ(decoder.get_us(2), 1200u);
+}
+
+/***********************************************************************************************************************
+ * Conversions
+ **********************************************************************************************************************/
+
+TEST(PPMDecoder, PercentMatchesLimitsAndDeadzone) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+	decoder.configure(TICK_HZ, 8);
+	decoder.set_limits(0, 1000, 2000, 50);
+	CaptureTrace trace;
+
+	const vector<uint32_t> widths = {1040, 900, 1250, 1500, 1750, 2000, 2200, 1990};
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	trace.frame(widths);
+	trace.frame(widths);
+	trace.edge();
+	decoder.process(trace.buffer, trace.head);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(decoder.get_percent(0), 0); //inside deadzone
+	ASSERT_EQ(decoder.get_percent(1), 0);
+	ASSERT_EQ(decoder.get_percent(2), 25);
+	ASSERT_EQ(decoder.get_percent(3), 50);
+	ASSERT_EQ(decoder.get_percent(4), 75);
+	ASSERT_EQ(decoder.get_percent(5), 100);
+	ASSERT_EQ(decoder.get_percent(6), 100);
+	ASSERT_EQ(decoder.get_percent(7), 99);
+}
+
+TEST(PPMDecoder, InvalidConfigurationIsRejected) {
+
+	/***********************SETUP***********************/
+
+	PPMDecoder decoder;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(decoder.configure(TICK_HZ, 0), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(decoder.configure(TICK_HZ, PPM_DECODER_MAX_CHANNELS + 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(decoder.configure(500000, 8), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(decoder.set_limits(0, 2000, 1000, 0), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(decoder.get_us(PPM_DECODER_MAX_CHANNELS), 0u);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "fff.h"
+
+#include "PWMScale.hpp"
+
+using ::testing::Test;
+
+static const uint32_t SYSTEM_CLOCK_HZ = 48000000; //the safety chip's
+
+typedef struct TimerSettings {
+	uint32_t prescaler;
+	uint32_t period_ticks;
+} TimerSettings;
+
+//picks the timer settings for a period the same way the stm32f0 pwm driver does
+static TimerSettings timer_for_period(uint32_t period_us) {
+	TimerSettings timer = {0, 0};
+
+	do {
+		timer.prescaler++;
+		timer.period_ticks = (uint32_t) round((SYSTEM_CLOCK_HZ / 1000000.0) * period_us / (timer.prescaler + 1));
+	} while (timer.period_ticks > 0xFFFF);
+
+	return timer;
+}
+
+static PWMScale scale_for(const TimerSettings &timer, uint32_t min_us, uint32_t max_us) {
+	PWMScale scale;
+	pwm_get_scale(SYSTEM_CLOCK_HZ / (timer.prescaler + 1), timer.period_ticks, min_us, max_us, scale);
+	return scale;
+}
+
+//what the driver used to work out with divisions on every set
+static uint32_t divided_ticks(const TimerSettings &timer, uint32_t us) {
+	return (us * (SYSTEM_CLOCK_HZ / 1000000UL)) / (timer.prescaler + 1);
+}
+
+static uint32_t divided_us(uint8_t percent, uint32_t min_us, uint32_t max_us) {
+	return (percent * (max_us - min_us)) / 100 + min_us;
+}
+
+static const uint32_t TEST_PERIODS_US[] = {20000, 10000, 4000, 2500, 2000, 1000, 60000};
+
+/***********************************************************************************************************************
+ * Conversions
+ **********************************************************************************************************************/
+
+TEST(PWMScale, TicksMatchTheDivisionWithinATick) {
+
+	/***********************SETUP***********************/
+
+	int worst = 0;
+
+	/********************STEPTHROUGH********************/
+
+	for (uint32_t period_us : TEST_PERIODS_US) {
+		TimerSettings timer = timer_for_period(period_us);
+		PWMScale scale = scale_for(timer, 0, period_us);
+
+		for (uint32_t us = 0; us <= scale.max_us; us++) {
+			int error = abs((int) pwm_us_to_ticks(scale, (uint16_t) us) - (int) divided_ticks(timer, us));
+			if (error > worst) worst = error;
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_LE(worst, 1);
+}
+
+TEST(PWMScale, PercentagesMatchTheDivisionWithinAMicrosecond) {
+
+	/***********************SETUP***********************/
+
+	static const uint32_t LIMITS_US[][2] = {{1000, 2000}, {900, 2100}, {1100, 1900}, {0, 20000}, {1500, 1500}};
+	TimerSettings timer = timer_for_period(20000);
+	int worst = 0;
+
+	/********************STEPTHROUGH********************/
+
+	for (const uint32_t *limits : LIMITS_US) {
+		PWMScale scale = scale_for(timer, limits[0], limits[1]);
+
+		for (uint8_t percent = 0; percent <= 100; percent++) {
+			int error = abs((int) pwm_percent_to_us(scale, percent) - (int) divided_us(percent, limits[0], limits[1]));
+			if (error > worst) worst = error;
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_LE(worst, 1);
+}
+
+TEST(PWMScale, PercentagesHitTheLimitsExactly) {
+
+	/***********************SETUP***********************/
+
+	PWMScale scale = scale_for(timer_for_period(20000), 1000, 2000);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(pwm_percent_to_us(scale, 0), 1000);
+	ASSERT_EQ(pwm_percent_to_us(scale, 50), 1500);
+	ASSERT_EQ(pwm_percent_to_us(scale, 100), 2000);
+	ASSERT_EQ(pwm_percent_to_us(scale, 255), 2000);
+}
+
+/***********************************************************************************************************************
+ * Clamping
+ **********************************************************************************************************************/
+
+TEST(PWMScale, PulsesAreClampedToTheLimits) {
+
+	/***********************SETUP***********************/
+
+	TimerSettings timer = timer_for_period(20000);
+	PWMScale scale = scale_for(timer, 1000, 2000);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(pwm_us_to_ticks(scale, 0), divided_ticks(timer, 1000));
+	ASSERT_EQ(pwm_us_to_ticks(scale, 999), divided_ticks(timer, 1000));
+	ASSERT_EQ(pwm_us_to_ticks(scale, 1500), divided_ticks(timer, 1500));
+	ASSERT_EQ(pwm_us_to_ticks(scale, 2001), divided_ticks(timer, 2000));
+	ASSERT_EQ(pwm_us_to_ticks(scale, 0xFFFF), divided_ticks(timer, 2000));
+}
+
+TEST(PWMScale, LimitsPastThePeriodAreCutDownToIt) {
+
+	/***********************SETUP***********************/
+
+	TimerSettings timer = timer_for_period(2500);
+	PWMScale scale = scale_for(timer, 3000, 5000);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(scale.max_us, 2500);
+	ASSERT_EQ(scale.min_us, 2500);
+	ASSERT_LE(pwm_us_to_ticks(scale, 0xFFFF), timer.period_ticks);
+}
+
+TEST(PWMScale, LongestPeriodDoesNotOverflow) {
+
+	/***********************SETUP***********************/
+
+	//close to all 16 bits of the timer used for the period
+	TimerSettings timer = timer_for_period(60000);
+	PWMScale scale = scale_for(timer, 0, 0xFFFF);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(scale.max_us, 60000);
+	ASSERT_LE(pwm_us_to_ticks(scale, 0xFFFF), timer.period_ticks);
+	ASSERT_GE(pwm_us_to_ticks(scale, 0xFFFF) + 1, timer.period_ticks);
+}
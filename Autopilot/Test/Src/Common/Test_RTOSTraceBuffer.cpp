@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "RTOSTraceBuffer.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint32_t TRACE_LEN = 8;
+static const uint32_t TRACE_RATE = 216000000;
+
+//reads the whole dump out a few bytes at a time, the way the chip sends it in log records
+static vector<uint8_t> read_whole_dump(const RTOSTraceBuffer &trace, size_t piece_len) {
+	vector<uint8_t> out;
+	uint8_t piece[64];
+	size_t len;
+
+	while ((len = trace.read_dump(out.size(), piece, piece_len)) > 0) {
+		out.insert(out.end(), piece, piece + len);
+	}
+	return out;
+}
+
+static uint32_t read_u32(const vector<uint8_t> &data, size_t offset) {
+	uint32_t value;
+	memcpy(&value, &data[offset], 4);
+	return value;
+}
+
+/***********************************************************************************************************************
+ * Recording
+ **********************************************************************************************************************/
+
+TEST(RTOSTraceBuffer, NothingIsRecordedBeforeInit) {
+
+	/***********************SETUP***********************/
+
+	RTOSTraceRecord storage[TRACE_LEN];
+	RTOSTraceBuffer trace;
+
+	/********************STEPTHROUGH********************/
+
+	trace.record(1, RTOS_TRACE_TICK, 0, 1);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(trace.is_recording());
+	ASSERT_EQ(trace.size(), 0u);
+	ASSERT_EQ(trace.init(storage, 6, TRACE_RATE), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(trace.init(storage, TRACE_LEN, TRACE_RATE), STATUS_CODE_OK);
+	ASSERT_TRUE(trace.is_recording());
+}
+
+TEST(RTOSTraceBuffer, FullRingKeepsTheNewestRecords) {
+
+	/***********************SETUP***********************/
+
+	RTOSTraceRecord storage[TRACE_LEN];
+	RTOSTraceBuffer trace;
+	trace.init(storage, TRACE_LEN, TRACE_RATE);
+
+	/********************STEPTHROUGH********************/
+
+	for (uint32_t i = 0; i < TRACE_LEN + 3; i++) {
+		trace.record(i * 100, RTOS_TRACE_TASK_SWITCHED_IN, (uint8_t) i, 0);
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(trace.get_written(), TRACE_LEN + 3);
+	ASSERT_EQ(trace.size(), TRACE_LEN);
+	ASSERT_EQ(trace.get(0).id, 3);
+	ASSERT_EQ(trace.get(0).timestamp, 300u);
+	ASSERT_EQ(trace.get(TRACE_LEN - 1).id, TRACE_LEN + 2);
+}
+
+TEST(RTOSTraceBuffer, PausedTraceIgnoresRecords) {
+
+	/***********************SETUP***********************/
+
+	RTOSTraceRecord storage[TRACE_LEN];
+	RTOSTraceBuffer trace;
+	trace.init(storage, TRACE_LEN, TRACE_RATE);
+
+	/********************STEPTHROUGH********************/
+
+	trace.record(1, RTOS_TRACE_ISR_ENTER, 16, 0);
+	trace.pause();
+	trace.record(2, RTOS_TRACE_ISR_EXIT, 16, 0);
+	uint32_t while_paused = trace.size();
+
+	trace.clear();
+	trace.resume();
+	trace.record(3, RTOS_TRACE_TICK, 0, 7);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(while_paused, 1u);
+	ASSERT_EQ(trace.size(), 1u);
+	ASSERT_EQ(trace.get(0).event, RTOS_TRACE_TICK);
+	ASSERT_EQ(trace.get(0).arg, 7);
+}
+
+/***********************************************************************************************************************
+ * Dumping
+ **********************************************************************************************************************/
+
+TEST(RTOSTraceBuffer, DumpHasHeaderNamesThenRecordsOldestFirst) {
+
+	/***********************SETUP***********************/
+
+	RTOSTraceRecord storage[TRACE_LEN];
+	RTOSTraceBuffer trace;
+	trace.init(storage, TRACE_LEN, TRACE_RATE);
+
+	trace.set_name(RTOS_TRACE_NAME_TASK, 1, "defaultTask");
+	trace.set_name(RTOS_TRACE_NAME_QUEUE, 2, "a queue name that is too long");
+	trace.set_name(RTOS_TRACE_NAME_TASK, 1, "renamed");
+
+	trace.record(0x11223344, RTOS_TRACE_TASK_SWITCHED_IN, 1, 0);
+	trace.record(0x11223400, RTOS_TRACE_QUEUE_SEND, 2, 0xABCD);
+
+	/********************STEPTHROUGH********************/
+
+	trace.pause();
+	vector<uint8_t> dump = read_whole_dump(trace, 5); //a piece length that lines up with nothing
+
+	/**********************ASSERTS**********************/
+
+	size_t names_at = RTOS_TRACE_HEADER_LEN;
+	size_t records_at = names_at + 2 * RTOS_TRACE_NAME_ENTRY_LEN;
+
+	ASSERT_EQ(dump.size(), trace.dump_len());
+	ASSERT_EQ(dump.size(), records_at + 2 * RTOS_TRACE_RECORD_LEN);
+
+	ASSERT_EQ(memcmp(&dump[0], "RTRC", 4), 0);
+	ASSERT_EQ(dump[4], RTOS_TRACE_DUMP_VERSION);
+	ASSERT_EQ(dump[5], 2);
+	ASSERT_EQ(read_u32(dump, 8), 2u);
+	ASSERT_EQ(read_u32(dump, 12), TRACE_RATE);
+
+	ASSERT_EQ(dump[names_at], RTOS_TRACE_NAME_TASK);
+	ASSERT_EQ(dump[names_at + 1], 1);
+	ASSERT_STREQ((const char *) &dump[names_at + 2], "renamed");
+	ASSERT_EQ(dump[names_at + RTOS_TRACE_NAME_ENTRY_LEN], RTOS_TRACE_NAME_QUEUE);
+	ASSERT_EQ(memcmp(&dump[names_at + RTOS_TRACE_NAME_ENTRY_LEN + 2], "a queue name tha", RTOS_TRACE_NAME_LEN), 0);
+
+	const uint8_t second_record[] = {0x00, 0x34, 0x22, 0x11, RTOS_TRACE_QUEUE_SEND, 2, 0xCD, 0xAB};
+	ASSERT_EQ(read_u32(dump, records_at), 0x11223344u);
+	ASSERT_EQ(memcmp(&dump[records_at + RTOS_TRACE_RECORD_LEN], second_record, sizeof(second_record)), 0);
+}
+
+TEST(RTOSTraceBuffer, NameTableFillsUp) {
+
+	/***********************SETUP***********************/
+
+	RTOSTraceBuffer trace;
+
+	/**********************ASSERTS**********************/
+
+	for (uint8_t i = 0; i < RTOS_TRACE_MAX_NAMES; i++) {
+		ASSERT_TRUE(trace.set_name(RTOS_TRACE_NAME_ISR, i, "irq"));
+	}
+	ASSERT_FALSE(trace.set_name(RTOS_TRACE_NAME_ISR, RTOS_TRACE_MAX_NAMES, "irq"));
+	ASSERT_TRUE(trace.set_name(RTOS_TRACE_NAME_ISR, 0, "replaced")); //existing names can still be changed
+}
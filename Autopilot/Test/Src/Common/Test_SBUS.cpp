@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "fff.h"
+
+#include "SBUSFrame.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+//frames recorded off of a receiver bound to a transmitter with every stick centered
+static const uint8_t CENTERED_FRAME[SBUS_FRAME_LEN] = {
+	0x0F, 0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0xE0,
+	0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x00, 0x00
+};
+
+//channels 172, 1811, 992, 0, 2047, 1000, 1500, 200, 300, 400, 500, 600, 700, 800, 900, 1024 with
+//the frame lost and failsafe flags set
+static const uint8_t MIXED_FRAME[SBUS_FRAME_LEN] = {
+	0x0F, 0xAC, 0x98, 0x38, 0xF8, 0x00, 0xF0, 0x7F, 0xF4, 0x71, 0x17, 0x19, 0x2C,
+	0x81, 0x0C, 0x7D, 0xB0, 0xC4, 0x2B, 0x90, 0x11, 0x0E, 0x80, 0x0C, 0x00
+};
+
+static const uint16_t MIXED_CHANNELS[SBUS_NUM_CHANNELS] = {
+	172, 1811, 992, 0, 2047, 1000, 1500, 200, 300, 400, 500, 600, 700, 800, 900, 1024
+};
+
+/***********************************************************************************************************************
+ * Frame decoding
+ **********************************************************************************************************************/
+
+TEST(SBUSDecode, CenteredFrameDecodesAllChannels) {
+
+	/***********************SETUP***********************/
+
+	SBUSFrame frame;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = sbus_decode_frame(CENTERED_FRAME, frame);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	for (int i = 0; i < SBUS_NUM_CHANNELS; i++) {
+		ASSERT_EQ(frame.channels[i], 992);
+	}
+	ASSERT_FALSE(frame.failsafe);
+	ASSERT_FALSE(frame.frame_lost);
+}
+
+TEST(SBUSDecode, EveryChannelAndFlagIsDecoded) {
+
+	/***********************SETUP***********************/
+
+	SBUSFrame frame;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = sbus_decode_frame(MIXED_FRAME, frame);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	for (int i = 0; i < SBUS_NUM_CHANNELS; i++) {
+		ASSERT_EQ(frame.channels[i], MIXED_CHANNELS[i]) << "channel " << i + 1;
+	}
+	ASSERT_FALSE(frame.channel_17);
+	ASSERT_FALSE(frame.channel_18);
+	ASSERT_TRUE(frame.frame_lost);
+	ASSERT_TRUE(frame.failsafe);
+}
+
+TEST(SBUSDecode, BadHeaderOrFooterIsRejected) {
+
+	/***********************SETUP***********************/
+
+	uint8_t bad_header[SBUS_FRAME_LEN];
+	uint8_t bad_footer[SBUS_FRAME_LEN];
+	memcpy(bad_header, CENTERED_FRAME, SBUS_FRAME_LEN);
+	memcpy(bad_footer, CENTERED_FRAME, SBUS_FRAME_LEN);
+	bad_header[0] = 0x0E;
+	bad_footer[SBUS_FRAME_LEN - 1] = 0xFF;
+
+	SBUSFrame frame;
+	frame.channels[0] = 1234;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	StatusCode header_status = sbus_decode_frame(bad_header, frame);
+	StatusCode footer_status = sbus_decode_frame(bad_footer, frame);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(header_status, STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(footer_status, STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(frame.channels[0], 1234);
+}
+
+TEST(SBUSDecode, SBUS2FooterIsAccepted) {
+
+	/***********************SETUP***********************/
+
+	uint8_t data[SBUS_FRAME_LEN];
+	memcpy(data, CENTERED_FRAME, SBUS_FRAME_LEN);
+	data[SBUS_FRAME_LEN - 1] = 0x24;
+
+	SBUSFrame frame;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(sbus_decode_frame(data, frame), STATUS_CODE_OK);
+}
+
+TEST(SBUSDecode, ConversionsMatchReceiverEndpoints) {
+
+	/***********************SETUP***********************/
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(sbus_raw_to_us(0), 1000u);
+	ASSERT_EQ(sbus_raw_to_us(SBUS_RAW_MIN), 1000u);
+	ASSERT_EQ(sbus_raw_to_us(992), 1500u);
+	ASSERT_EQ(sbus_raw_to_us(SBUS_RAW_MAX), 2000u);
+	ASSERT_EQ(sbus_raw_to_us(2047), 2000u);
+	for (uint16_t raw = SBUS_RAW_MIN; raw <= SBUS_RAW_MAX; raw++) {
+		double exact = 1000 + (raw - SBUS_RAW_MIN) * 1000.0 / (SBUS_RAW_MAX - SBUS_RAW_MIN);
+		ASSERT_NEAR(sbus_raw_to_us(raw), exact, 0.52) << raw;
+	}
+
+	ASSERT_EQ(sbus_raw_to_percent(0), 0);
+	ASSERT_EQ(sbus_raw_to_percent(SBUS_RAW_MIN), 0);
+	ASSERT_EQ(sbus_raw_to_percent(992), 50);
+	ASSERT_EQ(sbus_raw_to_percent(SBUS_RAW_MAX), 100);
+	ASSERT_EQ(sbus_raw_to_percent(2047), 100);
+}
+
+/***********************************************************************************************************************
+ * Frame alignment
+ **********************************************************************************************************************/
+
+static bool feed(SBUSFrameSync &sync, const uint8_t *bytes, size_t len, size_t chunk) {
+	bool got_frame = false;
+
+	while (len > 0) {
+		size_t n = len < chunk ? len : chunk;
+		if (n > sync.space()) n = sync.space();
+
+		memcpy(sync.buffer(), bytes, n);
+		got_frame = sync.commit(n) || got_frame;
+
+		bytes += n;
+		len -= n;
+	}
+	return got_frame;
+}
+
+TEST(SBUSFrameSync, WholeFrameIsReadyImmediately) {
+
+	/***********************SETUP***********************/
+
+	SBUSFrameSync sync;
+	SBUSFrame frame;
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	bool ready = feed(sync, MIXED_FRAME, SBUS_FRAME_LEN, SBUS_FRAME_LEN);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(ready);
+	ASSERT_EQ(sbus_decode_frame(sync.frame(), frame), STATUS_CODE_OK);
+	ASSERT_EQ(frame.channels[1], 1811);
+	ASSERT_EQ(sync.dropped_bytes(), 0u);
+}
+
+TEST(SBUSFrameSync, ResyncsWhenJoiningMidFrame) {
+
+	/***********************SETUP***********************/
+
+	SBUSFrameSync sync;
+	SBUSFrame frame;
+
+	//tail end of a frame (that contains no header bytes), followed by a full frame
+	const size_t tail_len = 3;
+	uint8_t stream[tail_len + SBUS_FRAME_LEN];
+	memcpy(stream, &CENTERED_FRAME[SBUS_FRAME_LEN - tail_len], tail_len);
+	memcpy(&stream[tail_len], MIXED_FRAME, SBUS_FRAME_LEN);
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	bool ready = feed(sync, stream, sizeof(stream), 7);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(ready);
+	ASSERT_EQ(sbus_decode_frame(sync.frame(), frame), STATUS_CODE_OK);
+	for (int i = 0; i < SBUS_NUM_CHANNELS; i++) {
+		ASSERT_EQ(frame.channels[i], MIXED_CHANNELS[i]);
+	}
+	ASSERT_EQ(sync.dropped_bytes(), tail_len);
+}
+
+TEST(SBUSFrameSync, FalseHeaderInsideDataIsSkipped) {
+
+	/***********************SETUP***********************/
+
+	SBUSFrameSync sync;
+
+	//starting on a 0x0F inside channel data gives a misaligned 25 byte window, which has to be thrown out
+	uint8_t stream[3 + SBUS_FRAME_LEN];
+	stream[0] = SBUS_HEADER;
+	stream[1] = 0x55;
+	stream[2] = 0xAA;
+	memcpy(&stream[3], CENTERED_FRAME, SBUS_FRAME_LEN);
+
+	/********************DEPENDENCIES*******************/
+	/********************STEPTHROUGH********************/
+
+	bool ready = feed(sync, stream, sizeof(stream), 1);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(ready);
+	ASSERT_TRUE(sbus_is_frame_aligned(sync.frame()));
+	ASSERT_EQ(memcmp(sync.frame(), CENTERED_FRAME, SBUS_FRAME_LEN), 0);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "fff.h"
+
+#include "Snapshot.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+//every field the same, so a copy that mixed two publishes shows up
+typedef struct SnapshotTestValue {
+	uint32_t fields[16];
+} SnapshotTestValue;
+
+static SnapshotTestValue value_of(uint32_t n) {
+	SnapshotTestValue value;
+	for (uint32_t &field : value.fields) field = n;
+	return value;
+}
+
+/***********************************************************************************************************************
+ * Snapshot
+ **********************************************************************************************************************/
+
+TEST(Snapshot, NothingUntilTheFirstPublish) {
+
+	/***********************SETUP***********************/
+
+	Snapshot<SnapshotTestValue> snapshot;
+	SnapshotTestValue value = value_of(7);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(snapshot.read(value), 0u);
+	ASSERT_EQ(value.fields[0], 7u);
+
+	snapshot.publish(value_of(1));
+	snapshot.publish(value_of(2));
+	ASSERT_EQ(snapshot.read(value), 2u);
+	ASSERT_EQ(value.fields[15], 2u);
+	ASSERT_EQ(snapshot.count(), 2u);
+}
+
+TEST(Snapshot, ReadsAreNeverTorn) {
+
+	/***********************SETUP***********************/
+
+	static const uint32_t PUBLISHES = 200000;
+	Snapshot<SnapshotTestValue> snapshot;
+	atomic<bool> done(false);
+
+	/********************STEPTHROUGH********************/
+
+	thread writer([&]() {
+		for (uint32_t n = 1; n <= PUBLISHES; n++) {
+			snapshot.publish(value_of(n));
+			if (n % 64 == 0) this_thread::yield();
+		}
+		done = true;
+	});
+
+	uint32_t torn = 0;
+	uint32_t out_of_order = 0;
+	uint32_t last = 0;
+	while (!done) {
+		SnapshotTestValue value;
+		uint32_t count = snapshot.read(value);
+		if (count == 0) continue;
+
+		for (uint32_t field : value.fields) {
+			if (field != count) torn++;
+		}
+		if (count < last) out_of_order++;
+		last = count;
+	}
+	writer.join();
+
+	/**********************ASSERTS**********************/
+
+	SnapshotTestValue value;
+	ASSERT_EQ(torn, 0u);
+	ASSERT_EQ(out_of_order, 0u);
+	ASSERT_EQ(snapshot.read(value), PUBLISHES);
+	ASSERT_EQ(value.fields[0], PUBLISHES);
+}
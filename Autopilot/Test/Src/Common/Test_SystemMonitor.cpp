@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "fff.h"
+
+#include "SystemMonitor.h"
+
+using ::testing::Test;
+
+static const SystemMonitorThresholds TEST_THRESHOLDS = {32, 1024, 900};
+static const uint32_t PLENTY_OF_HEAP = 20000;
+
+static SystemMonitorTaskSample make_task(uint8_t number, const char *name, uint32_t run_time, uint8_t is_idle = 0) {
+	SystemMonitorTaskSample task = {number, name, 200, run_time, is_idle};
+	return task;
+}
+
+/***********************************************************************************************************************
+ * Cpu usage
+ **********************************************************************************************************************/
+
+TEST(SystemMonitor, FirstSampleHasNoCpuUsage) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample tasks[] = {make_task(1, "IDLE", 5000, 1), make_task(2, "Attitude", 5000)};
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t raised = system_monitor_update(&monitor, tasks, 2, 10000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(raised, 0);
+	ASSERT_EQ(snapshot.task_count, 2);
+	ASSERT_EQ(snapshot.cpu_load_permille, 0);
+	ASSERT_EQ(snapshot.tasks[0].cpu_permille, 0);
+	ASSERT_EQ(snapshot.tasks[1].cpu_permille, 0);
+}
+
+TEST(SystemMonitor, CpuUsageCoversOnlyTheLastPeriod) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample first[] = {make_task(1, "IDLE", 9000, 1), make_task(2, "Attitude", 1000)};
+	system_monitor_update(&monitor, first, 2, 10000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+
+	/********************STEPTHROUGH********************/
+
+	//busy since the first sample, even though idle has still run the most overall
+	SystemMonitorTaskSample second[] = {make_task(1, "IDLE", 9250, 1), make_task(2, "Attitude", 1750)};
+	system_monitor_update(&monitor, second, 2, 11000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(snapshot.tasks[0].cpu_permille, 250);
+	ASSERT_EQ(snapshot.tasks[1].cpu_permille, 750);
+	ASSERT_EQ(snapshot.cpu_load_permille, 750);
+}
+
+TEST(SystemMonitor, RunTimeCountersCanWrap) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample first[] = {make_task(1, "IDLE", 0xFFFFF000, 1), make_task(2, "Log", 0x100)};
+	system_monitor_update(&monitor, first, 2, 0xFFFFFF00, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+
+	/********************STEPTHROUGH********************/
+
+	SystemMonitorTaskSample second[] = {make_task(1, "IDLE", 0x00000000, 1), make_task(2, "Log", 0x1100)};
+	system_monitor_update(&monitor, second, 2, 0x00001F00, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(snapshot.tasks[0].cpu_permille, 500);
+	ASSERT_EQ(snapshot.tasks[1].cpu_permille, 500);
+	ASSERT_EQ(snapshot.cpu_load_permille, 500);
+}
+
+TEST(SystemMonitor, NewTaskCountsFromZero) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample first[] = {make_task(1, "IDLE", 1000, 1)};
+	system_monitor_update(&monitor, first, 1, 1000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+
+	/********************STEPTHROUGH********************/
+
+	SystemMonitorTaskSample second[] = {make_task(1, "IDLE", 1900, 1), make_task(5, "Telem", 100)};
+	system_monitor_update(&monitor, second, 2, 2000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(snapshot.tasks[1].number, 5);
+	ASSERT_EQ(snapshot.tasks[1].cpu_permille, 100);
+	ASSERT_EQ(snapshot.cpu_load_permille, 100);
+}
+
+/***********************************************************************************************************************
+ * Alarms
+ **********************************************************************************************************************/
+
+TEST(SystemMonitor, AlarmsAreOnlyReturnedWhenFirstRaised) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample tasks[] = {make_task(1, "IDLE", 0, 1), make_task(2, "Attitude", 0)};
+	tasks[1].stack_free_words = 10;
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t first = system_monitor_update(&monitor, tasks, 2, 0, PLENTY_OF_HEAP, 500);
+	uint8_t still = system_monitor_update(&monitor, tasks, 2, 0, PLENTY_OF_HEAP, 500);
+
+	tasks[1].stack_free_words = 100;
+	uint8_t cleared = system_monitor_update(&monitor, tasks, 2, 0, PLENTY_OF_HEAP, 500);
+
+	tasks[1].stack_free_words = 10;
+	uint8_t again = system_monitor_update(&monitor, tasks, 2, 0, PLENTY_OF_HEAP, 500);
+
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(first, SYSTEM_MONITOR_ALARM_STACK | SYSTEM_MONITOR_ALARM_HEAP);
+	ASSERT_EQ(still, 0);
+	ASSERT_EQ(cleared, 0);
+	ASSERT_EQ(again, SYSTEM_MONITOR_ALARM_STACK);
+	ASSERT_EQ(snapshot.alarms, SYSTEM_MONITOR_ALARM_STACK | SYSTEM_MONITOR_ALARM_HEAP);
+}
+
+TEST(SystemMonitor, HighCpuLoadRaisesAnAlarm) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample first[] = {make_task(1, "IDLE", 0, 1), make_task(2, "Attitude", 0)};
+	system_monitor_update(&monitor, first, 2, 0, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+
+	/********************STEPTHROUGH********************/
+
+	SystemMonitorTaskSample second[] = {make_task(1, "IDLE", 50, 1), make_task(2, "Attitude", 950)};
+	uint8_t raised = system_monitor_update(&monitor, second, 2, 1000, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(raised, SYSTEM_MONITOR_ALARM_CPU);
+}
+
+TEST(SystemMonitor, TooManyTasksAreLeftOut) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample tasks[SYSTEM_MONITOR_MAX_TASKS + 2];
+	for (uint8_t i = 0; i < SYSTEM_MONITOR_MAX_TASKS + 2; i++) {
+		tasks[i] = make_task(i, "Task", 0);
+	}
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t raised = system_monitor_update(&monitor, tasks, SYSTEM_MONITOR_MAX_TASKS + 2, 0, PLENTY_OF_HEAP,
+										   PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(raised, SYSTEM_MONITOR_ALARM_TASKS);
+	ASSERT_EQ(snapshot.task_count, SYSTEM_MONITOR_MAX_TASKS);
+}
+
+TEST(SystemMonitor, LongNamesAreCut) {
+
+	/***********************SETUP***********************/
+
+	SystemMonitor monitor;
+	init_system_monitor(&monitor, &TEST_THRESHOLDS);
+	SystemMonitorTaskSample tasks[] = {make_task(1, "AttitudeManager", 0), make_task(2, "Log", 0)};
+
+	/********************STEPTHROUGH********************/
+
+	system_monitor_update(&monitor, tasks, 2, 0, PLENTY_OF_HEAP, PLENTY_OF_HEAP);
+	SystemMonitorSnapshot snapshot;
+	get_system_monitor_snapshot(&monitor, &snapshot);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(memcmp(snapshot.tasks[0].name, "Attitude", SYSTEM_MONITOR_NAME_LEN), 0);
+	ASSERT_STREQ(snapshot.tasks[1].name, "Log");
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "fff.h"
+
+#include "Timebase.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const uint64_t HALF_WRAP = 1ULL << 31;
+
+/***********************************************************************************************************************
+ * Extending
+ **********************************************************************************************************************/
+
+TEST(Timebase, ReadingsBeforeTheFirstWrapAreUnchanged) {
+
+	/***********************SETUP***********************/
+
+	TimebaseExtender extender;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(extender.read([]() { return 0u; }), 0u);
+	ASSERT_EQ(extender.read([]() { return 123456u; }), 123456u);
+	ASSERT_EQ(extender.read([]() { return 0xFFFFFFFFu; }), 0xFFFFFFFFu);
+}
+
+TEST(Timebase, EveryWrapAddsToTheUpperHalf) {
+
+	/***********************SETUP***********************/
+
+	TimebaseExtender extender;
+	uint64_t actual = 5;
+	vector<uint64_t> times;
+
+	/********************STEPTHROUGH********************/
+
+	//just under a half wrap each time, the slowest the time can be read without losing track of it
+	for (int i = 0; i < 20; i++) {
+		times.push_back(extender.read([&]() { return (uint32_t) actual; }));
+		actual += HALF_WRAP - 1;
+	}
+
+	/**********************ASSERTS**********************/
+
+	for (size_t i = 0; i < times.size(); i++) {
+		ASSERT_EQ(times[i], 5 + i * (HALF_WRAP - 1));
+	}
+}
+
+TEST(Timebase, ReaderThatFallsBehindStillGetsItsOwnTime) {
+
+	/***********************SETUP***********************/
+
+	TimebaseExtender extender;
+	extender.read([]() { return 0xF0000000u; });
+	uint64_t interrupting = 0;
+
+	/********************STEPTHROUGH********************/
+
+	//an interrupt lands between the first reader loading the half wrap count and reading the counter, and moves the
+	//count on past the wrap before the first reader gets its (older) counter value
+	uint64_t interrupted = extender.read([&]() {
+		interrupting = extender.read([]() { return 0x00000010u; });
+		return 0xFFFFFFF0u;
+	});
+	uint64_t after = extender.read([]() { return 0x00000020u; });
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(interrupted, 0xFFFFFFF0u);
+	ASSERT_EQ(interrupting, 0x100000010u);
+	ASSERT_EQ(after, 0x100000020u);
+}
+
+/***********************************************************************************************************************
+ * Stress
+ **********************************************************************************************************************/
+
+TEST(Timebase, ConcurrentReadersSeeEveryWrapAndNeverGoBack) {
+
+	/***********************SETUP***********************/
+
+	static const int THREADS = 4;
+	static const int ROUNDS = 320;
+	static const int READS_PER_ROUND = 256;
+
+	TimebaseExtender extender;
+	atomic<uint64_t> actual(0xC0000000ULL);
+	atomic<int> finished(0);
+	atomic<bool> failed(false);
+
+	//readers advance the counter themselves, by a step that varies per thread, so reads interleave any which way. They
+	//meet up every round, which keeps a reader that's preempted mid read from being left behind by a whole half wrap
+	auto reader = [&](int number) {
+		uint64_t previous = 0;
+		uint64_t step = 40000 + number * 7919;
+
+		for (int round = 0; round < ROUNDS; round++) {
+			for (int i = 0; i < READS_PER_ROUND; i++) {
+				uint64_t counted = 0;
+				uint64_t time = extender.read([&]() {
+					counted = actual.fetch_add(step) + step;
+					return (uint32_t) counted;
+				});
+
+				if (time != counted || time <= previous) failed = true;
+				previous = time;
+			}
+
+			finished++;
+			while (finished < (round + 1) * THREADS) this_thread::yield();
+		}
+	};
+
+	/********************STEPTHROUGH********************/
+
+	vector<thread> threads;
+	for (int i = 0; i < THREADS; i++) {
+		threads.push_back(thread(reader, i));
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(failed);
+	ASSERT_GT(actual.load(), 3 * (1ULL << 32)); //went through a few wraps
+}
@@ -0,0 +1,325 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "fff.h"
+
+#include "DubinsPlanner.hpp"
+#include "SimulatedAircraft.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const GeoPosition HOME = {434726560, -805423210, 326789};
+
+static Waypoint waypoint_at(float north, float east, float up, float airspeed) {
+	LocalFrame frame;
+	frame.set_reference(HOME);
+	NEDPosition ned = {north, east, -up};
+
+	Waypoint waypoint;
+	waypoint.position = frame.from_ned(ned);
+	waypoint.airspeed = airspeed;
+	return waypoint;
+}
+
+static float wrapped(float angle) {
+	while (angle > (float) M_PI) angle -= 2.0f * (float) M_PI;
+	while (angle < -(float) M_PI) angle += 2.0f * (float) M_PI;
+	return angle;
+}
+
+//where a segment finishes, and which way it's pointing there
+static DubinsPose segment_end(const PathSegment &segment) {
+	DubinsPose end;
+	if (segment.kind == PATH_LINE) {
+		end.north = segment.start_north + segment.length * segment.direction_north;
+		end.east = segment.start_east + segment.length * segment.direction_east;
+		end.course = segment.course;
+	} else {
+		float bearing = segment.start_bearing + segment.turn * segment.length / segment.radius;
+		end.north = segment.centre_north + segment.radius * cosf(bearing);
+		end.east = segment.centre_east + segment.radius * sinf(bearing);
+		end.course = wrapped(bearing + segment.turn * 0.5f * (float) M_PI);
+	}
+	return end;
+}
+
+//a survey pattern with a hairpin, a reversal, a short hop and a climb
+static const int SURVEY_LEN = 7;
+static Waypoint survey[SURVEY_LEN];
+
+class DubinsPlannerTest : public Test {
+ protected:
+	void SetUp() override {
+		survey[0] = waypoint_at(0, 0, 50, 20);
+		survey[1] = waypoint_at(800, 0, 100, 20);
+		survey[2] = waypoint_at(800, 100, 100, 20);
+		survey[3] = waypoint_at(0, 100, 100, 18);
+		survey[4] = waypoint_at(400, 100, 100, 18);
+		survey[5] = waypoint_at(420, 130, 100, 18);
+		survey[6] = waypoint_at(-200, 400, 120, 20);
+	}
+};
+
+/***********************************************************************************************************************
+ * Dubins paths
+ **********************************************************************************************************************/
+
+TEST(DubinsPath, StraightAheadIsOneLine) {
+
+	/***********************SETUP***********************/
+
+	DubinsPose from = {0, 0, 0};
+	DubinsPose to = {500, 0, 0};
+	PathSegment segments[3];
+	float length;
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t count = dubins_path(from, to, 50, segments, length);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(count, 1);
+	ASSERT_EQ(segments[0].kind, PATH_LINE);
+	ASSERT_NEAR(length, 500.0f, 0.01f);
+	ASSERT_NEAR(segments[0].course, 0.0f, 1e-4f);
+}
+
+TEST(DubinsPath, TurningBackIsOneHalfCircle) {
+
+	/***********************SETUP***********************/
+
+	DubinsPose from = {0, 0, 0};
+	DubinsPose to = {0, 100, (float) M_PI};
+	PathSegment segments[3];
+	float length;
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t count = dubins_path(from, to, 50, segments, length);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(count, 1);
+	ASSERT_EQ(segments[0].kind, PATH_ARC);
+	ASSERT_EQ(segments[0].turn, 1);
+	ASSERT_NEAR(length, M_PI * 50, 0.01f);
+	ASSERT_NEAR(segments[0].centre_east, 50.0f, 0.01f);
+}
+
+TEST(DubinsPath, CloseTogetherIsThreeTurns) {
+
+	/***********************SETUP***********************/
+
+	//turning back onto a point just ahead, too close to fit a straight between two turns
+	DubinsPose from = {0, 0, 0};
+	DubinsPose to = {20, 0, (float) M_PI};
+	PathSegment segments[3];
+	float length;
+
+	/********************STEPTHROUGH********************/
+
+	uint8_t count = dubins_path(from, to, 50, segments, length);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(count, 3);
+	ASSERT_EQ(segments[0].kind, PATH_ARC);
+	ASSERT_EQ(segments[1].kind, PATH_ARC);
+	ASSERT_EQ(segments[2].kind, PATH_ARC);
+	ASSERT_EQ(segments[1].turn, -segments[0].turn);
+
+	DubinsPose end = segment_end(segments[2]);
+	ASSERT_NEAR(end.north, 20.0f, 0.01f);
+	ASSERT_NEAR(end.east, 0.0f, 0.01f);
+	ASSERT_NEAR(wrapped(end.course - (float) M_PI), 0.0f, 1e-3f);
+}
+
+/***********************************************************************************************************************
+ * Planning
+ **********************************************************************************************************************/
+
+TEST_F(DubinsPlannerTest, PlansALegPerStep) {
+
+	/***********************SETUP***********************/
+
+	DubinsPlanner planner;
+	int steps = 0;
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_EQ(planner.start_mission(HOME, survey, SURVEY_LEN), STATUS_CODE_OK);
+	while (planner.step() == PLANNER_WORKING) steps++;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(steps + 1, SURVEY_LEN - 1);
+	ASSERT_EQ(planner.state(), PLANNER_DONE);
+	ASSERT_GE(planner.plan_length(), SURVEY_LEN - 1);
+	ASSERT_LE(planner.plan_length(), 3 * (SURVEY_LEN - 1));
+
+	//starting again part way through drops the old plan
+	planner.start_mission(HOME, survey, SURVEY_LEN);
+	planner.step();
+	planner.start_mission(HOME, survey, 3);
+	ASSERT_EQ(planner.step(), PLANNER_WORKING);
+	ASSERT_EQ(planner.step(), PLANNER_DONE);
+	ASSERT_EQ(planner.step(), PLANNER_DONE);
+}
+
+TEST_F(DubinsPlannerTest, PlanIsContinuous) {
+
+	/***********************SETUP***********************/
+
+	DubinsPlanner planner;
+	planner.start_mission(HOME, survey, SURVEY_LEN);
+	while (planner.step() == PLANNER_WORKING) {}
+
+	LocalFrame frame;
+	frame.set_reference(HOME);
+
+	/**********************ASSERTS**********************/
+
+	const PathSegment *plan = planner.plan();
+	uint8_t length = planner.plan_length();
+	uint8_t waypoints_passed = 1;
+
+	for (uint8_t i = 0; i + 1 < length; i++) {
+		DubinsPose end = segment_end(plan[i]);
+		const PathSegment &next = plan[i + 1];
+
+		ASSERT_NEAR(end.north, next.start_north, 0.05f) << (int) i;
+		ASSERT_NEAR(end.east, next.start_east, 0.05f) << (int) i;
+		ASSERT_NEAR(wrapped(end.course - next.course), 0.0f, 2e-3f) << (int) i;
+		ASSERT_NEAR(plan[i].start_down + plan[i].length * plan[i].climb, next.start_down, 0.01f) << (int) i;
+
+		//never tighter than the leg's airspeed allows
+		if (plan[i].kind == PATH_ARC) {
+			ASSERT_GE(plan[i].radius, planner_turn_radius(plan[i].airspeed) - 0.01f);
+		}
+
+		NEDPosition waypoint = frame.to_ned(survey[waypoints_passed].position);
+		if (fabsf(end.north - waypoint.north) < 0.05f && fabsf(end.east - waypoint.east) < 0.05f) {
+			waypoints_passed++;
+		}
+	}
+
+	//every waypoint is on the path, the last one at the very end
+	DubinsPose last = segment_end(plan[length - 1]);
+	NEDPosition goal = frame.to_ned(survey[SURVEY_LEN - 1].position);
+	ASSERT_EQ(waypoints_passed, SURVEY_LEN - 1);
+	ASSERT_NEAR(last.north, goal.north, 0.05f);
+	ASSERT_NEAR(last.east, goal.east, 0.05f);
+}
+
+TEST_F(DubinsPlannerTest, BadMissionsFail) {
+
+	/***********************SETUP***********************/
+
+	DubinsPlanner planner;
+	Waypoint repeated[3] = {survey[0], survey[1], survey[1]};
+	Waypoint stopped[2] = {survey[0], survey[1]};
+	stopped[1].airspeed = 0;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(planner.start_mission(HOME, survey, 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(planner.start_mission(HOME, stopped, 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(planner.state(), PLANNER_IDLE);
+
+	ASSERT_EQ(planner.start_mission(HOME, repeated, 3), STATUS_CODE_OK);
+	ASSERT_EQ(planner.step(), PLANNER_FAILED);
+	ASSERT_EQ(planner.step(), PLANNER_FAILED);
+}
+
+/***********************************************************************************************************************
+ * Flying the plan
+ **********************************************************************************************************************/
+
+TEST_F(DubinsPlannerTest, FliesThePlan) {
+
+	/***********************SETUP***********************/
+
+	DubinsPlanner planner;
+	planner.start_mission(HOME, survey, SURVEY_LEN);
+	while (planner.step() == PLANNER_WORKING) {}
+
+	PathManager manager;
+	ASSERT_EQ(manager.load_plan(planner.home(), planner.plan(), planner.plan_length()), STATUS_CODE_OK);
+
+	SimulatedAircraft aircraft(0, 0, -50, 0, 20);
+	PMCommands commands = {0, 0, 0, 0};
+	const float dt = 0.02f;
+
+	float worst_cross_track = 0;
+	int ticks = 0;
+
+	/********************STEPTHROUGH********************/
+
+	while (!manager.mission_complete() && ticks < 50 * 60 * 10) {
+		manager.update(aircraft.state(), commands);
+		aircraft.step(commands, dt);
+		ticks++;
+
+		float cross_track = fabsf(manager.cross_track_error());
+		if (cross_track > worst_cross_track) worst_cross_track = cross_track;
+	}
+
+	/**********************ASSERTS**********************/
+
+	//the turns are all flyable, so it stays on the path the whole way, hairpins included
+	ASSERT_TRUE(manager.mission_complete());
+	ASSERT_EQ(manager.current_segment(), planner.plan_length() - 1);
+	ASSERT_LT(worst_cross_track, 4.0f);
+}
+
+TEST(DubinsReturn, EndsLoiteringRoundHome) {
+
+	/***********************SETUP***********************/
+
+	LocalFrame frame;
+	frame.set_reference(HOME);
+	NEDPosition away = {1500, -800, -150};
+	GeoPosition position = frame.from_ned(away);
+
+	//heading further away
+	float course = atan2f(-800.0f, 1500.0f);
+
+	DubinsPlanner planner;
+	PathManager manager;
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_EQ(planner.start_return(position, course, HOME, 18, 80), STATUS_CODE_OK);
+	ASSERT_EQ(planner.step(), PLANNER_DONE);
+	ASSERT_EQ(manager.load_plan(planner.home(), planner.plan(), planner.plan_length()), STATUS_CODE_OK);
+
+	SimulatedAircraft aircraft(away.north, away.east, away.down, course, 18);
+	PMCommands commands = {0, 0, 0, 0};
+	const float dt = 0.02f;
+
+	int ticks = 0;
+	while (!manager.mission_complete() && ticks < 50 * 60 * 10) {
+		manager.update(aircraft.state(), commands);
+		aircraft.step(commands, dt);
+		ticks++;
+	}
+	ASSERT_TRUE(manager.mission_complete());
+
+	//a couple of laps to settle down to the loiter height
+	float worst_radius_error = 0;
+	for (int i = 0; i < 50 * 120; i++) {
+		manager.update(aircraft.state(), commands);
+		aircraft.step(commands, dt);
+
+		float radius = sqrtf(aircraft.position.north * aircraft.position.north
+			+ aircraft.position.east * aircraft.position.east);
+		worst_radius_error = fmaxf(worst_radius_error, fabsf(radius - 80.0f));
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(planner.plan()[planner.plan_length() - 1].kind, PATH_LOITER);
+	ASSERT_LT(worst_radius_error, 3.0f);
+	ASSERT_NEAR(aircraft.position.down, 0.0f, 2.0f);
+}
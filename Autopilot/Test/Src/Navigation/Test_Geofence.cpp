@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "fff.h"
+
+#include "Geofence.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const GeoPosition HOME = {434726560, -805423210, 326789};
+
+static GeoPosition at(float north, float east) {
+	LocalFrame frame;
+	frame.set_reference(HOME);
+	NEDPosition ned = {north, east, 0};
+	return frame.from_ned(ned);
+}
+
+static NEDPosition ned_at(float north, float east, float up) {
+	NEDPosition ned = {north, east, -up};
+	return ned;
+}
+
+//the sort of boundary a field or a range has: wobbly and concave, with a lot of vertices
+static vector<GeoPosition> boundary(int count) {
+	vector<GeoPosition> vertices;
+	for (int i = 0; i < count; i++) {
+		float angle = 2.0f * (float) M_PI * i / count;
+		float radius = 1500 + 300 * sinf(5 * angle) + 100 * sinf(23 * angle) + 30 * sinf(97 * angle);
+		vertices.push_back(at(radius * cosf(angle), radius * sinf(angle)));
+	}
+	return vertices;
+}
+
+//walks every edge, the way it would be done without the index
+static float naive_depth(const vector<NEDPosition> &polygon, float north, float east) {
+	bool inside = false;
+	float nearest = FLT_MAX;
+
+	for (size_t i = 0; i < polygon.size(); i++) {
+		const NEDPosition &a = polygon[i];
+		const NEDPosition &b = polygon[(i + 1) % polygon.size()];
+
+		if ((a.north > north) != (b.north > north)) {
+			float crossing = a.east + (north - a.north) * (b.east - a.east) / (b.north - a.north);
+			if (crossing > east) inside = !inside;
+		}
+
+		float edge_north = b.north - a.north;
+		float edge_east = b.east - a.east;
+		float t = ((north - a.north) * edge_north + (east - a.east) * edge_east)
+			/ (edge_north * edge_north + edge_east * edge_east);
+		t = t < 0 ? 0 : (t > 1 ? 1 : t);
+		float offset_north = a.north + t * edge_north - north;
+		float offset_east = a.east + t * edge_east - east;
+		nearest = fminf(nearest, offset_north * offset_north + offset_east * offset_east);
+	}
+
+	return inside ? sqrtf(nearest) : -sqrtf(nearest);
+}
+
+/***********************************************************************************************************************
+ * Zones
+ **********************************************************************************************************************/
+
+TEST(Geofence, NoZonesAllowsAnywhere) {
+
+	/***********************SETUP***********************/
+
+	Geofence fence;
+	fence.clear(HOME);
+
+	/********************STEPTHROUGH********************/
+
+	GeofenceStatus status = fence.check(ned_at(12345, -6789, 4000));
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(status.breached);
+	ASSERT_EQ(status.margin, FLT_MAX);
+}
+
+TEST(Geofence, InclusionSquare) {
+
+	/***********************SETUP***********************/
+
+	Geofence fence;
+	fence.clear(HOME);
+	GeoPosition square[4] = {at(-500, -500), at(-500, 500), at(500, 500), at(500, -500)};
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = fence.add_polygon(GEOFENCE_INCLUSION, square, 4);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+
+	GeofenceStatus centre = fence.check(ned_at(0, 0, 100));
+	//far from the edges the distance is a bound that's never more than the real one
+	ASSERT_FALSE(centre.breached);
+	ASSERT_GT(centre.margin, 0.0f);
+	ASSERT_LE(centre.margin, 500.05f);
+	ASSERT_EQ(centre.zone, 0);
+
+	GeofenceStatus near_edge = fence.check(ned_at(480, 100, 100));
+	ASSERT_NEAR(near_edge.margin, 20.0f, 0.05f);
+
+	GeofenceStatus outside = fence.check(ned_at(0, 530, 100));
+	ASSERT_TRUE(outside.breached);
+	ASSERT_NEAR(outside.margin, -30.0f, 0.05f);
+
+	//and the same off the geodetic position
+	ASSERT_TRUE(fence.check(at(0, 530)).breached);
+	ASSERT_FALSE(fence.check(at(0, 470)).breached);
+}
+
+TEST(Geofence, ExclusionsAndAltitudeLimits) {
+
+	/***********************SETUP***********************/
+
+	Geofence fence;
+	fence.clear(HOME);
+	fence.add_circle(GEOFENCE_INCLUSION, HOME, 1000);
+	GeoPosition tower[4] = {at(100, 100), at(100, 200), at(200, 200), at(200, 100)};
+	fence.add_polygon(GEOFENCE_EXCLUSION, tower, 4);
+	fence.add_circle(GEOFENCE_EXCLUSION, at(-300, 0), 50);
+	fence.set_altitude_limits(HOME.altitude_mm + 30000, HOME.altitude_mm + 120000);
+
+	/**********************ASSERTS**********************/
+
+	GeofenceStatus clear_of_everything = fence.check(ned_at(0, -500, 80));
+	ASSERT_FALSE(clear_of_everything.breached);
+	ASSERT_NEAR(clear_of_everything.margin, 40.0f, 0.05f); //the ceiling
+	ASSERT_EQ(clear_of_everything.zone, GEOFENCE_ALTITUDE);
+
+	GeofenceStatus in_tower = fence.check(ned_at(150, 190, 80));
+	ASSERT_TRUE(in_tower.breached);
+	ASSERT_NEAR(in_tower.margin, -10.0f, 0.05f);
+	ASSERT_EQ(in_tower.zone, 1);
+
+	GeofenceStatus by_tower = fence.check(ned_at(150, 215, 80));
+	ASSERT_NEAR(by_tower.margin, 15.0f, 0.05f);
+
+	GeofenceStatus in_circle = fence.check(ned_at(-300, 20, 80));
+	ASSERT_TRUE(in_circle.breached);
+	ASSERT_EQ(in_circle.zone, 2);
+
+	ASSERT_TRUE(fence.check(ned_at(0, -500, 20)).breached);
+	ASSERT_TRUE(fence.check(ned_at(0, -500, 125)).breached);
+	ASSERT_TRUE(fence.check(ned_at(0, -1100, 80)).breached);
+}
+
+TEST(Geofence, IndexedPolygonMatchesWalkingEveryEdge) {
+
+	/***********************SETUP***********************/
+
+	Geofence fence;
+	fence.clear(HOME);
+	vector<GeoPosition> vertices = boundary(300);
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), vertices.size()), STATUS_CODE_OK);
+
+	vector<NEDPosition> polygon;
+	for (const GeoPosition &vertex : vertices) polygon.push_back(fence.frame().to_ned(vertex));
+
+	srand(45);
+
+	/**********************ASSERTS**********************/
+
+	for (int i = 0; i < 20000; i++) {
+		float north = (rand() / (float) RAND_MAX - 0.5f) * 4400;
+		float east = (rand() / (float) RAND_MAX - 0.5f) * 4400;
+
+		float expected = naive_depth(polygon, north, east);
+		GeofenceStatus status = fence.check(ned_at(north, east, 0));
+
+		//the side is always right, and close to the boundary so is the distance. Further away it's never overstated
+		if (fabsf(expected) < 0.01f) continue;
+		ASSERT_EQ(status.breached, expected < 0) << north << ", " << east;
+		ASSERT_LE(fabsf(status.margin), fabsf(expected) + 0.01f) << north << ", " << east;
+		if (fabsf(expected) < 30.0f) {
+			ASSERT_NEAR(status.margin, expected, 0.01f) << north << ", " << east;
+		}
+	}
+}
+
+TEST(Geofence, FullFenceIsRejected) {
+
+	/***********************SETUP***********************/
+
+	Geofence fence;
+	fence.clear(HOME);
+	vector<GeoPosition> vertices = boundary(GEOFENCE_MAX_VERTICES / 2);
+	GeoPosition line[3] = {at(0, 0), at(100, 0), at(200, 0)};
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, line, 3), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(fence.add_circle(GEOFENCE_EXCLUSION, HOME, 0), STATUS_CODE_INVALID_ARGS);
+
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), vertices.size()), STATUS_CODE_OK);
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), vertices.size()), STATUS_CODE_OK);
+	ASSERT_EQ(fence.add_polygon(GEOFENCE_INCLUSION, vertices.data(), 3), STATUS_CODE_RESOURCE_EXHAUSTED);
+	ASSERT_EQ(fence.zone_count(), 2);
+}
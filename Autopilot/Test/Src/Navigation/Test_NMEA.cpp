@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "fff.h"
+
+#include "NMEA.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const char *CLASSIC_GGA = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char *CLASSIC_RMC = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+static const char *CLASSIC_VTG = "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n";
+
+//what a u-blox M8 puts out, in the southern and western hemispheres below sea level
+static const char *UBLOX_GGA = "$GNGGA,235959.95,3357.19731,S,15112.55012,W,2,12,0.67,-12.345,M,-28.1,M,,0000*71\r\n";
+static const char *UBLOX_RMC_NO_FIX = "$GNRMC,000001.00,V,,,,,,,010120,,,N*60\r\n";
+static const char *UBLOX_VTG_STATIONARY = "$GNVTG,,T,,M,0.012,N,0.022,K,A*3E\r\n";
+static const char *UBLOX_GSV = "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n";
+
+static int feed_string(NMEAParser &parser, const char *string) {
+	int completed = 0;
+	for (size_t i = 0; i < strlen(string); i++) {
+		if (parser.feed((uint8_t) string[i])) completed++;
+	}
+	return completed;
+}
+
+/***********************************************************************************************************************
+ * Conversion
+ **********************************************************************************************************************/
+
+TEST(NMEAParser, DecodesGGA) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, CLASSIC_GGA);
+	const NMEASentence &sentence = parser.sentence();
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(sentence.type, NMEA_SENTENCE_GGA);
+	ASSERT_EQ(sentence.talker[0], 'G');
+	ASSERT_EQ(sentence.talker[1], 'P');
+	ASSERT_EQ(sentence.gga.time_ms, (12u * 3600 + 35 * 60 + 19) * 1000);
+	ASSERT_EQ(sentence.gga.latitude, 481173000); //48 + 7.038 / 60 degrees
+	ASSERT_EQ(sentence.gga.longitude, 115166667); //11 + 31 / 60 degrees, rounded
+	ASSERT_EQ(sentence.gga.fix_quality, 1);
+	ASSERT_EQ(sentence.gga.satellites, 8);
+	ASSERT_EQ(sentence.gga.hdop, 90);
+	ASSERT_EQ(sentence.gga.altitude_mm, 545400);
+	ASSERT_EQ(sentence.gga.geoid_separation_mm, 46900);
+}
+
+TEST(NMEAParser, SouthWestAndNegativeValuesAreSigned) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, UBLOX_GGA);
+	const NMEAGGA &gga = parser.sentence().gga;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(parser.sentence().talker[1], 'N');
+	ASSERT_EQ(gga.time_ms, 86399950u);
+	ASSERT_EQ(gga.latitude, -339532885);
+	ASSERT_EQ(gga.longitude, -1512091687);
+	ASSERT_EQ(gga.fix_quality, 2);
+	ASSERT_EQ(gga.satellites, 12);
+	ASSERT_EQ(gga.hdop, 67);
+	ASSERT_EQ(gga.altitude_mm, -12345);
+	ASSERT_EQ(gga.geoid_separation_mm, -28100);
+}
+
+TEST(NMEAParser, DecodesRMCAndVTG) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+	NMEARMC rmc;
+	NMEAVTG vtg;
+
+	/********************STEPTHROUGH********************/
+
+	feed_string(parser, CLASSIC_RMC);
+	rmc = parser.sentence().rmc;
+	feed_string(parser, CLASSIC_VTG);
+	vtg = parser.sentence().vtg;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(rmc.valid);
+	ASSERT_EQ(rmc.latitude, 481173000);
+	ASSERT_EQ(rmc.longitude, 115166667);
+	ASSERT_EQ(rmc.speed_mm_s, 11524u); //22.4 knots
+	ASSERT_TRUE(rmc.course_valid);
+	ASSERT_EQ(rmc.course, 8440);
+	ASSERT_EQ(rmc.day, 23);
+	ASSERT_EQ(rmc.month, 3);
+	ASSERT_EQ(rmc.mode, 0); //from before NMEA 2.3
+
+	ASSERT_EQ(parser.sentence().type, NMEA_SENTENCE_VTG);
+	ASSERT_TRUE(vtg.course_valid);
+	ASSERT_EQ(vtg.course, 5470);
+	ASSERT_EQ(vtg.speed_mm_s, 2829u); //5.5 knots
+}
+
+TEST(NMEAParser, EmptyFieldsBeforeAFix) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+	NMEARMC rmc;
+	NMEAVTG vtg;
+
+	/********************STEPTHROUGH********************/
+
+	feed_string(parser, UBLOX_RMC_NO_FIX);
+	rmc = parser.sentence().rmc;
+	feed_string(parser, UBLOX_VTG_STATIONARY);
+	vtg = parser.sentence().vtg;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FALSE(rmc.valid);
+	ASSERT_EQ(rmc.time_ms, 1000u);
+	ASSERT_EQ(rmc.latitude, 0);
+	ASSERT_FALSE(rmc.course_valid);
+	ASSERT_EQ(rmc.day, 1);
+	ASSERT_EQ(rmc.month, 1);
+	ASSERT_EQ(rmc.year, 2020);
+	ASSERT_EQ(rmc.mode, 'N');
+
+	ASSERT_FALSE(vtg.course_valid);
+	ASSERT_EQ(vtg.speed_mm_s, 6u);
+	ASSERT_EQ(vtg.mode, 'A');
+}
+
+/***********************************************************************************************************************
+ * Framing
+ **********************************************************************************************************************/
+
+TEST(NMEAParser, BadChecksumIsRejected) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+	string corrupted = CLASSIC_GGA;
+	corrupted[20] = '9'; //one digit of the latitude flipped on the wire
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, corrupted.c_str());
+	completed += feed_string(parser, CLASSIC_VTG);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(parser.checksum_errors(), 1u);
+	ASSERT_EQ(parser.sentence().type, NMEA_SENTENCE_VTG);
+}
+
+TEST(NMEAParser, CutOffSentenceDoesntSwallowTheNextOne) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+	string cut_off = string(CLASSIC_GGA).substr(0, 30);
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, cut_off.c_str());
+	completed += feed_string(parser, CLASSIC_RMC);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(parser.malformed_sentences(), 1u);
+	ASSERT_EQ(parser.sentence().type, NMEA_SENTENCE_RMC);
+}
+
+TEST(NMEAParser, MissingAndOversizedFieldsAreMalformed) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, "$GPGGA,123519,4807.038,N*27\r\n");
+	completed += feed_string(parser,
+		"$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,5454444444444.4,M,46.9,M,,*47\r\n");
+	completed += feed_string(parser, "$GPGGA,123519,4807.038,N,01131.000\n,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 0);
+	ASSERT_EQ(parser.malformed_sentences(), 3u);
+	ASSERT_EQ(parser.checksum_errors(), 0u);
+}
+
+TEST(NMEAParser, OtherSentencesAreSkipped) {
+
+	/***********************SETUP***********************/
+
+	NMEAParser parser;
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_string(parser, UBLOX_GSV);
+	completed += feed_string(parser, "$PUBX,00,001043.00*29\r\n");
+	completed += feed_string(parser, UBLOX_GGA);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(parser.ignored_sentences(), 2u);
+	ASSERT_EQ(parser.malformed_sentences(), 0u);
+}
+
+TEST(NMEAParser, ParsesInPlaceOutOfARing) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[64];
+	ByteRing ring;
+	ring.init(storage, sizeof(storage));
+	NMEAParser parser;
+
+	const char *stream[] = {CLASSIC_GGA, UBLOX_GSV, CLASSIC_RMC, CLASSIC_VTG, UBLOX_GGA};
+	NMEASentenceType types[5];
+	int completed = 0;
+
+	/********************STEPTHROUGH********************/
+
+	//pushed in small chunks so the sentences wrap around the end of the ring
+	for (const char *sentence : stream) {
+		size_t pushed = 0;
+		size_t len = strlen(sentence);
+
+		while (pushed < len) {
+			size_t chunk = len - pushed < 13 ? len - pushed : 13;
+			pushed += ring.push((const uint8_t *) sentence + pushed, chunk);
+
+			while (parser.feed(ring)) {
+				types[completed++] = parser.sentence().type;
+			}
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 4);
+	ASSERT_EQ(types[0], NMEA_SENTENCE_GGA);
+	ASSERT_EQ(types[1], NMEA_SENTENCE_RMC);
+	ASSERT_EQ(types[2], NMEA_SENTENCE_VTG);
+	ASSERT_EQ(types[3], NMEA_SENTENCE_GGA);
+	ASSERT_EQ(parser.sentence().gga.latitude, -339532885);
+	ASSERT_TRUE(ring.empty());
+}
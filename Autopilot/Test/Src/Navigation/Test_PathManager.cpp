@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "fff.h"
+
+#include "PathManager.hpp"
+#include "SimulatedAircraft.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static const GeoPosition HOME = {434726560, -805423210, 326789};
+
+static Waypoint waypoint_at(float north, float east, float up, float airspeed) {
+	LocalFrame frame;
+	frame.set_reference(HOME);
+	NEDPosition ned = {north, east, -up};
+
+	Waypoint waypoint;
+	waypoint.position = frame.from_ned(ned);
+	waypoint.airspeed = airspeed;
+	return waypoint;
+}
+
+//a 1km box at 100m, starting and ending at home, climbing on the first leg
+static const int BOX_LEN = 5;
+static Waypoint box[BOX_LEN];
+
+class PathManagerTest : public Test {
+ protected:
+	void SetUp() override {
+		box[0] = waypoint_at(0, 0, 50, 20);
+		box[1] = waypoint_at(1000, 0, 100, 20);
+		box[2] = waypoint_at(1000, 1000, 100, 20);
+		box[3] = waypoint_at(0, 1000, 100, 18);
+		box[4] = waypoint_at(0, 0, 100, 18);
+	}
+};
+
+static PathState state_at(float north, float east, float up, float velocity_north, float velocity_east) {
+	PathState state;
+	state.position.north = north;
+	state.position.east = east;
+	state.position.down = -up;
+	state.velocity_north = velocity_north;
+	state.velocity_east = velocity_east;
+	return state;
+}
+
+/***********************************************************************************************************************
+ * Missions
+ **********************************************************************************************************************/
+
+TEST_F(PathManagerTest, BadMissionsAreRejected) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	Waypoint repeated[3] = {box[0], box[1], box[1]};
+	Waypoint too_many[PATH_MAX_WAYPOINTS + 1];
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(manager.load_mission(HOME, box, 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(manager.load_mission(HOME, nullptr, 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(manager.load_mission(HOME, too_many, PATH_MAX_WAYPOINTS + 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(manager.load_mission(HOME, repeated, 3), STATUS_CODE_INVALID_ARGS);
+	ASSERT_FALSE(manager.has_mission());
+}
+
+TEST_F(PathManagerTest, BadPlansAreRejected) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	PathSegment loiter;
+	loiter.kind = PATH_LOITER;
+	loiter.radius = 80;
+	loiter.turn = 1;
+
+	PathSegment line = loiter;
+	line.kind = PATH_LINE;
+	line.length = 100;
+
+	PathSegment backwards = loiter;
+	backwards.kind = PATH_ARC;
+	backwards.length = 50;
+	backwards.turn = 0;
+
+	PathSegment loiter_first[2] = {loiter, line};
+	PathSegment bad_arc[2] = {backwards, loiter};
+	PathSegment good[2] = {line, loiter};
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(manager.load_plan(HOME, good, 0), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(manager.load_plan(HOME, loiter_first, 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(manager.load_plan(HOME, bad_arc, 2), STATUS_CODE_INVALID_ARGS);
+	ASSERT_FALSE(manager.has_mission());
+
+	ASSERT_EQ(manager.load_plan(HOME, good, 2), STATUS_CODE_OK);
+	ASSERT_EQ(manager.segment_count(), 2);
+	ASSERT_FALSE(manager.mission_complete());
+}
+
+TEST_F(PathManagerTest, SegmentsArePrecomputed) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = manager.load_mission(HOME, box, BOX_LEN);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(manager.segment_count(), BOX_LEN - 1);
+
+	const PathSegment &first = manager.segment(0);
+	ASSERT_NEAR(first.length, 1000.0f, 0.05f);
+	ASSERT_NEAR(first.direction_north, 1.0f, 1e-4f);
+	ASSERT_NEAR(first.direction_east, 0.0f, 1e-4f);
+	ASSERT_NEAR(first.start_down, -50.0f, 0.01f);
+	ASSERT_NEAR(first.climb, -0.05f, 1e-4f);
+	ASSERT_NEAR(first.course, 0.0f, 1e-4f);
+
+	const PathSegment &second = manager.segment(1);
+	ASSERT_NEAR(second.course, M_PI / 2, 1e-4f);
+	ASSERT_NEAR(second.climb, 0.0f, 1e-4f);
+
+	const PathSegment &last = manager.segment(BOX_LEN - 2);
+	ASSERT_NEAR(last.course, -M_PI / 2, 1e-4f);
+	ASSERT_EQ(last.airspeed, 18.0f);
+
+	//a right angle turns in one radius at full roll
+	float radius = 20.0f * 20.0f / (9.80665f * tanf(PATH_MAX_ROLL_RAD));
+	ASSERT_NEAR(first.switch_distance, radius, 0.5f);
+	ASSERT_EQ(last.switch_distance, 0.0f);
+}
+
+/***********************************************************************************************************************
+ * Guidance
+ **********************************************************************************************************************/
+
+TEST_F(PathManagerTest, SteersBackOntoTheTrack) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	manager.load_mission(HOME, box, BOX_LEN);
+	PMCommands on_track;
+	PMCommands right_of_track;
+	PMCommands left_of_track;
+	PMCommands heading_away;
+
+	/********************STEPTHROUGH********************/
+
+	manager.update(state_at(200, 0, 60, 20, 0), on_track);
+	manager.update(state_at(200, 50, 60, 20, 0), right_of_track);
+	float right_error = manager.cross_track_error();
+	manager.update(state_at(200, -50, 60, 20, 0), left_of_track);
+	manager.update(state_at(200, 0, 60, 0, 20), heading_away);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_NEAR(on_track.roll, 0.0f, 1e-3f);
+	ASSERT_NEAR(on_track.yaw, 0.0f, 1e-3f);
+	ASSERT_NEAR(on_track.airspeed, 20.0f, 1e-3f);
+
+	ASSERT_NEAR(right_error, 50.0f, 0.01f);
+	ASSERT_LT(right_of_track.roll, -0.1f);
+	ASSERT_LT(right_of_track.yaw, 0.0f);
+	ASSERT_GT(left_of_track.roll, 0.1f);
+	ASSERT_GT(left_of_track.yaw, 0.0f);
+
+	ASSERT_FLOAT_EQ(heading_away.roll, -PATH_MAX_ROLL_RAD);
+}
+
+TEST_F(PathManagerTest, PitchHoldsTheClimb) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	manager.load_mission(HOME, box, BOX_LEN);
+	PMCommands on_track;
+	PMCommands low;
+
+	/********************STEPTHROUGH********************/
+
+	manager.update(state_at(200, 0, 60, 20, 0), on_track);
+	manager.update(state_at(200, 0, 55, 20, 0), low);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_NEAR(on_track.pitch, atanf(0.05f), 1e-3f);
+	ASSERT_NEAR(low.pitch, atanf(0.05f) + 5 * PATH_ALTITUDE_GAIN, 1e-3f);
+}
+
+TEST_F(PathManagerTest, CommandsAreLeftAloneWithoutAMission) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	PMCommands commands = {0.1f, 0.2f, 0.3f, 15.0f};
+
+	/********************STEPTHROUGH********************/
+
+	manager.update(state_at(200, 0, 60, 20, 0), commands);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(commands.roll, 0.1f);
+	ASSERT_EQ(commands.airspeed, 15.0f);
+}
+
+TEST_F(PathManagerTest, FliesTheBox) {
+
+	/***********************SETUP***********************/
+
+	PathManager manager;
+	manager.load_mission(HOME, box, BOX_LEN);
+
+	//starting off to the side of the first leg, pointed the wrong way
+	SimulatedAircraft aircraft(0, -100, -50, -M_PI / 2, 18);
+	PMCommands commands = {0, 0, 0, 0};
+	const float dt = 0.02f;
+
+	float worst_cross_track = 0;
+	float worst_height_error = 0;
+	int ticks = 0;
+
+	/********************STEPTHROUGH********************/
+
+	while (!manager.mission_complete() && ticks < 50 * 60 * 10) {
+		manager.update(aircraft.state(), commands);
+		aircraft.step(commands, dt);
+		ticks++;
+
+		//once settled onto the first leg, the middle of every leg should be tracked closely
+		const PathSegment &segment = manager.segment(manager.current_segment());
+		float along = (aircraft.position.north - segment.start_north) * segment.direction_north
+			+ (aircraft.position.east - segment.start_east) * segment.direction_east;
+		bool mid_leg = along > 300 && along < segment.length - 150;
+
+		if (manager.current_segment() > 0 && mid_leg) {
+			float cross_track = fabsf(manager.cross_track_error());
+			float height_error = fabsf(aircraft.position.down - (segment.start_down + along * segment.climb));
+			if (cross_track > worst_cross_track) worst_cross_track = cross_track;
+			if (height_error > worst_height_error) worst_height_error = height_error;
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(manager.mission_complete());
+	ASSERT_EQ(manager.current_segment(), BOX_LEN - 2);
+	ASSERT_LT(ticks * dt, 4 * 1000 / 18.0f * 1.3f);
+	ASSERT_LT(worst_cross_track, 2.0f);
+	ASSERT_LT(worst_height_error, 2.0f);
+	ASSERT_NEAR(aircraft.airspeed, 18.0f, 0.5f);
+}
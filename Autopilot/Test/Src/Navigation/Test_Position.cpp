@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "fff.h"
+
+#include "Position.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+//exact wgs84 geodetic -> ecef -> ned, in double precision
+static void reference_ecef(const GeoPosition &position, double ecef[3]) {
+	const double a = 6378137.0;
+	const double f = 1.0 / 298.257223563;
+	const double e2 = f * (2.0 - f);
+
+	double latitude = position.latitude * M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+	double longitude = position.longitude * M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+	double height = position.altitude_mm * 1e-3;
+	double prime_vertical = a / sqrt(1.0 - e2 * sin(latitude) * sin(latitude));
+
+	ecef[0] = (prime_vertical + height) * cos(latitude) * cos(longitude);
+	ecef[1] = (prime_vertical + height) * cos(latitude) * sin(longitude);
+	ecef[2] = (prime_vertical * (1.0 - e2) + height) * sin(latitude);
+}
+
+static void reference_ned(const GeoPosition &origin, const GeoPosition &position, double ned[3]) {
+	double from[3];
+	double to[3];
+	reference_ecef(origin, from);
+	reference_ecef(position, to);
+	double x = to[0] - from[0];
+	double y = to[1] - from[1];
+	double z = to[2] - from[2];
+
+	double latitude = origin.latitude * M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+	double longitude = origin.longitude * M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+
+	ned[0] = -sin(latitude) * cos(longitude) * x - sin(latitude) * sin(longitude) * y + cos(latitude) * z;
+	ned[1] = -sin(longitude) * x + cos(longitude) * y;
+	ned[2] = -cos(latitude) * cos(longitude) * x - cos(latitude) * sin(longitude) * y - sin(latitude) * z;
+}
+
+//points on a circle of the given radius around origin, climbing as they go round
+static GeoPosition around(const GeoPosition &origin, double radius, int step) {
+	double bearing = step * 10.0 * M_PI / 180.0;
+	double latitude = origin.latitude * M_PI / 180.0 / GEO_UNITS_PER_DEGREE;
+	double units_per_metre = GEO_UNITS_PER_DEGREE / 111000.0;
+
+	GeoPosition position;
+	position.latitude = origin.latitude + (int32_t) (radius * cos(bearing) * units_per_metre);
+	position.longitude = origin.longitude + (int32_t) (radius * sin(bearing) * units_per_metre / cos(latitude));
+	position.altitude_mm = origin.altitude_mm + step * 3000;
+	return position;
+}
+
+static double worst_error(const GeoPosition &origin, double radius) {
+	LocalFrame frame;
+	frame.set_reference(origin);
+	double worst = 0;
+
+	for (int step = 0; step < 36; step++) {
+		GeoPosition position = around(origin, radius, step);
+		double expected[3];
+		reference_ned(origin, position, expected);
+		NEDPosition ned = frame.to_ned(position);
+
+		double error = sqrt(pow(expected[0] - ned.north, 2) + pow(expected[1] - ned.east, 2)
+			+ pow(expected[2] - ned.down, 2));
+		if (error > worst) worst = error;
+	}
+
+	return worst;
+}
+
+static const GeoPosition WATERLOO = {434726560, -805423210, 326789};
+
+/***********************************************************************************************************************
+ * Conversions
+ **********************************************************************************************************************/
+
+TEST(LocalFrame, MatchesTheExactTangentPlane) {
+
+	/***********************SETUP***********************/
+
+	GeoPosition origins[] = {
+		WATERLOO,
+		{0, 0, 0},
+		{-700000000, 1701234567, 1500000}, //south, high up
+		{620000000, -1500000000, 12000}
+	};
+
+	/**********************ASSERTS**********************/
+
+	for (const GeoPosition &origin : origins) {
+		ASSERT_LT(worst_error(origin, 1000.0), 0.002);
+		ASSERT_LT(worst_error(origin, 5000.0), 0.05);
+		ASSERT_LT(worst_error(origin, 20000.0), 0.5);
+	}
+}
+
+TEST(LocalFrame, ReferenceIsTheOrigin) {
+
+	/***********************SETUP***********************/
+
+	LocalFrame frame;
+	frame.set_reference(WATERLOO);
+
+	/********************STEPTHROUGH********************/
+
+	NEDPosition ned = frame.to_ned(WATERLOO);
+	GeoPosition above = WATERLOO;
+	above.altitude_mm += 120000;
+	NEDPosition up = frame.to_ned(above);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_FLOAT_EQ(ned.north, 0.0f);
+	ASSERT_FLOAT_EQ(ned.east, 0.0f);
+	ASSERT_FLOAT_EQ(ned.down, 0.0f);
+	ASSERT_FLOAT_EQ(up.down, -120.0f);
+}
+
+TEST(LocalFrame, WorksAcrossTheAntimeridian) {
+
+	/***********************SETUP***********************/
+
+	LocalFrame frame;
+	GeoPosition origin = {-170000000, 1799990000, 0}; //just west of it, off fiji
+	frame.set_reference(origin);
+
+	GeoPosition east = {-170000000, -1799990000, 0};
+
+	/********************STEPTHROUGH********************/
+
+	NEDPosition ned = frame.to_ned(east);
+	GeoPosition back = frame.from_ned(ned);
+
+	/**********************ASSERTS**********************/
+
+	//0.002 degrees of longitude
+	ASSERT_NEAR(ned.east, 213.0, 1.0);
+	ASSERT_NEAR(ned.north, 0.0, 0.01);
+	ASSERT_EQ(back.longitude, east.longitude);
+}
+
+TEST(LocalFrame, FromNEDUndoesToNED) {
+
+	/***********************SETUP***********************/
+
+	LocalFrame frame;
+	frame.set_reference(WATERLOO);
+
+	/**********************ASSERTS**********************/
+
+	for (int step = 0; step < 36; step++) {
+		GeoPosition position = around(WATERLOO, 10000.0, step);
+		GeoPosition back = frame.from_ned(frame.to_ned(position));
+
+		//float rounding of the metres is a couple of units out at 10km
+		ASSERT_NEAR(back.latitude, position.latitude, 2);
+		ASSERT_NEAR(back.longitude, position.longitude, 2);
+		ASSERT_NEAR(back.altitude_mm, position.altitude_mm, 2);
+	}
+}
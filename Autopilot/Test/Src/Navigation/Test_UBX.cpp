@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "UBX.hpp"
+#include "UBXCaptures.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+static int feed_bytes(UBXParser &parser, const uint8_t *data, size_t len) {
+	int completed = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (parser.feed(data[i])) completed++;
+	}
+	return completed;
+}
+
+/***********************************************************************************************************************
+ * Framing
+ **********************************************************************************************************************/
+
+TEST(UBXParser, CompletesFramesByteAtATime) {
+
+	/***********************SETUP***********************/
+
+	UBXParser parser;
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_bytes(parser, UBX_CAPTURE_NAV_PVT_3D_FIX, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_TRUE(parser.is(UBX_CLASS_NAV, UBX_ID_NAV_PVT));
+	ASSERT_EQ(parser.payload_length(), 92);
+	ASSERT_EQ(memcmp(parser.payload(), &UBX_CAPTURE_NAV_PVT_3D_FIX[6], 92), 0);
+}
+
+TEST(UBXParser, BadChecksumIsDroppedAndTheNextFrameFound) {
+
+	/***********************SETUP***********************/
+
+	UBXParser parser;
+	vector<uint8_t> stream = {0x00, 0xB5, 0xB5}; //line noise, and a repeated sync byte
+	stream.insert(stream.end(), UBX_CAPTURE_NAV_PVT_3D_FIX, UBX_CAPTURE_NAV_PVT_3D_FIX + sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	stream[3 + 40] ^= 0x10; //one bit of the longitude flipped on the wire
+	stream.insert(stream.end(), UBX_CAPTURE_ACK_CFG_RATE, UBX_CAPTURE_ACK_CFG_RATE + sizeof(UBX_CAPTURE_ACK_CFG_RATE));
+
+	/********************STEPTHROUGH********************/
+
+	int completed = feed_bytes(parser, stream.data(), stream.size());
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 1);
+	ASSERT_EQ(parser.checksum_errors(), 1u);
+	ASSERT_TRUE(parser.is(UBX_CLASS_ACK, UBX_ID_ACK_ACK));
+	ASSERT_EQ(parser.payload()[0], UBX_CLASS_CFG);
+	ASSERT_EQ(parser.payload()[1], UBX_ID_CFG_RATE);
+}
+
+TEST(UBXParser, LargeFramesAreSkipped) {
+
+	/***********************SETUP***********************/
+
+	UBXParser parser;
+	uint8_t payload[400];
+	for (size_t i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t) i;
+	uint8_t nav_sat[sizeof(payload) + UBX_FRAME_OVERHEAD];
+	size_t nav_sat_len = ubx_build_frame(UBX_CLASS_NAV, 0x35, payload, sizeof(payload), nav_sat, sizeof(nav_sat));
+
+	vector<uint8_t> stream(nav_sat, nav_sat + nav_sat_len);
+	stream.insert(stream.end(), UBX_CAPTURE_NAV_PVT_NO_FIX, UBX_CAPTURE_NAV_PVT_NO_FIX + sizeof(UBX_CAPTURE_NAV_PVT_NO_FIX));
+
+	/********************STEPTHROUGH********************/
+
+	bool complete;
+	size_t used = parser.feed(stream.data(), stream.size(), complete);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(complete);
+	ASSERT_EQ(used, stream.size());
+	ASSERT_EQ(parser.skipped_frames(), 1u);
+	ASSERT_EQ(parser.checksum_errors(), 0u);
+	ASSERT_TRUE(parser.is(UBX_CLASS_NAV, UBX_ID_NAV_PVT));
+}
+
+TEST(UBXParser, BogusLengthInsideAPayloadIsRejectedStraightAway) {
+
+	/***********************SETUP***********************/
+
+	UBXParser parser;
+
+	//joined partway through a payload that happens to hold the sync bytes, followed by a header claiming 65535 bytes
+	vector<uint8_t> stream = {0x12, 0x34, UBX_SYNC_1, UBX_SYNC_2, UBX_CLASS_NAV, 0x35, 0xFF, 0xFF, 0x56, 0x78};
+	stream.insert(stream.end(), UBX_CAPTURE_NAV_PVT_3D_FIX, UBX_CAPTURE_NAV_PVT_3D_FIX + sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+
+	/********************STEPTHROUGH********************/
+
+	bool complete;
+	size_t used = parser.feed(stream.data(), stream.size(), complete);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(complete);
+	ASSERT_EQ(used, stream.size());
+	ASSERT_EQ(parser.skipped_frames(), 1u);
+	ASSERT_EQ(parser.checksum_errors(), 0u);
+	ASSERT_TRUE(parser.is(UBX_CLASS_NAV, UBX_ID_NAV_PVT));
+	ASSERT_EQ(parser.frame_start(), 10u);
+}
+
+TEST(UBXParser, ParsesInPlaceOutOfARing) {
+
+	/***********************SETUP***********************/
+
+	uint8_t storage[128];
+	ByteRing ring;
+	ring.init(storage, sizeof(storage));
+	UBXParser parser;
+	int completed = 0;
+
+	/********************STEPTHROUGH********************/
+
+	//a NAV-PVT is most of the ring, so every one wraps around its end at a different place
+	for (int i = 0; i < 10; i++) {
+		const uint8_t *frame = i % 2 ? UBX_CAPTURE_NAV_PVT_NO_FIX : UBX_CAPTURE_NAV_PVT_3D_FIX;
+		size_t pushed = 0;
+
+		while (pushed < sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX)) {
+			pushed += ring.push(frame + pushed, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX) - pushed);
+			while (parser.feed(ring)) completed++;
+		}
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(completed, 10);
+	ASSERT_EQ(parser.checksum_errors(), 0u);
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST(UBXParser, KnowsWhereEachFrameStarted) {
+
+	/***********************SETUP***********************/
+
+	//noise with a stray sync byte, then a frame, and a repeated sync byte ahead of another
+	vector<uint8_t> stream = {0x12, UBX_SYNC_1, 0x34};
+	stream.insert(stream.end(), UBX_CAPTURE_ACK_CFG_RATE, UBX_CAPTURE_ACK_CFG_RATE + sizeof(UBX_CAPTURE_ACK_CFG_RATE));
+	size_t second = stream.size() + 1;
+	stream.push_back(UBX_SYNC_1);
+	stream.insert(stream.end(), UBX_CAPTURE_NAV_PVT_3D_FIX,
+				  UBX_CAPTURE_NAV_PVT_3D_FIX + sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+
+	UBXParser parser;
+	vector<uint32_t> starts;
+
+	/********************STEPTHROUGH********************/
+
+	//in uneven chunks, so both the byte by byte and payload paths count
+	size_t position = 0;
+	while (position < stream.size()) {
+		size_t len = stream.size() - position < 37 ? stream.size() - position : 37;
+		bool complete;
+		position += parser.feed(&stream[position], len, complete);
+		if (complete) starts.push_back(parser.frame_start());
+	}
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(starts.size(), 2u);
+	ASSERT_EQ(starts[0], 3u);
+	ASSERT_EQ(starts[1], second);
+
+	parser.reset();
+	ASSERT_EQ(feed_bytes(parser, UBX_CAPTURE_ACK_CFG_RATE, sizeof(UBX_CAPTURE_ACK_CFG_RATE)), 1);
+	ASSERT_EQ(parser.frame_start(), 0u);
+}
+
+/***********************************************************************************************************************
+ * Messages
+ **********************************************************************************************************************/
+
+TEST(UBXParser, DecodesNavPVT) {
+
+	/***********************SETUP***********************/
+
+	UBXNavPVT pvt;
+
+	/********************STEPTHROUGH********************/
+
+	StatusCode status = ubx_decode_nav_pvt(&UBX_CAPTURE_NAV_PVT_3D_FIX[6], 92, pvt);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(status, STATUS_CODE_OK);
+	ASSERT_EQ(pvt.itow_ms, 417600000u);
+	ASSERT_EQ(pvt.year, 2019);
+	ASSERT_EQ(pvt.month, 6);
+	ASSERT_EQ(pvt.day, 14);
+	ASSERT_EQ(pvt.hour, 19);
+	ASSERT_EQ(pvt.second, 59);
+	ASSERT_EQ(pvt.nano, -12345);
+	ASSERT_TRUE(pvt.date_valid);
+	ASSERT_TRUE(pvt.time_valid);
+	ASSERT_EQ(pvt.fix_type, UBX_FIX_3D);
+	ASSERT_TRUE(pvt.fix_ok);
+	ASSERT_TRUE(pvt.differential);
+	ASSERT_EQ(pvt.satellites, 14);
+	ASSERT_EQ(pvt.longitude, -805423210);
+	ASSERT_EQ(pvt.latitude, 434726560);
+	ASSERT_EQ(pvt.height_mm, 291234);
+	ASSERT_EQ(pvt.height_msl_mm, 326789);
+	ASSERT_EQ(pvt.horizontal_accuracy_mm, 1234u);
+	ASSERT_EQ(pvt.vertical_accuracy_mm, 2345u);
+	ASSERT_EQ(pvt.velocity_north_mm_s, 1500);
+	ASSERT_EQ(pvt.velocity_east_mm_s, -2500);
+	ASSERT_EQ(pvt.velocity_down_mm_s, 300);
+	ASSERT_EQ(pvt.ground_speed_mm_s, 2915);
+	ASSERT_EQ(pvt.heading_of_motion, 30096376);
+	ASSERT_EQ(pvt.pdop, 132);
+
+	//u-blox 7 receivers send a shorter payload, anything shorter than that is broken
+	ASSERT_EQ(ubx_decode_nav_pvt(&UBX_CAPTURE_NAV_PVT_3D_FIX[6], 84, pvt), STATUS_CODE_OK);
+	ASSERT_EQ(ubx_decode_nav_pvt(&UBX_CAPTURE_NAV_PVT_3D_FIX[6], 83, pvt), STATUS_CODE_INVALID_ARGS);
+}
+
+TEST(UBXParser, BuildsConfigurationFrames) {
+
+	/***********************SETUP***********************/
+
+	uint8_t frame[32];
+	uint8_t too_small[10];
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(ubx_build_cfg_prt(115200, frame, sizeof(frame)), sizeof(UBX_EXPECTED_CFG_PRT_115200));
+	ASSERT_EQ(memcmp(frame, UBX_EXPECTED_CFG_PRT_115200, sizeof(UBX_EXPECTED_CFG_PRT_115200)), 0);
+
+	ASSERT_EQ(ubx_build_cfg_rate(100, frame, sizeof(frame)), sizeof(UBX_EXPECTED_CFG_RATE_10HZ));
+	ASSERT_EQ(memcmp(frame, UBX_EXPECTED_CFG_RATE_10HZ, sizeof(UBX_EXPECTED_CFG_RATE_10HZ)), 0);
+
+	ASSERT_EQ(ubx_build_cfg_msg(UBX_CLASS_NAV, UBX_ID_NAV_PVT, 1, frame, sizeof(frame)),
+			  sizeof(UBX_EXPECTED_CFG_MSG_NAV_PVT));
+	ASSERT_EQ(memcmp(frame, UBX_EXPECTED_CFG_MSG_NAV_PVT, sizeof(UBX_EXPECTED_CFG_MSG_NAV_PVT)), 0);
+
+	ASSERT_EQ(ubx_build_cfg_rate(100, too_small, sizeof(too_small)), 0u);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "fff.h"
+
+#include "Clock.hpp"
+#include "HostDevices.hpp"
+#include "UbloxGps.hpp"
+#include "UBXCaptures.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+class UbloxGpsTest : public Test {
+ protected:
+	void SetUp() override { host_devices_reset(); }
+
+	void TearDown() override { host_devices_reset(); }
+};
+
+static bool contains(const vector<uint8_t> &haystack, const uint8_t *needle, size_t len) {
+	for (size_t i = 0; i + len <= haystack.size(); i++) {
+		if (memcmp(&haystack[i], needle, len) == 0) return true;
+	}
+	return false;
+}
+
+//steps the driver through its configuration the way the gps task does, in its own time
+static void configure(UbloxGps &gps) {
+	gps.Init();
+	for (int i = 0; i < 100 && gps.configuring(); i++) {
+		this_thread::sleep_for(chrono::milliseconds(5));
+		gps.BeginMeasuring();
+	}
+}
+
+/***********************************************************************************************************************
+ * Driver
+ **********************************************************************************************************************/
+
+TEST_F(UbloxGpsTest, InitConfiguresTheReceiver) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	uint8_t sent[256];
+
+	/********************STEPTHROUGH********************/
+
+	configure(gps);
+	size_t sent_len = host_uart_take_transmitted(UART_PORT2, sent, sizeof(sent));
+	vector<uint8_t> transmitted(sent, sent + sent_len);
+
+	/**********************ASSERTS**********************/
+
+	//the baudrate change twice, at the old and new baudrates, then the rate and the message
+	ASSERT_FALSE(gps.configuring());
+	ASSERT_EQ(memcmp(&transmitted[0], UBX_EXPECTED_CFG_PRT_115200, sizeof(UBX_EXPECTED_CFG_PRT_115200)), 0);
+	ASSERT_EQ(memcmp(&transmitted[sizeof(UBX_EXPECTED_CFG_PRT_115200)], UBX_EXPECTED_CFG_PRT_115200,
+					 sizeof(UBX_EXPECTED_CFG_PRT_115200)), 0);
+	ASSERT_TRUE(contains(transmitted, UBX_EXPECTED_CFG_RATE_10HZ, sizeof(UBX_EXPECTED_CFG_RATE_10HZ)));
+	ASSERT_TRUE(contains(transmitted, UBX_EXPECTED_CFG_MSG_NAV_PVT, sizeof(UBX_EXPECTED_CFG_MSG_NAV_PVT)));
+}
+
+TEST_F(UbloxGpsTest, ConfiguringNeverWaits) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	uint8_t sent[256];
+	uint64_t longest_us = 0;
+
+	/********************STEPTHROUGH********************/
+
+	uint64_t start = get_system_time_us();
+	gps.Init();
+	longest_us = get_system_time_us() - start;
+	size_t first_len = host_uart_take_transmitted(UART_PORT2, sent, sizeof(sent));
+
+	while (gps.configuring()) {
+		this_thread::sleep_for(chrono::milliseconds(5));
+		start = get_system_time_us();
+		gps.BeginMeasuring();
+		uint64_t took = get_system_time_us() - start;
+		if (took > longest_us) longest_us = took;
+	}
+
+	/**********************ASSERTS**********************/
+
+	//only the first baudrate change goes out straight away, the rest wait for it without holding the task up
+	ASSERT_EQ(first_len, sizeof(UBX_EXPECTED_CFG_PRT_115200));
+	ASSERT_LT(longest_us, 5000u);
+	ASSERT_EQ(gps.reconfigurations(), 0u);
+}
+
+TEST_F(UbloxGpsTest, SolutionsAreConvertedIntoGpsData) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	configure(gps);
+	GpsData_t data;
+
+	/********************STEPTHROUGH********************/
+
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_ACK_CFG_RATE, sizeof(UBX_CAPTURE_ACK_CFG_RATE));
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_NAV_PVT_3D_FIX, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	gps.BeginMeasuring();
+	gps.GetResult(&data);
+
+	GpsData_t again;
+	gps.GetResult(&again);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(data.dataIsNew);
+	ASSERT_EQ(data.position.latitude, 434726560);
+	ASSERT_EQ(data.position.longitude, -805423210);
+	ASSERT_EQ(data.position.altitude_mm, 326789);
+	ASSERT_NEAR(data.utcTime, 19 * 3600 + 59 * 60 + 59, 0.01);
+	ASSERT_FLOAT_EQ(data.groundSpeed, 2.915f);
+	ASSERT_EQ(data.heading, 300);
+	ASSERT_FLOAT_EQ(data.velocityNorth, 1.5f);
+	ASSERT_FLOAT_EQ(data.velocityEast, -2.5f);
+	ASSERT_FLOAT_EQ(data.velocityDown, 0.3f);
+	ASSERT_FLOAT_EQ(data.horizontalAccuracy, 1.234f);
+	ASSERT_FLOAT_EQ(data.verticalAccuracy, 2.345f);
+	ASSERT_EQ(data.numSatellites, 14);
+	ASSERT_EQ(data.sensorStatus, 2); //differential
+
+	ASSERT_FALSE(again.dataIsNew);
+	ASSERT_EQ(gps.rejected_configurations(), 0u);
+}
+
+TEST_F(UbloxGpsTest, LosingTheFixIsReported) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	configure(gps);
+	GpsData_t data;
+
+	/********************STEPTHROUGH********************/
+
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_NAV_PVT_3D_FIX, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_NAV_PVT_NO_FIX, sizeof(UBX_CAPTURE_NAV_PVT_NO_FIX));
+	gps.BeginMeasuring();
+	gps.GetResult(&data);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(data.sensorStatus, 0);
+	ASSERT_EQ(data.numSatellites, 2);
+	ASSERT_EQ(gps.latest().itow_ms, 417600100u);
+	ASSERT_EQ(gps.reconfigurations(), 0u);
+}
+
+/***********************************************************************************************************************
+ * Publishing
+ **********************************************************************************************************************/
+
+TEST_F(UbloxGpsTest, SolutionsAreStampedWhenTheyArrive) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	configure(gps);
+	GpsData_t data;
+
+	//the whole frame at 115200 baud, 10 bits a byte
+	const uint64_t frame_time_us = sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX) * 10 * 1000000ULL / UBLOX_BAUDRATE;
+
+	/********************STEPTHROUGH********************/
+
+	uint64_t injected_us = get_system_time_us();
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_NAV_PVT_3D_FIX, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	this_thread::sleep_for(chrono::milliseconds(30));
+
+	uint64_t parsed_us = get_system_time_us();
+	gps.BeginMeasuring();
+	gps.GetResult(&data);
+
+	/**********************ASSERTS**********************/
+
+	//injecting hands the whole frame over at once, so its first byte is put a frame's time before that
+	ASSERT_TRUE(data.dataIsNew);
+	ASSERT_GE(data.receivedTimeUs + frame_time_us, injected_us);
+	ASSERT_LE(data.receivedTimeUs + frame_time_us, injected_us + 5000);
+	ASSERT_LT(data.receivedTimeUs, parsed_us);
+}
+
+TEST_F(UbloxGpsTest, GetResultOnlyCopiesWhatWasPublished) {
+
+	/***********************SETUP***********************/
+
+	UbloxGps gps(UART_PORT2);
+	configure(gps);
+	GpsData_t data;
+	GpsData_t latest;
+
+	/********************STEPTHROUGH********************/
+
+	gps.GetResult(&data);
+	ASSERT_FALSE(data.dataIsNew);
+	ASSERT_EQ(data.sensorStatus, 0);
+
+	host_uart_inject(UART_PORT2, UBX_CAPTURE_NAV_PVT_3D_FIX, sizeof(UBX_CAPTURE_NAV_PVT_3D_FIX));
+	gps.GetResult(&data);
+	ASSERT_FALSE(data.dataIsNew); //nothing's parsed until the service runs
+
+	gps.BeginMeasuring();
+	uint32_t published = gps.read_latest(latest);
+	gps.GetResult(&data);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(published, 1u);
+	ASSERT_TRUE(data.dataIsNew);
+	ASSERT_EQ(data.position.latitude, latest.position.latitude);
+	ASSERT_EQ(data.receivedTimeUs, latest.receivedTimeUs);
+
+	//other readers don't take the new data away from GetResult's reader
+	gps.read_latest(latest);
+	gps.GetResult(&data);
+	ASSERT_FALSE(data.dataIsNew);
+}
@@ -0,0 +1,416 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "Telemetry.hpp"
+#include "Checksum.h"
+
+using namespace std;
+using ::testing::Test;
+
+//what the ground does with a frame: undo the encoding, check and strip the crc. Empty if anything's wrong with it
+static vector<uint8_t> decode(const vector<uint8_t> &frame) {
+	vector<uint8_t> content;
+	if (frame.size() < 2 || frame.back() != 0) return vector<uint8_t>();
+
+	size_t end = frame.size() - 1;
+	size_t i = 0;
+	while (i < end) {
+		uint8_t code = frame[i];
+		if (code == 0 || i + code > end) return vector<uint8_t>();
+
+		content.insert(content.end(), frame.begin() + i + 1, frame.begin() + i + code);
+		i += code;
+		if (i < end) content.push_back(0);
+	}
+
+	if (content.size() < TELEMETRY_HEADER_LEN + TELEMETRY_CRC_LEN) return vector<uint8_t>();
+
+	size_t crc_at = content.size() - TELEMETRY_CRC_LEN;
+	uint16_t crc = (uint16_t) (content[crc_at] | (content[crc_at + 1] << 8));
+	if (crc != crc16_ccitt_update(CRC16_CCITT_INIT, content.data(), crc_at)) return vector<uint8_t>();
+
+	content.resize(crc_at);
+	return content;
+}
+
+static uint32_t u32_at(const vector<uint8_t> &content, size_t index) {
+	return (uint32_t) content[index] | ((uint32_t) content[index + 1] << 8) | ((uint32_t) content[index + 2] << 16)
+		| ((uint32_t) content[index + 3] << 24);
+}
+
+static float float_at(const vector<uint8_t> &content, size_t index) {
+	uint32_t bits = u32_at(content, index);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+//writes a frame into one buffer, split the way a ring wrapping at split would hand it out
+static vector<uint8_t> write_frame(size_t payload_len, size_t split, void (*write)(TelemetryWriter &),
+								   TelemetryMessageId id, uint8_t sequence) {
+	size_t len = telemetry_frame_len(payload_len);
+	vector<uint8_t> first(len, 0xAA);
+	vector<uint8_t> second(len, 0xAA);
+
+	DMATxRegion region;
+	region.first = first.data();
+	region.first_len = split < len ? split : len;
+	region.second = second.data();
+	region.second_len = len - region.first_len;
+
+	TelemetryWriter writer(region, id, sequence);
+	write(writer);
+	size_t written = writer.finish();
+
+	vector<uint8_t> frame(first.begin(), first.begin() + region.first_len);
+	frame.insert(frame.end(), second.begin(), second.begin() + region.second_len);
+	frame.resize(written);
+	return frame;
+}
+
+static SFOutput_t attitude() {
+	SFOutput_t output;
+	output.IMUroll = 0.1f;
+	output.IMUpitch = -0.25f;
+	output.IMUyaw = 3.0f;
+	output.IMUrollrate = 0;
+	output.IMUpitchrate = 0.5f;
+	output.IMUyawrate = -1.5f;
+	output.Airspeed = 17.5f;
+	return output;
+}
+
+static void write_attitude(TelemetryWriter &writer) {
+	telemetry_write_attitude(writer, attitude());
+}
+
+static void write_gps(TelemetryWriter &writer) {
+	GpsData_t gps;
+	memset(&gps, 0, sizeof(gps));
+	gps.position.latitude = 434726560;
+	gps.position.longitude = -805423210;
+	gps.position.altitude_mm = 326789;
+	gps.velocityNorth = 12.5f;
+	gps.heading = 270;
+	gps.numSatellites = 11;
+	gps.sensorStatus = 1;
+	gps.receivedTimeUs = 123456789;
+	telemetry_write_gps(writer, gps);
+}
+
+static void write_heartbeat(TelemetryWriter &writer) {
+	SystemMonitorSnapshot system;
+	memset(&system, 0, sizeof(system));
+	system.heap_free_bytes = 0x1000; //plenty of zeros for the encoding to deal with
+	system.cpu_load_permille = 345;
+	telemetry_write_heartbeat(writer, 60000, system, TELEMETRY_FLAG_GPS_FIX);
+}
+
+static void write_tasks(TelemetryWriter &writer) {
+	SystemMonitorSnapshot system;
+	memset(&system, 0, sizeof(system));
+	system.task_count = SYSTEM_MONITOR_MAX_TASKS;
+	for (uint8_t i = 0; i < system.task_count; i++) {
+		system.tasks[i].number = i + 1;
+		memcpy(system.tasks[i].name, i % 2 ? "GpsServi" : "IDLE\0\0\0\0", SYSTEM_MONITOR_NAME_LEN);
+		system.tasks[i].stack_free_words = (uint16_t) (100 + i);
+		system.tasks[i].cpu_permille = (uint16_t) (i * 10);
+	}
+	telemetry_write_tasks(writer, system);
+}
+
+static void write_interchip(TelemetryWriter &writer) {
+	InterchipStatsSnapshot local;
+	memset(&local, 0, sizeof(local));
+	local.frames_sent = 200000;
+	local.frames_received = 199990;
+	local.crc_failures = 3;
+	local.max_rtt_us = 1800;
+	local.rtt_histogram[0] = 12;
+	local.rtt_histogram[INTERCHIP_RTT_BUCKETS - 1] = 1;
+
+	Interchip_LinkHealth remote = {2, 5, 7};
+	telemetry_write_interchip(writer, local, remote);
+}
+
+/***********************************************************************************************************************
+ * Framing
+ **********************************************************************************************************************/
+
+TEST(Telemetry, AttitudeRoundTrips) {
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> frame = write_frame(TELEMETRY_ATTITUDE_LEN, 1000, write_attitude, TELEMETRY_ATTITUDE, 7);
+	vector<uint8_t> content = decode(frame);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(frame.size(), telemetry_frame_len(TELEMETRY_ATTITUDE_LEN));
+	ASSERT_EQ(content.size(), TELEMETRY_HEADER_LEN + TELEMETRY_ATTITUDE_LEN);
+	ASSERT_EQ(content[0], TELEMETRY_ATTITUDE);
+	ASSERT_EQ(content[1], 7);
+	ASSERT_EQ(float_at(content, 2), 0.1f);
+	ASSERT_EQ(float_at(content, 6), -0.25f);
+	ASSERT_EQ(float_at(content, 10), 3.0f);
+	ASSERT_EQ(float_at(content, 14), 0.0f);
+	ASSERT_EQ(float_at(content, 18), 0.5f);
+	ASSERT_EQ(float_at(content, 22), -1.5f);
+	ASSERT_EQ(float_at(content, 26), 17.5f);
+}
+
+TEST(Telemetry, GpsRoundTrips) {
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> content = decode(write_frame(TELEMETRY_GPS_LEN, 1000, write_gps, TELEMETRY_GPS, 0));
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(content.size(), TELEMETRY_HEADER_LEN + TELEMETRY_GPS_LEN);
+	ASSERT_EQ((int32_t) u32_at(content, 2), 434726560);
+	ASSERT_EQ((int32_t) u32_at(content, 6), -805423210);
+	ASSERT_EQ((int32_t) u32_at(content, 10), 326789);
+	ASSERT_EQ(float_at(content, 14), 12.5f);
+	ASSERT_EQ(content[34] | (content[35] << 8), 270);
+	ASSERT_EQ(content[36], 11);
+	ASSERT_EQ(content[37], 1);
+	ASSERT_EQ(u32_at(content, 38), 123456u); //ms
+}
+
+TEST(Telemetry, InterchipRoundTrips) {
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> content = decode(write_frame(TELEMETRY_INTERCHIP_LEN, 30, write_interchip, TELEMETRY_INTERCHIP, 3));
+
+	/**********************ASSERTS**********************/
+
+	size_t remote_at = 2 + 4 * (9 + INTERCHIP_RTT_BUCKETS);
+	ASSERT_EQ(content.size(), TELEMETRY_HEADER_LEN + TELEMETRY_INTERCHIP_LEN);
+	ASSERT_EQ(content[0], TELEMETRY_INTERCHIP);
+	ASSERT_EQ(u32_at(content, 2), 200000u);
+	ASSERT_EQ(u32_at(content, 6), 199990u);
+	ASSERT_EQ(u32_at(content, 10), 3u);
+	ASSERT_EQ(u32_at(content, 34), 1800u);
+	ASSERT_EQ(u32_at(content, 38), 12u);
+	ASSERT_EQ(u32_at(content, remote_at - 4), 1u);
+	ASSERT_EQ(content[remote_at] | (content[remote_at + 1] << 8), 2);
+	ASSERT_EQ(content[remote_at + 2] | (content[remote_at + 3] << 8), 5);
+	ASSERT_EQ(content[remote_at + 4] | (content[remote_at + 5] << 8), 7);
+}
+
+TEST(Telemetry, OnlyTheEndOfAFrameIsZero) {
+
+	/********************STEPTHROUGH********************/
+
+	vector<uint8_t> heartbeat = write_frame(TELEMETRY_HEARTBEAT_LEN, 1000, write_heartbeat, TELEMETRY_HEARTBEAT, 0);
+	vector<uint8_t> tasks = write_frame(telemetry_tasks_len(SYSTEM_MONITOR_MAX_TASKS), 1000, write_tasks,
+										TELEMETRY_TASKS, 0);
+
+	/**********************ASSERTS**********************/
+
+	for (const vector<uint8_t> &frame : {heartbeat, tasks}) {
+		for (size_t i = 0; i + 1 < frame.size(); i++) {
+			ASSERT_NE(frame[i], 0) << "at " << i;
+		}
+		ASSERT_EQ(frame.back(), 0);
+	}
+
+	vector<uint8_t> content = decode(heartbeat);
+	ASSERT_EQ(u32_at(content, 2), 60000u);
+	ASSERT_EQ(u32_at(content, 6), 0x1000u);
+	ASSERT_EQ(content[13], TELEMETRY_FLAG_GPS_FIX);
+
+	content = decode(tasks);
+	ASSERT_EQ(content.size(), TELEMETRY_HEADER_LEN + telemetry_tasks_len(SYSTEM_MONITOR_MAX_TASKS));
+	ASSERT_EQ(content[2], SYSTEM_MONITOR_MAX_TASKS);
+	ASSERT_EQ(memcmp(&content[3 + TELEMETRY_TASK_LEN + 1], "GpsServi", SYSTEM_MONITOR_NAME_LEN), 0);
+}
+
+TEST(Telemetry, WrappingAroundTheQueueMakesNoDifference) {
+
+	/***********************SETUP***********************/
+
+	vector<uint8_t> whole = write_frame(TELEMETRY_GPS_LEN, 1000, write_gps, TELEMETRY_GPS, 200);
+
+	/**********************ASSERTS**********************/
+
+	//every place the ring could wrap, including right after the code byte and right before the end
+	for (size_t split = 1; split <= whole.size(); split++) {
+		ASSERT_EQ(write_frame(TELEMETRY_GPS_LEN, split, write_gps, TELEMETRY_GPS, 200), whole) << "split at " << split;
+	}
+}
+
+TEST(Telemetry, CorruptionIsCaught) {
+
+	/***********************SETUP***********************/
+
+	vector<uint8_t> frame = write_frame(TELEMETRY_ATTITUDE_LEN, 1000, write_attitude, TELEMETRY_ATTITUDE, 1);
+
+	/********************STEPTHROUGH********************/
+
+	frame[10] ^= 0x04;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(decode(frame).empty());
+}
+
+TEST(Telemetry, TheLargestPayloadFits) {
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_LE(telemetry_tasks_len(SYSTEM_MONITOR_MAX_TASKS), TELEMETRY_MAX_PAYLOAD_LEN);
+	ASSERT_LE(TELEMETRY_GPS_LEN, TELEMETRY_MAX_PAYLOAD_LEN);
+	ASSERT_LE(TELEMETRY_INTERCHIP_LEN, TELEMETRY_MAX_PAYLOAD_LEN);
+}
+
+/***********************************************************************************************************************
+ * Scheduling
+ **********************************************************************************************************************/
+
+//runs the scheduler the way the telemetry task does, every tick_us for duration_us, sending whatever fits
+static void run_link(TelemetryScheduler &scheduler, uint64_t duration_us, uint64_t tick_us, const size_t *frame_len,
+					 uint64_t *bytes = nullptr) {
+	for (uint64_t now = 0; now < duration_us; now += tick_us) {
+		for (;;) {
+			TelemetryMessageId id = scheduler.next(now);
+			if (id == TELEMETRY_NONE) break;
+			if (!scheduler.spend(frame_len[id], now)) break;
+
+			scheduler.sent(id);
+			if (bytes) *bytes += frame_len[id];
+		}
+	}
+}
+
+static const size_t FRAME_LENS[TELEMETRY_MESSAGE_COUNT] = {
+	telemetry_frame_len(TELEMETRY_HEARTBEAT_LEN),
+	telemetry_frame_len(TELEMETRY_ATTITUDE_LEN),
+	telemetry_frame_len(TELEMETRY_GPS_LEN),
+	telemetry_frame_len(TELEMETRY_GEOFENCE_LEN),
+	telemetry_frame_len(telemetry_tasks_len(SYSTEM_MONITOR_MAX_TASKS)),
+	telemetry_frame_len(TELEMETRY_INTERCHIP_LEN),
+};
+
+TEST(TelemetryScheduler, SendsEachMessageAtItsRate) {
+
+	/***********************SETUP***********************/
+
+	TelemetryScheduler scheduler;
+	scheduler.set_link(100000, 4096);
+	scheduler.set_rate(TELEMETRY_HEARTBEAT, 1);
+	scheduler.set_rate(TELEMETRY_ATTITUDE, 50);
+	scheduler.set_rate(TELEMETRY_GPS, 5);
+
+	/********************STEPTHROUGH********************/
+
+	run_link(scheduler, 10000000, 1000, FRAME_LENS);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(scheduler.sent_count(TELEMETRY_HEARTBEAT), 10u);
+	ASSERT_EQ(scheduler.sent_count(TELEMETRY_ATTITUDE), 500u);
+	ASSERT_EQ(scheduler.sent_count(TELEMETRY_GPS), 50u);
+	ASSERT_EQ(scheduler.sent_count(TELEMETRY_TASKS), 0u);
+	ASSERT_EQ(scheduler.skipped_count(TELEMETRY_ATTITUDE), 0u);
+}
+
+TEST(TelemetryScheduler, NeverGoesOverTheLink) {
+
+	/***********************SETUP***********************/
+
+	//far more than the link can carry
+	TelemetryScheduler scheduler;
+	scheduler.set_link(2000, 256);
+	scheduler.set_rate(TELEMETRY_HEARTBEAT, 1);
+	scheduler.set_rate(TELEMETRY_ATTITUDE, 100);
+	scheduler.set_rate(TELEMETRY_GPS, 10);
+	scheduler.set_rate(TELEMETRY_TASKS, 1);
+
+	/********************STEPTHROUGH********************/
+
+	uint64_t bytes = 0;
+	run_link(scheduler, 10000000, 10000, FRAME_LENS, &bytes);
+
+	/**********************ASSERTS**********************/
+
+	//10s of the link, and the burst it starts with
+	ASSERT_LE(bytes, 2000u * 10 + 256);
+	ASSERT_GT(bytes, 2000u * 10 * 9 / 10);
+
+	//nothing starves: the slow messages still get out, the fast one just loses periods
+	ASSERT_GE(scheduler.sent_count(TELEMETRY_HEARTBEAT), 9u);
+	ASSERT_GE(scheduler.sent_count(TELEMETRY_TASKS), 9u);
+	ASSERT_GT(scheduler.sent_count(TELEMETRY_GPS), 50u);
+	ASSERT_GT(scheduler.skipped_count(TELEMETRY_ATTITUDE), 0u);
+}
+
+TEST(TelemetryScheduler, FurthestPastDueGoesFirst) {
+
+	/***********************SETUP***********************/
+
+	TelemetryScheduler scheduler;
+	scheduler.set_link(100000, 4096);
+	scheduler.set_rate(TELEMETRY_ATTITUDE, 10);
+	scheduler.set_rate(TELEMETRY_GPS, 5);
+	ASSERT_EQ(scheduler.next(0), TELEMETRY_ATTITUDE); //a tie goes to the lower id
+	scheduler.sent(TELEMETRY_ATTITUDE);
+
+	/********************STEPTHROUGH********************/
+
+	TelemetryMessageId late = scheduler.next(150000);
+
+	/**********************ASSERTS**********************/
+
+	//gps has been due since 0, attitude only since 100ms
+	ASSERT_EQ(late, TELEMETRY_GPS);
+	scheduler.sent(late);
+	ASSERT_EQ(scheduler.next(150000), TELEMETRY_ATTITUDE);
+	scheduler.sent(TELEMETRY_ATTITUDE);
+	ASSERT_EQ(scheduler.next(150000), TELEMETRY_NONE);
+}
+
+TEST(TelemetryScheduler, SkipsPeriodsItFellBehindOn) {
+
+	/***********************SETUP***********************/
+
+	TelemetryScheduler scheduler;
+	scheduler.set_link(100000, 4096);
+	scheduler.set_rate(TELEMETRY_ATTITUDE, 10);
+	scheduler.next(0);
+	scheduler.sent(TELEMETRY_ATTITUDE);
+
+	/********************STEPTHROUGH********************/
+
+	//stalled for 350ms, so the ones due at 100, 200 and 300ms didn't go
+	TelemetryMessageId id = scheduler.next(450000);
+	scheduler.sent(id);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(id, TELEMETRY_ATTITUDE);
+	ASSERT_EQ(scheduler.skipped_count(TELEMETRY_ATTITUDE), 3u);
+	//and it's back to its own rate, not bursting to catch up
+	ASSERT_EQ(scheduler.next(450000), TELEMETRY_NONE);
+	ASSERT_EQ(scheduler.next(500000), TELEMETRY_ATTITUDE);
+}
+
+TEST(TelemetryScheduler, RejectsBadRates) {
+
+	/***********************SETUP***********************/
+
+	TelemetryScheduler scheduler;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(scheduler.set_rate(TELEMETRY_MESSAGE_COUNT, 1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(scheduler.set_rate(TELEMETRY_GPS, -1), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(scheduler.set_rate(TELEMETRY_GPS, NAN), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(scheduler.set_rate(TELEMETRY_GPS, 0.0001f), STATUS_CODE_OK);
+	ASSERT_EQ(scheduler.set_rate(TELEMETRY_GPS, 0), STATUS_CODE_OK);
+	ASSERT_EQ(scheduler.next(0), TELEMETRY_NONE);
+}
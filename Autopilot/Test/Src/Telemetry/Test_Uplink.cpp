@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "fff.h"
+
+#include "Uplink.hpp"
+
+using namespace std;
+using ::testing::Test;
+
+//what the ground sends. The framing is the same both ways, so telemetry's writer makes uplink frames too
+static vector<uint8_t> encode(uint8_t id, uint8_t sequence, const vector<uint8_t> &payload) {
+	size_t len = telemetry_frame_len(payload.size());
+	vector<uint8_t> frame(len);
+	DMATxRegion region = {frame.data(), len, nullptr, 0};
+
+	TelemetryWriter writer(region, (TelemetryMessageId) id, sequence);
+	writer.put_bytes(payload.data(), payload.size());
+	frame.resize(writer.finish());
+	return frame;
+}
+
+static void put_u32(vector<uint8_t> &out, uint32_t value) {
+	for (int i = 0; i < 4; i++) out.push_back((uint8_t) (value >> (8 * i)));
+}
+
+static void put_float(vector<uint8_t> &out, float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	put_u32(out, bits);
+}
+
+/***********************************************************************************************************************
+ * Messages
+ **********************************************************************************************************************/
+
+TEST(Uplink, ParsesSetpointsAndParameters) {
+
+	/***********************SETUP***********************/
+
+	vector<uint8_t> setpoint_payload;
+	put_float(setpoint_payload, 0.2f);
+	put_float(setpoint_payload, -0.1f);
+	put_float(setpoint_payload, 1.5f);
+	put_float(setpoint_payload, 18);
+	setpoint_payload.push_back(0xE8); //1000
+	setpoint_payload.push_back(0x03);
+
+	vector<uint8_t> parameter_payload = {2, 0};
+	put_float(parameter_payload, 10);
+
+	/********************STEPTHROUGH********************/
+
+	UplinkSetpoint setpoint;
+	bool parsed_setpoint = uplink_parse_setpoint(setpoint_payload.data(), setpoint_payload.size(), setpoint);
+	UplinkParameterWrite parameter;
+	bool parsed_parameter = uplink_parse_parameter(parameter_payload.data(), parameter_payload.size(), parameter);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(parsed_setpoint);
+	ASSERT_EQ(setpoint.commands.roll, 0.2f);
+	ASSERT_EQ(setpoint.commands.pitch, -0.1f);
+	ASSERT_EQ(setpoint.commands.yaw, 1.5f);
+	ASSERT_EQ(setpoint.commands.airspeed, 18.0f);
+	ASSERT_EQ(setpoint.hold_ms, 1000);
+
+	ASSERT_TRUE(parsed_parameter);
+	ASSERT_EQ(parameter.id, 2);
+	ASSERT_EQ(parameter.value, 10.0f);
+
+	//anything the wrong length is turned away
+	ASSERT_FALSE(uplink_parse_setpoint(setpoint_payload.data(), setpoint_payload.size() - 1, setpoint));
+	ASSERT_FALSE(uplink_parse_parameter(parameter_payload.data(), 0, parameter));
+	UplinkMissionChunk chunk;
+	ASSERT_FALSE(uplink_parse_mission_chunk(setpoint_payload.data(), UPLINK_MISSION_CHUNK_HEADER_LEN, chunk));
+	ASSERT_FALSE(uplink_parse_mission_chunk(setpoint_payload.data(), setpoint_payload.size() - 1, chunk));
+}
+
+TEST(Uplink, FramesComeApartIntoCommands) {
+
+	/***********************SETUP***********************/
+
+	//a chunk with 0s in its waypoints, so the framing has something to do
+	vector<uint8_t> payload = {3, 0};
+	put_u32(payload, 434726560);
+	put_u32(payload, 0);
+	put_u32(payload, 100000);
+	put_float(payload, 0);
+	vector<uint8_t> frame = encode(UPLINK_MISSION_CHUNK, 17, payload);
+
+	uint8_t buffer[TELEMETRY_MAX_CONTENT_LEN];
+	FrameDecoder decoder(TELEMETRY_FRAMING, buffer, sizeof(buffer));
+
+	/********************STEPTHROUGH********************/
+
+	bool complete;
+	decoder.feed(frame.data(), frame.size(), complete);
+
+	UplinkMissionChunk chunk;
+	bool parsed = uplink_parse_mission_chunk(decoder.packet() + TELEMETRY_HEADER_LEN,
+											 decoder.packet_len() - TELEMETRY_HEADER_LEN, chunk);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_TRUE(complete);
+	ASSERT_EQ(frame.size(), telemetry_frame_len(payload.size()));
+	ASSERT_EQ(decoder.packet()[0], UPLINK_MISSION_CHUNK);
+	ASSERT_EQ(decoder.packet()[1], 17);
+	ASSERT_TRUE(parsed);
+	ASSERT_EQ(chunk.transfer, 3);
+	ASSERT_EQ(chunk.count, 1);
+	ASSERT_EQ(memcmp(chunk.waypoints, &payload[UPLINK_MISSION_CHUNK_HEADER_LEN], UPLINK_WAYPOINT_LEN), 0);
+}
+
+/***********************************************************************************************************************
+ * Missions
+ **********************************************************************************************************************/
+
+static const GeoPosition HOME = {434726560, -805423210, 326789};
+
+static UplinkMissionStart start_of(uint8_t transfer, uint8_t count) {
+	UplinkMissionStart start = {transfer, count, HOME};
+	return start;
+}
+
+//a chunk of count waypoints from first, each one a little further north
+static vector<uint8_t> chunk_payload(uint8_t transfer, uint8_t first, uint8_t count) {
+	vector<uint8_t> payload = {transfer, first};
+	for (uint8_t i = first; i < first + count; i++) {
+		put_u32(payload, (uint32_t) (HOME.latitude + 1000 * i));
+		put_u32(payload, (uint32_t) HOME.longitude);
+		put_u32(payload, (uint32_t) (HOME.altitude_mm + 100000));
+		put_float(payload, 15 + i);
+	}
+	return payload;
+}
+
+static StatusCode add_chunk(UplinkMission &mission, uint8_t transfer, uint8_t first, uint8_t count) {
+	vector<uint8_t> payload = chunk_payload(transfer, first, count);
+	UplinkMissionChunk chunk;
+	if (!uplink_parse_mission_chunk(payload.data(), payload.size(), chunk)) return STATUS_CODE_INVALID_ARGS;
+	return mission.add(chunk);
+}
+
+TEST(UplinkMission, ComesTogetherFromChunks) {
+
+	/***********************SETUP***********************/
+
+	UplinkMission mission;
+	ASSERT_EQ(mission.start(start_of(5, 40)), STATUS_CODE_OK);
+
+	/********************STEPTHROUGH********************/
+
+	ASSERT_EQ(add_chunk(mission, 5, 0, UPLINK_MAX_CHUNK_WAYPOINTS), STATUS_CODE_OK);
+	ASSERT_EQ(mission.finish(5), STATUS_CODE_OUT_OF_RANGE);
+	ASSERT_EQ(add_chunk(mission, 5, UPLINK_MAX_CHUNK_WAYPOINTS, UPLINK_MAX_CHUNK_WAYPOINTS), STATUS_CODE_OK);
+	ASSERT_EQ(add_chunk(mission, 5, 2 * UPLINK_MAX_CHUNK_WAYPOINTS, 40 - 2 * UPLINK_MAX_CHUNK_WAYPOINTS),
+			  STATUS_CODE_OK);
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(mission.received(), 40);
+	ASSERT_EQ(mission.finish(5), STATUS_CODE_OK);
+	ASSERT_EQ(mission.count(), 40);
+	ASSERT_EQ(mission.home().latitude, HOME.latitude);
+	for (uint8_t i = 0; i < 40; i++) {
+		ASSERT_EQ(mission.waypoints()[i].position.latitude, HOME.latitude + 1000 * i);
+		ASSERT_EQ(mission.waypoints()[i].airspeed, 15.0f + i);
+	}
+}
+
+TEST(UplinkMission, LostChunksAndAcksAreSentAgain) {
+
+	/***********************SETUP***********************/
+
+	UplinkMission mission;
+	ASSERT_EQ(mission.start(start_of(1, 20)), STATUS_CODE_OK);
+	ASSERT_EQ(add_chunk(mission, 1, 0, 10), STATUS_CODE_OK);
+
+	/**********************ASSERTS**********************/
+
+	//the start again, because its ack was lost, keeps what's arrived
+	ASSERT_EQ(mission.start(start_of(1, 20)), STATUS_CODE_OK);
+	ASSERT_EQ(mission.received(), 10);
+
+	//a chunk that would leave a gap is turned away, one sent again is fine
+	ASSERT_EQ(add_chunk(mission, 1, 15, 5), STATUS_CODE_OUT_OF_RANGE);
+	ASSERT_EQ(add_chunk(mission, 1, 5, 5), STATUS_CODE_OK);
+	ASSERT_EQ(mission.received(), 10);
+
+	//and nothing from another transfer, or past the end
+	ASSERT_EQ(add_chunk(mission, 2, 10, 5), STATUS_CODE_UNINITIALIZED);
+	ASSERT_EQ(add_chunk(mission, 1, 10, 11), STATUS_CODE_OUT_OF_RANGE);
+	ASSERT_EQ(mission.finish(2), STATUS_CODE_UNINITIALIZED);
+
+	ASSERT_EQ(add_chunk(mission, 1, 10, 10), STATUS_CODE_OK);
+	ASSERT_EQ(mission.finish(1), STATUS_CODE_OK);
+
+	//once it's handed over, the end sent again doesn't hand it over twice, and a new transfer starts from scratch
+	mission.handed_over();
+	ASSERT_TRUE(mission.was_handed_over());
+	ASSERT_EQ(mission.start(start_of(2, 3)), STATUS_CODE_OK);
+	ASSERT_FALSE(mission.was_handed_over());
+	ASSERT_EQ(mission.received(), 0);
+}
+
+TEST(UplinkMission, RejectsMissionsThatCantBeFlown) {
+
+	/***********************SETUP***********************/
+
+	UplinkMission mission;
+
+	/**********************ASSERTS**********************/
+
+	ASSERT_EQ(mission.start(start_of(1, 1)), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(mission.start(start_of(1, PATH_MAX_WAYPOINTS + 1)), STATUS_CODE_INVALID_ARGS);
+	ASSERT_EQ(add_chunk(mission, 1, 0, 1), STATUS_CODE_UNINITIALIZED);
+}
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+Turns binary log records (see Common/Inc/BinaryLog.hpp) back into text. Plain text debug output in the same stream
+is passed through as is.
+
+Usage:
+    decode_log.py [--trace <trace.bin>] <Autopilot_log_strings.bin> [capture file or serial device, stdin if left out]
+
+Scheduler trace dumps (see Common/Inc/RTOSTrace.h) come through as records of their own. With --trace they're saved
+to the given file for trace_to_json.py, otherwise they're left out.
+
+The string table comes out of the build next to the .elf, and has to be from the same build as the firmware that
+produced the log.
+"""
+
+import re
+import struct
+import sys
+
+SYNC = 0xFE
+HEADER_LEN = 4
+MAX_ARGS_LEN = 64
+DROPPED_ID = 0xFFFF
+TRACE_ID = 0xFFFE
+
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])')
+
+
+def load_strings(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+def format_string(table, string_id):
+    if string_id >= len(table):
+        return None
+    end = table.find(b'\0', string_id)
+    if end < 0:
+        return None
+    return table[string_id:end].decode('ascii', errors='replace')
+
+
+def format_record(fmt, args):
+    """printf's the packed arguments, pulling each one out the way the firmware packed it"""
+    out = []
+    pos = 0
+    last = 0
+
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[last:match.start()])
+        last = match.end()
+        flags, length, conversion = match.groups()
+
+        if conversion == '%':
+            out.append('%')
+            continue
+
+        if conversion == 's':
+            n = args[pos]
+            value = args[pos + 1:pos + 1 + n].decode('ascii', errors='replace')
+            pos += 1 + n
+        elif conversion in 'fFeEgG':
+            value = struct.unpack_from('<f', args, pos)[0]
+            pos += 4
+        elif length == 'll':
+            value = struct.unpack_from('<q' if conversion in 'di' else '<Q', args, pos)[0]
+            pos += 8
+        else:
+            value = struct.unpack_from('<i' if conversion in 'di' else '<I', args, pos)[0]
+            pos += 4
+
+        if conversion == 'p':
+            out.append('0x%08x' % value)
+        elif conversion == 'c':
+            out.append(chr(value & 0xFF))
+        else:
+            out.append(('%' + flags + conversion) % value)
+
+    out.append(fmt[last:])
+    return ''.join(out)
+
+
+def decode(stream, table, write, trace=None):
+    """Reads the stream a byte at a time, so it also works on a live serial port"""
+    text = bytearray()
+
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+
+        if byte[0] != SYNC:
+            text += byte
+            continue
+
+        if text:
+            write(text.decode('ascii', errors='replace'))
+            text.clear()
+
+        header = stream.read(HEADER_LEN - 1)
+        if len(header) < HEADER_LEN - 1:
+            break
+
+        length, string_id = header[0], header[1] | (header[2] << 8)
+        if length > MAX_ARGS_LEN:
+            write('<bad record, resyncing>\r\n')
+            continue
+
+        args = stream.read(length)
+        if len(args) < length:
+            break
+
+        if string_id == TRACE_ID:
+            if trace is not None:
+                trace.write(args)
+                trace.flush()
+            continue
+
+        if string_id == DROPPED_ID:
+            write('<%d log records dropped>\r\n' % struct.unpack_from('<I', args)[0])
+            continue
+
+        fmt = format_string(table, string_id)
+        if fmt is None:
+            write('<unknown log id %d, is the string table from this build?>\r\n' % string_id)
+            continue
+
+        try:
+            write(format_record(fmt, args) + '\r\n')
+        except (struct.error, IndexError, TypeError, ValueError):
+            write('<arguments don\'t match "%s">\r\n' % fmt)
+
+    if text:
+        write(text.decode('ascii', errors='replace'))
+
+
+def main():
+    args = sys.argv[1:]
+    trace = None
+
+    if len(args) >= 2 and args[0] == '--trace':
+        trace = open(args[1], 'wb')
+        args = args[2:]
+
+    if len(args) < 1:
+        print(__doc__)
+        sys.exit(1)
+
+    table = load_strings(args[0])
+
+    def write(line):
+        sys.stdout.write(line)
+        sys.stdout.flush()
+
+    try:
+        if len(args) > 1:
+            with open(args[1], 'rb', buffering=0) as stream:
+                decode(stream, table, write, trace)
+        else:
+            decode(sys.stdin.buffer, table, write, trace)
+    finally:
+        if trace is not None:
+            trace.close()
+
+
+if __name__ == '__main__':
+    main()
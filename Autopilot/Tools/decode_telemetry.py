@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+Turns the binary telemetry stream (see Autopilot/Inc/Telemetry.hpp) into one line of text per message, and keeps
+count of frames that went missing or arrived damaged.
+
+Usage:
+    decode_telemetry.py [--stats] [capture file or serial device, stdin if left out]
+
+With --stats, how many of each message arrived, how many bytes, and how many were lost are printed at the end.
+"""
+
+import struct
+import sys
+
+HEADER_LEN = 2
+CRC_LEN = 2
+MAX_FRAME_LEN = 256  # code byte, 254 bytes of content and the 0
+
+HEARTBEAT, ATTITUDE, GPS, GEOFENCE, TASKS, INTERCHIP = range(6)
+NAMES = ['heartbeat', 'attitude', 'gps', 'geofence', 'tasks', 'interchip']
+ACK = 0x80  # answers to uplink commands, outside the scheduled ids
+
+UPLINK_NAMES = {0x40: 'setpoint', 0x41: 'param set', 0x42: 'mission start', 0x43: 'mission chunk', 0x44: 'mission end'}
+STATUS_NAMES = ['ok', 'unknown', 'invalid args', 'resource exhausted', 'unreachable', 'timeout', 'empty',
+                'out of range', 'unimplemented', 'uninitialized', 'internal error']
+
+FLAGS = ['planner busy', 'gps fix', 'geofence active', 'geofence breached']
+TASK_NAME_LEN = 8
+GEOFENCE_ALTITUDE = 0xFF
+INTERCHIP_RTT_BUCKETS = 8
+INTERCHIP_RTT_FIRST_BUCKET_US = 500
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, the same as Common/Src/Checksum.cpp"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    """frame is everything before the 0. None if it isn't valid"""
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def format_flags(flags):
+    names = [name for bit, name in enumerate(FLAGS) if flags & (1 << bit)]
+    return ', '.join(names) if names else 'none'
+
+
+def format_payload(message_id, payload):
+    if message_id == HEARTBEAT:
+        uptime, heap, cpu, alarms, flags = struct.unpack('<IIHBB', payload)
+        return 'up %.1fs, heap free %d, cpu %.1f%%, alarms 0x%x, flags: %s' % (
+            uptime / 1000.0, heap, cpu / 10.0, alarms, format_flags(flags))
+
+    if message_id == ATTITUDE:
+        roll, pitch, yaw, roll_rate, pitch_rate, yaw_rate, airspeed = struct.unpack('<7f', payload)
+        return 'roll %.3f pitch %.3f yaw %.3f rad, rates %.3f %.3f %.3f rad/s, airspeed %.1f m/s' % (
+            roll, pitch, yaw, roll_rate, pitch_rate, yaw_rate, airspeed)
+
+    if message_id == GPS:
+        (lat, lon, alt, north, east, down, h_acc, v_acc, heading, satellites, fix,
+         received_ms) = struct.unpack('<iii5fhBBI', payload)
+        return '%.7f %.7f %.3fm, velocity %.2f %.2f %.2f m/s, accuracy %.1f/%.1fm, heading %d, %d sats, fix %d, ' \
+               'at %dms' % (lat * 1e-7, lon * 1e-7, alt / 1000.0, north, east, down, h_acc, v_acc, heading,
+                            satellites, fix, received_ms)
+
+    if message_id == GEOFENCE:
+        breached, zone, margin = struct.unpack('<BBf', payload)
+        zone_name = 'altitude' if zone == GEOFENCE_ALTITUDE else 'zone %d' % zone
+        return '%s, %.1fm from %s' % ('BREACHED' if breached else 'inside', margin, zone_name)
+
+    if message_id == TASKS:
+        count = payload[0]
+        tasks = []
+        for i in range(count):
+            number, name, stack, cpu = struct.unpack_from('<B%dsHH' % TASK_NAME_LEN, payload,
+                                                          1 + i * (5 + TASK_NAME_LEN))
+            name = name.rstrip(b'\0').decode('ascii', errors='replace')
+            tasks.append('%d %s stack %d cpu %.1f%%' % (number, name, stack, cpu / 10.0))
+        return '; '.join(tasks)
+
+    if message_id == INTERCHIP:
+        local = struct.unpack_from('<%dI' % (9 + INTERCHIP_RTT_BUCKETS), payload)
+        (sent, received, crc_failures, gaps, late, overruns, errors, last_rtt, max_rtt) = local[:9]
+        buckets = ['<%dus %d' % (INTERCHIP_RTT_FIRST_BUCKET_US << i, count)
+                   for i, count in enumerate(local[9:-1])]
+        buckets.append('rest %d' % local[-1])
+        remote_crc, remote_gaps, remote_late = struct.unpack_from('<3H', payload, 4 * len(local))
+        return 'sent %d, received %d, crc failures %d, gaps %d, late %d, overruns %d, errors %d, rtt %dus ' \
+               '(max %dus, %s); safety chip: crc failures %d, gaps %d, late %d' % (
+                   sent, received, crc_failures, gaps, late, overruns, errors, last_rtt, max_rtt, ', '.join(buckets),
+                   remote_crc, remote_gaps, remote_late)
+
+    if message_id == ACK:
+        command, sequence, status, detail = struct.unpack('<BBBB', payload)
+        command_name = UPLINK_NAMES.get(command, 'command %d' % command)
+        status_name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else 'status %d' % status
+        return '%s %d: %s, %d waypoints in' % (command_name, sequence, status_name, detail)
+
+    return None
+
+
+class Stats:
+    def __init__(self):
+        self.messages = [0] * len(NAMES)
+        self.acks = 0
+        self.bytes = 0
+        self.damaged = 0
+        self.lost = 0
+        self.last_sequence = None
+
+    def sequence(self, sequence):
+        if self.last_sequence is not None:
+            self.lost += (sequence - self.last_sequence - 1) & 0xFF
+        self.last_sequence = sequence
+
+    def summary(self):
+        lines = ['%d bytes' % self.bytes]
+        lines += ['%-10s %d' % (name, count) for name, count in zip(NAMES, self.messages)]
+        lines.append('%-10s %d' % ('ack', self.acks))
+        lines.append('lost %d, damaged %d' % (self.lost, self.damaged))
+        return '\n'.join(lines) + '\n'
+
+
+def decode_frame(frame, stats):
+    """A line for one frame, the 0 at its end already taken off"""
+    content = cobs_decode(frame)
+    if content is None or len(content) < HEADER_LEN + CRC_LEN:
+        stats.damaged += 1
+        return '<damaged frame>'
+
+    body, crc = content[:-CRC_LEN], struct.unpack('<H', content[-CRC_LEN:])[0]
+    if crc16_ccitt(body) != crc:
+        stats.damaged += 1
+        return '<bad crc>'
+
+    message_id, sequence = body[0], body[1]
+    stats.sequence(sequence)
+
+    try:
+        text = format_payload(message_id, body[HEADER_LEN:])
+    except (struct.error, IndexError):
+        text = None
+    if text is None:
+        return '<%d: unknown message %d, %d bytes>' % (sequence, message_id, len(body) - HEADER_LEN)
+
+    if message_id == ACK:
+        stats.acks += 1
+        return '%3d %-10s %s' % (sequence, 'ack', text)
+
+    stats.messages[message_id] += 1
+    return '%3d %-10s %s' % (sequence, NAMES[message_id], text)
+
+
+def decode(stream, write, stats):
+    """Reads the stream a byte at a time, so it also works on a live serial port"""
+    frame = bytearray()
+
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+        stats.bytes += 1
+
+        if byte[0] != 0:
+            frame += byte
+            if len(frame) > MAX_FRAME_LEN:
+                # joined the stream partway through something that isn't telemetry, wait for the next 0
+                frame.clear()
+                stats.damaged += 1
+            continue
+
+        if frame:
+            write(decode_frame(bytes(frame), stats) + '\n')
+            frame.clear()
+
+
+def main():
+    args = sys.argv[1:]
+    show_stats = False
+
+    if args and args[0] == '--stats':
+        show_stats = True
+        args = args[1:]
+
+    if args and args[0] in ('-h', '--help'):
+        print(__doc__)
+        sys.exit(1)
+
+    stats = Stats()
+
+    def write(line):
+        sys.stdout.write(line)
+        sys.stdout.flush()
+
+    try:
+        if args:
+            with open(args[0], 'rb', buffering=0) as stream:
+                decode(stream, write, stats)
+        else:
+            decode(sys.stdin.buffer, write, stats)
+    except KeyboardInterrupt:
+        pass
+
+    if show_stats:
+        sys.stdout.write(stats.summary())
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""
+Turns a scheduler trace dump (see Common/Inc/RTOSTrace.h) into Chrome trace JSON, which chrome://tracing and
+ui.perfetto.dev can both open.
+
+Usage:
+    trace_to_json.py <trace.bin> [output.json, stdout if left out]
+
+trace.bin is what decode_log.py --trace saved. If it holds more than one dump, each becomes its own process in the
+timeline.
+
+Every task gets a track showing when it was running, with its queue, semaphore and mutex operations marked on it.
+Interrupts share a track of their own, and kernel ticks are marked on a third.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b'RTRC'
+VERSION = 1
+HEADER = struct.Struct('<4sBBHII')
+NAME_LEN = 16
+NAME_ENTRY = struct.Struct('<BB%ds' % NAME_LEN)
+RECORD = struct.Struct('<IBBH')
+
+(TASK_CREATE, TASK_SWITCHED_IN, TASK_SWITCHED_OUT, TICK, ISR_ENTER, ISR_EXIT, QUEUE_CREATE, QUEUE_SEND,
+ QUEUE_RECEIVE, QUEUE_SEND_FROM_ISR, QUEUE_RECEIVE_FROM_ISR, QUEUE_BLOCK_SEND, QUEUE_BLOCK_RECEIVE) = range(13)
+
+NAME_TASK, NAME_QUEUE, NAME_ISR = range(3)
+
+# FreeRTOS queue types, the argument of queue events
+QUEUE_TYPES = {0: 'queue', 1: 'mutex', 2: 'semaphore', 3: 'semaphore', 4: 'mutex'}
+
+QUEUE_ACTIONS = {
+    QUEUE_SEND: ('send', 'give'),
+    QUEUE_RECEIVE: ('receive', 'take'),
+    QUEUE_SEND_FROM_ISR: ('send from isr', 'give from isr'),
+    QUEUE_RECEIVE_FROM_ISR: ('receive from isr', 'take from isr'),
+    QUEUE_BLOCK_SEND: ('blocked sending', 'blocked giving'),
+    QUEUE_BLOCK_RECEIVE: ('blocked receiving', 'blocked taking'),
+}
+
+ISR_TID = 1
+TICK_TID = 2
+TASK_TID_BASE = 100
+
+# cortex m exceptions below the first external interrupt
+EXCEPTIONS = {2: 'NMI', 3: 'HardFault', 4: 'MemManage', 5: 'BusFault', 6: 'UsageFault', 11: 'SVCall',
+              14: 'PendSV', 15: 'SysTick'}
+
+
+def parse_dumps(data):
+    """Finds every dump in the file. Anything around them is skipped"""
+    dumps = []
+    pos = data.find(MAGIC)
+
+    while pos >= 0 and pos + HEADER.size <= len(data):
+        magic, version, name_count, _, record_count, frequency = HEADER.unpack_from(data, pos)
+        end = pos + HEADER.size + name_count * NAME_ENTRY.size + record_count * RECORD.size
+
+        if version != VERSION or end > len(data) or frequency == 0:
+            pos = data.find(MAGIC, pos + 1)
+            continue
+
+        offset = pos + HEADER.size
+        names = {}
+        for _ in range(name_count):
+            kind, ident, name = NAME_ENTRY.unpack_from(data, offset)
+            names[(kind, ident)] = name.split(b'\0', 1)[0].decode('ascii', errors='replace')
+            offset += NAME_ENTRY.size
+
+        records = [RECORD.unpack_from(data, offset + i * RECORD.size) for i in range(record_count)]
+        dumps.append((frequency, names, records))
+        pos = data.find(MAGIC, end)
+
+    return dumps
+
+
+def isr_name(names, number):
+    if (NAME_ISR, number) in names:
+        return names[(NAME_ISR, number)]
+    if number in EXCEPTIONS:
+        return EXCEPTIONS[number]
+    return 'IRQ %d' % (number - 16)
+
+
+def convert(pid, frequency, names, records):
+    events = [{'name': 'process_name', 'ph': 'M', 'pid': pid, 'args': {'name': 'Autopilot trace %d' % pid}},
+              {'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': ISR_TID, 'args': {'name': 'Interrupts'}},
+              {'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': TICK_TID, 'args': {'name': 'Ticks'}}]
+
+    def task_name(ident):
+        return names.get((NAME_TASK, ident), 'task %d' % ident)
+
+    def queue_name(ident):
+        return names.get((NAME_QUEUE, ident), '#%d' % ident)
+
+    tasks_seen = set()
+
+    def task_tid(ident):
+        if ident not in tasks_seen:
+            tasks_seen.add(ident)
+            events.append({'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': TASK_TID_BASE + ident,
+                           'args': {'name': task_name(ident)}})
+        return TASK_TID_BASE + ident
+
+    # timestamps are a 32 bit cycle count, so unwrap them as they go. Ticks make sure it never goes a whole wrap
+    # without a record
+    cycles = 0
+    previous = records[0][0] if records else 0
+
+    running = None
+    running_since = 0
+    isr_stack = []
+
+    for timestamp, event, ident, arg in records:
+        cycles += (timestamp - previous) & 0xFFFFFFFF
+        previous = timestamp
+        now = cycles * 1e6 / frequency
+
+        if event == TASK_SWITCHED_IN:
+            running = ident
+            running_since = now
+        elif event == TASK_SWITCHED_OUT:
+            start = running_since if running == ident else 0.0
+            events.append({'name': task_name(ident), 'cat': 'task', 'ph': 'X', 'pid': pid, 'tid': task_tid(ident),
+                           'ts': start, 'dur': now - start})
+            running = None
+        elif event == ISR_ENTER:
+            isr_stack.append((ident, now))
+        elif event == ISR_EXIT:
+            start = now
+            while isr_stack:
+                number, entered = isr_stack.pop()
+                if number == ident:
+                    start = entered
+                    break
+            events.append({'name': isr_name(names, ident), 'cat': 'isr', 'ph': 'X', 'pid': pid, 'tid': ISR_TID,
+                           'ts': start, 'dur': now - start})
+        elif event == TICK:
+            events.append({'name': 'tick', 'cat': 'tick', 'ph': 'i', 's': 't', 'pid': pid, 'tid': TICK_TID,
+                           'ts': now, 'args': {'tick': arg}})
+        elif event == TASK_CREATE:
+            events.append({'name': 'created', 'cat': 'task', 'ph': 'i', 's': 't', 'pid': pid,
+                           'tid': task_tid(ident), 'ts': now})
+        elif event == QUEUE_CREATE:
+            events.append({'name': '%s %s created' % (QUEUE_TYPES.get(arg, 'queue'), queue_name(ident)),
+                           'cat': 'queue', 'ph': 'i', 's': 'p', 'pid': pid, 'ts': now})
+        elif event in QUEUE_ACTIONS:
+            kind = QUEUE_TYPES.get(arg, 'queue')
+            action = QUEUE_ACTIONS[event][0 if kind == 'queue' else 1]
+            if isr_stack or event in (QUEUE_SEND_FROM_ISR, QUEUE_RECEIVE_FROM_ISR) or running is None:
+                tid = ISR_TID
+            else:
+                tid = task_tid(running)
+            events.append({'name': '%s %s %s' % (action, kind, queue_name(ident)), 'cat': 'queue', 'ph': 'i',
+                           's': 't', 'pid': pid, 'tid': tid, 'ts': now})
+
+    # whatever was running when the trace was paused
+    if running is not None:
+        events.append({'name': task_name(running), 'cat': 'task', 'ph': 'X', 'pid': pid, 'tid': task_tid(running),
+                       'ts': running_since, 'dur': cycles * 1e6 / frequency - running_since})
+
+    return events
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1], 'rb') as f:
+        dumps = parse_dumps(f.read())
+
+    if not dumps:
+        sys.stderr.write('no trace dumps found in %s\n' % sys.argv[1])
+        sys.exit(1)
+
+    events = []
+    for pid, (frequency, names, records) in enumerate(dumps, 1):
+        events += convert(pid, frequency, names, records)
+
+    trace = {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
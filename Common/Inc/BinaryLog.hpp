@@ -0,0 +1,225 @@
+/**
+ * Deferred binary logging. Instead of formatting a message with sprintf where it's logged, a call site only stores
+ * the id of its format string and the raw bytes of its arguments on a ring. A low priority task drains the ring out of
+ * the debug port, and the host turns the records back into text with Autopilot/Tools/decode_log.py.
+ *
+ * Format strings are put in the .log_strings section, which the linker scripts keep out of flash and place at
+ * address 0. A string's address is its id, so ids are fixed at link time and the build extracts the section into
+ * log_strings.bin for the decoder. The strings themselves are never read on the chip.
+ *
+ * Records on the wire are:
+ *
+ *  [0]      BINARY_LOG_SYNC. Never a valid ASCII character, so records can be mixed in with plain text debug output
+ *  [1]      length of the argument bytes
+ *  [2-3]    format string id, little endian
+ *  [4-]     arguments, little endian. Integers up to 32 bits and floats take 4 bytes, 64 bit integers 8, and strings
+ *           a length byte followed by up to BINARY_LOG_MAX_STRING_LEN characters (copied, so they can be temporaries)
+ *
+ * Logging is safe from interrupts. A call costs packing the arguments plus a short critical section to copy them on
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+#include "ByteRing.hpp"
+#include "Status.hpp"
+
+static const uint8_t BINARY_LOG_SYNC = 0xFE;
+static const size_t BINARY_LOG_HEADER_LEN = 4;
+static const size_t BINARY_LOG_MAX_ARGS_LEN = 64;
+static const size_t BINARY_LOG_MAX_STRING_LEN = 32;
+
+//reserved id for the record that says how many records were thrown away because the ring was full. Its argument is
+//a 4 byte count
+static const uint16_t BINARY_LOG_DROPPED_ID = 0xFFFF;
+
+//reserved id for chunks of a scheduler trace dump (see RTOSTrace.h). The arguments are the raw bytes of the dump,
+//which decode_log.py pulls back out into a file
+static const uint16_t BINARY_LOG_TRACE_ID = 0xFFFE;
+
+#define BINARY_LOG_STRING_SECTION __attribute__((section(".log_strings"), used))
+
+/**
+ * Logs a printf style message. Only the format's id and the arguments are stored, the format must be a string literal
+ */
+#define BINARY_LOG(fmt, ...) do { \
+	static const char binary_log_format[] BINARY_LOG_STRING_SECTION = fmt; \
+	binary_log((uint16_t) (uintptr_t) binary_log_format, ##__VA_ARGS__); \
+} while (0)
+
+#define LOG_DEBUG(fmt, ...) BINARY_LOG("[DEBUG] " fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...) BINARY_LOG("[INFO] " fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) BINARY_LOG("[ERROR] " fmt, ##__VA_ARGS__)
+
+/**
+ * Ring of framed log records. Any number of producers can write(), as long as they don't preempt each other (the
+ * chip's binary_log_write() wraps it in a critical section). One consumer drains it with peek() and consume()
+ */
+class BinaryLog {
+ public:
+	BinaryLog();
+
+	/**
+	 * @param storage Must stay valid for as long as the log is used
+	 * @param capacity Size of storage. Must be a power of two
+	 * @return STATUS_CODE_INVALID_ARGS if capacity isn't a power of two
+	 */
+	StatusCode init(uint8_t *storage, uint32_t capacity);
+
+	/**
+	 * Frames a record onto the ring. If records were dropped since the last write that went through, a record saying
+	 * how many is written first
+	 * @param id Format string id
+	 * @param args Packed arguments
+	 * @param len No more than BINARY_LOG_MAX_ARGS_LEN
+	 * @return false if there wasn't room, in which case the record is counted as dropped
+	 */
+	bool write(uint16_t id, const uint8_t *args, uint8_t len);
+
+	/**
+	 * Like write(), but leaves the record out without counting it as dropped if there isn't room. For writers that
+	 * would rather wait for the ring to drain
+	 * @param id
+	 * @param args
+	 * @param len
+	 * @return false if there wasn't room
+	 */
+	bool try_write(uint16_t id, const uint8_t *args, uint8_t len);
+
+	/**
+	 * Gets the largest contiguous region of framed bytes waiting to be sent. Records can be split across regions
+	 * @param data Set to where the region starts
+	 * @return Length of the region
+	 */
+	size_t peek(const uint8_t *&data) const { return ring.peek(data); }
+
+	/**
+	 * Releases bytes that were peek()ed at, once they've been sent
+	 * @param len
+	 */
+	void consume(size_t len) { ring.consume(len); }
+
+	/**
+	 * @return Total records thrown away because the ring was full
+	 */
+	uint32_t get_dropped() const { return total_dropped; }
+
+ private:
+	ByteRing ring;
+	uint32_t unreported_dropped;
+	uint32_t total_dropped;
+
+	bool write_record(uint16_t id, const uint8_t *args, uint8_t len);
+};
+
+/**
+ * Puts a record on the chip's log ring. Safe to call from interrupts. Use the LOG_ macros rather than calling this
+ * @param id
+ * @param args
+ * @param len
+ */
+void binary_log_write(uint16_t id, const uint8_t *args, uint8_t len);
+
+/**
+ * Puts a record on the chip's log ring only if it fits, see BinaryLog::try_write(). Safe to call from interrupts
+ * @param id
+ * @param args
+ * @param len
+ * @return false if the ring was too full
+ */
+bool binary_log_try_write(uint16_t id, const uint8_t *args, uint8_t len);
+
+/**
+ * Sends as much of the log ring out of the debug port as it'll currently take. Call regularly from a low priority
+ * task, or the main loop on chips without an RTOS
+ */
+extern "C" void binary_log_flush(void);
+
+/******************************************* Argument packing *******************************************/
+
+//bytes an argument can take up once packed, used to size the buffer on the stack
+template <typename T, typename Enable = void>
+struct BinaryLogArgSize {
+	static const size_t value = sizeof(T) > 4 ? 8 : 4;
+};
+
+template <typename T>
+struct BinaryLogArgSize<T, typename std::enable_if<std::is_pointer<T>::value>::type> {
+	static const size_t value = 1 + BINARY_LOG_MAX_STRING_LEN;
+};
+
+template <typename... Args>
+struct BinaryLogArgsSize;
+
+template <>
+struct BinaryLogArgsSize<> {
+	static const size_t value = 0;
+};
+
+template <typename T, typename... Rest>
+struct BinaryLogArgsSize<T, Rest...> {
+	static const size_t value = BinaryLogArgSize<T>::value + BinaryLogArgsSize<Rest...>::value;
+};
+
+template <typename T>
+inline typename std::enable_if<(std::is_integral<T>::value || std::is_enum<T>::value) && sizeof(T) <= 4, uint8_t *>::type
+binary_log_pack_arg(uint8_t *out, T value) {
+	uint32_t word = std::is_signed<T>::value ? (uint32_t) (int32_t) value : (uint32_t) value;
+	memcpy(out, &word, 4);
+	return out + 4;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 4), uint8_t *>::type
+binary_log_pack_arg(uint8_t *out, T value) {
+	uint64_t word = (uint64_t) value;
+	memcpy(out, &word, 8);
+	return out + 8;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint8_t *>::type
+binary_log_pack_arg(uint8_t *out, T value) {
+	float word = (float) value;
+	memcpy(out, &word, 4);
+	return out + 4;
+}
+
+inline uint8_t *binary_log_pack_arg(uint8_t *out, const char *string) {
+	uint8_t len = 0;
+	if (string != nullptr) {
+		while (len < BINARY_LOG_MAX_STRING_LEN && string[len] != '\0') len++;
+	}
+
+	*out = len;
+	if (len > 0) memcpy(out + 1, string, len);
+	return out + 1 + len;
+}
+
+inline uint8_t *binary_log_pack(uint8_t *out) {
+	return out;
+}
+
+/**
+ * Packs arguments in the order they're given
+ * @return One past the last byte written
+ */
+template <typename T, typename... Rest>
+inline uint8_t *binary_log_pack(uint8_t *out, T value, Rest... rest) {
+	out = binary_log_pack_arg(out, value);
+	return binary_log_pack(out, rest...);
+}
+
+template <typename... Args>
+inline void binary_log(uint16_t id, Args... args) {
+	static_assert(BinaryLogArgsSize<Args...>::value <= BINARY_LOG_MAX_ARGS_LEN, "Too many log arguments");
+
+	uint8_t packed[BinaryLogArgsSize<Args...>::value + 1];
+	uint8_t *end = binary_log_pack(packed, args...);
+	binary_log_write(id, packed, (uint8_t) (end - packed));
+}
@@ -0,0 +1,135 @@
+/**
+ * Fixed size, lock free byte ring for passing data between exactly one producer and one consumer, like an
+ * interrupt handler and a task. Nothing is ever allocated or resized; the owner hands in the storage once.
+ *
+ * head and tail are free running counters that only ever go up, and the capacity is a power of two, so an index
+ * is just a mask and the fill level is head - tail even after they wrap. Only the producer writes head and only
+ * the consumer writes tail, so plain atomic loads and stores are enough (no read-modify-write instructions,
+ * which the Cortex-M0 doesn't have).
+ *
+ * Bulk push()/pop() copy with at most two memcpys. For parsers and DMA that want to work in place, peek() and
+ * reserve() hand out the largest contiguous region, which is released with consume() and commit()
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "Status.hpp"
+
+//ATOMIC_INT_LOCK_FREE is only 1 on the Cortex-M0, since it can't compare-and-swap. The ring doesn't need that, just
+//loads and stores of head and tail that happen in one go, which any aligned word is
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && alignof(std::atomic<uint32_t>) == alignof(uint32_t),
+			  "ByteRing needs head and tail to be plain aligned words");
+
+class ByteRing {
+ public:
+	ByteRing();
+
+	/**
+	 * Only call this while neither side is using the ring
+	 * @param storage Must stay valid for as long as the ring is used
+	 * @param capacity Size of storage. Must be a power of two
+	 * @return STATUS_CODE_INVALID_ARGS if capacity isn't a power of two
+	 */
+	StatusCode init(uint8_t *storage, uint32_t capacity);
+
+	/******************************************* Producer side *******************************************/
+
+	/**
+	 * Copies in as much of data as there is space for
+	 * @return Number of bytes pushed
+	 */
+	size_t push(const uint8_t *data, size_t len);
+
+	/**
+	 * @return false if the ring is full
+	 */
+	bool push(uint8_t byte);
+
+	/**
+	 * Gets the largest contiguous free region, so data can be written straight into the ring
+	 * @param data Set to where the region starts
+	 * @return Length of the region. Can be less than space() if the free space wraps around the end
+	 */
+	size_t reserve(uint8_t *&data);
+
+	/**
+	 * Gets all the free space, which wraps around the end when it's split in two
+	 * @param first Set to where the free space starts
+	 * @param second Set to the start of the storage, where the rest of it is
+	 * @param second_len Set to the length of the rest of it, 0 if it doesn't wrap
+	 * @return Length of the first region
+	 */
+	size_t reserve(uint8_t *&first, uint8_t *&second, size_t &second_len);
+
+	/**
+	 * Makes bytes written into reserve()d space visible to the consumer
+	 * @param len No more than what reserve() handed out
+	 */
+	void commit(size_t len);
+
+	/**
+	 * @return Bytes that can be pushed right now
+	 */
+	size_t space() const;
+
+	/******************************************* Consumer side *******************************************/
+
+	/**
+	 * Copies out up to len bytes
+	 * @return Number of bytes popped
+	 */
+	size_t pop(uint8_t *data, size_t len);
+
+	/**
+	 * @return false if the ring is empty
+	 */
+	bool pop(uint8_t &byte);
+
+	/**
+	 * Gets the largest contiguous region of unread data, so it can be parsed in place
+	 * @param data Set to where the region starts
+	 * @return Length of the region. Can be less than size() if the data wraps around the end
+	 */
+	size_t peek(const uint8_t *&data) const;
+
+	/**
+	 * Same as above, for parsers that rewrite the data where it is, like decoding a frame over the top of itself. The
+	 * bytes are the consumer's until they're consumed, so nothing else can be using them
+	 */
+	size_t peek(uint8_t *&data);
+
+	/**
+	 * Releases bytes that were peek()ed at
+	 * @param len No more than size()
+	 */
+	void consume(size_t len);
+
+	/**
+	 * Throws away everything that's currently in the ring
+	 */
+	void clear();
+
+	/******************************************* Either side *******************************************/
+
+	/**
+	 * @return Bytes waiting to be popped. Exact from the consumer's side, a lower bound from the producer's
+	 */
+	size_t size() const;
+
+	size_t capacity() const { return mask + 1; }
+
+	bool empty() const { return size() == 0; }
+
+ private:
+	uint8_t *buffer;
+	uint32_t mask;
+	std::atomic<uint32_t> head; //total bytes ever pushed
+	std::atomic<uint32_t> tail; //total bytes ever popped
+
+	size_t unread_run(uint8_t *&data) const;
+};
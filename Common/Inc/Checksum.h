@@ -0,0 +1,42 @@
+/**
+ * Checksums shared by the protocols running between the chips and the ground
+ *
+ * The CRC uses a 16 entry table (one nibble at a time), which keeps it small enough for the safety chip
+ * while still being a lot faster than going bit by bit
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+//use C interface so that the C drivers and the FreeRTOS tasks can use these too
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CRC16_CCITT_INIT 0xFFFF
+
+/**
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection, no final xor)
+ * @param data
+ * @param len Number of bytes
+ * @return
+ */
+uint16_t crc16_ccitt(const void *data, size_t len);
+
+/**
+ * Same as above, but continues on from a previous crc so data can be fed in pieces
+ * @param crc CRC16_CCITT_INIT for the first piece, then the result of the previous call
+ * @param data
+ * @param len
+ * @return
+ */
+uint16_t crc16_ccitt_update(uint16_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -45,11 +45,29 @@ uint32_t get_lsi_clock();
 uint32_t get_system_time();
 
 /**
- * Get system time since boot in us
+ * Get system time since boot in us. Never goes backwards, and is safe to call from any task or interrupt.
+ *
+ * On the stm32f7 this is a 32 bit timer counting at 1MHz, extended to 64 bits with a TimebaseExtender. On the stm32f0
+ * it's the ms tick plus the systick count, scaled with a multiply
  * @return
  */
 uint64_t get_system_time_us();
 
+/**
+ * Reads the free running cycle counter. It wraps every 2^32 cycles (about 20s on the autopilot), so only use it to
+ * time things shorter than that, by subtracting two readings as unsigned 32 bit values
+ *
+ * On the stm32f7 this is the DWT cycle counter, which costs a single load. The stm32f0 (cortex m0) has no DWT, so
+ * it's built from the systick count and the ms tick instead
+ * @return Cycles since boot, modulo 2^32
+ */
+uint32_t get_cycle_count();
+
+/**
+ * @return Rate get_cycle_count() counts at, in Hz
+ */
+uint32_t get_cycle_count_frequency();
+
 /**
  * Block for a certain amount of ms
  * @param ms
@@ -0,0 +1,164 @@
+/**
+ * Cycle accurate profiling for C++ code. Each CycleProfiler times a section with get_cycle_count() and keeps the
+ * count, total, min and max, plus a log scale histogram that percentiles are estimated from. Recording a sample is
+ * a handful of integer adds and compares and a count leading zeros, so profilers can be left in hot paths and ISRs.
+ * Anything that divides (the mean, the conversion to us) is only done when stats are read.
+ *
+ * Buckets split every power of two into 2^CYCLE_PROFILER_SUB_BUCKET_BITS equal parts, so a percentile is off by at
+ * most a quarter of its value. Values below 2^CYCLE_PROFILER_SUB_BUCKET_BITS get a bucket each.
+ *
+ * Every profiler adds itself to a registry when constructed, so they can all be printed or reset at once. Create
+ * them at startup (usually as statics), since the registry isn't locked. A profiler shouldn't be recorded to from
+ * two contexts that can preempt each other, give each its own
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Clock.hpp"
+
+static const uint8_t CYCLE_PROFILER_SUB_BUCKET_BITS = 2;
+static const uint8_t CYCLE_PROFILER_SUB_BUCKETS = 1 << CYCLE_PROFILER_SUB_BUCKET_BITS;
+static const uint8_t CYCLE_PROFILER_NUM_BUCKETS = (32 - CYCLE_PROFILER_SUB_BUCKET_BITS + 1) * CYCLE_PROFILER_SUB_BUCKETS;
+
+class CycleProfiler {
+ public:
+	/**
+	 * @param name What the profiler is printed as. Must outlive the profiler, a string literal is best
+	 */
+	explicit CycleProfiler(const char *name);
+
+	~CycleProfiler();
+
+	CycleProfiler(const CycleProfiler &) = delete;
+	CycleProfiler &operator=(const CycleProfiler &) = delete;
+
+	void start() { started_at = get_cycle_count(); }
+
+	/**
+	 * Records the cycles since the last start()
+	 */
+	void stop() { record(get_cycle_count() - started_at); }
+
+	inline void record(uint32_t cycles) {
+		count++;
+		total += cycles;
+		latest = cycles;
+		if (cycles > max) max = cycles;
+		if (cycles < min) min = cycles;
+		histogram[bucket_for(cycles)]++;
+	}
+
+	void reset();
+
+	const char *get_name() const { return name; }
+
+	uint32_t get_count() const { return count; }
+
+	uint64_t get_total() const { return total; }
+
+	uint32_t get_latest() const { return latest; }
+
+	uint32_t get_max() const { return max; }
+
+	/**
+	 * @return 0 if nothing has been recorded
+	 */
+	uint32_t get_min() const { return count > 0 ? min : 0; }
+
+	/**
+	 * @return Mean cycles per sample. Divides, so don't call it where recording happens
+	 */
+	uint32_t get_mean() const;
+
+	/**
+	 * Estimates a percentile from the histogram, as the upper edge of the bucket it falls in (kept within min and max)
+	 * @param percent 0 - 100
+	 * @return Cycles, or 0 if nothing has been recorded
+	 */
+	uint32_t get_percentile(uint8_t percent) const;
+
+	uint32_t get_bucket_count(uint8_t bucket) const { return histogram[bucket]; }
+
+	/**
+	 * Prints a one line summary, in cycles and us
+	 * @param buffer
+	 * @param len Size of buffer
+	 * @return Number of characters written, like snprintf
+	 */
+	int print_stats(char *buffer, size_t len) const;
+
+	/**
+	 * @param cycles
+	 * @return Histogram bucket the value is counted in
+	 */
+	static inline uint8_t bucket_for(uint32_t cycles) {
+		if (cycles < CYCLE_PROFILER_SUB_BUCKETS) return (uint8_t) cycles;
+
+		uint8_t msb = (uint8_t) (31 - __builtin_clz(cycles));
+		uint8_t shift = msb - CYCLE_PROFILER_SUB_BUCKET_BITS;
+		return (uint8_t) ((shift + 1) * CYCLE_PROFILER_SUB_BUCKETS
+			+ ((cycles >> shift) & (CYCLE_PROFILER_SUB_BUCKETS - 1)));
+	}
+
+	/**
+	 * @param bucket
+	 * @return Largest value counted in the bucket
+	 */
+	static uint32_t bucket_upper_bound(uint8_t bucket);
+
+	/**
+	 * Registry of every profiler that currently exists, newest first
+	 */
+	static CycleProfiler *first();
+
+	CycleProfiler *next() const { return next_profiler; }
+
+	static void reset_all();
+
+	/**
+	 * Prints every profiler that has samples, a line at a time
+	 * @param print Called with each line, say info()
+	 */
+	static void print_all(void (*print)(const char *line));
+
+ private:
+	const char *name;
+	CycleProfiler *next_profiler;
+
+	uint32_t started_at;
+	uint32_t count;
+	uint64_t total;
+	uint32_t latest;
+	uint32_t max;
+	uint32_t min;
+	uint32_t histogram[CYCLE_PROFILER_NUM_BUCKETS];
+};
+
+/**
+ * Records the cycles from where it's declared to the end of the enclosing scope, however the scope is left
+ */
+class ProfileScope {
+ public:
+	explicit ProfileScope(CycleProfiler &profiler) : profiler(profiler), started_at(get_cycle_count()) {}
+
+	~ProfileScope() { profiler.record(get_cycle_count() - started_at); }
+
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+
+ private:
+	CycleProfiler &profiler;
+	uint32_t started_at;
+};
+
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+
+/**
+ * Profiles the rest of the enclosing scope, ie. PROFILE_SCOPE(imu_read_profiler);
+ */
+#define PROFILE_SCOPE(profiler) ProfileScope PROFILE_SCOPE_CONCAT(profile_scope_, __LINE__)(profiler)
@@ -16,16 +16,27 @@ extern "C" {
 #include <stdbool.h>
 #include <stdlib.h>
 
+#define DMA_RX_STAMPS 8 //hand overs remembered, so bytes read a little late can still be timed
+
+/**
+ * When bytes were handed over to the ring
+ */
+typedef struct DMARXStamp {
+	volatile uint32_t received_bytes; //pushed onto the ring since the stamps were reset, up to and including this one
+	volatile uint32_t time_us; //low 32 bits of get_system_time_us() at the hand over
+} DMARXStamp;
+
 typedef struct DMAConfig {
 	void *dma_handle;
 	volatile bool reset; //toggle wether we need to reset DMA lines
-	volatile bool idle_line;
-	volatile size_t prev_pos; //prev position in dma buffer
+	volatile size_t read_pos; //position in the dma buffer everything before which has been copied out
 	uint8_t *dma_buffer; //must be dynamically allocated
 	size_t dma_buffer_len;
-	volatile uint32_t timer;
-	uint32_t timeout;
-	void *queue; //queue to offload the dma buffer onto. Should be pointer to std::deque<uint8_t>
+	void *queue; //ring to offload the dma buffer onto. Should be pointer to a ByteRing
+	volatile uint32_t dropped_bytes; //received bytes thrown away because the ring was full
+	volatile uint32_t received_bytes; //pushed onto the ring since the stamps were reset, wrapping
+	volatile uint32_t rx_events; //hand overs with new data since the stamps were reset
+	DMARXStamp stamps[DMA_RX_STAMPS]; //the latest hand over is stamps[rx_events % DMA_RX_STAMPS]
 	void (*complete_callback)();
 } DMAConfig;
 
@@ -38,11 +49,41 @@ typedef struct DMAConfig {
 void resetDMAConfig(DMAConfig *config, size_t dma_buffer_len);
 
 /**
- * Dumps the contents of the dma buffer into the FIFO queue, taking into account
- * if the complete event triggered early due to an idle line or stop bit
+ * Starts counting received bytes from 0 again. Call whenever the ring is emptied, not when re-setting up after an
+ * error, so the count keeps lining up with what's read off the ring
+ * @param config
+ */
+void resetDMARXStamps(DMAConfig *config);
+
+/**
+ * Copies everything the dma has written since the last call onto the ring. Call this on the dma half and full
+ * transfer interrupts, and on the peripheral's idle line (or stop bit) interrupt, so that data is delivered as soon
+ * as the sender pauses instead of when the buffer fills up. All of the interrupts that call this for a given
+ * config must have the same priority, so they can't preempt each other
  * @param config
  */
-void processDMARXCompleteEvent(DMAConfig *config);
+void processDMARXEvent(DMAConfig *config);
+
+/**
+ * Hardware independent part of processDMARXEvent(). Works out which region of the dma buffer is new from how far
+ * the dma has got, and copies it onto the ring. The half and full transfer interrupts make sure this is called at
+ * least twice per trip around the buffer, so the position is never ambiguous
+ * @param config
+ * @param remaining Bytes the dma still had left to transfer (the CNDTR/NDTR register) when the event fired
+ * @return Number of bytes copied onto the ring
+ */
+size_t copyDMARXRegion(DMAConfig *config, uint32_t remaining);
+
+/**
+ * Works out when a received byte came in, from the hand over that delivered it. Bytes are assumed to have come in
+ * back to back up to the end of the hand over, which is a character late for an idle line. Safe to call from a task
+ * while the interrupts keep going
+ * @param byte_index Counting bytes pushed onto the ring since the stamps were reset, from 0
+ * @param byte_time_us How long one character takes on the wire
+ * @param time_us Set to the low 32 bits of get_system_time_us() when the byte arrived
+ * @return false if the byte hasn't been handed over yet, or was handed over too long ago to still have its stamp
+ */
+bool getDMARXArrival(const DMAConfig *config, uint32_t byte_index, uint32_t byte_time_us, uint32_t *time_us);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,124 @@
+/**
+ * Non-blocking transmit queue for peripherals that send with DMA. write() copies the data onto a ring and returns
+ * straight away. The dma is handed the largest contiguous region of the ring, and its transfer complete interrupt
+ * chains the next region, so the queue keeps draining without the caller having to wait on the wire.
+ *
+ * Starting a transfer goes through a function pointer, which keeps this free of hardware dependencies. The chip
+ * drivers pass in something that starts a HAL dma transfer, while the host tests and benchmarks pass in a stand-in
+ * that just records the regions.
+ *
+ * write() and the transfer_*() calls change the same state, so they must never preempt each other. The drivers
+ * mask interrupts around write(), which also lets several tasks share one port
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ByteRing.hpp"
+#include "Status.hpp"
+
+/**
+ * Starts sending a region of the queue
+ * @param context Whatever was passed to DMATxQueue::init(), like the peripheral handle
+ * @param data Stays valid and unchanged until transfer_complete() or transfer_aborted() is called
+ * @param len
+ * @return false if the transfer couldn't be started
+ */
+typedef bool (*DMATxStartFunction)(void *context, const uint8_t *data, size_t len);
+
+/**
+ * Space in the queue to write a message straight into. It can wrap around the end of the queue, so it comes in up to
+ * two pieces, and the message carries on from the end of first at the start of second
+ */
+typedef struct DMATxRegion {
+	uint8_t *first;
+	size_t first_len;
+	uint8_t *second;
+	size_t second_len;
+} DMATxRegion;
+
+class DMATxQueue {
+ public:
+	DMATxQueue();
+
+	/**
+	 * Only call this while no transfer is running
+	 * @param storage Must stay valid for as long as the queue is used, and be reachable by the dma
+	 * @param capacity Size of storage. Must be a power of two
+	 * @param start Called whenever there's queued data and the dma is idle
+	 * @param context Passed on to start
+	 * @return STATUS_CODE_INVALID_ARGS if capacity isn't a power of two or there's no start function
+	 */
+	StatusCode init(uint8_t *storage, uint32_t capacity, DMATxStartFunction start, void *context);
+
+	/**
+	 * Queues data to be sent, and starts the dma if it's idle. Either all of it is queued or none of it is, so
+	 * messages never go out half written
+	 * @param data Can be reused as soon as this returns
+	 * @param len
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if there isn't enough free space right now.
+	 * STATUS_CODE_INVALID_ARGS if len is larger than the whole queue
+	 */
+	StatusCode write(const uint8_t *data, size_t len);
+
+	/**
+	 * Hands out space for a message to be written straight into the queue, instead of being built somewhere else and
+	 * copied in with write(). Nothing else can write to the queue until it's given back with commit()
+	 * @param len
+	 * @param region Set to exactly len bytes of space
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if there isn't enough free space right now, which counts as a rejected
+	 * write. STATUS_CODE_INVALID_ARGS if len is larger than the whole queue
+	 */
+	StatusCode reserve(size_t len, DMATxRegion &region);
+
+	/**
+	 * Queues the first len bytes of the space from reserve(), and starts the dma if it's idle
+	 * @param len No more than was reserved. 0 gives all of it back
+	 */
+	void commit(size_t len);
+
+	/**
+	 * Call from the transfer complete interrupt. Frees the region that was just sent and starts the next one
+	 */
+	void transfer_complete();
+
+	/**
+	 * Call when a transfer was stopped part way, like on a dma error. Nothing is freed, so the whole region is
+	 * sent again on the next write()
+	 */
+	void transfer_aborted();
+
+	/**
+	 * Throws away everything that hasn't been sent. Only call this while no transfer is running
+	 */
+	void clear();
+
+	/**
+	 * @return true while the dma is sending a region of the queue
+	 */
+	bool busy() const { return in_flight != 0; }
+
+	/**
+	 * @return Bytes queued, including the ones being sent right now
+	 */
+	size_t pending() const { return ring.size(); }
+
+	size_t capacity() const { return ring.capacity(); }
+
+	/**
+	 * @return Number of write()s turned away because the queue was full
+	 */
+	uint32_t get_rejected_writes() const { return rejected_writes; }
+
+ private:
+	ByteRing ring;
+	DMATxStartFunction start;
+	void *context;
+	volatile size_t in_flight; //length of the region the dma is sending, 0 when idle
+	volatile uint32_t rejected_writes;
+
+	void start_next();
+};
@@ -0,0 +1,109 @@
+/**
+ * Pure encoding and decoding of DShot frames, the digital ESC protocol. Kept free of hardware dependencies so it
+ * can be unit tested and benchmarked on a host machine. The timer/DMA side lives in the chip's PWM driver.
+ *
+ * A DShot frame is 16 bits, sent MSB first:
+ *
+ *  [15-5]   11 bit value. 0 is disarmed, 1-47 are ESC commands, 48-2047 is throttle
+ *  [4]      telemetry request
+ *  [3-0]    CRC. XOR of the three nibbles above (inverted for bidirectional DShot)
+ *
+ * Every bit takes the same amount of time, and is sent as a pulse that's high for 75% of the bit for a 1
+ * and 37.5% of the bit for a 0. In bidirectional mode the signal is inverted, and after every frame the ESC
+ * replies on the same wire with its eRPM, GCR encoded at 5/4 of the bitrate
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Status.hpp"
+
+typedef enum DShotSpeed {
+	DSHOT_150,
+	DSHOT_300,
+	DSHOT_600
+} DShotSpeed;
+
+static const uint8_t DSHOT_FRAME_BITS = 16;
+
+//bit slots at the end of every frame that hold the line low (or high when inverted) until the next frame
+static const uint8_t DSHOT_FRAME_TRAILING_SLOTS = 2;
+static const uint8_t DSHOT_FRAME_SLOTS = DSHOT_FRAME_BITS + DSHOT_FRAME_TRAILING_SLOTS;
+
+static const uint16_t DSHOT_CMD_MOTOR_STOP = 0;
+static const uint16_t DSHOT_THROTTLE_MIN = 48;
+static const uint16_t DSHOT_THROTTLE_MAX = 2047;
+
+//number of throttle steps, from DSHOT_THROTTLE_MIN to DSHOT_THROTTLE_MAX
+static const uint16_t DSHOT_THROTTLE_RANGE = DSHOT_THROTTLE_MAX - DSHOT_THROTTLE_MIN + 1;
+
+typedef struct DShotTiming {
+	uint16_t period; //timer ticks per bit
+	uint16_t bit_0; //high time for a 0, in ticks
+	uint16_t bit_1; //high time for a 1, in ticks
+} DShotTiming;
+
+/**
+ * @param speed
+ * @return Bits per second
+ */
+uint32_t dshot_bitrate(DShotSpeed speed);
+
+/**
+ * Works out the timer values for a given speed. Done once when the output is configured
+ * @param speed
+ * @param timer_hz Frequency the timer counts at
+ * @param timing
+ * @return STATUS_CODE_OUT_OF_RANGE if the timer is too slow (or too fast) to produce the bitrate
+ */
+StatusCode dshot_get_timing(DShotSpeed speed, uint32_t timer_hz, DShotTiming &timing);
+
+/**
+ * Maps a throttle from 0 to DSHOT_THROTTLE_RANGE - 1 onto the DShot throttle values
+ * @param throttle
+ * @return Value that can be passed to dshot_encode_packet()
+ */
+uint16_t dshot_throttle_value(uint16_t throttle);
+
+/**
+ * Builds a frame, including the CRC
+ * @param value 0-2047. Anything larger is clamped
+ * @param telemetry Ask the ESC to send back telemetry on its telemetry wire
+ * @param bidirectional Invert the CRC, which is how the ESC knows to reply with eRPM on the signal wire
+ * @return 16 bit frame
+ */
+uint16_t dshot_encode_packet(uint16_t value, bool telemetry, bool bidirectional);
+
+/**
+ * Expands frames into compare values for a timer that writes num_channels capture/compare registers on every
+ * update event (DMA burst mode). Values are interleaved: all channels for bit 15, then all channels for bit 14...
+ * followed by DSHOT_FRAME_TRAILING_SLOTS slots of 0.
+ * @param packets One frame per channel
+ * @param num_channels 1-4
+ * @param timing
+ * @param buffer At least DSHOT_FRAME_SLOTS * num_channels long
+ */
+void dshot_fill_burst_buffer(const uint16_t *packets, uint8_t num_channels, const DShotTiming &timing,
+							 uint16_t *buffer);
+
+/**
+ * Decodes an eRPM reply that has already been turned into bits
+ * @param gcr The 20 GCR encoded bits of the reply (not including the start bit)
+ * @param erpm Electrical RPM. 0 if the motor is stopped. Divide by half the number of motor poles to get RPM
+ * @return STATUS_CODE_INVALID_ARGS if the reply has an invalid GCR code or a bad CRC
+ */
+StatusCode dshot_decode_erpm(uint32_t gcr, uint32_t &erpm);
+
+/**
+ * Decodes an eRPM reply from the timestamps of its edges, as captured by a timer. Every edge is a 1 in the
+ * GCR data, and the gaps between edges are filled with 0s
+ * @param edges Timer values of each edge, starting with the falling edge of the start bit
+ * @param count
+ * @param ticks_per_bit Timer ticks per bit of the reply. The reply is sent at 5/4 of the DShot bitrate
+ * @param erpm
+ * @return STATUS_CODE_INVALID_ARGS if the edges don't make up a valid reply
+ */
+StatusCode dshot_decode_erpm_edges(const uint16_t *edges, size_t count, uint16_t ticks_per_bit, uint32_t &erpm);
@@ -31,6 +31,14 @@ void debug_array(const char* string, uint8_t* data, size_t data_size, bool displ
 
 void abort(const char *msg, const char *file, int line);
 
+/**
+ * Sends raw bytes out of the debug port, like binary log records
+ * @param data
+ * @param len
+ * @return STATUS_CODE_RESOURCE_EXHAUSTED if the port's transmit queue can't take it right now
+ */
+StatusCode debug_transmit(const uint8_t *data, size_t len);
+
 
 
 
@@ -0,0 +1,83 @@
+/**
+ * Packets on a UARTPort, framed as in Framing.hpp, for protocols that send packets of any length and want each one as
+ * soon as it's arrived.
+ *
+ * receive() works straight on the uart's receive ring. A frame that's in one piece there is decoded where it is and
+ * handed over without ever being copied. Only one that's split around the end of the ring, or that the caller's byte
+ * budget ran out part way through, is put back together in the decoder's buffer instead. Every good packet goes to
+ * each handler in turn, in the calling task, or onto a FrameQueue for another task to take later.
+ *
+ * send() encodes straight into the transmit queue. Senders that want to write their packet field by field can use a
+ * FrameWriter on UARTPort::transmit_reserve() themselves
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Framing.hpp"
+#include "UART.hpp"
+#include "Status.hpp"
+
+/**
+ * Gets every good packet. It's only there until the handler returns
+ */
+typedef void (*FrameHandler)(void *context, const uint8_t *packet, size_t len);
+
+static const uint8_t FRAMED_PORT_MAX_HANDLERS = 4;
+
+class FramedPort {
+ public:
+	/**
+	 * @param port With rx dma for receive(), and tx dma for send(). Its receive ring should hold at least one of the
+	 * longest frames
+	 * @param buffer Where packets that don't arrive in one piece are put back together, see FrameDecoder
+	 * @param capacity Size of buffer, which is the longest packet taken, crc included
+	 */
+	FramedPort(UARTPort &port, FramingFormat format, uint8_t *buffer, size_t capacity);
+
+	/**
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if FRAMED_PORT_MAX_HANDLERS have been added already
+	 */
+	StatusCode add_handler(FrameHandler handler, void *context);
+
+	/**
+	 * Copies every good packet onto queue. Ones it doesn't have room for are dropped, and counted by the queue
+	 */
+	StatusCode add_queue(FrameQueue &queue);
+
+	/**
+	 * Decodes what's come in and hands over every good packet
+	 * @param max_bytes Most to work through, so a burst of data can't hold the caller up for long. Whatever's left
+	 * waits for the next call
+	 * @return Packets handed over
+	 */
+	size_t receive(size_t max_bytes);
+
+	/**
+	 * Frames a packet and queues it to go out
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if there isn't room in the transmit queue for it right now.
+	 * STATUS_CODE_UNINITIALIZED without tx dma
+	 */
+	StatusCode send(const uint8_t *packet, size_t len);
+
+	const FrameDecoder &decoder() const { return frames; }
+
+	/**
+	 * @return Packets decoded where they arrived, without being copied
+	 */
+	uint32_t in_place_count() const { return in_place; }
+
+ private:
+	UARTPort &port;
+	FramingFormat format;
+	FrameDecoder frames;
+	FrameHandler handlers[FRAMED_PORT_MAX_HANDLERS];
+	void *contexts[FRAMED_PORT_MAX_HANDLERS];
+	uint8_t handler_count;
+	uint32_t in_place;
+
+	void deliver(const uint8_t *packet, size_t len);
+};
@@ -0,0 +1,223 @@
+/**
+ * Packet framing for byte streams like a uart, so packets of any length can be picked back out of the stream however
+ * it arrives, and a receiver can join the stream anywhere.
+ *
+ * Two encodings:
+ *  - COBS (Cheshire and Baker, "Consistent Overhead Byte Stuffing", 1999). A 0 only ever ends a frame. It costs one
+ *  byte for every 254 of packet, plus the 0, whatever's in the packet, so the worst case is known up front
+ *  - SLIP (RFC 1055). 0xC0 ends a frame, and a 0xC0 or 0xDB in the packet is escaped into two bytes. Costs nothing for
+ *  most packets, but up to twice their size. For devices that already speak it
+ *
+ * Either can carry a crc16_ccitt of the packet after it, little endian. Frames with a bad crc are dropped.
+ *
+ * FrameWriter encodes a packet as it's written, straight into wherever it's sent from, like the space handed out by
+ * UARTPort::transmit_reserve(). FrameDecoder takes frames apart again, a run of bytes at a time (putting the packet
+ * back together as it goes, so a frame can arrive in any number of pieces), or in place when a whole frame is in one
+ * piece of memory already. Both do the same small amount of work for every byte, crc included, so a frame's last byte
+ * costs no more than any other. FramedPort.hpp puts them together on a UARTPort
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ByteRing.hpp"
+#include "DMATxQueue.hpp"
+#include "Status.hpp"
+
+typedef enum FramingEncoding {
+	FRAMING_COBS,
+	FRAMING_SLIP
+} FramingEncoding;
+
+typedef struct FramingFormat {
+	FramingEncoding encoding;
+	bool crc; //a crc16_ccitt after the packet
+} FramingFormat;
+
+static const size_t FRAMING_CRC_LEN = 2;
+static const size_t FRAMING_COBS_MAX_BLOCK = 254; //data bytes a single code byte can cover
+
+static const uint8_t FRAMING_SLIP_END = 0xC0;
+static const uint8_t FRAMING_SLIP_ESC = 0xDB;
+static const uint8_t FRAMING_SLIP_ESC_END = 0xDC;
+static const uint8_t FRAMING_SLIP_ESC_ESC = 0xDD;
+
+/**
+ * @return The byte that ends every frame, and never turns up inside one
+ */
+static inline uint8_t framing_delimiter(FramingFormat format) {
+	return format.encoding == FRAMING_COBS ? 0 : FRAMING_SLIP_END;
+}
+
+/**
+ * @return The most bytes a packet of this length can take on the wire, framing and crc included
+ */
+size_t framing_max_frame_len(FramingFormat format, size_t packet_len);
+
+/**
+ * Encodes one packet as it's written, into space that can be in up to two pieces like what
+ * UARTPort::transmit_reserve() hands out. Nothing is built up anywhere else first
+ */
+class FrameWriter {
+ public:
+	/**
+	 * Starts a frame
+	 * @param region At least framing_max_frame_len() of the packet that's going to be written
+	 */
+	FrameWriter(FramingFormat format, const DMATxRegion &region);
+
+	void put_u8(uint8_t value);
+	void put_u16(uint16_t value);
+	void put_u32(uint32_t value);
+	void put_i32(int32_t value) { put_u32((uint32_t) value); }
+	void put_float(float value);
+	void put_bytes(const uint8_t *data, size_t len);
+
+	/**
+	 * Adds the crc and ends the frame
+	 * @return Length of the frame, to commit. 0 if it didn't fit in the region, and none of it should be sent
+	 */
+	size_t finish();
+
+ private:
+	FramingFormat format;
+	DMATxRegion region;
+	size_t position;
+	size_t code_position; //where the code byte for the cobs block being written goes
+	uint8_t code;
+	uint16_t crc;
+
+	void encode(uint8_t byte);
+	void end_block();
+	void emit(uint8_t byte);
+	void write_at(size_t index, uint8_t byte);
+};
+
+/**
+ * Encodes a packet that's all in one place already
+ * @param out_len At least framing_max_frame_len() of the packet
+ * @return Length of the frame. 0 if it didn't fit
+ */
+size_t framing_encode(FramingFormat format, const uint8_t *packet, size_t len, uint8_t *out, size_t out_len);
+
+/**
+ * Takes frames apart, a run of received bytes at a time. Damaged frames are dropped at the next delimiter, and the
+ * stream picks up again from there
+ */
+class FrameDecoder {
+ public:
+	/**
+	 * @param buffer Where packets that arrive in pieces are put back together. Must stay valid for as long as the
+	 * decoder is used
+	 * @param capacity Size of buffer. Frames with more than this in them (packet and crc) are dropped
+	 */
+	FrameDecoder(FramingFormat format, uint8_t *buffer, size_t capacity);
+
+	/**
+	 * Decodes bytes until a packet is finished
+	 * @param complete Set if the last byte used finished a good frame. The packet's in packet() until the next feed()
+	 * @return Bytes used. Less than len only when a frame was finished, so the rest should be fed in after it's handled
+	 */
+	size_t feed(const uint8_t *data, size_t len, bool &complete);
+
+	/**
+	 * Decodes a whole frame that's in one piece, over the top of itself, so the packet is never copied. Only while
+	 * idle(), since it doesn't know about anything fed in already
+	 * @param frame Everything before the delimiter
+	 * @param len
+	 * @param packet_len Set to the packet's length. It starts at frame[0]
+	 * @return false if the frame's damaged or too long for the decoder's buffer
+	 */
+	bool decode_in_place(uint8_t *frame, size_t len, size_t &packet_len);
+
+	/**
+	 * Drops whatever frame is part way through, like after the receiver's been set up again
+	 */
+	void reset();
+
+	/**
+	 * @return true if nothing's been fed in since the last delimiter
+	 */
+	bool idle() const;
+
+	const uint8_t *packet() const { return buffer; }
+	size_t packet_len() const { return finished_len; }
+
+	FramingFormat frame_format() const { return format; }
+
+	/**
+	 * @return Most bytes one of the frames this decoder takes can have on the wire
+	 */
+	size_t max_frame_len() const;
+
+	uint32_t frame_count() const { return frames; }
+
+	/**
+	 * @return Frames dropped for a bad crc, bad encoding, or being too long
+	 */
+	uint32_t error_count() const { return errors; }
+
+ private:
+	FramingFormat format;
+	uint8_t *buffer;
+	size_t capacity;
+	size_t length;
+	size_t finished_len;
+	uint8_t block_left; //cobs data bytes left before the next code byte
+	bool zero_pending; //the 0 the last cobs block ended in, only added if another block follows it
+	bool escaped; //the last byte was a slip escape
+	bool discarding; //something's wrong with this frame, so everything up to the next delimiter is ignored
+	uint16_t crc; //of every byte but the last two
+
+	uint32_t frames;
+	uint32_t errors;
+
+	void append(uint8_t byte);
+	void end_frame(bool &complete);
+	bool check_in_place(const uint8_t *content, size_t len, size_t &packet_len) const;
+};
+
+/**
+ * Whole packets, passed from whoever decodes them to a task that takes them later. Each one is copied in behind its
+ * length, and only shows up once all of it is there. One producer and one consumer, like the ByteRing underneath
+ */
+class FrameQueue {
+ public:
+	FrameQueue();
+
+	/**
+	 * Only call this while neither side is using the queue
+	 * @param storage Must stay valid for as long as the queue is used
+	 * @param capacity Size of storage. Must be a power of two. Each packet takes 2 bytes more than its length
+	 * @return STATUS_CODE_INVALID_ARGS if capacity isn't a power of two
+	 */
+	StatusCode init(uint8_t *storage, uint32_t capacity);
+
+	/**
+	 * @return false if there isn't room for the whole packet, in which case it's dropped
+	 */
+	bool push(const uint8_t *packet, size_t len);
+
+	/**
+	 * Takes the oldest packet out
+	 * @param max_len Size of packet
+	 * @param len Set to the packet's length
+	 * @return STATUS_CODE_EMPTY if there's nothing waiting. STATUS_CODE_RESOURCE_EXHAUSTED if the packet's longer than
+	 * max_len, in which case it's dropped
+	 */
+	StatusCode pop(uint8_t *packet, size_t max_len, size_t &len);
+
+	bool empty() const { return ring.empty(); }
+
+	/**
+	 * @return Packets turned away by push() for want of room
+	 */
+	uint32_t dropped_count() const { return dropped; }
+
+ private:
+	ByteRing ring;
+	uint32_t dropped;
+};
@@ -0,0 +1,237 @@
+/**
+ * Controls for the host (x86 linux) backend of the drivers, which lives in Common/Src/x86 and the x86 folders of the
+ * chip libraries. There the drivers talk to simulated hardware instead of registers, so everything above them (gps
+ * parsing, sbus, interchip, logging) can run and be profiled on a development machine at full speed. None of this
+ * exists on the chips.
+ *
+ * UART: whatever a port transmits goes to what it's wired to. Unwired ports keep it, for host_uart_take_transmitted().
+ * Ports can be wired to each other (crossed over, like a null modem cable), to themselves as a loopback, or to a pair
+ * of file descriptors, like a pipe or a pty. Incoming bytes go through the same dma buffer and ring as on the chip
+ * when rx dma is set up, and otherwise wait on the line for a blocking read.
+ *
+ * I2C and SPI: devices are objects attached to an address or slave number. HostI2CRegisterDevice and
+ * HostSPIRegisterDevice model the usual register mapped sensor, and can be scripted by setting their registers or
+ * overriding their hooks. Transfers to an address with nothing attached fail like a NACK would.
+ *
+ * GPIO: pins keep the level last driven onto them, by an output pin or by host_gpio_drive()
+ *
+ * Each port is locked on its own, so tasks can be stood in for with threads. Call host_devices_reset() between tests
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Status.hpp"
+#include "UART.hpp"
+#include "I2C.hpp"
+#include "GPIO.hpp"
+#include "DMA.hpp"
+
+static const uint8_t HOST_UART_PORTS = 6;
+static const uint8_t HOST_I2C_PORTS = 4;
+static const uint8_t HOST_I2C_DEVICES_PER_PORT = 8;
+static const uint8_t HOST_SPI_PORTS = 6;
+static const uint8_t HOST_SPI_DEVICES_PER_PORT = 5;
+static const uint8_t HOST_GPIO_PORTS = 6;
+static const uint8_t HOST_GPIO_PINS = 16;
+
+/**
+ * Unwires every port, detaches every device and lets every pin float low again. Uart ports with rx dma stop receiving,
+ * so set them up again afterwards
+ */
+void host_devices_reset();
+
+/***********************************************************************************************************************
+ * UART
+ **********************************************************************************************************************/
+
+/**
+ * Wires the tx of each port to the rx of the other. Wiring a port to itself makes a loopback
+ */
+StatusCode host_uart_connect(UARTPortNum a, UARTPortNum b);
+
+/**
+ * Wires a port to file descriptors, like the two ends of a pipe or a pty. Reads are polled without blocking
+ * @param read_fd What the port receives from, -1 for nothing
+ * @param write_fd What the port transmits to, -1 for nothing
+ */
+StatusCode host_uart_attach_fds(UARTPortNum port, int read_fd, int write_fd);
+
+/**
+ * Opens a pseudo terminal and wires the port to it, so a terminal program or a tool like gpsfake can talk to the port
+ * @param name Filled in with the path of the pty's other end, like /dev/pts/3
+ * @param name_len
+ */
+StatusCode host_uart_open_pty(UARTPortNum port, char *name, size_t name_len);
+
+/**
+ * Puts bytes on the port's rx line, as if a device had sent them
+ * @return Bytes accepted. With rx dma, anything that doesn't fit in the ring is dropped, like on the chip
+ */
+size_t host_uart_inject(UARTPortNum port, const uint8_t *data, size_t len);
+
+/**
+ * Takes out what an unwired port has transmitted
+ * @return Bytes copied into data
+ */
+size_t host_uart_take_transmitted(UARTPortNum port, uint8_t *data, size_t len);
+
+/***********************************************************************************************************************
+ * I2C
+ **********************************************************************************************************************/
+
+/**
+ * A device on an i2c bus. Each call is one transaction, between a start and a stop (or a repeated start)
+ */
+class HostI2CDevice {
+ public:
+	virtual ~HostI2CDevice() = default;
+
+	/**
+	 * @return false to nack
+	 */
+	virtual bool write(const uint8_t *data, size_t len) = 0;
+
+	/**
+	 * @return false to nack
+	 */
+	virtual bool read(uint8_t *data, size_t len) = 0;
+};
+
+/**
+ * The usual register mapped sensor: a write starts with the register address, and reads and writes carry on from
+ * there, moving up one register per byte
+ */
+class HostI2CRegisterDevice : public HostI2CDevice {
+ public:
+	/**
+	 * @param register_address_size Bytes in a register address, 1 or 2
+	 */
+	explicit HostI2CRegisterDevice(size_t register_address_size = 1);
+
+	bool write(const uint8_t *data, size_t len) override;
+
+	bool read(uint8_t *data, size_t len) override;
+
+	/**
+	 * Called before the registers are read, so a model can put a new sample in them
+	 * @param address First register being read
+	 */
+	virtual void before_read(uint16_t address) {}
+
+	/**
+	 * Called after registers are written
+	 * @param address First register written
+	 * @param len
+	 */
+	virtual void after_write(uint16_t address, size_t len) {}
+
+	uint8_t registers[256]; //two byte addresses wrap around it
+	uint32_t reads = 0;
+	uint32_t writes = 0;
+
+ private:
+	size_t register_address_size;
+	uint16_t pointer = 0;
+};
+
+/**
+ * @param address The address the drivers are called with
+ * @param device Must outlive its attachment
+ * @return STATUS_CODE_RESOURCE_EXHAUSTED if the bus already has HOST_I2C_DEVICES_PER_PORT devices
+ */
+StatusCode host_i2c_attach(I2CPortNum port, I2CAddress address, HostI2CDevice *device);
+
+/***********************************************************************************************************************
+ * SPI
+ **********************************************************************************************************************/
+
+/**
+ * A device on an spi bus
+ */
+class HostSPIDevice {
+ public:
+	virtual ~HostSPIDevice() = default;
+
+	/**
+	 * Chip select was asserted, so a new transaction is starting
+	 */
+	virtual void select() {}
+
+	/**
+	 * Full duplex, a byte comes back for every byte sent
+	 * @param tx
+	 * @param rx
+	 * @param len
+	 */
+	virtual void exchange(const uint8_t *tx, uint8_t *rx, size_t len) = 0;
+};
+
+/**
+ * Register mapped sensor, the way most imus and barometers work. The first byte of a transaction is the register
+ * address with the top bit set for a read, then data bytes follow, moving up one register per byte
+ */
+class HostSPIRegisterDevice : public HostSPIDevice {
+ public:
+	void select() override;
+
+	void exchange(const uint8_t *tx, uint8_t *rx, size_t len) override;
+
+	/**
+	 * Called before a read transaction, so a model can put a new sample in the registers
+	 */
+	virtual void before_read(uint8_t address) {}
+
+	uint8_t registers[128] = {};
+
+ private:
+	bool address_next = true;
+	bool reading = false;
+	uint8_t pointer = 0;
+};
+
+/**
+ * @param slave_num The number SPIPort::add_slave() gave the chip select pin
+ * @param device Must outlive its attachment
+ */
+StatusCode host_spi_attach(uint8_t port, uint32_t slave_num, HostSPIDevice *device);
+
+/**
+ * Used by the host SPIPort. Nullptr if there's nothing there
+ */
+HostSPIDevice *host_spi_device(uint8_t port, uint32_t slave_num);
+
+/***********************************************************************************************************************
+ * GPIO
+ **********************************************************************************************************************/
+
+/**
+ * Drives a pin from outside, for input pins to read
+ */
+StatusCode host_gpio_drive(GPIOPort port, GPIOPinNum pin, GPIOState state);
+
+/**
+ * @return The level on a pin, like what an output pin last set
+ */
+GPIOState host_gpio_level(GPIOPort port, GPIOPinNum pin);
+
+/***********************************************************************************************************************
+ * DMA
+ **********************************************************************************************************************/
+
+/**
+ * Where a simulated circular dma stream has got to. Set as DMAConfig::dma_handle
+ */
+typedef struct HostDMAStream {
+	size_t position;
+} HostDMAStream;
+
+/**
+ * Writes bytes into a circular dma buffer the way the stream would, firing processDMARXEvent() at every half and full
+ * buffer, and once more at the end like an idle line interrupt
+ * @return Bytes that made it onto the ring
+ */
+size_t host_dma_receive(DMAConfig *config, const uint8_t *data, size_t len);
@@ -14,7 +14,7 @@
 #include "Status.hpp"
 #include "GPIO.hpp"
 #include "DMA.hpp"
-#include <deque>
+#include "ByteRing.hpp"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -129,7 +129,7 @@ class I2CSlavePort : public I2CPort {
 
  private:
 	I2CAddress address; //the devices i2c address
-	std::deque<uint8_t> *rx_queue;
+	ByteRing *rx_ring;
 	DMAConfig *dma_config;
 	bool dma_setup_tx = false;
 	bool dma_setup_rx = false;
@@ -138,6 +138,13 @@ class I2CSlavePort : public I2CPort {
 
 class I2CMasterPort : public I2CPort {
  public:
+	/**
+	 * Creates the object, but does not initialize the connection
+	 * @param port_num
+	 * @param settings
+	 */
+	I2CMasterPort(I2CPortNum port_num, I2CSettings settings);
+
 	StatusCode setup();
 
 	/**
@@ -1,13 +1,36 @@
 /*
 * Interchip packets
 * Packets should be a multiple of 16 bits
+*
+* Every packet carries a sequence number, echoes the last sequence number it got from the other chip (so the
+* sender can measure round trip time), and a summary of how the link looks from its end. The crc covers
+* everything before it
 */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+	uint16_t crc_failures;
+	uint16_t sequence_gaps;
+	uint16_t late_frames;
+} Interchip_LinkHealth;    //Low 16 bits of the sender's link counters. See InterchipStats.h
+
 typedef struct {
+	uint16_t sequence;
+	uint16_t ack_sequence;
+	Interchip_LinkHealth link;
 	int16_t PWM[12];
 	uint16_t safety_level;
+	uint16_t crc;
 } Interchip_StoA_Packet;    //Safety to Autopilot packet
 
 typedef struct {
+	uint16_t sequence;
+	uint16_t ack_sequence;
+	Interchip_LinkHealth link;
 	int16_t PWM[12];
 	uint16_t autonomous_level;
-} Interchip_AtoS_Packet;    //Autopilot to Safety packet
\ No newline at end of file
+	uint16_t crc;
+} Interchip_AtoS_Packet;    //Autopilot to Safety packet
@@ -0,0 +1,142 @@
+/**
+ * Link quality and latency statistics for the SPI link between the autopilot and safety chips. Both ends keep
+ * one of these and feed it as frames go out and come in.
+ *
+ * Every counter has exactly one writer (the task sending frames, or the interrupt receiving them), and is a
+ * single 32 bit word, so everything is lock free and safe to read from anywhere. A snapshot can tear between
+ * counters, but never within one.
+ *
+ * Round trip time is measured by remembering when each sequence number went out, and looking it up when the
+ * other chip echoes it back. Times are kept in a histogram with power of two buckets, whose counts are halved
+ * every INTERCHIP_RTT_WINDOW samples so that it follows how the link is doing now rather than since boot
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+//use C interface so that we can use these anywhere in the code, including ISRs and the C interchip tasks
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "Interchip.h"
+
+#define INTERCHIP_RTT_BUCKETS 8
+#define INTERCHIP_RTT_FIRST_BUCKET_US 500 //bucket n holds times below 500us << n, the last one holds the rest
+#define INTERCHIP_RTT_WINDOW 256
+#define INTERCHIP_RTT_SLOTS 16 //how many sent frames we remember the send time of. Must be a power of two
+
+typedef struct InterchipStatsSnapshot {
+	uint32_t frames_sent;
+	uint32_t frames_received; //only counts frames that passed their crc
+	uint32_t crc_failures;
+	uint32_t sequence_gaps; //total number of frames from the other chip that never showed up
+	uint32_t late_frames; //frames from the other chip that took too long to arrive
+	uint32_t send_overruns; //times we couldn't send because the previous transfer was still going
+	uint32_t transfer_errors; //errors reported by the spi peripheral itself
+	uint32_t last_rtt_us;
+	uint32_t max_rtt_us;
+	uint32_t rtt_histogram[INTERCHIP_RTT_BUCKETS];
+} InterchipStatsSnapshot;
+
+typedef struct InterchipStats {
+	//written by the sending side
+	volatile uint32_t frames_sent;
+	volatile uint32_t send_overruns;
+	volatile uint16_t next_sequence;
+	volatile uint16_t sent_sequence[INTERCHIP_RTT_SLOTS];
+	volatile uint32_t sent_time_us[INTERCHIP_RTT_SLOTS];
+
+	//written by the receiving side
+	volatile uint32_t frames_received;
+	volatile uint32_t crc_failures;
+	volatile uint32_t transfer_errors;
+	volatile uint32_t sequence_gaps;
+	volatile uint32_t late_frames;
+	volatile uint32_t last_rtt_us;
+	volatile uint32_t max_rtt_us;
+	volatile uint32_t rtt_histogram[INTERCHIP_RTT_BUCKETS];
+	volatile uint32_t rtt_samples;
+	volatile uint16_t last_rx_sequence;
+	volatile uint16_t last_ack_sequence;
+	volatile uint32_t last_rx_time_us;
+	volatile uint8_t has_received;
+
+	uint32_t late_threshold_us;
+} InterchipStats;
+
+/**
+ * @param stats
+ * @param frame_period_us How often frames are expected from the other chip. Anything that takes more than 1.5
+ * 		times as long is counted as late
+ */
+void init_interchip_stats(InterchipStats *stats, uint32_t frame_period_us);
+
+/**
+ * Call right before a frame is sent
+ * @param stats
+ * @return Sequence number to put in the frame
+ */
+uint16_t interchip_stats_frame_sent(InterchipStats *stats);
+
+/**
+ * Call when a frame comes in and its crc checks out
+ * @param stats
+ * @param sequence Sequence number of the received frame
+ * @param ack_sequence Sequence number the other chip echoed back
+ */
+void interchip_stats_frame_received(InterchipStats *stats, uint16_t sequence, uint16_t ack_sequence);
+
+/**
+ * Call when a frame comes in with a bad crc
+ * @param stats
+ */
+void interchip_stats_crc_failure(InterchipStats *stats);
+
+/**
+ * Call when the sender couldn't get a frame out on time, because the previous transfer was still going
+ * @param stats
+ */
+void interchip_stats_send_overrun(InterchipStats *stats);
+
+/**
+ * Call when the spi peripheral reports an error. Should be called from the same context that receives frames
+ * @param stats
+ */
+void interchip_stats_transfer_error(InterchipStats *stats);
+
+/**
+ * @param stats
+ * @return Sequence number to echo back to the other chip in the next frame
+ */
+uint16_t interchip_stats_ack_sequence(const InterchipStats *stats);
+
+/**
+ * Fills in the link summary that gets sent to the other chip
+ * @param stats
+ * @param health
+ */
+void interchip_stats_get_health(const InterchipStats *stats, Interchip_LinkHealth *health);
+
+/**
+ * Copies all the counters out, for telemetry or printing
+ * @param stats
+ * @param snapshot
+ */
+void get_interchip_stats(const InterchipStats *stats, InterchipStatsSnapshot *snapshot);
+
+/**
+ * Prints link stats onto buffer
+ * Returns number of characters written into buffer
+ * @param label
+ * @param buffer
+ * @param stats
+ */
+int print_interchip_stats(const char *label, char *buffer, const InterchipStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+/**
+ * Pure decoding of PPM pulse trains from a stream of input capture timestamps. The capture hardware only has to
+ * drop the free-running 16-bit counter value of every edge into a circular buffer; everything else (frame
+ * alignment, conversions) is done here, once per frame, by whoever reads the channels.
+ *
+ * A PPM frame is a series of pulses, where the time between consecutive edges is the width of each channel.
+ * Frames are separated by a sync gap, which is longer than any valid channel width:
+ *
+ *  | ch1 | ch2 | ... | chN |      sync gap      | ch1 | ...
+ *
+ * All conversions are precomputed into multiply-shift constants when the limits are set, so reading a channel
+ * never needs a division
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Status.hpp"
+
+static const uint8_t PPM_DECODER_MAX_CHANNELS = 12;
+
+//size of the capture timestamp buffer. Must be a power of two. Enough for two full frames of 12 channels
+static const uint32_t PPM_CAPTURE_BUFFER_LEN = 32;
+
+//anything longer than this between two edges is a sync gap. Channels never go past ~2.2ms
+static const uint32_t PPM_DEFAULT_SYNC_GAP_US = 3000;
+
+typedef struct PPMChannelScale {
+	uint32_t min_ticks; //ticks for a 0% signal
+	uint32_t range_ticks; //ticks between a 0% and a 100% signal
+	uint32_t deadzone_ticks;
+	uint32_t percent_mul; //percent = ((ticks - min_ticks) * percent_mul) >> 16
+} PPMChannelScale;
+
+class PPMDecoder {
+ public:
+	PPMDecoder();
+
+	/**
+	 * Resets all channel limits back to their defaults, as they're stored in ticks
+	 * @param tick_hz Frequency the capture timer counts at. Must be at least 1MHz, and low enough that a whole
+	 * 		frame fits in 16 bits worth of ticks (2MHz is a good compromise)
+	 * @param num_channels 1-12
+	 * @param sync_gap_us Minimum time between edges that is considered a sync gap
+	 * @return STATUS_CODE_INVALID_ARGS if any parameter is out of range
+	 */
+	StatusCode configure(uint32_t tick_hz, uint8_t num_channels, uint32_t sync_gap_us = PPM_DEFAULT_SYNC_GAP_US);
+
+	/**
+	 * Set expected input limits for a particular channel. Defaults to 1000-2000us with no deadzone
+	 * @param channel 0 indexed
+	 * @param min_us Time for a 0% signal
+	 * @param max_us Time for a 100% signal
+	 * @param deadzone_us Signals up to this far above min_us still read as 0%
+	 */
+	StatusCode set_limits(uint8_t channel, uint32_t min_us, uint32_t max_us, uint32_t deadzone_us);
+
+	/**
+	 * Decodes every capture that was added to the buffer since the last call
+	 * @param captures Circular buffer of PPM_CAPTURE_BUFFER_LEN timestamps, one per edge
+	 * @param head Total number of captures ever written to the buffer. Only the low bits are used as the index,
+	 * 		so this is allowed to wrap around
+	 * @return Number of complete frames decoded by this call
+	 */
+	uint32_t process(const volatile uint16_t *captures, uint32_t head);
+
+	/**
+	 * @param channel 0 indexed
+	 * @return Width of the channel in the last complete frame, in timer ticks. 0 if none received
+	 */
+	uint16_t get_ticks(uint8_t channel) const;
+
+	/**
+	 * @param channel 0 indexed
+	 * @return Width of the channel in the last complete frame in us. 0 if none received
+	 */
+	uint32_t get_us(uint8_t channel) const;
+
+	/**
+	 * @param channel 0 indexed
+	 * @return 0-100 based on the channel limits
+	 */
+	uint8_t get_percent(uint8_t channel) const;
+
+	/**
+	 * Forget the last frame (all channels read 0) and wait for the next sync gap
+	 */
+	void clear();
+
+	uint8_t get_num_channels() const { return num_channels; }
+
+	uint32_t get_frame_count() const { return frame_count; }
+
+	/**
+	 * @return Number of frames thrown away because they had the wrong number of channels
+	 */
+	uint32_t get_error_count() const { return error_count; }
+
+	/**
+	 * @return Number of times captures were overwritten before they could be processed
+	 */
+	uint32_t get_overrun_count() const { return overrun_count; }
+
+ private:
+	uint32_t tick_hz;
+	uint32_t us_mul; //us = (ticks * us_mul) >> 16
+	uint32_t sync_gap_ticks;
+	uint8_t num_channels;
+
+	PPMChannelScale scales[PPM_DECODER_MAX_CHANNELS];
+	uint16_t widths[PPM_DECODER_MAX_CHANNELS]; //last complete frame
+	uint16_t pending[PPM_DECODER_MAX_CHANNELS]; //frame currently being received
+
+	uint32_t tail; //next capture to process
+	uint16_t last_edge;
+	bool have_last_edge;
+	int8_t index; //next channel in the pending frame, or -1 while waiting for a sync gap
+
+	uint32_t frame_count;
+	uint32_t error_count;
+	uint32_t overrun_count;
+};
@@ -0,0 +1,44 @@
+/**
+ * Pure conversions from percentages and pulse widths to timer compare values for PWM outputs. Kept free of hardware
+ * so they can be tested on a host machine. The timer side lives in the chip's PWM driver.
+ *
+ * Everything that needs a division is worked out once, when the limits or the timer change, into multiply-shift
+ * constants. Setting an output is then just a clamp, a multiply and a shift
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct PWMScale {
+	uint16_t min_us; //shortest pulse that will be sent
+	uint16_t max_us; //longest pulse that will be sent, never past the end of the period
+	uint32_t us_to_ticks; //ticks = (us * us_to_ticks + 0x8000) >> 16
+	uint32_t percent_to_us; //us = min_us + (percent * percent_to_us + 0x8000) >> 16
+} PWMScale;
+
+/**
+ * Works out the constants for an output. Done whenever the limits or the timer change
+ * @param tick_hz Frequency the timer counts at
+ * @param period_ticks Timer ticks per pwm period
+ * @param min_us Pulse width for 0%
+ * @param max_us Pulse width for 100%. Anything past the period is cut down to it
+ * @param scale
+ */
+void pwm_get_scale(uint32_t tick_hz, uint32_t period_ticks, uint32_t min_us, uint32_t max_us, PWMScale &scale);
+
+/**
+ * @param scale
+ * @param us Clamped to the output's limits
+ * @return Compare value for the timer
+ */
+uint16_t pwm_us_to_ticks(const PWMScale &scale, uint16_t us);
+
+/**
+ * @param scale
+ * @param percent Anything over 100 is clamped
+ * @return Pulse width, in us
+ */
+uint16_t pwm_percent_to_us(const PWMScale &scale, uint8_t percent);
@@ -3,7 +3,10 @@
  *
  * You can call the start and stop method on a particular profiler multiple times,
  * and it'll gather statistics about the longest, shortest, and average running times
- * of whatever you put in between the start and stop methods. Everything is reported in us
+ * of whatever you put in between the start and stop methods. Times are kept in cycles of get_cycle_count(), and
+ * reported in us. The average is only worked out when printing, so stop_profile() doesn't divide
+ *
+ * C++ code should prefer CycleProfiler.hpp, which adds percentiles and scope guards
  * @author Serj Babayan
  * @copyright Waterloo Aerial Robotics Group 2019
  *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
@@ -24,7 +27,6 @@ typedef struct Profiler {
 	uint64_t prev_time;
 	uint64_t max_diff;
 	uint64_t min_diff;
-	uint64_t average_diff;
 	uint64_t total_diff;
 	uint64_t latest_diff;
 	int num_profiles;
@@ -0,0 +1,122 @@
+/**
+ * Scheduler tracing. FreeRTOS's trace hooks (defined below, and pulled in by FreeRTOSConfig.h) and the interrupt
+ * handlers write small timestamped records into a RAM ring: task switches, ticks, interrupts, and queue, semaphore
+ * and mutex operations. The ring keeps the most recent RTOS_TRACE_LEN records, overwriting the oldest.
+ *
+ * A dump pauses recording and sends the ring out of the debug port as binary log records, so it can be mixed in
+ * with the rest of the log. Tools/decode_log.py --trace saves it to a file, and Tools/trace_to_json.py turns that
+ * into Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+ *
+ * A record is a cycle count read, an atomic add and an 8 byte store, around 20 cycles on the stm32f7. Even at tens
+ * of thousands of events a second that's well under 1% of the cpu
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+//use C interface so the hooks can be called from the kernel and the interrupt handlers
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum RTOSTraceEvent {
+	RTOS_TRACE_TASK_CREATE = 0,
+	RTOS_TRACE_TASK_SWITCHED_IN,
+	RTOS_TRACE_TASK_SWITCHED_OUT,
+	RTOS_TRACE_TICK,
+	RTOS_TRACE_ISR_ENTER,
+	RTOS_TRACE_ISR_EXIT,
+	RTOS_TRACE_QUEUE_CREATE,
+	RTOS_TRACE_QUEUE_SEND,
+	RTOS_TRACE_QUEUE_RECEIVE,
+	RTOS_TRACE_QUEUE_SEND_FROM_ISR,
+	RTOS_TRACE_QUEUE_RECEIVE_FROM_ISR,
+	RTOS_TRACE_QUEUE_BLOCK_SEND,
+	RTOS_TRACE_QUEUE_BLOCK_RECEIVE,
+} RTOSTraceEvent;
+
+/**
+ * What an event happened to depends on the event. Task events carry the task number, interrupt events the exception
+ * number, and queue events the queue number, with the queue's type (so mutexes can be told apart) as the argument.
+ * Ticks carry the bottom 16 bits of the tick count as the argument
+ */
+typedef struct RTOSTraceRecord {
+	uint32_t timestamp; //get_cycle_count()
+	uint8_t event;
+	uint8_t id;
+	uint16_t arg;
+} RTOSTraceRecord;
+
+void rtos_trace_record(uint8_t event, uint8_t id, uint16_t arg);
+
+void rtos_trace_task_created(uint8_t id, const char *name);
+
+/**
+ * @param type FreeRTOS queue type, ie. queueQUEUE_TYPE_MUTEX
+ * @return Number to give the queue, so later events can refer to it
+ */
+uint8_t rtos_trace_queue_created(uint8_t type);
+
+void rtos_trace_queue_named(uint8_t id, const char *name);
+
+/**
+ * Call first and last thing in an interrupt handler
+ */
+void rtos_trace_isr_enter(void);
+
+void rtos_trace_isr_exit(void);
+
+/**
+ * Asks for the trace to be dumped the next time rtos_trace_service() runs. Safe from interrupts
+ */
+void rtos_trace_request_dump(void);
+
+/**
+ * Carries out a requested dump. Blocks until the whole trace is on its way out, so call it from a low priority
+ * task, and not with the scheduler suspended
+ */
+void rtos_trace_service(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/******************************************* FreeRTOS hooks *******************************************/
+
+//FreeRTOSConfig.h sets RTOS_TRACE_ENABLED and includes this, ahead of FreeRTOS.h filling in empty hooks. They're
+//only expanded inside the kernel sources, which is where TCB_t, Queue_t and pxCurrentTCB can be seen.
+//configUSE_TRACE_FACILITY has to be on for the task and queue numbers to exist
+
+#if defined(RTOS_TRACE_ENABLED) && RTOS_TRACE_ENABLED
+
+#define traceTASK_CREATE(pxNewTCB) rtos_trace_task_created((uint8_t) (pxNewTCB)->uxTCBNumber, (pxNewTCB)->pcTaskName)
+
+#define traceTASK_SWITCHED_IN() \
+	rtos_trace_record(RTOS_TRACE_TASK_SWITCHED_IN, (uint8_t) pxCurrentTCB->uxTCBNumber, 0)
+
+#define traceTASK_SWITCHED_OUT() \
+	rtos_trace_record(RTOS_TRACE_TASK_SWITCHED_OUT, (uint8_t) pxCurrentTCB->uxTCBNumber, 0)
+
+#define traceTASK_INCREMENT_TICK(xTickCount) rtos_trace_record(RTOS_TRACE_TICK, 0, (uint16_t) (xTickCount))
+
+#define traceQUEUE_CREATE(pxNewQueue) \
+	(pxNewQueue)->uxQueueNumber = rtos_trace_queue_created((pxNewQueue)->ucQueueType)
+
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName) \
+	rtos_trace_queue_named((uint8_t) ((Queue_t *) (xQueue))->uxQueueNumber, (pcQueueName))
+
+#define RTOS_TRACE_QUEUE(event, pxQueue) \
+	rtos_trace_record((event), (uint8_t) (pxQueue)->uxQueueNumber, (pxQueue)->ucQueueType)
+
+#define traceQUEUE_SEND(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_SEND, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_RECEIVE, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_SEND_FROM_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_RECEIVE_FROM_ISR, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_BLOCK_SEND, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) RTOS_TRACE_QUEUE(RTOS_TRACE_QUEUE_BLOCK_RECEIVE, pxQueue)
+
+#endif
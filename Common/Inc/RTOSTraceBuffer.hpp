@@ -0,0 +1,129 @@
+/**
+ * The ring behind RTOSTrace.h, kept apart from the chip so it can be tested on the host.
+ *
+ * Writers reserve a slot with an atomic add on the write count, so any number of tasks and interrupts can record at
+ * once without a critical section. Once the ring is full the oldest records are overwritten.
+ *
+ * A dump is read out as one stream of bytes, a piece at a time with read_dump(), while recording is paused:
+ *
+ *  header   "RTRC", version, number of names, 2 reserved bytes, number of records (u32), cycle counter rate (u32)
+ *  names    RTOS_TRACE_NAME_LEN + 2 bytes each: kind, id, then the name padded with zeros
+ *  records  8 bytes each, oldest first, laid out as RTOSTraceRecord
+ *
+ * Everything is little endian
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "RTOSTrace.h"
+#include "Status.hpp"
+
+static const uint8_t RTOS_TRACE_DUMP_VERSION = 1;
+static const size_t RTOS_TRACE_HEADER_LEN = 16;
+static const size_t RTOS_TRACE_RECORD_LEN = 8;
+static const size_t RTOS_TRACE_NAME_LEN = 16;
+static const size_t RTOS_TRACE_NAME_ENTRY_LEN = RTOS_TRACE_NAME_LEN + 2;
+static const uint8_t RTOS_TRACE_MAX_NAMES = 24;
+
+typedef enum RTOSTraceNameKind {
+	RTOS_TRACE_NAME_TASK = 0,
+	RTOS_TRACE_NAME_QUEUE,
+	RTOS_TRACE_NAME_ISR,
+} RTOSTraceNameKind;
+
+class RTOSTraceBuffer {
+ public:
+	RTOSTraceBuffer();
+
+	/**
+	 * Records are kept from here on. Anything recorded before init() is ignored
+	 * @param storage Must stay valid for as long as the buffer is used
+	 * @param capacity Number of records storage holds. Must be a power of two
+	 * @param cycles_per_second Rate of the timestamps, put in the dump header
+	 * @return STATUS_CODE_INVALID_ARGS if capacity isn't a power of two
+	 */
+	StatusCode init(RTOSTraceRecord *storage, uint32_t capacity, uint32_t cycles_per_second);
+
+	inline void record(uint32_t timestamp, uint8_t event, uint8_t id, uint16_t arg) {
+		if (!recording.load(std::memory_order_relaxed)) return;
+
+		uint32_t index = written.fetch_add(1, std::memory_order_relaxed) & mask;
+		RTOSTraceRecord &slot = storage[index];
+		slot.timestamp = timestamp;
+		slot.event = event;
+		slot.id = id;
+		slot.arg = arg;
+	}
+
+	/**
+	 * Names a task, queue or interrupt in the dump. Naming something again replaces the old name
+	 * @param kind
+	 * @param id
+	 * @param name Copied, and cut to RTOS_TRACE_NAME_LEN characters
+	 * @return false if the name table is full
+	 */
+	bool set_name(RTOSTraceNameKind kind, uint8_t id, const char *name);
+
+	void pause() { recording.store(false, std::memory_order_relaxed); }
+
+	void resume() { recording.store(storage != nullptr, std::memory_order_relaxed); }
+
+	/**
+	 * Throws away every record, but keeps the names
+	 */
+	void clear() { written.store(0, std::memory_order_relaxed); }
+
+	bool is_recording() const { return recording.load(std::memory_order_relaxed); }
+
+	/**
+	 * @return Records in the ring right now, at most the capacity
+	 */
+	uint32_t size() const;
+
+	/**
+	 * @return Records written since the last clear, including ones that have since been overwritten
+	 */
+	uint32_t get_written() const { return written.load(std::memory_order_relaxed); }
+
+	/**
+	 * @param i 0 is the oldest record still in the ring
+	 */
+	const RTOSTraceRecord &get(uint32_t i) const;
+
+	/**
+	 * @return Total length of the dump, for the records in the ring right now
+	 */
+	size_t dump_len() const;
+
+	/**
+	 * Copies out part of the dump. Pause recording first, or the records can change underneath it
+	 * @param offset Byte of the dump to start at
+	 * @param out
+	 * @param len Most bytes to copy
+	 * @return Bytes copied, 0 once offset reaches the end
+	 */
+	size_t read_dump(size_t offset, uint8_t *out, size_t len) const;
+
+ private:
+	typedef struct TraceName {
+		uint8_t kind;
+		uint8_t id;
+		char name[RTOS_TRACE_NAME_LEN];
+	} TraceName;
+
+	RTOSTraceRecord *storage;
+	uint32_t mask;
+	uint32_t cycles_per_second;
+	std::atomic<uint32_t> written;
+	std::atomic<bool> recording;
+
+	TraceName names[RTOS_TRACE_MAX_NAMES];
+	uint8_t name_count;
+
+	size_t read_dump_piece(size_t offset, uint8_t *out, size_t len) const;
+};
@@ -0,0 +1,111 @@
+/**
+ * Pure decoding of S.BUS frames. Kept free of any hardware dependencies so that it can be unit tested and
+ * benchmarked on a host machine with recorded frames, and shared by any chip that has a receiver attached.
+ *
+ * An S.BUS frame is 25 bytes long:
+ *
+ *  [0]      header (0x0F)
+ *  [1-22]   16 channels, 11 bits each, packed LSB first
+ *  [23]     flags. bit0: digital channel 17, bit1: digital channel 18, bit2: frame lost, bit3: failsafe
+ *  [24]     footer (0x00, or 0x04/0x14/0x24/0x34 for S.BUS2 receivers)
+ *
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Status.hpp"
+
+static const size_t SBUS_FRAME_LEN = 25;
+static const uint8_t SBUS_NUM_CHANNELS = 16;
+static const uint8_t SBUS_HEADER = 0x0F;
+
+//raw channel values the receiver sends out for a 1000us and 2000us pulse
+static const uint16_t SBUS_RAW_MIN = 172;
+static const uint16_t SBUS_RAW_MAX = 1811;
+
+typedef struct SBUSFrame {
+	uint16_t channels[SBUS_NUM_CHANNELS]; //raw 11-bit values, 0-2047
+	bool channel_17;
+	bool channel_18;
+	bool frame_lost; //receiver missed a frame from the transmitter. Channels hold the last good values
+	bool failsafe; //receiver has lost the transmitter entirely and is outputting its failsafe values
+} SBUSFrame;
+
+/**
+ * Returns true if the 25 bytes pointed to by data start with a header and end with a valid footer
+ * @param data
+ */
+bool sbus_is_frame_aligned(const uint8_t *data);
+
+/**
+ * Unpacks a complete frame
+ * @param data Exactly SBUS_FRAME_LEN bytes, starting at the header
+ * @param frame Decoded values are written here
+ * @return STATUS_CODE_INVALID_ARGS if the header or footer is wrong. frame is left untouched in that case
+ */
+StatusCode sbus_decode_frame(const uint8_t *data, SBUSFrame &frame);
+
+/**
+ * Converts a raw channel value into the equivalent pulse width, using the standard
+ * mapping of 172 -> 1000us and 1811 -> 2000us, clamping at both ends
+ * @param raw
+ * @return Pulse width in us
+ */
+uint32_t sbus_raw_to_us(uint16_t raw);
+
+/**
+ * Converts a raw channel value into a 0-100 percentage, clamping at both ends
+ * @param raw
+ */
+uint8_t sbus_raw_to_percent(uint16_t raw);
+
+/**
+ * Re-aligns a stream of bytes onto S.BUS frame boundaries. Bytes should be written directly into buffer()
+ * (up to space() of them), then reported with commit(). Once a complete, aligned frame is sitting in the
+ * buffer it can be decoded in place. If the stream was joined half way through a frame, the buffer is
+ * shifted up to the next header and filling continues from there.
+ */
+class SBUSFrameSync {
+ public:
+	/**
+	 * @return Where the next received bytes should be written to
+	 */
+	uint8_t *buffer() { return &data[length]; }
+
+	/**
+	 * @return How many bytes can be written to buffer() before the frame is complete
+	 */
+	size_t space() const { return SBUS_FRAME_LEN - length; }
+
+	/**
+	 * Report that bytes were written into buffer()
+	 * @param len
+	 * @return true if a complete, aligned frame is now available through frame()
+	 */
+	bool commit(size_t len);
+
+	/**
+	 * @return The aligned frame. Only valid after commit() returned true
+	 */
+	const uint8_t *frame() const { return data; }
+
+	/**
+	 * Drop any partially received frame. Should be called whenever the line goes idle, as frames
+	 * are always sent back to back with a gap in between
+	 */
+	void reset() { length = 0; }
+
+	/**
+	 * @return Number of bytes thrown away so far while searching for a header
+	 */
+	uint32_t dropped_bytes() const { return dropped; }
+
+ private:
+	uint8_t data[SBUS_FRAME_LEN];
+	size_t length = 0;
+	uint32_t dropped = 0;
+};
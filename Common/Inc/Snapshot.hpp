@@ -0,0 +1,88 @@
+/**
+ * Hands the latest value of something from one task to any number of others, without locks or critical sections.
+ *
+ * There are two slots, each with its own sequence number: twice the publish count of the value in it, less one while
+ * it's being written. The writer fills the slot its next publish count picks, then moves the count on, so the slot
+ * readers are being pointed at is never the one being written. A reader copies the slot the count points at, and only
+ * goes again if its sequence number was odd or changed while copying, which takes the writer getting two publishes in
+ * during one copy.
+ *
+ * So readers that preempt the writer always get a value first time, where a single slot seqlock could leave them
+ * spinning on a half written value that the writer never gets to finish. Only one task can publish
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template<typename T>
+class Snapshot {
+	static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied byte by byte");
+
+ public:
+	Snapshot() : published(0) {
+		slots[0].sequence.store(0, std::memory_order_relaxed);
+		slots[1].sequence.store(0, std::memory_order_relaxed);
+	}
+
+	Snapshot(const Snapshot &) = delete;
+	Snapshot &operator=(const Snapshot &) = delete;
+
+	/**
+	 * Makes value the latest. Only ever call this from one task
+	 */
+	void publish(const T &value) {
+		uint32_t count = published.load(std::memory_order_relaxed) + 1;
+		Slot &slot = slots[count & 1];
+
+		slot.sequence.store(2 * count - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		memcpy(&slot.value, &value, sizeof(T));
+
+		slot.sequence.store(2 * count, std::memory_order_release);
+		published.store(count, std::memory_order_release);
+	}
+
+	/**
+	 * Copies out the latest value. Safe from any task or interrupt
+	 * @param value Left untouched if nothing has been published yet
+	 * @return How many values had been published when this one was, so a change means there's a new value. 0 if
+	 * nothing has been published yet. The count can have moved on past the slot while it was being found, so this
+	 * comes from the slot itself
+	 */
+	uint32_t read(T &value) const {
+		for (;;) {
+			uint32_t count = published.load(std::memory_order_acquire);
+			if (count == 0) return 0;
+
+			const Slot &slot = slots[count & 1];
+			uint32_t before = slot.sequence.load(std::memory_order_acquire);
+			if (before & 1) continue;
+
+			memcpy(&value, &slot.value, sizeof(T));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == before) return before / 2;
+		}
+	}
+
+	/**
+	 * @return How many values have been published
+	 */
+	uint32_t count() const { return published.load(std::memory_order_acquire); }
+
+ private:
+	struct Slot {
+		std::atomic<uint32_t> sequence;
+		T value;
+	};
+
+	Slot slots[2];
+	std::atomic<uint32_t> published;
+};
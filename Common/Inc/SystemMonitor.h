@@ -0,0 +1,105 @@
+/**
+ * Works out how much stack, heap and cpu the tasks are using, from what the kernel reports. A monitor task samples
+ * every task's stack high water mark and run time counter, along with the free heap, and feeds them in here.
+ *
+ * Each task's share of the cpu is the growth of its run time counter over the growth of the total since the previous
+ * sample, so it reflects the last sampling period rather than the time since boot. Run time counters are 32 bits and
+ * wrap, which is fine as long as samples are closer together than one wrap.
+ *
+ * Alarms are raised when a threshold is crossed, and system_monitor_update() only returns the ones that weren't
+ * already raised, so each crossing is reported once
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+//use C interface to match the rest of the task level code
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define SYSTEM_MONITOR_MAX_TASKS 12
+#define SYSTEM_MONITOR_NAME_LEN 8 //task names are cut to this in snapshots
+
+typedef enum SystemMonitorAlarm {
+	SYSTEM_MONITOR_ALARM_STACK = 1 << 0, //a task's stack came closer to overflowing than allowed
+	SYSTEM_MONITOR_ALARM_HEAP = 1 << 1, //the free heap got lower than allowed at some point
+	SYSTEM_MONITOR_ALARM_CPU = 1 << 2, //the tasks other than idle used more of the cpu than allowed
+	SYSTEM_MONITOR_ALARM_TASKS = 1 << 3, //more tasks than a snapshot can hold, the rest aren't monitored
+} SystemMonitorAlarm;
+
+typedef struct SystemMonitorThresholds {
+	uint16_t min_stack_free_words;
+	uint32_t min_heap_free_bytes;
+	uint16_t max_cpu_load_permille;
+} SystemMonitorThresholds;
+
+/**
+ * One task, as read from the kernel
+ */
+typedef struct SystemMonitorTaskSample {
+	uint8_t number; //stays the same for as long as the task exists
+	const char *name;
+	uint16_t stack_free_words; //least free stack the task has ever had
+	uint32_t run_time; //total time the task has run for, in run time counter ticks
+	uint8_t is_idle;
+} SystemMonitorTaskSample;
+
+typedef struct SystemMonitorTaskUsage {
+	uint8_t number;
+	char name[SYSTEM_MONITOR_NAME_LEN]; //not terminated if the name fills it
+	uint16_t stack_free_words;
+	uint16_t cpu_permille;
+} SystemMonitorTaskUsage;
+
+/**
+ * Compact summary, for telemetry
+ */
+typedef struct SystemMonitorSnapshot {
+	uint32_t heap_free_bytes;
+	uint32_t heap_min_free_bytes;
+	uint16_t cpu_load_permille; //everything but the idle task
+	uint8_t alarms; //SystemMonitorAlarm bits raised right now
+	uint8_t task_count;
+	SystemMonitorTaskUsage tasks[SYSTEM_MONITOR_MAX_TASKS];
+} SystemMonitorSnapshot;
+
+typedef struct SystemMonitor {
+	SystemMonitorThresholds thresholds;
+	uint8_t has_sampled;
+	uint32_t last_total_run_time;
+	uint8_t last_count;
+	uint8_t last_number[SYSTEM_MONITOR_MAX_TASKS];
+	uint32_t last_run_time[SYSTEM_MONITOR_MAX_TASKS];
+	SystemMonitorSnapshot snapshot;
+} SystemMonitor;
+
+void init_system_monitor(SystemMonitor *monitor, const SystemMonitorThresholds *thresholds);
+
+/**
+ * Takes in a new sample of every task. The cpu shares of the first sample are all 0, since there's nothing to
+ * measure them against yet
+ * @param monitor
+ * @param tasks
+ * @param task_count Any past SYSTEM_MONITOR_MAX_TASKS are left out, and raise SYSTEM_MONITOR_ALARM_TASKS
+ * @param total_run_time Run time counter at the time of the sample
+ * @param heap_free_bytes
+ * @param heap_min_free_bytes Least free heap there's ever been
+ * @return Alarms raised by this sample that weren't raised by the previous one
+ */
+uint8_t system_monitor_update(SystemMonitor *monitor, const SystemMonitorTaskSample *tasks, uint8_t task_count,
+							  uint32_t total_run_time, uint32_t heap_free_bytes, uint32_t heap_min_free_bytes);
+
+/**
+ * @param monitor
+ * @param snapshot Filled in with the results of the last update
+ */
+void get_system_monitor_snapshot(const SystemMonitor *monitor, SystemMonitorSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+/**
+ * Extends a free running 32 bit counter to 64 bits without locks or an overflow interrupt.
+ *
+ * The extender keeps a count of half wraps: the number of full wraps seen so far times two, plus the top bit of the
+ * last counter value it saw. A new reading whose top bit differs from that has moved on by a half wrap (0 -> 1 is
+ * the middle of a wrap, 1 -> 0 is the wrap itself), so the count goes up by one either way, and the upper 32 bits of
+ * the time are the count over two.
+ *
+ * The count is loaded before the counter is read, so a reading is never older than the count it's compared against.
+ * Whoever sees a half wrap first moves the count on with a compare and swap. If that fails another reader already
+ * moved it, and the time worked out is still right, since it only depended on the count loaded before the reading.
+ * This is safe from any number of tasks and interrupts, as long as something reads the time at least once every
+ * half wrap (about 35 minutes for a 1MHz counter)
+ * @copyright Waterloo Aerial Robotics Group 2019
+ *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+class TimebaseExtender {
+ public:
+	TimebaseExtender() : half_wraps(0) {}
+
+	TimebaseExtender(const TimebaseExtender &) = delete;
+	TimebaseExtender &operator=(const TimebaseExtender &) = delete;
+
+	/**
+	 * @param read_counter Called once to read the hardware counter, after the half wrap count has been loaded
+	 * @return The counter extended to 64 bits
+	 */
+	template<typename ReadCounter>
+	inline uint64_t read(ReadCounter read_counter) {
+		uint32_t seen = half_wraps.load(std::memory_order_acquire);
+		uint32_t count = read_counter();
+		uint32_t now = seen + ((seen ^ (count >> 31)) & 1);
+
+		if (now != seen) {
+			half_wraps.compare_exchange_strong(seen, now, std::memory_order_acq_rel);
+		}
+		return ((uint64_t) (now >> 1) << 32) | count;
+	}
+
+	/**
+	 * Only for when the counter itself is reset
+	 */
+	void reset() { half_wraps.store(0, std::memory_order_release); }
+
+ private:
+	std::atomic<uint32_t> half_wraps;
+};
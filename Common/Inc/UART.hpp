@@ -6,22 +6,23 @@
  *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
  *
  *  Notes on DMA:
- *  - You should only setup DMA on the interface if you're expecting to receive constant size packets. Variable size
- *  packets may work, however then you should pick a common multiple of the different sizes of packets. This is because
- *  a DMA interrupt only triggers when the buffer is half full or full, so if the device has sent data that doesn't fill
- *  the buffer, you'll have to wait until enough bytes are received before being able to read it!
+ *  - Received data is handed over whenever the line goes idle (one character time after the last byte), and whenever
+ *  the DMA buffer is half or completely full, so packets of any size can be read as soon as they've arrived. Make the
+ *  buffer at least as big as the largest burst the device sends without pausing
  *
- *  Note that this isn't an issue when sending TX through DMA (just make sure that the dma send buffer is large enough to
- *  fill your largest packet
+ *  - With TX DMA, transmit() copies the data onto a queue and returns straight away, instead of waiting for it to go
+ *  out on the wire. The dma drains the queue in the background. Make the queue large enough to hold everything that's
+ *  sent in a burst, as transmit() turns data away instead of waiting for space
  */
 
 #pragma once
 
 #include "DMA.hpp"
 #include "GPIO.hpp"
+#include "ByteRing.hpp"
+#include "DMATxQueue.hpp"
 #include <stdint.h>
 #include <stdlib.h>
-#include <queue>
 
 //only ports 1 and 2 supported on safety chip
 //only 1, 2, 3, 4 supported on autopilot
@@ -79,11 +80,11 @@ class UARTPort {
 	/**
 	 * Sets up DMA transfers transparently, if the hardware can support it. If possible, attempts to do both tx and RX
 	 * using DMA. If not, may only do RX. If either the parameters are 0, will only enable either the RX/TX buffers respectively
-	 * @param tx_buffer_size Size of DMA buffer when transmitting (used if possible). Try to make this as large as the largest
-	 * 	packet you could possible send
+	 * @param tx_buffer_size Space needed in the transmit queue. Try to make this as large as everything you could send in
+	 * 	one burst. The queue itself is a fixed size per chip, this is only checked against it
 	 * @param rx_buffer_size Size of DMA buffer when receiving. Make this the size of the largest packet you're expecting
 	 * to receive
-	 * @return
+	 * @return STATUS_CODE_UNIMPLEMENTED if the port can't do dma in the requested direction
 	 */
 	StatusCode setupDMA(size_t tx_buffer_size, size_t rx_buffer_size);
 
@@ -115,13 +116,65 @@ class UARTPort {
 	StatusCode read_bytes(uint8_t *data, size_t len, size_t &bytes_read);
 
 	/**
-	 * Transmit a set of data
-	 * @param data
+	 * Works out when a received byte came in, so messages can be timestamped by their first byte however late they're
+	 * read. Only with rx dma
+	 * @param byte_index Counting every byte received since rx dma was set up, from 0
+	 * @param time_us Set to get_system_time_us() when the byte came in, give or take a character
+	 * @return STATUS_CODE_UNINITIALIZED without rx dma. STATUS_CODE_OUT_OF_RANGE if the byte hasn't been received, or
+	 * was received too many hand overs ago to tell
+	 */
+	StatusCode rx_arrival_time(uint32_t byte_index, uint64_t &time_us);
+
+	/**
+	 * Gets the oldest contiguous run of received bytes, so they can be parsed where they are in the receive ring
+	 * instead of being copied out with read_bytes(). Only with rx dma. Give them back with rx_consume(), after which
+	 * the next run (including any that wrapped around the end of the ring) can be peeked at
+	 * @param data Set to the first byte. The bytes belong to the caller until they're consumed, and can be rewritten
+	 * where they are, like decoding a frame over the top of itself
+	 * @param len Set to how many there are
+	 * @return STATUS_CODE_EMPTY if there's nothing. STATUS_CODE_INTERNAL_ERROR if rx dma had to be set up again
+	 * after an error, like read_bytes()
+	 */
+	StatusCode rx_peek(uint8_t *&data, size_t &len);
+
+	/**
+	 * @return Bytes received and not consumed yet. More than rx_peek() hands out when they wrap around the end of the
+	 * ring, so a parser waiting on the rest of a message can tell whether it's still to come or just around the end.
+	 * 0 without rx dma
+	 */
+	size_t rx_available();
+
+	/**
+	 * Gives back bytes that rx_peek() handed out, for dma to reuse
+	 * @param len No more than rx_peek() gave
+	 */
+	StatusCode rx_consume(size_t len);
+
+	/**
+	 * Transmit a set of data. With TX DMA this only queues the data and never blocks. Without it, waits until
+	 * everything has been sent (or the timeout runs out)
+	 * @param data Can be reused as soon as this returns
 	 * @param len
-	 * @return If not enough space in buffer, will return a STATUS_CODE_RESOURCE_EXAUSTED and not transmit
+	 * @return If not enough space in the transmit queue, will return a STATUS_CODE_RESOURCE_EXHAUSTED and not transmit
 	 */
 	StatusCode transmit(uint8_t *data, size_t len);
 
+	/**
+	 * Hands out space in the transmit queue to build a message in place, for senders that would otherwise build it in
+	 * a buffer of their own just to copy it in with transmit(). Only with TX DMA. Nothing else can transmit on the port
+	 * until the space is given back with transmit_commit(), so the port should have one sender
+	 * @param len
+	 * @param region Set to exactly len bytes, in up to two pieces
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if there isn't len free in the queue right now
+	 */
+	StatusCode transmit_reserve(size_t len, DMATxRegion &region);
+
+	/**
+	 * Sends the first len bytes of the space from transmit_reserve()
+	 * @param len 0 gives it all back
+	 */
+	StatusCode transmit_commit(size_t len);
+
  private:
 	GPIOPin rx_pin;
 	GPIOPin tx_pin;
@@ -135,7 +188,13 @@ class UARTPort {
 	bool dma_setup_rx = false;
 	bool dma_setup_tx = false;
 	bool reallocate_dma_buffer = true;
-	std::deque<uint8_t> *rx_queue;
+	ByteRing *rx_ring;
+	DMATxQueue *tx_queue;
 
 	bool is_valid_port();
+	StatusCode setupRXDMA(size_t rx_buffer_size);
+	StatusCode setupTXDMA(size_t tx_buffer_size);
+	StatusCode resetRXDMA();
+	StatusCode resetTXDMA();
+	StatusCode recoverRXDMA();
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "BinaryLog.hpp"
+
+BinaryLog::BinaryLog() : unreported_dropped(0), total_dropped(0) {
+	//no storage yet, init() has to be called before anything else
+}
+
+StatusCode BinaryLog::init(uint8_t *storage, uint32_t capacity) {
+	unreported_dropped = 0;
+	total_dropped = 0;
+	return ring.init(storage, capacity);
+}
+
+bool BinaryLog::write(uint16_t id, const uint8_t *args, uint8_t len) {
+	if (unreported_dropped > 0) {
+		uint8_t count[4];
+		binary_log_pack(count, unreported_dropped);
+
+		//both have to fit, otherwise the drop record would take the space and this one would be lost anyway
+		if (ring.space() < 2 * BINARY_LOG_HEADER_LEN + sizeof(count) + len) {
+			unreported_dropped++;
+			total_dropped++;
+			return false;
+		}
+
+		write_record(BINARY_LOG_DROPPED_ID, count, sizeof(count));
+		unreported_dropped = 0;
+	}
+
+	if (!write_record(id, args, len)) {
+		unreported_dropped++;
+		total_dropped++;
+		return false;
+	}
+	return true;
+}
+
+bool BinaryLog::try_write(uint16_t id, const uint8_t *args, uint8_t len) {
+	size_t needed = BINARY_LOG_HEADER_LEN + len;
+	if (unreported_dropped > 0) needed += BINARY_LOG_HEADER_LEN + 4;
+
+	if (len > BINARY_LOG_MAX_ARGS_LEN || ring.space() < needed) return false;
+	return write(id, args, len);
+}
+
+bool BinaryLog::write_record(uint16_t id, const uint8_t *args, uint8_t len) {
+	if (len > BINARY_LOG_MAX_ARGS_LEN || ring.space() < BINARY_LOG_HEADER_LEN + len) {
+		return false;
+	}
+
+	uint8_t header[BINARY_LOG_HEADER_LEN] = {BINARY_LOG_SYNC, len, (uint8_t) (id & 0xFF), (uint8_t) (id >> 8)};
+
+	ring.push(header, BINARY_LOG_HEADER_LEN);
+	ring.push(args, len);
+	return true;
+}
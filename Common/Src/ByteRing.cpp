@@ -0,0 +1,148 @@
+#include "ByteRing.hpp"
+#include <string.h>
+
+ByteRing::ByteRing() : buffer(nullptr), mask(0), head(0), tail(0) {
+	//no storage yet, init() has to be called before anything else
+}
+
+StatusCode ByteRing::init(uint8_t *storage, uint32_t capacity) {
+	if (storage == nullptr || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	buffer = storage;
+	mask = capacity - 1;
+	head.store(0, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+	return STATUS_CODE_OK;
+}
+
+size_t ByteRing::push(const uint8_t *data, size_t len) {
+	uint32_t h = head.load(std::memory_order_relaxed);
+	uint32_t free = (mask + 1) - (h - tail.load(std::memory_order_acquire));
+
+	if (len > free) {
+		len = free;
+	}
+
+	uint32_t index = h & mask;
+	size_t first = (mask + 1) - index;
+	if (first > len) {
+		first = len;
+	}
+
+	memcpy(&buffer[index], data, first);
+	memcpy(&buffer[0], data + first, len - first);
+
+	head.store(h + (uint32_t) len, std::memory_order_release);
+	return len;
+}
+
+bool ByteRing::push(uint8_t byte) {
+	uint32_t h = head.load(std::memory_order_relaxed);
+
+	if (h - tail.load(std::memory_order_acquire) > mask) {
+		return false;
+	}
+
+	buffer[h & mask] = byte;
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+size_t ByteRing::reserve(uint8_t *&data) {
+	uint32_t h = head.load(std::memory_order_relaxed);
+	uint32_t free = (mask + 1) - (h - tail.load(std::memory_order_acquire));
+	uint32_t index = h & mask;
+	uint32_t to_end = (mask + 1) - index;
+
+	data = &buffer[index];
+	return free < to_end ? free : to_end;
+}
+
+size_t ByteRing::reserve(uint8_t *&first, uint8_t *&second, size_t &second_len) {
+	uint32_t h = head.load(std::memory_order_relaxed);
+	uint32_t free = (mask + 1) - (h - tail.load(std::memory_order_acquire));
+	uint32_t index = h & mask;
+	uint32_t to_end = (mask + 1) - index;
+	uint32_t first_len = free < to_end ? free : to_end;
+
+	first = &buffer[index];
+	second = buffer;
+	second_len = free - first_len;
+	return first_len;
+}
+
+void ByteRing::commit(size_t len) {
+	head.store(head.load(std::memory_order_relaxed) + (uint32_t) len, std::memory_order_release);
+}
+
+size_t ByteRing::space() const {
+	return (mask + 1) - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+}
+
+size_t ByteRing::pop(uint8_t *data, size_t len) {
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	uint32_t available = head.load(std::memory_order_acquire) - t;
+
+	if (len > available) {
+		len = available;
+	}
+
+	uint32_t index = t & mask;
+	size_t first = (mask + 1) - index;
+	if (first > len) {
+		first = len;
+	}
+
+	memcpy(data, &buffer[index], first);
+	memcpy(data + first, &buffer[0], len - first);
+
+	tail.store(t + (uint32_t) len, std::memory_order_release);
+	return len;
+}
+
+bool ByteRing::pop(uint8_t &byte) {
+	uint32_t t = tail.load(std::memory_order_relaxed);
+
+	if (head.load(std::memory_order_acquire) == t) {
+		return false;
+	}
+
+	byte = buffer[t & mask];
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+size_t ByteRing::unread_run(uint8_t *&data) const {
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	uint32_t available = head.load(std::memory_order_acquire) - t;
+	uint32_t index = t & mask;
+	uint32_t to_end = (mask + 1) - index;
+
+	data = &buffer[index];
+	return available < to_end ? available : to_end;
+}
+
+size_t ByteRing::peek(const uint8_t *&data) const {
+	uint8_t *run;
+	size_t len = unread_run(run);
+	data = run;
+	return len;
+}
+
+size_t ByteRing::peek(uint8_t *&data) {
+	return unread_run(data);
+}
+
+void ByteRing::consume(size_t len) {
+	tail.store(tail.load(std::memory_order_relaxed) + (uint32_t) len, std::memory_order_release);
+}
+
+void ByteRing::clear() {
+	tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t ByteRing::size() const {
+	return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,20 @@
+#include "Checksum.h"
+
+static const uint16_t CRC16_CCITT_NIBBLE_TABLE[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t crc16_ccitt_update(uint16_t crc, const void *data, size_t len) {
+	const uint8_t *bytes = (const uint8_t *) data;
+
+	for (size_t i = 0; i < len; i++) {
+		crc = (uint16_t) ((crc << 4) ^ CRC16_CCITT_NIBBLE_TABLE[(crc >> 12) ^ (bytes[i] >> 4)]);
+		crc = (uint16_t) ((crc << 4) ^ CRC16_CCITT_NIBBLE_TABLE[(crc >> 12) ^ (bytes[i] & 0x0F)]);
+	}
+	return crc;
+}
+
+uint16_t crc16_ccitt(const void *data, size_t len) {
+	return crc16_ccitt_update(CRC16_CCITT_INIT, data, len);
+}
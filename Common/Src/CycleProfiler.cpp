@@ -0,0 +1,115 @@
+#include "CycleProfiler.hpp"
+#include <stdio.h>
+
+//longest line print_stats() makes, with a long name
+static const size_t CYCLE_PROFILER_LINE_LEN = 192;
+
+static CycleProfiler *registry_head = nullptr;
+
+CycleProfiler::CycleProfiler(const char *name) : name(name), next_profiler(registry_head), started_at(0) {
+	reset();
+	registry_head = this;
+}
+
+CycleProfiler::~CycleProfiler() {
+	CycleProfiler **link = &registry_head;
+	while (*link != nullptr) {
+		if (*link == this) {
+			*link = next_profiler;
+			return;
+		}
+		link = &(*link)->next_profiler;
+	}
+}
+
+void CycleProfiler::reset() {
+	count = 0;
+	total = 0;
+	latest = 0;
+	max = 0;
+	min = UINT32_MAX;
+	for (uint8_t i = 0; i < CYCLE_PROFILER_NUM_BUCKETS; i++) {
+		histogram[i] = 0;
+	}
+}
+
+uint32_t CycleProfiler::get_mean() const {
+	if (count == 0) return 0;
+	return (uint32_t) (total / count);
+}
+
+uint32_t CycleProfiler::get_percentile(uint8_t percent) const {
+	if (count == 0) return 0;
+	if (percent > 100) percent = 100;
+
+	//rank of the sample the percentile lands on, rounded up so p100 is the last one
+	uint32_t rank = (uint32_t) (((uint64_t) count * percent + 99) / 100);
+	if (rank == 0) rank = 1;
+
+	uint32_t seen = 0;
+	for (uint8_t i = 0; i < CYCLE_PROFILER_NUM_BUCKETS; i++) {
+		seen += histogram[i];
+		if (seen >= rank) {
+			uint32_t bound = bucket_upper_bound(i);
+			if (bound > max) return max;
+			if (bound < min) return min;
+			return bound;
+		}
+	}
+
+	return max;
+}
+
+uint32_t CycleProfiler::bucket_upper_bound(uint8_t bucket) {
+	if (bucket < CYCLE_PROFILER_SUB_BUCKETS) return bucket;
+
+	uint8_t shift = bucket / CYCLE_PROFILER_SUB_BUCKETS - 1;
+	uint32_t lower = (uint32_t) (CYCLE_PROFILER_SUB_BUCKETS + bucket % CYCLE_PROFILER_SUB_BUCKETS) << shift;
+	return lower + ((1UL << shift) - 1);
+}
+
+//cycles to us with one decimal, as tenths
+static uint32_t cycles_to_tenths_us(uint32_t cycles) {
+	uint32_t frequency = get_cycle_count_frequency();
+	if (frequency < 10000000UL) {
+		return (uint32_t) ((uint64_t) cycles * 10000000ULL / frequency);
+	}
+	return cycles / (frequency / 10000000UL);
+}
+
+int CycleProfiler::print_stats(char *buffer, size_t len) const {
+	uint32_t mean = get_mean();
+	uint32_t p99 = get_percentile(99);
+	uint32_t mean_us = cycles_to_tenths_us(mean);
+	uint32_t p99_us = cycles_to_tenths_us(p99);
+	uint32_t max_us = cycles_to_tenths_us(max);
+
+	return snprintf(buffer, len, "%s: n %lu, cycles min %lu p50 %lu p90 %lu p99 %lu max %lu mean %lu, "
+								 "us mean %lu.%lu p99 %lu.%lu max %lu.%lu",
+					name, (unsigned long) count, (unsigned long) get_min(), (unsigned long) get_percentile(50),
+					(unsigned long) get_percentile(90), (unsigned long) p99, (unsigned long) max,
+					(unsigned long) mean, (unsigned long) (mean_us / 10), (unsigned long) (mean_us % 10),
+					(unsigned long) (p99_us / 10), (unsigned long) (p99_us % 10),
+					(unsigned long) (max_us / 10), (unsigned long) (max_us % 10));
+}
+
+CycleProfiler *CycleProfiler::first() {
+	return registry_head;
+}
+
+void CycleProfiler::reset_all() {
+	for (CycleProfiler *profiler = registry_head; profiler != nullptr; profiler = profiler->next_profiler) {
+		profiler->reset();
+	}
+}
+
+void CycleProfiler::print_all(void (*print)(const char *line)) {
+	char line[CYCLE_PROFILER_LINE_LEN];
+
+	for (CycleProfiler *profiler = registry_head; profiler != nullptr; profiler = profiler->next_profiler) {
+		if (profiler->count == 0) continue;
+
+		profiler->print_stats(line, sizeof(line));
+		print(line);
+	}
+}
@@ -0,0 +1,87 @@
+#include "DMA.hpp"
+#include "ByteRing.hpp"
+#include "Clock.hpp"
+
+void resetDMAConfig(DMAConfig *config, size_t dma_buffer_len) {
+	config->reset = false;
+	config->dma_buffer_len = dma_buffer_len;
+	config->read_pos = 0;
+	config->dropped_bytes = 0;
+}
+
+void resetDMARXStamps(DMAConfig *config) {
+	config->received_bytes = 0;
+	config->rx_events = 0;
+}
+
+size_t copyDMARXRegion(DMAConfig *config, uint32_t remaining) {
+	auto ring = static_cast<ByteRing *>(config->queue);
+	size_t len = config->dma_buffer_len;
+	size_t start = config->read_pos;
+
+	//in circular mode the counter reloads as soon as it reaches 0, so a full buffer reads as being back at the start
+	size_t pos = (remaining < len) ? len - remaining : 0;
+
+	if (pos == start) return 0;
+
+	size_t length, pushed;
+
+	if (pos > start) {
+		length = pos - start;
+		pushed = ring->push(&config->dma_buffer[start], length);
+	} else {
+		//the new data runs off the end of the buffer and carries on from the start
+		length = len - start + pos;
+		pushed = ring->push(&config->dma_buffer[start], len - start);
+		pushed += ring->push(&config->dma_buffer[0], pos);
+	}
+
+	config->read_pos = pos;
+	config->dropped_bytes += (uint32_t) (length - pushed);
+
+	if (pushed > 0) {
+		//the new stamp goes in the oldest slot, and only counts once rx_events moves on to it
+		uint32_t received = config->received_bytes + (uint32_t) pushed;
+		DMARXStamp &stamp = config->stamps[(config->rx_events + 1) % DMA_RX_STAMPS];
+		stamp.received_bytes = received;
+		stamp.time_us = (uint32_t) get_system_time_us();
+
+		config->received_bytes = received;
+		config->rx_events = config->rx_events + 1;
+	}
+
+	return pushed;
+}
+
+bool getDMARXArrival(const DMAConfig *config, uint32_t byte_index, uint32_t byte_time_us, uint32_t *time_us) {
+	DMARXStamp stamps[DMA_RX_STAMPS];
+	uint32_t events;
+
+	//an interrupt in the middle of copying could have overwritten a stamp, so go again until none came in
+	do {
+		events = config->rx_events;
+		for (uint32_t i = 0; i < DMA_RX_STAMPS; i++) {
+			stamps[i].received_bytes = config->stamps[i].received_bytes;
+			stamps[i].time_us = config->stamps[i].time_us;
+		}
+	} while (events != config->rx_events);
+
+	//newest first, back to the first hand over that included the byte. The oldest slot is left out, it's the next
+	//one to be overwritten
+	uint32_t available = events < DMA_RX_STAMPS - 1 ? events : DMA_RX_STAMPS - 1;
+	const DMARXStamp *delivered = nullptr;
+	uint32_t checked;
+
+	for (checked = 0; checked < available; checked++) {
+		const DMARXStamp &stamp = stamps[(events - checked) % DMA_RX_STAMPS];
+		if ((int32_t) (stamp.received_bytes - byte_index) <= 0) break; //it came in after this hand over
+		delivered = &stamp;
+	}
+
+	//if every stamp left includes it, it could have come in with one that's been forgotten
+	if (delivered == nullptr || (checked == available && events > available)) return false;
+
+	//the bytes in a hand over came in back to back, ending just before it
+	*time_us = delivered->time_us - (delivered->received_bytes - 1 - byte_index) * byte_time_us;
+	return true;
+}
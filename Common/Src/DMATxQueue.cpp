@@ -0,0 +1,92 @@
+#include "DMATxQueue.hpp"
+
+DMATxQueue::DMATxQueue() : start(nullptr), context(nullptr), in_flight(0), rejected_writes(0) {
+	//no storage yet, init() has to be called before anything else
+}
+
+StatusCode DMATxQueue::init(uint8_t *storage, uint32_t capacity, DMATxStartFunction start, void *context) {
+	if (start == nullptr) return STATUS_CODE_INVALID_ARGS;
+
+	StatusCode status = ring.init(storage, capacity);
+	if (status != STATUS_CODE_OK) return status;
+
+	this->start = start;
+	this->context = context;
+	in_flight = 0;
+	rejected_writes = 0;
+	return STATUS_CODE_OK;
+}
+
+StatusCode DMATxQueue::write(const uint8_t *data, size_t len) {
+	if (start == nullptr) return STATUS_CODE_UNINITIALIZED;
+	if (len == 0) return STATUS_CODE_OK;
+	if (data == nullptr || len > ring.capacity()) return STATUS_CODE_INVALID_ARGS;
+
+	if (len > ring.space()) {
+		rejected_writes = rejected_writes + 1;
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	ring.push(data, len);
+
+	if (in_flight == 0) {
+		start_next();
+	}
+	return STATUS_CODE_OK;
+}
+
+StatusCode DMATxQueue::reserve(size_t len, DMATxRegion &region) {
+	if (start == nullptr) return STATUS_CODE_UNINITIALIZED;
+	if (len > ring.capacity()) return STATUS_CODE_INVALID_ARGS;
+
+	size_t second_len;
+	size_t first_len = ring.reserve(region.first, region.second, second_len);
+	if (len > first_len + second_len) {
+		rejected_writes = rejected_writes + 1;
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	region.first_len = len < first_len ? len : first_len;
+	region.second_len = len - region.first_len;
+	return STATUS_CODE_OK;
+}
+
+void DMATxQueue::commit(size_t len) {
+	if (len == 0) return;
+
+	ring.commit(len);
+
+	if (in_flight == 0) {
+		start_next();
+	}
+}
+
+void DMATxQueue::transfer_complete() {
+	//a stray completion (say after a reset) has nothing to free
+	if (in_flight == 0) return;
+
+	ring.consume(in_flight);
+	in_flight = 0;
+	start_next();
+}
+
+void DMATxQueue::transfer_aborted() {
+	in_flight = 0;
+}
+
+void DMATxQueue::clear() {
+	in_flight = 0;
+	ring.clear();
+}
+
+void DMATxQueue::start_next() {
+	const uint8_t *region;
+	size_t len = ring.peek(region);
+	if (len == 0) return;
+
+	//set before starting, so a backend that finishes inside start() can already call transfer_complete()
+	in_flight = len;
+	if (!start(context, region, len)) {
+		in_flight = 0;
+	}
+}
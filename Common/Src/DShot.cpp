@@ -0,0 +1,136 @@
+#include "DShot.hpp"
+
+static const uint8_t DSHOT_REPLY_BITS = 21; //start bit + 4 GCR nibbles of 5 bits
+static const uint16_t DSHOT_ERPM_STOPPED = 0x0FFF;
+static const uint8_t GCR_INVALID = 0xFF;
+
+//maps the 5 bit GCR codes back onto the nibbles they encode
+static const uint8_t GCR_DECODE[32] = {
+	GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID, GCR_INVALID,
+	GCR_INVALID, 0x9, 0xA, 0xB, GCR_INVALID, 0xD, 0xE, 0xF,
+	GCR_INVALID, GCR_INVALID, 0x2, 0x3, GCR_INVALID, 0x5, 0x6, 0x7,
+	GCR_INVALID, 0x0, 0x8, 0x1, GCR_INVALID, 0x4, 0xC, GCR_INVALID
+};
+
+uint32_t dshot_bitrate(DShotSpeed speed) {
+	switch (speed) {
+		case DSHOT_150: return 150000;
+		case DSHOT_300: return 300000;
+		case DSHOT_600: return 600000;
+		default: return 0;
+	}
+}
+
+StatusCode dshot_get_timing(DShotSpeed speed, uint32_t timer_hz, DShotTiming &timing) {
+	uint32_t bitrate = dshot_bitrate(speed);
+	if (bitrate == 0) return STATUS_CODE_INVALID_ARGS;
+
+	uint32_t period = (timer_hz + bitrate / 2) / bitrate;
+
+	//need enough ticks per bit to tell a 37.5% pulse from a 75% one, and it has to fit in a 16 bit timer
+	if (period < 8 || period > UINT16_MAX) return STATUS_CODE_OUT_OF_RANGE;
+
+	timing.period = (uint16_t) period;
+	timing.bit_1 = (uint16_t) ((period * 3 + 2) / 4);
+	timing.bit_0 = (uint16_t) ((period * 3 + 4) / 8);
+	return STATUS_CODE_OK;
+}
+
+uint16_t dshot_throttle_value(uint16_t throttle) {
+	if (throttle >= DSHOT_THROTTLE_RANGE) {
+		return DSHOT_THROTTLE_MAX;
+	}
+	return (uint16_t) (throttle + DSHOT_THROTTLE_MIN);
+}
+
+uint16_t dshot_encode_packet(uint16_t value, bool telemetry, bool bidirectional) {
+	if (value > DSHOT_THROTTLE_MAX) {
+		value = DSHOT_THROTTLE_MAX;
+	}
+
+	uint16_t packet = (uint16_t) ((value << 1) | (telemetry ? 1 : 0));
+
+	uint16_t crc = (uint16_t) (packet ^ (packet >> 4) ^ (packet >> 8));
+	if (bidirectional) {
+		crc = (uint16_t) ~crc;
+	}
+
+	return (uint16_t) ((packet << 4) | (crc & 0x0F));
+}
+
+void dshot_fill_burst_buffer(const uint16_t *packets, uint8_t num_channels, const DShotTiming &timing,
+							 uint16_t *buffer) {
+	for (uint8_t ch = 0; ch < num_channels; ch++) {
+		uint16_t packet = packets[ch];
+		uint16_t *out = &buffer[ch];
+
+		for (uint8_t bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+			*out = (packet & 0x8000) ? timing.bit_1 : timing.bit_0;
+			packet = (uint16_t) (packet << 1);
+			out += num_channels;
+		}
+
+		for (uint8_t slot = 0; slot < DSHOT_FRAME_TRAILING_SLOTS; slot++) {
+			*out = 0;
+			out += num_channels;
+		}
+	}
+}
+
+StatusCode dshot_decode_erpm(uint32_t gcr, uint32_t &erpm) {
+	uint32_t value = 0;
+
+	for (int8_t shift = 15; shift >= 0; shift -= 5) {
+		uint8_t nibble = GCR_DECODE[(gcr >> shift) & 0x1F];
+		if (nibble == GCR_INVALID) return STATUS_CODE_INVALID_ARGS;
+
+		value = (value << 4) | nibble;
+	}
+
+	//xor of all four nibbles, including the crc, comes out as 0xF for a good reply
+	uint32_t crc = value ^ (value >> 8);
+	crc = crc ^ (crc >> 4);
+	if ((crc & 0x0F) != 0x0F) return STATUS_CODE_INVALID_ARGS;
+
+	value >>= 4;
+	if (value == DSHOT_ERPM_STOPPED) {
+		erpm = 0;
+		return STATUS_CODE_OK;
+	}
+
+	//3 bit exponent and 9 bit mantissa, giving the time per electrical revolution in us
+	uint32_t period_us = (value & 0x1FF) << (value >> 9);
+	if (period_us == 0) return STATUS_CODE_INVALID_ARGS;
+
+	erpm = (60000000UL + period_us / 2) / period_us;
+	return STATUS_CODE_OK;
+}
+
+StatusCode dshot_decode_erpm_edges(const uint16_t *edges, size_t count, uint16_t ticks_per_bit, uint32_t &erpm) {
+	if (edges == nullptr || count == 0 || ticks_per_bit == 0) return STATUS_CODE_INVALID_ARGS;
+
+	uint32_t value = 0;
+	uint8_t bits = 0;
+
+	//every edge is a 1, followed by as many 0s as fit in the gap to the next edge. The line goes idle after
+	//the last edge, so whatever bits are left over belong to it
+	for (size_t i = 1; i <= count; i++) {
+		uint8_t len;
+
+		if (i < count) {
+			uint16_t gap = (uint16_t) (edges[i] - edges[i - 1]);
+			len = (uint8_t) ((gap + ticks_per_bit / 2) / ticks_per_bit);
+		} else {
+			len = (uint8_t) (DSHOT_REPLY_BITS - bits);
+		}
+
+		if (len == 0 || bits + len > DSHOT_REPLY_BITS) return STATUS_CODE_INVALID_ARGS;
+
+		value = (value << len) | (1UL << (len - 1));
+		bits = (uint8_t) (bits + len);
+	}
+
+	if (bits != DSHOT_REPLY_BITS) return STATUS_CODE_INVALID_ARGS;
+
+	return dshot_decode_erpm(value & 0xFFFFF, erpm);
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 static const uint32_t DEBUG_BAUDRATE = 115200;
+static const size_t DEBUG_TX_QUEUE_LEN = 256;
 
 UARTPort port;
 bool port_setup = false;
@@ -40,7 +41,12 @@ StatusCode init_debug(UARTPortNum num, bool flip_tx_rx) {
 
 	port_setup = true;
 
-	return port.setup();
+	StatusCode status = port.setup();
+	if (status != STATUS_CODE_OK) return status;
+
+	//queue messages up for the dma so printing doesn't wait on the wire. Ports without tx dma stay blocking
+	port.setupDMA(DEBUG_TX_QUEUE_LEN, 0);
+	return STATUS_CODE_OK;
 }
 
 static void print_msg(const char *string, size_t len) {
@@ -49,6 +55,11 @@ static void print_msg(const char *string, size_t len) {
 	}
 }
 
+StatusCode debug_transmit(const uint8_t *data, size_t len) {
+	if (!port_setup) return STATUS_CODE_UNINITIALIZED;
+	return port.transmit((uint8_t *) data, len);
+}
+
 void debug_array(const char *string, uint8_t *data, size_t data_size, bool display_char) {
 	int len = sprintf(buffer, "[DATA] %s: ", string);
 	int end = 0;
@@ -0,0 +1,92 @@
+#include "FramedPort.hpp"
+#include <string.h>
+
+static void push_onto_queue(void *context, const uint8_t *packet, size_t len) {
+	static_cast<FrameQueue *>(context)->push(packet, len);
+}
+
+FramedPort::FramedPort(UARTPort &port, FramingFormat format, uint8_t *buffer, size_t capacity)
+	: port(port), format(format), frames(format, buffer, capacity), handler_count(0), in_place(0) {
+}
+
+StatusCode FramedPort::add_handler(FrameHandler handler, void *context) {
+	if (handler == nullptr) return STATUS_CODE_INVALID_ARGS;
+	if (handler_count == FRAMED_PORT_MAX_HANDLERS) return STATUS_CODE_RESOURCE_EXHAUSTED;
+
+	handlers[handler_count] = handler;
+	contexts[handler_count] = context;
+	handler_count++;
+	return STATUS_CODE_OK;
+}
+
+StatusCode FramedPort::add_queue(FrameQueue &queue) {
+	return add_handler(push_onto_queue, &queue);
+}
+
+void FramedPort::deliver(const uint8_t *packet, size_t len) {
+	for (uint8_t i = 0; i < handler_count; i++) {
+		handlers[i](contexts[i], packet, len);
+	}
+}
+
+size_t FramedPort::receive(size_t max_bytes) {
+	uint8_t delimiter = framing_delimiter(format);
+	size_t delivered = 0;
+
+	while (max_bytes > 0) {
+		uint8_t *data;
+		size_t len;
+		StatusCode status = port.rx_peek(data, len);
+		if (status == STATUS_CODE_INTERNAL_ERROR) {
+			//the receiver was set up again, so whatever frame was part way through is gone
+			frames.reset();
+			break;
+		}
+		if (status != STATUS_CODE_OK) break;
+		if (len > max_bytes) len = max_bytes;
+
+		if (frames.idle()) {
+			uint8_t *end = static_cast<uint8_t *>(memchr(data, delimiter, len));
+			if (end != nullptr) {
+				//the whole frame is right here, so the packet's decoded over it and handed out from the ring
+				size_t frame_len = (size_t) (end - data);
+				size_t packet_len;
+				if (frame_len > 0 && frames.decode_in_place(data, frame_len, packet_len)) {
+					in_place++;
+					delivered++;
+					deliver(data, packet_len);
+				}
+
+				port.rx_consume(frame_len + 1);
+				max_bytes -= frame_len + 1;
+				continue;
+			}
+
+			//the rest of the frame is still to come, so it's left to be decoded in place once it's here. Unless it's
+			//wrapped around the end of the ring, or it's already too long to be a frame
+			if (len == port.rx_available() && len < frames.max_frame_len()) break;
+		}
+
+		bool complete;
+		size_t used = frames.feed(data, len, complete);
+		port.rx_consume(used);
+		max_bytes -= used;
+
+		if (complete) {
+			delivered++;
+			deliver(frames.packet(), frames.packet_len());
+		}
+	}
+
+	return delivered;
+}
+
+StatusCode FramedPort::send(const uint8_t *packet, size_t len) {
+	DMATxRegion region;
+	StatusCode status = port.transmit_reserve(framing_max_frame_len(format, len), region);
+	if (status != STATUS_CODE_OK) return status;
+
+	FrameWriter writer(format, region);
+	writer.put_bytes(packet, len);
+	return port.transmit_commit(writer.finish());
+}
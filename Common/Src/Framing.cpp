@@ -0,0 +1,356 @@
+#include "Framing.hpp"
+#include "Checksum.h"
+#include <string.h>
+
+static const uint8_t FRAMING_COBS_FULL_BLOCK = 0xFF;
+static const size_t FRAMING_QUEUE_HEADER_LEN = 2;
+
+static size_t crc_len(FramingFormat format) {
+	return format.crc ? FRAMING_CRC_LEN : 0;
+}
+
+size_t framing_max_frame_len(FramingFormat format, size_t packet_len) {
+	size_t content = packet_len + crc_len(format);
+
+	if (format.encoding == FRAMING_SLIP) {
+		//the END in front, every byte escaped, and the END after
+		return 1 + 2 * content + 1;
+	}
+
+	//a code byte for every 254 bytes (one for nothing at all), and the 0
+	size_t codes = content > 0 ? 1 + (content - 1) / FRAMING_COBS_MAX_BLOCK : 1;
+	return content + codes + 1;
+}
+
+/***********************************************************************************************************************
+ * Encoding
+ **********************************************************************************************************************/
+
+FrameWriter::FrameWriter(FramingFormat format, const DMATxRegion &region)
+	: format(format), region(region), position(0), code_position(0), code(1), crc(CRC16_CCITT_INIT) {
+	if (format.encoding == FRAMING_COBS) {
+		//byte 0 is left for the first code byte
+		position = 1;
+	} else {
+		//flushes out whatever noise the receiver picked up since the last frame
+		emit(FRAMING_SLIP_END);
+	}
+}
+
+void FrameWriter::write_at(size_t index, uint8_t byte) {
+	//anything past the space would land on data that's queued already
+	if (index < region.first_len) {
+		region.first[index] = byte;
+	} else if (index - region.first_len < region.second_len) {
+		region.second[index - region.first_len] = byte;
+	}
+}
+
+void FrameWriter::emit(uint8_t byte) {
+	write_at(position++, byte);
+}
+
+void FrameWriter::end_block() {
+	write_at(code_position, code);
+	code_position = position++;
+	code = 1;
+}
+
+void FrameWriter::encode(uint8_t byte) {
+	if (format.encoding == FRAMING_SLIP) {
+		if (byte == FRAMING_SLIP_END) {
+			emit(FRAMING_SLIP_ESC);
+			emit(FRAMING_SLIP_ESC_END);
+		} else if (byte == FRAMING_SLIP_ESC) {
+			emit(FRAMING_SLIP_ESC);
+			emit(FRAMING_SLIP_ESC_ESC);
+		} else {
+			emit(byte);
+		}
+		return;
+	}
+
+	//each 0 becomes the distance to the next one, as the code byte that starts the block after it. A full block only
+	//ends once there's something after it, so a frame ending on one doesn't need another code byte
+	if (code == FRAMING_COBS_FULL_BLOCK) end_block();
+
+	if (byte == 0) {
+		end_block();
+	} else {
+		emit(byte);
+		code++;
+	}
+}
+
+void FrameWriter::put_u8(uint8_t value) {
+	if (format.crc) crc = crc16_ccitt_update(crc, &value, 1);
+	encode(value);
+}
+
+void FrameWriter::put_u16(uint16_t value) {
+	put_u8((uint8_t) value);
+	put_u8((uint8_t) (value >> 8));
+}
+
+void FrameWriter::put_u32(uint32_t value) {
+	put_u8((uint8_t) value);
+	put_u8((uint8_t) (value >> 8));
+	put_u8((uint8_t) (value >> 16));
+	put_u8((uint8_t) (value >> 24));
+}
+
+void FrameWriter::put_float(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	put_u32(bits);
+}
+
+void FrameWriter::put_bytes(const uint8_t *data, size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		put_u8(data[i]);
+	}
+}
+
+size_t FrameWriter::finish() {
+	if (format.crc) {
+		uint16_t value = crc;
+		encode((uint8_t) value);
+		encode((uint8_t) (value >> 8));
+	}
+
+	if (format.encoding == FRAMING_COBS) {
+		write_at(code_position, code);
+		emit(0);
+	} else {
+		emit(FRAMING_SLIP_END);
+	}
+
+	return position <= region.first_len + region.second_len ? position : 0;
+}
+
+size_t framing_encode(FramingFormat format, const uint8_t *packet, size_t len, uint8_t *out, size_t out_len) {
+	DMATxRegion region = {out, out_len, nullptr, 0};
+	FrameWriter writer(format, region);
+	writer.put_bytes(packet, len);
+	return writer.finish();
+}
+
+/***********************************************************************************************************************
+ * Decoding
+ **********************************************************************************************************************/
+
+FrameDecoder::FrameDecoder(FramingFormat format, uint8_t *buffer, size_t capacity)
+	: format(format), buffer(buffer), capacity(capacity), finished_len(0), frames(0), errors(0) {
+	reset();
+}
+
+void FrameDecoder::reset() {
+	length = 0;
+	block_left = 0;
+	zero_pending = false;
+	escaped = false;
+	discarding = false;
+	crc = CRC16_CCITT_INIT;
+}
+
+bool FrameDecoder::idle() const {
+	return length == 0 && block_left == 0 && !zero_pending && !escaped && !discarding;
+}
+
+size_t FrameDecoder::max_frame_len() const {
+	size_t crc_bytes = crc_len(format);
+	return framing_max_frame_len(format, capacity > crc_bytes ? capacity - crc_bytes : 0);
+}
+
+size_t FrameDecoder::feed(const uint8_t *data, size_t len, bool &complete) {
+	uint8_t delimiter = framing_delimiter(format);
+	complete = false;
+
+	for (size_t i = 0; i < len; i++) {
+		uint8_t byte = data[i];
+
+		if (byte == delimiter) {
+			end_frame(complete);
+			if (complete) return i + 1;
+			continue;
+		}
+		if (discarding) continue;
+
+		if (format.encoding == FRAMING_COBS) {
+			if (block_left == 0) {
+				//a code byte: the distance to the next 0, which the block it starts ends in unless it's a full one
+				if (zero_pending) append(0);
+				block_left = (uint8_t) (byte - 1);
+				zero_pending = byte != FRAMING_COBS_FULL_BLOCK;
+			} else {
+				append(byte);
+				block_left--;
+			}
+		} else if (escaped) {
+			escaped = false;
+			if (byte == FRAMING_SLIP_ESC_END) {
+				append(FRAMING_SLIP_END);
+			} else if (byte == FRAMING_SLIP_ESC_ESC) {
+				append(FRAMING_SLIP_ESC);
+			} else {
+				discarding = true;
+			}
+		} else if (byte == FRAMING_SLIP_ESC) {
+			escaped = true;
+		} else {
+			append(byte);
+		}
+	}
+
+	return len;
+}
+
+void FrameDecoder::append(uint8_t byte) {
+	if (length == capacity) {
+		discarding = true;
+		return;
+	}
+
+	//the last two bytes are the crc, so each byte is only added to it once two more have come in after it
+	if (format.crc && length >= FRAMING_CRC_LEN) {
+		crc = crc16_ccitt_update(crc, &buffer[length - FRAMING_CRC_LEN], 1);
+	}
+	buffer[length++] = byte;
+}
+
+void FrameDecoder::end_frame(bool &complete) {
+	//delimiters back to back are just an idle line
+	bool empty = idle();
+
+	bool good = !discarding && block_left == 0 && !escaped && length > 0 && length >= crc_len(format);
+	if (good && format.crc) {
+		good = crc == (uint16_t) (buffer[length - 2] | (buffer[length - 1] << 8));
+	}
+
+	if (good) {
+		finished_len = length - crc_len(format);
+		frames++;
+		complete = true;
+	} else if (!empty) {
+		errors++;
+	}
+
+	reset();
+}
+
+bool FrameDecoder::decode_in_place(uint8_t *frame, size_t len, size_t &packet_len) {
+	if (len == 0) return false;
+
+	//the decoded frame is never longer than what's left to read, so it can be written over the start of it
+	size_t read = 0;
+	size_t written = 0;
+	bool good = true;
+
+	if (format.encoding == FRAMING_COBS) {
+		while (read < len) {
+			uint8_t code = frame[read++];
+			if (code == 0 || code - 1u > len - read) {
+				good = false;
+				break;
+			}
+
+			memmove(&frame[written], &frame[read], code - 1u);
+			written += code - 1u;
+			read += code - 1u;
+			if (code != FRAMING_COBS_FULL_BLOCK && read < len) frame[written++] = 0;
+		}
+	} else {
+		while (read < len) {
+			uint8_t byte = frame[read++];
+			if (byte == FRAMING_SLIP_ESC) {
+				byte = read < len ? frame[read++] : 0;
+				if (byte == FRAMING_SLIP_ESC_END) {
+					byte = FRAMING_SLIP_END;
+				} else if (byte == FRAMING_SLIP_ESC_ESC) {
+					byte = FRAMING_SLIP_ESC;
+				} else {
+					good = false;
+					break;
+				}
+			}
+			frame[written++] = byte;
+		}
+	}
+
+	good = good && written <= capacity && check_in_place(frame, written, packet_len);
+	if (good) {
+		frames++;
+	} else {
+		errors++;
+	}
+	return good;
+}
+
+bool FrameDecoder::check_in_place(const uint8_t *content, size_t len, size_t &packet_len) const {
+	if (len == 0 || len < crc_len(format)) return false;
+
+	packet_len = len - crc_len(format);
+	if (!format.crc) return true;
+
+	uint16_t expected = (uint16_t) (content[packet_len] | (content[packet_len + 1] << 8));
+	return crc16_ccitt(content, packet_len) == expected;
+}
+
+/***********************************************************************************************************************
+ * Queueing
+ **********************************************************************************************************************/
+
+FrameQueue::FrameQueue() : dropped(0) {
+	//no storage yet, init() has to be called before anything else
+}
+
+StatusCode FrameQueue::init(uint8_t *storage, uint32_t capacity) {
+	dropped = 0;
+	return ring.init(storage, capacity);
+}
+
+//copies into the free space from ByteRing::reserve(), offset bytes in, wrapping into its second piece
+static void copy_into(uint8_t *first, size_t first_len, uint8_t *second, size_t offset, const uint8_t *data,
+					  size_t len) {
+	size_t in_first = offset < first_len ? first_len - offset : 0;
+	if (in_first > len) in_first = len;
+
+	memcpy(first + offset, data, in_first);
+	if (len > in_first) memcpy(second + (offset + in_first - first_len), data + in_first, len - in_first);
+}
+
+bool FrameQueue::push(const uint8_t *packet, size_t len) {
+	uint8_t *first;
+	uint8_t *second;
+	size_t second_len;
+	size_t first_len = ring.reserve(first, second, second_len);
+
+	if (len > UINT16_MAX || first_len + second_len < FRAMING_QUEUE_HEADER_LEN + len) {
+		dropped++;
+		return false;
+	}
+
+	//committed in one go, so the other side never sees a length without all of its packet
+	uint8_t header[FRAMING_QUEUE_HEADER_LEN] = {(uint8_t) len, (uint8_t) (len >> 8)};
+	copy_into(first, first_len, second, 0, header, FRAMING_QUEUE_HEADER_LEN);
+	copy_into(first, first_len, second, FRAMING_QUEUE_HEADER_LEN, packet, len);
+	ring.commit(FRAMING_QUEUE_HEADER_LEN + len);
+	return true;
+}
+
+StatusCode FrameQueue::pop(uint8_t *packet, size_t max_len, size_t &len) {
+	len = 0;
+	if (ring.empty()) return STATUS_CODE_EMPTY;
+
+	uint8_t header[FRAMING_QUEUE_HEADER_LEN];
+	ring.pop(header, FRAMING_QUEUE_HEADER_LEN);
+	size_t packet_len = (size_t) (header[0] | (header[1] << 8));
+
+	if (packet_len > max_len) {
+		ring.consume(packet_len);
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	len = ring.pop(packet, packet_len);
+	return STATUS_CODE_OK;
+}
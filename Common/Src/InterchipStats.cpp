@@ -0,0 +1,173 @@
+#include "InterchipStats.h"
+#include "Clock.hpp"
+#include <stdio.h>
+
+static const uint16_t SEQUENCE_HALF_RANGE = 0x8000;
+
+static inline uint32_t now_us() {
+	//32 bits of us wraps every 71 minutes, which is fine as we only ever look at differences
+	return (uint32_t) get_system_time_us();
+}
+
+static inline uint8_t rtt_bucket(uint32_t rtt_us) {
+	uint8_t bucket = 0;
+	uint32_t limit = INTERCHIP_RTT_FIRST_BUCKET_US;
+
+	while (bucket < INTERCHIP_RTT_BUCKETS - 1 && rtt_us >= limit) {
+		limit <<= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+static void record_rtt(InterchipStats *stats, uint32_t rtt_us) {
+	stats->last_rtt_us = rtt_us;
+	if (rtt_us > stats->max_rtt_us) {
+		stats->max_rtt_us = rtt_us;
+	}
+
+	stats->rtt_histogram[rtt_bucket(rtt_us)]++;
+	stats->rtt_samples++;
+
+	//age out old samples so the histogram reflects the recent state of the link
+	if (stats->rtt_samples >= INTERCHIP_RTT_WINDOW) {
+		for (int i = 0; i < INTERCHIP_RTT_BUCKETS; i++) {
+			stats->rtt_histogram[i] >>= 1;
+		}
+		stats->rtt_samples = INTERCHIP_RTT_WINDOW / 2;
+	}
+}
+
+void init_interchip_stats(InterchipStats *stats, uint32_t frame_period_us) {
+	stats->frames_sent = 0;
+	stats->send_overruns = 0;
+	stats->next_sequence = 0;
+
+	for (int i = 0; i < INTERCHIP_RTT_SLOTS; i++) {
+		stats->sent_sequence[i] = 0;
+		stats->sent_time_us[i] = 0;
+	}
+
+	stats->frames_received = 0;
+	stats->crc_failures = 0;
+	stats->transfer_errors = 0;
+	stats->sequence_gaps = 0;
+	stats->late_frames = 0;
+	stats->last_rtt_us = 0;
+	stats->max_rtt_us = 0;
+	stats->rtt_samples = 0;
+	stats->last_rx_sequence = 0;
+	stats->last_ack_sequence = 0;
+	stats->last_rx_time_us = 0;
+	stats->has_received = 0;
+
+	for (int i = 0; i < INTERCHIP_RTT_BUCKETS; i++) {
+		stats->rtt_histogram[i] = 0;
+	}
+
+	stats->late_threshold_us = frame_period_us + frame_period_us / 2;
+}
+
+uint16_t interchip_stats_frame_sent(InterchipStats *stats) {
+	uint16_t sequence = stats->next_sequence;
+	uint8_t slot = sequence & (INTERCHIP_RTT_SLOTS - 1);
+
+	//time has to be in place before the sequence number, as the receive interrupt checks the sequence first
+	stats->sent_time_us[slot] = now_us();
+	stats->sent_sequence[slot] = sequence;
+
+	stats->next_sequence = (uint16_t) (sequence + 1);
+	stats->frames_sent++;
+	return sequence;
+}
+
+void interchip_stats_frame_received(InterchipStats *stats, uint16_t sequence, uint16_t ack_sequence) {
+	uint32_t time = now_us();
+
+	if (stats->has_received) {
+		uint16_t gap = (uint16_t) (sequence - stats->last_rx_sequence - 1);
+
+		//anything more than half the sequence range "behind" is a duplicate or a reordered frame, not a gap
+		if (gap < SEQUENCE_HALF_RANGE) {
+			stats->sequence_gaps += gap;
+		}
+
+		if (time - stats->last_rx_time_us > stats->late_threshold_us) {
+			stats->late_frames++;
+		}
+
+		//the other chip keeps echoing the same number until it gets a new frame, only measure it once
+		if (ack_sequence != stats->last_ack_sequence) {
+			uint8_t slot = ack_sequence & (INTERCHIP_RTT_SLOTS - 1);
+
+			if (stats->sent_sequence[slot] == ack_sequence) {
+				record_rtt(stats, time - stats->sent_time_us[slot]);
+			}
+		}
+	}
+
+	stats->last_rx_sequence = sequence;
+	stats->last_ack_sequence = ack_sequence;
+	stats->last_rx_time_us = time;
+	stats->has_received = 1;
+	stats->frames_received++;
+}
+
+void interchip_stats_crc_failure(InterchipStats *stats) {
+	stats->crc_failures++;
+}
+
+void interchip_stats_send_overrun(InterchipStats *stats) {
+	stats->send_overruns++;
+}
+
+void interchip_stats_transfer_error(InterchipStats *stats) {
+	stats->transfer_errors++;
+}
+
+uint16_t interchip_stats_ack_sequence(const InterchipStats *stats) {
+	return stats->last_rx_sequence;
+}
+
+void interchip_stats_get_health(const InterchipStats *stats, Interchip_LinkHealth *health) {
+	health->crc_failures = (uint16_t) stats->crc_failures;
+	health->sequence_gaps = (uint16_t) stats->sequence_gaps;
+	health->late_frames = (uint16_t) stats->late_frames;
+}
+
+void get_interchip_stats(const InterchipStats *stats, InterchipStatsSnapshot *snapshot) {
+	snapshot->frames_sent = stats->frames_sent;
+	snapshot->frames_received = stats->frames_received;
+	snapshot->crc_failures = stats->crc_failures;
+	snapshot->sequence_gaps = stats->sequence_gaps;
+	snapshot->late_frames = stats->late_frames;
+	snapshot->send_overruns = stats->send_overruns;
+	snapshot->transfer_errors = stats->transfer_errors;
+	snapshot->last_rtt_us = stats->last_rtt_us;
+	snapshot->max_rtt_us = stats->max_rtt_us;
+
+	for (int i = 0; i < INTERCHIP_RTT_BUCKETS; i++) {
+		snapshot->rtt_histogram[i] = stats->rtt_histogram[i];
+	}
+}
+
+int print_interchip_stats(const char *label, char *buffer, const InterchipStats *stats) {
+	InterchipStatsSnapshot s;
+	get_interchip_stats(stats, &s);
+
+	return sprintf(buffer, "Interchip stats for: %s \r\n"
+						   "Sent: %lu Received: %lu \r\n"
+						   "CRC Failures: %lu Sequence Gaps: %lu \r\n"
+						   "Late: %lu Overruns: %lu Errors: %lu \r\n"
+						   "RTT (us) Last: %lu Max: %lu \r\n"
+						   "RTT Histogram: %lu %lu %lu %lu %lu %lu %lu %lu \r\n",
+				   label,
+				   (unsigned long) s.frames_sent, (unsigned long) s.frames_received,
+				   (unsigned long) s.crc_failures, (unsigned long) s.sequence_gaps,
+				   (unsigned long) s.late_frames, (unsigned long) s.send_overruns, (unsigned long) s.transfer_errors,
+				   (unsigned long) s.last_rtt_us, (unsigned long) s.max_rtt_us,
+				   (unsigned long) s.rtt_histogram[0], (unsigned long) s.rtt_histogram[1],
+				   (unsigned long) s.rtt_histogram[2], (unsigned long) s.rtt_histogram[3],
+				   (unsigned long) s.rtt_histogram[4], (unsigned long) s.rtt_histogram[5],
+				   (unsigned long) s.rtt_histogram[6], (unsigned long) s.rtt_histogram[7]);
+}
@@ -0,0 +1,151 @@
+#include "PPMDecoder.hpp"
+
+static const uint32_t PPM_CAPTURE_BUFFER_MASK = PPM_CAPTURE_BUFFER_LEN - 1;
+static const uint32_t PPM_DEFAULT_TICK_HZ = 2000000;
+static const uint32_t PPM_DEFAULT_MIN_US = 1000;
+static const uint32_t PPM_DEFAULT_MAX_US = 2000;
+
+static_assert((PPM_CAPTURE_BUFFER_LEN & PPM_CAPTURE_BUFFER_MASK) == 0, "Capture buffer must be a power of two");
+
+static inline uint32_t us_to_ticks(uint32_t us, uint32_t tick_hz) {
+	return (uint32_t) (((uint64_t) us * tick_hz) / 1000000UL);
+}
+
+PPMDecoder::PPMDecoder() {
+	tail = 0;
+	tick_hz = 0;
+	frame_count = 0;
+	error_count = 0;
+	overrun_count = 0;
+
+	configure(PPM_DEFAULT_TICK_HZ, 8);
+}
+
+StatusCode PPMDecoder::configure(uint32_t hz, uint8_t channels, uint32_t sync_gap_us) {
+	if (channels == 0 || channels > PPM_DECODER_MAX_CHANNELS || hz < 1000000UL) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	uint32_t gap_ticks = us_to_ticks(sync_gap_us, hz);
+	if (gap_ticks == 0 || gap_ticks > UINT16_MAX) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	tick_hz = hz;
+	num_channels = channels;
+	sync_gap_ticks = gap_ticks;
+
+	//hz is at least 1MHz, so this is at most 1 << 16 and ticks * us_mul can't overflow
+	us_mul = (uint32_t) ((1000000ULL << 16) / hz);
+
+	for (uint8_t i = 0; i < PPM_DECODER_MAX_CHANNELS; i++) {
+		set_limits(i, PPM_DEFAULT_MIN_US, PPM_DEFAULT_MAX_US, 0);
+	}
+
+	clear();
+	return STATUS_CODE_OK;
+}
+
+StatusCode PPMDecoder::set_limits(uint8_t channel, uint32_t min_us, uint32_t max_us, uint32_t deadzone_us) {
+	if (channel >= PPM_DECODER_MAX_CHANNELS || min_us >= max_us) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
+
+	PPMChannelScale &scale = scales[channel];
+	scale.min_ticks = us_to_ticks(min_us, tick_hz);
+	scale.range_ticks = us_to_ticks(max_us, tick_hz) - scale.min_ticks;
+	scale.deadzone_ticks = us_to_ticks(deadzone_us, tick_hz);
+
+	if (scale.range_ticks == 0) {
+		scale.range_ticks = 1;
+	}
+	//rounded up so that exact percentages (like the 50% stick center) don't truncate down by one
+	scale.percent_mul = ((100UL << 16) + scale.range_ticks - 1) / scale.range_ticks;
+
+	return STATUS_CODE_OK;
+}
+
+void PPMDecoder::clear() {
+	for (uint8_t i = 0; i < PPM_DECODER_MAX_CHANNELS; i++) {
+		widths[i] = 0;
+		pending[i] = 0;
+	}
+	have_last_edge = false;
+	index = -1;
+}
+
+uint32_t PPMDecoder::process(const volatile uint16_t *captures, uint32_t head) {
+	uint32_t frames = 0;
+
+	if (head - tail > PPM_CAPTURE_BUFFER_LEN) {
+		//the oldest captures were overwritten, so the edge we have stored no longer lines up with the buffer
+		overrun_count++;
+		tail = head - PPM_CAPTURE_BUFFER_LEN;
+		have_last_edge = false;
+		index = -1;
+	}
+
+	while (tail != head) {
+		uint16_t edge = captures[tail & PPM_CAPTURE_BUFFER_MASK];
+		tail++;
+
+		if (!have_last_edge) {
+			last_edge = edge;
+			have_last_edge = true;
+			continue;
+		}
+
+		//unsigned subtraction takes care of the counter wrapping around
+		uint16_t width = (uint16_t) (edge - last_edge);
+		last_edge = edge;
+
+		if (width >= sync_gap_ticks) {
+			if (index == num_channels) {
+				for (uint8_t i = 0; i < num_channels; i++) {
+					widths[i] = pending[i];
+				}
+				frame_count++;
+				frames++;
+			} else if (index > 0) {
+				error_count++;
+			}
+			index = 0;
+		} else if (index >= 0 && index < num_channels) {
+			pending[index++] = width;
+		} else if (index >= 0) {
+			//more pulses than channels, so we're misconfigured or have noise on the line
+			error_count++;
+			index = -1;
+		}
+	}
+
+	return frames;
+}
+
+uint16_t PPMDecoder::get_ticks(uint8_t channel) const {
+	if (channel >= num_channels) return 0;
+	return widths[channel];
+}
+
+uint32_t PPMDecoder::get_us(uint8_t channel) const {
+	if (channel >= num_channels) return 0;
+	return ((uint32_t) widths[channel] * us_mul) >> 16;
+}
+
+uint8_t PPMDecoder::get_percent(uint8_t channel) const {
+	if (channel >= num_channels) return 0;
+
+	const PPMChannelScale &scale = scales[channel];
+	uint32_t ticks = widths[channel];
+
+	//if the input signal is lower than the minimum signal, or if we're not outside the deadzone, return 0%
+	if (ticks <= scale.min_ticks || ticks - scale.min_ticks < scale.deadzone_ticks) {
+		return 0;
+	}
+
+	uint32_t diff = ticks - scale.min_ticks;
+	if (diff >= scale.range_ticks) {
+		return 100;
+	}
+	return (uint8_t) ((diff * scale.percent_mul) >> 16);
+}
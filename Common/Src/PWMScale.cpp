@@ -0,0 +1,31 @@
+#include "PWMScale.hpp"
+
+static const uint32_t PWM_US_PER_SECOND = 1000000UL;
+static const uint32_t PWM_SCALE_ROUNDING = 1UL << 15; //half of the 16 bit fixed point fraction
+
+void pwm_get_scale(uint32_t tick_hz, uint32_t period_ticks, uint32_t min_us, uint32_t max_us, PWMScale &scale) {
+	uint32_t period_us = tick_hz == 0 ? 0 : (uint32_t) (((uint64_t) period_ticks * PWM_US_PER_SECOND) / tick_hz);
+	if (period_us > 0xFFFF) period_us = 0xFFFF;
+
+	if (max_us > period_us) max_us = period_us;
+	if (min_us > max_us) min_us = max_us;
+
+	scale.min_us = (uint16_t) min_us;
+	scale.max_us = (uint16_t) max_us;
+	scale.us_to_ticks = (uint32_t) ((((uint64_t) tick_hz << 16) + PWM_US_PER_SECOND / 2) / PWM_US_PER_SECOND);
+	scale.percent_to_us = (((max_us - min_us) << 16) + 50) / 100;
+}
+
+uint16_t pwm_us_to_ticks(const PWMScale &scale, uint16_t us) {
+	if (us < scale.min_us) us = scale.min_us;
+	if (us > scale.max_us) us = scale.max_us;
+
+	//max_us is inside the period, which is at most 16 bits of ticks, so this can't overflow
+	return (uint16_t) ((us * scale.us_to_ticks + PWM_SCALE_ROUNDING) >> 16);
+}
+
+uint16_t pwm_percent_to_us(const PWMScale &scale, uint8_t percent) {
+	if (percent > 100) percent = 100;
+
+	return (uint16_t) (scale.min_us + ((percent * scale.percent_to_us + PWM_SCALE_ROUNDING) >> 16));
+}
@@ -8,28 +8,30 @@ void init_profiler(Profiler *p) {
 	p->prev_time = 0;
 	p->max_diff = 0;
 	p->latest_diff = 0;
-	p->min_diff = INT64_MAX;
-	p->average_diff = 0;
+	p->min_diff = UINT32_MAX;
 	p->total_diff = 0;
 	p->num_profiles = 0;
 }
 
 void start_profile(Profiler *p) {
 	p->started_profile = 1;
-	p->prev_time = get_system_time_us();
+	p->prev_time = get_cycle_count();
 }
 
 void stop_profile(Profiler *p) {
 	if (!p->started_profile) return;
 	p->started_profile = 0;
-	p->latest_diff = get_system_time_us() - p->prev_time;
+	p->latest_diff = (uint32_t) (get_cycle_count() - (uint32_t) p->prev_time);
 	p->num_profiles++;
 	p->total_diff += p->latest_diff;
-	p->average_diff = p->total_diff / p->num_profiles;
 	p->max_diff = (p->latest_diff > p->max_diff) ? p->latest_diff : p->max_diff;
 	p->min_diff = (p->latest_diff < p->min_diff) ? p->latest_diff : p->min_diff;
 }
 
+static uint32_t cycles_to_us(uint64_t cycles) {
+	return (uint32_t) (cycles * 1000000ULL / get_cycle_count_frequency());
+}
+
 int print_profile_stats(const char *label, char *buffer, Profiler *p) {
 	if (p->num_profiles == 0) {
 		return 0;
@@ -42,9 +44,9 @@ int print_profile_stats(const char *label, char *buffer, Profiler *p) {
 						   "Min: %lu \r\n"
 						   "Num Profiles: %d \r\n",
 				   label,
-				   (uint32_t) p->latest_diff,
-				   (uint32_t) p->average_diff,
-				   (uint32_t) p->max_diff,
-				   (uint32_t) p->min_diff,
+				   (unsigned long) cycles_to_us(p->latest_diff),
+				   (unsigned long) cycles_to_us(p->total_diff / p->num_profiles),
+				   (unsigned long) cycles_to_us(p->max_diff),
+				   (unsigned long) cycles_to_us(p->min_diff),
 				   p->num_profiles);
 }
@@ -0,0 +1,106 @@
+#include "RTOSTraceBuffer.hpp"
+#include <string.h>
+
+RTOSTraceBuffer::RTOSTraceBuffer() : storage(nullptr), mask(0), cycles_per_second(0), written(0), recording(false),
+									 name_count(0) {
+	//no storage yet, nothing is recorded until init()
+}
+
+StatusCode RTOSTraceBuffer::init(RTOSTraceRecord *storage, uint32_t capacity, uint32_t cycles_per_second) {
+	if (storage == nullptr || capacity == 0 || (capacity & (capacity - 1)) != 0) return STATUS_CODE_INVALID_ARGS;
+
+	recording.store(false, std::memory_order_relaxed);
+	this->storage = storage;
+	this->mask = capacity - 1;
+	this->cycles_per_second = cycles_per_second;
+	written.store(0, std::memory_order_relaxed);
+	recording.store(true, std::memory_order_relaxed);
+	return STATUS_CODE_OK;
+}
+
+bool RTOSTraceBuffer::set_name(RTOSTraceNameKind kind, uint8_t id, const char *name) {
+	uint8_t i = 0;
+	while (i < name_count && !(names[i].kind == kind && names[i].id == id)) i++;
+
+	if (i == name_count) {
+		if (name_count == RTOS_TRACE_MAX_NAMES) return false;
+		name_count++;
+	}
+
+	names[i].kind = (uint8_t) kind;
+	names[i].id = id;
+	memset(names[i].name, 0, RTOS_TRACE_NAME_LEN);
+	if (name != nullptr) strncpy(names[i].name, name, RTOS_TRACE_NAME_LEN);
+	return true;
+}
+
+uint32_t RTOSTraceBuffer::size() const {
+	if (storage == nullptr) return 0;
+
+	uint32_t count = get_written();
+	return count > mask ? mask + 1 : count;
+}
+
+const RTOSTraceRecord &RTOSTraceBuffer::get(uint32_t i) const {
+	uint32_t oldest = get_written() - size();
+	return storage[(oldest + i) & mask];
+}
+
+size_t RTOSTraceBuffer::dump_len() const {
+	return RTOS_TRACE_HEADER_LEN + name_count * RTOS_TRACE_NAME_ENTRY_LEN + size() * RTOS_TRACE_RECORD_LEN;
+}
+
+size_t RTOSTraceBuffer::read_dump(size_t offset, uint8_t *out, size_t len) const {
+	size_t copied = 0;
+
+	while (copied < len) {
+		size_t piece = read_dump_piece(offset + copied, out + copied, len - copied);
+		if (piece == 0) break;
+		copied += piece;
+	}
+	return copied;
+}
+
+//copies from whichever header, name or record the offset lands in, up to the end of it
+size_t RTOSTraceBuffer::read_dump_piece(size_t offset, uint8_t *out, size_t len) const {
+	uint8_t piece[RTOS_TRACE_HEADER_LEN > RTOS_TRACE_NAME_ENTRY_LEN ? RTOS_TRACE_HEADER_LEN : RTOS_TRACE_NAME_ENTRY_LEN];
+	size_t piece_len;
+	size_t names_len = name_count * RTOS_TRACE_NAME_ENTRY_LEN;
+	uint32_t record_count = size();
+
+	if (offset < RTOS_TRACE_HEADER_LEN) {
+		memcpy(piece, "RTRC", 4);
+		piece[4] = RTOS_TRACE_DUMP_VERSION;
+		piece[5] = name_count;
+		piece[6] = 0;
+		piece[7] = 0;
+		memcpy(&piece[8], &record_count, 4);
+		memcpy(&piece[12], &cycles_per_second, 4);
+		piece_len = RTOS_TRACE_HEADER_LEN;
+	} else if (offset < RTOS_TRACE_HEADER_LEN + names_len) {
+		offset -= RTOS_TRACE_HEADER_LEN;
+		const TraceName &name = names[offset / RTOS_TRACE_NAME_ENTRY_LEN];
+
+		piece[0] = name.kind;
+		piece[1] = name.id;
+		memcpy(&piece[2], name.name, RTOS_TRACE_NAME_LEN);
+		piece_len = RTOS_TRACE_NAME_ENTRY_LEN;
+		offset %= RTOS_TRACE_NAME_ENTRY_LEN;
+	} else {
+		offset -= RTOS_TRACE_HEADER_LEN + names_len;
+		if (offset >= record_count * RTOS_TRACE_RECORD_LEN) return 0;
+
+		const RTOSTraceRecord &record = get((uint32_t) (offset / RTOS_TRACE_RECORD_LEN));
+		memcpy(piece, &record.timestamp, 4);
+		piece[4] = record.event;
+		piece[5] = record.id;
+		memcpy(&piece[6], &record.arg, 2);
+		piece_len = RTOS_TRACE_RECORD_LEN;
+		offset %= RTOS_TRACE_RECORD_LEN;
+	}
+
+	size_t n = piece_len - offset;
+	if (n > len) n = len;
+	memcpy(out, piece + offset, n);
+	return n;
+}
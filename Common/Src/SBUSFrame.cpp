@@ -0,0 +1,104 @@
+#include "SBUSFrame.hpp"
+#include <string.h>
+
+static const uint16_t SBUS_CHANNEL_MASK = 0x07FF;
+static const uint8_t SBUS_FLAG_CH17 = 1U << 0;
+static const uint8_t SBUS_FLAG_CH18 = 1U << 1;
+static const uint8_t SBUS_FLAG_FRAME_LOST = 1U << 2;
+static const uint8_t SBUS_FLAG_FAILSAFE = 1U << 3;
+
+static inline bool is_valid_footer(uint8_t footer) {
+	//s.bus2 receivers cycle the upper nibble to indicate the telemetry slot
+	return footer == 0x00 || (footer & 0x0F) == 0x04;
+}
+
+//explicit byte assembly so we don't rely on the endianness or alignment of the buffer. The compiler
+//turns this into a single load on little endian targets that allow unaligned access
+static inline uint64_t load_le64(const uint8_t *p) {
+	return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24)
+		| ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static inline uint32_t load_le24(const uint8_t *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16);
+}
+
+/**
+ * 8 channels * 11 bits = 88 bits = exactly 11 bytes, so the 16 channels split into two identical groups.
+ * Each group is loaded as one 64-bit word plus one 24-bit word and sliced with constant shifts
+ */
+static inline void unpack_group(const uint8_t *p, uint16_t *out) {
+	uint64_t lo = load_le64(p);
+	uint32_t hi = load_le24(p + 8);
+
+	out[0] = (uint16_t) (lo & SBUS_CHANNEL_MASK);
+	out[1] = (uint16_t) ((lo >> 11) & SBUS_CHANNEL_MASK);
+	out[2] = (uint16_t) ((lo >> 22) & SBUS_CHANNEL_MASK);
+	out[3] = (uint16_t) ((lo >> 33) & SBUS_CHANNEL_MASK);
+	out[4] = (uint16_t) ((lo >> 44) & SBUS_CHANNEL_MASK);
+	out[5] = (uint16_t) (((uint32_t) (lo >> 55) | (hi << 9)) & SBUS_CHANNEL_MASK);
+	out[6] = (uint16_t) ((hi >> 2) & SBUS_CHANNEL_MASK);
+	out[7] = (uint16_t) ((hi >> 13) & SBUS_CHANNEL_MASK);
+}
+
+bool sbus_is_frame_aligned(const uint8_t *data) {
+	return data[0] == SBUS_HEADER && is_valid_footer(data[SBUS_FRAME_LEN - 1]);
+}
+
+StatusCode sbus_decode_frame(const uint8_t *data, SBUSFrame &frame) {
+	if (data == nullptr || !sbus_is_frame_aligned(data)) return STATUS_CODE_INVALID_ARGS;
+
+	unpack_group(&data[1], &frame.channels[0]);
+	unpack_group(&data[12], &frame.channels[8]);
+
+	uint8_t flags = data[23];
+	frame.channel_17 = (flags & SBUS_FLAG_CH17) != 0;
+	frame.channel_18 = (flags & SBUS_FLAG_CH18) != 0;
+	frame.frame_lost = (flags & SBUS_FLAG_FRAME_LOST) != 0;
+	frame.failsafe = (flags & SBUS_FLAG_FAILSAFE) != 0;
+
+	return STATUS_CODE_OK;
+}
+
+uint32_t sbus_raw_to_us(uint16_t raw) {
+	if (raw <= SBUS_RAW_MIN) return 1000;
+	if (raw >= SBUS_RAW_MAX) return 2000;
+
+	//1000 / (1811 - 172) ~= 39986 / 65536, within half a us of the exact mapping everywhere in between
+	return 1000 + (((uint32_t) (raw - SBUS_RAW_MIN) * 39986 + 32768) >> 16);
+}
+
+uint8_t sbus_raw_to_percent(uint16_t raw) {
+	if (raw <= SBUS_RAW_MIN) return 0;
+	if (raw >= SBUS_RAW_MAX) return 100;
+
+	//100 / (1811 - 172) ~= 4000 / 65536
+	return (uint8_t) (((uint32_t) (raw - SBUS_RAW_MIN) * 4000 + 32768) >> 16);
+}
+
+bool SBUSFrameSync::commit(size_t len) {
+	length += len;
+	if (length > SBUS_FRAME_LEN) length = SBUS_FRAME_LEN;
+
+	size_t start = 0;
+
+	//if we're not sitting on a header, or a full frame arrived but its footer doesn't line up, slide the
+	//buffer down to the next candidate header
+	if (length > 0 && (data[0] != SBUS_HEADER || (length == SBUS_FRAME_LEN && !sbus_is_frame_aligned(data)))) {
+		start = 1;
+		while (start < length && data[start] != SBUS_HEADER) start++;
+	}
+
+	if (start > 0) {
+		memmove(data, &data[start], length - start);
+		length -= start;
+		dropped += (uint32_t) start;
+		return false;
+	}
+
+	if (length == SBUS_FRAME_LEN) {
+		length = 0; //frame stays valid in data until the caller writes into buffer() again
+		return true;
+	}
+	return false;
+}
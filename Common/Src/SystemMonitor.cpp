@@ -0,0 +1,87 @@
+#include "SystemMonitor.h"
+#include <string.h>
+
+void init_system_monitor(SystemMonitor *monitor, const SystemMonitorThresholds *thresholds) {
+	memset(monitor, 0, sizeof(SystemMonitor));
+	monitor->thresholds = *thresholds;
+}
+
+//run time the task had at the previous sample. A task that wasn't there has run for all of its time since
+static uint32_t previous_run_time(const SystemMonitor *monitor, uint8_t number) {
+	for (uint8_t i = 0; i < monitor->last_count; i++) {
+		if (monitor->last_number[i] == number) return monitor->last_run_time[i];
+	}
+	return 0;
+}
+
+static uint16_t permille(uint32_t part, uint32_t whole) {
+	if (whole == 0) return 0;
+
+	uint64_t share = (uint64_t) part * 1000 / whole;
+	return share > 1000 ? 1000 : (uint16_t) share;
+}
+
+uint8_t system_monitor_update(SystemMonitor *monitor, const SystemMonitorTaskSample *tasks, uint8_t task_count,
+							  uint32_t total_run_time, uint32_t heap_free_bytes, uint32_t heap_min_free_bytes) {
+	SystemMonitorSnapshot *snapshot = &monitor->snapshot;
+	const SystemMonitorThresholds *thresholds = &monitor->thresholds;
+	uint8_t previous_alarms = snapshot->alarms;
+	uint8_t alarms = 0;
+
+	if (task_count > SYSTEM_MONITOR_MAX_TASKS) {
+		task_count = SYSTEM_MONITOR_MAX_TASKS;
+		alarms |= SYSTEM_MONITOR_ALARM_TASKS;
+	}
+
+	uint32_t elapsed = monitor->has_sampled ? total_run_time - monitor->last_total_run_time : 0;
+	uint16_t idle_permille = 1000;
+	uint8_t has_idle = 0;
+
+	for (uint8_t i = 0; i < task_count; i++) {
+		const SystemMonitorTaskSample *task = &tasks[i];
+		SystemMonitorTaskUsage *usage = &snapshot->tasks[i];
+
+		usage->number = task->number;
+		memset(usage->name, 0, SYSTEM_MONITOR_NAME_LEN);
+		if (task->name != NULL) strncpy(usage->name, task->name, SYSTEM_MONITOR_NAME_LEN);
+		usage->stack_free_words = task->stack_free_words;
+		usage->cpu_permille = permille(task->run_time - previous_run_time(monitor, task->number), elapsed);
+
+		if (task->stack_free_words < thresholds->min_stack_free_words) {
+			alarms |= SYSTEM_MONITOR_ALARM_STACK;
+		}
+
+		if (task->is_idle) {
+			idle_permille = usage->cpu_permille;
+			has_idle = 1;
+		}
+	}
+
+	//only the idle task's counter is needed for the load, so tasks that didn't fit don't throw it off
+	snapshot->cpu_load_permille = (has_idle && elapsed > 0) ? (uint16_t) (1000 - idle_permille) : 0;
+	snapshot->task_count = task_count;
+	snapshot->heap_free_bytes = heap_free_bytes;
+	snapshot->heap_min_free_bytes = heap_min_free_bytes;
+
+	if (heap_min_free_bytes < thresholds->min_heap_free_bytes) {
+		alarms |= SYSTEM_MONITOR_ALARM_HEAP;
+	}
+	if (snapshot->cpu_load_permille > thresholds->max_cpu_load_permille) {
+		alarms |= SYSTEM_MONITOR_ALARM_CPU;
+	}
+	snapshot->alarms = alarms;
+
+	for (uint8_t i = 0; i < task_count; i++) {
+		monitor->last_number[i] = tasks[i].number;
+		monitor->last_run_time[i] = tasks[i].run_time;
+	}
+	monitor->last_count = task_count;
+	monitor->last_total_run_time = total_run_time;
+	monitor->has_sampled = 1;
+
+	return (uint8_t) (alarms & ~previous_alarms);
+}
+
+void get_system_monitor_snapshot(const SystemMonitor *monitor, SystemMonitorSnapshot *snapshot) {
+	*snapshot = monitor->snapshot;
+}
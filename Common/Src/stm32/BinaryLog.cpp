@@ -0,0 +1,64 @@
+#include "BinaryLog.hpp"
+#include "Debug.hpp"
+
+#if STM32F030xC
+#include "stm32f0xx_hal.h"
+#elif STM32F7xx
+#include "stm32f7xx_hal.h"
+#endif
+
+//has to hold everything logged between two flushes. Must be a power of two
+#if STM32F030xC
+static const uint32_t BINARY_LOG_RING_LEN = 512;
+#else
+static const uint32_t BINARY_LOG_RING_LEN = 4096;
+#endif
+
+//kept below the debug port's transmit queue, which turns away anything it can't take whole
+static const size_t BINARY_LOG_FLUSH_CHUNK = 64;
+
+static uint8_t binary_log_storage[BINARY_LOG_RING_LEN];
+static BinaryLog binary_log_ring;
+static bool binary_log_setup = false;
+
+void binary_log_write(uint16_t id, const uint8_t *args, uint8_t len) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!binary_log_setup) {
+		binary_log_ring.init(binary_log_storage, BINARY_LOG_RING_LEN);
+		binary_log_setup = true;
+	}
+	binary_log_ring.write(id, args, len);
+
+	__set_PRIMASK(primask);
+}
+
+bool binary_log_try_write(uint16_t id, const uint8_t *args, uint8_t len) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!binary_log_setup) {
+		binary_log_ring.init(binary_log_storage, BINARY_LOG_RING_LEN);
+		binary_log_setup = true;
+	}
+	bool written = binary_log_ring.try_write(id, args, len);
+
+	__set_PRIMASK(primask);
+	return written;
+}
+
+void binary_log_flush(void) {
+	if (!binary_log_setup) return;
+
+	const uint8_t *data;
+	size_t len;
+
+	while ((len = binary_log_ring.peek(data)) > 0) {
+		if (len > BINARY_LOG_FLUSH_CHUNK) len = BINARY_LOG_FLUSH_CHUNK;
+
+		//try again next time if the port is busy
+		if (debug_transmit(data, len) != STATUS_CODE_OK) return;
+		binary_log_ring.consume(len);
+	}
+}
@@ -93,15 +93,9 @@ StatusCode I2CSlavePort::read_bytes(uint8_t *rx_data, size_t rx_len, size_t &byt
 			dma_config->reset = false;
 		}
 
-		if (rx_queue == nullptr) abort("RX QUEUE IS NULL!", __FILE__, __LINE__);
+		if (rx_ring == nullptr) abort("RX RING IS NULL!", __FILE__, __LINE__);
 
-		bytes_read = 0;
-
-		while (bytes_read < rx_len && !rx_queue->empty()) {
-			rx_data[bytes_read] = rx_queue->front();
-			rx_queue->pop_front();
-			bytes_read++;
-		}
+		bytes_read = rx_ring->pop(rx_data, rx_len);
 	} else {
 		auto handle = (I2C_HandleTypeDef *) interface_handle;
 
@@ -138,6 +132,9 @@ StatusCode I2CSlavePort::clearDMAReceiveCallback() {
 	return STATUS_CODE_OK;
 }
 
+I2CMasterPort::I2CMasterPort(I2CPortNum port_num, I2CSettings settings) : I2CPort(port_num, settings) {
+}
+
 StatusCode I2CMasterPort::setup() {
 	if (is_setup || !is_valid_port()) return STATUS_CODE_INVALID_ARGS;
 
@@ -1,4 +1,5 @@
 #include "UART.hpp"
+#include "Clock.hpp"
 #include "Debug.hpp"
 
 #if STM32F030xC
@@ -22,7 +23,13 @@ StatusCode UARTPort::setup() {
 	if (status != STATUS_CODE_OK) return status;
 
 	uart->Init.BaudRate = settings.baudrate;
-	uart->Init.WordLength = UART_WORDLENGTH_8B;
+
+	//the parity bit is counted as part of the word on stm32, so we need 9 bits to keep 8 data bits
+	if (settings.parity == UART_NO_PARITY) {
+		uart->Init.WordLength = UART_WORDLENGTH_8B;
+	} else {
+		uart->Init.WordLength = UART_WORDLENGTH_9B;
+	}
 
 	if (settings.stop_bits == 2) {
 		uart->Init.StopBits = UART_STOPBITS_2;
@@ -88,6 +95,40 @@ StatusCode UARTPort::adjustBaudrate(uint32_t baudrate) {
 	return STATUS_CODE_OK;
 }
 
+StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+	if (tx_buffer_size == 0 && rx_buffer_size == 0) return STATUS_CODE_INVALID_ARGS;
+	if ((tx_buffer_size != 0 && dma_setup_tx) || (rx_buffer_size != 0 && dma_setup_rx)) return STATUS_CODE_INVALID_ARGS;
+
+	StatusCode status = STATUS_CODE_OK;
+
+	if (rx_buffer_size != 0) {
+		status = setupRXDMA(rx_buffer_size);
+		if (status != STATUS_CODE_OK) return status;
+	}
+
+	if (tx_buffer_size != 0) {
+		status = setupTXDMA(tx_buffer_size);
+	}
+	return status;
+}
+
+StatusCode UARTPort::resetDMA() {
+	if (!dma_setup_rx && !dma_setup_tx) return STATUS_CODE_INVALID_ARGS;
+
+	StatusCode status = STATUS_CODE_OK;
+
+	if (dma_setup_tx) {
+		status = resetTXDMA();
+	}
+
+	if (dma_setup_rx) {
+		StatusCode rx_status = resetRXDMA();
+		if (status == STATUS_CODE_OK) status = rx_status;
+	}
+	return status;
+}
+
 StatusCode UARTPort::read_byte(uint8_t &data) {
 	size_t read;
 
@@ -101,25 +142,10 @@ StatusCode UARTPort::read_bytes(uint8_t *data, size_t len, size_t &bytes_read) {
 
 	if (dma_setup_rx) {
 		bytes_read = 0;
-		//by default if something as simple as a frame error occurs, the HAL aborts all transfers
-		//in this case, re-setup the DMA connection
-		if (dma_config->reset) {
-			reallocate_dma_buffer = false;
-			reset();
-			setup();
-			setupDMA(0, dma_config->dma_buffer_len);
-			reallocate_dma_buffer = true;
-			dma_config->reset = false;
-			return STATUS_CODE_INTERNAL_ERROR; //let user know we're reconfiguring
-		}
-
-		if (rx_queue == nullptr) abort("RX QUEUE IS NULL!", __FILE__, __LINE__);
-
-		while (bytes_read < len && !rx_queue->empty()) {
-			data[bytes_read] = rx_queue->front();
-			rx_queue->pop_front();
-			bytes_read++;
-		}
+		status = recoverRXDMA();
+		if (status != STATUS_CODE_OK) return status;
+
+		bytes_read = rx_ring->pop(data, len);
 	} else {
 		auto uart = (UART_HandleTypeDef *) this->interface_handle;
 		status = get_status_code(HAL_UART_Receive(uart, data, (uint16_t) len, settings.timeout));
@@ -131,17 +157,107 @@ StatusCode UARTPort::read_bytes(uint8_t *data, size_t len, size_t &bytes_read) {
 	return status;
 }
 
+StatusCode UARTPort::rx_peek(uint8_t *&data, size_t &len) {
+	len = 0;
+	if (!is_setup || !dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	StatusCode status = recoverRXDMA();
+	if (status != STATUS_CODE_OK) return status;
+
+	len = rx_ring->peek(data);
+	return len == 0 ? STATUS_CODE_EMPTY : STATUS_CODE_OK;
+}
+
+size_t UARTPort::rx_available() {
+	if (!is_setup || !dma_setup_rx) return 0;
+	return rx_ring->size();
+}
+
+StatusCode UARTPort::rx_consume(size_t len) {
+	if (!is_setup || !dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	rx_ring->consume(len);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::recoverRXDMA() {
+	//by default if something as simple as a frame error occurs, the HAL aborts all transfers
+	//in this case, re-setup the DMA connection
+	if (dma_config->reset) {
+		size_t tx_buffer_size = dma_setup_tx ? tx_queue->capacity() : 0;
+		reallocate_dma_buffer = false;
+		reset();
+		setup();
+		setupDMA(tx_buffer_size, dma_config->dma_buffer_len);
+		reallocate_dma_buffer = true;
+		dma_config->reset = false;
+		return STATUS_CODE_INTERNAL_ERROR; //let user know we're reconfiguring
+	}
+
+	if (rx_ring == nullptr) abort("RX RING IS NULL!", __FILE__, __LINE__);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::rx_arrival_time(uint32_t byte_index, uint64_t &time_us) {
+	if (!dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	//a start bit, 8 data bits, the parity bit and the stop bits
+	uint32_t bits = 9 + (settings.parity == UART_NO_PARITY ? 0 : 1) + settings.stop_bits;
+	uint32_t byte_time_us = bits * 1000000 / settings.baudrate;
+
+	uint32_t arrived;
+	if (!getDMARXArrival(dma_config, byte_index, byte_time_us, &arrived)) return STATUS_CODE_OUT_OF_RANGE;
+
+	//the stamp only has the low 32 bits, and it's in the past
+	uint64_t now = get_system_time_us();
+	time_us = now - (uint32_t) ((uint32_t) now - arrived);
+	return STATUS_CODE_OK;
+}
+
 StatusCode UARTPort::transmit(uint8_t *data, size_t len) {
 	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
 
 	StatusCode status;
 	auto uart = (UART_HandleTypeDef *) this->interface_handle;
 
+	if (dma_setup_tx) {
+		//the queue is shared with the transfer complete interrupt, and with any other task printing to this port
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		status = tx_queue->write(data, len);
+		__set_PRIMASK(primask);
+		return status;
+	}
+
 	status = get_status_code(HAL_UART_Transmit(uart, data, (uint16_t) len, settings.timeout));
 
 	return status;
 }
 
+StatusCode UARTPort::transmit_reserve(size_t len, DMATxRegion &region) {
+	if (!is_setup || !dma_setup_tx) return STATUS_CODE_UNINITIALIZED;
+
+	//only the free space is handed out, which the transfer complete interrupt can only ever grow
+	return tx_queue->reserve(len, region);
+}
+
+StatusCode UARTPort::transmit_commit(size_t len) {
+	if (!is_setup || !dma_setup_tx) return STATUS_CODE_UNINITIALIZED;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	tx_queue->commit(len);
+	__set_PRIMASK(primask);
+	return STATUS_CODE_OK;
+}
+
+//handed to the DMATxQueue of every port that transmits with dma. Only ever called with interrupts masked, or from
+//the port's transmit complete interrupt
+bool start_uart_dma_transmit(void *context, const uint8_t *data, size_t len) {
+	auto uart = (UART_HandleTypeDef *) context;
+	return HAL_UART_Transmit_DMA(uart, (uint8_t *) data, (uint16_t) len) == HAL_OK;
+}
+
 const char* get_uart_error_code(uint32_t code){
 	switch (code){
 		case HAL_UART_ERROR_NONE:
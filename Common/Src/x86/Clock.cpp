@@ -0,0 +1,57 @@
+/**
+ * Host clock, read from steady_clock. Times count from when the program started, like they count from boot on the
+ * chips, and the cycle counter counts ns
+ */
+
+#include "Clock.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono;
+
+static const steady_clock::time_point boot_time = steady_clock::now();
+
+static uint64_t ns_since_boot() {
+	return (uint64_t) duration_cast<nanoseconds>(steady_clock::now() - boot_time).count();
+}
+
+StatusCode initialize_system_clock() {
+	return STATUS_CODE_OK;
+}
+
+//there are no buses to clock, so report the autopilot's, for anything that works out dividers from them
+uint32_t get_system_clock() {
+	return 216000000UL;
+}
+
+uint32_t get_peripheral_clock_apb1() {
+	return 54000000UL;
+}
+
+uint32_t get_peripheral_clock_apb2() {
+	return 108000000UL;
+}
+
+uint32_t get_lsi_clock() {
+	return 32000UL;
+}
+
+uint32_t get_system_time() {
+	return (uint32_t) (ns_since_boot() / 1000000ULL);
+}
+
+uint64_t get_system_time_us() {
+	return ns_since_boot() / 1000ULL;
+}
+
+uint32_t get_cycle_count() {
+	return (uint32_t) ns_since_boot();
+}
+
+uint32_t get_cycle_count_frequency() {
+	return 1000000000UL;
+}
+
+void delay(uint32_t ms) {
+	std::this_thread::sleep_for(milliseconds(ms));
+}
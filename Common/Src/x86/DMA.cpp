@@ -0,0 +1,47 @@
+/**
+ * Host dma. There's no stream moving bytes in the background, so host_dma_receive() plays its part: it fills the
+ * buffer in order and raises the same events the chip would
+ */
+
+#include "DMA.hpp"
+#include "HostDevices.hpp"
+#include <string.h>
+
+void processDMARXEvent(DMAConfig *config) {
+	if (config->dma_buffer == nullptr || config->queue == nullptr || config->dma_handle == nullptr) return;
+
+	auto stream = static_cast<HostDMAStream *>(config->dma_handle);
+
+	copyDMARXRegion(config, (uint32_t) (config->dma_buffer_len - stream->position));
+}
+
+size_t host_dma_receive(DMAConfig *config, const uint8_t *data, size_t len) {
+	if (config->dma_buffer == nullptr || config->dma_handle == nullptr || config->dma_buffer_len == 0) return 0;
+
+	auto stream = static_cast<HostDMAStream *>(config->dma_handle);
+	size_t half = config->dma_buffer_len / 2;
+	uint32_t dropped_before = config->dropped_bytes;
+	size_t total = len;
+
+	while (len > 0) {
+		//up to whichever of the half and full transfer interrupts is next
+		size_t boundary = (stream->position < half) ? half : config->dma_buffer_len;
+		size_t chunk = boundary - stream->position;
+		if (chunk > len) chunk = len;
+
+		memcpy(&config->dma_buffer[stream->position], data, chunk);
+		stream->position += chunk;
+		data += chunk;
+		len -= chunk;
+
+		bool at_boundary = stream->position == boundary;
+		if (stream->position == config->dma_buffer_len) stream->position = 0; //circular mode
+
+		//the idle line interrupt covers the end of the burst
+		if (at_boundary || len == 0) {
+			processDMARXEvent(config);
+		}
+	}
+
+	return total - (config->dropped_bytes - dropped_before);
+}
@@ -0,0 +1,102 @@
+/**
+ * Host gpio. Every pin is a level in a table, set by output pins and by host_gpio_drive(), and read by input pins
+ */
+
+#include "GPIO.hpp"
+#include "HostDevices.hpp"
+#include <atomic>
+
+static std::atomic<uint8_t> levels[HOST_GPIO_PORTS][HOST_GPIO_PINS];
+
+static bool is_host_pin(GPIOPort port, GPIOPinNum pin) {
+	return (uint32_t) port < HOST_GPIO_PORTS && pin < HOST_GPIO_PINS;
+}
+
+StatusCode gpio_init() {
+	return STATUS_CODE_OK;
+}
+
+GPIOPin::GPIOPin(GPIOPort port,
+				 GPIOPinNum pin,
+				 GPIOMode mode,
+				 GPIOState initial_state,
+				 GPIOResistorState resistor_state,
+				 GPIOSpeed speed,
+				 uint8_t alternate_function) {
+
+	this->mode = mode;
+	this->num = pin;
+	this->port = port;
+	this->current_state = initial_state;
+	this->resistor_state = resistor_state;
+	this->speed = speed;
+	this->alternate_function = alternate_function;
+}
+
+StatusCode GPIOPin::setup() {
+	if (!is_host_pin(port, num)) return STATUS_CODE_INVALID_ARGS;
+
+	//an input with a pull resistor and nothing driving it reads as what it's pulled to
+	if (mode == GPIO_INPUT && resistor_state == GPIO_RES_PULLUP) {
+		levels[port][num] = GPIO_STATE_HIGH;
+	} else if (mode == GPIO_INPUT && resistor_state == GPIO_RES_PULLDOWN) {
+		levels[port][num] = GPIO_STATE_LOW;
+	}
+	return this->set_state(current_state);
+}
+
+StatusCode GPIOPin::get_state(GPIOState &state) {
+	if (this->mode == GPIO_OUTPUT || this->mode == GPIO_OUTPUT_OD) {
+		state = current_state;
+		return STATUS_CODE_OK;
+	} else if (this->mode == GPIO_INPUT) {
+		if (!is_host_pin(port, num)) return STATUS_CODE_INVALID_ARGS;
+
+		current_state = (GPIOState) levels[port][num].load();
+		state = current_state;
+		return STATUS_CODE_OK;
+	}
+	return STATUS_CODE_INVALID_ARGS; //reading state in alternate function mode doesn't make sense
+}
+
+StatusCode GPIOPin::set_state(GPIOState new_state) {
+	if (this->mode == GPIO_OUTPUT || this->mode == GPIO_OUTPUT_OD) {
+		if (!is_host_pin(port, num)) return STATUS_CODE_INVALID_ARGS;
+
+		levels[port][num] = new_state;
+		current_state = new_state;
+	}
+	return STATUS_CODE_OK;
+}
+
+StatusCode GPIOPin::toggle_state() {
+	if (current_state == GPIO_STATE_LOW) {
+		return this->set_state(GPIO_STATE_HIGH);
+	}
+	return this->set_state(GPIO_STATE_LOW);
+}
+
+StatusCode GPIOPin::reset() {
+	return STATUS_CODE_OK;
+}
+
+StatusCode host_gpio_drive(GPIOPort port, GPIOPinNum pin, GPIOState state) {
+	if (!is_host_pin(port, pin)) return STATUS_CODE_INVALID_ARGS;
+
+	levels[port][pin] = state;
+	return STATUS_CODE_OK;
+}
+
+GPIOState host_gpio_level(GPIOPort port, GPIOPinNum pin) {
+	if (!is_host_pin(port, pin)) return GPIO_STATE_LOW;
+
+	return (GPIOState) levels[port][pin].load();
+}
+
+void host_gpio_reset_all() {
+	for (auto &port : levels) {
+		for (auto &level : port) {
+			level = GPIO_STATE_LOW;
+		}
+	}
+}
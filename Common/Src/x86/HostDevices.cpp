@@ -0,0 +1,71 @@
+/**
+ * The parts of the host backend that aren't a driver of their own. SPI devices are kept here rather than next to
+ * SPIPort, since SPIPort is only built for the autopilot
+ */
+
+#include "HostDevices.hpp"
+#include <mutex>
+#include <string.h>
+
+extern void host_uart_reset_all();
+extern void host_i2c_reset_all();
+extern void host_gpio_reset_all();
+
+static std::mutex spi_lock;
+static HostSPIDevice *spi_devices[HOST_SPI_PORTS][HOST_SPI_DEVICES_PER_PORT];
+
+void host_devices_reset() {
+	host_uart_reset_all();
+	host_i2c_reset_all();
+	host_gpio_reset_all();
+
+	std::lock_guard<std::mutex> lock(spi_lock);
+	memset(spi_devices, 0, sizeof(spi_devices));
+}
+
+/***********************************************************************************************************************
+ * SPI
+ **********************************************************************************************************************/
+
+StatusCode host_spi_attach(uint8_t port, uint32_t slave_num, HostSPIDevice *device) {
+	if (port >= HOST_SPI_PORTS || slave_num >= HOST_SPI_DEVICES_PER_PORT) return STATUS_CODE_INVALID_ARGS;
+
+	std::lock_guard<std::mutex> lock(spi_lock);
+	spi_devices[port][slave_num] = device;
+	return STATUS_CODE_OK;
+}
+
+HostSPIDevice *host_spi_device(uint8_t port, uint32_t slave_num) {
+	if (port >= HOST_SPI_PORTS || slave_num >= HOST_SPI_DEVICES_PER_PORT) return nullptr;
+
+	std::lock_guard<std::mutex> lock(spi_lock);
+	return spi_devices[port][slave_num];
+}
+
+void HostSPIRegisterDevice::select() {
+	address_next = true;
+}
+
+void HostSPIRegisterDevice::exchange(const uint8_t *tx, uint8_t *rx, size_t len) {
+	size_t i = 0;
+
+	if (address_next && len > 0) {
+		reading = (tx[0] & 0x80) != 0;
+		pointer = tx[0] & 0x7F;
+		address_next = false;
+		rx[0] = 0; //nothing comes back while the address is clocked in
+		i = 1;
+
+		if (reading) before_read(pointer);
+	}
+
+	for (; i < len; i++) {
+		if (reading) {
+			rx[i] = registers[pointer];
+		} else {
+			registers[pointer] = tx[i];
+			rx[i] = 0;
+		}
+		pointer = (pointer + 1) & 0x7F;
+	}
+}
@@ -0,0 +1,239 @@
+/**
+ * Host i2c. Master transfers go to the device attached at the address, and fail like a nack if there isn't one.
+ * Nothing plays master to a slave port on the host, so those are left unimplemented
+ */
+
+#include "I2C.hpp"
+#include "HostDevices.hpp"
+#include <mutex>
+#include <vector>
+#include <string.h>
+
+struct HostI2CBus {
+	std::mutex lock; //one transaction on the bus at a time
+	uint8_t device_count = 0;
+	I2CAddress addresses[HOST_I2C_DEVICES_PER_PORT];
+	HostI2CDevice *devices[HOST_I2C_DEVICES_PER_PORT];
+};
+
+static HostI2CBus buses[HOST_I2C_PORTS];
+
+static HostI2CDevice *find_device(HostI2CBus *bus, I2CAddress address) {
+	for (uint8_t i = 0; i < bus->device_count; i++) {
+		if (bus->addresses[i] == address) return bus->devices[i];
+	}
+	return nullptr;
+}
+
+bool I2CPort::is_valid_port() {
+	return (uint32_t) port < HOST_I2C_PORTS;
+}
+
+I2CPort::I2CPort(I2CPortNum port_num, I2CSettings settings) {
+	port = port_num;
+	this->settings = settings;
+	interface_handle = is_valid_port() ? &buses[port] : nullptr;
+}
+
+StatusCode I2CPort::setup() {
+	if (is_setup || !is_valid_port()) return STATUS_CODE_INVALID_ARGS;
+
+	is_setup = true;
+	return STATUS_CODE_OK;
+}
+
+StatusCode I2CPort::reset() {
+	if (!is_setup || !is_valid_port()) return STATUS_CODE_INVALID_ARGS;
+
+	is_setup = false;
+	return STATUS_CODE_OK;
+}
+
+I2CMasterPort::I2CMasterPort(I2CPortNum port_num, I2CSettings settings) : I2CPort(port_num, settings) {
+}
+
+StatusCode I2CMasterPort::setup() {
+	return I2CPort::setup();
+}
+
+StatusCode I2CMasterPort::read_bytes(I2CAddress addr, uint8_t *rx_data, size_t rx_len) {
+	if (!is_setup) return STATUS_CODE_INVALID_ARGS;
+
+	auto bus = static_cast<HostI2CBus *>(interface_handle);
+	std::lock_guard<std::mutex> lock(bus->lock);
+
+	HostI2CDevice *device = find_device(bus, addr);
+	if (device == nullptr || !device->read(rx_data, rx_len)) return STATUS_CODE_INTERNAL_ERROR;
+	return STATUS_CODE_OK;
+}
+
+StatusCode I2CMasterPort::write_bytes(I2CAddress addr, uint8_t *tx_data, size_t tx_len) {
+	if (!is_setup) return STATUS_CODE_INVALID_ARGS;
+
+	auto bus = static_cast<HostI2CBus *>(interface_handle);
+	std::lock_guard<std::mutex> lock(bus->lock);
+
+	HostI2CDevice *device = find_device(bus, addr);
+	if (device == nullptr || !device->write(tx_data, tx_len)) return STATUS_CODE_INTERNAL_ERROR;
+	return STATUS_CODE_OK;
+}
+
+//register addresses go out most significant byte first
+static size_t put_register_address(uint8_t *out, uint16_t register_address, size_t register_address_size) {
+	if (register_address_size == 2) {
+		out[0] = (uint8_t) (register_address >> 8);
+		out[1] = (uint8_t) register_address;
+	} else {
+		out[0] = (uint8_t) register_address;
+	}
+	return register_address_size;
+}
+
+StatusCode I2CMasterPort::read_register(I2CAddress addr,
+										uint16_t register_address,
+										size_t register_address_size,
+										uint8_t *rx_data,
+										size_t rx_len) {
+	if (!is_setup || register_address_size < 1 || register_address_size > 2) return STATUS_CODE_INVALID_ARGS;
+
+	auto bus = static_cast<HostI2CBus *>(interface_handle);
+	std::lock_guard<std::mutex> lock(bus->lock);
+
+	HostI2CDevice *device = find_device(bus, addr);
+	if (device == nullptr) return STATUS_CODE_INTERNAL_ERROR;
+
+	//the address is written, then read from after a repeated start
+	uint8_t address_bytes[2];
+	size_t address_len = put_register_address(address_bytes, register_address, register_address_size);
+
+	if (!device->write(address_bytes, address_len) || !device->read(rx_data, rx_len)) {
+		return STATUS_CODE_INTERNAL_ERROR;
+	}
+	return STATUS_CODE_OK;
+}
+
+StatusCode I2CMasterPort::write_register(I2CAddress addr,
+										 uint16_t register_address,
+										 size_t register_address_size,
+										 uint8_t *tx_data,
+										 size_t tx_len) {
+	if (!is_setup || register_address_size < 1 || register_address_size > 2) return STATUS_CODE_INVALID_ARGS;
+
+	auto bus = static_cast<HostI2CBus *>(interface_handle);
+	std::lock_guard<std::mutex> lock(bus->lock);
+
+	HostI2CDevice *device = find_device(bus, addr);
+	if (device == nullptr) return STATUS_CODE_INTERNAL_ERROR;
+
+	//the address and the data go out in one transaction
+	std::vector<uint8_t> transaction(register_address_size + tx_len);
+	size_t address_len = put_register_address(transaction.data(), register_address, register_address_size);
+	memcpy(&transaction[address_len], tx_data, tx_len);
+
+	if (!device->write(transaction.data(), transaction.size())) return STATUS_CODE_INTERNAL_ERROR;
+	return STATUS_CODE_OK;
+}
+
+I2CSlavePort::I2CSlavePort(I2CPortNum port_num, I2CSettings settings, I2CAddress address) : I2CPort(port_num,
+																									settings) {
+	this->address = static_cast<I2CAddress>(address & (0xFF >> 1)); //force 7-bit mask
+	this->rx_ring = nullptr;
+	this->dma_config = nullptr;
+}
+
+StatusCode I2CSlavePort::setup() {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::setupDMA(size_t, size_t) {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::resetDMA() {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::read_bytes(uint8_t *, size_t, size_t &bytes_read) {
+	bytes_read = 0;
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::write_bytes(uint8_t *, size_t) {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::registerDMAReceiveCallback(void (*)()) {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+StatusCode I2CSlavePort::clearDMAReceiveCallback() {
+	return STATUS_CODE_UNIMPLEMENTED;
+}
+
+/***********************************************************************************************************************
+ * Devices
+ **********************************************************************************************************************/
+
+StatusCode host_i2c_attach(I2CPortNum port, I2CAddress address, HostI2CDevice *device) {
+	if ((uint32_t) port >= HOST_I2C_PORTS || device == nullptr) return STATUS_CODE_INVALID_ARGS;
+
+	HostI2CBus *bus = &buses[port];
+	std::lock_guard<std::mutex> lock(bus->lock);
+
+	for (uint8_t i = 0; i < bus->device_count; i++) {
+		if (bus->addresses[i] == address) {
+			bus->devices[i] = device;
+			return STATUS_CODE_OK;
+		}
+	}
+
+	if (bus->device_count == HOST_I2C_DEVICES_PER_PORT) return STATUS_CODE_RESOURCE_EXHAUSTED;
+
+	bus->addresses[bus->device_count] = address;
+	bus->devices[bus->device_count] = device;
+	bus->device_count++;
+	return STATUS_CODE_OK;
+}
+
+void host_i2c_reset_all() {
+	for (HostI2CBus &bus : buses) {
+		std::lock_guard<std::mutex> lock(bus.lock);
+		bus.device_count = 0;
+	}
+}
+
+HostI2CRegisterDevice::HostI2CRegisterDevice(size_t register_address_size) {
+	this->register_address_size = (register_address_size == 2) ? 2 : 1;
+	memset(registers, 0, sizeof(registers));
+}
+
+bool HostI2CRegisterDevice::write(const uint8_t *data, size_t len) {
+	if (len == 0) return true; //just checking the device is there
+	if (len < register_address_size) return false;
+
+	pointer = (register_address_size == 2) ? (uint16_t) ((data[0] << 8) | data[1]) : data[0];
+	uint16_t start = pointer;
+	size_t data_len = len - register_address_size;
+
+	for (size_t i = 0; i < data_len; i++) {
+		registers[pointer & 0xFF] = data[register_address_size + i];
+		pointer++;
+	}
+
+	if (data_len > 0) {
+		writes++;
+		after_write(start, data_len);
+	}
+	return true;
+}
+
+bool HostI2CRegisterDevice::read(uint8_t *data, size_t len) {
+	before_read(pointer);
+
+	for (size_t i = 0; i < len; i++) {
+		data[i] = registers[pointer & 0xFF];
+		pointer++;
+	}
+	reads++;
+	return true;
+}
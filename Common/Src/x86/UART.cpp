@@ -0,0 +1,495 @@
+/**
+ * Host uart. Transmitting hands the bytes straight to whatever the port is wired to, so with tx dma the queue drains
+ * inside transmit(). Receiving with rx dma goes through a simulated dma buffer into the same ring as on the chip
+ */
+
+#include "UART.hpp"
+#include "Clock.hpp"
+#include "HostDevices.hpp"
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+//same sizes as on the autopilot, so profiles match the chip
+static const uint32_t UART_RX_RING_LEN = 512;
+static const uint32_t UART_TX_QUEUE_LEN = 1024;
+
+static const size_t UART_FD_READ_LEN = 256;
+
+/**
+ * Everything on one port's wires
+ */
+struct HostUART {
+	std::mutex rx_lock; //guards everything on the receiving side
+	std::condition_variable rx_arrived;
+	std::deque<uint8_t> rx_line; //received while rx dma is off, waiting for a blocking read
+	DMAConfig *rx_dma = nullptr; //set while rx dma is on
+	int read_fd = -1;
+
+	std::mutex tx_lock; //guards the transmitting side. Also stands in for masking interrupts around the tx queue
+	std::vector<uint8_t> transmitted; //sent while wired to nothing
+	int peer = -1;
+	int write_fd = -1;
+	bool owns_fds = false; //opened here, like a pty, so closed here too
+};
+
+static HostUART uarts[HOST_UART_PORTS];
+
+static uint8_t rx_storage[HOST_UART_PORTS][UART_RX_RING_LEN];
+static ByteRing rx_rings[HOST_UART_PORTS];
+static DMAConfig rx_dma_configs[HOST_UART_PORTS];
+static HostDMAStream rx_streams[HOST_UART_PORTS];
+
+static uint8_t tx_storage[HOST_UART_PORTS][UART_TX_QUEUE_LEN];
+static DMATxQueue tx_queues[HOST_UART_PORTS];
+
+static bool is_host_port(UARTPortNum port) {
+	return (uint32_t) port < HOST_UART_PORTS;
+}
+
+static size_t receive(HostUART *uart, const uint8_t *data, size_t len) {
+	size_t accepted;
+
+	{
+		std::lock_guard<std::mutex> lock(uart->rx_lock);
+
+		if (uart->rx_dma != nullptr) {
+			accepted = host_dma_receive(uart->rx_dma, data, len);
+		} else {
+			uart->rx_line.insert(uart->rx_line.end(), data, data + len);
+			accepted = len;
+		}
+	}
+	uart->rx_arrived.notify_all();
+	return accepted;
+}
+
+//takes whatever is waiting on the read fd, without blocking
+static void poll_read_fd(HostUART *uart) {
+	if (uart->read_fd < 0) return;
+
+	uint8_t data[UART_FD_READ_LEN];
+	ssize_t len;
+
+	while ((len = read(uart->read_fd, data, sizeof(data))) > 0) {
+		receive(uart, data, (size_t) len);
+	}
+}
+
+//call with the tx lock held
+static void send_on_wire(HostUART *uart, const uint8_t *data, size_t len) {
+	bool wired = false;
+
+	if (uart->peer >= 0) {
+		receive(&uarts[uart->peer], data, len);
+		wired = true;
+	}
+
+	if (uart->write_fd >= 0) {
+		size_t written = 0;
+		while (written < len) {
+			ssize_t result = write(uart->write_fd, data + written, len - written);
+			if (result <= 0) break; //the other end went away, the bytes are lost like on a cut wire
+			written += (size_t) result;
+		}
+		wired = true;
+	}
+
+	if (!wired) {
+		uart->transmitted.insert(uart->transmitted.end(), data, data + len);
+	}
+}
+
+//handed to the DMATxQueue of every port that transmits with dma. The transfer is over as soon as it starts
+static bool start_host_dma_transmit(void *context, const uint8_t *data, size_t len) {
+	auto uart = static_cast<HostUART *>(context);
+
+	send_on_wire(uart, data, len);
+	tx_queues[uart - uarts].transfer_complete();
+	return true;
+}
+
+bool UARTPort::is_valid_port() {
+	return is_host_port(port);
+}
+
+UARTPort::UARTPort(UARTPortNum port, UARTSettings settings) {
+	this->port = port;
+	this->settings = settings;
+	this->interface_handle = is_valid_port() ? &uarts[port] : nullptr;
+	this->dma_config = nullptr;
+	this->rx_ring = nullptr;
+	this->tx_queue = nullptr;
+}
+
+StatusCode UARTPort::setup() {
+	if (!is_valid_port()) return STATUS_CODE_INVALID_ARGS;
+
+	is_setup = true;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::reset() {
+	if (!is_setup) return STATUS_CODE_INVALID_ARGS;
+
+	if (dma_setup_rx || dma_setup_tx) {
+		resetDMA();
+	}
+
+	is_setup = false;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::adjustBaudrate(uint32_t baudrate) {
+	bool was_setup = is_setup;
+	if (was_setup) {
+		reset();
+	}
+	settings.baudrate = baudrate;
+
+	if (was_setup) {
+		return setup();
+	}
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+	if (tx_buffer_size == 0 && rx_buffer_size == 0) return STATUS_CODE_INVALID_ARGS;
+	if ((tx_buffer_size != 0 && dma_setup_tx) || (rx_buffer_size != 0 && dma_setup_rx)) return STATUS_CODE_INVALID_ARGS;
+
+	StatusCode status = STATUS_CODE_OK;
+
+	if (rx_buffer_size != 0) {
+		status = setupRXDMA(rx_buffer_size);
+		if (status != STATUS_CODE_OK) return status;
+	}
+
+	if (tx_buffer_size != 0) {
+		status = setupTXDMA(tx_buffer_size);
+	}
+	return status;
+}
+
+StatusCode UARTPort::resetDMA() {
+	if (!dma_setup_rx && !dma_setup_tx) return STATUS_CODE_INVALID_ARGS;
+
+	StatusCode status = STATUS_CODE_OK;
+
+	if (dma_setup_tx) {
+		status = resetTXDMA();
+	}
+
+	if (dma_setup_rx) {
+		StatusCode rx_status = resetRXDMA();
+		if (status == STATUS_CODE_OK) status = rx_status;
+	}
+	return status;
+}
+
+StatusCode UARTPort::setupRXDMA(size_t rx_buffer_size) {
+	if (rx_buffer_size > UART_RX_RING_LEN) return STATUS_CODE_INVALID_ARGS;
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+
+	dma_config = &rx_dma_configs[port];
+	resetDMAConfig(dma_config, rx_buffer_size);
+	rx_streams[port].position = 0;
+	dma_config->dma_handle = &rx_streams[port];
+	dma_config->queue = &rx_rings[port];
+	rx_ring = &rx_rings[port];
+
+	if (reallocate_dma_buffer) {
+		StatusCode status = rx_ring->init(rx_storage[port], UART_RX_RING_LEN);
+		if (status != STATUS_CODE_OK) return status;
+		resetDMARXStamps(dma_config);
+
+		dma_config->dma_buffer = (uint8_t *) malloc(rx_buffer_size);
+		if (dma_config->dma_buffer == nullptr) return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	//bytes that arrived before the dma was running would have been overrun on the chip
+	std::lock_guard<std::mutex> lock(uart->rx_lock);
+	uart->rx_line.clear();
+	uart->rx_dma = dma_config;
+
+	dma_setup_rx = true;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::resetRXDMA() {
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+
+	std::lock_guard<std::mutex> lock(uart->rx_lock);
+	uart->rx_dma = nullptr;
+
+	if (reallocate_dma_buffer) {
+		free(dma_config->dma_buffer);
+		dma_config->dma_buffer = nullptr;
+		rx_ring->clear();
+	}
+
+	dma_setup_rx = false;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::setupTXDMA(size_t tx_buffer_size) {
+	if (tx_buffer_size > UART_TX_QUEUE_LEN) return STATUS_CODE_INVALID_ARGS;
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+	tx_queue = &tx_queues[port];
+
+	if (reallocate_dma_buffer) {
+		std::lock_guard<std::mutex> lock(uart->tx_lock);
+		StatusCode status = tx_queue->init(tx_storage[port], UART_TX_QUEUE_LEN, start_host_dma_transmit, uart);
+		if (status != STATUS_CODE_OK) return status;
+	}
+
+	dma_setup_tx = true;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::resetTXDMA() {
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+
+	std::lock_guard<std::mutex> lock(uart->tx_lock);
+	if (reallocate_dma_buffer) {
+		tx_queue->clear();
+	} else {
+		tx_queue->transfer_aborted();
+	}
+
+	dma_setup_tx = false;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::read_byte(uint8_t &data) {
+	size_t read;
+
+	return read_bytes(&data, 1, read);
+}
+
+StatusCode UARTPort::read_bytes(uint8_t *data, size_t len, size_t &bytes_read) {
+	bytes_read = 0;
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+	poll_read_fd(uart);
+
+	if (dma_setup_rx) {
+		bytes_read = rx_ring->pop(data, len);
+		return bytes_read == 0 ? STATUS_CODE_EMPTY : STATUS_CODE_OK;
+	}
+
+	//waits for exactly len bytes, the way HAL_UART_Receive() does
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.timeout);
+	std::unique_lock<std::mutex> lock(uart->rx_lock);
+
+	while (uart->rx_line.size() < len) {
+		if (std::chrono::steady_clock::now() >= deadline) return STATUS_CODE_TIMEOUT;
+
+		if (uart->read_fd >= 0) {
+			lock.unlock();
+			poll_read_fd(uart);
+			lock.lock();
+		}
+		uart->rx_arrived.wait_for(lock, std::chrono::milliseconds(1));
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		data[i] = uart->rx_line.front();
+		uart->rx_line.pop_front();
+	}
+	bytes_read = len;
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::rx_peek(uint8_t *&data, size_t &len) {
+	len = 0;
+	if (!is_setup || !dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	StatusCode status = recoverRXDMA();
+	if (status != STATUS_CODE_OK) return status;
+
+	len = rx_ring->peek(data);
+	return len == 0 ? STATUS_CODE_EMPTY : STATUS_CODE_OK;
+}
+
+size_t UARTPort::rx_available() {
+	if (!is_setup || !dma_setup_rx) return 0;
+	return rx_ring->size();
+}
+
+StatusCode UARTPort::rx_consume(size_t len) {
+	if (!is_setup || !dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	rx_ring->consume(len);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::recoverRXDMA() {
+	//simulated dma never stops on an error, it only has to be caught up with whatever the fds have brought in
+	poll_read_fd(static_cast<HostUART *>(interface_handle));
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::rx_arrival_time(uint32_t byte_index, uint64_t &time_us) {
+	if (!dma_setup_rx) return STATUS_CODE_UNINITIALIZED;
+
+	//a start bit, 8 data bits, the parity bit and the stop bits
+	uint32_t bits = 9 + (settings.parity == UART_NO_PARITY ? 0 : 1) + settings.stop_bits;
+	uint32_t byte_time_us = bits * 1000000 / settings.baudrate;
+
+	uint32_t arrived;
+	if (!getDMARXArrival(dma_config, byte_index, byte_time_us, &arrived)) return STATUS_CODE_OUT_OF_RANGE;
+
+	//the stamp only has the low 32 bits, and it's in the past
+	uint64_t now = get_system_time_us();
+	time_us = now - (uint32_t) ((uint32_t) now - arrived);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::transmit(uint8_t *data, size_t len) {
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+	std::lock_guard<std::mutex> lock(uart->tx_lock);
+
+	if (dma_setup_tx) {
+		return tx_queue->write(data, len);
+	}
+
+	send_on_wire(uart, data, len);
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::transmit_reserve(size_t len, DMATxRegion &region) {
+	if (!is_setup || !dma_setup_tx) return STATUS_CODE_UNINITIALIZED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+	std::lock_guard<std::mutex> lock(uart->tx_lock);
+	return tx_queue->reserve(len, region);
+}
+
+StatusCode UARTPort::transmit_commit(size_t len) {
+	if (!is_setup || !dma_setup_tx) return STATUS_CODE_UNINITIALIZED;
+
+	auto uart = static_cast<HostUART *>(interface_handle);
+	std::lock_guard<std::mutex> lock(uart->tx_lock);
+	tx_queue->commit(len);
+	return STATUS_CODE_OK;
+}
+
+/***********************************************************************************************************************
+ * Wiring
+ **********************************************************************************************************************/
+
+static void close_fds(HostUART *uart) {
+	if (uart->owns_fds) {
+		if (uart->read_fd >= 0) close(uart->read_fd);
+		if (uart->write_fd >= 0 && uart->write_fd != uart->read_fd) close(uart->write_fd);
+	}
+	uart->read_fd = -1;
+	uart->write_fd = -1;
+	uart->owns_fds = false;
+}
+
+StatusCode host_uart_connect(UARTPortNum a, UARTPortNum b) {
+	if (!is_host_port(a) || !is_host_port(b)) return STATUS_CODE_INVALID_ARGS;
+
+	{
+		std::lock_guard<std::mutex> lock(uarts[a].tx_lock);
+		uarts[a].peer = b;
+	}
+	std::lock_guard<std::mutex> lock(uarts[b].tx_lock);
+	uarts[b].peer = a;
+	return STATUS_CODE_OK;
+}
+
+static StatusCode attach_fds(UARTPortNum port, int read_fd, int write_fd, bool owned) {
+	if (!is_host_port(port)) return STATUS_CODE_INVALID_ARGS;
+
+	HostUART *uart = &uarts[port];
+
+	if (read_fd >= 0) {
+		int flags = fcntl(read_fd, F_GETFL);
+		if (flags < 0 || fcntl(read_fd, F_SETFL, flags | O_NONBLOCK) < 0) return STATUS_CODE_INVALID_ARGS;
+	}
+
+	//tx before rx, the same order a transmit on a loopback takes them in
+	std::lock_guard<std::mutex> tx_lock(uart->tx_lock);
+	std::lock_guard<std::mutex> rx_lock(uart->rx_lock);
+	close_fds(uart);
+	uart->read_fd = read_fd;
+	uart->write_fd = write_fd;
+	uart->owns_fds = owned;
+	return STATUS_CODE_OK;
+}
+
+StatusCode host_uart_attach_fds(UARTPortNum port, int read_fd, int write_fd) {
+	return attach_fds(port, read_fd, write_fd, false);
+}
+
+StatusCode host_uart_open_pty(UARTPortNum port, char *name, size_t name_len) {
+	if (!is_host_port(port) || name == nullptr) return STATUS_CODE_INVALID_ARGS;
+
+	int fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd < 0) return STATUS_CODE_INTERNAL_ERROR;
+
+	//raw, so binary protocols get through the line discipline untouched
+	struct termios settings;
+	if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, name, name_len) != 0
+		|| tcgetattr(fd, &settings) != 0) {
+		close(fd);
+		return STATUS_CODE_INTERNAL_ERROR;
+	}
+	cfmakeraw(&settings);
+	tcsetattr(fd, TCSANOW, &settings);
+
+	StatusCode status = attach_fds(port, fd, fd, true);
+	if (status != STATUS_CODE_OK) close(fd);
+	return status;
+}
+
+size_t host_uart_inject(UARTPortNum port, const uint8_t *data, size_t len) {
+	if (!is_host_port(port)) return 0;
+
+	return receive(&uarts[port], data, len);
+}
+
+size_t host_uart_take_transmitted(UARTPortNum port, uint8_t *data, size_t len) {
+	if (!is_host_port(port)) return 0;
+
+	HostUART *uart = &uarts[port];
+	std::lock_guard<std::mutex> lock(uart->tx_lock);
+
+	if (len > uart->transmitted.size()) len = uart->transmitted.size();
+	memcpy(data, uart->transmitted.data(), len);
+	uart->transmitted.erase(uart->transmitted.begin(), uart->transmitted.begin() + len);
+	return len;
+}
+
+void host_uart_reset_all() {
+	for (HostUART &uart : uarts) {
+		std::lock_guard<std::mutex> tx_lock(uart.tx_lock);
+		std::lock_guard<std::mutex> rx_lock(uart.rx_lock);
+		close_fds(&uart);
+		uart.rx_line.clear();
+		uart.rx_dma = nullptr;
+		uart.transmitted.clear();
+		uart.peer = -1;
+	}
+}
@@ -1,9 +1,15 @@
 /**
  * SBUS is a protocol alternative to PPM and PWM that uses UART as a means of communication. It uses inverted UART
- * with a baudrate of 100,000
+ * with a baudrate of 100,000, 8 data bits, even parity and 2 stop bits (8E2)
  *
- * This is just a template, currently this is unimplemented
- * @author ***
+ * A frame of 25 bytes is sent every 7 or 14ms (depending on the receiver) with a gap in between. The UART driver hands
+ * bytes over on the idle line and stamps when it did, so a gap between bytes marks where a frame starts, and a frame
+ * is timed by when its first byte came in rather than when it's read. Frames are assembled directly in a buffer owned
+ * by this class and decoded in place (see SBUSFrame.hpp for the decoder itself)
+ *
+ * Hardware Info:
+ *
+ * Only UART2 supports DMA on the safety chip, so that's the port that should be used
  * @copyright Waterloo Aerial Robotics Group 2019
  *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
  */
@@ -14,9 +20,10 @@
 #include "GPIO.hpp"
 #include "UART.hpp"
 #include "PWM.hpp"
+#include "SBUSFrame.hpp"
 
 typedef struct SBUSSettings {
-	uint32_t dummy;
+	uint32_t disconnect_timeout = 100; //number of ms without a good frame before we consider the receiver disconnected
 } SBUSSettings;
 
 class SBUSPort {
@@ -28,9 +35,16 @@ class SBUSPort {
 	StatusCode reset();
 
 	/**
-	 * Returns a percent value that was most recently received from the PPM channel, as a percentage
+	 * Drains any bytes received by the UART and decodes every complete frame found. Call this periodically
+	 * from the main loop, at least as often as frames are sent
+	 * @return STATUS_CODE_EMPTY if no new frame was decoded
+	 */
+	StatusCode update();
+
+	/**
+	 * Returns a percent value that was most recently received from the SBUS channel, as a percentage
 	 * from 0-100
-	 * @param num
+	 * @param num 1-16
 	 * @return 0 if an invalid channel number was given
 	 */
 	uint8_t get(PWMChannelNum num);
@@ -43,14 +57,45 @@ class SBUSPort {
 	uint32_t get_us(PWMChannelNum num);
 
 	/**
-	 * Wether the channel has disconnected based on the timeout
+	 * Wether the channel has disconnected based on the timeout. Also true if the receiver has reported
+	 * that it is in failsafe
 	 * @param sys_time Current system time in ms
 	 * @return
 	 */
 	bool is_disconnected(uint32_t sys_time);
 
+	/**
+	 * @return True if the last frame had its frame lost flag set. Values are still valid, but stale
+	 */
+	bool is_frame_lost();
+
+	/**
+	 * @return System time in us at which the last good frame started arriving. 0 if none were received yet
+	 */
+	uint64_t get_frame_time_us();
+
+	/**
+	 * @return The last good frame, with all 16 raw channels and flags
+	 */
+	const SBUSFrame &get_frame();
+
  private:
 	bool is_setup = false;
 	UARTPort port;
 	SBUSSettings settings;
-};
\ No newline at end of file
+	SBUSFrameSync sync;
+	SBUSFrame frame = {};
+	uint64_t frame_time_us = 0;
+	bool received_frame = false;
+
+	uint32_t rx_bytes = 0; //read since rx dma was set up, which is how the uart looks up when they came in
+	uint64_t last_byte_us = 0; //when the last byte read came in
+	bool has_last_byte = false;
+
+	/**
+	 * Finds where the line last went idle in bytes that were just read, by when they came in
+	 * @param len Bytes read, starting at rx_bytes
+	 * @return Index of the first byte after the gap, or len if there wasn't one
+	 */
+	size_t find_idle(size_t len);
+};
@@ -5,6 +5,11 @@
  * modify the prescaler in the implementation, as we may get a timer overflow or get really bad precision!
  * Its fine if the signals we're reading are around the same ranges however, like 800us to 2200us. In that case
  * just modify the setLimits() so the percentages received are correct
+ *
+ * The capture interrupt only records the timer value of each edge into a circular buffer. Frames are found
+ * from the sync gap and decoded in one go the next time a channel is read (see PPMDecoder.hpp).
+ * Ideally DMA would fill that buffer, but TIM14 has no DMA request on the stm32f030, and PB1's only other
+ * timer function (TIM3_CH4) is already taken by PWM8
  * @author Serj Babayan
  * @copyright Waterloo Aerial Robotics Group 2019
  *  https://raw.githubusercontent.com/UWARG/ZeroPilot-SW/devel/LICENSE.md
@@ -18,8 +23,9 @@
 #include <stdint.h>
 #include "GPIO.hpp"
 #include "PWM.hpp"
+#include "PPMDecoder.hpp"
 
-static const int32_t MAX_PPM_CHANNELS = 12;
+static const int32_t MAX_PPM_CHANNELS = PPM_DECODER_MAX_CHANNELS;
 
 class PPMChannel {
  public:
@@ -89,10 +95,18 @@ class PPMChannel {
 	bool is_disconnected(uint32_t sys_time);
 
  private:
+	/**
+	 * Decode whatever the capture interrupt has recorded since the last call
+	 */
+	void update();
+
+	uint8_t num_channels;
 	int32_t deadzones[MAX_PPM_CHANNELS];
-	int32_t min_values[MAX_PPM_CHANNELS]; //stores min tick values for each channel
-	int32_t max_values[MAX_PPM_CHANNELS]; //stores max tick values for each channel
+	int32_t min_values[MAX_PPM_CHANNELS]; //stores min us values for each channel
+	int32_t max_values[MAX_PPM_CHANNELS]; //stores max us values for each channel
 	uint32_t disconnect_timeout;
+	uint32_t last_frame_time = 0; //system time in ms at which we last decoded a full frame
+	PPMDecoder decoder;
 	bool is_setup = false;
 	GPIOPin ppm_pin;
-};
\ No newline at end of file
+};
@@ -17,15 +17,29 @@
  *
  * The above means we can only set the frequencies of a group of PWMs controlled by a single timer!
  * We can't individually control frequencies of channels!
+ *
+ * Any group can also be switched over to DShot output for ESCs that support it. The timer's update DMA then
+ * writes a precomputed compare value for every bit, for all channels in the group at once. The stm32f030
+ * shares each DMA channel between several peripherals, so watch out for conflicts:
+ *
+ * PWM 1 (TIM16_UP) - DMA1 Channel 3, shared with I2C1 RX
+ * PWM 2 (TIM17_UP) - DMA1 Channel 1
+ * PWM 3-4 (TIM15_UP) - DMA1 Channel 5, shared with UART2 RX
+ * PWM 5-8 (TIM3_UP) - DMA1 Channel 3, shared with I2C1 RX
+ * PWM 9-12 (TIM1_UP) - DMA1 Channel 5, shared with UART2 RX
  */
 
 #pragma once
 
 #include <stdint.h>
 #include "GPIO.hpp"
+#include "DShot.hpp"
+#include "PWMScale.hpp"
 
 typedef uint8_t PWMChannelNum;
 
+static const uint8_t PWM_NUM_GROUPS = 5;
+
 /**
  * Represents a group of PWM outputs that map to a single timer
  * Settings can be changed on a per-group basis
@@ -45,6 +59,13 @@ typedef struct PWMGroupSetting {
 	bool inverted = false;
 } PWMGroupSetting;
 
+typedef struct PWMDShotState {
+	bool enabled = false;
+	bool bidirectional = false;
+	DShotTiming timing;
+	uint16_t packets[4]; //frames to send next, one per channel in the group
+} PWMDShotState;
+
 class PWMChannel {
  public:
 	PWMChannel() = default;
@@ -64,7 +85,9 @@ class PWMChannel {
 	StatusCode reset();
 
 	/**
-	 * Sets the min and max signals. Used for percentage conversion
+	 * Sets the min and max signals. Used for percentage conversion, and every pulse is clamped to them
+	 * Also precomputes the conversion to timer ticks, so this has to be called again whenever the timer
+	 * is reconfigured
 	 * @param min
 	 * @param max
 	 */
@@ -76,12 +99,18 @@ class PWMChannel {
 	 */
 	void set(uint8_t percent);
 
+	/**
+	 * Set the output to a specific pulse width
+	 * @param us Clamped to the limits, and to the period of the timer
+	 */
+	void set_us(uint16_t us);
+
  private:
 	GPIOPin pin;
-	void *timer;
-	uint16_t timer_channel;
-	uint32_t min_signal = 1000; //standard for 50hz pwm signal
-	uint32_t max_signal = 2000;
+	void *timer = nullptr;
+	uint16_t timer_channel = 0;
+	PWMScale scale = {0, 0, 0, 0}; //from setLimits(). Sends nothing until then
+	volatile uint32_t *compare = nullptr; //capture/compare register of the channel
 };
 
 /**
@@ -99,7 +128,8 @@ class PWMManager {
 
 	/**
 	 * Configure a PWM port with the appropriate frequency, etc..
-	 * Call setup() afterwards
+	 * Call setup() afterwards. Called after setup(), every PWM group is restarted in phase with the reconfigured
+	 * one, which can cut the pulse each of them is sending short
 	 * @param group
 	 * @param setting
 	 * @return
@@ -133,13 +163,49 @@ class PWMManager {
 	 */
 	StatusCode set_all(uint8_t percent);
 
+	/**
+	 * Sets every output channel to a pulse width at once. All the new values take effect on the
+	 * same pwm period, as long as the groups share the same period. Channels in DShot groups are skipped
+	 * @param us Pulse widths for channels 1-12
+	 * @return
+	 */
+	StatusCode set_all_us(const uint16_t us[12]);
+
+	/**
+	 * Switch a group over to DShot output. Channels in the group should only be set through
+	 * set_dshot() after this. Call configure() on the group to go back to regular PWM
+	 * @param group
+	 * @param speed
+	 * @param bidirectional Invert the output and request eRPM replies from the ESC
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if the DMA channel the group needs is already in use
+	 */
+	StatusCode configure_dshot(PWMGroup group, DShotSpeed speed, bool bidirectional = false);
+
+	/**
+	 * Set the value a DShot channel will send next. Nothing goes out until send_dshot() is called
+	 * @param num 1-indexed channel, in a group that was configured for DShot
+	 * @param value 0-2047, see DShot.hpp. Use dshot_throttle_value() to convert a throttle
+	 * @param telemetry Request telemetry from the ESC
+	 * @return
+	 */
+	StatusCode set_dshot(PWMChannelNum num, uint16_t value, bool telemetry = false);
+
+	/**
+	 * Starts sending a frame on every DShot group. Should be called at a fixed rate, as ESCs
+	 * disarm if they stop getting frames
+	 * @return STATUS_CODE_RESOURCE_EXHAUSTED if a group was still busy sending its last frame. That
+	 * group is skipped, the others are still sent
+	 */
+	StatusCode send_dshot();
+
 	//disable copy and assignment constructors
 	PWMManager(PWMManager const &) = delete;
 	void operator=(PWMManager const &) = delete;
 
  private:
-	PWMManager() = default; //force initialization through getInstance()
+	PWMManager(); //force initialization through getInstance()
 	PWMChannel channels[12];
+	PWMDShotState dshot[PWM_NUM_GROUPS];
 	bool is_setup = false;
 	uint16_t prescaler;
 };
\ No newline at end of file
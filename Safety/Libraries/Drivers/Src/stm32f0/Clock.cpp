@@ -4,6 +4,9 @@
 
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 
+//us per systick count, as a 16.16 fixed point number, so get_system_time_us() doesn't need the m0's software divide
+static uint32_t systick_us_scale = 0;
+
 uint32_t get_lsi_clock() {
 	return 40000UL; //40khz lsi clock on stm32f0
 }
@@ -56,9 +59,47 @@ StatusCode initialize_system_clock() {
 
 	HAL_RCC_MCOConfig(RCC_MCO, RCC_MCO1SOURCE_SYSCLK, RCC_MCODIV_1);
 
+	//systick was set up for 1ms ticks at the new clock speed by HAL_RCC_ClockConfig()
+	systick_us_scale = (1000UL << 16) / (SysTick->LOAD + 1);
+
 	return STATUS_CODE_OK;
 }
 
+/**
+ * The ms tick plus how far systick has counted down into the current ms. The tick is read again after systick, the
+ * same way get_cycle_count() does, so a tick interrupt in between can't make the time jump back 1ms
+ */
 uint64_t get_system_time_us() {
-	return (uint64_t) (HAL_GetTick() * 1000ULL + SysTick->VAL / (get_system_clock() / 1000000UL));
-}
\ No newline at end of file
+	uint32_t tick;
+	uint32_t value;
+
+	do {
+		tick = HAL_GetTick();
+		value = SysTick->VAL;
+	} while (tick != HAL_GetTick());
+
+	uint32_t into_tick = ((SysTick->LOAD - value) * systick_us_scale) >> 16;
+	return (uint64_t) tick * 1000ULL + into_tick;
+}
+
+/**
+ * The m0 has no cycle counter, so this counts ms ticks of (LOAD + 1) cycles each, plus how far systick has counted
+ * down into the current one. The tick is read on both sides of the systick value, and if the tick interrupt landed in
+ * between the read is done again. Only multiplies and adds, so it stays cheap without a hardware divider
+ */
+uint32_t get_cycle_count() {
+	uint32_t tick;
+	uint32_t value;
+
+	do {
+		tick = HAL_GetTick();
+		value = SysTick->VAL;
+	} while (tick != HAL_GetTick());
+
+	uint32_t reload = SysTick->LOAD;
+	return tick * (reload + 1) + (reload - value);
+}
+
+uint32_t get_cycle_count_frequency() {
+	return SystemCoreClock;
+}
@@ -1,6 +1,7 @@
 #include "I2C.hpp"
 #include "Status.hpp"
 #include "Debug.hpp"
+#include "BinaryLog.hpp"
 #include "DMA.hpp"
 #include "stm32f0xx_hal.h"
 #include <stdlib.h>
@@ -22,7 +23,11 @@ uint32_t FAST_MODE_SLAVE_TIMING = 0x00900000;
 I2C_HandleTypeDef hi2c1;
 DMA_HandleTypeDef hdma_i2c1_rx;
 DMAConfig i2c1_dma_config;
-static std::deque<uint8_t> i2c1_rx_queue;
+
+//received bytes wait here until they're read. Must be a power of two, and at least as big as the dma buffer
+static const uint32_t I2C_RX_RING_LEN = 128;
+static uint8_t i2c1_rx_storage[I2C_RX_RING_LEN];
+static ByteRing i2c1_rx_ring;
 
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 void I2C1_DMA_ErrorCallback(DMA_HandleTypeDef *dma);
@@ -75,15 +80,22 @@ StatusCode I2CPort::reset() {
 //we're only gonna support DMA on I2C1 RX for this device
 StatusCode I2CSlavePort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 	if (port != I2C_PORT1) return STATUS_CODE_UNIMPLEMENTED;
-	if (dma_setup_rx || !is_setup || rx_buffer_size == 0) return STATUS_CODE_INVALID_ARGS;
+	if (dma_setup_rx || !is_setup || rx_buffer_size == 0 || rx_buffer_size > I2C_RX_RING_LEN) {
+		return STATUS_CODE_INVALID_ARGS;
+	}
 
 	__HAL_RCC_DMA1_CLK_ENABLE();
 
 	dma_config = &i2c1_dma_config;
 	resetDMAConfig(dma_config, rx_buffer_size);
 	dma_config->dma_handle = (void *) &hdma_i2c1_rx;
-	dma_config->queue = (void *) &i2c1_rx_queue;
-	rx_queue = &i2c1_rx_queue;
+	dma_config->queue = (void *) &i2c1_rx_ring;
+	rx_ring = &i2c1_rx_ring;
+
+	//keep whatever was already received if we're only re-setting up after an error
+	if (reallocate_dma_buffer) {
+		rx_ring->init(i2c1_rx_storage, I2C_RX_RING_LEN);
+	}
 
 	auto handle = (I2C_HandleTypeDef *) interface_handle;
 	auto dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
@@ -159,7 +171,7 @@ StatusCode I2CSlavePort::resetDMA() {
 		if (dma_config->dma_buffer == nullptr) abort("i2c dma buffer null!", __FILE__, __LINE__);
 		free(dma_config->dma_buffer);
 		dma_config->dma_buffer = nullptr;
-		rx_queue->erase(rx_queue->begin(), rx_queue->end());
+		rx_ring->clear();
 	}
 
 	dma_setup_rx = false;
@@ -168,7 +180,7 @@ StatusCode I2CSlavePort::resetDMA() {
 
 void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef *hi2c) {
 	if (hi2c->Instance == I2C1) {
-		processDMARXCompleteEvent(&i2c1_dma_config);
+		processDMARXEvent(&i2c1_dma_config);
 
 		//notify user we received new packet
 		if (i2c1_dma_config.complete_callback) {
@@ -178,14 +190,14 @@ void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef *hi2c) {
 }
 
 void I2C1_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("I2C1 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("I2C1 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
 	if (hi2c->Instance == I2C1) {
-		error("USART1 Error received", hi2c->ErrorCode);
+		LOG_ERROR("I2C1 Error received. Code: 0x%02lx", hi2c->ErrorCode);
 		i2c1_dma_config.reset = true;
 	} else {
-		error("Unknown USART port got an error callback");
+		LOG_ERROR("Unknown I2C port got an error callback");
 	}
 }
\ No newline at end of file
@@ -6,42 +6,30 @@
 
 TIM_HandleTypeDef htim14;
 
-//number of milliseconds expected between subsequent PPM packets
-uint32_t PPM_PACKET_TIMEOUT = 3;
-
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 
 //if modifying the below pin numbers, also modify the ISR routine down below to match
 static const GPIOPinNum PPM_PIN_NUM = 1;
 static const GPIOPort PPM_PORT = GPIO_PORT_B;
 
-static const uint16_t TIMER_PRESCALER = 2; // since we're capturing 2000us max signal
+//timer counts at 2Mhz, so a 16 bit counter wraps around every 32ms. That's longer than a whole PPM frame,
+//which lets us leave the counter free running and just subtract consecutive edges
+static const uint32_t TIMER_TICK_HZ = 2000000UL;
 static const uint16_t TIMER_PERIOD = 0xFFFF;
 
-static uint8_t num_channels = 0;
-static volatile uint16_t capture_value[MAX_PPM_CHANNELS] = {0};
-static volatile uint8_t ppm_index = 0;
-
-//these variables are used in the systick interrupt routine
-volatile uint32_t ppm_last_received_time = 0;
-volatile uint8_t ppm_packet_timeout_reached = 1;
-
-// 1 tick is prescaler / 48000000Hz (internal clock)
-//therefore capture in us = capture * prescaler * 1E6 / 8E6
-inline static uint32_t convert_ticks_to_us(int32_t ticks) {
-	return (ticks * (TIMER_PRESCALER + 1)) / (get_system_clock() / (1000000UL));
-}
+//filled in by the capture interrupt, one timestamp per rising edge. Only the interrupt writes to these
+static volatile uint16_t ppm_captures[PPM_CAPTURE_BUFFER_LEN] = {0};
+static volatile uint32_t ppm_capture_head = 0;
 
 PPMChannel::PPMChannel(uint8_t channels, uint32_t timeout) {
 	if (channels > MAX_PPM_CHANNELS || channels <= 0) {
-		num_channels = 8;
+		channels = 8;
 	}
 
-	ppm_index = 0;
+	this->num_channels = channels;
 	this->disconnect_timeout = timeout;
 
 	for (int i = 0; i < MAX_PPM_CHANNELS; i++) {
-		capture_value[i] = 0;
 		min_values[i] = 1000;
 		max_values[i] = 2000;
 		deadzones[i] = 0;
@@ -60,7 +48,8 @@ StatusCode PPMChannel::setLimits(uint8_t channel, uint32_t min, uint32_t max, ui
 	this->max_values[channel - 1] = max;
 	this->deadzones[channel - 1] = deadzone;
 
-	return STATUS_CODE_OK;
+	//the decoder precomputes its conversion constants here, so none of this is done when reading channels
+	return decoder.set_limits(channel - 1, min, max, deadzone);
 }
 
 StatusCode PPMChannel::setTimeout(uint32_t timeout) {
@@ -76,34 +65,31 @@ StatusCode PPMChannel::setNumChannels(uint8_t num) {
 		return STATUS_CODE_INVALID_ARGS;
 	}
 	num_channels = num;
+
+	if (is_setup) {
+		StatusCode status = decoder.configure(TIMER_TICK_HZ, num_channels);
+		if (status != STATUS_CODE_OK) return status;
+
+		for (uint8_t i = 0; i < num_channels; i++) {
+			decoder.set_limits(i, min_values[i], max_values[i], deadzones[i]);
+		}
+	}
 	return STATUS_CODE_OK;
 }
 
-uint8_t PPMChannel::get(PWMChannelNum num) {
-	if (num <= 0 || num > num_channels) {
-		return 0;
+void PPMChannel::update() {
+	if (decoder.process(ppm_captures, ppm_capture_head) > 0) {
+		last_frame_time = get_system_time();
 	}
+}
 
-	int32_t capture = capture_value[num - 1];
-
-	// 1 tick is prescaler / 48000000Hz (internal clock)
-	//therefore capture in us = capture * prescaler * 1E6 / 8E6
-	uint32_t num_us = convert_ticks_to_us(capture);
-
-	int32_t min_diff = num_us - this->min_values[num - 1];
-
-	//if the input signal is lower than the minimum signal, or if we're not outside the deadzone, return 0%
-	if (min_diff < 0 || min_diff < deadzones[num - 1]) {
+uint8_t PPMChannel::get(PWMChannelNum num) {
+	if (num <= 0 || num > num_channels) {
 		return 0;
 	}
 
-	uint32_t
-		percent = (num_us - this->min_values[num - 1]) * 100 / (this->max_values[num - 1] - this->min_values[num - 1]);
-
-	if (percent > 100) {
-		return 100;
-	}
-	return (uint8_t) percent;
+	update();
+	return decoder.get_percent(num - 1);
 }
 
 uint32_t PPMChannel::get_us(PWMChannelNum num) {
@@ -111,8 +97,8 @@ uint32_t PPMChannel::get_us(PWMChannelNum num) {
 		return 0;
 	}
 
-	int32_t capture = capture_value[num - 1];
-	return convert_ticks_to_us(capture);
+	update();
+	return decoder.get_us(num - 1);
 }
 
 StatusCode PPMChannel::setup() {
@@ -120,9 +106,16 @@ StatusCode PPMChannel::setup() {
 		return STATUS_CODE_INVALID_ARGS;
 	}
 
+	StatusCode status = decoder.configure(TIMER_TICK_HZ, num_channels);
+	if (status != STATUS_CODE_OK) return status;
+
+	for (uint8_t i = 0; i < num_channels; i++) {
+		decoder.set_limits(i, min_values[i], max_values[i], deadzones[i]);
+	}
+
 	__HAL_RCC_TIM14_CLK_ENABLE();
 
-	StatusCode status = ppm_pin.setup();
+	status = ppm_pin.setup();
 	if (status != STATUS_CODE_OK) return status;
 
 	//enable timer14 interrupts
@@ -131,8 +124,9 @@ StatusCode PPMChannel::setup() {
 
 	TIM_IC_InitTypeDef sConfigIC = {0, 0, 0, 0};
 
+	//apb1 timers run at the system clock on the stm32f0, since the apb1 prescaler is 1
 	htim14.Instance = TIM14;
-	htim14.Init.Prescaler = TIMER_PRESCALER;
+	htim14.Init.Prescaler = (uint16_t) (get_system_clock() / TIMER_TICK_HZ - 1);
 	htim14.Init.CounterMode = TIM_COUNTERMODE_UP;
 	htim14.Init.Period = TIMER_PERIOD;
 	htim14.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
@@ -152,7 +146,8 @@ StatusCode PPMChannel::setup() {
 	status = get_status_code(HAL_TIM_IC_ConfigChannel(&htim14, &sConfigIC, TIM_CHANNEL_1));
 	if (status != STATUS_CODE_OK) return status;
 
-	status = get_status_code(HAL_TIM_Base_Start_IT(&htim14));
+	//no update interrupt needed, as the sync gap is found from the capture timestamps themselves
+	status = get_status_code(HAL_TIM_Base_Start(&htim14));
 	if (status != STATUS_CODE_OK) return status;
 
 	status = get_status_code(HAL_TIM_IC_Start_IT(&htim14, TIM_CHANNEL_1));
@@ -178,37 +173,23 @@ StatusCode PPMChannel::reset() {
 }
 
 bool PPMChannel::is_disconnected(uint32_t sys_time) {
-	bool disconnected = (sys_time - ppm_last_received_time) >= this->disconnect_timeout;
+	update();
+
+	bool disconnected = (sys_time - last_frame_time) >= this->disconnect_timeout;
 
 	if (disconnected) { //reset capture states if we get a disconnect timeout
-		for (int i = 0; i < num_channels; i++) {
-			capture_value[i] = 0;
-		}
-		ppm_index = 0;
+		decoder.clear();
 	}
 
 	return disconnected;
 }
 
-//our interrupt callback for when we get a pulse capture
+//our interrupt callback for when we get a pulse capture. Kept as short as possible, all decoding
+//happens when the channels are read
 void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
 	if (htim->Instance == TIM14) {
-		ppm_last_received_time = get_system_time();
-		auto time_diff = (uint16_t) HAL_TIM_ReadCapturedValue(htim, TIM_CHANNEL_1);
-
-		if (ppm_packet_timeout_reached) {
-			ppm_packet_timeout_reached = 0;
-			ppm_index = 0;
-		}
-
-		capture_value[ppm_index] = time_diff;
-		ppm_index = (uint8_t) (ppm_index + 1) % num_channels;
-		__HAL_TIM_SET_COUNTER(htim, 0);
-	}
-}
-
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
-	if (htim->Instance == TIM14) { // only timer we care about
-		ppm_index = 0;
+		uint32_t head = ppm_capture_head;
+		ppm_captures[head & (PPM_CAPTURE_BUFFER_LEN - 1)] = (uint16_t) htim->Instance->CCR1;
+		ppm_capture_head = head + 1;
 	}
 }
@@ -38,6 +38,30 @@ static const PWMPinConfig PWM_CONFIG[12] = {
 	{11, GPIO_PORT_A, GPIO_AF2_TIM1, &htim1, TIM_CHANNEL_4}, //pwm12
 };
 
+typedef struct PWMTimerConfig {
+	TIM_HandleTypeDef *timer;
+	TIM_TypeDef *instance;
+	DMA_Channel_TypeDef *dma_channel;
+	uint8_t first_channel; //index into PWM_CONFIG
+	uint8_t num_channels;
+	uint32_t burst_length;
+	bool config_breaktime;
+	bool config_master;
+} PWMTimerConfig;
+
+static const PWMTimerConfig PWM_TIMER_CONFIG[PWM_NUM_GROUPS] = {
+	{&htim16, TIM16, DMA1_Channel3, 0, 1, TIM_DMABURSTLENGTH_1TRANSFER, true, false}, //pwm1
+	{&htim17, TIM17, DMA1_Channel1, 1, 1, TIM_DMABURSTLENGTH_1TRANSFER, true, false}, //pwm2
+	{&htim15, TIM15, DMA1_Channel5, 2, 2, TIM_DMABURSTLENGTH_2TRANSFERS, true, true}, //pwm3-4
+	{&htim3, TIM3, DMA1_Channel3, 4, 4, TIM_DMABURSTLENGTH_4TRANSFERS, false, true}, //pwm5-8
+	{&htim1, TIM1, DMA1_Channel5, 8, 4, TIM_DMABURSTLENGTH_4TRANSFERS, true, true}, //pwm9-12
+};
+
+static const uint16_t PWM_CHANNEL_TO_CCR_SHIFT = 2; //TIM_CHANNEL_x is 4 * (x - 1), CCRx registers are 1 word apart
+
+//compare values the DMA copies into the timer, one per channel per bit
+static uint16_t dshot_buffers[PWM_NUM_GROUPS][DSHOT_FRAME_SLOTS * 4];
+
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 
 /**
@@ -54,11 +78,14 @@ static TIM_BreakDeadTimeConfigTypeDef getBreaktimeConfig();
 static TIM_MasterConfigTypeDef getMasterConfig();
 static StatusCode init_timer(TIM_HandleTypeDef *timer,
 							 TIM_TypeDef *instance,
-							 uint32_t period,
+							 struct PWMCounterSettings counter,
 							 int32_t num_channels,
 							 bool config_breaktime,
 							 bool config_master,
 							 bool inverted);
+static void enable_timer_clock(PWMGroup group);
+static void stop_dshot_dma(PWMGroup group);
+static void synchronize_timers(const PWMDShotState dshot[PWM_NUM_GROUPS]);
 
 PWMChannel::PWMChannel(GPIOPort port, GPIOPinNum pin_num, uint8_t alternate_function, void *timer, uint16_t channel) {
 	pin = GPIOPin(port, pin_num, GPIO_ALT_PP, GPIO_STATE_LOW, GPIO_RES_NONE, GPIO_FREQ_LOW, alternate_function);
@@ -67,21 +94,20 @@ PWMChannel::PWMChannel(GPIOPort port, GPIOPinNum pin_num, uint8_t alternate_func
 }
 
 void PWMChannel::setLimits(uint32_t min, uint32_t max) {
-	this->min_signal = min;
-	this->max_signal = max;
+	//precompute everything set() and set_us() need, so setting an output is just a multiply and a shift
+	auto handle = static_cast<TIM_HandleTypeDef *>(this->timer);
+	uint32_t tick_hz = get_system_clock() / (handle->Init.Prescaler + 1);
+
+	pwm_get_scale(tick_hz, handle->Init.Period, min, max, scale);
+	compare = &handle->Instance->CCR1 + (timer_channel >> PWM_CHANNEL_TO_CCR_SHIFT);
 }
 
 void PWMChannel::set(uint8_t percent) {
-	if (percent > 100) {
-		percent = 100;
-	}
-
-	//in us
-	uint32_t prescaler = (static_cast<TIM_HandleTypeDef *>(this->timer))->Init.Prescaler;
-	uint32_t us = ((percent * (max_signal - min_signal)) / 100 + min_signal);
-	uint32_t ticks = (us * (get_system_clock() / 1000000UL)) / (prescaler + 1);
+	set_us(pwm_percent_to_us(scale, percent));
+}
 
-	__HAL_TIM_SET_COMPARE((TIM_HandleTypeDef *) this->timer, this->timer_channel, (uint32_t) ticks);
+void PWMChannel::set_us(uint16_t us) {
+	*compare = pwm_us_to_ticks(scale, us);
 }
 
 StatusCode PWMChannel::setup() {
@@ -92,6 +118,16 @@ StatusCode PWMChannel::reset() {
 	return pin.reset();
 }
 
+PWMManager::PWMManager() {
+	for (int i = 0; i < 12; i++) {
+		channels[i] = PWMChannel(PWM_CONFIG[i].port,
+								 PWM_CONFIG[i].num,
+								 PWM_CONFIG[i].pin_function,
+								 (void *) PWM_CONFIG[i].timer,
+								 PWM_CONFIG[i].timer_channel);
+	}
+}
+
 PWMManager &PWMManager::getInstance() {
 	static PWMManager instance;
 
@@ -107,7 +143,7 @@ StatusCode PWMManager::setup() {
 	PWMGroupSetting default_settings = {
 		20000, //20ms period
 		1000, //1ms min pulse length
-		1500, //2ms max pulse length
+		2000, //2ms max pulse length
 		false //not inverted
 	};
 
@@ -127,11 +163,6 @@ StatusCode PWMManager::setup() {
 
 	//init the GPIO for all the channels
 	for (int i = 0; i < 12; i++) {
-		channels[i] = PWMChannel(PWM_CONFIG[i].port,
-								 PWM_CONFIG[i].num,
-								 PWM_CONFIG[i].pin_function,
-								 (void *) PWM_CONFIG[i].timer,
-								 PWM_CONFIG[i].timer_channel);
 		status = channels[i].setup();
 
 		if (status != STATUS_CODE_OK) {
@@ -142,40 +173,51 @@ StatusCode PWMManager::setup() {
 		if (status != STATUS_CODE_OK) return status;
 	}
 
+	//all groups share the same default period, so starting them in phase means they all hit
+	//their update events together. set_all_us() relies on that
+	synchronize_timers(dshot);
+
 	is_setup = true;
 	return STATUS_CODE_OK;
 }
 
 StatusCode PWMManager::configure(PWMGroup group, PWMGroupSetting setting) {
+	if (group < PWM_NUM_GROUPS && dshot[group].enabled) {
+		stop_dshot_dma(group);
+		dshot[group].enabled = false;
+	}
+
+	StatusCode status = STATUS_CODE_OK;
+
 	switch (group) {
 		case PWM_GROUP_1: __HAL_RCC_TIM16_CLK_ENABLE();
-			init_timer(&htim16, TIM16, setting.period, 1, true, false, setting.inverted);
+			init_timer(&htim16, TIM16, getCounterSettings(setting.period), 1, true, false, setting.inverted);
 			channels[0].setLimits(setting.min_length, setting.max_length);
 
 			if (is_setup) { //if we're reconfiguring the channel, rather than completly setting it up again
-				return get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[0].timer, PWM_CONFIG[0].timer_channel));
+				status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[0].timer, PWM_CONFIG[0].timer_channel));
 			}
 			break;
 		case PWM_GROUP_2: __HAL_RCC_TIM17_CLK_ENABLE();
-			init_timer(&htim17, TIM17, setting.period, 1, true, false, setting.inverted);
+			init_timer(&htim17, TIM17, getCounterSettings(setting.period), 1, true, false, setting.inverted);
 			channels[1].setLimits(setting.min_length, setting.max_length);
 
 			if (is_setup) {
-				return get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[1].timer, PWM_CONFIG[1].timer_channel));
+				status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[1].timer, PWM_CONFIG[1].timer_channel));
 			}
 			break;
 		case PWM_GROUP_3_4: __HAL_RCC_TIM15_CLK_ENABLE();
-			init_timer(&htim15, TIM15, setting.period, 2, true, true, setting.inverted);
+			init_timer(&htim15, TIM15, getCounterSettings(setting.period), 2, true, true, setting.inverted);
 			channels[2].setLimits(setting.min_length, setting.max_length);
 			channels[3].setLimits(setting.min_length, setting.max_length);
 
 			if (is_setup) {
 				HAL_TIM_PWM_Start(PWM_CONFIG[2].timer, PWM_CONFIG[2].timer_channel);
-				return get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[3].timer, PWM_CONFIG[3].timer_channel));
+				status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[3].timer, PWM_CONFIG[3].timer_channel));
 			}
 			break;
 		case PWM_GROUP_5_8: __HAL_RCC_TIM3_CLK_ENABLE();
-			init_timer(&htim3, TIM3, setting.period, 4, false, true, setting.inverted);
+			init_timer(&htim3, TIM3, getCounterSettings(setting.period), 4, false, true, setting.inverted);
 			channels[4].setLimits(setting.min_length, setting.max_length);
 			channels[5].setLimits(setting.min_length, setting.max_length);
 			channels[6].setLimits(setting.min_length, setting.max_length);
@@ -185,11 +227,11 @@ StatusCode PWMManager::configure(PWMGroup group, PWMGroupSetting setting) {
 				HAL_TIM_PWM_Start(PWM_CONFIG[4].timer, PWM_CONFIG[4].timer_channel);
 				HAL_TIM_PWM_Start(PWM_CONFIG[5].timer, PWM_CONFIG[5].timer_channel);
 				HAL_TIM_PWM_Start(PWM_CONFIG[6].timer, PWM_CONFIG[6].timer_channel);
-				return get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[7].timer, PWM_CONFIG[7].timer_channel));
+				status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[7].timer, PWM_CONFIG[7].timer_channel));
 			}
 			break;
 		case PWM_GROUP_9_12: __HAL_RCC_TIM1_CLK_ENABLE();
-			init_timer(&htim1, TIM1, setting.period, 4, true, true, setting.inverted);
+			init_timer(&htim1, TIM1, getCounterSettings(setting.period), 4, true, true, setting.inverted);
 			channels[8].setLimits(setting.min_length, setting.max_length);
 			channels[9].setLimits(setting.min_length, setting.max_length);
 			channels[10].setLimits(setting.min_length, setting.max_length);
@@ -199,12 +241,18 @@ StatusCode PWMManager::configure(PWMGroup group, PWMGroupSetting setting) {
 				HAL_TIM_PWM_Start(PWM_CONFIG[8].timer, PWM_CONFIG[8].timer_channel);
 				HAL_TIM_PWM_Start(PWM_CONFIG[9].timer, PWM_CONFIG[9].timer_channel);
 				HAL_TIM_PWM_Start(PWM_CONFIG[10].timer, PWM_CONFIG[10].timer_channel);
-				return get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[11].timer, PWM_CONFIG[11].timer_channel));
+				status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[11].timer, PWM_CONFIG[11].timer_channel));
 			}
 			break;
 		default: return STATUS_CODE_INVALID_ARGS;
 	}
-	return STATUS_CODE_OK;
+
+	//the reinitialised timer starts counting from 0 again, out of phase with the rest. Restart them all together, as
+	//setup() does, so set_all_us() still lands on the same period everywhere
+	if (is_setup && status == STATUS_CODE_OK) {
+		synchronize_timers(dshot);
+	}
+	return status;
 }
 
 StatusCode PWMManager::reset() {
@@ -216,6 +264,13 @@ StatusCode PWMManager::reset() {
 		channels[i].reset();
 	}
 
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (dshot[i].enabled) {
+			stop_dshot_dma((PWMGroup) i);
+			dshot[i].enabled = false;
+		}
+	}
+
 	HAL_TIM_Base_DeInit(&htim16);
 	HAL_TIM_Base_DeInit(&htim17);
 	HAL_TIM_Base_DeInit(&htim15);
@@ -239,6 +294,138 @@ StatusCode PWMManager::set_all(uint8_t percent) {
 	return STATUS_CODE_OK;
 }
 
+StatusCode PWMManager::configure_dshot(PWMGroup group, DShotSpeed speed, bool bidirectional) {
+	if (group >= PWM_NUM_GROUPS) return STATUS_CODE_INVALID_ARGS;
+
+	const PWMTimerConfig &config = PWM_TIMER_CONFIG[group];
+	PWMDShotState &state = dshot[group];
+
+	//timers run straight off the system clock, since the apb prescaler is 1
+	DShotTiming timing;
+	StatusCode status = dshot_get_timing(speed, get_system_clock(), timing);
+	if (status != STATUS_CODE_OK) return status;
+
+	//channel is already running for some other peripheral
+	if (!state.enabled && (config.dma_channel->CCR & DMA_CCR_EN)) {
+		return STATUS_CODE_RESOURCE_EXHAUSTED;
+	}
+
+	//two groups can share a dma channel, but only one of them can be sending DShot
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (i != group && dshot[i].enabled && PWM_TIMER_CONFIG[i].dma_channel == config.dma_channel) {
+			return STATUS_CODE_RESOURCE_EXHAUSTED;
+		}
+	}
+
+	if (state.enabled) {
+		stop_dshot_dma(group);
+	}
+
+	//one timer period per bit, with no prescaler so we get the most resolution on the pulse widths
+	struct PWMCounterSettings counter = {0, (uint16_t) (timing.period - 1)};
+
+	enable_timer_clock(group);
+	status = init_timer(config.timer,
+						config.instance,
+						counter,
+						config.num_channels,
+						config.config_breaktime,
+						config.config_master,
+						bidirectional);
+	if (status != STATUS_CODE_OK) return status;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	//the timer copies a burst of num_channels values into CCR1 onwards on every update event
+	config.dma_channel->CCR = 0;
+	config.dma_channel->CPAR = (uint32_t) &config.instance->DMAR;
+	config.dma_channel->CCR = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_PL_1;
+	config.instance->DCR = TIM_DMABASE_CCR1 | config.burst_length;
+	__HAL_TIM_ENABLE_DMA(config.timer, TIM_DMA_UPDATE);
+
+	state.timing = timing;
+	state.bidirectional = bidirectional;
+	for (int i = 0; i < 4; i++) {
+		state.packets[i] = dshot_encode_packet(DSHOT_CMD_MOTOR_STOP, false, bidirectional);
+	}
+	state.enabled = true;
+
+	if (is_setup) {
+		for (int i = config.first_channel; i < config.first_channel + config.num_channels; i++) {
+			status = get_status_code(HAL_TIM_PWM_Start(PWM_CONFIG[i].timer, PWM_CONFIG[i].timer_channel));
+			if (status != STATUS_CODE_OK) return status;
+		}
+	}
+	return STATUS_CODE_OK;
+}
+
+StatusCode PWMManager::set_dshot(PWMChannelNum num, uint16_t value, bool telemetry) {
+	if (num == 0 || num > 12) return STATUS_CODE_INVALID_ARGS;
+
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		const PWMTimerConfig &config = PWM_TIMER_CONFIG[i];
+		uint8_t index = (uint8_t) (num - 1 - config.first_channel);
+
+		if (index < config.num_channels) {
+			if (!dshot[i].enabled) return STATUS_CODE_UNINITIALIZED;
+
+			dshot[i].packets[index] = dshot_encode_packet(value, telemetry, dshot[i].bidirectional);
+			return STATUS_CODE_OK;
+		}
+	}
+	return STATUS_CODE_INVALID_ARGS;
+}
+
+StatusCode PWMManager::send_dshot() {
+	StatusCode status = STATUS_CODE_OK;
+
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (!dshot[i].enabled) continue;
+
+		const PWMTimerConfig &config = PWM_TIMER_CONFIG[i];
+		DMA_Channel_TypeDef *dma = config.dma_channel;
+
+		//previous frame still going out. Don't touch the buffer under the dma
+		if ((dma->CCR & DMA_CCR_EN) && dma->CNDTR != 0) {
+			status = STATUS_CODE_RESOURCE_EXHAUSTED;
+			continue;
+		}
+
+		dshot_fill_burst_buffer(dshot[i].packets, config.num_channels, dshot[i].timing, dshot_buffers[i]);
+
+		dma->CCR &= ~DMA_CCR_EN;
+		dma->CMAR = (uint32_t) dshot_buffers[i];
+		dma->CNDTR = (uint32_t) DSHOT_FRAME_SLOTS * config.num_channels;
+		dma->CCR |= DMA_CCR_EN;
+	}
+	return status;
+}
+
+StatusCode PWMManager::set_all_us(const uint16_t us[12]) {
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+
+	//hold off the update events so that no timer picks up half of the new values. The compare registers
+	//are preloaded, so everything written in between goes out together on the next pwm period
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (!dshot[i].enabled) PWM_TIMER_CONFIG[i].instance->CR1 |= TIM_CR1_UDIS;
+	}
+
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (dshot[i].enabled) continue;
+
+		const PWMTimerConfig &config = PWM_TIMER_CONFIG[i];
+		for (int ch = config.first_channel; ch < config.first_channel + config.num_channels; ch++) {
+			channels[ch].set_us(us[ch]);
+		}
+	}
+
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (!dshot[i].enabled) PWM_TIMER_CONFIG[i].instance->CR1 &= ~TIM_CR1_UDIS;
+	}
+
+	return STATUS_CODE_OK;
+}
+
 PWMChannel &PWMManager::channel(PWMChannelNum num) {
 	if (num <= 12 && num > 0) {
 		return channels[num - 1];
@@ -305,9 +492,52 @@ static TIM_MasterConfigTypeDef getMasterConfig() {
 	return sMasterConfig;
 }
 
+static void enable_timer_clock(PWMGroup group) {
+	switch (group) {
+		case PWM_GROUP_1: __HAL_RCC_TIM16_CLK_ENABLE();
+			break;
+		case PWM_GROUP_2: __HAL_RCC_TIM17_CLK_ENABLE();
+			break;
+		case PWM_GROUP_3_4: __HAL_RCC_TIM15_CLK_ENABLE();
+			break;
+		case PWM_GROUP_5_8: __HAL_RCC_TIM3_CLK_ENABLE();
+			break;
+		case PWM_GROUP_9_12: __HAL_RCC_TIM1_CLK_ENABLE();
+			break;
+		default: break;
+	}
+}
+
+static void stop_dshot_dma(PWMGroup group) {
+	const PWMTimerConfig &config = PWM_TIMER_CONFIG[group];
+
+	__HAL_TIM_DISABLE_DMA(config.timer, TIM_DMA_UPDATE);
+	config.dma_channel->CCR &= ~DMA_CCR_EN;
+	config.instance->DCR = 0;
+}
+
+//DShot groups are left alone: an update event there would kick off their dma in the middle of a frame
+static void synchronize_timers(const PWMDShotState dshot[PWM_NUM_GROUPS]) {
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (!dshot[i].enabled) PWM_TIMER_CONFIG[i].instance->CR1 &= ~TIM_CR1_CEN;
+	}
+
+	//reset the counters and load the preloaded registers
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (dshot[i].enabled) continue;
+		PWM_TIMER_CONFIG[i].instance->CNT = 0;
+		PWM_TIMER_CONFIG[i].instance->EGR = TIM_EGR_UG;
+	}
+
+	//all timers run off the same clock, so once started back to back they stay in phase
+	for (int i = 0; i < PWM_NUM_GROUPS; i++) {
+		if (!dshot[i].enabled) PWM_TIMER_CONFIG[i].instance->CR1 |= TIM_CR1_CEN;
+	}
+}
+
 static StatusCode init_timer(TIM_HandleTypeDef *timer,
 							 TIM_TypeDef *instance,
-							 uint32_t period,
+							 struct PWMCounterSettings counter,
 							 int32_t num_channels,
 							 bool config_breaktime,
 							 bool config_master,
@@ -319,15 +549,13 @@ static StatusCode init_timer(TIM_HandleTypeDef *timer,
 	TIM_OC_InitTypeDef sConfigOC = getChannelConfig(inverted);
 	TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = getBreaktimeConfig();
 
-	struct PWMCounterSettings counter = getCounterSettings(period);
-
 	timer->Instance = instance;
 	timer->Init.Prescaler = counter.prescaler;
 	timer->Init.Period = counter.period;
 	timer->Init.CounterMode = TIM_COUNTERMODE_UP;
 	timer->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	timer->Init.RepetitionCounter = 0;
-	timer->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	timer->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
 
 	HAL_StatusTypeDef status;
 
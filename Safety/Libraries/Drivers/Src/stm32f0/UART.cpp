@@ -2,15 +2,18 @@
  * DMA implementation uses UART Idle line detection to support variable size reads. More info can be found
  * on: https://github.com/akospasztor/stm32-dma-uart
  * Which is what this code is based off
+ *
+ * DMA receive is only supported on port 2. DMA transmit works on both ports, through a DMATxQueue chained from the
+ * transmit complete interrupt
  */
 #include "UART.hpp"
 #include "GPIO.hpp"
 #include "DMA.hpp"
 #include "Status.hpp"
 #include "Debug.hpp"
+#include "BinaryLog.hpp"
 #include "stm32f0xx_hal.h"
 #include <stdlib.h>
-#include <queue>
 
 static const GPIOPort UART1_RX_PORT = GPIO_PORT_B;
 static const GPIOPort UART1_TX_PORT = GPIO_PORT_B;
@@ -22,16 +25,30 @@ static const GPIOPort UART2_TX_PORT = GPIO_PORT_A;
 static const GPIOPinNum UART2_RX_PIN = 3;
 static const GPIOPinNum UART2_TX_PIN = 2;
 
-static UART_HandleTypeDef huart1;
+//received bytes wait here until they're read. Must be a power of two, and at least as big as the dma buffer
+static const uint32_t UART_RX_RING_LEN = 256;
+
+//bytes waiting to be sent with dma. Must be a power of two
+static const uint32_t UART_TX_QUEUE_LEN = 256;
+
+//stm32f0xx_it.c needs these, so don't make static
+UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_tx;
+static uint8_t uart1_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart1_tx_queue;
 
-//stm32f0xx_it.c needs this, so don't make static
 UART_HandleTypeDef huart2;
 DMA_HandleTypeDef hdma_usart2_rx;
-static std::deque<uint8_t> uart2_rx_queue;
 DMAConfig uart2_dma_config;
+static uint8_t uart2_rx_storage[UART_RX_RING_LEN];
+static ByteRing uart2_rx_ring;
+DMA_HandleTypeDef hdma_usart2_tx;
+static uint8_t uart2_tx_storage[UART_TX_QUEUE_LEN];
+static DMATxQueue uart2_tx_queue;
 
 extern StatusCode get_status_code(HAL_StatusTypeDef status);
 extern const char* get_uart_error_code(uint32_t code);
+extern bool start_uart_dma_transmit(void *context, const uint8_t *data, size_t len);
 void USART2_DMA_ErrorCallback(DMA_HandleTypeDef *dma);
 
 bool UARTPort::is_valid_port() {
@@ -117,18 +134,22 @@ StatusCode UARTPort::reset() {
 	return STATUS_CODE_OK;
 }
 
-StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
-	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
-	if (dma_setup_rx || rx_buffer_size == 0) return STATUS_CODE_INVALID_ARGS;
+StatusCode UARTPort::setupRXDMA(size_t rx_buffer_size) {
+	if (rx_buffer_size > UART_RX_RING_LEN) return STATUS_CODE_INVALID_ARGS;
 
 	if (port == UART_PORT2) {
 
 		dma_config = &uart2_dma_config;
 		resetDMAConfig(dma_config, rx_buffer_size);
 		dma_config->dma_handle = (void *) &hdma_usart2_rx;
-		dma_config->queue = (void *) &uart2_rx_queue;
-		dma_config->timeout = 50;
-		this->rx_queue = &uart2_rx_queue;
+		dma_config->queue = (void *) &uart2_rx_ring;
+		this->rx_ring = &uart2_rx_ring;
+
+		//keep whatever was already received if we're only re-setting up after an error
+		if (reallocate_dma_buffer) {
+			rx_ring->init(uart2_rx_storage, UART_RX_RING_LEN);
+			resetDMARXStamps(dma_config);
+		}
 
 		auto dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 		auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
@@ -165,8 +186,6 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 												 (uint16_t) dma_config->dma_buffer_len));
 		if (status != STATUS_CODE_OK) return status;
 
-		//disable the DMA half interrupt since we're using idle line detection instead
-		__HAL_DMA_DISABLE_IT(dma_handle, DMA_IT_HT);
 		HAL_DMA_RegisterCallback(dma_handle, HAL_DMA_XFER_ERROR_CB_ID, USART2_DMA_ErrorCallback);
 
 		//enable uart idle line interrupt
@@ -185,9 +204,8 @@ StatusCode UARTPort::setupDMA(size_t tx_buffer_size, size_t rx_buffer_size) {
 	return STATUS_CODE_UNIMPLEMENTED; //only port 2 supported for stm32f0
 }
 
-StatusCode UARTPort::resetDMA() {
+StatusCode UARTPort::resetRXDMA() {
 	if (port != UART_PORT2) return STATUS_CODE_UNIMPLEMENTED;
-	if (!dma_setup_rx) return STATUS_CODE_INVALID_ARGS;
 
 	auto dma_handle = (DMA_HandleTypeDef *) dma_config->dma_handle;
 	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
@@ -206,7 +224,7 @@ StatusCode UARTPort::resetDMA() {
 		if (dma_config->dma_buffer == nullptr) abort("i2c dma buffer null!", __FILE__, __LINE__);
 		free(dma_config->dma_buffer);
 		dma_config->dma_buffer = nullptr;
-		rx_queue->erase(rx_queue->begin(), rx_queue->end());
+		rx_ring->clear();
 	}
 
 	dma_setup_rx = false;
@@ -214,40 +232,144 @@ StatusCode UARTPort::resetDMA() {
 	return STATUS_CODE_OK;
 }
 
+StatusCode UARTPort::setupTXDMA(size_t tx_buffer_size) {
+	if (tx_buffer_size > UART_TX_QUEUE_LEN) return STATUS_CODE_INVALID_ARGS;
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	DMA_HandleTypeDef *dma_handle;
+	uint8_t *tx_storage;
+	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
+
+	//channel 2 shares its interrupt with the i2c rx dma on channel 3, and channel 4 with the uart 2 rx dma on
+	//channel 5. See PWM.hpp for the other channels in use
+	if (port == UART_PORT1) {
+		dma_handle = &hdma_usart1_tx;
+		tx_queue = &uart1_tx_queue;
+		tx_storage = uart1_tx_storage;
+		dma_handle->Instance = DMA1_Channel2;
+	} else {
+		dma_handle = &hdma_usart2_tx;
+		tx_queue = &uart2_tx_queue;
+		tx_storage = uart2_tx_storage;
+		dma_handle->Instance = DMA1_Channel4;
+	}
+
+	//keep whatever is still waiting to go out if we're only re-setting up after an error
+	if (reallocate_dma_buffer) {
+		StatusCode status = tx_queue->init(tx_storage, UART_TX_QUEUE_LEN, start_uart_dma_transmit, uart_handle);
+		if (status != STATUS_CODE_OK) return status;
+	}
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	dma_handle->Init.Direction = DMA_MEMORY_TO_PERIPH;
+	dma_handle->Init.PeriphInc = DMA_PINC_DISABLE;
+	dma_handle->Init.MemInc = DMA_MINC_ENABLE;
+	dma_handle->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	dma_handle->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	dma_handle->Init.Mode = DMA_NORMAL;
+	dma_handle->Init.Priority = DMA_PRIORITY_LOW;
+
+	StatusCode status = get_status_code(HAL_DMA_Init(dma_handle));
+	if (status != STATUS_CODE_OK) return status;
+
+	__HAL_LINKDMA(uart_handle, hdmatx, (*dma_handle));
+
+	//the transmit complete callback comes from the uart interrupt, once the last byte has left the shift register
+	if (port == UART_PORT1) {
+		__HAL_DMA1_REMAP(HAL_DMA1_CH2_USART1_TX);
+		HAL_NVIC_SetPriority(USART1_IRQn, 0, 0);
+		HAL_NVIC_SetPriority(DMA1_Channel2_3_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(USART1_IRQn);
+		HAL_NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
+	} else {
+		__HAL_DMA1_REMAP(HAL_DMA1_CH4_USART2_TX);
+		HAL_NVIC_SetPriority(USART2_IRQn, 0, 0);
+		HAL_NVIC_SetPriority(DMA1_Channel4_5_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(USART2_IRQn);
+		HAL_NVIC_EnableIRQ(DMA1_Channel4_5_IRQn);
+	}
+
+	dma_setup_tx = true;
+
+	return STATUS_CODE_OK;
+}
+
+StatusCode UARTPort::resetTXDMA() {
+	if (!is_valid_port()) return STATUS_CODE_UNIMPLEMENTED;
+
+	auto uart_handle = (UART_HandleTypeDef *) this->interface_handle;
+
+	//the dma interrupts are shared with other peripherals, so they're left enabled
+	HAL_UART_AbortTransmit(uart_handle);
+
+	StatusCode status = get_status_code(HAL_DMA_DeInit(uart_handle->hdmatx));
+	if (status != STATUS_CODE_OK) return status;
+
+	//whatever was being sent goes out again from the start once the dma is back up
+	if (reallocate_dma_buffer) {
+		tx_queue->clear();
+	} else {
+		tx_queue->transfer_aborted();
+	}
+
+	dma_setup_tx = false;
+
+	return STATUS_CODE_OK;
+}
+
+static DMATxQueue *get_tx_queue(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) return &uart1_tx_queue;
+	if (huart->Instance == USART2) return &uart2_tx_queue;
+	return nullptr;
+}
+
 //Below code based off: https://github.com/akospasztor/stm32-dma-uart/blob/master/Src/main.c
+//the idle line interrupt (in stm32f0xx_it.c) delivers data as soon as the sender pauses, these two only make sure
+//it's picked up before the dma overwrites it on a long burst
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
 	if (huart->Instance == USART2) {
-		processDMARXCompleteEvent(&uart2_dma_config);
+		processDMARXEvent(&uart2_dma_config);
 	}
 }
 void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
-	error("half called");
-	UNUSED(huart);
+	if (huart->Instance == USART2) {
+		processDMARXEvent(&uart2_dma_config);
+	}
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+	DMATxQueue *queue = get_tx_queue(huart);
+	if (queue != nullptr) queue->transfer_complete();
 }
 
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	//a dma error stops the transmit part way. The queue resends that region on the next transmit
+	if (huart->gState == HAL_UART_STATE_READY) {
+		DMATxQueue *queue = get_tx_queue(huart);
+		if (queue != nullptr) queue->transfer_aborted();
+	}
+
+	//runs in the uart interrupt, so only the binary log is safe to use here
 	if (huart->Instance == USART1) {
-		error("USART1 Error received", huart->ErrorCode);
+		LOG_ERROR("USART1 Error received. Code: 0x%02lx", huart->ErrorCode);
 	} else if (huart->Instance == USART2) {
-		char buffer[50];
-		sprintf(buffer, "USART2 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
-		error(buffer);
+		LOG_ERROR("USART2 Error received. Code: %lu Type: %s", huart->ErrorCode, get_uart_error_code(huart->ErrorCode));
 		uart2_dma_config.reset = true;
 	} else {
-		error("Unknown USART port got an error callback");
+		LOG_ERROR("Unknown USART port got an error callback");
 	}
 }
 
 void USART2_DMA_ErrorCallback(DMA_HandleTypeDef *dma) {
-	error("USART 2 DMA Error received!", dma->ErrorCode);
+	LOG_ERROR("USART 2 DMA Error received! Code: 0x%02lx", dma->ErrorCode);
 }
 
 void HAL_UART_AbortCpltCallback(UART_HandleTypeDef *huart) {
 	if (huart->Instance == USART1) {
-		error("USART1 Abort received");
+		LOG_ERROR("USART1 Abort received");
 	}
 	if (huart->Instance == USART2) {
-		error("USART2 Abort received");
+		LOG_ERROR("USART2 Abort received");
 	}
 }
 
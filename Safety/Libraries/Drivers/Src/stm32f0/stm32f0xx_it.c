@@ -60,17 +60,15 @@
 /* External variables --------------------------------------------------------*/
 //extern SPI_HandleTypeDef hspi1;
 extern TIM_HandleTypeDef htim14;
+extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart2_tx;
 extern I2C_HandleTypeDef hi2c1;
 
 extern DMAConfig i2c1_dma_config;
 extern DMAConfig uart2_dma_config;
 
-//ppm stuff
-extern volatile uint32_t ppm_last_received_time;
-extern volatile uint8_t ppm_packet_timeout_reached;
-extern uint32_t PPM_PACKET_TIMEOUT;
-
 //watchdog
 extern WWDG_HandleTypeDef hwwdg;
 /* USER CODE END EV */
@@ -146,20 +144,6 @@ void SysTick_Handler(void) {
 	HAL_IncTick();
 	/* USER CODE BEGIN SysTick_IRQn 1 */
 
-	if (uart2_dma_config.timer == 1) {
-		//call uart2 transfer complete with idle flag on
-		uart2_dma_config.idle_line = 1;
-
-		DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) uart2_dma_config.dma_handle;
-		dma_handle->XferCpltCallback(dma_handle);
-	}
-
-	if (uart2_dma_config.timer) uart2_dma_config.timer--;
-
-	if (HAL_GetTick() - ppm_last_received_time >= PPM_PACKET_TIMEOUT){
-		ppm_packet_timeout_reached = 1;
-	}
-
 	/* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -178,7 +162,12 @@ void DMA1_Channel2_3_IRQHandler(void) {
 
 	/* USER CODE END DMA1_Channel2_3_IRQn 0 */
 	//HAL_DMA_IRQHandler(&hdma_spi1_rx);
-	HAL_DMA_IRQHandler((DMA_HandleTypeDef *) i2c1_dma_config.dma_handle);
+	if (i2c1_dma_config.dma_handle != NULL) {
+		HAL_DMA_IRQHandler((DMA_HandleTypeDef *) i2c1_dma_config.dma_handle);
+	}
+	if (hdma_usart1_tx.Instance != NULL) {
+		HAL_DMA_IRQHandler(&hdma_usart1_tx);
+	}
 	/* USER CODE BEGIN DMA1_Channel2_3_IRQn 1 */
 
 	/* USER CODE END DMA1_Channel2_3_IRQn 1 */
@@ -191,7 +180,12 @@ void DMA1_Channel4_5_IRQHandler(void) {
 	/* USER CODE BEGIN DMA1_Channel4_5_IRQn 0 */
 
 	/* USER CODE END DMA1_Channel4_5_IRQn 0 */
-	HAL_DMA_IRQHandler((DMA_HandleTypeDef *) uart2_dma_config.dma_handle);
+	if (uart2_dma_config.dma_handle != NULL) {
+		HAL_DMA_IRQHandler((DMA_HandleTypeDef *) uart2_dma_config.dma_handle);
+	}
+	if (hdma_usart2_tx.Instance != NULL) {
+		HAL_DMA_IRQHandler(&hdma_usart2_tx);
+	}
 	/* USER CODE BEGIN DMA1_Channel4_5_IRQn 1 */
 
 	/* USER CODE END DMA1_Channel4_5_IRQn 1 */
@@ -223,12 +217,16 @@ void SPI1_IRQHandler(void) {
 	/* USER CODE END SPI1_IRQn 1 */
 }
 
+void USART1_IRQHandler(void) {
+	HAL_UART_IRQHandler(&huart1);
+}
+
 void USART2_IRQHandler(void) {
 	/* UART IDLE Interrupt */
-	if ((USART2->ISR & USART_ISR_IDLE) != RESET) {
+	if ((USART2->CR1 & USART_CR1_IDLEIE) && (USART2->ISR & USART_ISR_IDLE) != RESET) {
 		USART2->ICR = UART_CLEAR_IDLEF;
-		/* Start DMA timer */
-		uart2_dma_config.timer = uart2_dma_config.timeout;
+		/* Line went idle, deliver whatever the DMA has received so far */
+		processDMARXEvent(&uart2_dma_config);
 	}
 
 	HAL_UART_IRQHandler(&huart2);
@@ -238,8 +236,6 @@ void I2C1_IRQHandler(void) {
 	if ((I2C1->ISR & I2C_ISR_TCR) != RESET) { //if we got stop bit complete callback
 		I2C1->ICR = I2C_ICR_STOPCF;
 
-		i2c1_dma_config.idle_line = 1;
-
 		DMA_HandleTypeDef *dma_handle = (DMA_HandleTypeDef *) i2c1_dma_config.dma_handle;
 		dma_handle->XferCpltCallback(dma_handle); //call our transfer complete callback
 	}
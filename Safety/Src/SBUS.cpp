@@ -1,13 +1,22 @@
 #include "SBUS.hpp"
+#include "Clock.hpp"
+#include <string.h>
+
+static const uint32_t SBUS_BAUDRATE = 100000;
+static const uint32_t SBUS_BYTE_TIME_US = 12 * 1000000 / SBUS_BAUDRATE; //start, 8 data, parity and 2 stop bits
+
+//bytes in a frame come in back to back, and there are at least a few ms between frames. This is well clear of both,
+//and of how far off arrival times can be
+static const int64_t SBUS_IDLE_GAP_US = 1000;
 
 SBUSPort::SBUSPort(UARTPortNum num, SBUSSettings settings) {
 	UARTSettings port_settings;
 	port_settings.rx_inverted = true;
 	port_settings.timeout = 50;
-	port_settings.stop_bits = 1;
+	port_settings.stop_bits = 2;
 	port_settings.cts_rts = false;
-	port_settings.parity = UART_NO_PARITY; //double check this?
-	port_settings.baudrate = 100000;
+	port_settings.parity = UART_EVEN_PARITY;
+	port_settings.baudrate = SBUS_BAUDRATE;
 
 	port = UARTPort(num, port_settings);
 
@@ -20,30 +29,130 @@ StatusCode SBUSPort::setup() {
 	StatusCode status = port.setup();
 	if (status != STATUS_CODE_OK) return status;
 
-	status = port.setupDMA(0, 24); //setup DMA to be the largest size of a SBUS packet
+	//one frame at a time. The idle line flushes the buffer in between frames
+	status = port.setupDMA(0, SBUS_FRAME_LEN);
 	if (status != STATUS_CODE_OK) return status;
 
+	sync.reset();
+	received_frame = false;
+	frame_time_us = 0;
+	rx_bytes = 0;
+	has_last_byte = false;
+
 	is_setup = true;
-	return STATUS_CODE_UNIMPLEMENTED;
+	return STATUS_CODE_OK;
 }
 
 StatusCode SBUSPort::reset() {
 	if (!is_setup) return STATUS_CODE_INVALID_ARGS;
 
-	port.reset();
+	StatusCode status = port.reset();
 
 	is_setup = false;
-	return STATUS_CODE_UNIMPLEMENTED;
+	return status;
+}
+
+StatusCode SBUSPort::update() {
+	if (!is_setup) return STATUS_CODE_UNINITIALIZED;
+
+	StatusCode status = STATUS_CODE_EMPTY;
+	size_t bytes_read = 0;
+
+	//read straight into the frame buffer so the frame never has to be copied before decoding
+	do {
+		uint8_t *received = sync.buffer();
+		StatusCode read_status = port.read_bytes(received, sync.space(), bytes_read);
+
+		if (read_status == STATUS_CODE_INTERNAL_ERROR) {
+			//the uart driver is re-initializing after a line error, anything partial is garbage now
+			sync.reset();
+			return read_status;
+		}
+
+		if (bytes_read == 0) break;
+
+		//anything from before the line last went idle belongs to a frame that lost bytes, so it's dropped
+		size_t start = find_idle(bytes_read);
+		size_t len = bytes_read;
+		rx_bytes += (uint32_t) bytes_read;
+		if (start < bytes_read) {
+			sync.reset();
+			len = bytes_read - start;
+			memmove(sync.buffer(), received + start, len);
+		}
+
+		if (sync.commit(len)) {
+			if (sbus_decode_frame(sync.frame(), frame) == STATUS_CODE_OK) {
+				//timed by when its first byte came in, however long the main loop took to get here
+				if (port.rx_arrival_time(rx_bytes - SBUS_FRAME_LEN, frame_time_us) != STATUS_CODE_OK) {
+					frame_time_us = get_system_time_us();
+				}
+				received_frame = true;
+				status = STATUS_CODE_OK;
+			}
+		}
+	} while (bytes_read > 0);
+
+	return status;
+}
+
+size_t SBUSPort::find_idle(size_t len) {
+	uint64_t first_us, last_us;
+	if (port.rx_arrival_time(rx_bytes, first_us) != STATUS_CODE_OK
+		|| port.rx_arrival_time(rx_bytes + (uint32_t) len - 1, last_us) != STATUS_CODE_OK) {
+		//read too late to still be timed, so there's no telling
+		has_last_byte = false;
+		return len;
+	}
+
+	size_t start = len;
+	if (has_last_byte && (int64_t) (first_us - last_byte_us) > SBUS_IDLE_GAP_US) start = 0;
+
+	//bytes are timed back to back from the hand over that delivered them, so a gap anywhere in between shows up as
+	//the whole run taking longer than it should. Only then is each byte looked at
+	if ((int64_t) (last_us - first_us) > (int64_t) ((len - 1) * SBUS_BYTE_TIME_US) + SBUS_IDLE_GAP_US) {
+		uint64_t previous_us = first_us;
+		for (size_t i = 1; i < len; i++) {
+			uint64_t arrived_us;
+			if (port.rx_arrival_time(rx_bytes + (uint32_t) i, arrived_us) != STATUS_CODE_OK) continue;
+			if ((int64_t) (arrived_us - previous_us) > SBUS_IDLE_GAP_US) start = i;
+			previous_us = arrived_us;
+		}
+	}
+
+	last_byte_us = last_us;
+	has_last_byte = true;
+	return start;
 }
 
 uint8_t SBUSPort::get(PWMChannelNum num) {
-	return 0;
+	if (num == 0 || num > SBUS_NUM_CHANNELS || !received_frame) {
+		return 0;
+	}
+	return sbus_raw_to_percent(frame.channels[num - 1]);
 }
 
 uint32_t SBUSPort::get_us(PWMChannelNum num) {
-	return 0;
+	if (num == 0 || num > SBUS_NUM_CHANNELS || !received_frame) {
+		return 0;
+	}
+	return sbus_raw_to_us(frame.channels[num - 1]);
 }
 
 bool SBUSPort::is_disconnected(uint32_t sys_time) {
-	return false;
-}
\ No newline at end of file
+	if (!received_frame || frame.failsafe) return true;
+
+	return (sys_time - (uint32_t) (frame_time_us / 1000)) >= settings.disconnect_timeout;
+}
+
+bool SBUSPort::is_frame_lost() {
+	return frame.frame_lost;
+}
+
+uint64_t SBUSPort::get_frame_time_us() {
+	return frame_time_us;
+}
+
+const SBUSFrame &SBUSPort::get_frame() {
+	return frame;
+}
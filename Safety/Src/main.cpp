@@ -8,6 +8,7 @@
 #include "PPM.hpp"
 #include "Watchdog.hpp"
 #include "Profiler.h"
+#include "BinaryLog.hpp"
 #include "stm32f0xx_hal.h"
 
 char buffer[200]; //buffer for printing
@@ -133,8 +134,8 @@ int main() {
 			toggle = true;
 		}
 
-		sprintf(buffer, "System Time (us): %u", get_system_time());
-		info(buffer);
+		LOG_INFO("System Time (ms): %lu", get_system_time());
+		binary_log_flush();
 
 		delay(1000);
 